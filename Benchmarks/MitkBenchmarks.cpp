@@ -0,0 +1,28 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include "mitkBenchmark.h"
+
+/**
+  \brief Runs the performance benchmarks of the core image pipelines.
+
+  Call with --benchmark_out=results.json to keep the results for comparing
+  them between revisions, see mitk::Benchmark::RunSpecified() for all options.
+*/
+int main(int argc, char* argv[])
+{
+  return mitk::Benchmark::RunSpecified(argc, argv);
+}
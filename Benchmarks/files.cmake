@@ -0,0 +1,7 @@
+set(CPP_FILES
+  MitkBenchmarks.cpp
+  mitkBenchmark.cpp
+  mitkDataStorageBenchmarks.cpp
+  mitkImageBenchmarks.cpp
+  mitkPropertyBenchmarks.cpp
+)
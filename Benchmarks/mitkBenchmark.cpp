@@ -0,0 +1,481 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include "mitkBenchmark.h"
+
+#include <mitkVersion.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <exception>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <thread>
+
+namespace
+{
+  struct BenchmarkResult
+  {
+    std::string Name;
+    unsigned long long Iterations;
+    double RealTime;
+    double CpuTime;
+    double BytesPerSecond;
+    double ItemsPerSecond;
+    std::string Label;
+    std::string ErrorMessage;
+    bool Error;
+  };
+
+  std::vector<mitk::Benchmark*>& GetBenchmarks()
+  {
+    static std::vector<mitk::Benchmark*> benchmarks;
+    return benchmarks;
+  }
+
+  const unsigned long long MaxIterations = 1000000000;
+
+  /**
+   * Runs a benchmark with a growing number of iterations until the iterations
+   * take at least minTime seconds, the way Google Benchmark does.
+   */
+  BenchmarkResult Run(mitk::Benchmark* benchmark, const std::string& name, long range, double minTime)
+  {
+    BenchmarkResult result;
+    result.Name = name;
+    result.Error = false;
+
+    unsigned long long iterations = 1;
+    while (true)
+    {
+      mitk::BenchmarkState state(iterations, range);
+      try
+      {
+        benchmark->GetFunction()(state);
+      }
+      catch (const std::exception& e)
+      {
+        state.SkipWithError(e.what());
+      }
+      catch (...)
+      {
+        state.SkipWithError("unknown exception");
+      }
+
+      const double seconds = state.GetRealTime();
+      if (state.HasError() || seconds >= minTime || iterations >= MaxIterations)
+      {
+        result.Iterations = state.GetIterations();
+        result.Error = state.HasError();
+        result.ErrorMessage = state.GetErrorMessage();
+        result.Label = state.GetLabel();
+        result.RealTime = result.Iterations > 0 ? seconds / result.Iterations : 0.0;
+        result.CpuTime = result.Iterations > 0 ? state.GetCpuTime() / result.Iterations : 0.0;
+        result.BytesPerSecond = seconds > 0 ? state.GetBytesProcessed() / seconds : 0.0;
+        result.ItemsPerSecond = seconds > 0 ? state.GetItemsProcessed() / seconds : 0.0;
+        return result;
+      }
+
+      // aim 40% above the minimum, but grow at most tenfold per attempt
+      const double multiplier = seconds > 0 ? std::min(10.0, minTime * 1.4 / seconds) : 10.0;
+      iterations = std::min(MaxIterations, std::max(iterations + 1, static_cast<unsigned long long>(iterations * multiplier)));
+    }
+  }
+
+  void WriteJsonString(std::ostream& os, const std::string& str)
+  {
+    os << '"';
+    for (std::string::const_iterator iter = str.begin(); iter != str.end(); ++iter)
+    {
+      const unsigned char c = static_cast<unsigned char>(*iter);
+      if (c == '"' || c == '\\')
+      {
+        os << '\\' << *iter;
+      }
+      else if (c < 0x20)
+      {
+        os << "\\u" << std::hex << std::setw(4) << std::setfill('0') << static_cast<int>(c) << std::dec << std::setfill(' ');
+      }
+      else
+      {
+        os << *iter;
+      }
+    }
+    os << '"';
+  }
+
+  /** Writes the results in the JSON format of Google Benchmark, times in milliseconds. */
+  void WriteJson(std::ostream& os, const std::string& executable, const std::vector<BenchmarkResult>& results)
+  {
+    char date[32];
+    const std::time_t now = std::time(nullptr);
+    std::strftime(date, sizeof(date), "%Y-%m-%d %H:%M:%S", std::localtime(&now));
+
+    os << "{\n  \"context\": {\n    \"date\": ";
+    WriteJsonString(os, date);
+    os << ",\n    \"executable\": ";
+    WriteJsonString(os, executable);
+    os << ",\n    \"num_cpus\": " << std::thread::hardware_concurrency()
+       << ",\n    \"mitk_version\": ";
+    WriteJsonString(os, MITK_VERSION_STRING);
+    os << ",\n    \"mitk_revision\": ";
+    WriteJsonString(os, MITK_REVISION);
+#ifdef NDEBUG
+    os << ",\n    \"library_build_type\": \"release\"";
+#else
+    os << ",\n    \"library_build_type\": \"debug\"";
+#endif
+    os << "\n  },\n  \"benchmarks\": [";
+
+    os << std::setprecision(6);
+    for (std::vector<BenchmarkResult>::const_iterator iter = results.begin(); iter != results.end(); ++iter)
+    {
+      os << (iter == results.begin() ? "\n" : ",\n") << "    {\n      \"name\": ";
+      WriteJsonString(os, iter->Name);
+      if (iter->Error)
+      {
+        os << ",\n      \"error_occurred\": true,\n      \"error_message\": ";
+        WriteJsonString(os, iter->ErrorMessage);
+      }
+      os << ",\n      \"iterations\": " << iter->Iterations
+         << ",\n      \"real_time\": " << iter->RealTime * 1000.0
+         << ",\n      \"cpu_time\": " << iter->CpuTime * 1000.0
+         << ",\n      \"time_unit\": \"ms\"";
+      if (iter->BytesPerSecond > 0)
+      {
+        os << ",\n      \"bytes_per_second\": " << iter->BytesPerSecond;
+      }
+      if (iter->ItemsPerSecond > 0)
+      {
+        os << ",\n      \"items_per_second\": " << iter->ItemsPerSecond;
+      }
+      if (!iter->Label.empty())
+      {
+        os << ",\n      \"label\": ";
+        WriteJsonString(os, iter->Label);
+      }
+      os << "\n    }";
+    }
+    os << "\n  ]\n}\n";
+  }
+
+  void WriteConsole(std::ostream& os, const BenchmarkResult& result)
+  {
+    os << std::left << std::setw(48) << result.Name << std::right;
+    if (result.Error)
+    {
+      os << " ERROR OCCURRED: '" << result.ErrorMessage << "'" << std::endl;
+      return;
+    }
+    os << std::fixed << std::setprecision(3)
+       << std::setw(12) << result.RealTime * 1000.0 << " ms"
+       << std::setw(12) << result.CpuTime * 1000.0 << " ms"
+       << std::setw(12) << result.Iterations;
+    if (result.BytesPerSecond > 0)
+    {
+      os << std::setw(10) << result.BytesPerSecond / (1024.0 * 1024.0) << " MB/s";
+    }
+    if (result.ItemsPerSecond > 0)
+    {
+      os << std::setw(12) << result.ItemsPerSecond << " items/s";
+    }
+    if (!result.Label.empty())
+    {
+      os << " " << result.Label;
+    }
+    os.unsetf(std::ios_base::floatfield);
+    os << std::endl;
+  }
+
+  bool ParseOption(const std::string& arg, const std::string& option, std::string& value)
+  {
+    const std::string prefix = "--" + option + "=";
+    if (arg.compare(0, prefix.size(), prefix) != 0) return false;
+    value = arg.substr(prefix.size());
+    return true;
+  }
+}
+
+mitk::BenchmarkState::BenchmarkState(unsigned long long maxIterations, long range)
+  : m_MaxIterations(maxIterations)
+  , m_Range(range)
+  , m_Iterations(0)
+  , m_Started(false)
+  , m_Running(false)
+  , m_CpuStart(0)
+  , m_RealTime(0)
+  , m_CpuTime(0)
+  , m_BytesProcessed(0)
+  , m_ItemsProcessed(0)
+{
+}
+
+bool mitk::BenchmarkState::KeepRunning()
+{
+  if (!m_Started)
+  {
+    m_Started = true;
+    if (!this->HasError())
+    {
+      this->ResumeTiming();
+    }
+  }
+  else
+  {
+    ++m_Iterations;
+  }
+
+  if (this->HasError() || m_Iterations >= m_MaxIterations)
+  {
+    if (m_Running)
+    {
+      this->PauseTiming();
+    }
+    return false;
+  }
+  return true;
+}
+
+void mitk::BenchmarkState::PauseTiming()
+{
+  if (!m_Running) return;
+  m_RealTime += std::chrono::duration<double>(std::chrono::steady_clock::now() - m_RealStart).count();
+  m_CpuTime += static_cast<double>(std::clock() - m_CpuStart) / CLOCKS_PER_SEC;
+  m_Running = false;
+}
+
+void mitk::BenchmarkState::ResumeTiming()
+{
+  if (m_Running) return;
+  m_Running = true;
+  m_CpuStart = std::clock();
+  m_RealStart = std::chrono::steady_clock::now();
+}
+
+long mitk::BenchmarkState::GetRange() const
+{
+  return m_Range;
+}
+
+void mitk::BenchmarkState::SetBytesProcessed(long long bytes)
+{
+  m_BytesProcessed = bytes;
+}
+
+void mitk::BenchmarkState::SetItemsProcessed(long long items)
+{
+  m_ItemsProcessed = items;
+}
+
+void mitk::BenchmarkState::SetLabel(const std::string& label)
+{
+  m_Label = label;
+}
+
+void mitk::BenchmarkState::SkipWithError(const std::string& message)
+{
+  m_ErrorMessage = message.empty() ? std::string("error") : message;
+  this->PauseTiming();
+}
+
+unsigned long long mitk::BenchmarkState::GetIterations() const
+{
+  return m_Iterations;
+}
+
+double mitk::BenchmarkState::GetRealTime() const
+{
+  return m_RealTime;
+}
+
+double mitk::BenchmarkState::GetCpuTime() const
+{
+  return m_CpuTime;
+}
+
+long long mitk::BenchmarkState::GetBytesProcessed() const
+{
+  return m_BytesProcessed;
+}
+
+long long mitk::BenchmarkState::GetItemsProcessed() const
+{
+  return m_ItemsProcessed;
+}
+
+const std::string& mitk::BenchmarkState::GetLabel() const
+{
+  return m_Label;
+}
+
+bool mitk::BenchmarkState::HasError() const
+{
+  return !m_ErrorMessage.empty();
+}
+
+const std::string& mitk::BenchmarkState::GetErrorMessage() const
+{
+  return m_ErrorMessage;
+}
+
+mitk::Benchmark::Benchmark(const std::string& name, Function function)
+  : m_Name(name)
+  , m_Function(function)
+{
+}
+
+mitk::Benchmark* mitk::Benchmark::Arg(long range)
+{
+  m_Args.push_back(range);
+  return this;
+}
+
+const std::string& mitk::Benchmark::GetName() const
+{
+  return m_Name;
+}
+
+mitk::Benchmark::Function mitk::Benchmark::GetFunction() const
+{
+  return m_Function;
+}
+
+const std::vector<long>& mitk::Benchmark::GetArgs() const
+{
+  return m_Args;
+}
+
+mitk::Benchmark* mitk::Benchmark::Register(const std::string& name, Function function)
+{
+  // registered benchmarks live until the program ends
+  Benchmark* benchmark = new Benchmark(name, function);
+  GetBenchmarks().push_back(benchmark);
+  return benchmark;
+}
+
+int mitk::Benchmark::RunSpecified(int argc, char* argv[])
+{
+  std::string filter;
+  std::string format = "console";
+  std::string outFile;
+  double minTime = 0.5;
+  bool list = false;
+
+  for (int i = 1; i < argc; ++i)
+  {
+    const std::string arg = argv[i];
+    std::string value;
+    if (ParseOption(arg, "benchmark_filter", value))
+    {
+      filter = value == "all" ? std::string() : value;
+    }
+    else if (ParseOption(arg, "benchmark_min_time", value))
+    {
+      minTime = std::atof(value.c_str());
+    }
+    else if (ParseOption(arg, "benchmark_format", value) && (value == "console" || value == "json"))
+    {
+      format = value;
+    }
+    else if (ParseOption(arg, "benchmark_out", value))
+    {
+      outFile = value;
+    }
+    else if (arg == "--benchmark_list_tests" || arg == "--benchmark_list_tests=true")
+    {
+      list = true;
+    }
+    else
+    {
+      std::cerr << "Usage: " << argv[0] << " [--benchmark_filter=<substring>] [--benchmark_min_time=<seconds>]\n"
+                << "       [--benchmark_format=<console|json>] [--benchmark_out=<file>] [--benchmark_list_tests]" << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+
+  std::vector<std::pair<Benchmark*, long> > runs;
+  std::vector<std::string> names;
+  const std::vector<Benchmark*>& benchmarks = GetBenchmarks();
+  for (std::vector<Benchmark*>::const_iterator iter = benchmarks.begin(); iter != benchmarks.end(); ++iter)
+  {
+    std::vector<long> args = (*iter)->GetArgs();
+    if (args.empty())
+    {
+      args.push_back(0);
+    }
+    for (std::vector<long>::const_iterator argIter = args.begin(); argIter != args.end(); ++argIter)
+    {
+      std::ostringstream name;
+      name << (*iter)->GetName();
+      if (!(*iter)->GetArgs().empty())
+      {
+        name << '/' << *argIter;
+      }
+      if (name.str().find(filter) != std::string::npos)
+      {
+        runs.push_back(std::make_pair(*iter, *argIter));
+        names.push_back(name.str());
+      }
+    }
+  }
+
+  if (list)
+  {
+    for (std::vector<std::string>::const_iterator iter = names.begin(); iter != names.end(); ++iter)
+    {
+      std::cout << *iter << std::endl;
+    }
+    return EXIT_SUCCESS;
+  }
+
+  if (format == "console")
+  {
+    std::cout << std::left << std::setw(48) << "Benchmark" << std::right
+              << std::setw(15) << "Time" << std::setw(15) << "CPU" << std::setw(12) << "Iterations" << std::endl;
+  }
+
+  std::vector<BenchmarkResult> results;
+  bool success = true;
+  for (std::size_t i = 0; i < runs.size(); ++i)
+  {
+    results.push_back(Run(runs[i].first, names[i], runs[i].second, minTime));
+    success = success && !results.back().Error;
+    if (format == "console")
+    {
+      WriteConsole(std::cout, results.back());
+    }
+  }
+
+  if (format == "json")
+  {
+    WriteJson(std::cout, argv[0], results);
+  }
+
+  if (!outFile.empty())
+  {
+    std::ofstream out(outFile.c_str());
+    WriteJson(out, argv[0], results);
+    if (!out)
+    {
+      std::cerr << "Could not write the results to " << outFile << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+
+  return success ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,149 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#ifndef mitkBenchmark_h
+#define mitkBenchmark_h
+
+#include <chrono>
+#include <ctime>
+#include <string>
+#include <vector>
+
+namespace mitk
+{
+
+/**
+ * \brief Controls the timed loop of one benchmark run.
+ *
+ * A benchmark function does its set-up, then repeats the measured code while
+ * KeepRunning() returns true:
+ *
+ * \code
+ * void BM_Something(mitk::BenchmarkState& state)
+ * {
+ *   mitk::Image::Pointer image = CreateImage(state.GetRange());
+ *   while (state.KeepRunning())
+ *   {
+ *     DoSomething(image);
+ *   }
+ * }
+ * MITK_BENCHMARK(BM_Something)->Arg(64)->Arg(256);
+ * \endcode
+ *
+ * The interface follows Google Benchmark, so that its tools can be used to
+ * compare the results.
+ */
+class BenchmarkState
+{
+public:
+
+  BenchmarkState(unsigned long long maxIterations, long range);
+
+  /** \brief Starts the timer on the first call, stops it after the last iteration. */
+  bool KeepRunning();
+
+  /** \brief Excludes code from the measurement, e.g. resetting the input of the next iteration. */
+  void PauseTiming();
+  void ResumeTiming();
+
+  /** \brief The argument of the run, e.g. the edge length of the generated image. */
+  long GetRange() const;
+
+  /** \brief Bytes or items processed by all iterations, reported per second. */
+  void SetBytesProcessed(long long bytes);
+  void SetItemsProcessed(long long items);
+
+  void SetLabel(const std::string& label);
+
+  /** \brief Ends the run and reports it as failed, KeepRunning() returns false afterwards. */
+  void SkipWithError(const std::string& message);
+
+  unsigned long long GetIterations() const;
+  double GetRealTime() const;
+  double GetCpuTime() const;
+  long long GetBytesProcessed() const;
+  long long GetItemsProcessed() const;
+  const std::string& GetLabel() const;
+  bool HasError() const;
+  const std::string& GetErrorMessage() const;
+
+private:
+
+  const unsigned long long m_MaxIterations;
+  const long m_Range;
+  unsigned long long m_Iterations;
+  bool m_Started;
+  bool m_Running;
+
+  std::chrono::steady_clock::time_point m_RealStart;
+  std::clock_t m_CpuStart;
+  double m_RealTime;
+  double m_CpuTime;
+
+  long long m_BytesProcessed;
+  long long m_ItemsProcessed;
+  std::string m_Label;
+  std::string m_ErrorMessage;
+};
+
+/**
+ * \brief A registered benchmark function and the arguments it is run with.
+ */
+class Benchmark
+{
+public:
+
+  typedef void (*Function)(BenchmarkState&);
+
+  Benchmark(const std::string& name, Function function);
+
+  /** \brief Adds a run with the given argument, see BenchmarkState::GetRange(). */
+  Benchmark* Arg(long range);
+
+  const std::string& GetName() const;
+  Function GetFunction() const;
+  const std::vector<long>& GetArgs() const;
+
+  /** \brief Registers a benchmark, use the MITK_BENCHMARK macro instead. */
+  static Benchmark* Register(const std::string& name, Function function);
+
+  /**
+   * \brief Runs the registered benchmarks selected on the command line.
+   *
+   * Understands the Google Benchmark options --benchmark_filter=<substring>,
+   * --benchmark_min_time=<seconds>, --benchmark_format=<console|json>,
+   * --benchmark_out=<file> (always JSON) and --benchmark_list_tests.
+   * \return the exit code of the program
+   */
+  static int RunSpecified(int argc, char* argv[]);
+
+private:
+
+  const std::string m_Name;
+  const Function m_Function;
+  std::vector<long> m_Args;
+};
+
+}
+
+#define MITK_BENCHMARK_CONCAT_(a, b) a##b
+#define MITK_BENCHMARK_CONCAT(a, b) MITK_BENCHMARK_CONCAT_(a, b)
+
+/** \brief Registers \c function as a benchmark of the same name, returns a mitk::Benchmark*. */
+#define MITK_BENCHMARK(function) \
+  static mitk::Benchmark* MITK_BENCHMARK_CONCAT(mitkBenchmark, __LINE__) = mitk::Benchmark::Register(#function, &function)
+
+#endif
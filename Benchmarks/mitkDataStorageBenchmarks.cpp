@@ -0,0 +1,106 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include "mitkBenchmark.h"
+
+#include <mitkNodePredicateDataType.h>
+#include <mitkNodePredicateProperty.h>
+#include <mitkPointSet.h>
+#include <mitkProperties.h>
+#include <mitkStandaloneDataStorage.h>
+#include <mitkSurface.h>
+
+#include <sstream>
+#include <vector>
+
+/*
+ * The argument of the runs is the number of nodes in the data storage. Every
+ * hundredth node holds a surface, all others a point set. A run looks up one
+ * node by name or all surfaces by data type per iteration, once through the
+ * indices of the data storage and once by checking the predicate on all nodes
+ * like the data storage did before it had indices.
+ */
+
+namespace
+{
+  volatile std::size_t g_Sink = 0;
+
+  mitk::StandaloneDataStorage::Pointer CreateDataStorage(long numNodes)
+  {
+    mitk::StandaloneDataStorage::Pointer dataStorage = mitk::StandaloneDataStorage::New();
+    for (long i = 0; i < numNodes; ++i)
+    {
+      std::ostringstream name;
+      name << "label " << i;
+      mitk::DataNode::Pointer node = mitk::DataNode::New();
+      node->SetName(name.str());
+      if (i % 100)
+        node->SetData(mitk::PointSet::New());
+      else
+        node->SetData(mitk::Surface::New());
+      dataStorage->Add(node);
+    }
+    return dataStorage;
+  }
+
+  /** Alternating name and data type queries. */
+  std::vector<mitk::NodePredicateBase::Pointer> CreateConditions(long numNodes)
+  {
+    std::vector<mitk::NodePredicateBase::Pointer> conditions;
+    for (long i = 0; i < numNodes; i += numNodes / 100)
+    {
+      std::ostringstream name;
+      name << "label " << i;
+      conditions.push_back(mitk::NodePredicateProperty::New("name", mitk::StringProperty::New(name.str())).GetPointer());
+      conditions.push_back(mitk::NodePredicateDataType::New("Surface").GetPointer());
+    }
+    return conditions;
+  }
+
+  void BM_DataStorage_GetSubset_Indexed(mitk::BenchmarkState& state)
+  {
+    mitk::StandaloneDataStorage::Pointer dataStorage = CreateDataStorage(state.GetRange());
+    std::vector<mitk::NodePredicateBase::Pointer> conditions = CreateConditions(state.GetRange());
+
+    std::size_t query = 0;
+    while (state.KeepRunning())
+    {
+      g_Sink = dataStorage->GetSubset(conditions[query++ % conditions.size()])->Size();
+    }
+    state.SetItemsProcessed(state.GetIterations());
+  }
+  MITK_BENCHMARK(BM_DataStorage_GetSubset_Indexed)->Arg(1000)->Arg(10000);
+
+  void BM_DataStorage_GetSubset_LinearScan(mitk::BenchmarkState& state)
+  {
+    mitk::StandaloneDataStorage::Pointer dataStorage = CreateDataStorage(state.GetRange());
+    std::vector<mitk::NodePredicateBase::Pointer> conditions = CreateConditions(state.GetRange());
+    mitk::DataStorage::SetOfObjects::ConstPointer all = dataStorage->GetAll();
+
+    std::size_t query = 0;
+    while (state.KeepRunning())
+    {
+      const mitk::NodePredicateBase* condition = conditions[query++ % conditions.size()];
+      mitk::DataStorage::SetOfObjects::Pointer result = mitk::DataStorage::SetOfObjects::New();
+      for (mitk::DataStorage::SetOfObjects::ConstIterator it = all->Begin(); it != all->End(); ++it)
+        if (condition->CheckNode(it.Value()))
+          result->InsertElement(result->Size(), it.Value());
+      g_Sink = result->Size();
+    }
+    state.SetItemsProcessed(state.GetIterations());
+  }
+  MITK_BENCHMARK(BM_DataStorage_GetSubset_LinearScan)->Arg(1000)->Arg(10000);
+}
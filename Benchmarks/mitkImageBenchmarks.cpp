@@ -0,0 +1,406 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include "mitkBenchmark.h"
+
+#include <mitkClassicDICOMSeriesReader.h>
+#include <mitkExtractSliceFilter.h>
+#include <mitkImageAccessByItk.h>
+#include <mitkImageCast.h>
+#include <mitkImageGenerator.h>
+#include <mitkImageStatisticsCalculator.h>
+#include <mitkImageToSurfaceFilter.h>
+#include <mitkIOUtil.h>
+#include <mitkLevelWindowProperty.h>
+#include <mitkRenderingTestHelper.h>
+#include <mitkSurface.h>
+#include <mitkVtkImageOverwrite.h>
+
+#include <itkGDCMImageIO.h>
+#include <itkImageRegionIteratorWithIndex.h>
+#include <itkImageSeriesWriter.h>
+#include <itkMetaDataObject.h>
+#include <itkNumericSeriesFileNames.h>
+
+#include <itksys/SystemTools.hxx>
+
+#include <vtkImageData.h>
+#include <vtkPolyData.h>
+#include <vtkRenderWindow.h>
+#include <vtkSmartPointer.h>
+
+#include <sstream>
+
+/*
+ * The benchmarks run on synthetic images with the edge length given as the
+ * argument of the run, so that the results only depend on the code and the
+ * machine. A benchmark does its set-up once per run and measures the loop
+ * around KeepRunning() only.
+ */
+
+namespace
+{
+  typedef short PixelType;
+  typedef itk::Image<PixelType, 3> ItkImageType;
+  typedef itk::Image<unsigned char, 3> ItkSegmentationType;
+
+  // results of the measured code are written here, so the compiler cannot drop it
+  volatile double g_Sink = 0;
+
+  /** Random CT-like volume with unit spacing. */
+  mitk::Image::Pointer CreateImage(long edge)
+  {
+    return mitk::ImageGenerator::GenerateRandomImage<PixelType>(edge, edge, edge, 1, 1, 1, 1, 3000, -1000);
+  }
+
+  /** Binary volume containing a sphere of a third of the edge length as radius. */
+  mitk::Image::Pointer CreateSegmentation(long edge)
+  {
+    ItkSegmentationType::SizeType size;
+    size.Fill(edge);
+    ItkSegmentationType::Pointer segmentation = ItkSegmentationType::New();
+    segmentation->SetRegions(size);
+    segmentation->Allocate();
+
+    const double center = (edge - 1) / 2.0;
+    const double radius = edge / 3.0;
+    itk::ImageRegionIteratorWithIndex<ItkSegmentationType> iter(segmentation, segmentation->GetLargestPossibleRegion());
+    for (iter.GoToBegin(); !iter.IsAtEnd(); ++iter)
+    {
+      double distance = 0;
+      for (unsigned int i = 0; i < 3; ++i)
+      {
+        distance += (iter.GetIndex()[i] - center) * (iter.GetIndex()[i] - center);
+      }
+      iter.Set(distance <= radius * radius ? 1 : 0);
+    }
+
+    mitk::Image::Pointer image;
+    mitk::CastToMitkImage(segmentation, image);
+    return image;
+  }
+
+  /** Plane through the center of the slice with the given index, as used by the segmentation tools. */
+  mitk::PlaneGeometry::Pointer CreatePlane(const mitk::Image* image, mitk::PlaneGeometry::PlaneOrientation orientation, long slice)
+  {
+    mitk::PlaneGeometry::Pointer plane = mitk::PlaneGeometry::New();
+    plane->InitializeStandardPlane(image->GetGeometry(), orientation, slice, true, false);
+    mitk::Vector3D normal = plane->GetNormal();
+    normal.Normalize();
+    plane->SetOrigin(plane->GetOrigin() + normal * 0.5);
+    return plane;
+  }
+
+  long long GetSizeInBytes(const mitk::Image* image)
+  {
+    long long size = image->GetPixelType().GetSize();
+    for (unsigned int i = 0; i < image->GetDimension(); ++i)
+    {
+      size *= image->GetDimension(i);
+    }
+    return size;
+  }
+
+  /** Directory for the files of a benchmark, removed with its contents at the end of the run. */
+  class TemporaryDirectory
+  {
+  public:
+
+    TemporaryDirectory()
+      : m_Path(mitk::IOUtil::CreateTemporaryDirectory("mitkBenchmark_XXXXXX"))
+    {
+    }
+
+    ~TemporaryDirectory()
+    {
+      itksys::SystemTools::RemoveADirectory(m_Path);
+    }
+
+    const std::string& GetPath() const
+    {
+      return m_Path;
+    }
+
+  private:
+
+    const std::string m_Path;
+  };
+
+  /** Writes the image as a series of MR slices, returns the file names. */
+  mitk::StringList WriteDicomSeries(const mitk::Image* image, const std::string& directory)
+  {
+    ItkImageType::Pointer itkImage;
+    mitk::CastToItkImage(image, itkImage);
+    const unsigned int slices = itkImage->GetLargestPossibleRegion().GetSize(2);
+
+    itk::NumericSeriesFileNames::Pointer fileNames = itk::NumericSeriesFileNames::New();
+    fileNames->SetSeriesFormat(directory + "/slice%04d.dcm");
+    fileNames->SetStartIndex(0);
+    fileNames->SetEndIndex(slices - 1);
+    fileNames->SetIncrementIndex(1);
+
+    // GDCMImageIO writes the position of 2D slices from the dictionaries only
+    const std::string uidRoot = "1.2.826.0.1.3680043.2.1125.9999";
+    std::vector<itk::MetaDataDictionary> dictionaries(slices);
+    itk::ImageSeriesWriter<ItkImageType, itk::Image<PixelType, 2> >::DictionaryArrayType dictionaryArray;
+    for (unsigned int i = 0; i < slices; ++i)
+    {
+      itk::MetaDataDictionary& dictionary = dictionaries[i];
+      std::ostringstream instance;
+      instance << i + 1;
+      std::ostringstream position;
+      position << "0\\0\\" << i;
+
+      itk::EncapsulateMetaData<std::string>(dictionary, "0008|0016", "1.2.840.10008.5.1.4.1.1.4");
+      itk::EncapsulateMetaData<std::string>(dictionary, "0008|0018", uidRoot + ".3." + instance.str());
+      itk::EncapsulateMetaData<std::string>(dictionary, "0008|0060", "MR");
+      itk::EncapsulateMetaData<std::string>(dictionary, "0020|000d", uidRoot + ".1");
+      itk::EncapsulateMetaData<std::string>(dictionary, "0020|000e", uidRoot + ".2");
+      itk::EncapsulateMetaData<std::string>(dictionary, "0020|0013", instance.str());
+      itk::EncapsulateMetaData<std::string>(dictionary, "0020|0032", position.str());
+      itk::EncapsulateMetaData<std::string>(dictionary, "0020|0037", "1\\0\\0\\0\\1\\0");
+      itk::EncapsulateMetaData<std::string>(dictionary, "0018|0050", "1");
+      itk::EncapsulateMetaData<std::string>(dictionary, "0028|0030", "1\\1");
+      dictionaryArray.push_back(&dictionary);
+    }
+
+    itk::GDCMImageIO::Pointer dicomIO = itk::GDCMImageIO::New();
+    dicomIO->KeepOriginalUIDOn();
+
+    itk::ImageSeriesWriter<ItkImageType, itk::Image<PixelType, 2> >::Pointer writer =
+      itk::ImageSeriesWriter<ItkImageType, itk::Image<PixelType, 2> >::New();
+    writer->SetInput(itkImage);
+    writer->SetImageIO(dicomIO);
+    writer->SetFileNames(fileNames->GetFileNames());
+    writer->SetMetaDataDictionaryArray(&dictionaryArray);
+    writer->Update();
+
+    return fileNames->GetFileNames();
+  }
+
+  template <typename TPixel, unsigned int VImageDimension>
+  void SumPixels(itk::Image<TPixel, VImageDimension>* itkImage, double& sum)
+  {
+    const TPixel* pixel = itkImage->GetBufferPointer();
+    const TPixel* end = pixel + itkImage->GetBufferedRegion().GetNumberOfPixels();
+    for (; pixel != end; ++pixel)
+    {
+      sum += *pixel;
+    }
+  }
+
+  void BM_ExtractSliceFilter_Axial(mitk::BenchmarkState& state)
+  {
+    mitk::Image::Pointer image = CreateImage(state.GetRange());
+    mitk::ExtractSliceFilter::Pointer extractor = mitk::ExtractSliceFilter::New();
+    extractor->SetInput(image);
+
+    long slice = 0;
+    while (state.KeepRunning())
+    {
+      // the filter does not keep a reference to the plane
+      mitk::PlaneGeometry::Pointer plane = CreatePlane(image, mitk::PlaneGeometry::Axial, slice++ % state.GetRange());
+      extractor->SetWorldGeometry(plane);
+      extractor->Modified();
+      extractor->Update();
+      g_Sink = extractor->GetOutput()->GetDimension(0);
+    }
+    state.SetItemsProcessed(state.GetIterations());
+    state.SetBytesProcessed(state.GetIterations() * GetSizeInBytes(image) / state.GetRange());
+  }
+  MITK_BENCHMARK(BM_ExtractSliceFilter_Axial)->Arg(64)->Arg(256);
+
+  // sagittal slices are spread over the whole buffer
+  void BM_ExtractSliceFilter_Sagittal(mitk::BenchmarkState& state)
+  {
+    mitk::Image::Pointer image = CreateImage(state.GetRange());
+    mitk::ExtractSliceFilter::Pointer extractor = mitk::ExtractSliceFilter::New();
+    extractor->SetInput(image);
+
+    long slice = 0;
+    while (state.KeepRunning())
+    {
+      // the filter does not keep a reference to the plane
+      mitk::PlaneGeometry::Pointer plane = CreatePlane(image, mitk::PlaneGeometry::Sagittal, slice++ % state.GetRange());
+      extractor->SetWorldGeometry(plane);
+      extractor->Modified();
+      extractor->Update();
+      g_Sink = extractor->GetOutput()->GetDimension(0);
+    }
+    state.SetItemsProcessed(state.GetIterations());
+    state.SetBytesProcessed(state.GetIterations() * GetSizeInBytes(image) / state.GetRange());
+  }
+  MITK_BENCHMARK(BM_ExtractSliceFilter_Sagittal)->Arg(64)->Arg(256);
+
+  // renders the same slice with a changing level window, requires an OpenGL context
+  void BM_ImageVtkMapper2D_LevelWindow(mitk::BenchmarkState& state)
+  {
+    mitk::RenderingTestHelper renderingHelper(512, 512);
+    renderingHelper.GetVtkRenderWindow()->SetOffScreenRendering(1);
+
+    mitk::DataNode::Pointer node = mitk::DataNode::New();
+    node->SetData(CreateImage(state.GetRange()));
+    renderingHelper.AddNodeToStorage(node);
+    renderingHelper.Render();
+
+    int window = 100;
+    while (state.KeepRunning())
+    {
+      window = window % 2000 + 100;
+      node->SetProperty("levelwindow", mitk::LevelWindowProperty::New(mitk::LevelWindow(500, window)));
+      renderingHelper.Render();
+    }
+    state.SetItemsProcessed(state.GetIterations());
+  }
+  MITK_BENCHMARK(BM_ImageVtkMapper2D_LevelWindow)->Arg(256);
+
+  void BM_AccessByItk(mitk::BenchmarkState& state)
+  {
+    mitk::Image::Pointer image = CreateImage(state.GetRange());
+
+    while (state.KeepRunning())
+    {
+      double sum = 0;
+      AccessByItk_1(image, SumPixels, sum);
+      g_Sink = sum;
+    }
+    state.SetBytesProcessed(state.GetIterations() * GetSizeInBytes(image));
+  }
+  MITK_BENCHMARK(BM_AccessByItk)->Arg(64)->Arg(256);
+
+  void BM_CastToItkImage_Float(mitk::BenchmarkState& state)
+  {
+    mitk::Image::Pointer image = CreateImage(state.GetRange());
+
+    while (state.KeepRunning())
+    {
+      itk::Image<float, 3>::Pointer itkImage;
+      mitk::CastToItkImage(image, itkImage);
+      g_Sink = *itkImage->GetBufferPointer();
+    }
+    state.SetBytesProcessed(state.GetIterations() * GetSizeInBytes(image));
+  }
+  MITK_BENCHMARK(BM_CastToItkImage_Float)->Arg(64)->Arg(256);
+
+  void BM_ImageStatisticsCalculator(mitk::BenchmarkState& state)
+  {
+    mitk::Image::Pointer image = CreateImage(state.GetRange());
+
+    while (state.KeepRunning())
+    {
+      // the calculator keeps its results until the image is modified
+      mitk::ImageStatisticsCalculator::Pointer calculator = mitk::ImageStatisticsCalculator::New();
+      calculator->SetImage(image);
+      calculator->SetMaskingModeToNone();
+      calculator->ComputeStatistics();
+      g_Sink = calculator->GetStatistics().GetMean();
+    }
+    state.SetBytesProcessed(state.GetIterations() * GetSizeInBytes(image));
+  }
+  MITK_BENCHMARK(BM_ImageStatisticsCalculator)->Arg(64)->Arg(256);
+
+  void BM_ImageToSurfaceFilter(mitk::BenchmarkState& state)
+  {
+    mitk::Image::Pointer segmentation = CreateSegmentation(state.GetRange());
+    mitk::ImageToSurfaceFilter::Pointer filter = mitk::ImageToSurfaceFilter::New();
+    filter->SetInput(segmentation);
+
+    while (state.KeepRunning())
+    {
+      filter->Modified();
+      filter->Update();
+      g_Sink = filter->GetOutput()->GetVtkPolyData()->GetNumberOfCells();
+    }
+    state.SetBytesProcessed(state.GetIterations() * GetSizeInBytes(segmentation));
+  }
+  MITK_BENCHMARK(BM_ImageToSurfaceFilter)->Arg(64)->Arg(256);
+
+  void BM_IOUtil_LoadNrrd(mitk::BenchmarkState& state)
+  {
+    TemporaryDirectory directory;
+    const std::string fileName = directory.GetPath() + "/image.nrrd";
+    mitk::Image::Pointer image = CreateImage(state.GetRange());
+    mitk::IOUtil::Save(image, fileName);
+
+    while (state.KeepRunning())
+    {
+      g_Sink = mitk::IOUtil::LoadImage(fileName)->GetDimension(2);
+    }
+    state.SetBytesProcessed(state.GetIterations() * GetSizeInBytes(image));
+  }
+  MITK_BENCHMARK(BM_IOUtil_LoadNrrd)->Arg(64)->Arg(256);
+
+  void BM_DICOMReader_Load(mitk::BenchmarkState& state)
+  {
+    TemporaryDirectory directory;
+    mitk::Image::Pointer image = CreateImage(state.GetRange());
+    const mitk::StringList fileNames = WriteDicomSeries(image, directory.GetPath());
+
+    while (state.KeepRunning())
+    {
+      mitk::ClassicDICOMSeriesReader::Pointer reader = mitk::ClassicDICOMSeriesReader::New();
+      reader->SetInputFiles(fileNames);
+      reader->AnalyzeInputFiles();
+      if (reader->GetNumberOfOutputs() != 1 || !reader->LoadImages())
+      {
+        state.SkipWithError("The synthetic series was not read as a single image");
+        break;
+      }
+      g_Sink = reader->GetOutput(0).GetMitkImage()->GetDimension(2);
+    }
+    state.SetItemsProcessed(state.GetIterations() * fileNames.size());
+    state.SetBytesProcessed(state.GetIterations() * GetSizeInBytes(image));
+  }
+  MITK_BENCHMARK(BM_DICOMReader_Load)->Arg(64)->Arg(256);
+
+  // writes an edited slice back into the segmentation, as SegTool2D does after every stroke
+  void BM_SegmentationWriteBack(mitk::BenchmarkState& state)
+  {
+    mitk::Image::Pointer segmentation = CreateSegmentation(state.GetRange());
+    const long center = state.GetRange() / 2;
+
+    mitk::ExtractSliceFilter::Pointer extractor = mitk::ExtractSliceFilter::New();
+    extractor->SetInput(segmentation);
+    mitk::PlaneGeometry::Pointer centerPlane = CreatePlane(segmentation, mitk::PlaneGeometry::Axial, center);
+    extractor->SetWorldGeometry(centerPlane);
+    extractor->SetResliceTransformByGeometry(segmentation->GetGeometry());
+    extractor->Update();
+    mitk::Image::Pointer slice = extractor->GetOutput();
+
+    vtkSmartPointer<mitkVtkImageOverwrite> reslice = vtkSmartPointer<mitkVtkImageOverwrite>::New();
+    reslice->SetInputSlice(slice->GetVtkImageData());
+    reslice->SetOverwriteMode(true);
+    mitk::ExtractSliceFilter::Pointer writer = mitk::ExtractSliceFilter::New(reslice);
+    writer->SetInput(segmentation);
+    writer->SetVtkOutputRequest(true);
+    writer->SetResliceTransformByGeometry(segmentation->GetGeometry());
+
+    long offset = 0;
+    while (state.KeepRunning())
+    {
+      mitk::PlaneGeometry::Pointer plane = CreatePlane(segmentation, mitk::PlaneGeometry::Axial, (center + offset++) % state.GetRange());
+      writer->SetWorldGeometry(plane);
+      reslice->Modified();
+      writer->Modified();
+      writer->Update();
+      // the image was modified within the pipeline, but not marked so
+      segmentation->Modified();
+      segmentation->GetVtkImageData()->Modified();
+    }
+    state.SetItemsProcessed(state.GetIterations());
+  }
+  MITK_BENCHMARK(BM_SegmentationWriteBack)->Arg(64)->Arg(256);
+}
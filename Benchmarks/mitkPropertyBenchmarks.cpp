@@ -0,0 +1,145 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include "mitkBenchmark.h"
+
+#include <mitkDataNode.h>
+#include <mitkImageGenerator.h>
+#include <mitkImageVtkMapper2D.h>
+#include <mitkProperties.h>
+#include <mitkPropertyKey.h>
+#include <mitkRenderingManager.h>
+#include <mitkSurface.h>
+#include <mitkSurfaceVtkMapper3D.h>
+#include <mitkVtkPropRenderer.h>
+
+#include <vtkRenderWindow.h>
+#include <vtkSmartPointer.h>
+
+#include <sstream>
+#include <vector>
+
+/*
+ * The property lookups of a render pass over a scene: the argument of the
+ * runs is the number of nodes. Image, segmentation and surface nodes carry
+ * the default properties of their mappers, some of them have renderer
+ * specific properties. One iteration looks up, in each of the four renderers
+ * of the standard display, the properties the core mappers and the
+ * VtkPropRenderer read for every node. The lookup by name is the way all
+ * mappers did it before mitk::PropertyKey, the lookup by key is the way the
+ * core mappers do it now.
+ */
+
+namespace
+{
+  volatile unsigned int g_Sink = 0;
+
+  const char* const g_Names[] = {
+    "visible", "layer", "opacity", "color", "binary", "outline binary", "outline width",
+    "texture interpolation", "reslice interpolation", "in plane resample extent by geometry",
+    "Image Rendering.Mode", "Image Rendering.Transfer Function", "levelwindow", "LookupTable",
+    "depthOffset", "helper object", "includeInBoundingBox", "material.representation", "scalar visibility" };
+  const unsigned int g_NumNames = sizeof(g_Names) / sizeof(g_Names[0]);
+
+  struct RenderScene
+  {
+    std::vector<vtkSmartPointer<vtkRenderWindow> > Windows;
+    std::vector<mitk::BaseRenderer::Pointer> Renderers;
+    std::vector<mitk::DataNode::Pointer> Nodes;
+  };
+
+  void CreateScene(long numNodes, RenderScene& scene)
+  {
+    for (int w = 0; w < 4; ++w)
+    {
+      std::ostringstream name;
+      name << "mitkPropertyBenchmarks.widget" << w + 1;
+      vtkSmartPointer<vtkRenderWindow> window = vtkSmartPointer<vtkRenderWindow>::New();
+      mitk::VtkPropRenderer::Pointer renderer = mitk::VtkPropRenderer::New(name.str().c_str(), window, mitk::RenderingManager::GetInstance());
+      renderer->SetMapperID(w < 3 ? mitk::BaseRenderer::Standard2D : mitk::BaseRenderer::Standard3D);
+      scene.Windows.push_back(window);
+      scene.Renderers.push_back(renderer.GetPointer());
+    }
+
+    // the level window defaults are computed once and cached by the image
+    mitk::Image::Pointer image = mitk::ImageGenerator::GenerateRandomImage<short>(16, 16, 16, 1, 1, 1, 1, 3000, -1000);
+
+    for (long i = 0; i < numNodes; ++i)
+    {
+      mitk::DataNode::Pointer node = mitk::DataNode::New();
+      std::ostringstream name;
+      name << "node " << i;
+      node->SetName(name.str());
+
+      if (i % 3 == 2)
+      {
+        node->SetData(mitk::Surface::New());
+        mitk::SurfaceVtkMapper3D::SetDefaultProperties(node);
+      }
+      else
+      {
+        node->SetData(image);
+        if (i % 3 == 1)
+          node->SetBoolProperty("binary", true);
+        mitk::ImageVtkMapper2D::SetDefaultProperties(node);
+      }
+      node->SetIntProperty("layer", static_cast<int>(i));
+
+      // e.g. planes and segmentations hidden or outlined in single windows
+      if (i % 4 == 0)
+        node->SetVisibility(false, scene.Renderers[3]);
+      if (i % 5 == 0)
+        node->SetBoolProperty("outline binary", true, scene.Renderers[0]);
+
+      scene.Nodes.push_back(node);
+    }
+  }
+
+  template <typename KeyType>
+  void RenderPass(mitk::BenchmarkState& state, const std::vector<KeyType>& keys)
+  {
+    RenderScene scene;
+    CreateScene(state.GetRange(), scene);
+
+    while (state.KeepRunning())
+    {
+      unsigned int found = 0;
+      for (std::size_t r = 0; r < scene.Renderers.size(); ++r)
+        for (std::size_t i = 0; i < scene.Nodes.size(); ++i)
+          for (std::size_t k = 0; k < keys.size(); ++k)
+            if (scene.Nodes[i]->GetProperty(keys[k], scene.Renderers[r]) != nullptr)
+              ++found;
+      g_Sink = found;
+    }
+    state.SetItemsProcessed(state.GetIterations() * scene.Renderers.size() * scene.Nodes.size() * keys.size());
+  }
+
+  void BM_DataNode_RenderPass_ByName(mitk::BenchmarkState& state)
+  {
+    std::vector<const char*> names(g_Names, g_Names + g_NumNames);
+    RenderPass(state, names);
+  }
+  MITK_BENCHMARK(BM_DataNode_RenderPass_ByName)->Arg(100)->Arg(1000);
+
+  void BM_DataNode_RenderPass_ByKey(mitk::BenchmarkState& state)
+  {
+    std::vector<mitk::PropertyKey> keys;
+    for (unsigned int n = 0; n < g_NumNames; ++n)
+      keys.push_back(mitk::PropertyKey(g_Names[n]));
+    RenderPass(state, keys);
+  }
+  MITK_BENCHMARK(BM_DataNode_RenderPass_ByKey)->Arg(100)->Arg(1000);
+}
@@ -86,6 +86,15 @@ public:
   */
   virtual bool AppliesTo(const std::string& path) const;
 
+  /**
+  * \brief Checks if AppliesTo() only depends on the extension of the given path.
+  *
+  * The mime-type provider caches the result of AppliesTo() per extension for such
+  * mime-types. The base implementation returns true for plain CustomMimeType
+  * objects only. Child classes which do not peek into the file may override it.
+  */
+  virtual bool AppliesToExtensionOnly() const;
+
   /**
   * \brief Checks if the MimeType can handle the etension of the given path
   *
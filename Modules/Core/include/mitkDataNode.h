@@ -22,6 +22,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 //#include "mitkMapper.h"
 #include "mitkInteractor.h"
 #include "mitkDataInteractor.h"
+#include "mitkLazyDataLoader.h"
 
 #ifdef MBI_NO_STD_NAMESPACE
 #define MBI_STD
@@ -40,6 +41,9 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 #include <map>
 #include <set>
+#include <atomic>
+
+#include <itkSimpleFastMutexLock.h>
 #include "mitkLevelWindow.h"
 
 class vtkLinearTransform;
@@ -88,9 +92,34 @@ public:
   /**
    * \brief Get the data object (instance of BaseData, e.g., an Image)
    * managed by this DataNode
+   *
+   * If a LazyDataLoader was set, the first call reads the data. Concurrent
+   * calls wait for it, the data is read once.
    */
   BaseData* GetData() const;
 
+  /**
+   * \brief Set a loader that reads the data object on the first call of GetData()
+   *
+   * Used to open scenes without reading the data of all nodes. Replaces the
+   * current data object; SetData() discards the loader. The default properties
+   * of the data type are not set when the data is loaded, the loader is
+   * expected to come with a complete property list.
+   */
+  void SetDataLoader(LazyDataLoader* loader);
+
+  /**
+   * \brief The loader that will read the data object, NULL if there is none or the data was read already.
+   */
+  LazyDataLoader* GetDataLoader() const;
+
+  /**
+   * \brief False while the data object of a LazyDataLoader was not read.
+   *
+   * Lets code that only inspects nodes, like predicates, avoid reading data.
+   */
+  bool IsDataLoaded() const;
+
   /**
    * \brief Get the transformation applied prior to displaying the data as
    * a vtkTransform
@@ -219,6 +248,13 @@ public:
    */
   mitk::BaseProperty* GetProperty(const char *propertyKey, const mitk::BaseRenderer* renderer = nullptr) const;
 
+  /**
+   * \brief Same as GetProperty(const char*, const mitk::BaseRenderer*), but with an interned key
+   *
+   * Faster than the lookup by name, see PropertyKey.
+   */
+  mitk::BaseProperty* GetProperty(const PropertyKey& propertyKey, const mitk::BaseRenderer* renderer = nullptr) const;
+
   /**
    * \brief Get the property of type T with key \a propertyKey from the PropertyList
    * of the \a renderer, if available there, otherwise use the BaseRenderer-independent PropertyList.
@@ -282,6 +318,11 @@ public:
    */
   bool GetBoolProperty(const char* propertyKey, bool &boolValue, const mitk::BaseRenderer* renderer = nullptr) const;
 
+  /**
+   * \brief Same as GetBoolProperty(const char*, bool&, const mitk::BaseRenderer*), but with an interned key
+   */
+  bool GetBoolProperty(const PropertyKey& propertyKey, bool &boolValue, const mitk::BaseRenderer* renderer = nullptr) const;
+
   /**
    * \brief Convenience access method for int properties (instances of
    * IntProperty)
@@ -289,6 +330,11 @@ public:
    */
   bool GetIntProperty(const char* propertyKey, int &intValue, const mitk::BaseRenderer* renderer=nullptr) const;
 
+  /**
+   * \brief Same as GetIntProperty(const char*, int&, const mitk::BaseRenderer*), but with an interned key
+   */
+  bool GetIntProperty(const PropertyKey& propertyKey, int &intValue, const mitk::BaseRenderer* renderer=nullptr) const;
+
   /**
    * \brief Convenience access method for float properties (instances of
    * FloatProperty)
@@ -314,12 +360,19 @@ public:
    */
   bool GetStringProperty(const char* propertyKey, std::string& string, const mitk::BaseRenderer* renderer = nullptr) const;
 
+  /**
+   * \brief Convenience access method for color properties (instances of
+   * ColorProperty) with property-key "color"
+   * \return \a true property was found
+   */
+  bool GetColor(float rgb[3], const mitk::BaseRenderer* renderer = nullptr) const;
+
   /**
    * \brief Convenience access method for color properties (instances of
    * ColorProperty)
    * \return \a true property was found
    */
-  bool GetColor(float rgb[3], const mitk::BaseRenderer* renderer = nullptr, const char* propertyKey = "color") const;
+  bool GetColor(float rgb[3], const mitk::BaseRenderer* renderer, const char* propertyKey) const;
 
   /**
    * \brief Convenience access method for level-window properties (instances of
@@ -393,17 +446,30 @@ public:
    * \return \a true property was found
    * \sa IsVisible
    */
-  bool GetVisibility(bool &visible, const mitk::BaseRenderer* renderer, const char* propertyKey = "visible") const
+  bool GetVisibility(bool &visible, const mitk::BaseRenderer* renderer, const char* propertyKey) const
   {
     return GetBoolProperty(propertyKey, visible, renderer);
   }
 
+  /**
+   * \brief Convenience access method for the visibility property with property-key "visible"
+   * \return \a true property was found
+   */
+  bool GetVisibility(bool &visible, const mitk::BaseRenderer* renderer) const;
+
+  /**
+   * \brief Convenience access method for opacity properties (instances of
+   * FloatProperty) with property-key "opacity"
+   * \return \a true property was found
+   */
+  bool GetOpacity(float &opacity, const mitk::BaseRenderer* renderer) const;
+
   /**
    * \brief Convenience access method for opacity properties (instances of
    * FloatProperty)
    * \return \a true property was found
    */
-  bool GetOpacity(float &opacity, const mitk::BaseRenderer* renderer, const char* propertyKey = "opacity") const;
+  bool GetOpacity(float &opacity, const mitk::BaseRenderer* renderer, const char* propertyKey) const;
 
   /**
    * \brief Convenience access method for boolean properties (instances
@@ -422,6 +488,15 @@ public:
     return defaultIsOn;
   }
 
+  /**
+   * \brief Same as IsOn(const char*, const mitk::BaseRenderer*, bool), but with an interned key
+   */
+  bool IsOn(const PropertyKey& propertyKey, const mitk::BaseRenderer* renderer, bool defaultIsOn = true) const
+  {
+    GetBoolProperty(propertyKey, defaultIsOn, renderer);
+    return defaultIsOn;
+  }
+
   /**
    * \brief Convenience access method for visibility properties (instances
    * of BoolProperty). Return value is the visibility. Default is
@@ -433,11 +508,18 @@ public:
    * \sa GetVisibility
    * \sa IsOn
    */
-  bool IsVisible(const mitk::BaseRenderer* renderer, const char* propertyKey = "visible", bool defaultIsOn = true) const
+  bool IsVisible(const mitk::BaseRenderer* renderer, const char* propertyKey, bool defaultIsOn = true) const
   {
     return IsOn(propertyKey, renderer, defaultIsOn);
   }
 
+  /**
+   * \brief Visibility of the node according to the property with property-key "visible",
+   * true if the property is not found
+   * \sa IsVisible(const mitk::BaseRenderer*, const char*, bool)
+   */
+  bool IsVisible(const mitk::BaseRenderer* renderer) const;
+
   /**
    * \brief Convenience method for setting color properties (instances of
    * ColorProperty)
@@ -550,6 +632,14 @@ protected:
   /// Invoked when the property list was modified. Calls Modified() of the DataNode
   virtual void PropertyListModified(const itk::Object *caller, const itk::EventObject &event);
 
+  /// Takes m_Data from m_DataLoader and removes the loader, m_DataLoaderMutex has to be locked
+  void LoadData();
+
+  /// Looks propertyKey up in the list of renderer, if available there, otherwise in the renderer independent list.
+  /// KeyType is std::string or PropertyKey, only instantiated in mitkDataNode.cpp
+  template <typename KeyType>
+  mitk::BaseProperty* FindProperty(const KeyType& propertyKey, const mitk::BaseRenderer* renderer) const;
+
   /// \brief Mapper-slots
   mutable MapperVector m_Mappers;
 
@@ -578,6 +668,15 @@ protected:
   /// \brief Timestamp of the last change of m_Data
   itk::TimeStamp m_DataReferenceChangedTime;
 
+  /// \brief Reads m_Data on the first call of GetData(), see SetDataLoader()
+  LazyDataLoader::Pointer m_DataLoader;
+
+  /// \brief False while m_DataLoader is set, lets GetData() skip the lock once the data was read
+  std::atomic<bool> m_DataLoaded;
+
+  /// \brief Guards m_DataLoader, so that concurrent GetData() calls read the data once
+  mutable itk::SimpleFastMutexLock m_DataLoaderMutex;
+
   unsigned long m_PropertyListModifiedObserverTag;
 };
 
@@ -26,6 +26,8 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "mitkGeometry3D.h"
 #include "itkSimpleFastMutexLock.h"
 #include <map>
+#include <set>
+#include <vector>
 
 namespace mitk {
 
@@ -101,7 +103,9 @@ namespace mitk {
     //## (see definition of NodePredicateBase for details).
     //## The method returns a set of SmartPointers to the DataNodes that fulfill the
     //## conditions. A set of all objects can be retrieved with the GetAll() method;
-    SetOfObjects::ConstPointer GetSubset(const NodePredicateBase* condition) const;
+    //## Subclasses may use indices to restrict the set of nodes the condition is evaluated on,
+    //## but must return the same result as checking the condition on all nodes.
+    virtual SetOfObjects::ConstPointer GetSubset(const NodePredicateBase* condition) const;
 
     //##Documentation
     //## @brief returns a set of source objects for a given node that meet the given condition(s).
@@ -249,6 +253,84 @@ namespace mitk {
 
     DataStorageEvent InteractorChangedNodeEvent;
 
+    //##Documentation
+    //## @brief Nodes of the events that were collected between BeginBatch() and EndBatch()
+    //##
+    //## Every node is listed at most once per event type. Nodes that were added and removed
+    //## within the batch are not listed at all, changes of added or removed nodes are not listed.
+    struct BatchedNodeEvents
+    {
+      std::vector<mitk::DataNode::ConstPointer> AddedNodes;
+      std::vector<mitk::DataNode::ConstPointer> RemovedNodes;
+      std::vector<mitk::DataNode::ConstPointer> ChangedNodes;
+    };
+    typedef Message1<const BatchedNodeEvents&> DataStorageBatchEvent;
+
+    //##Documentation
+    //## @brief BatchNodeEvent is emitted once at the end of a batch (see BeginBatch()).
+    //##
+    //## It is emitted before the deferred AddNodeEvent, RemoveNodeEvent and ChangedNodeEvent
+    //## of the batch are sent. Observers that handle the whole batch here can ignore these
+    //## single events while IsDeliveringBatch() returns true.
+    DataStorageBatchEvent BatchNodeEvent;
+
+    //##Documentation
+    //## @brief Starts collecting AddNodeEvent, RemoveNodeEvent and ChangedNodeEvent instead of sending them
+    //##
+    //## Batches can be nested, the collected events are sent when the outermost batch is ended:
+    //## first BatchNodeEvent, then RemoveNodeEvent, AddNodeEvent and ChangedNodeEvent for every
+    //## node of the batch. As a consequence, RemoveNodeEvent is sent after the node was removed.
+    //## DeleteNodeEvent and InteractorChangedNodeEvent are never deferred. Use BatchScope to make
+    //## sure that every BeginBatch() is matched by an EndBatch().
+    void BeginBatch();
+
+    //##Documentation
+    //## @brief Ends a batch started with BeginBatch() and sends the collected events if it was the outermost one
+    //##
+    //## Throws std::logic_error if no batch was started.
+    void EndBatch();
+
+    //##Documentation
+    //## @brief Returns true between BeginBatch() and the matching EndBatch()
+    bool IsBatching() const;
+
+    //##Documentation
+    //## @brief Returns true while the single events of a finished batch are sent
+    bool IsDeliveringBatch() const;
+
+    //##Documentation
+    //## @brief Calls BeginBatch() on construction and EndBatch() on destruction
+    //##
+    //## \code
+    //## {
+    //##   mitk::DataStorage::BatchScope batch(dataStorage);
+    //##   for (...)
+    //##     dataStorage->Add(node);
+    //## } // observers are notified here
+    //## \endcode
+    class BatchScope
+    {
+    public:
+      explicit BatchScope(DataStorage* dataStorage)
+        : m_DataStorage(dataStorage)
+      {
+        if (m_DataStorage.IsNotNull())
+          m_DataStorage->BeginBatch();
+      }
+
+      ~BatchScope()
+      {
+        if (m_DataStorage.IsNotNull())
+          m_DataStorage->EndBatch();
+      }
+
+    private:
+      BatchScope(const BatchScope&);
+      BatchScope& operator=(const BatchScope&);
+
+      DataStorage::Pointer m_DataStorage;
+    };
+
 
     //##Documentation
     //## @brief Compute the axis-parallel bounding geometry of the input objects
@@ -368,6 +450,19 @@ namespace mitk {
     //## If the cast succeeds the ChangedNodeEvent is emitted with this node.
     void OnNodeModifiedOrDeleted( const itk::Object *caller, const itk::EventObject &event );
 
+    //##Documentation
+    //## @brief Types of the events that are collected during a batch
+    enum BatchedEventType
+    {
+      BatchedAddEvent,
+      BatchedRemoveEvent,
+      BatchedChangedEvent
+    };
+
+    //##Documentation
+    //## @brief Adds the event to the current batch. Returns false if no batch is open, i.e. the event has to be sent now.
+    bool AddToBatch(BatchedEventType type, const mitk::DataNode* node);
+
     //##Documentation
     //## @brief  Adds a Modified-Listener to the given Node.
     void AddListeners(const mitk::DataNode* _Node);
@@ -394,6 +489,17 @@ namespace mitk {
     //## to suppress NodeChangedEvent to be emitted.
     bool m_BlockNodeModifiedEvents;
 
+    //##Documentation
+    //## @brief Number of open batches, events are collected in m_Batch while it is not 0
+    unsigned int m_BatchDepth;
+    bool m_DeliveringBatch;
+    BatchedNodeEvents m_Batch;
+    //##Documentation
+    //## @brief The nodes of m_Batch, to deduplicate the events
+    std::set<const mitk::DataNode*> m_BatchedAddedNodes;
+    std::set<const mitk::DataNode*> m_BatchedRemovedNodes;
+    std::set<const mitk::DataNode*> m_BatchedChangedNodes;
+
     //##Documentation
     //## @brief Standard Constructor for ::New() instantiation
     DataStorage();
@@ -228,7 +228,24 @@ public:
    */
   static DataStorage::SetOfObjects::Pointer Load(const std::vector<std::string>& paths, DataStorage& storage);
 
-  static std::vector<BaseData::Pointer> Load(const std::vector<std::string>& paths);
+  /**
+   * @brief Loads a list of file paths, optionally in parallel.
+   *
+   * Each file is read with its default reader. The result keeps the order of
+   * \c paths. If an entry cannot be loaded, the remaining entries are still
+   * loaded and an exception is thrown afterwards.
+   *
+   * The files are read one after another by default. More threads may only be
+   * used if the readers of all files are safe to run concurrently; in particular
+   * they must not change the locale of the process (see mitk::LocaleSwitch),
+   * which some readers still do by calling setlocale().
+   *
+   * @param paths A list of absolute file names including the file extension.
+   * @param numberOfThreads The number of threads that read the files, 1 reads them in the calling thread.
+   * @return The loaded BaseData objects.
+   * @throws mitk::Exception if an entry in \c paths could not be loaded.
+   */
+  static std::vector<BaseData::Pointer> Load(const std::vector<std::string>& paths, unsigned int numberOfThreads = 1);
 
   /**
    * Load files in <code>fileNames</code> and add the constructed mitk::DataNode instances
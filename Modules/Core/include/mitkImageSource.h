@@ -134,6 +134,10 @@ public:
   virtual vtkImageData* GetVtkImageData();
   virtual const vtkImageData* GetVtkImageData() const;
 
+  /** @brief Updates the output like ProcessObject::UpdateOutputData(), traced
+   * as a zone named after the filter class (see mitk::Tracing). */
+  virtual void UpdateOutputData(itk::DataObject* output) override;
+
 protected:
   ImageSource();
   virtual ~ImageSource() {}
@@ -0,0 +1,69 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#ifndef mitkLazyDataLoader_h
+#define mitkLazyDataLoader_h
+
+#include <MitkCoreExports.h>
+#include "mitkBaseData.h"
+
+namespace mitk
+{
+
+/**
+ * \brief Reads the BaseData of a DataNode when it is accessed for the first time.
+ *
+ * A DataNode with a loader (see DataNode::SetDataLoader()) calls Load() from
+ * the first GetData() and keeps the result. Until then, predicates and indices
+ * can ask GetDataType() without reading the data.
+ *
+ * Load() may be called from a prefetch thread before the node asks for the
+ * data, implementations must therefore be thread safe and return the same
+ * object on every call.
+ *
+ * \ingroup DataManagement
+ */
+class MITKCORE_EXPORT LazyDataLoader : public itk::Object
+{
+public:
+
+  mitkClassMacroItkParent(LazyDataLoader, itk::Object)
+
+  /**
+   * \brief Class name of the BaseData that Load() will return, e.g. "Image".
+   */
+  virtual std::string GetDataType() const = 0;
+
+  /**
+   * \brief Reads the data, or returns the data read by a previous call.
+   * \return NULL if the data could not be read
+   */
+  virtual BaseData::Pointer Load() = 0;
+
+protected:
+
+  LazyDataLoader() {}
+  virtual ~LazyDataLoader() {}
+
+private:
+
+  LazyDataLoader(const LazyDataLoader&);
+  LazyDataLoader& operator=(const LazyDataLoader&);
+};
+
+}
+
+#endif
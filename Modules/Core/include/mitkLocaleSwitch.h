@@ -15,46 +15,48 @@ See LICENSE.txt or http://www.mitk.org for details.
 ===================================================================*/
 
 
-
 #ifndef MITKLOCALESWITCH_H_
 #define MITKLOCALESWITCH_H_
 
 #include <MitkCoreExports.h>
-#include <clocale>
+
+#include <string>
 
 namespace mitk {
 
-struct MITKCORE_EXPORT LocaleSwitch
+/**
+ * \brief Convenience class to temporarily change the C locale of the current thread.
+ *
+ * Helper class that can be used to switch to a specific locale for a limited scope,
+ * e.g. the "C" locale while numbers are parsed or written. The previous locale is
+ * restored when the LocaleSwitch is destroyed.
+ *
+ * Only the locale of the calling thread is changed (uselocale() on POSIX systems and
+ * a per-thread locale on Windows), so readers and writers using LocaleSwitch can run
+ * in parallel without changing the locale of other threads. Calling setlocale()
+ * directly changes the locale of the whole process instead.
+ *
+ * \code
+ * {
+ *   LocaleSwitch localeSwitch("C");
+ *   // locale independent parsing of numbers
+ * }
+ * \endcode
+ */
+class MITKCORE_EXPORT LocaleSwitch
 {
-  LocaleSwitch(const std::string& newLocale)
-    : m_OldLocale(std::setlocale(LC_ALL, nullptr))
-    , m_NewLocale(newLocale)
-  {
-    if (m_OldLocale == nullptr)
-    {
-      m_OldLocale = "";
-    }
-    else if (m_NewLocale != m_OldLocale)
-    {
-      // set the locale
-      if (std::setlocale(LC_ALL, m_NewLocale.c_str()) == nullptr)
-      {
-        MITK_INFO << "Could not set locale " << m_NewLocale;
-        m_OldLocale = nullptr;
-      }
-    }
-  }
-  ~LocaleSwitch()
-  {
-    if (m_OldLocale != nullptr && std::setlocale(LC_ALL, m_OldLocale) == nullptr)
-    {
-      MITK_INFO << "Could not reset locale " << m_OldLocale;
-    }
-  }
+public:
+  explicit LocaleSwitch(const std::string& newLocale);
+  ~LocaleSwitch();
+
 private:
-  const char* m_OldLocale;
-  const std::string m_NewLocale;
+  LocaleSwitch(const LocaleSwitch&);
+  LocaleSwitch& operator=(const LocaleSwitch&);
+
+  struct Impl;
+  Impl* m_LocaleSwitchImpl;
 };
+
 }
 
 #endif // MITKLOCALESWITCH_H_
@@ -75,6 +75,9 @@ public:
   /** @See mitk::CustomMimeType::AppliesTo()*/
   bool AppliesTo(const std::string& path) const;
 
+  /** @See mitk::CustomMimeType::AppliesToExtensionOnly()*/
+  bool AppliesToExtensionOnly() const;
+
   /** @See mitk::CustomMimeType::MatchesExtension()*/
   bool MatchesExtension(const std::string& path) const;
 
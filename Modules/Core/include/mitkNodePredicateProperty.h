@@ -50,6 +50,18 @@ namespace mitk {
       //## @brief Checks, if the nodes contains a property that is equal to m_ValidProperty
       virtual bool CheckNode(const mitk::DataNode* node) const override;
 
+      //##Documentation
+      //## @brief Name of the checked property
+      const std::string& GetPropertyName() const { return m_ValidPropertyName; }
+
+      //##Documentation
+      //## @brief Property value the node's property is compared to, NULL if only the existence is checked
+      const mitk::BaseProperty* GetValidProperty() const { return m_ValidProperty; }
+
+      //##Documentation
+      //## @brief Renderer whose renderer-specific property is checked, NULL for the renderer unspecific property
+      const mitk::BaseRenderer* GetRenderer() const { return m_Renderer; }
+
     protected:
       //##Documentation
       //## @brief Constructor to check for a named property
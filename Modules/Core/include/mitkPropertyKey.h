@@ -0,0 +1,75 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#ifndef mitkPropertyKey_h
+#define mitkPropertyKey_h
+
+#include <MitkCoreExports.h>
+#include <string>
+
+namespace mitk
+{
+  /**
+   * \brief Interned name of a property.
+   *
+   * Every property name is stored once in a global table and a PropertyKey refers to its entry in
+   * this table. Comparing keys compares integers instead of strings, and looking a property up by
+   * key does not construct a std::string from the name. Keys are meant for a fixed set of names
+   * that are looked up often, e.g. in every render pass, and should be created once:
+   *
+   * \code
+   * static const mitk::PropertyKey visibleKey("visible");
+   * bool visible = true;
+   * node->GetBoolProperty(visibleKey, visible, renderer);
+   * \endcode
+   *
+   * Keys are never removed from the table. Reading the table, i.e. Find() and GetName(), does not
+   * lock; interning a new name copies the table and is therefore comparatively expensive.
+   */
+  class MITKCORE_EXPORT PropertyKey
+  {
+  public:
+    typedef unsigned int IdType;
+
+    /** \brief Interns name, i.e. adds it to the table if it is not yet contained. */
+    explicit PropertyKey(const char* name);
+    explicit PropertyKey(const std::string& name);
+
+    /** \brief Returns the key of name without interning it, IsValid() is false if name was never interned. */
+    static PropertyKey Find(const std::string& name);
+
+    bool IsValid() const { return m_Id != InvalidId; }
+    IdType GetId() const { return m_Id; }
+
+    /** \brief The interned name, empty for invalid keys. */
+    const std::string& GetName() const;
+
+    bool operator==(const PropertyKey& other) const { return m_Id == other.m_Id; }
+    bool operator!=(const PropertyKey& other) const { return m_Id != other.m_Id; }
+    bool operator<(const PropertyKey& other) const { return m_Id < other.m_Id; }
+
+  private:
+    static const IdType InvalidId = static_cast<IdType>(-1);
+
+    PropertyKey() : m_Id(InvalidId), m_Name(nullptr) {}
+    PropertyKey(IdType id, const std::string* name) : m_Id(id), m_Name(name) {}
+
+    IdType m_Id;
+    const std::string* m_Name;
+  };
+}
+
+#endif
@@ -21,11 +21,13 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "mitkBaseProperty.h"
 #include "mitkGenericProperty.h"
 #include "mitkUIDGenerator.h"
+#include "mitkPropertyKey.h"
 
 #include <itkObjectFactory.h>
 
 #include <string>
 #include <map>
+#include <vector>
 
 namespace mitk {
 
@@ -86,6 +88,15 @@ class MITKCORE_EXPORT PropertyList : public itk::Object
      */
     mitk::BaseProperty* GetProperty(const std::string& propertyKey) const;
 
+    /**
+     * @brief Get a property by its interned name.
+     *
+     * Looks the property up by the integer id of the key, which is considerably faster than
+     * comparing strings. Use this in code that is executed often, e.g. for every node in
+     * every render pass.
+     */
+    mitk::BaseProperty* GetProperty(const PropertyKey& propertyKey) const;
+
     /**
      * @brief Set a property in the list/map by value.
      *
@@ -254,6 +265,20 @@ class MITKCORE_EXPORT PropertyList : public itk::Object
 
   private:
 
+    /**
+     * @brief Lookup index: the properties of m_Properties sorted by the id of their interned key.
+     *
+     * The index shares the ownership of the properties with m_Properties. Every method of this
+     * class that adds, replaces or removes an entry of m_Properties updates the index.
+     */
+    typedef std::vector< std::pair<PropertyKey::IdType, BaseProperty::Pointer> > PropertyIndex;
+    PropertyIndex m_PropertyIndex;
+
+    /**
+     * @brief Sets the indexed property of propertyKey, removes it from the index if property is NULL.
+     */
+    void UpdateIndex(const std::string& propertyKey, BaseProperty* property);
+
     virtual itk::LightObject::Pointer InternalClone() const override;
 
 };
@@ -21,7 +21,10 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "mitkDataStorage.h"
 #include "mitkMessage.h"
 #include "itkVectorContainer.h"
+#include "itkCommand.h"
 #include <map>
+#include <set>
+#include <vector>
 
 namespace mitk {
 
@@ -89,6 +92,24 @@ namespace mitk {
     //##
     SetOfObjects::ConstPointer GetAll() const override;
 
+    //##Documentation
+    //## @brief returns a set of data objects that meet the given condition(s)
+    //##
+    //## The nodes are looked up in indices of their name, their data type and the
+    //## properties registered with AddPropertyIndex() if the condition is a
+    //## NodePredicateDataType, a renderer unspecific NodePredicateProperty on an indexed
+    //## property, or a NodePredicateAnd/NodePredicateOr of those. The condition is then only
+    //## checked on the indexed candidates, otherwise on all nodes. The result is the same
+    //## (including its order) as the one of DataStorage::GetSubset().
+    SetOfObjects::ConstPointer GetSubset(const NodePredicateBase* condition) const override;
+
+    //##Documentation
+    //## @brief Maintains an index of the renderer unspecific property propertyKey
+    //##
+    //## Bool and string properties are indexed by value, properties of other types only
+    //## by their existence. The "name" property is always indexed.
+    void AddPropertyIndex(const std::string& propertyKey);
+
     /*ITK Mutex */
     mutable itk::SimpleFastMutexLock m_Mutex;
 
@@ -127,6 +148,59 @@ namespace mitk {
     //##Documentation
     //## @brief Nodes are stored in reverse relation for easier traversal in the opposite direction of the relation
     AdjacencyList m_DerivedNodes;
+
+    //##Documentation
+    //## @brief set of nodes ordered like m_SourceNodes, so that indexed results keep the order of GetAll()
+    typedef std::set<const mitk::DataNode*> NodeSet;
+    //##Documentation
+    //## @brief nodes by indexed value
+    typedef std::map<std::string, NodeSet> ValueIndex;
+
+    //##Documentation
+    //## @brief values a node is currently indexed with and the observers that invalidate them
+    struct IndexEntry
+    {
+      IndexEntry() : NodeObserverTag(0) {}
+
+      std::string DataType;
+      std::map<std::string, std::string> PropertyValues;
+      std::vector<std::pair<mitk::BaseProperty::Pointer, unsigned long> > PropertyObserverTags;
+      unsigned long NodeObserverTag;
+    };
+    typedef std::map<const mitk::DataNode*, IndexEntry> IndexEntries;
+
+    //##Documentation
+    //## @brief adds node to the indices, called with m_Mutex locked
+    void AddToIndex(const mitk::DataNode* node);
+    //##Documentation
+    //## @brief removes node from the indices, called with m_Mutex locked
+    void RemoveFromIndex(const mitk::DataNode* node);
+    //##Documentation
+    //## @brief re-reads the indexed values of all outdated nodes, called with m_IndexMutex locked
+    void UpdateIndex() const;
+    //##Documentation
+    //## @brief removes the values and property observers of entry from the indices, called with m_IndexMutex locked
+    void ClearIndexEntry(const mitk::DataNode* node, IndexEntry& entry) const;
+    //##Documentation
+    //## @brief collects the nodes that may fulfil condition from the indices, returns false if condition cannot be indexed
+    bool GetIndexedCandidates(const NodePredicateBase* condition, NodeSet& candidates) const;
+    //##Documentation
+    //## @brief marks the node (or the nodes of the property) that sent a ModifiedEvent as outdated
+    void OnIndexedObjectModified(const itk::Object* caller, const itk::EventObject& event);
+
+    //##Documentation
+    //## @brief guards all index members, never held while events are sent
+    mutable itk::SimpleFastMutexLock m_IndexMutex;
+    mutable IndexEntries m_IndexEntries;
+    mutable NodeSet m_OutdatedIndexEntries;
+    mutable ValueIndex m_DataTypeIndex;
+    //##Documentation
+    //## @brief value indices of the indexed properties. An empty value stands for properties that are neither bool nor string
+    mutable std::map<std::string, ValueIndex> m_PropertyIndices;
+    //##Documentation
+    //## @brief nodes by the indexed property objects they contain
+    mutable std::multimap<const itk::Object*, const mitk::DataNode*> m_IndexedProperties;
+    itk::Command::Pointer m_IndexModifiedCommand;
   };
 } // namespace mitk
 #endif /* MITKSTANDALONEDATASTORAGE_H_HEADER_INCLUDED_ */
@@ -0,0 +1,169 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#ifndef mitkTracing_h
+#define mitkTracing_h
+
+#include <MitkCoreExports.h>
+
+#include <cstddef>
+#include <iosfwd>
+#include <map>
+#include <string>
+
+namespace mitk
+{
+
+/**
+ * \brief Records where the time goes in the running threads.
+ *
+ * Code marks the regions of interest with MITK_TRACE_ZONE. While tracing is
+ * enabled, every zone records its name, category, thread and begin and end
+ * time into a ring buffer of its thread. The buffers are written without
+ * locks; when a buffer is full, the oldest events of the thread are
+ * overwritten. The buffer of a thread that ends is reused by the next new
+ * thread, so its events continue the track of the ended thread. While
+ * tracing is disabled, a zone costs a single atomic load, so the
+ * instrumentation is compiled into release builds.
+ *
+ * The recorded events can be written in the Chrome trace event format, to be
+ * opened in chrome://tracing, or summarized per zone name.
+ *
+ * If the environment variable MITK_TRACE_FILE is set, tracing is enabled when
+ * the Core module is loaded and the trace is written to the file named by the
+ * variable when the module is unloaded.
+ */
+class MITKCORE_EXPORT Tracing
+{
+public:
+
+  /** \brief Summary of the recorded events of one zone name, times in milliseconds. */
+  struct ZoneStatistics
+  {
+    ZoneStatistics() : Count(0), TotalTime(0), MaxTime(0) {}
+
+    unsigned long Count;
+    double TotalTime;
+    double MaxTime;
+  };
+
+  static void SetEnabled(bool enabled);
+  static bool IsEnabled();
+
+  /**
+   * \brief Discards all recorded events.
+   *
+   * Must not be called while other threads are recording events.
+   */
+  static void Clear();
+
+  /**
+   * \brief Size of the ring buffer of a thread.
+   *
+   * Once a buffer is full, the newest GetBufferCapacity() - 1 events of it
+   * are written, since the oldest slot may be overwritten at any time.
+   */
+  static std::size_t GetBufferCapacity();
+
+  /**
+   * \brief Number of events dropped since the last Clear() because too many
+   * threads were recording at the same time.
+   *
+   * The count is also written to the Chrome trace, as "droppedEvents" of its "otherData".
+   */
+  static unsigned long long GetDroppedEventCount();
+
+  /**
+   * \brief Writes the recorded events as Chrome trace event JSON.
+   *
+   * Events which a thread overwrites while they are written are left out.
+   */
+  static void WriteChromeTrace(std::ostream& os);
+
+  /**
+   * \brief Writes the recorded events as Chrome trace event JSON to a file.
+   * \throws mitk::Exception if the file cannot be written
+   */
+  static void WriteChromeTrace(const std::string& filename);
+
+  /** \brief Statistics of the recorded events, per zone name. */
+  static std::map<std::string, ZoneStatistics> GetStatistics();
+
+  /** \brief Nanoseconds since the Core library was loaded, as used by TraceZone. */
+  static long long GetTimestamp();
+
+  /**
+   * \brief Adds an event ending now to the buffer of the calling thread, used by TraceZone.
+   *
+   * \c name and \c category are stored as pointers and must therefore stay
+   * valid until the trace is written, e.g. string literals or the result of
+   * itk::LightObject::GetNameOfClass().
+   */
+  static void Record(const char* name, const char* category, long long begin);
+
+private:
+
+  Tracing();
+};
+
+/**
+ * \brief Records the lifetime of a scope as an event if tracing is enabled.
+ *
+ * Use the MITK_TRACE_ZONE macro instead of instantiating this class directly.
+ * \sa Tracing
+ */
+class TraceZone
+{
+public:
+
+  TraceZone(const char* name, const char* category)
+    : m_Name(Tracing::IsEnabled() ? name : nullptr)
+    , m_Category(category)
+    , m_Begin(m_Name ? Tracing::GetTimestamp() : 0)
+  {
+  }
+
+  ~TraceZone()
+  {
+    if (m_Name)
+    {
+      Tracing::Record(m_Name, m_Category, m_Begin);
+    }
+  }
+
+private:
+
+  TraceZone(const TraceZone&);
+  TraceZone& operator=(const TraceZone&);
+
+  const char* const m_Name;
+  const char* const m_Category;
+  const long long m_Begin;
+};
+
+}
+
+#define MITK_TRACE_ZONE_CONCAT_(a, b) a##b
+#define MITK_TRACE_ZONE_CONCAT(a, b) MITK_TRACE_ZONE_CONCAT_(a, b)
+
+/**
+ * \brief Traces the rest of the enclosing scope as a zone named \c name in \c category.
+ * \sa mitk::Tracing
+ */
+#define MITK_TRACE_ZONE(name, category) \
+  mitk::TraceZone MITK_TRACE_ZONE_CONCAT(mitkTraceZone, __LINE__)(name, category)
+
+#endif
@@ -19,6 +19,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 #include "mitkImageVtkReadAccessor.h"
 #include "mitkImageVtkWriteAccessor.h"
+#include "mitkTracing.h"
 
 mitk::ImageSource::ImageSource()
 {
@@ -120,6 +121,14 @@ void mitk::ImageSource::AllocateOutputs()
 
 //----------------------------------------------------------------------------
 
+void mitk::ImageSource::UpdateOutputData(itk::DataObject* output)
+{
+  MITK_TRACE_ZONE(this->GetNameOfClass(), "filter");
+  Superclass::UpdateOutputData(output);
+}
+
+//----------------------------------------------------------------------------
+
 void mitk::ImageSource::GenerateData()
 {
   // Call a method that can be overriden by a subclass to allocate
@@ -177,6 +186,7 @@ ITK_THREAD_RETURN_TYPE mitk::ImageSource::ThreaderCallback( void *arg )
 
   if (threadId < total)
     {
+    MITK_TRACE_ZONE(str->Filter->GetNameOfClass(), "filter");
     str->Filter->ThreadedGenerateData(splitRegion, threadId);
     }
   // else
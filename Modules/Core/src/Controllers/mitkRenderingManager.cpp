@@ -21,6 +21,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "mitkNodePredicateNot.h"
 #include "mitkNodePredicateProperty.h"
 #include "mitkProportionalTimeGeometry.h"
+#include "mitkTracing.h"
 
 #include <vtkRenderWindow.h>
 
@@ -654,6 +655,8 @@ SliceNavigationController* RenderingManager::GetTimeNavigationController()
 
 void RenderingManager::ExecutePendingRequests()
 {
+  MITK_TRACE_ZONE("RenderingManager::ExecutePendingRequests", "rendering");
+
   m_UpdatePending = false;
 
   // Satisfy all pending update requests
@@ -0,0 +1,356 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include "mitkTracing.h"
+#include "mitkExceptionMacro.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <vector>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <pthread.h>
+#endif
+
+namespace
+{
+  struct TraceEvent
+  {
+    const char* Name;
+    const char* Category;
+    long long Begin;
+    long long Duration;
+  };
+
+  /**
+   * Ring buffer of the events of one thread. Only the owning thread writes,
+   * readers detect overwritten events by reading the write count again.
+   * When its thread ends, the buffer is released and taken over by the next
+   * thread that needs one, together with the events recorded so far.
+   */
+  class TraceBuffer
+  {
+  public:
+
+    static const std::size_t Capacity = 1 << 14;
+
+    explicit TraceBuffer(unsigned int index)
+      : m_Index(index)
+      , m_Events(Capacity)
+      , m_Count(0)
+      , m_InUse(true)
+    {
+    }
+
+    unsigned int GetIndex() const
+    {
+      return m_Index;
+    }
+
+    bool Acquire()
+    {
+      bool inUse = false;
+      return m_InUse.compare_exchange_strong(inUse, true, std::memory_order_acquire);
+    }
+
+    void Release()
+    {
+      m_InUse.store(false, std::memory_order_release);
+    }
+
+    void Add(const TraceEvent& event)
+    {
+      const unsigned long long count = m_Count.load(std::memory_order_relaxed);
+      m_Events[count % Capacity] = event;
+      m_Count.store(count + 1, std::memory_order_release);
+    }
+
+    std::vector<TraceEvent> GetEvents() const
+    {
+      // while event number count is written, it overwrites the slot of event count - Capacity
+      const unsigned long long end = m_Count.load(std::memory_order_acquire);
+      const unsigned long long begin = end >= Capacity ? end - Capacity + 1 : 0;
+
+      std::vector<TraceEvent> events;
+      events.reserve(static_cast<std::size_t>(end - begin));
+      for (unsigned long long i = begin; i < end; ++i)
+      {
+        events.push_back(m_Events[i % Capacity]);
+      }
+
+      // drop the events the thread overwrote or was overwriting while they were copied
+      std::atomic_thread_fence(std::memory_order_acquire);
+      const unsigned long long count = m_Count.load(std::memory_order_relaxed);
+      if (count >= Capacity && count - Capacity + 1 > begin)
+      {
+        const std::size_t overwritten = static_cast<std::size_t>(std::min(count - Capacity + 1 - begin, end - begin));
+        events.erase(events.begin(), events.begin() + overwritten);
+      }
+      return events;
+    }
+
+    void Clear()
+    {
+      m_Count.store(0, std::memory_order_release);
+    }
+
+  private:
+
+    const unsigned int m_Index;
+    std::vector<TraceEvent> m_Events;
+    std::atomic<unsigned long long> m_Count;
+    std::atomic<bool> m_InUse;
+  };
+
+  const std::size_t MaxThreads = 256;
+
+  std::atomic<bool> g_Enabled(false);
+
+  // Buffers are never deleted, since detached threads may still record
+  // events during static destruction. Only as many buffers are created as
+  // threads record at the same time.
+  std::atomic<TraceBuffer*> g_Buffers[MaxThreads];
+  std::atomic<unsigned long long> g_DroppedEvents(0);
+
+  const std::chrono::steady_clock::time_point g_Start = std::chrono::steady_clock::now();
+
+#ifdef _WIN32
+  void NTAPI ReleaseBuffer(void* buffer)
+  {
+    if (buffer != nullptr)
+    {
+      static_cast<TraceBuffer*>(buffer)->Release();
+    }
+  }
+
+  // fiber local storage, unlike thread local storage, calls back when the thread ends
+  const DWORD g_BufferKey = FlsAlloc(&ReleaseBuffer);
+
+  TraceBuffer* GetThreadBuffer()
+  {
+    return static_cast<TraceBuffer*>(FlsGetValue(g_BufferKey));
+  }
+
+  void SetThreadBuffer(TraceBuffer* buffer)
+  {
+    FlsSetValue(g_BufferKey, buffer);
+  }
+#else
+  extern "C" void ReleaseBuffer(void* buffer)
+  {
+    static_cast<TraceBuffer*>(buffer)->Release();
+  }
+
+  pthread_key_t CreateBufferKey()
+  {
+    pthread_key_t key;
+    pthread_key_create(&key, &ReleaseBuffer);
+    return key;
+  }
+
+  const pthread_key_t g_BufferKey = CreateBufferKey();
+
+  TraceBuffer* GetThreadBuffer()
+  {
+    return static_cast<TraceBuffer*>(pthread_getspecific(g_BufferKey));
+  }
+
+  void SetThreadBuffer(TraceBuffer* buffer)
+  {
+    pthread_setspecific(g_BufferKey, buffer);
+  }
+#endif
+
+  /** The buffer of the calling thread, a released or new one on its first call. */
+  TraceBuffer* GetBuffer()
+  {
+    TraceBuffer* buffer = GetThreadBuffer();
+    if (buffer != nullptr)
+    {
+      return buffer;
+    }
+
+    for (std::size_t i = 0; i < MaxThreads && buffer == nullptr; ++i)
+    {
+      TraceBuffer* released = g_Buffers[i].load(std::memory_order_acquire);
+      if (released == nullptr)
+      {
+        TraceBuffer* newBuffer = new TraceBuffer(static_cast<unsigned int>(i + 1));
+        if (g_Buffers[i].compare_exchange_strong(released, newBuffer, std::memory_order_acq_rel))
+        {
+          buffer = newBuffer;
+          break;
+        }
+        // another thread took the slot, compare_exchange_strong loaded its buffer
+        delete newBuffer;
+      }
+      if (released->Acquire())
+      {
+        buffer = released;
+      }
+    }
+
+    if (buffer != nullptr)
+    {
+      SetThreadBuffer(buffer);
+    }
+    return buffer;
+  }
+
+  void WriteJsonString(std::ostream& os, const char* str)
+  {
+    os << '"';
+    for (; *str != '\0'; ++str)
+    {
+      const unsigned char c = static_cast<unsigned char>(*str);
+      if (c == '"' || c == '\\')
+      {
+        os << '\\' << *str;
+      }
+      else if (c < 0x20)
+      {
+        os << "\\u" << std::hex << std::setw(4) << std::setfill('0') << static_cast<int>(c) << std::dec;
+      }
+      else
+      {
+        os << *str;
+      }
+    }
+    os << '"';
+  }
+}
+
+void mitk::Tracing::SetEnabled(bool enabled)
+{
+  g_Enabled.store(enabled, std::memory_order_relaxed);
+}
+
+bool mitk::Tracing::IsEnabled()
+{
+  return g_Enabled.load(std::memory_order_relaxed);
+}
+
+void mitk::Tracing::Clear()
+{
+  g_DroppedEvents.store(0, std::memory_order_relaxed);
+  for (std::size_t i = 0; i < MaxThreads; ++i)
+  {
+    TraceBuffer* buffer = g_Buffers[i].load(std::memory_order_acquire);
+    if (buffer != nullptr)
+    {
+      buffer->Clear();
+    }
+  }
+}
+
+std::size_t mitk::Tracing::GetBufferCapacity()
+{
+  return TraceBuffer::Capacity;
+}
+
+long long mitk::Tracing::GetTimestamp()
+{
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - g_Start).count();
+}
+
+void mitk::Tracing::Record(const char* name, const char* category, long long begin)
+{
+  TraceBuffer* buffer = GetBuffer();
+  if (buffer != nullptr)
+  {
+    TraceEvent event = { name, category, begin, GetTimestamp() - begin };
+    buffer->Add(event);
+  }
+  else
+  {
+    // more threads recording at the same time than buffers
+    g_DroppedEvents.fetch_add(1, std::memory_order_relaxed);
+  }
+}
+
+unsigned long long mitk::Tracing::GetDroppedEventCount()
+{
+  return g_DroppedEvents.load(std::memory_order_relaxed);
+}
+
+void mitk::Tracing::WriteChromeTrace(std::ostream& os)
+{
+  os << "{\"traceEvents\":[";
+  bool first = true;
+  for (std::size_t i = 0; i < MaxThreads; ++i)
+  {
+    TraceBuffer* buffer = g_Buffers[i].load(std::memory_order_acquire);
+    if (buffer == nullptr) continue;
+
+    const std::vector<TraceEvent> events = buffer->GetEvents();
+    for (std::vector<TraceEvent>::const_iterator iter = events.begin(); iter != events.end(); ++iter)
+    {
+      os << (first ? "\n" : ",\n") << "{\"name\":";
+      WriteJsonString(os, iter->Name);
+      os << ",\"cat\":";
+      WriteJsonString(os, iter->Category);
+      // timestamps are in microseconds
+      os << ",\"ph\":\"X\",\"ts\":" << std::fixed << std::setprecision(3) << iter->Begin / 1000.0
+         << ",\"dur\":" << iter->Duration / 1000.0
+         << ",\"pid\":1,\"tid\":" << buffer->GetIndex() << "}";
+      first = false;
+    }
+  }
+  os << "\n],\"displayTimeUnit\":\"ms\",\"otherData\":{\"droppedEvents\":\"" << GetDroppedEventCount() << "\"}}\n";
+}
+
+void mitk::Tracing::WriteChromeTrace(const std::string& filename)
+{
+  std::ofstream file(filename.c_str());
+  if (!file)
+  {
+    mitkThrow() << "Could not open " << filename << " for writing the trace.";
+  }
+  WriteChromeTrace(file);
+  if (!file)
+  {
+    mitkThrow() << "Could not write the trace to " << filename;
+  }
+}
+
+std::map<std::string, mitk::Tracing::ZoneStatistics> mitk::Tracing::GetStatistics()
+{
+  std::map<std::string, ZoneStatistics> result;
+  for (std::size_t i = 0; i < MaxThreads; ++i)
+  {
+    TraceBuffer* buffer = g_Buffers[i].load(std::memory_order_acquire);
+    if (buffer == nullptr) continue;
+
+    const std::vector<TraceEvent> events = buffer->GetEvents();
+    for (std::vector<TraceEvent>::const_iterator iter = events.begin(); iter != events.end(); ++iter)
+    {
+      ZoneStatistics& statistics = result[iter->Name];
+      const double time = iter->Duration / 1.0e6;
+      ++statistics.Count;
+      statistics.TotalTime += time;
+      statistics.MaxTime = std::max(statistics.MaxTime, time);
+    }
+  }
+  return result;
+}
@@ -18,6 +18,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "mitkDataNode.h"
 #include "mitkCoreObjectFactory.h"
 #include <vtkTransform.h>
+#include <itkMutexLockHolder.h>
 
 #include "mitkProperties.h"
 #include "mitkStringProperty.h"
@@ -52,9 +53,68 @@ mitk::Mapper* mitk::DataNode::GetMapper(MapperSlotId id) const
 
 mitk::BaseData* mitk::DataNode::GetData() const
 {
+  if (!m_DataLoaded.load(std::memory_order_acquire))
+  {
+    itk::MutexLockHolder<itk::SimpleFastMutexLock> lock(m_DataLoaderMutex);
+    // another thread may have read the data while this one waited for the lock
+    if (m_DataLoader.IsNotNull())
+      const_cast<DataNode*>(this)->LoadData();
+  }
   return m_Data;
 }
 
+void mitk::DataNode::LoadData()
+{
+  LazyDataLoader::Pointer loader = m_DataLoader;
+
+  m_Data = loader->Load();
+  if (m_Data.IsNull())
+  {
+    MITK_ERROR << "Could not load the " << loader->GetDataType() << " of node " << this->GetName();
+  }
+
+  // the properties of the node are complete, so unlike SetData() no default properties are set;
+  // no Modified() either, the node was showing this data already. The mappers are kept, they are
+  // created for the data and GetMapper() may be the caller of GetData().
+  m_DataReferenceChangedTime.Modified();
+
+  m_DataLoader = NULL;
+  m_DataLoaded.store(true, std::memory_order_release);
+
+  if (m_Interactor.IsNotNull())
+    m_Interactor->DataChanged();
+}
+
+void mitk::DataNode::SetDataLoader(LazyDataLoader* loader)
+{
+  {
+    itk::MutexLockHolder<itk::SimpleFastMutexLock> lock(m_DataLoaderMutex);
+    if (m_DataLoader == loader)
+      return;
+
+    m_DataLoader = loader;
+    m_DataLoaded.store(loader == NULL, std::memory_order_release);
+    m_Data = NULL;
+  }
+
+  m_Mappers.clear();
+  m_Mappers.resize(10);
+
+  m_DataReferenceChangedTime.Modified();
+  Modified();
+}
+
+mitk::LazyDataLoader* mitk::DataNode::GetDataLoader() const
+{
+  itk::MutexLockHolder<itk::SimpleFastMutexLock> lock(m_DataLoaderMutex);
+  return m_DataLoader;
+}
+
+bool mitk::DataNode::IsDataLoaded() const
+{
+  return m_DataLoaded.load(std::memory_order_acquire);
+}
+
 mitk::Interactor* mitk::DataNode::GetInteractor() const
 {
   return m_Interactor;
@@ -62,6 +122,12 @@ mitk::Interactor* mitk::DataNode::GetInteractor() const
 
 void mitk::DataNode::SetData(mitk::BaseData* baseData)
 {
+  {
+    itk::MutexLockHolder<itk::SimpleFastMutexLock> lock(m_DataLoaderMutex);
+    m_DataLoader = NULL;
+    m_DataLoaded.store(true, std::memory_order_release);
+  }
+
   if(m_Data!=baseData)
   {
     m_Data=baseData;
@@ -87,7 +153,7 @@ void mitk::DataNode::SetInteractor(mitk::Interactor* interactor)
     m_Interactor->SetDataNode(this);
 }
 
-mitk::DataNode::DataNode() : m_Data(NULL), m_PropertyListModifiedObserverTag(0)
+mitk::DataNode::DataNode() : m_Data(NULL), m_DataLoaded(true), m_PropertyListModifiedObserverTag(0)
 {
   m_Mappers.resize(10);
 
@@ -222,44 +288,42 @@ void mitk::DataNode::ConcatenatePropertyList(PropertyList *pList, bool replace)
   m_PropertyList->ConcatenatePropertyList(pList, replace);
 }
 
-mitk::BaseProperty* mitk::DataNode::GetProperty(const char *propertyKey, const mitk::BaseRenderer* renderer) const
+template <typename KeyType>
+mitk::BaseProperty* mitk::DataNode::FindProperty(const KeyType& propertyKey, const mitk::BaseRenderer* renderer) const
 {
-  if(propertyKey==NULL)
-    return NULL;
-
   //renderer specified?
   if (renderer)
   {
-    std::string rendererName = renderer->GetName();
-
     MapOfPropertyLists::const_iterator it;
     //check for the renderer specific property
-    it=m_MapOfPropertyLists.find(rendererName);
+    it=m_MapOfPropertyLists.find(renderer->GetName());
     if(it!=m_MapOfPropertyLists.end()) //found
     {
-      mitk::BaseProperty::Pointer property;
-      property=it->second->GetProperty(propertyKey);
-      if(property.IsNotNull())//found an enabled property in the render specific list
+      mitk::BaseProperty* property=it->second->GetProperty(propertyKey);
+      if(property!=NULL)//found an enabled property in the render specific list
         return property;
-      else //found a renderer specific list, but not the desired property
-        return m_PropertyList->GetProperty(propertyKey); //return renderer unspecific property
-    }
-    else //didn't find the property list of the given renderer
-    {
-      //return the renderer unspecific property if there is one
-      return m_PropertyList->GetProperty(propertyKey);
     }
   }
-  else //no specific renderer given; use the renderer independent one
-  {
-    mitk::BaseProperty::Pointer property;
-    property=m_PropertyList->GetProperty(propertyKey);
-    if(property.IsNotNull())
-      return property;
-  }
 
-  //only to satisfy compiler!
-  return NULL;
+  //no specific renderer given, no renderer specific list or property; use the renderer independent one
+  return m_PropertyList->GetProperty(propertyKey);
+}
+
+mitk::BaseProperty* mitk::DataNode::GetProperty(const char *propertyKey, const mitk::BaseRenderer* renderer) const
+{
+  if(propertyKey==NULL)
+    return NULL;
+
+  // construct the name once for both property lists
+  return this->FindProperty(std::string(propertyKey), renderer);
+}
+
+mitk::BaseProperty* mitk::DataNode::GetProperty(const PropertyKey& propertyKey, const mitk::BaseRenderer* renderer) const
+{
+  if(!propertyKey.IsValid())
+    return NULL;
+
+  return this->FindProperty(propertyKey, renderer);
 }
 
 mitk::DataNode::GroupTagList mitk::DataNode::GetGroupTags() const
@@ -291,6 +355,16 @@ bool mitk::DataNode::GetBoolProperty(const char* propertyKey, bool& boolValue, c
   return true;
 }
 
+bool mitk::DataNode::GetBoolProperty(const PropertyKey& propertyKey, bool& boolValue, const mitk::BaseRenderer* renderer) const
+{
+  mitk::BoolProperty* boolprop = dynamic_cast<mitk::BoolProperty*>(GetProperty(propertyKey, renderer));
+  if(boolprop == NULL)
+    return false;
+
+  boolValue = boolprop->GetValue();
+  return true;
+}
+
 bool mitk::DataNode::GetIntProperty(const char* propertyKey, int &intValue, const mitk::BaseRenderer* renderer) const
 {
   mitk::IntProperty::Pointer intprop = dynamic_cast<mitk::IntProperty*>(GetProperty(propertyKey, renderer));
@@ -301,6 +375,16 @@ bool mitk::DataNode::GetIntProperty(const char* propertyKey, int &intValue, cons
   return true;
 }
 
+bool mitk::DataNode::GetIntProperty(const PropertyKey& propertyKey, int &intValue, const mitk::BaseRenderer* renderer) const
+{
+  mitk::IntProperty* intprop = dynamic_cast<mitk::IntProperty*>(GetProperty(propertyKey, renderer));
+  if(intprop == NULL)
+    return false;
+
+  intValue = intprop->GetValue();
+  return true;
+}
+
 bool mitk::DataNode::GetFloatProperty(const char* propertyKey, float &floatValue, const mitk::BaseRenderer* renderer) const
 {
   mitk::FloatProperty::Pointer floatprop = dynamic_cast<mitk::FloatProperty*>(GetProperty(propertyKey, renderer));
@@ -355,6 +439,17 @@ bool mitk::DataNode::GetColor(float rgb[3], const mitk::BaseRenderer* renderer,
   return true;
 }
 
+bool mitk::DataNode::GetColor(float rgb[3], const mitk::BaseRenderer* renderer) const
+{
+  static const PropertyKey colorKey("color");
+  mitk::ColorProperty* colorprop = dynamic_cast<mitk::ColorProperty*>(GetProperty(colorKey, renderer));
+  if(colorprop == NULL)
+    return false;
+
+  memcpy(rgb, colorprop->GetColor().GetDataPointer(), 3*sizeof(float));
+  return true;
+}
+
 bool mitk::DataNode::GetOpacity(float &opacity, const mitk::BaseRenderer* renderer, const char* propertyKey) const
 {
   mitk::FloatProperty::Pointer opacityprop = dynamic_cast<mitk::FloatProperty*>(GetProperty(propertyKey, renderer));
@@ -365,6 +460,30 @@ bool mitk::DataNode::GetOpacity(float &opacity, const mitk::BaseRenderer* render
   return true;
 }
 
+bool mitk::DataNode::GetOpacity(float &opacity, const mitk::BaseRenderer* renderer) const
+{
+  static const PropertyKey opacityKey("opacity");
+  mitk::FloatProperty* opacityprop = dynamic_cast<mitk::FloatProperty*>(GetProperty(opacityKey, renderer));
+  if(opacityprop == NULL)
+    return false;
+
+  opacity=opacityprop->GetValue();
+  return true;
+}
+
+bool mitk::DataNode::GetVisibility(bool &visible, const mitk::BaseRenderer* renderer) const
+{
+  static const PropertyKey visibleKey("visible");
+  return GetBoolProperty(visibleKey, visible, renderer);
+}
+
+bool mitk::DataNode::IsVisible(const mitk::BaseRenderer* renderer) const
+{
+  bool visible = true;
+  GetVisibility(visible, renderer);
+  return visible;
+}
+
 bool mitk::DataNode::GetLevelWindow(mitk::LevelWindow &levelWindow, const mitk::BaseRenderer* renderer, const char* propertyKey) const
 {
   mitk::LevelWindowProperty::Pointer levWinProp = dynamic_cast<mitk::LevelWindowProperty*>(GetProperty(propertyKey, renderer));
@@ -479,9 +598,9 @@ void mitk::DataNode::AddProperty(const char *propertyKey,
 
 vtkLinearTransform* mitk::DataNode::GetVtkTransform(int t) const
 {
-  assert(m_Data.IsNotNull());
+  assert(this->GetData() != NULL);
 
-  mitk::BaseGeometry* geometry = m_Data->GetGeometry(t);
+  mitk::BaseGeometry* geometry = this->GetData()->GetGeometry(t);
 
   if(geometry == NULL)
     return NULL;
@@ -25,8 +25,12 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "itkMutexLockHolder.h"
 #include "itkCommand.h"
 
+#include <algorithm>
+
 mitk::DataStorage::DataStorage() : itk::Object()
   , m_BlockNodeModifiedEvents(false)
+  , m_BatchDepth(0)
+  , m_DeliveringBatch(false)
 {
 }
 
@@ -113,7 +117,10 @@ void mitk::DataStorage::PrintSelf(std::ostream& os, itk::Indent indent) const
     std::string name;
     allIt.Value()->GetName(name);
     std::string datatype;
-    if (allIt.Value()->GetData() != NULL)
+    mitk::LazyDataLoader::Pointer loader = allIt.Value()->GetDataLoader();
+    if (loader.IsNotNull())
+      datatype = loader->GetDataType();
+    else if (allIt.Value()->GetData() != NULL)
       datatype = allIt.Value()->GetData()->GetNameOfClass();
     os << indent << " " << allIt.Value().GetPointer() << "<" << datatype << ">: " << name << std::endl;
     mitk::DataStorage::SetOfObjects::ConstPointer parents = this->GetSources(allIt.Value());
@@ -169,12 +176,103 @@ const mitk::DataNode::GroupTagList mitk::DataStorage::GetGroupTags() const
 
 void mitk::DataStorage::EmitAddNodeEvent(const mitk::DataNode* node)
 {
-  AddNodeEvent.Send(node);
+  if (!this->AddToBatch(BatchedAddEvent, node))
+    AddNodeEvent.Send(node);
 }
 
 void mitk::DataStorage::EmitRemoveNodeEvent(const mitk::DataNode* node)
 {
-  RemoveNodeEvent.Send(node);
+  if (!this->AddToBatch(BatchedRemoveEvent, node))
+    RemoveNodeEvent.Send(node);
+}
+
+namespace
+{
+  void EraseNode(std::vector<mitk::DataNode::ConstPointer>& nodes, const mitk::DataNode* node)
+  {
+    nodes.erase(std::find(nodes.begin(), nodes.end(), node));
+  }
+}
+
+bool mitk::DataStorage::AddToBatch(BatchedEventType type, const mitk::DataNode* node)
+{
+  itk::MutexLockHolder<itk::SimpleFastMutexLock> locked(m_MutexOne);
+  if (m_BatchDepth == 0)
+    return false;
+
+  switch (type)
+  {
+  case BatchedAddEvent:
+    if (m_BatchedAddedNodes.insert(node).second)
+      m_Batch.AddedNodes.push_back(node);
+    break;
+  case BatchedRemoveEvent:
+    // nodes that were added and removed within the batch are not reported at all
+    if (m_BatchedAddedNodes.erase(node) > 0)
+      EraseNode(m_Batch.AddedNodes, node);
+    else if (m_BatchedRemovedNodes.insert(node).second)
+      m_Batch.RemovedNodes.push_back(node);
+    if (m_BatchedChangedNodes.erase(node) > 0)
+      EraseNode(m_Batch.ChangedNodes, node);
+    break;
+  case BatchedChangedEvent:
+    // observers see the final state of added nodes anyway
+    if (m_BatchedAddedNodes.count(node) == 0 && m_BatchedChangedNodes.insert(node).second)
+      m_Batch.ChangedNodes.push_back(node);
+    break;
+  }
+  return true;
+}
+
+void mitk::DataStorage::BeginBatch()
+{
+  itk::MutexLockHolder<itk::SimpleFastMutexLock> locked(m_MutexOne);
+  ++m_BatchDepth;
+}
+
+void mitk::DataStorage::EndBatch()
+{
+  BatchedNodeEvents events;
+  {
+    itk::MutexLockHolder<itk::SimpleFastMutexLock> locked(m_MutexOne);
+    if (m_BatchDepth == 0)
+      throw std::logic_error("DataStorage: EndBatch() called without BeginBatch()");
+    if (--m_BatchDepth > 0)
+      return;
+
+    std::swap(events, m_Batch);
+    m_BatchedAddedNodes.clear();
+    m_BatchedRemovedNodes.clear();
+    m_BatchedChangedNodes.clear();
+  }
+
+  if (events.AddedNodes.empty() && events.RemovedNodes.empty() && events.ChangedNodes.empty())
+    return;
+
+  // observers may start and end batches themselves while they are notified
+  bool wasDeliveringBatch = m_DeliveringBatch;
+  m_DeliveringBatch = false;
+  BatchNodeEvent.Send(events);
+
+  m_DeliveringBatch = true;
+  for (std::vector<DataNode::ConstPointer>::const_iterator it = events.RemovedNodes.begin(); it != events.RemovedNodes.end(); ++it)
+    RemoveNodeEvent.Send(*it);
+  for (std::vector<DataNode::ConstPointer>::const_iterator it = events.AddedNodes.begin(); it != events.AddedNodes.end(); ++it)
+    AddNodeEvent.Send(*it);
+  for (std::vector<DataNode::ConstPointer>::const_iterator it = events.ChangedNodes.begin(); it != events.ChangedNodes.end(); ++it)
+    ChangedNodeEvent.Send(*it);
+  m_DeliveringBatch = wasDeliveringBatch;
+}
+
+bool mitk::DataStorage::IsBatching() const
+{
+  itk::MutexLockHolder<itk::SimpleFastMutexLock> locked(m_MutexOne);
+  return m_BatchDepth > 0;
+}
+
+bool mitk::DataStorage::IsDeliveringBatch() const
+{
+  return m_DeliveringBatch;
 }
 
 void mitk::DataStorage::OnNodeInteractorChanged( itk::Object *caller, const itk::EventObject& )
@@ -196,7 +294,10 @@ void mitk::DataStorage::OnNodeModifiedOrDeleted( const itk::Object *caller, cons
   {
     const itk::ModifiedEvent* modEvent = dynamic_cast<const itk::ModifiedEvent*>(&event);
     if(modEvent)
-      ChangedNodeEvent.Send(_Node);
+    {
+      if (!this->AddToBatch(BatchedChangedEvent, _Node))
+        ChangedNodeEvent.Send(_Node);
+    }
     else
       DeleteNodeEvent.Send(_Node);
   }
@@ -282,10 +383,12 @@ mitk::TimeGeometry::Pointer mitk::DataStorage::ComputeBoundingGeometry3D( const
   for (SetOfObjects::ConstIterator it = input->Begin(); it != input->End(); ++it)
   {
     DataNode::Pointer node = it->Value();
-    if((node.IsNotNull()) && (node->GetData() != NULL) &&
-      (node->GetData()->IsEmpty()==false) &&
+    // properties first, hidden nodes with a data loader are not read
+    if((node.IsNotNull()) &&
       node->IsOn(boolPropertyKey, renderer) &&
-      node->IsOn(boolPropertyKey2, renderer)
+      node->IsOn(boolPropertyKey2, renderer) &&
+      (node->GetData() != NULL) &&
+      (node->GetData()->IsEmpty()==false)
       )
     {
       const TimeGeometry* timeGeometry = node->GetData()->GetUpdatedTimeGeometry();
@@ -413,10 +516,12 @@ mitk::BoundingBox::Pointer mitk::DataStorage::ComputeBoundingBox( const char* bo
   for (SetOfObjects::ConstIterator it = all->Begin(); it != all->End(); ++it)
   {
     DataNode::Pointer node = it->Value();
-    if((node.IsNotNull()) && (node->GetData() != NULL) &&
-      (node->GetData()->IsEmpty()==false) &&
+    // properties first, hidden nodes with a data loader are not read
+    if((node.IsNotNull()) &&
       node->IsOn(boolPropertyKey, renderer) &&
-      node->IsOn(boolPropertyKey2, renderer)
+      node->IsOn(boolPropertyKey2, renderer) &&
+      (node->GetData() != NULL) &&
+      (node->GetData()->IsEmpty()==false)
       )
     {
       const TimeGeometry* geometry = node->GetData()->GetUpdatedTimeGeometry();
@@ -466,10 +571,12 @@ mitk::TimeBounds mitk::DataStorage::ComputeTimeBounds( const char* boolPropertyK
   for (SetOfObjects::ConstIterator it = all->Begin(); it != all->End(); ++it)
   {
     DataNode::Pointer node = it->Value();
-    if((node.IsNotNull()) && (node->GetData() != NULL) &&
-      (node->GetData()->IsEmpty()==false) &&
+    // properties first, hidden nodes with a data loader are not read
+    if((node.IsNotNull()) &&
       node->IsOn(boolPropertyKey, renderer) &&
-      node->IsOn(boolPropertyKey2, renderer)
+      node->IsOn(boolPropertyKey2, renderer) &&
+      (node->GetData() != NULL) &&
+      (node->GetData()->IsEmpty()==false)
       )
     {
       const TimeGeometry* geometry = node->GetData()->GetUpdatedTimeGeometry();
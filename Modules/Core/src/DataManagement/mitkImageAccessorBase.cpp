@@ -16,6 +16,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 #include "mitkImageAccessorBase.h"
 #include "mitkImage.h"
+#include "mitkTracing.h"
 
 mitk::ImageAccessorBase::ThreadIDType mitk::ImageAccessorBase::CurrentThreadHandle()
 {
@@ -156,7 +157,10 @@ bool mitk::ImageAccessorBase::Overlap(const ImageAccessorBase* iAB)
 /** \brief Uses the WaitLock to wait for another ImageAccessor*/
 void mitk::ImageAccessorBase::WaitForReleaseOf(ImageAccessorWaitLock* wL)
 {
-  wL->m_Mutex.Lock();
+  {
+    MITK_TRACE_ZONE("ImageAccessor::WaitForReleaseOf", "lock");
+    wL->m_Mutex.Lock();
+  }
 
   // Decrement
   wL->m_WaiterCount -= 1;
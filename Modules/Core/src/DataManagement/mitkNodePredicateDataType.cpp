@@ -40,6 +40,11 @@ bool mitk::NodePredicateDataType::CheckNode(const mitk::DataNode* node) const
     throw std::invalid_argument("NodePredicateDataType: invalid node");
 
 
+  // nodes of lazily loaded scenes know their data type before the data is read
+  mitk::LazyDataLoader::Pointer loader = node->GetDataLoader();
+  if (loader.IsNotNull())
+    return ( m_ValidDataType.compare(loader->GetDataType()) == 0);
+
   mitk::BaseData* data = node->GetData();
 
   if (data == nullptr)
@@ -0,0 +1,121 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include "mitkPropertyKey.h"
+
+#include <itkSimpleFastMutexLock.h>
+#include <itkMutexLockHolder.h>
+
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace
+{
+  struct PropertyKeyEntry
+  {
+    mitk::PropertyKey::IdType Id;
+    std::string Name;
+  };
+
+  typedef std::unordered_map<std::string, const PropertyKeyEntry*> PropertyKeySnapshot;
+
+  /**
+   * Readers only load the current snapshot, which is never changed after it was published.
+   * Interning a name publishes a copy of the snapshot with the new entry. Replaced snapshots
+   * are kept, because readers may still use them.
+   */
+  struct PropertyKeyTable
+  {
+    PropertyKeyTable() : Current(nullptr)
+    {
+      Snapshots.push_back(std::unique_ptr<const PropertyKeySnapshot>(new PropertyKeySnapshot));
+      Current.store(Snapshots.back().get());
+    }
+
+    std::atomic<const PropertyKeySnapshot*> Current;
+
+    itk::SimpleFastMutexLock Mutex;     // serializes interning
+    std::deque<PropertyKeyEntry> Entries;  // a deque does not move its elements
+    std::vector<std::unique_ptr<const PropertyKeySnapshot> > Snapshots;
+  };
+
+  PropertyKeyTable& GetTable()
+  {
+    static PropertyKeyTable table;
+    return table;
+  }
+
+  const PropertyKeyEntry* Find(const PropertyKeySnapshot* snapshot, const std::string& name)
+  {
+    PropertyKeySnapshot::const_iterator it = snapshot->find(name);
+    return it != snapshot->end() ? it->second : nullptr;
+  }
+
+  const PropertyKeyEntry* Intern(const std::string& name)
+  {
+    PropertyKeyTable& table = GetTable();
+    const PropertyKeyEntry* entry = Find(table.Current.load(std::memory_order_acquire), name);
+    if (entry != nullptr)
+      return entry;
+
+    itk::MutexLockHolder<itk::SimpleFastMutexLock> lock(table.Mutex);
+    const PropertyKeySnapshot* current = table.Current.load(std::memory_order_relaxed);
+    entry = Find(current, name);
+    if (entry != nullptr)
+      return entry;
+
+    PropertyKeyEntry newEntry = { static_cast<mitk::PropertyKey::IdType>(table.Entries.size()), name };
+    table.Entries.push_back(newEntry);
+    entry = &table.Entries.back();
+
+    std::unique_ptr<PropertyKeySnapshot> snapshot(new PropertyKeySnapshot(*current));
+    snapshot->insert(std::make_pair(name, entry));
+    table.Current.store(snapshot.get(), std::memory_order_release);
+    table.Snapshots.push_back(std::move(snapshot));
+    return entry;
+  }
+}
+
+mitk::PropertyKey::PropertyKey(const char* name)
+{
+  const PropertyKeyEntry* entry = Intern(name != nullptr ? std::string(name) : std::string());
+  m_Id = entry->Id;
+  m_Name = &entry->Name;
+}
+
+mitk::PropertyKey::PropertyKey(const std::string& name)
+{
+  const PropertyKeyEntry* entry = Intern(name);
+  m_Id = entry->Id;
+  m_Name = &entry->Name;
+}
+
+mitk::PropertyKey mitk::PropertyKey::Find(const std::string& name)
+{
+  const PropertyKeyEntry* entry = ::Find(GetTable().Current.load(std::memory_order_acquire), name);
+  if (entry == nullptr)
+    return PropertyKey();
+  return PropertyKey(entry->Id, &entry->Name);
+}
+
+const std::string& mitk::PropertyKey::GetName() const
+{
+  static const std::string empty;
+  return m_Name != nullptr ? *m_Name : empty;
+}
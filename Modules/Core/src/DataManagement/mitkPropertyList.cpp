@@ -21,6 +21,18 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "mitkStringProperty.h"
 #include "mitkNumericTypes.h"
 
+#include <algorithm>
+
+namespace
+{
+  struct IndexEntryLess
+  {
+    bool operator()(const std::pair<mitk::PropertyKey::IdType, mitk::BaseProperty::Pointer>& entry, mitk::PropertyKey::IdType id) const
+    {
+      return entry.first < id;
+    }
+  };
+}
 
 mitk::BaseProperty* mitk::PropertyList::GetProperty(const std::string& propertyKey) const
 {
@@ -34,6 +46,38 @@ mitk::BaseProperty* mitk::PropertyList::GetProperty(const std::string& propertyK
 }
 
 
+mitk::BaseProperty* mitk::PropertyList::GetProperty(const PropertyKey& propertyKey) const
+{
+  if (!propertyKey.IsValid())
+    return nullptr;
+
+  PropertyIndex::const_iterator it = std::lower_bound(m_PropertyIndex.begin(), m_PropertyIndex.end(), propertyKey.GetId(), IndexEntryLess());
+  if (it != m_PropertyIndex.end() && it->first == propertyKey.GetId())
+    return it->second;
+  else
+    return nullptr;
+}
+
+
+void mitk::PropertyList::UpdateIndex(const std::string& propertyKey, BaseProperty* property)
+{
+  // interns the name, the set of property names is small and interning is done once per name
+  PropertyKey::IdType id = PropertyKey(propertyKey).GetId();
+  PropertyIndex::iterator it = std::lower_bound(m_PropertyIndex.begin(), m_PropertyIndex.end(), id, IndexEntryLess());
+  if (it != m_PropertyIndex.end() && it->first == id)
+  {
+    if (property != nullptr)
+      it->second = property;
+    else
+      m_PropertyIndex.erase(it);
+  }
+  else if (property != nullptr)
+  {
+    m_PropertyIndex.insert(it, std::make_pair(id, BaseProperty::Pointer(property)));
+  }
+}
+
+
 void mitk::PropertyList::SetProperty(const std::string& propertyKey, BaseProperty* property)
 {
   if (!property) return;
@@ -74,6 +118,7 @@ void mitk::PropertyList::SetProperty(const std::string& propertyKey, BasePropert
 
   //no? add it.
   m_Properties.insert( PropertyMap::value_type(propertyKey, property) );
+  this->UpdateIndex(propertyKey, property);
   this->Modified();
 }
 
@@ -93,6 +138,7 @@ void mitk::PropertyList::ReplaceProperty(const std::string& propertyKey, BasePro
 
   //no? add/replace it.
   m_Properties.insert( PropertyMap::value_type(propertyKey, property) );
+  this->UpdateIndex(propertyKey, property);
   Modified();
 }
 
@@ -107,7 +153,9 @@ mitk::PropertyList::PropertyList(const mitk::PropertyList& other)
   for (auto i = other.m_Properties.begin();
        i != other.m_Properties.end(); ++i)
   {
-    m_Properties.insert(std::make_pair(i->first, i->second->Clone()));
+    BaseProperty::Pointer clone = i->second->Clone();
+    m_Properties.insert(std::make_pair(i->first, clone));
+    this->UpdateIndex(i->first, clone);
   }
 }
 
@@ -152,6 +200,7 @@ bool mitk::PropertyList::DeleteProperty(const std::string& propertyKey)
   {
     it->second=nullptr;
     m_Properties.erase(it);
+    this->UpdateIndex(propertyKey, nullptr);
     Modified();
     return true;
   }
@@ -168,6 +217,7 @@ void mitk::PropertyList::Clear()
     ++it;
   }
   m_Properties.clear();
+  m_PropertyIndex.clear();
 }
 
 itk::LightObject::Pointer mitk::PropertyList::InternalClone() const
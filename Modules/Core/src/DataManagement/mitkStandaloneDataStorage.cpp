@@ -20,14 +20,40 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "mitkProperties.h"
 #include "mitkNodePredicateBase.h"
 #include "mitkNodePredicateProperty.h"
+#include "mitkNodePredicateDataType.h"
+#include "mitkNodePredicateAnd.h"
+#include "mitkNodePredicateOr.h"
 #include "mitkGroupTagProperty.h"
 #include "itkSimpleFastMutexLock.h"
 #include "itkMutexLockHolder.h"
 
+#include <algorithm>
+#include <iterator>
+#include <typeinfo>
+
+namespace
+{
+  // Value a property is indexed with. Only properties of the same type can be equal (see
+  // BaseProperty::operator==), so all properties that are neither bool nor string share the empty value.
+  std::string GetIndexValue(const mitk::BaseProperty* property)
+  {
+    if (typeid(*property) == typeid(mitk::StringProperty))
+      return std::string("s") + static_cast<const mitk::StringProperty*>(property)->GetValue();
+    if (typeid(*property) == typeid(mitk::BoolProperty))
+      return static_cast<const mitk::BoolProperty*>(property)->GetValue() ? "b1" : "b0";
+    return std::string();
+  }
+}
+
 
 mitk::StandaloneDataStorage::StandaloneDataStorage()
 : mitk::DataStorage()
 {
+  itk::MemberCommand<StandaloneDataStorage>::Pointer command = itk::MemberCommand<StandaloneDataStorage>::New();
+  command->SetCallbackFunction(this, &StandaloneDataStorage::OnIndexedObjectModified);
+  m_IndexModifiedCommand = command.GetPointer();
+
+  m_PropertyIndices["name"];
 }
 
 
@@ -37,6 +63,7 @@ mitk::StandaloneDataStorage::~StandaloneDataStorage()
     it != m_SourceNodes.end(); it++)
   {
     this->RemoveListeners(it->first);
+    this->RemoveFromIndex(it->first);
   }
 }
 
@@ -89,6 +116,7 @@ void mitk::StandaloneDataStorage::Add(mitk::DataNode* node, const mitk::DataStor
 
     // register for ITK changed events
     this->AddListeners(node);
+    this->AddToIndex(node);
   }
 
   /* Notify observers */
@@ -119,6 +147,7 @@ void mitk::StandaloneDataStorage::Remove(const mitk::DataNode* node)
   EmitRemoveNodeEvent(node);
   {
     itk::MutexLockHolder<itk::SimpleFastMutexLock> locked(m_Mutex);
+    this->RemoveFromIndex(node);
     /* remove node from both relation adjacency lists */
     this->RemoveFromRelation(node, m_SourceNodes);
     this->RemoveFromRelation(node, m_DerivedNodes);
@@ -168,6 +197,244 @@ mitk::DataStorage::SetOfObjects::ConstPointer mitk::StandaloneDataStorage::GetAl
 }
 
 
+mitk::DataStorage::SetOfObjects::ConstPointer mitk::StandaloneDataStorage::GetSubset(const NodePredicateBase* condition) const
+{
+  if (condition == NULL)
+    return Superclass::GetSubset(condition);
+
+  mitk::DataStorage::SetOfObjects::Pointer candidateSet = mitk::DataStorage::SetOfObjects::New();
+  {
+    itk::MutexLockHolder<itk::SimpleFastMutexLock> locked(m_IndexMutex);
+    this->UpdateIndex();
+    NodeSet candidates;
+    if (!this->GetIndexedCandidates(condition, candidates))
+      candidateSet = NULL;
+    else
+      for (NodeSet::const_iterator it = candidates.begin(); it != candidates.end(); ++it)
+        candidateSet->InsertElement(candidateSet->Size(), const_cast<mitk::DataNode*>(*it));
+  }
+
+  if (candidateSet.IsNull())  // condition can not be answered from the indices, check all nodes
+    return Superclass::GetSubset(condition);
+  return this->FilterSetOfObjects(candidateSet, condition);
+}
+
+
+void mitk::StandaloneDataStorage::AddPropertyIndex(const std::string& propertyKey)
+{
+  itk::MutexLockHolder<itk::SimpleFastMutexLock> locked(m_IndexMutex);
+  if (m_PropertyIndices.find(propertyKey) != m_PropertyIndices.end())
+    return;
+
+  m_PropertyIndices[propertyKey];
+  for (IndexEntries::const_iterator it = m_IndexEntries.begin(); it != m_IndexEntries.end(); ++it)
+    m_OutdatedIndexEntries.insert(it->first);
+}
+
+
+void mitk::StandaloneDataStorage::AddToIndex(const mitk::DataNode* node)
+{
+  if (node == NULL)
+    return;
+
+  itk::MutexLockHolder<itk::SimpleFastMutexLock> locked(m_IndexMutex);
+  IndexEntry& entry = m_IndexEntries[node];
+  entry.NodeObserverTag = const_cast<mitk::DataNode*>(node)->AddObserver(itk::ModifiedEvent(), m_IndexModifiedCommand);
+  // the values are read on the next query, nodes are often modified right after they were added
+  m_OutdatedIndexEntries.insert(node);
+}
+
+
+void mitk::StandaloneDataStorage::RemoveFromIndex(const mitk::DataNode* node)
+{
+  itk::MutexLockHolder<itk::SimpleFastMutexLock> locked(m_IndexMutex);
+  IndexEntries::iterator it = m_IndexEntries.find(node);
+  if (it == m_IndexEntries.end())
+    return;
+
+  this->ClearIndexEntry(node, it->second);
+  const_cast<mitk::DataNode*>(node)->RemoveObserver(it->second.NodeObserverTag);
+  m_OutdatedIndexEntries.erase(node);
+  m_IndexEntries.erase(it);
+}
+
+
+void mitk::StandaloneDataStorage::ClearIndexEntry(const mitk::DataNode* node, IndexEntry& entry) const
+{
+  if (!entry.DataType.empty())
+  {
+    ValueIndex::iterator bucket = m_DataTypeIndex.find(entry.DataType);
+    bucket->second.erase(node);
+    if (bucket->second.empty())
+      m_DataTypeIndex.erase(bucket);
+  }
+
+  for (std::map<std::string, std::string>::const_iterator it = entry.PropertyValues.begin(); it != entry.PropertyValues.end(); ++it)
+  {
+    ValueIndex& index = m_PropertyIndices[it->first];
+    ValueIndex::iterator bucket = index.find(it->second);
+    bucket->second.erase(node);
+    if (bucket->second.empty())
+      index.erase(bucket);
+  }
+
+  for (std::vector<std::pair<mitk::BaseProperty::Pointer, unsigned long> >::const_iterator it = entry.PropertyObserverTags.begin(); it != entry.PropertyObserverTags.end(); ++it)
+  {
+    it->first->RemoveObserver(it->second);
+    typedef std::multimap<const itk::Object*, const mitk::DataNode*>::iterator PropertyIterator;
+    std::pair<PropertyIterator, PropertyIterator> range = m_IndexedProperties.equal_range(it->first.GetPointer());
+    for (PropertyIterator p = range.first; p != range.second; ++p)
+      if (p->second == node)
+      {
+        m_IndexedProperties.erase(p);
+        break;
+      }
+  }
+
+  entry.DataType.clear();
+  entry.PropertyValues.clear();
+  entry.PropertyObserverTags.clear();
+}
+
+
+void mitk::StandaloneDataStorage::UpdateIndex() const
+{
+  for (NodeSet::const_iterator it = m_OutdatedIndexEntries.begin(); it != m_OutdatedIndexEntries.end(); ++it)
+  {
+    const mitk::DataNode* node = *it;
+    IndexEntry& entry = m_IndexEntries[node];
+    this->ClearIndexEntry(node, entry);
+
+    // the data of lazily loaded nodes is not read for the index
+    mitk::LazyDataLoader::Pointer loader = node->GetDataLoader();
+    if (loader.IsNotNull())
+    {
+      entry.DataType = loader->GetDataType();
+      m_DataTypeIndex[entry.DataType].insert(node);
+    }
+    else if (node->GetData() != NULL)
+    {
+      entry.DataType = node->GetData()->GetNameOfClass();
+      m_DataTypeIndex[entry.DataType].insert(node);
+    }
+
+    for (std::map<std::string, ValueIndex>::iterator index = m_PropertyIndices.begin(); index != m_PropertyIndices.end(); ++index)
+    {
+      mitk::BaseProperty* property = node->GetPropertyList()->GetProperty(index->first);
+      if (property == NULL)
+        continue;
+
+      std::string value = GetIndexValue(property);
+      entry.PropertyValues[index->first] = value;
+      index->second[value].insert(node);
+
+      // setting the value of a property does not modify the node, so the property itself is observed
+      if (!value.empty())
+      {
+        unsigned long tag = property->AddObserver(itk::ModifiedEvent(), m_IndexModifiedCommand);
+        entry.PropertyObserverTags.push_back(std::make_pair(mitk::BaseProperty::Pointer(property), tag));
+        m_IndexedProperties.insert(std::make_pair(property, node));
+      }
+    }
+  }
+  m_OutdatedIndexEntries.clear();
+}
+
+
+bool mitk::StandaloneDataStorage::GetIndexedCandidates(const NodePredicateBase* condition, NodeSet& candidates) const
+{
+  if (const mitk::NodePredicateProperty* propertyCondition = dynamic_cast<const mitk::NodePredicateProperty*>(condition))
+  {
+    if (propertyCondition->GetRenderer() != NULL)
+      return false;
+    std::map<std::string, ValueIndex>::const_iterator index = m_PropertyIndices.find(propertyCondition->GetPropertyName());
+    if (index == m_PropertyIndices.end())
+      return false;
+
+    if (propertyCondition->GetValidProperty() == NULL)
+    {
+      for (ValueIndex::const_iterator bucket = index->second.begin(); bucket != index->second.end(); ++bucket)
+        candidates.insert(bucket->second.begin(), bucket->second.end());
+    }
+    else
+    {
+      ValueIndex::const_iterator bucket = index->second.find(GetIndexValue(propertyCondition->GetValidProperty()));
+      if (bucket != index->second.end())
+        candidates = bucket->second;
+    }
+    return true;
+  }
+
+  if (const mitk::NodePredicateDataType* typeCondition = dynamic_cast<const mitk::NodePredicateDataType*>(condition))
+  {
+    ValueIndex::const_iterator bucket = m_DataTypeIndex.find(typeCondition->GetValidDataType());
+    if (bucket != m_DataTypeIndex.end())
+      candidates = bucket->second;
+    return true;
+  }
+
+  if (const mitk::NodePredicateAnd* andCondition = dynamic_cast<const mitk::NodePredicateAnd*>(condition))
+  {
+    // intersection of the candidates of all indexed children, the others are checked on the result
+    bool indexed = false;
+    mitk::NodePredicateCompositeBase::ChildPredicates children = andCondition->GetPredicates();
+    for (mitk::NodePredicateCompositeBase::ChildPredicates::const_iterator it = children.begin(); it != children.end(); ++it)
+    {
+      NodeSet childCandidates;
+      if (!this->GetIndexedCandidates(*it, childCandidates))
+        continue;
+      if (!indexed)
+      {
+        candidates.swap(childCandidates);
+        indexed = true;
+      }
+      else
+      {
+        NodeSet intersection;
+        std::set_intersection(candidates.begin(), candidates.end(), childCandidates.begin(), childCandidates.end(), std::inserter(intersection, intersection.end()));
+        candidates.swap(intersection);
+      }
+    }
+    return indexed;
+  }
+
+  if (const mitk::NodePredicateOr* orCondition = dynamic_cast<const mitk::NodePredicateOr*>(condition))
+  {
+    // union of the candidates of all children, so all of them have to be indexed
+    mitk::NodePredicateCompositeBase::ChildPredicates children = orCondition->GetPredicates();
+    if (children.empty())
+      return false;
+    for (mitk::NodePredicateCompositeBase::ChildPredicates::const_iterator it = children.begin(); it != children.end(); ++it)
+    {
+      NodeSet childCandidates;
+      if (!this->GetIndexedCandidates(*it, childCandidates))
+        return false;
+      candidates.insert(childCandidates.begin(), childCandidates.end());
+    }
+    return true;
+  }
+
+  return false;
+}
+
+
+void mitk::StandaloneDataStorage::OnIndexedObjectModified(const itk::Object* caller, const itk::EventObject& /*event*/)
+{
+  itk::MutexLockHolder<itk::SimpleFastMutexLock> locked(m_IndexMutex);
+  if (const mitk::DataNode* node = dynamic_cast<const mitk::DataNode*>(caller))
+  {
+    if (m_IndexEntries.find(node) != m_IndexEntries.end())
+      m_OutdatedIndexEntries.insert(node);
+    return;
+  }
+
+  typedef std::multimap<const itk::Object*, const mitk::DataNode*>::const_iterator PropertyIterator;
+  std::pair<PropertyIterator, PropertyIterator> range = m_IndexedProperties.equal_range(caller);
+  for (PropertyIterator it = range.first; it != range.second; ++it)
+    m_OutdatedIndexEntries.insert(it->second);
+}
+
+
 mitk::DataStorage::SetOfObjects::ConstPointer mitk::StandaloneDataStorage::GetRelations(const mitk::DataNode* node, const AdjacencyList& relation, const NodePredicateBase* condition, bool onlyDirectlyRelated) const
 {
   if (node == NULL)
@@ -19,6 +19,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "mitkMimeType.h"
 
 #include <algorithm>
+#include <typeinfo>
 
 #include <itksys/SystemTools.hxx>
 
@@ -125,6 +126,12 @@ bool CustomMimeType::AppliesTo(const std::string& path) const
   return MatchesExtension(path);
 }
 
+bool CustomMimeType::AppliesToExtensionOnly() const
+{
+  // child classes usually override AppliesTo() to look into the file
+  return typeid(*this) == typeid(CustomMimeType);
+}
+
 bool CustomMimeType::MatchesExtension(const std::string& path) const
 {
   std::string extension, filename;
@@ -20,6 +20,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <mitkDicomSeriesReader.h>
 #include <mitkImage.h>
 #include <mitkImageCast.h>
+#include <mitkLocaleSwitch.h>
 
 #include <itkGDCMSeriesFileNames.h>
 
@@ -1448,11 +1449,7 @@ void DicomSeriesReader::FixSpacingInformation( mitk::Image* image, const ImageBl
 
 void DicomSeriesReader::LoadDicom(const StringContainer &filenames, DataNode &node, bool sort, bool load4D, bool correctTilt, UpdateCallBackMethod callback, Image::Pointer preLoadedImageBlock)
 {
-  const char* previousCLocale = setlocale(LC_NUMERIC, nullptr);
-  setlocale(LC_NUMERIC, "C");
-  std::locale previousCppLocale( std::cin.getloc() );
-  std::locale l( "C" );
-  std::cin.imbue(l);
+  LocaleSwitch localeSwitch("C");
 
   ImageBlockDescriptor imageBlockDescriptor;
 
@@ -1569,8 +1566,6 @@ void DicomSeriesReader::LoadDicom(const StringContainer &filenames, DataNode &no
 
       node.SetData( image );
       node.SetName(patientName);
-      setlocale(LC_NUMERIC, previousCLocale);
-      std::cin.imbue(previousCppLocale);
     }
 
     MITK_DEBUG << "--------------------------------------------------------------------------------";
@@ -1585,10 +1580,6 @@ void DicomSeriesReader::LoadDicom(const StringContainer &filenames, DataNode &no
   }
   catch (std::exception& e)
   {
-    // reset locale then throw up
-    setlocale(LC_NUMERIC, previousCLocale);
-    std::cin.imbue(previousCppLocale);
-
     MITK_DEBUG << "Caught exception in DicomSeriesReader::LoadDicom";
 
     throw e;
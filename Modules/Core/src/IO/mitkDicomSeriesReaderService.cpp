@@ -21,6 +21,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <mitkDicomSeriesReader.h>
 #include <mitkProgressBar.h>
 #include <mitkImage.h>
+#include <mitkLocaleSwitch.h>
 
 #include <iostream>
 
@@ -36,11 +37,7 @@ std::vector<itk::SmartPointer<BaseData> > DicomSeriesReaderService::Read()
 {
   std::vector<BaseData::Pointer> result;
 
-  const char* previousCLocale = setlocale(LC_NUMERIC, NULL);
-  setlocale(LC_NUMERIC, "C");
-  std::locale previousCppLocale( std::cin.getloc() );
-  std::locale l( "C" );
-  std::cin.imbue(l);
+  LocaleSwitch localeSwitch("C");
 
   std::string fileName = this->GetLocalFileName();
   if (  DicomSeriesReader::IsPhilips3DDicom(fileName) )
@@ -56,8 +53,6 @@ std::vector<itk::SmartPointer<BaseData> > DicomSeriesReaderService::Read()
       data->GetPropertyList()->SetProperty("name", nameProp);
       result.push_back(data);
     }
-    setlocale(LC_NUMERIC, previousCLocale);
-    std::cin.imbue(previousCppLocale);
     return result;
 
   }
@@ -120,9 +115,6 @@ std::vector<itk::SmartPointer<BaseData> > DicomSeriesReaderService::Read()
     ProgressBar::GetInstance()->Progress();
   }
 
-  setlocale(LC_NUMERIC, previousCLocale);
-  std::cin.imbue(previousCppLocale);
-
   return result;
 }
 
@@ -0,0 +1,107 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include "mitkFileReaderReferenceCache.h"
+
+#include <usLDAPProp.h>
+#include <usModuleContext.h>
+#include <usServiceProperties.h>
+
+#include <itkMutexLockHolder.h>
+
+#include <algorithm>
+
+namespace mitk {
+
+FileReaderReferenceCache* FileReaderReferenceCache::s_Instance = NULL;
+
+FileReaderReferenceCache::FileReaderReferenceCache()
+  : m_Context(NULL)
+  , m_Generation(0)
+{
+}
+
+FileReaderReferenceCache::~FileReaderReferenceCache()
+{
+  if (s_Instance == this)
+  {
+    s_Instance = NULL;
+  }
+}
+
+void FileReaderReferenceCache::Start(us::ModuleContext* context)
+{
+  m_Context = context;
+  std::string filter = us::LDAPProp(us::ServiceConstants::OBJECTCLASS()) == us_service_interface_iid<IFileReader>();
+  m_Context->AddServiceListener(this, &FileReaderReferenceCache::ReaderServiceChanged, filter);
+  s_Instance = this;
+}
+
+void FileReaderReferenceCache::Stop()
+{
+  s_Instance = NULL;
+  if (m_Context != NULL)
+  {
+    m_Context->RemoveServiceListener(this, &FileReaderReferenceCache::ReaderServiceChanged);
+    m_Context = NULL;
+  }
+
+  itk::MutexLockHolder<itk::SimpleFastMutexLock> lock(m_Mutex);
+  m_References.clear();
+}
+
+FileReaderReferenceCache* FileReaderReferenceCache::GetInstance()
+{
+  return s_Instance;
+}
+
+std::vector<FileReaderReferenceCache::ReaderReference> FileReaderReferenceCache::GetReferences(const std::string& mimeTypeName)
+{
+  unsigned long generation = 0;
+  {
+    itk::MutexLockHolder<itk::SimpleFastMutexLock> lock(m_Mutex);
+    std::map<std::string, std::vector<ReaderReference> >::const_iterator iter = m_References.find(mimeTypeName);
+    if (iter != m_References.end())
+    {
+      return iter->second;
+    }
+    generation = m_Generation;
+  }
+
+  // query the registry without holding the lock, service events are
+  // delivered synchronously and need it to clear the cache
+  std::string filter = us::LDAPProp(us::ServiceConstants::OBJECTCLASS()) == us_service_interface_iid<IFileReader>() &&
+                       us::LDAPProp(IFileReader::PROP_MIMETYPE()) == mimeTypeName;
+  std::vector<ReaderReference> refs = m_Context->GetServiceReferences<IFileReader>(filter);
+  std::sort(refs.begin(), refs.end());
+
+  itk::MutexLockHolder<itk::SimpleFastMutexLock> lock(m_Mutex);
+  // a reader was (un)registered meanwhile, the result may be stale already
+  if (generation == m_Generation)
+  {
+    m_References[mimeTypeName] = refs;
+  }
+  return refs;
+}
+
+void FileReaderReferenceCache::ReaderServiceChanged(const us::ServiceEvent /*event*/)
+{
+  itk::MutexLockHolder<itk::SimpleFastMutexLock> lock(m_Mutex);
+  m_References.clear();
+  ++m_Generation;
+}
+
+}
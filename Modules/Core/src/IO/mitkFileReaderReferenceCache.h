@@ -0,0 +1,70 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#ifndef MITKFILEREADERREFERENCECACHE_H
+#define MITKFILEREADERREFERENCECACHE_H
+
+#include "mitkIFileReader.h"
+
+#include <usServiceEvent.h>
+#include <usServiceReference.h>
+
+#include <itkSimpleFastMutexLock.h>
+
+#include <map>
+
+namespace mitk {
+
+/**
+ * @brief Caches the ranked IFileReader references per mime-type name.
+ *
+ * The cache is cleared whenever an IFileReader service is registered,
+ * modified or unregistered. It is owned by the Core module activator.
+ */
+class FileReaderReferenceCache
+{
+public:
+
+  typedef us::ServiceReference<IFileReader> ReaderReference;
+
+  FileReaderReferenceCache();
+  ~FileReaderReferenceCache();
+
+  void Start(us::ModuleContext* context);
+  void Stop();
+
+  /** @return The started cache or NULL */
+  static FileReaderReferenceCache* GetInstance();
+
+  /** @return The references of all readers for the mime-type, sorted by ascending ranking */
+  std::vector<ReaderReference> GetReferences(const std::string& mimeTypeName);
+
+private:
+
+  void ReaderServiceChanged(const us::ServiceEvent event);
+
+  us::ModuleContext* m_Context;
+
+  itk::SimpleFastMutexLock m_Mutex;
+  std::map<std::string, std::vector<ReaderReference> > m_References;
+  unsigned long m_Generation;
+
+  static FileReaderReferenceCache* s_Instance;
+};
+
+}
+
+#endif // MITKFILEREADERREFERENCECACHE_H
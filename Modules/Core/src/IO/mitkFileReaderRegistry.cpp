@@ -18,6 +18,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 #include "mitkIMimeTypeProvider.h"
 #include "mitkCoreServices.h"
+#include "mitkFileReaderReferenceCache.h"
 
 // Microservices
 #include <usGetModuleContext.h>
@@ -59,6 +60,13 @@ mitk::MimeType mitk::FileReaderRegistry::GetMimeTypeForFile(const std::string& p
 
 std::vector<mitk::FileReaderRegistry::ReaderReference> mitk::FileReaderRegistry::GetReferences(const MimeType& mimeType, us::ModuleContext* context)
 {
+  // all module contexts share the same service registry
+  FileReaderReferenceCache* cache = FileReaderReferenceCache::GetInstance();
+  if (cache != NULL)
+  {
+    return cache->GetReferences(mimeType.GetName());
+  }
+
   if (context == NULL) context = us::GetModuleContext();
 
   std::string filter = us::LDAPProp(us::ServiceConstants::OBJECTCLASS()) == us_service_interface_iid<IFileReader>() &&
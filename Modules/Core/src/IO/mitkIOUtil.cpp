@@ -29,17 +29,22 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <mitkFileWriterRegistry.h>
 #include <mitkCoreServices.h>
 #include <mitkIMimeTypeProvider.h>
+#include <mitkTracing.h>
 #include <usModuleResource.h>
 #include <usModuleResourceStream.h>
 
 //ITK
 #include <itksys/SystemTools.hxx>
+#include <itkMultiThreader.h>
+#include <itkMutexLockHolder.h>
+#include <itkSimpleFastMutexLock.h>
 
 //VTK
 #include <vtkPolyData.h>
 #include <vtkTriangleFilter.h>
 #include <vtkSmartPointer.h>
 
+#include <algorithm>
 #include <cerrno>
 #include <cstdlib>
 
@@ -328,6 +333,19 @@ struct IOUtil::Impl
     const IFileWriter::Options& m_Options;
   };
 
+  struct ParallelLoadData
+  {
+    const std::vector<std::string>* m_Paths;
+    std::vector<std::vector<BaseData::Pointer> > m_Outputs;
+    std::vector<std::string> m_Errors;
+    std::size_t m_NextPath;
+    itk::SimpleFastMutexLock m_Mutex;
+  };
+
+  static std::string LoadWithDefaultReader(const std::string& path, std::vector<BaseData::Pointer>& output);
+  static ITK_THREAD_RETURN_TYPE LoadThread(void* arg);
+  static std::string LoadInParallel(const std::vector<std::string>& paths, unsigned int numberOfThreads, std::vector<BaseData::Pointer>& result);
+
   static BaseData::Pointer LoadBaseDataFromFile(const std::string& path);
 
   static void SetDefaultDataNodeProperties(mitk::DataNode* node, const std::string& filePath = std::string());
@@ -548,27 +566,132 @@ DataStorage::SetOfObjects::Pointer IOUtil::Load(const std::vector<std::string>&
   return nodeResult;
 }
 
-std::vector<BaseData::Pointer> IOUtil::Load(const std::vector<std::string>& paths)
+std::vector<BaseData::Pointer> IOUtil::Load(const std::vector<std::string>& paths, unsigned int numberOfThreads)
 {
-  std::vector<BaseData::Pointer> result;
-  std::vector<LoadInfo> loadInfos;
-  for (auto loadInfo : paths)
-  {
+  MITK_TRACE_ZONE("IOUtil::Load", "io");
 
-    loadInfos.push_back(loadInfo);
+  if (paths.empty())
+  {
+    mitkThrow() << "No input files given";
   }
-  std::string errMsg = Load(loadInfos, NULL, NULL, NULL);
+
+  int filesToRead = static_cast<int>(paths.size());
+  mitk::ProgressBar::GetInstance()->AddStepsToDo(2*filesToRead);
+
+  std::vector<BaseData::Pointer> result;
+  std::string errMsg = Impl::LoadInParallel(paths, numberOfThreads, result);
+
+  mitk::ProgressBar::GetInstance()->Progress(2*filesToRead);
+
   if (!errMsg.empty())
   {
+    MITK_ERROR << errMsg;
     mitkThrow() << errMsg;
   }
+  return result;
+}
+
+std::string IOUtil::Impl::LoadWithDefaultReader(const std::string& path, std::vector<BaseData::Pointer>& output)
+{
+  MITK_TRACE_ZONE("IOUtil::LoadWithDefaultReader", "io");
 
-  for (std::vector<LoadInfo>::const_iterator iter = loadInfos.begin(), iterEnd = loadInfos.end();
-       iter != iterEnd; ++iter)
+  LoadInfo loadInfo(path);
+  if (loadInfo.m_ReaderSelector.IsEmpty())
   {
-    result.insert(result.end(), iter->m_Output.begin(), iter->m_Output.end());
+    if (!itksys::SystemTools::FileExists(path.c_str()))
+    {
+      return "File '" + path + "' does not exist\n";
+    }
+    return "No reader available for '" + path + "'\n";
   }
-  return result;
+
+  IFileReader* reader = loadInfo.m_ReaderSelector.GetSelected().GetReader();
+  if (reader == NULL)
+  {
+    return "Unexpected NULL reader.";
+  }
+
+  try
+  {
+    std::vector<BaseData::Pointer> baseData = reader->Read();
+    for (std::vector<BaseData::Pointer>::iterator iter = baseData.begin();
+         iter != baseData.end(); ++iter)
+    {
+      if (iter->IsNotNull())
+      {
+        (*iter)->SetProperty("path", mitk::StringProperty::New(path));
+        output.push_back(*iter);
+      }
+    }
+
+    if (output.empty())
+    {
+      return "Unknown read error occurred reading " + path;
+    }
+  }
+  catch (const std::exception& e)
+  {
+    return "Exception occured when reading file " + path + ":\n" + e.what() + "\n\n";
+  }
+  return std::string();
+}
+
+ITK_THREAD_RETURN_TYPE IOUtil::Impl::LoadThread(void* arg)
+{
+  ParallelLoadData* data = static_cast<ParallelLoadData*>(
+        static_cast<itk::MultiThreader::ThreadInfoStruct*>(arg)->UserData);
+
+  while (true)
+  {
+    std::size_t index = 0;
+    {
+      itk::MutexLockHolder<itk::SimpleFastMutexLock> lock(data->m_Mutex);
+      if (data->m_NextPath >= data->m_Paths->size())
+      {
+        break;
+      }
+      index = data->m_NextPath++;
+    }
+
+    // every file has its own reader selector and reader instances
+    data->m_Errors[index] = LoadWithDefaultReader((*data->m_Paths)[index], data->m_Outputs[index]);
+  }
+  return ITK_THREAD_RETURN_VALUE;
+}
+
+std::string IOUtil::Impl::LoadInParallel(const std::vector<std::string>& paths, unsigned int numberOfThreads, std::vector<BaseData::Pointer>& result)
+{
+  ParallelLoadData data;
+  data.m_Paths = &paths;
+  data.m_Outputs.resize(paths.size());
+  data.m_Errors.resize(paths.size());
+  data.m_NextPath = 0;
+
+  // readers that call setlocale() change the locale of all threads, so parallel reading is an opt-in of the caller
+  itk::ThreadIdType threads = std::min<itk::ThreadIdType>(
+        static_cast<itk::ThreadIdType>(numberOfThreads), static_cast<itk::ThreadIdType>(paths.size()));
+  if (threads > 1)
+  {
+    itk::MultiThreader::Pointer threader = itk::MultiThreader::New();
+    threader->SetNumberOfThreads(threads);
+    threader->SetSingleMethod(&Impl::LoadThread, &data);
+    threader->SingleMethodExecute();
+  }
+  else
+  {
+    itk::MultiThreader::ThreadInfoStruct threadInfo;
+    threadInfo.UserData = &data;
+    LoadThread(&threadInfo);
+  }
+
+  // keep the order of the given paths
+  std::string errMsg;
+  for (std::size_t i = 0; i < paths.size(); ++i)
+  {
+    errMsg += data.m_Errors[i];
+    result.insert(result.end(), data.m_Outputs[i].begin(), data.m_Outputs[i].end());
+  }
+  return errMsg;
 }
 
 int IOUtil::LoadFiles(const std::vector<std::string> &fileNames, DataStorage& ds)
@@ -645,6 +768,8 @@ std::string IOUtil::Load(std::vector<LoadInfo>& loadInfos,
                          DataStorage::SetOfObjects* nodeResult, DataStorage* ds,
                          ReaderOptionsFunctorBase* optionsCallback)
 {
+  MITK_TRACE_ZONE("IOUtil::Load", "io");
+
   if (loadInfos.empty())
   {
     return "No input files given";
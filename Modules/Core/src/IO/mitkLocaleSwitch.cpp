@@ -0,0 +1,95 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include "mitkLocaleSwitch.h"
+
+#include "mitkLogMacros.h"
+
+#include <clocale>
+
+#if defined(_WIN32)
+// per-thread locale, see _configthreadlocale()
+#elif defined(__APPLE__)
+#include <xlocale.h>
+#else
+#include <locale.h>
+#endif
+
+struct mitk::LocaleSwitch::Impl
+{
+#if defined(_WIN32)
+  Impl(const std::string& newLocale)
+    : m_OldThreadLocaleSetting(_configthreadlocale(_ENABLE_PER_THREAD_LOCALE))
+  {
+    // with the per-thread locale enabled, setlocale() only affects the calling thread
+    const char* oldLocale = setlocale(LC_ALL, nullptr);
+    if (oldLocale != nullptr)
+      m_OldLocale = oldLocale;
+
+    if (newLocale != m_OldLocale && setlocale(LC_ALL, newLocale.c_str()) == nullptr)
+    {
+      MITK_INFO << "Could not set locale " << newLocale;
+    }
+  }
+
+  ~Impl()
+  {
+    if (!m_OldLocale.empty() && setlocale(LC_ALL, m_OldLocale.c_str()) == nullptr)
+    {
+      MITK_INFO << "Could not reset locale " << m_OldLocale;
+    }
+    _configthreadlocale(m_OldThreadLocaleSetting);
+  }
+
+  std::string m_OldLocale;
+  int m_OldThreadLocaleSetting;
+#else
+  Impl(const std::string& newLocale)
+    : m_NewLocale(newlocale(LC_ALL_MASK, newLocale.c_str(), static_cast<locale_t>(0)))
+    , m_OldLocale(static_cast<locale_t>(0))
+  {
+    if (m_NewLocale == static_cast<locale_t>(0))
+    {
+      MITK_INFO << "Could not set locale " << newLocale;
+      return;
+    }
+    m_OldLocale = uselocale(m_NewLocale);
+  }
+
+  ~Impl()
+  {
+    if (m_NewLocale == static_cast<locale_t>(0))
+      return;
+
+    // LC_GLOBAL_LOCALE if the thread used the global locale before
+    uselocale(m_OldLocale);
+    freelocale(m_NewLocale);
+  }
+
+  locale_t m_NewLocale;
+  locale_t m_OldLocale;
+#endif
+};
+
+mitk::LocaleSwitch::LocaleSwitch(const std::string& newLocale)
+  : m_LocaleSwitchImpl(new Impl(newLocale))
+{
+}
+
+mitk::LocaleSwitch::~LocaleSwitch()
+{
+  delete m_LocaleSwitchImpl;
+}
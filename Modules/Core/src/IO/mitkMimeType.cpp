@@ -111,6 +111,11 @@ bool MimeType::AppliesTo(const std::string& path) const
   return m_Data->m_CustomMimeType->AppliesTo(path);
 }
 
+bool MimeType::AppliesToExtensionOnly() const
+{
+  return m_Data->m_CustomMimeType->AppliesToExtensionOnly();
+}
+
 bool MimeType::MatchesExtension(const std::string& path) const
 {
   return m_Data->m_CustomMimeType->MatchesExtension(path);
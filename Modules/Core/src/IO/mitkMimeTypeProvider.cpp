@@ -21,8 +21,12 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <usGetModuleContext.h>
 #include <usModuleContext.h>
 
+#include <itkMutexLockHolder.h>
+
 #include <itksys/SystemTools.hxx>
 
+#include <algorithm>
+
 #ifdef _MSC_VER
 #pragma warning(disable:4503) // decorated name length exceeded, name was truncated
 #pragma warning(disable:4355)
@@ -31,7 +35,8 @@ See LICENSE.txt or http://www.mitk.org for details.
 namespace mitk {
 
 MimeTypeProvider::MimeTypeProvider()
-  : m_Tracker(NULL)
+  : m_Tracker(NULL),
+    m_ExtensionCacheMisses(0)
 {
 }
 
@@ -56,6 +61,7 @@ void MimeTypeProvider::Stop()
 
 std::vector<MimeType> MimeTypeProvider::GetMimeTypes() const
 {
+  itk::MutexLockHolder<itk::SimpleFastMutexLock> lock(m_Mutex);
   std::vector<MimeType> result;
   for (const auto & elem : m_NameToMimeType)
   {
@@ -67,11 +73,35 @@ std::vector<MimeType> MimeTypeProvider::GetMimeTypes() const
 std::vector<MimeType> MimeTypeProvider::GetMimeTypesForFile(const std::string& filePath) const
 {
   std::vector<MimeType> result;
-  for (const auto & elem : m_NameToMimeType)
+  std::vector<MimeType> contentMimeTypes;
   {
-    if (elem.second.AppliesTo(filePath))
+    itk::MutexLockHolder<itk::SimpleFastMutexLock> lock(m_Mutex);
+    // there is at most one entry per registered extension
+    std::string key = this->GetExtensionKeyLocked(filePath);
+    ExtensionCacheType::const_iterator cacheIter = m_ExtensionCache.find(key);
+    if (cacheIter == m_ExtensionCache.end())
     {
-      result.push_back(elem.second);
+      ++m_ExtensionCacheMisses;
+      std::vector<MimeType> extensionMimeTypes;
+      for (const auto & elem : m_NameToMimeType)
+      {
+        if (elem.second.AppliesToExtensionOnly() && elem.second.AppliesTo(key))
+        {
+          extensionMimeTypes.push_back(elem.second);
+        }
+      }
+      cacheIter = m_ExtensionCache.insert(std::make_pair(key, extensionMimeTypes)).first;
+    }
+    result = cacheIter->second;
+    contentMimeTypes = m_ContentMimeTypes;
+  }
+
+  // these may read the file, do not block other threads meanwhile
+  for (const auto & mimeType : contentMimeTypes)
+  {
+    if (mimeType.AppliesTo(filePath))
+    {
+      result.push_back(mimeType);
     }
   }
   std::sort(result.begin(), result.end());
@@ -81,6 +111,7 @@ std::vector<MimeType> MimeTypeProvider::GetMimeTypesForFile(const std::string& f
 
 std::vector<MimeType> MimeTypeProvider::GetMimeTypesForCategory(const std::string& category) const
 {
+  itk::MutexLockHolder<itk::SimpleFastMutexLock> lock(m_Mutex);
   std::vector<MimeType> result;
   for (const auto & elem : m_NameToMimeType)
   {
@@ -94,6 +125,7 @@ std::vector<MimeType> MimeTypeProvider::GetMimeTypesForCategory(const std::strin
 
 MimeType MimeTypeProvider::GetMimeTypeForName(const std::string& name) const
 {
+  itk::MutexLockHolder<itk::SimpleFastMutexLock> lock(m_Mutex);
   std::map<std::string, MimeType>::const_iterator iter = m_NameToMimeType.find(name);
   if (iter != m_NameToMimeType.end()) return iter->second;
   return MimeType();
@@ -101,6 +133,7 @@ MimeType MimeTypeProvider::GetMimeTypeForName(const std::string& name) const
 
 std::vector<std::string> MimeTypeProvider::GetCategories() const
 {
+  itk::MutexLockHolder<itk::SimpleFastMutexLock> lock(m_Mutex);
   std::vector<std::string> result;
   for (const auto & elem : m_NameToMimeType)
   {
@@ -120,11 +153,13 @@ MimeTypeProvider::TrackedType MimeTypeProvider::AddingService(const ServiceRefer
   MimeType result = this->GetMimeType(reference);
   if (result.IsValid())
   {
+    itk::MutexLockHolder<itk::SimpleFastMutexLock> lock(m_Mutex);
     std::string name = result.GetName();
     m_NameToMimeTypes[name].insert(result);
 
     // get the highest ranked mime-type
     m_NameToMimeType[name] = *(m_NameToMimeTypes[name].rbegin());
+    this->MimeTypesChanged();
   }
   return result;
 }
@@ -136,6 +171,7 @@ void MimeTypeProvider::ModifiedService(const ServiceReferenceType& /*reference*/
 
 void MimeTypeProvider::RemovedService(const ServiceReferenceType& /*reference*/, TrackedType mimeType)
 {
+  itk::MutexLockHolder<itk::SimpleFastMutexLock> lock(m_Mutex);
   std::string name = mimeType.GetName();
   std::set<MimeType>& mimeTypes = m_NameToMimeTypes[name];
   mimeTypes.erase(mimeType);
@@ -149,6 +185,66 @@ void MimeTypeProvider::RemovedService(const ServiceReferenceType& /*reference*/,
     // get the highest ranked mime-type
     m_NameToMimeType[name] = *(mimeTypes.rbegin());
   }
+  this->MimeTypesChanged();
+}
+
+void MimeTypeProvider::MimeTypesChanged()
+{
+  m_ContentMimeTypes.clear();
+  m_Extensions.clear();
+  std::set<std::string::size_type> lengths;
+  for (const auto & elem : m_NameToMimeType)
+  {
+    if (!elem.second.AppliesToExtensionOnly())
+    {
+      m_ContentMimeTypes.push_back(elem.second);
+    }
+    else
+    {
+      for (const auto & extension : elem.second.GetExtensions())
+      {
+        if (!extension.empty())
+        {
+          m_Extensions.insert(itksys::SystemTools::LowerCase(extension));
+          lengths.insert(extension.size());
+        }
+      }
+    }
+  }
+  m_ExtensionLengths.assign(lengths.rbegin(), lengths.rend());
+  m_ExtensionCache.clear();
+}
+
+std::string MimeTypeProvider::GetExtensionKey(const std::string& filePath) const
+{
+  itk::MutexLockHolder<itk::SimpleFastMutexLock> lock(m_Mutex);
+  return this->GetExtensionKeyLocked(filePath);
+}
+
+unsigned long MimeTypeProvider::GetExtensionCacheMisses() const
+{
+  itk::MutexLockHolder<itk::SimpleFastMutexLock> lock(m_Mutex);
+  return m_ExtensionCacheMisses;
+}
+
+std::string MimeTypeProvider::GetExtensionKeyLocked(const std::string& filePath) const
+{
+  // extensions are matched case insensitive against the end of the path. Every extension
+  // that matches is a suffix of the longest one that matches, so the longest one decides
+  // which extension-only mime-types apply.
+  std::string path = itksys::SystemTools::LowerCase(filePath);
+  for (const auto & length : m_ExtensionLengths)
+  {
+    if (length <= path.size())
+    {
+      std::string suffix = path.substr(path.size() - length);
+      if (m_Extensions.count(suffix))
+      {
+        return suffix;
+      }
+    }
+  }
+  return std::string();
 }
 
 MimeType MimeTypeProvider::GetMimeType(const ServiceReferenceType& reference) const
@@ -17,12 +17,15 @@ See LICENSE.txt or http://www.mitk.org for details.
 #ifndef MITKMIMETYPEPROVIDER_H
 #define MITKMIMETYPEPROVIDER_H
 
+#include <MitkCoreExports.h>
 #include "mitkIMimeTypeProvider.h"
 #include "mitkCustomMimeType.h"
 
 #include "usServiceTracker.h"
 #include "usServiceTrackerCustomizer.h"
 
+#include <itkSimpleFastMutexLock.h>
+
 #include <set>
 
 namespace mitk {
@@ -46,7 +49,7 @@ struct MimeTypeTrackerTypeTraits : public us::TrackedTypeTraitsBase<MimeType,Mim
   }
 };
 
-class MimeTypeProvider : public IMimeTypeProvider,
+class MITKCORE_EXPORT MimeTypeProvider : public IMimeTypeProvider,
     private us::ServiceTrackerCustomizer<CustomMimeType, MimeType>
 {
 public:
@@ -64,6 +67,18 @@ public:
 
   virtual std::vector<std::string> GetCategories() const override;
 
+  /**
+   * \brief The key of filePath in the cache of extension-only mime-types.
+   *
+   * The longest extension of a registered extension-only mime-type that filePath ends with,
+   * in lower case, or an empty string if there is none. All file names with the same key
+   * share a cache entry, whatever their base name is.
+   */
+  std::string GetExtensionKey(const std::string& filePath) const;
+
+  /** \brief How often GetMimeTypesForFile() did not find the extension key in its cache. */
+  unsigned long GetExtensionCacheMisses() const;
+
 private:
 
   virtual TrackedType AddingService(const ServiceReferenceType& reference) override;
@@ -72,12 +87,32 @@ private:
 
   MimeType GetMimeType(const ServiceReferenceType& reference) const;
 
+  /** Rebuilds the list of content dependent mime-types and clears the cache */
+  void MimeTypesChanged();
+
+  /** GetExtensionKey() for callers that locked m_Mutex */
+  std::string GetExtensionKeyLocked(const std::string& filePath) const;
+
   us::ServiceTracker<CustomMimeType, MimeTypeTrackerTypeTraits>* m_Tracker;
 
   typedef std::map<std::string, std::set<MimeType> > MapType;
   MapType m_NameToMimeTypes;
 
   std::map<std::string, MimeType> m_NameToMimeType;
+
+  // mime-types whose AppliesTo() needs to look at each file
+  std::vector<MimeType> m_ContentMimeTypes;
+
+  // extension-only mime-types which apply to a file name extension
+  typedef std::map<std::string, std::vector<MimeType> > ExtensionCacheType;
+  mutable ExtensionCacheType m_ExtensionCache;
+  mutable unsigned long m_ExtensionCacheMisses;
+
+  // the lower case extensions of the extension-only mime-types and their lengths, longest first
+  std::set<std::string> m_Extensions;
+  std::vector<std::string::size_type> m_ExtensionLengths;
+
+  mutable itk::SimpleFastMutexLock m_Mutex;
 };
 
 }
@@ -91,8 +91,9 @@ float mitk::ImageVtkMapper2D::CalculateLayerDepth(mitk::BaseRenderer* renderer)
 
   //Due to a VTK bug, we cannot use the whole clipping range. /100 is empirically determined
   float depth = -maxRange*0.01; // divide by 100
+  static const mitk::PropertyKey layerKey("layer");
   int layer = 0;
-  GetDataNode()->GetIntProperty( "layer", layer, renderer);
+  GetDataNode()->GetIntProperty( layerKey, layer, renderer);
   //add the layer property for each image to render images with a higher layer on top of the others
   depth += layer*10; //*10: keep some room for each image (e.g. for QBalls in between)
   if(depth > 0.0f) {
@@ -325,7 +326,8 @@ void mitk::ImageVtkMapper2D::GenerateDataForRenderer( mitk::BaseRenderer *render
   //get the binary property
   bool binary = false;
   bool binaryOutline = false;
-  datanode->GetBoolProperty( "binary", binary, renderer );
+  static const mitk::PropertyKey binaryKey("binary");
+  datanode->GetBoolProperty( binaryKey, binary, renderer );
   if(binary) //binary image
   {
     datanode->GetBoolProperty( "outline binary", binaryOutline, renderer );
@@ -466,9 +468,10 @@ void mitk::ImageVtkMapper2D::ApplyColor( mitk::BaseRenderer* renderer )
   bool hover    = false;
   bool selected = false;
   bool binary = false;
+  static const mitk::PropertyKey binaryKey("binary");
   GetDataNode()->GetBoolProperty("binaryimage.ishovering", hover, renderer);
   GetDataNode()->GetBoolProperty("selected", selected, renderer);
-  GetDataNode()->GetBoolProperty("binary", binary, renderer);
+  GetDataNode()->GetBoolProperty(binaryKey, binary, renderer);
   if(binary && hover && !selected)
   {
     mitk::ColorProperty::Pointer colorprop = dynamic_cast<mitk::ColorProperty*>(GetDataNode()->GetProperty
@@ -479,7 +482,7 @@ void mitk::ImageVtkMapper2D::ApplyColor( mitk::BaseRenderer* renderer )
     }
     else
     {
-      GetDataNode()->GetColor( rgb, renderer, "color" );
+      GetDataNode()->GetColor(rgb, renderer);
     }
   }
   if(binary && selected)
@@ -491,12 +494,12 @@ void mitk::ImageVtkMapper2D::ApplyColor( mitk::BaseRenderer* renderer )
     }
     else
     {
-      GetDataNode()->GetColor(rgb, renderer, "color");
+      GetDataNode()->GetColor(rgb, renderer);
     }
   }
   if(!binary || (!hover && !selected))
   {
-    GetDataNode()->GetColor( rgb, renderer, "color" );
+    GetDataNode()->GetColor(rgb, renderer);
   }
 
   double rgbConv[3] = {(double)rgb[0], (double)rgb[1], (double)rgb[2]}; //conversion to double for VTK
@@ -522,7 +525,7 @@ void mitk::ImageVtkMapper2D::ApplyOpacity( mitk::BaseRenderer* renderer )
   LocalStorage* localStorage = this->GetLocalStorage( renderer );
   float opacity = 1.0f;
   // check for opacity prop and use it for rendering if it exists
-  GetDataNode()->GetOpacity( opacity, renderer, "opacity" );
+  GetDataNode()->GetOpacity(opacity, renderer);
   //set the opacity according to the properties
   localStorage->m_Actor->GetProperty()->SetOpacity(opacity);
   if ( localStorage->m_Actors->GetParts()->GetNumberOfItems() > 1 )
@@ -535,8 +538,9 @@ void mitk::ImageVtkMapper2D::ApplyRenderingMode( mitk::BaseRenderer* renderer )
 {
   LocalStorage* localStorage = m_LSH.GetLocalStorage(renderer);
 
+  static const mitk::PropertyKey binaryKey("binary");
   bool binary = false;
-  this->GetDataNode()->GetBoolProperty( "binary", binary, renderer );
+  this->GetDataNode()->GetBoolProperty( binaryKey, binary, renderer );
   if(binary) // is it a binary image?
   {
     //for binary images, we always use our default LuT and map every value to (0,1)
@@ -624,7 +628,7 @@ void mitk::ImageVtkMapper2D::Update(mitk::BaseRenderer* renderer)
 {
 
   bool visible = true;
-  GetDataNode()->GetVisibility(visible, renderer, "visible");
+  GetDataNode()->GetVisibility(visible, renderer);
 
   if ( !visible )
   {
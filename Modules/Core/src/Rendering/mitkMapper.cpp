@@ -20,6 +20,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "mitkBaseRenderer.h"
 #include "mitkProperties.h"
 #include "mitkOverlayManager.h"
+#include "mitkTracing.h"
 
 
 mitk::Mapper::Mapper()
@@ -105,6 +106,8 @@ void mitk::Mapper::CalculateTimeStep( mitk::BaseRenderer *renderer )
 
 void mitk::Mapper::Update(mitk::BaseRenderer *renderer)
 {
+  MITK_TRACE_ZONE(this->GetNameOfClass(), "rendering");
+
   if(GetOverlayManager())
     GetOverlayManager()->AddBaseRenderer(renderer);
 
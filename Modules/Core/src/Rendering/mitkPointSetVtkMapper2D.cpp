@@ -573,7 +573,7 @@ void mitk::PointSetVtkMapper2D::GenerateDataForRenderer( mitk::BaseRenderer *ren
 
   // toggle visibility
   bool visible = true;
-  node->GetVisibility(visible, renderer, "visible");
+  node->GetVisibility(visible, renderer);
   if(!visible)
   {
     ls->m_UnselectedActor->VisibilityOff();
@@ -355,7 +355,7 @@ void mitk::PointSetVtkMapper3D::CreateVTKRenderObjects()
 void mitk::PointSetVtkMapper3D::GenerateDataForRenderer( mitk::BaseRenderer *renderer )
 {
   bool visible = true;
-  GetDataNode()->GetVisibility(visible, renderer, "visible");
+  GetDataNode()->GetVisibility(visible, renderer);
   if(!visible)
   {
     m_UnselectedActor->VisibilityOff();
@@ -129,7 +129,7 @@ void mitk::SurfaceVtkMapper2D::Update(mitk::BaseRenderer* renderer)
   if( node == NULL )
     return;
   bool visible = true;
-  node->GetVisibility(visible, renderer, "visible");
+  node->GetVisibility(visible, renderer);
   if ( !visible )
     return;
 
@@ -274,9 +274,9 @@ void mitk::SurfaceVtkMapper2D::ApplyAllProperties(mitk::BaseRenderer* renderer)
 
   // check for color and opacity properties, use it for rendering if they exists
   float color[3]= { 1.0f, 1.0f, 1.0f };
-  node->GetColor(color, renderer, "color");
+  node->GetColor(color, renderer);
   float opacity = 1.0f;
-  node->GetOpacity(opacity, renderer, "opacity");
+  node->GetOpacity(opacity, renderer);
 
   //Pass properties to VTK
   localStorage->m_Actor->GetProperty()->SetColor(color[0], color[1], color[2]);
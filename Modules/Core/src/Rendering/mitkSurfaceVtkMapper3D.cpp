@@ -61,7 +61,7 @@ void mitk::SurfaceVtkMapper3D::GenerateDataForRenderer(mitk::BaseRenderer* rende
   LocalStorage *ls = m_LSH.GetLocalStorage(renderer);
 
   bool visible = true;
-  GetDataNode()->GetVisibility(visible, renderer, "visible");
+  GetDataNode()->GetVisibility(visible, renderer);
 
   if(!visible)
   {
@@ -54,7 +54,7 @@ void mitk::VtkMapper::MitkRenderOverlay(BaseRenderer* renderer)
 {
 
   bool visible = true;
-  GetDataNode()->GetVisibility(visible, renderer, "visible");
+  GetDataNode()->GetVisibility(visible, renderer);
   if ( !visible) return;
 
   if ( this->GetVtkProp(renderer)->GetVisibility() )
@@ -67,7 +67,7 @@ void mitk::VtkMapper::MitkRenderOpaqueGeometry(BaseRenderer* renderer)
 {
   bool visible = true;
 
-  GetDataNode()->GetVisibility(visible, renderer, "visible");
+  GetDataNode()->GetVisibility(visible, renderer);
   if ( !visible) return;
 
   if ( this->GetVtkProp(renderer)->GetVisibility() )
@@ -79,7 +79,7 @@ void mitk::VtkMapper::MitkRenderOpaqueGeometry(BaseRenderer* renderer)
 void mitk::VtkMapper::MitkRenderTranslucentGeometry(BaseRenderer* renderer)
 {
   bool visible = true;
-  GetDataNode()->GetVisibility(visible, renderer, "visible");
+  GetDataNode()->GetVisibility(visible, renderer);
   if ( !visible) return;
 
   if ( this->GetVtkProp(renderer)->GetVisibility() )
@@ -101,7 +101,7 @@ void mitk::VtkMapper::ApplyShaderProperties(mitk::BaseRenderer* renderer)
 void mitk::VtkMapper::MitkRenderVolumetricGeometry(BaseRenderer* renderer)
 {
   bool visible = true;
-  GetDataNode()->GetVisibility(visible, renderer, "visible");
+  GetDataNode()->GetVisibility(visible, renderer);
   if ( !visible) return;
 
   if ( GetVtkProp(renderer)->GetVisibility() )
@@ -139,9 +139,9 @@ void mitk::VtkMapper::ApplyColorAndOpacityProperties(BaseRenderer* renderer, vtk
   DataNode * node = GetDataNode();
 
   // check for color prop and use it for rendering if it exists
-  node->GetColor(rgba, renderer, "color");
+  node->GetColor(rgba, renderer);
   // check for opacity prop and use it for rendering if it exists
-  node->GetOpacity(rgba[3], renderer, "opacity");
+  node->GetOpacity(rgba[3], renderer);
 
   double drgba[4]={rgba[0],rgba[1],rgba[2],rgba[3]};
   actor->GetProperty()->SetColor(drgba);
@@ -244,7 +244,7 @@ void mitk::VtkPropRenderer::PrepareMapperQueue()
       continue;
 
     bool visible = true;
-    node->GetVisibility(visible, this, "visible");
+    node->GetVisibility(visible, this);
 
     // The information about LOD-enabled mappers is required by RenderingManager
     if ( mapper->IsLODEnabled( this ) && visible )
@@ -252,8 +252,9 @@ void mitk::VtkPropRenderer::PrepareMapperQueue()
       ++m_NumberOfVisibleLODEnabledMappers;
     }
     // mapper without a layer property get layer number 1
+    static const mitk::PropertyKey layerKey("layer");
     int layer = 1;
-    node->GetIntProperty("layer", layer, this);
+    node->GetIntProperty(layerKey, layer, this);
     int nr = (layer<<16) + mapperNo;
     m_MappersMap.insert( std::pair< int, Mapper * >( nr, mapper ) );
     mapperNo++;
@@ -29,6 +29,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <mitkSurfaceVtkXmlIO.h>
 #include <mitkImageVtkXmlIO.h>
 #include <mitkImageVtkLegacyIO.h>
+#include <mitkTracing.h>
 
 #include <mitkFileWriter.h>
 #include "mitkLegacyFileWriterService.h"
@@ -36,6 +37,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 #include <itkNiftiImageIO.h>
 #include <itkGDCMImageIO.h>
+#include <itksys/SystemTools.hxx>
 
 // Micro Services
 #include <usGetModuleContext.h>
@@ -267,6 +269,13 @@ void MitkCoreActivator::Load(us::ModuleContext* context)
 
   this->m_Context = context;
 
+  const char* traceFile = itksys::SystemTools::GetEnv("MITK_TRACE_FILE");
+  if (traceFile != nullptr && traceFile[0] != '\0')
+  {
+    m_TraceFile = traceFile;
+    mitk::Tracing::SetEnabled(true);
+  }
+
   // Add the current application directory to the auto-load paths.
   // This is useful for third-party executables.
   std::string programPath = mitk::IOUtil::GetProgramPath();
@@ -302,6 +311,9 @@ void MitkCoreActivator::Load(us::ModuleContext* context)
   m_MimeTypeProvider->Start();
   m_MimeTypeProviderReg = context->RegisterService<mitk::IMimeTypeProvider>(m_MimeTypeProvider.get());
 
+  m_FileReaderReferenceCache.reset(new mitk::FileReaderReferenceCache);
+  m_FileReaderReferenceCache->Start(context);
+
   this->RegisterDefaultMimeTypes();
   this->RegisterItkReaderWriter();
   this->RegisterVtkReaderWriter();
@@ -328,6 +340,19 @@ void MitkCoreActivator::Load(us::ModuleContext* context)
 
 void MitkCoreActivator::Unload(us::ModuleContext* )
 {
+  if (!m_TraceFile.empty())
+  {
+    mitk::Tracing::SetEnabled(false);
+    try
+    {
+      mitk::Tracing::WriteChromeTrace(m_TraceFile);
+    }
+    catch (const mitk::Exception& e)
+    {
+      MITK_ERROR << e.GetDescription();
+    }
+  }
+
   for(auto & elem : m_FileReaders)
   {
     delete elem;
@@ -359,6 +384,7 @@ void MitkCoreActivator::Unload(us::ModuleContext* )
   // actually valid.
   m_MimeTypeProviderReg.Unregister();
   m_MimeTypeProvider->Stop();
+  m_FileReaderReferenceCache->Stop();
 
   for (std::vector<mitk::CustomMimeType*>::const_iterator mimeTypeIter = m_DefaultMimeTypes.begin(),
        iterEnd = m_DefaultMimeTypes.end(); mimeTypeIter != iterEnd; ++mimeTypeIter)
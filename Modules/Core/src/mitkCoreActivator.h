@@ -30,6 +30,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <mitkPropertyExtensions.h>
 #include <mitkPropertyFilters.h>
 #include <mitkMimeTypeProvider.h>
+#include <mitkFileReaderReferenceCache.h>
 
 // Micro Services
 #include <usModuleActivator.h>
@@ -70,6 +71,7 @@ private:
   std::auto_ptr<mitk::PropertyExtensions> m_PropertyExtensions;
   std::auto_ptr<mitk::PropertyFilters> m_PropertyFilters;
   std::auto_ptr<mitk::MimeTypeProvider> m_MimeTypeProvider;
+  std::auto_ptr<mitk::FileReaderReferenceCache> m_FileReaderReferenceCache;
 
   // File IO
   std::vector<mitk::IFileReader*> m_FileReaders;
@@ -82,6 +84,9 @@ private:
   us::ServiceRegistration<mitk::IMimeTypeProvider> m_MimeTypeProviderReg;
 
   us::ModuleContext* m_Context;
+
+  // file from the MITK_TRACE_FILE environment variable
+  std::string m_TraceFile;
 };
 
 #endif // MITKCOREACTIVATOR_H_
@@ -80,6 +80,12 @@ set(MODULE_TESTS
   mitkRenderingManagerTest.cpp
   vtkMitkThickSlicesFilterTest.cpp
   mitkNodePredicateSourceTest.cpp
+  mitkDataStorageIndexTest.cpp
+  mitkDataStorageBatchTest.cpp
+  mitkPropertyKeyTest.cpp
+  mitkLazyDataLoaderTest.cpp
+  mitkMimeTypeProviderTest.cpp
+  mitkTracingTest.cpp
   mitkVectorTest.cpp
   mitkClippedSurfaceBoundsCalculatorTest.cpp
   mitkExceptionTest.cpp
@@ -0,0 +1,189 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include "mitkTestingMacros.h"
+#include <mitkTestFixture.h>
+#include <mitkStandaloneDataStorage.h>
+#include <itkCommand.h>
+
+class mitkDataStorageBatchTestSuite : public mitk::TestFixture
+{
+
+  CPPUNIT_TEST_SUITE(mitkDataStorageBatchTestSuite);
+  MITK_TEST(BatchScope_AddNodes_EventsDeferredToScopeEnd);
+  MITK_TEST(BatchScope_ModifyNodeRepeatedly_OneChangedEvent);
+  MITK_TEST(BatchScope_AddAndRemoveNode_NoEvents);
+  MITK_TEST(BatchScope_RemoveNode_NodeAliveDuringEvent);
+  MITK_TEST(BatchScope_Nested_EventsSentAtOutermostEnd);
+  MITK_TEST(EndBatch_WithoutBeginBatch_ThrowsException);
+  CPPUNIT_TEST_SUITE_END();
+
+private:
+
+  mitk::StandaloneDataStorage::Pointer m_DataStorage;
+
+  std::vector<const mitk::DataNode*> m_Added;
+  std::vector<const mitk::DataNode*> m_Removed;
+  std::vector<const mitk::DataNode*> m_Changed;
+  std::vector<mitk::DataStorage::BatchedNodeEvents> m_Batches;
+  std::vector<bool> m_RemovedNodeExisted;
+  bool m_NodeDeleted;
+
+  void OnAdd(const mitk::DataNode* node) { m_Added.push_back(node); }
+  void OnChanged(const mitk::DataNode* node) { m_Changed.push_back(node); }
+  void OnBatch(const mitk::DataStorage::BatchedNodeEvents& events) { m_Batches.push_back(events); }
+
+  void OnRemove(const mitk::DataNode* node)
+  {
+    m_Removed.push_back(node);
+    m_RemovedNodeExisted.push_back(!m_NodeDeleted);
+  }
+
+  void OnNodeDeleted() { m_NodeDeleted = true; }
+
+  void ClearEvents()
+  {
+    m_Added.clear();
+    m_Removed.clear();
+    m_Changed.clear();
+    m_Batches.clear();
+    m_RemovedNodeExisted.clear();
+    m_NodeDeleted = false;
+  }
+
+public:
+
+  void setUp() override
+  {
+    m_DataStorage = mitk::StandaloneDataStorage::New();
+    m_DataStorage->AddNodeEvent.AddListener(mitk::MessageDelegate1<mitkDataStorageBatchTestSuite, const mitk::DataNode*>(this, &mitkDataStorageBatchTestSuite::OnAdd));
+    m_DataStorage->RemoveNodeEvent.AddListener(mitk::MessageDelegate1<mitkDataStorageBatchTestSuite, const mitk::DataNode*>(this, &mitkDataStorageBatchTestSuite::OnRemove));
+    m_DataStorage->ChangedNodeEvent.AddListener(mitk::MessageDelegate1<mitkDataStorageBatchTestSuite, const mitk::DataNode*>(this, &mitkDataStorageBatchTestSuite::OnChanged));
+    m_DataStorage->BatchNodeEvent.AddListener(mitk::MessageDelegate1<mitkDataStorageBatchTestSuite, const mitk::DataStorage::BatchedNodeEvents&>(this, &mitkDataStorageBatchTestSuite::OnBatch));
+    this->ClearEvents();
+  }
+
+  void tearDown() override
+  {
+    m_DataStorage = nullptr;
+    this->ClearEvents();
+  }
+
+  void BatchScope_AddNodes_EventsDeferredToScopeEnd()
+  {
+    {
+      mitk::DataStorage::BatchScope batch(m_DataStorage);
+      for (int i = 0; i < 5; ++i)
+        m_DataStorage->Add(mitk::DataNode::New());
+      CPPUNIT_ASSERT_MESSAGE("Batching", m_DataStorage->IsBatching());
+      CPPUNIT_ASSERT_MESSAGE("No add events during the batch", m_Added.empty());
+    }
+
+    CPPUNIT_ASSERT_MESSAGE("Batch ended", !m_DataStorage->IsBatching());
+    CPPUNIT_ASSERT_EQUAL_MESSAGE("One batch event", 1u, (unsigned int)m_Batches.size());
+    CPPUNIT_ASSERT_EQUAL_MESSAGE("All nodes in the batch", 5u, (unsigned int)m_Batches[0].AddedNodes.size());
+    CPPUNIT_ASSERT_EQUAL_MESSAGE("Single add events after the batch", 5u, (unsigned int)m_Added.size());
+    CPPUNIT_ASSERT_MESSAGE("Changes of added nodes are not reported", m_Changed.empty());
+  }
+
+  void BatchScope_ModifyNodeRepeatedly_OneChangedEvent()
+  {
+    mitk::DataNode::Pointer node = mitk::DataNode::New();
+    m_DataStorage->Add(node);
+    this->ClearEvents();
+
+    {
+      mitk::DataStorage::BatchScope batch(m_DataStorage);
+      for (int i = 0; i < 10; ++i)
+        node->SetIntProperty("layer", i);
+      CPPUNIT_ASSERT_MESSAGE("No changed events during the batch", m_Changed.empty());
+    }
+
+    CPPUNIT_ASSERT_EQUAL_MESSAGE("One batch event", 1u, (unsigned int)m_Batches.size());
+    CPPUNIT_ASSERT_EQUAL_MESSAGE("Node changed once in the batch", 1u, (unsigned int)m_Batches[0].ChangedNodes.size());
+    CPPUNIT_ASSERT_EQUAL_MESSAGE("One changed event", 1u, (unsigned int)m_Changed.size());
+    CPPUNIT_ASSERT_MESSAGE("Changed event for the node", m_Changed[0] == node);
+  }
+
+  void BatchScope_AddAndRemoveNode_NoEvents()
+  {
+    {
+      mitk::DataStorage::BatchScope batch(m_DataStorage);
+      mitk::DataNode::Pointer node = mitk::DataNode::New();
+      m_DataStorage->Add(node);
+      node->SetName("temporary");
+      m_DataStorage->Remove(node);
+    }
+
+    CPPUNIT_ASSERT_MESSAGE("No batch event", m_Batches.empty());
+    CPPUNIT_ASSERT_MESSAGE("No add event", m_Added.empty());
+    CPPUNIT_ASSERT_MESSAGE("No remove event", m_Removed.empty());
+    CPPUNIT_ASSERT_MESSAGE("No changed event", m_Changed.empty());
+  }
+
+  void BatchScope_RemoveNode_NodeAliveDuringEvent()
+  {
+    mitk::DataNode::Pointer node = mitk::DataNode::New();
+    m_DataStorage->Add(node);
+    const mitk::DataNode* removed = node;
+    this->ClearEvents();
+
+    // the delete event tells whether the node is gone without dereferencing it
+    itk::SimpleMemberCommand<mitkDataStorageBatchTestSuite>::Pointer deleteCommand = itk::SimpleMemberCommand<mitkDataStorageBatchTestSuite>::New();
+    deleteCommand->SetCallbackFunction(this, &mitkDataStorageBatchTestSuite::OnNodeDeleted);
+    node->AddObserver(itk::DeleteEvent(), deleteCommand);
+
+    {
+      mitk::DataStorage::BatchScope batch(m_DataStorage);
+      node->SetName("removed");
+      m_DataStorage->Remove(node);
+      node = nullptr;
+      CPPUNIT_ASSERT_MESSAGE("No remove events during the batch", m_Removed.empty());
+    }
+
+    CPPUNIT_ASSERT_EQUAL_MESSAGE("One remove event", 1u, (unsigned int)m_Removed.size());
+    CPPUNIT_ASSERT_MESSAGE("Remove event for the node", m_Removed[0] == removed);
+    CPPUNIT_ASSERT_MESSAGE("Node still referenced by the batch", m_RemovedNodeExisted[0]);
+    CPPUNIT_ASSERT_MESSAGE("Changes of removed nodes are not reported", m_Changed.empty());
+
+    m_Batches.clear();
+    CPPUNIT_ASSERT_MESSAGE("Node released after the batch", m_NodeDeleted);
+  }
+
+  void BatchScope_Nested_EventsSentAtOutermostEnd()
+  {
+    {
+      mitk::DataStorage::BatchScope outer(m_DataStorage);
+      {
+        mitk::DataStorage::BatchScope inner(m_DataStorage);
+        m_DataStorage->Add(mitk::DataNode::New());
+      }
+      CPPUNIT_ASSERT_MESSAGE("No events at the end of the inner batch", m_Batches.empty() && m_Added.empty());
+      m_DataStorage->Add(mitk::DataNode::New());
+    }
+
+    CPPUNIT_ASSERT_EQUAL_MESSAGE("One batch event", 1u, (unsigned int)m_Batches.size());
+    CPPUNIT_ASSERT_EQUAL_MESSAGE("Nodes of both batches", 2u, (unsigned int)m_Batches[0].AddedNodes.size());
+  }
+
+  void EndBatch_WithoutBeginBatch_ThrowsException()
+  {
+    CPPUNIT_ASSERT_THROW(m_DataStorage->EndBatch(), std::logic_error);
+  }
+
+};
+
+MITK_TEST_SUITE_REGISTRATION(mitkDataStorageBatch)
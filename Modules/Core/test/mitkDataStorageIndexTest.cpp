@@ -0,0 +1,246 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include "mitkTestingMacros.h"
+#include <mitkTestFixture.h>
+#include <mitkStandaloneDataStorage.h>
+#include <mitkNodePredicateProperty.h>
+#include <mitkNodePredicateDataType.h>
+#include <mitkNodePredicateAnd.h>
+#include <mitkNodePredicateOr.h>
+#include <mitkNodePredicateNot.h>
+#include <mitkProperties.h>
+#include <mitkPointSet.h>
+#include <mitkSurface.h>
+#include <sstream>
+
+class mitkDataStorageIndexTestSuite : public mitk::TestFixture
+{
+
+  CPPUNIT_TEST_SUITE(mitkDataStorageIndexTestSuite);
+  MITK_TEST(GetNamedNode_AfterRenaming_FindsNewName);
+  MITK_TEST(GetSubset_DataType_FollowsSetData);
+  MITK_TEST(GetSubset_IndexedBoolProperty_EqualsLinearScan);
+  MITK_TEST(GetSubset_CompositePredicates_EqualsLinearScan);
+  MITK_TEST(GetSubset_RemovedNode_NotFound);
+  MITK_TEST(GetSubset_AfterAddRemoveAndChanges_EqualsLinearScan);
+  CPPUNIT_TEST_SUITE_END();
+
+private:
+
+  mitk::StandaloneDataStorage::Pointer m_DataStorage;
+
+  /** Reference result: the condition checked on all nodes in the order of GetAll() */
+  mitk::DataStorage::SetOfObjects::ConstPointer LinearSubset(const mitk::NodePredicateBase* condition)
+  {
+    mitk::DataStorage::SetOfObjects::ConstPointer all = m_DataStorage->GetAll();
+    mitk::DataStorage::SetOfObjects::Pointer result = mitk::DataStorage::SetOfObjects::New();
+    for (mitk::DataStorage::SetOfObjects::ConstIterator it = all->Begin(); it != all->End(); ++it)
+      if (condition->CheckNode(it.Value()))
+        result->InsertElement(result->Size(), it.Value());
+    return result.GetPointer();
+  }
+
+  void AssertEqualsLinearScan(const mitk::NodePredicateBase* condition, const std::string& message)
+  {
+    mitk::DataStorage::SetOfObjects::ConstPointer indexed = m_DataStorage->GetSubset(condition);
+    mitk::DataStorage::SetOfObjects::ConstPointer linear = this->LinearSubset(condition);
+    CPPUNIT_ASSERT_EQUAL_MESSAGE(message, linear->Size(), indexed->Size());
+    for (unsigned int i = 0; i < linear->Size(); ++i)
+      CPPUNIT_ASSERT_MESSAGE(message, linear->GetElement(i) == indexed->GetElement(i));
+  }
+
+  mitk::DataNode::Pointer AddNode(const std::string& name, mitk::BaseData* data)
+  {
+    mitk::DataNode::Pointer node = mitk::DataNode::New();
+    node->SetName(name);
+    node->SetData(data);
+    m_DataStorage->Add(node);
+    return node;
+  }
+
+public:
+
+  void setUp() override
+  {
+    m_DataStorage = mitk::StandaloneDataStorage::New();
+  }
+
+  void tearDown() override
+  {
+    m_DataStorage = nullptr;
+  }
+
+  void GetNamedNode_AfterRenaming_FindsNewName()
+  {
+    mitk::DataNode::Pointer node = this->AddNode("liver", mitk::PointSet::New());
+    this->AddNode("spleen", mitk::PointSet::New());
+    CPPUNIT_ASSERT_MESSAGE("Named node found", m_DataStorage->GetNamedNode("liver") == node);
+
+    node->SetName("kidney");
+    CPPUNIT_ASSERT_MESSAGE("Old name not found after SetName()", m_DataStorage->GetNamedNode("liver") == nullptr);
+    CPPUNIT_ASSERT_MESSAGE("New name found after SetName()", m_DataStorage->GetNamedNode("kidney") == node);
+
+    // changing the property object does not modify the node
+    dynamic_cast<mitk::StringProperty*>(node->GetProperty("name"))->SetValue("heart");
+    CPPUNIT_ASSERT_MESSAGE("Old name not found after changing the property", m_DataStorage->GetNamedNode("kidney") == nullptr);
+    CPPUNIT_ASSERT_MESSAGE("New name found after changing the property", m_DataStorage->GetNamedNode("heart") == node);
+  }
+
+  void GetSubset_DataType_FollowsSetData()
+  {
+    mitk::DataNode::Pointer node = this->AddNode("a", mitk::PointSet::New());
+    this->AddNode("b", mitk::Surface::New());
+    this->AddNode("c", nullptr);
+
+    mitk::NodePredicateDataType::Pointer isPointSet = mitk::NodePredicateDataType::New("PointSet");
+    mitk::NodePredicateDataType::Pointer isSurface = mitk::NodePredicateDataType::New("Surface");
+    CPPUNIT_ASSERT_EQUAL_MESSAGE("One point set", 1u, (unsigned int)m_DataStorage->GetSubset(isPointSet)->Size());
+
+    node->SetData(mitk::Surface::New());
+    CPPUNIT_ASSERT_EQUAL_MESSAGE("No point set after SetData()", 0u, (unsigned int)m_DataStorage->GetSubset(isPointSet)->Size());
+    this->AssertEqualsLinearScan(isSurface, "Surfaces after SetData()");
+  }
+
+  void GetSubset_IndexedBoolProperty_EqualsLinearScan()
+  {
+    m_DataStorage->AddPropertyIndex("helper object");
+    std::vector<mitk::DataNode::Pointer> nodes;
+    for (int i = 0; i < 20; ++i)
+    {
+      std::ostringstream name;
+      name << "node" << i;
+      nodes.push_back(this->AddNode(name.str(), mitk::PointSet::New()));
+      if (i % 3 == 0)
+        nodes.back()->SetBoolProperty("helper object", true);
+      else if (i % 3 == 1)
+        nodes.back()->SetBoolProperty("helper object", false);
+    }
+    nodes[4]->GetPropertyList()->ReplaceProperty("helper object", mitk::IntProperty::New(1));
+
+    mitk::NodePredicateProperty::Pointer isHelper = mitk::NodePredicateProperty::New("helper object", mitk::BoolProperty::New(true));
+    mitk::NodePredicateProperty::Pointer hasHelper = mitk::NodePredicateProperty::New("helper object");
+    mitk::NodePredicateProperty::Pointer isIntHelper = mitk::NodePredicateProperty::New("helper object", mitk::IntProperty::New(1));
+    this->AssertEqualsLinearScan(isHelper, "Bool value");
+    this->AssertEqualsLinearScan(hasHelper, "Existence");
+    this->AssertEqualsLinearScan(isIntHelper, "Property of another type");
+
+    dynamic_cast<mitk::BoolProperty*>(nodes[1]->GetProperty("helper object"))->SetValue(true);
+    nodes[0]->GetPropertyList()->DeleteProperty("helper object");
+    this->AssertEqualsLinearScan(isHelper, "Bool value after changes");
+    this->AssertEqualsLinearScan(hasHelper, "Existence after changes");
+  }
+
+  void GetSubset_CompositePredicates_EqualsLinearScan()
+  {
+    for (int i = 0; i < 30; ++i)
+    {
+      mitk::BaseData::Pointer data;
+      if (i % 2)
+        data = mitk::PointSet::New();
+      else
+        data = mitk::Surface::New();
+      std::ostringstream name;
+      name << "node" << i % 5;
+      this->AddNode(name.str(), data);
+    }
+
+    mitk::NodePredicateDataType::Pointer isPointSet = mitk::NodePredicateDataType::New("PointSet");
+    mitk::NodePredicateProperty::Pointer isNode3 = mitk::NodePredicateProperty::New("name", mitk::StringProperty::New("node3"));
+    mitk::NodePredicateProperty::Pointer isNode4 = mitk::NodePredicateProperty::New("name", mitk::StringProperty::New("node4"));
+    mitk::NodePredicateNot::Pointer notPointSet = mitk::NodePredicateNot::New(isPointSet);
+
+    this->AssertEqualsLinearScan(mitk::NodePredicateAnd::New(isPointSet, isNode3), "And of indexed predicates");
+    this->AssertEqualsLinearScan(mitk::NodePredicateAnd::New(notPointSet, isNode4), "And with an unindexed predicate");
+    this->AssertEqualsLinearScan(mitk::NodePredicateOr::New(isNode3, isNode4), "Or of indexed predicates");
+    this->AssertEqualsLinearScan(mitk::NodePredicateOr::New(notPointSet, isNode4), "Or with an unindexed predicate");
+  }
+
+  void GetSubset_RemovedNode_NotFound()
+  {
+    mitk::DataNode::Pointer node = this->AddNode("liver", mitk::PointSet::New());
+    CPPUNIT_ASSERT_MESSAGE("Named node found", m_DataStorage->GetNamedNode("liver") == node);
+    m_DataStorage->Remove(node);
+    CPPUNIT_ASSERT_MESSAGE("Removed node not found", m_DataStorage->GetNamedNode("liver") == nullptr);
+
+    node->SetName("spleen");
+    CPPUNIT_ASSERT_MESSAGE("Removed node not found after renaming", m_DataStorage->GetNamedNode("spleen") == nullptr);
+  }
+
+  /** Checks indexed name, type and property queries while nodes are added, removed and changed. */
+  void GetSubset_AfterAddRemoveAndChanges_EqualsLinearScan()
+  {
+    m_DataStorage->AddPropertyIndex("helper object");
+    std::vector<mitk::DataNode::Pointer> nodes;
+    for (int i = 0; i < 50; ++i)
+    {
+      std::ostringstream name;
+      name << "label " << i % 10;
+      mitk::BaseData::Pointer data;
+      if (i % 4)
+        data = mitk::PointSet::New();
+      else
+        data = mitk::Surface::New();
+      nodes.push_back(this->AddNode(name.str(), data));
+      nodes.back()->SetBoolProperty("helper object", i % 3 == 0);
+    }
+
+    std::vector<mitk::NodePredicateBase::Pointer> conditions;
+    conditions.push_back(mitk::NodePredicateProperty::New("name", mitk::StringProperty::New("label 3")).GetPointer());
+    conditions.push_back(mitk::NodePredicateProperty::New("name", mitk::StringProperty::New("renamed")).GetPointer());
+    conditions.push_back(mitk::NodePredicateDataType::New("PointSet").GetPointer());
+    conditions.push_back(mitk::NodePredicateDataType::New("Surface").GetPointer());
+    conditions.push_back(mitk::NodePredicateProperty::New("helper object", mitk::BoolProperty::New(true)).GetPointer());
+    conditions.push_back(mitk::NodePredicateAnd::New(conditions[0], conditions[2]).GetPointer());
+    conditions.push_back(mitk::NodePredicateOr::New(conditions[1], conditions[4]).GetPointer());
+
+    for (int step = 0; step < 4; ++step)
+    {
+      switch (step)
+      {
+        case 1: // remove every fifth node
+          for (std::size_t i = 0; i < nodes.size(); i += 5)
+            m_DataStorage->Remove(nodes[i]);
+          break;
+        case 2: // change name, data and properties of the remaining nodes
+          for (std::size_t i = 1; i < nodes.size(); i += 5)
+          {
+            nodes[i]->SetName("renamed");
+            nodes[i + 1]->SetData(mitk::Surface::New());
+            dynamic_cast<mitk::BoolProperty*>(nodes[i + 2]->GetProperty("helper object"))->SetValue(true);
+            nodes[i + 3]->GetPropertyList()->DeleteProperty("helper object");
+          }
+          break;
+        case 3: // add the removed nodes again and some new ones
+          for (std::size_t i = 0; i < nodes.size(); i += 5)
+            m_DataStorage->Add(nodes[i]);
+          for (int i = 0; i < 10; ++i)
+            this->AddNode("label 3", mitk::PointSet::New())->SetBoolProperty("helper object", true);
+          break;
+      }
+
+      for (std::size_t i = 0; i < conditions.size(); ++i)
+      {
+        std::ostringstream message;
+        message << "Condition " << i << " after step " << step;
+        this->AssertEqualsLinearScan(conditions[i], message.str());
+      }
+    }
+  }
+
+};
+
+MITK_TEST_SUITE_REGISTRATION(mitkDataStorageIndex)
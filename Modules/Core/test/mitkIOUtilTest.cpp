@@ -33,6 +33,7 @@ class mitkIOUtilTestSuite : public mitk::TestFixture
   MITK_TEST(TestNullSave);
   MITK_TEST(TestLoadAndSavePointSet);
   MITK_TEST(TestLoadAndSaveSurface);
+  MITK_TEST(TestLoadMultipleFiles);
   MITK_TEST(TestTempMethodsForUniqueFilenames);
   MITK_TEST(TestTempMethodsForUniqueFilenames);
   CPPUNIT_TEST_SUITE_END();
@@ -228,6 +229,35 @@ public:
     //delete the files after the test is done
     std::remove(surfacePath.c_str());
   }
+
+  void TestLoadMultipleFiles()
+  {
+    std::vector<std::string> paths;
+    paths.push_back(m_PointSetPath);
+    paths.push_back(m_SurfacePath);
+    paths.push_back(m_ImagePath);
+    paths.push_back(m_PointSetPath);
+
+    std::vector<mitk::BaseData::Pointer> data = mitk::IOUtil::Load(paths);
+    CPPUNIT_ASSERT_EQUAL(paths.size(), data.size());
+    CPPUNIT_ASSERT(dynamic_cast<mitk::PointSet*>(data[0].GetPointer()) != NULL);
+    CPPUNIT_ASSERT(dynamic_cast<mitk::Surface*>(data[1].GetPointer()) != NULL);
+    CPPUNIT_ASSERT(dynamic_cast<mitk::Image*>(data[2].GetPointer()) != NULL);
+    CPPUNIT_ASSERT(dynamic_cast<mitk::PointSet*>(data[3].GetPointer()) != NULL);
+    CPPUNIT_ASSERT(data[0] != data[3]);
+
+    // the readers of these files keep their locale changes on their own thread
+    std::vector<mitk::BaseData::Pointer> parallelData = mitk::IOUtil::Load(paths, 4);
+    CPPUNIT_ASSERT_EQUAL(paths.size(), parallelData.size());
+    CPPUNIT_ASSERT(dynamic_cast<mitk::PointSet*>(parallelData[0].GetPointer()) != NULL);
+    CPPUNIT_ASSERT(dynamic_cast<mitk::Surface*>(parallelData[1].GetPointer()) != NULL);
+    CPPUNIT_ASSERT(dynamic_cast<mitk::Image*>(parallelData[2].GetPointer()) != NULL);
+    CPPUNIT_ASSERT(dynamic_cast<mitk::PointSet*>(parallelData[3].GetPointer()) != NULL);
+
+    // the remaining files are read, the missing one is reported afterwards
+    paths.push_back(mitk::IOUtil::GetTempPath() + mitk::IOUtil::GetDirectorySeparator() + "mitkIOUtilTest-missing.nrrd");
+    CPPUNIT_ASSERT_THROW(mitk::IOUtil::Load(paths), mitk::Exception);
+  }
 };
 
 MITK_TEST_SUITE_REGISTRATION(mitkIOUtil)
@@ -0,0 +1,153 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include "mitkTestingMacros.h"
+#include <mitkTestFixture.h>
+#include <mitkLazyDataLoader.h>
+#include <mitkStandaloneDataStorage.h>
+#include <mitkNodePredicateDataType.h>
+#include <mitkPointSet.h>
+#include <itkMultiThreader.h>
+
+namespace
+{
+  /** Creates a point set and counts how often it is asked to */
+  class PointSetLoader : public mitk::LazyDataLoader
+  {
+  public:
+    mitkClassMacro(PointSetLoader, mitk::LazyDataLoader)
+    itkFactorylessNewMacro(Self)
+
+    virtual std::string GetDataType() const override { return "PointSet"; }
+
+    virtual mitk::BaseData::Pointer Load() override
+    {
+      ++m_Loads;
+      if (m_Data.IsNull())
+        m_Data = mitk::PointSet::New();
+      return m_Data.GetPointer();
+    }
+
+    unsigned int m_Loads;
+    mitk::PointSet::Pointer m_Data;
+
+  protected:
+    PointSetLoader() : m_Loads(0) {}
+  };
+
+  struct GetDataArgs
+  {
+    mitk::DataNode* Node;
+    mitk::BaseData* Data[4];
+  };
+
+  ITK_THREAD_RETURN_TYPE GetDataThread(void* arg)
+  {
+    itk::MultiThreader::ThreadInfoStruct* info = static_cast<itk::MultiThreader::ThreadInfoStruct*>(arg);
+    GetDataArgs* args = static_cast<GetDataArgs*>(info->UserData);
+    args->Data[info->ThreadID] = args->Node->GetData();
+    return ITK_THREAD_RETURN_VALUE;
+  }
+}
+
+class mitkLazyDataLoaderTestSuite : public mitk::TestFixture
+{
+
+  CPPUNIT_TEST_SUITE(mitkLazyDataLoaderTestSuite);
+  MITK_TEST(GetData_WithLoader_LoadsOnce);
+  MITK_TEST(GetData_FromSeveralThreads_LoadsOnce);
+  MITK_TEST(NodePredicateDataType_WithLoader_DoesNotLoad);
+  MITK_TEST(GetSubset_DataTypeWithLoader_DoesNotLoad);
+  MITK_TEST(SetData_WithLoader_DiscardsLoader);
+  CPPUNIT_TEST_SUITE_END();
+
+private:
+
+  mitk::DataNode::Pointer m_Node;
+  PointSetLoader::Pointer m_Loader;
+
+public:
+
+  void setUp() override
+  {
+    m_Loader = PointSetLoader::New();
+    m_Node = mitk::DataNode::New();
+    m_Node->SetName("lazy");
+    m_Node->SetDataLoader(m_Loader);
+  }
+
+  void tearDown() override
+  {
+    m_Node = nullptr;
+    m_Loader = nullptr;
+  }
+
+  void GetData_WithLoader_LoadsOnce()
+  {
+    CPPUNIT_ASSERT_MESSAGE("Data not loaded", !m_Node->IsDataLoaded());
+    CPPUNIT_ASSERT_EQUAL_MESSAGE("Nothing loaded before GetData()", 0u, m_Loader->m_Loads);
+
+    mitk::BaseData* data = m_Node->GetData();
+    CPPUNIT_ASSERT_MESSAGE("Loaded data returned", data == m_Loader->m_Data.GetPointer());
+    CPPUNIT_ASSERT_MESSAGE("Data loaded", m_Node->IsDataLoaded());
+    CPPUNIT_ASSERT_MESSAGE("Loader released", m_Node->GetDataLoader() == nullptr);
+
+    m_Node->GetData();
+    CPPUNIT_ASSERT_EQUAL_MESSAGE("Loaded once", 1u, m_Loader->m_Loads);
+    CPPUNIT_ASSERT_EQUAL_MESSAGE("Properties kept", std::string("lazy"), m_Node->GetName());
+  }
+
+  void GetData_FromSeveralThreads_LoadsOnce()
+  {
+    GetDataArgs args = { m_Node, { nullptr, nullptr, nullptr, nullptr } };
+    itk::MultiThreader::Pointer threader = itk::MultiThreader::New();
+    threader->SetNumberOfThreads(4);
+    threader->SetSingleMethod(&GetDataThread, &args);
+    threader->SingleMethodExecute();
+
+    CPPUNIT_ASSERT_EQUAL_MESSAGE("Loaded once", 1u, m_Loader->m_Loads);
+    for (int i = 0; i < threader->GetNumberOfThreads(); ++i)
+      CPPUNIT_ASSERT_MESSAGE("Loaded data returned to every thread", args.Data[i] == m_Loader->m_Data.GetPointer());
+  }
+
+  void NodePredicateDataType_WithLoader_DoesNotLoad()
+  {
+    CPPUNIT_ASSERT_MESSAGE("Type of the loader matches", mitk::NodePredicateDataType::New("PointSet")->CheckNode(m_Node));
+    CPPUNIT_ASSERT_MESSAGE("Other type does not match", !mitk::NodePredicateDataType::New("Image")->CheckNode(m_Node));
+    CPPUNIT_ASSERT_EQUAL_MESSAGE("Nothing loaded", 0u, m_Loader->m_Loads);
+  }
+
+  void GetSubset_DataTypeWithLoader_DoesNotLoad()
+  {
+    mitk::StandaloneDataStorage::Pointer storage = mitk::StandaloneDataStorage::New();
+    storage->Add(m_Node);
+
+    mitk::DataStorage::SetOfObjects::ConstPointer pointSets = storage->GetSubset(mitk::NodePredicateDataType::New("PointSet"));
+    CPPUNIT_ASSERT_EQUAL_MESSAGE("Node found by the type of its loader", 1u, (unsigned int)pointSets->Size());
+    CPPUNIT_ASSERT_EQUAL_MESSAGE("Nothing loaded", 0u, m_Loader->m_Loads);
+  }
+
+  void SetData_WithLoader_DiscardsLoader()
+  {
+    mitk::PointSet::Pointer pointSet = mitk::PointSet::New();
+    m_Node->SetData(pointSet);
+    CPPUNIT_ASSERT_MESSAGE("Data set", m_Node->GetData() == pointSet.GetPointer());
+    CPPUNIT_ASSERT_EQUAL_MESSAGE("Loader not used", 0u, m_Loader->m_Loads);
+  }
+
+};
+
+MITK_TEST_SUITE_REGISTRATION(mitkLazyDataLoader)
@@ -0,0 +1,180 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include "mitkTestingMacros.h"
+#include <mitkTestFixture.h>
+#include <mitkCoreServices.h>
+#include <mitkCustomMimeType.h>
+#include <mitkIMimeTypeProvider.h>
+
+// the cache is an implementation detail of the provider in the Core module
+#include "../src/IO/mitkMimeTypeProvider.h"
+
+#include <usGetModuleContext.h>
+#include <usModuleContext.h>
+
+namespace
+{
+  /** Applies to every file containing "peek" in its name */
+  class PeekingMimeType : public mitk::CustomMimeType
+  {
+  public:
+    PeekingMimeType() : mitk::CustomMimeType("application/vnd.mitk.test.peek") {}
+
+    virtual bool AppliesTo(const std::string& path) const override
+    {
+      return path.find("peek") != std::string::npos;
+    }
+
+    virtual PeekingMimeType* Clone() const override
+    {
+      return new PeekingMimeType(*this);
+    }
+  };
+}
+
+class mitkMimeTypeProviderTestSuite : public mitk::TestFixture
+{
+
+  CPPUNIT_TEST_SUITE(mitkMimeTypeProviderTestSuite);
+  MITK_TEST(GetMimeTypesForFile_RegisteredLater_Found);
+  MITK_TEST(GetMimeTypesForFile_Unregistered_NotFound);
+  MITK_TEST(GetMimeTypesForFile_ContentMimeType_CheckedPerFile);
+  MITK_TEST(GetMimeTypesForFile_DottedBaseNames_CacheHit);
+  MITK_TEST(GetExtensionKey_DoubleExtension_LongestMatch);
+  CPPUNIT_TEST_SUITE_END();
+
+private:
+
+  mitk::CustomMimeType m_MimeType;
+  us::ServiceRegistration<mitk::CustomMimeType> m_Registration;
+
+  static bool Contains(const std::vector<mitk::MimeType>& mimeTypes, const std::string& name)
+  {
+    for (const auto & mimeType : mimeTypes)
+    {
+      if (mimeType.GetName() == name) return true;
+    }
+    return false;
+  }
+
+  std::vector<mitk::MimeType> GetMimeTypesForFile(const std::string& path)
+  {
+    mitk::CoreServicePointer<mitk::IMimeTypeProvider> mimeTypeProvider(mitk::CoreServices::GetMimeTypeProvider());
+    return mimeTypeProvider->GetMimeTypesForFile(path);
+  }
+
+public:
+
+  void setUp() override
+  {
+    m_MimeType = mitk::CustomMimeType("application/vnd.mitk.test.cache");
+    m_MimeType.AddExtension("mimecachetest");
+  }
+
+  void tearDown() override
+  {
+    if (m_Registration)
+    {
+      m_Registration.Unregister();
+    }
+  }
+
+  void GetMimeTypesForFile_RegisteredLater_Found()
+  {
+    CPPUNIT_ASSERT_MESSAGE("Not registered yet", !Contains(GetMimeTypesForFile("/a/first.mimecachetest"), m_MimeType.GetName()));
+
+    m_Registration = us::GetModuleContext()->RegisterService<mitk::CustomMimeType>(&m_MimeType);
+    CPPUNIT_ASSERT_MESSAGE("Cache cleared on registration", Contains(GetMimeTypesForFile("/a/first.mimecachetest"), m_MimeType.GetName()));
+    CPPUNIT_ASSERT_MESSAGE("Same extension, other name", Contains(GetMimeTypesForFile("/b/second.MIMECACHETEST"), m_MimeType.GetName()));
+  }
+
+  void GetMimeTypesForFile_Unregistered_NotFound()
+  {
+    m_Registration = us::GetModuleContext()->RegisterService<mitk::CustomMimeType>(&m_MimeType);
+    CPPUNIT_ASSERT(Contains(GetMimeTypesForFile("/a/first.mimecachetest"), m_MimeType.GetName()));
+
+    m_Registration.Unregister();
+    m_Registration = us::ServiceRegistration<mitk::CustomMimeType>();
+    CPPUNIT_ASSERT_MESSAGE("Cache cleared on unregistration", !Contains(GetMimeTypesForFile("/a/first.mimecachetest"), m_MimeType.GetName()));
+  }
+
+  void GetMimeTypesForFile_ContentMimeType_CheckedPerFile()
+  {
+    PeekingMimeType peekingMimeType;
+    CPPUNIT_ASSERT(!peekingMimeType.AppliesToExtensionOnly());
+    CPPUNIT_ASSERT(m_MimeType.AppliesToExtensionOnly());
+
+    us::ServiceRegistration<mitk::CustomMimeType> registration =
+        us::GetModuleContext()->RegisterService<mitk::CustomMimeType>(&peekingMimeType);
+    CPPUNIT_ASSERT(Contains(GetMimeTypesForFile("/a/peek.mimecachetest"), peekingMimeType.GetName()));
+    CPPUNIT_ASSERT_MESSAGE("Not cached for the extension", !Contains(GetMimeTypesForFile("/a/other.mimecachetest"), peekingMimeType.GetName()));
+    registration.Unregister();
+  }
+
+  void GetMimeTypesForFile_DottedBaseNames_CacheHit()
+  {
+    m_Registration = us::GetModuleContext()->RegisterService<mitk::CustomMimeType>(&m_MimeType);
+    mitk::MimeTypeProvider provider;
+    provider.Start();
+
+    CPPUNIT_ASSERT(Contains(provider.GetMimeTypesForFile("/a/scan_2015.01.01.mimecachetest"), m_MimeType.GetName()));
+    unsigned long misses = provider.GetExtensionCacheMisses();
+
+    const char* paths[] = { "/a/scan_2015.01.02.mimecachetest", "/b/1.2.840.113619.2.55.3.mimecachetest", "/c/SCAN.V2.MimeCacheTest" };
+    for (const char* path : paths)
+    {
+      CPPUNIT_ASSERT_EQUAL_MESSAGE(path, std::string("mimecachetest"), provider.GetExtensionKey(path));
+      CPPUNIT_ASSERT_MESSAGE(path, Contains(provider.GetMimeTypesForFile(path), m_MimeType.GetName()));
+    }
+    CPPUNIT_ASSERT_EQUAL_MESSAGE("Dotted base names hit the cache", misses, provider.GetExtensionCacheMisses());
+
+    CPPUNIT_ASSERT_MESSAGE("Unknown extension", !Contains(provider.GetMimeTypesForFile("/a/scan_2015.01.01.unknownext"), m_MimeType.GetName()));
+    misses = provider.GetExtensionCacheMisses();
+    provider.GetMimeTypesForFile("/a/1.2.840.113619.2.55.4");
+    CPPUNIT_ASSERT_EQUAL_MESSAGE("All unknown extensions share one entry", misses, provider.GetExtensionCacheMisses());
+
+    provider.Stop();
+  }
+
+  void GetExtensionKey_DoubleExtension_LongestMatch()
+  {
+    mitk::CustomMimeType compressedMimeType("application/vnd.mitk.test.cache.gz");
+    compressedMimeType.AddExtension("mimecachetest.gz");
+    mitk::CustomMimeType gzMimeType("application/vnd.mitk.test.gz");
+    gzMimeType.AddExtension("gz");
+    us::ServiceRegistration<mitk::CustomMimeType> compressedRegistration =
+        us::GetModuleContext()->RegisterService<mitk::CustomMimeType>(&compressedMimeType);
+    us::ServiceRegistration<mitk::CustomMimeType> gzRegistration =
+        us::GetModuleContext()->RegisterService<mitk::CustomMimeType>(&gzMimeType);
+    mitk::MimeTypeProvider provider;
+    provider.Start();
+
+    CPPUNIT_ASSERT_EQUAL(std::string("mimecachetest.gz"), provider.GetExtensionKey("/a/scan.01.mimecachetest.GZ"));
+    CPPUNIT_ASSERT_EQUAL(std::string("gz"), provider.GetExtensionKey("/a/scan.01.other.gz"));
+    std::vector<mitk::MimeType> mimeTypes = provider.GetMimeTypesForFile("/a/scan.01.mimecachetest.gz");
+    CPPUNIT_ASSERT_MESSAGE("Longest extension", Contains(mimeTypes, compressedMimeType.GetName()));
+    CPPUNIT_ASSERT_MESSAGE("Shorter extension", Contains(mimeTypes, gzMimeType.GetName()));
+    CPPUNIT_ASSERT_MESSAGE("Shorter extension only", !Contains(provider.GetMimeTypesForFile("/a/scan.01.other.gz"), compressedMimeType.GetName()));
+
+    provider.Stop();
+    gzRegistration.Unregister();
+    compressedRegistration.Unregister();
+  }
+
+};
+
+MITK_TEST_SUITE_REGISTRATION(mitkMimeTypeProvider)
@@ -0,0 +1,146 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include "mitkTestingMacros.h"
+#include <mitkTestFixture.h>
+#include <mitkPropertyKey.h>
+#include <mitkPropertyList.h>
+#include <mitkDataNode.h>
+#include <mitkProperties.h>
+
+class mitkPropertyKeyTestSuite : public mitk::TestFixture
+{
+
+  CPPUNIT_TEST_SUITE(mitkPropertyKeyTestSuite);
+  MITK_TEST(PropertyKey_SameName_SameId);
+  MITK_TEST(Find_NameNeverInterned_InvalidKey);
+  MITK_TEST(GetProperty_ByKey_EqualsByName);
+  MITK_TEST(GetProperty_AfterReplaceDeleteAndClone_EqualsMap);
+  MITK_TEST(DeleteProperty_ReplacedAndDeleted_PropertyReleased);
+  MITK_TEST(DataNode_DefaultKeys_EqualsByName);
+  CPPUNIT_TEST_SUITE_END();
+
+public:
+
+  void PropertyKey_SameName_SameId()
+  {
+    mitk::PropertyKey a("mitkPropertyKeyTest.same");
+    mitk::PropertyKey b(std::string("mitkPropertyKeyTest.same"));
+    mitk::PropertyKey c("mitkPropertyKeyTest.other");
+    CPPUNIT_ASSERT_MESSAGE("Same name, same key", a == b);
+    CPPUNIT_ASSERT_MESSAGE("Different names, different keys", a != c);
+    CPPUNIT_ASSERT_EQUAL_MESSAGE("Name of the key", std::string("mitkPropertyKeyTest.same"), a.GetName());
+    CPPUNIT_ASSERT_MESSAGE("Find returns the interned key", mitk::PropertyKey::Find("mitkPropertyKeyTest.same") == a);
+  }
+
+  void Find_NameNeverInterned_InvalidKey()
+  {
+    mitk::PropertyKey key = mitk::PropertyKey::Find("mitkPropertyKeyTest.never interned");
+    CPPUNIT_ASSERT_MESSAGE("Invalid key", !key.IsValid());
+    CPPUNIT_ASSERT_MESSAGE("Empty name", key.GetName().empty());
+
+    mitk::PropertyList::Pointer list = mitk::PropertyList::New();
+    CPPUNIT_ASSERT_MESSAGE("Lookup by an unknown name", list->GetProperty("mitkPropertyKeyTest.never interned either") == nullptr);
+    CPPUNIT_ASSERT_MESSAGE("Lookup does not intern", !mitk::PropertyKey::Find("mitkPropertyKeyTest.never interned either").IsValid());
+  }
+
+  void GetProperty_ByKey_EqualsByName()
+  {
+    mitk::PropertyList::Pointer list = mitk::PropertyList::New();
+    list->SetBoolProperty("visible", true);
+    list->SetIntProperty("layer", 3);
+    list->SetFloatProperty("opacity", 0.5f);
+
+    const char* names[] = {"visible", "layer", "opacity", "color"};
+    for (int i = 0; i < 4; ++i)
+    {
+      CPPUNIT_ASSERT_MESSAGE("Key lookup equals name lookup", list->GetProperty(mitk::PropertyKey(names[i])) == list->GetProperty(names[i]));
+      mitk::PropertyList::PropertyMap::const_iterator it = list->GetMap()->find(names[i]);
+      mitk::BaseProperty* expected = it == list->GetMap()->end() ? nullptr : it->second.GetPointer();
+      CPPUNIT_ASSERT_MESSAGE("Name lookup equals map", list->GetProperty(names[i]) == expected);
+    }
+  }
+
+  void GetProperty_AfterReplaceDeleteAndClone_EqualsMap()
+  {
+    mitk::PropertyList::Pointer list = mitk::PropertyList::New();
+    list->SetBoolProperty("binary", false);
+    list->SetIntProperty("layer", 1);
+
+    mitk::StringProperty::Pointer replacement = mitk::StringProperty::New("yes");
+    list->ReplaceProperty("binary", replacement);
+    CPPUNIT_ASSERT_MESSAGE("Replaced property found", list->GetProperty(mitk::PropertyKey("binary")) == replacement.GetPointer());
+
+    list->DeleteProperty("layer");
+    CPPUNIT_ASSERT_MESSAGE("Deleted property not found", list->GetProperty(mitk::PropertyKey("layer")) == nullptr);
+
+    mitk::PropertyList::Pointer clone = list->Clone();
+    CPPUNIT_ASSERT_MESSAGE("Cloned property found", clone->GetProperty(mitk::PropertyKey("binary")) == clone->GetMap()->find("binary")->second.GetPointer());
+    CPPUNIT_ASSERT_MESSAGE("Cloned property is a copy", clone->GetProperty("binary") != replacement.GetPointer());
+
+    list->Clear();
+    CPPUNIT_ASSERT_MESSAGE("No property after Clear()", list->GetProperty(mitk::PropertyKey("binary")) == nullptr);
+  }
+
+  void DeleteProperty_ReplacedAndDeleted_PropertyReleased()
+  {
+    mitk::PropertyList::Pointer list = mitk::PropertyList::New();
+    mitk::IntProperty::Pointer first = mitk::IntProperty::New(1);
+    mitk::IntProperty::Pointer second = mitk::IntProperty::New(2);
+    const int unreferenced = first->GetReferenceCount();
+
+    list->ReplaceProperty("layer", first);
+    list->ReplaceProperty("layer", second);
+    CPPUNIT_ASSERT_EQUAL_MESSAGE("Replaced property released", unreferenced, first->GetReferenceCount());
+    CPPUNIT_ASSERT_MESSAGE("Replacement found by key", list->GetProperty(mitk::PropertyKey("layer")) == second.GetPointer());
+
+    list->DeleteProperty("layer");
+    CPPUNIT_ASSERT_EQUAL_MESSAGE("Deleted property released", unreferenced, second->GetReferenceCount());
+  }
+
+  void DataNode_DefaultKeys_EqualsByName()
+  {
+    mitk::DataNode::Pointer node = mitk::DataNode::New();
+    node->SetVisibility(false);
+    node->SetOpacity(0.5f);
+    node->SetColor(1.0, 0.5, 0.25);
+    node->SetIntProperty("layer", 3);
+    node->SetBoolProperty("binary", true);
+
+    float color[3] = {0, 0, 0};
+    float expectedColor[3] = {0, 0, 0};
+    CPPUNIT_ASSERT_MESSAGE("Color found", node->GetColor(color) && node->GetColor(expectedColor, nullptr, "color"));
+    for (int i = 0; i < 3; ++i)
+      CPPUNIT_ASSERT_EQUAL_MESSAGE("Color", expectedColor[i], color[i]);
+
+    float opacity = 1.0f;
+    CPPUNIT_ASSERT_MESSAGE("Opacity found", node->GetOpacity(opacity, nullptr));
+    CPPUNIT_ASSERT_EQUAL_MESSAGE("Opacity", 0.5f, opacity);
+    CPPUNIT_ASSERT_MESSAGE("Visibility", !node->IsVisible(nullptr) && !node->IsVisible(nullptr, "visible"));
+
+    int layer = 0;
+    bool binary = false;
+    CPPUNIT_ASSERT_MESSAGE("Layer by key", node->GetIntProperty(mitk::PropertyKey("layer"), layer) && layer == 3);
+    CPPUNIT_ASSERT_MESSAGE("Binary by key", node->GetBoolProperty(mitk::PropertyKey("binary"), binary) && binary);
+    CPPUNIT_ASSERT_MESSAGE("Property of another type", !node->GetBoolProperty(mitk::PropertyKey("layer"), binary));
+
+    node->GetPropertyList()->DeleteProperty("visible");
+    CPPUNIT_ASSERT_MESSAGE("Visible without property", node->IsVisible(nullptr));
+  }
+
+};
+
+MITK_TEST_SUITE_REGISTRATION(mitkPropertyKey)
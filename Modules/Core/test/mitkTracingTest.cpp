@@ -0,0 +1,145 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include "mitkTestingMacros.h"
+#include <mitkTestFixture.h>
+#include <mitkTracing.h>
+
+#include <itkMultiThreader.h>
+
+#include <sstream>
+
+namespace
+{
+  ITK_THREAD_RETURN_TYPE TraceThread(void*)
+  {
+    MITK_TRACE_ZONE("thread", "test");
+    return ITK_THREAD_RETURN_VALUE;
+  }
+}
+
+class mitkTracingTestSuite : public mitk::TestFixture
+{
+
+  CPPUNIT_TEST_SUITE(mitkTracingTestSuite);
+  MITK_TEST(TraceZone_Disabled_NotRecorded);
+  MITK_TEST(TraceZone_Nested_Recorded);
+  MITK_TEST(TraceZone_FullBuffer_KeepsNewest);
+  MITK_TEST(TraceZone_Threads_RecordedPerThread);
+  MITK_TEST(TraceZone_ManyShortThreads_NoneDropped);
+  MITK_TEST(WriteChromeTrace_EscapesNames);
+  CPPUNIT_TEST_SUITE_END();
+
+public:
+
+  void setUp() override
+  {
+    mitk::Tracing::SetEnabled(false);
+    mitk::Tracing::Clear();
+  }
+
+  void tearDown() override
+  {
+    mitk::Tracing::SetEnabled(false);
+    mitk::Tracing::Clear();
+  }
+
+  void TraceZone_Disabled_NotRecorded()
+  {
+    {
+      MITK_TRACE_ZONE("disabled", "test");
+    }
+    CPPUNIT_ASSERT_MESSAGE("Nothing recorded", mitk::Tracing::GetStatistics().empty());
+  }
+
+  void TraceZone_Nested_Recorded()
+  {
+    mitk::Tracing::SetEnabled(true);
+    {
+      MITK_TRACE_ZONE("outer", "test");
+      for (int i = 0; i < 3; ++i)
+      {
+        MITK_TRACE_ZONE("inner", "test");
+      }
+    }
+
+    std::map<std::string, mitk::Tracing::ZoneStatistics> statistics = mitk::Tracing::GetStatistics();
+    CPPUNIT_ASSERT_EQUAL_MESSAGE("Two zone names", 2u, (unsigned int)statistics.size());
+    CPPUNIT_ASSERT_EQUAL_MESSAGE("Outer zone once", 1ul, statistics["outer"].Count);
+    CPPUNIT_ASSERT_EQUAL_MESSAGE("Inner zone three times", 3ul, statistics["inner"].Count);
+    CPPUNIT_ASSERT_MESSAGE("Outer zone contains inner zones", statistics["outer"].TotalTime >= statistics["inner"].TotalTime);
+  }
+
+  void TraceZone_FullBuffer_KeepsNewest()
+  {
+    mitk::Tracing::SetEnabled(true);
+    for (std::size_t i = 0; i < mitk::Tracing::GetBufferCapacity(); ++i)
+    {
+      MITK_TRACE_ZONE("old", "test");
+    }
+    for (int i = 0; i < 10; ++i)
+    {
+      MITK_TRACE_ZONE("new", "test");
+    }
+
+    std::map<std::string, mitk::Tracing::ZoneStatistics> statistics = mitk::Tracing::GetStatistics();
+    CPPUNIT_ASSERT_EQUAL_MESSAGE("Newest events kept", 10ul, statistics["new"].Count);
+    CPPUNIT_ASSERT_EQUAL_MESSAGE("Oldest events overwritten", (unsigned long)mitk::Tracing::GetBufferCapacity() - 11, statistics["old"].Count);
+  }
+
+  void TraceZone_Threads_RecordedPerThread()
+  {
+    mitk::Tracing::SetEnabled(true);
+    itk::MultiThreader::Pointer threader = itk::MultiThreader::New();
+    threader->SetNumberOfThreads(4);
+    threader->SetSingleMethod(&TraceThread, nullptr);
+    threader->SingleMethodExecute();
+
+    CPPUNIT_ASSERT_EQUAL_MESSAGE("Zone of every thread recorded", 4ul, mitk::Tracing::GetStatistics()["thread"].Count);
+  }
+
+  void TraceZone_ManyShortThreads_NoneDropped()
+  {
+    mitk::Tracing::SetEnabled(true);
+    itk::MultiThreader::Pointer threader = itk::MultiThreader::New();
+    threader->SetNumberOfThreads(2);
+    threader->SetSingleMethod(&TraceThread, nullptr);
+    for (int i = 0; i < 300; ++i)
+    {
+      threader->SingleMethodExecute();
+    }
+
+    CPPUNIT_ASSERT_EQUAL_MESSAGE("Zone of every thread recorded", 600ul, mitk::Tracing::GetStatistics()["thread"].Count);
+    CPPUNIT_ASSERT_EQUAL_MESSAGE("No event dropped", 0ull, mitk::Tracing::GetDroppedEventCount());
+  }
+
+  void WriteChromeTrace_EscapesNames()
+  {
+    mitk::Tracing::SetEnabled(true);
+    {
+      MITK_TRACE_ZONE("say \"hello\"", "test");
+    }
+
+    std::ostringstream trace;
+    mitk::Tracing::WriteChromeTrace(trace);
+    CPPUNIT_ASSERT_MESSAGE("Trace events written", trace.str().find("{\"traceEvents\":[") == 0);
+    CPPUNIT_ASSERT_MESSAGE("Dropped events written", trace.str().find("\"otherData\":{\"droppedEvents\":\"0\"}") != std::string::npos);
+    CPPUNIT_ASSERT_MESSAGE("Name escaped", trace.str().find("\"name\":\"say \\\"hello\\\"\",\"cat\":\"test\",\"ph\":\"X\"") != std::string::npos);
+  }
+
+};
+
+MITK_TEST_SUITE_REGISTRATION(mitkTracing)
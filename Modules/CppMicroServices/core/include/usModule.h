@@ -152,6 +152,17 @@ public:
    */
   static const std::string& PROP_AUTOLOADED_MODULES();
 
+  /**
+   * Returns the property key with a value of \c module.activation_time for
+   * looking up the time it took to activate this module.
+   * The property value is of type \c double and contains the milliseconds
+   * spent in creating the module activator and in its ModuleActivator::Load()
+   * method, excluding the activation of auto-loaded modules.
+   *
+   * @return The activation time property key.
+   */
+  static const std::string& PROP_ACTIVATION_TIME();
+
   ~Module();
 
   /**
@@ -335,6 +346,7 @@ private:
 
   friend class CoreModuleActivator;
   friend class ModuleRegistry;
+  friend class ParallelModuleStart;
   friend class ServiceReferencePrivate;
 
   ModulePrivate* d;
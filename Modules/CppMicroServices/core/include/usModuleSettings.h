@@ -41,6 +41,7 @@ US_BEGIN_NAMESPACE
  * - \e US_DISABLE_AUTOLOADING If set, auto-loading of modules is disabled.
  * - \e US_AUTOLOAD_PATHS A ':' (Unix) or ';' (Windows) separated list of paths
  *   from which modules should be auto-loaded.
+ * - \e US_PARALLEL_ACTIVATION If set, auto-loaded modules are activated in parallel.
  *
  * \remarks This class is thread safe.
  */
@@ -97,6 +98,32 @@ public:
    */
   static void SetAutoLoadingEnabled(bool enable);
 
+  /**
+   * \return \c true if the modules auto-loaded by one module are activated
+   * in parallel, \c false otherwise.
+   *
+   * \remarks This method will always return \c false if threading support
+   * has not been configured into the CppMicroServices library.
+   */
+  static bool IsParallelActivationEnabled();
+
+  /**
+   * Enable or disable the parallel activation of auto-loaded modules.
+   *
+   * If enabled, all libraries of an auto-load directory are loaded first and
+   * the activators of their modules are called concurrently afterwards. Modules
+   * loaded as a dependency of an auto-loaded library are activated before, in
+   * the order of their loading. The auto-loaded modules of one directory must
+   * therefore not depend on each other, and their activators as well as all
+   * module listeners must be thread safe.
+   *
+   * The default is \c false, unless the US_PARALLEL_ACTIVATION environment
+   * variable is defined.
+   *
+   * \param enable If \c true, enable parallel activation, disable it otherwise.
+   */
+  static void SetParallelActivationEnabled(bool enable);
+
   /**
    * \return A list of paths in the file-system from which modules will be
    * auto-loaded.
@@ -31,8 +31,150 @@
 
 #include "usCoreConfig.h"
 
+#include <algorithm>
+#include <chrono>
+
+#ifdef US_ENABLE_THREADING_SUPPORT
+#include "usStaticInit_p.h"
+#include "usThreads_p.h"
+
+#include <atomic>
+#include <exception>
+#include <map>
+#include <thread>
+#endif
+
 US_BEGIN_NAMESPACE
 
+#ifdef US_ENABLE_THREADING_SUPPORT
+
+/**
+ * Modules registered by a thread while it auto-loads modules with
+ * parallel activation enabled. They are started after all libraries
+ * of the auto-load directories have been loaded.
+ */
+typedef std::map<std::thread::id, std::vector<Module*> > DeferredModulesMap;
+
+US_GLOBAL_STATIC(DeferredModulesMap, deferredModules)
+
+US_GLOBAL_STATIC(Mutex, deferredModulesLock)
+
+namespace {
+
+bool DeferStart(Module* module)
+{
+  MutexLock lock(*deferredModulesLock());
+  DeferredModulesMap::iterator iter = deferredModules()->find(std::this_thread::get_id());
+  if (iter == deferredModules()->end())
+  {
+    return false;
+  }
+  iter->second.push_back(module);
+  return true;
+}
+
+}
+
+/**
+ * Auto-loads the modules of a module and starts them from a pool of threads,
+ * the calling thread included. The first exception thrown by a module activator
+ * is re-thrown after all modules have been started.
+ */
+class ParallelModuleStart
+{
+public:
+
+  static std::vector<std::string> AutoLoadModules(const ModuleInfo& moduleInfo)
+  {
+    {
+      MutexLock lock(*deferredModulesLock());
+      deferredModules()->insert(std::make_pair(std::this_thread::get_id(), std::vector<Module*>()));
+    }
+
+    const std::vector<std::string> loadedPaths = US_PREPEND_NAMESPACE(AutoLoadModules)(moduleInfo);
+
+    std::vector<Module*> modules;
+    {
+      MutexLock lock(*deferredModulesLock());
+      DeferredModulesMap::iterator iter = deferredModules()->find(std::this_thread::get_id());
+      modules.swap(iter->second);
+      deferredModules()->erase(iter);
+    }
+
+    // Modules of libraries which were loaded as a dependency of an auto-loaded
+    // library are started first, in the order in which they were registered.
+    std::vector<Module*> autoLoadedModules;
+    for (std::size_t i = 0; i < modules.size(); ++i)
+    {
+      if (std::find(loadedPaths.begin(), loadedPaths.end(), modules[i]->GetLocation()) != loadedPaths.end())
+      {
+        autoLoadedModules.push_back(modules[i]);
+      }
+      else
+      {
+        modules[i]->Start();
+      }
+    }
+
+    ParallelModuleStart(autoLoadedModules).Run();
+    return loadedPaths;
+  }
+
+private:
+
+  ParallelModuleStart(const std::vector<Module*>& modules)
+    : m_Modules(modules)
+    , m_Errors(modules.size())
+    , m_Next(0)
+  {}
+
+  void Run()
+  {
+    std::size_t threadCount = std::max(1u, std::thread::hardware_concurrency());
+    threadCount = std::min(threadCount, m_Modules.size());
+
+    std::vector<std::thread> threads;
+    for (std::size_t i = 1; i < threadCount; ++i)
+    {
+      threads.push_back(std::thread(&ParallelModuleStart::StartModules, this));
+    }
+    this->StartModules();
+    for (std::size_t i = 0; i < threads.size(); ++i)
+    {
+      threads[i].join();
+    }
+
+    for (std::size_t i = 0; i < m_Errors.size(); ++i)
+    {
+      if (m_Errors[i])
+      {
+        std::rethrow_exception(m_Errors[i]);
+      }
+    }
+  }
+
+  void StartModules()
+  {
+    for (std::size_t i = m_Next++; i < m_Modules.size(); i = m_Next++)
+    {
+      try
+      {
+        m_Modules[i]->Start();
+      }
+      catch (...)
+      {
+        m_Errors[i] = std::current_exception();
+      }
+    }
+  }
+
+  const std::vector<Module*>& m_Modules;
+  std::vector<std::exception_ptr> m_Errors;
+  std::atomic<std::size_t> m_Next;
+};
+
+#endif
+
 const std::string& Module::PROP_ID()
 {
   static const std::string s("module.id");
@@ -78,6 +220,12 @@ const std::string&Module::PROP_AUTOLOADED_MODULES()
   return s;
 }
 
+const std::string&Module::PROP_ACTIVATION_TIME()
+{
+  static const std::string s("module.activation_time");
+  return s;
+}
+
 Module::Module()
 : d(0)
 {
@@ -125,6 +273,15 @@ void Module::Start()
     return;
   }
 
+#ifdef US_ENABLE_THREADING_SUPPORT
+  if (DeferStart(this))
+  {
+    return;
+  }
+#endif
+
+  const std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+
   d->moduleContext = new ModuleContext(this->d);
 
   typedef ModuleActivator*(*ModuleActivatorHook)(void);
@@ -156,10 +313,24 @@ void Module::Start()
     d->moduleActivator->Load(d->moduleContext);
   }
 
+  const double activationTime = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+  d->moduleManifest.SetValue(PROP_ACTIVATION_TIME(), Any(activationTime));
+  US_DEBUG << "Module " << d->info.name << " activated in " << activationTime << " ms";
+
 #ifdef US_ENABLE_AUTOLOADING_SUPPORT
   if (ModuleSettings::IsAutoLoadingEnabled())
   {
-    const std::vector<std::string> loadedPaths = AutoLoadModules(d->info);
+    std::vector<std::string> loadedPaths;
+#ifdef US_ENABLE_THREADING_SUPPORT
+    if (ModuleSettings::IsParallelActivationEnabled())
+    {
+      loadedPaths = ParallelModuleStart::AutoLoadModules(d->info);
+    }
+    else
+#endif
+    {
+      loadedPaths = AutoLoadModules(d->info);
+    }
     if (!loadedPaths.empty())
     {
       d->moduleManifest.SetValue(PROP_AUTOLOADED_MODULES(), Any(loadedPaths));
@@ -67,6 +67,7 @@ struct ModuleSettingsPrivate : public MultiThreaded<>
     , autoLoadingEnabled(false)
   #endif
     , autoLoadingDisabled(false)
+    , parallelActivationEnabled(false)
     , logLevel(DebugMsg)
   {
     autoLoadPaths.insert(ModuleSettings::CURRENT_MODULE_PATH());
@@ -95,12 +96,18 @@ struct ModuleSettingsPrivate : public MultiThreaded<>
     {
       autoLoadingDisabled = true;
     }
+
+    if (getenv("US_PARALLEL_ACTIVATION"))
+    {
+      parallelActivationEnabled = true;
+    }
   }
 
   std::set<std::string> autoLoadPaths;
   std::set<std::string> extraPaths;
   bool autoLoadingEnabled;
   bool autoLoadingDisabled;
+  bool parallelActivationEnabled;
   std::string storagePath;
   MsgType logLevel;
 };
@@ -133,6 +140,22 @@ void ModuleSettings::SetAutoLoadingEnabled(bool enable)
   moduleSettingsPrivate()->autoLoadingEnabled = enable;
 }
 
+bool ModuleSettings::IsParallelActivationEnabled()
+{
+  US_UNUSED(ModuleSettingsPrivate::Lock(moduleSettingsPrivate()));
+#ifdef US_ENABLE_THREADING_SUPPORT
+  return moduleSettingsPrivate()->parallelActivationEnabled;
+#else
+  return false;
+#endif
+}
+
+void ModuleSettings::SetParallelActivationEnabled(bool enable)
+{
+  US_UNUSED(ModuleSettingsPrivate::Lock(moduleSettingsPrivate()));
+  moduleSettingsPrivate()->parallelActivationEnabled = enable;
+}
+
 ModuleSettings::PathList ModuleSettings::GetAutoLoadPaths()
 {
   US_UNUSED(ModuleSettingsPrivate::Lock(moduleSettingsPrivate()));
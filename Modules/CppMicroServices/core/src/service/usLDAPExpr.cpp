@@ -133,26 +133,33 @@ class LDAPExprData : public SharedData
 public:
 
   LDAPExprData( int op, const std::vector<LDAPExpr>& args )
-    : m_operator(op), m_args(args), m_attrName(), m_attrValue()
+    : m_operator(op), m_args(args), m_attrName(), m_attrNameLower(),
+    m_attrValue(), m_hasWildcard(false)
   {
   }
 
   LDAPExprData( int op, std::string attrName, const std::string& attrValue )
-    : m_operator(op), m_args(), m_attrName(attrName), m_attrValue(attrValue)
+    : m_operator(op), m_args(), m_attrName(attrName),
+    m_attrNameLower(ServicePropertiesImpl::ToLower(attrName)), m_attrValue(attrValue),
+    m_hasWildcard(attrValue.find(LDAPExprConstants::WILDCARD()) != std::string::npos)
   {
   }
 
   LDAPExprData( const LDAPExprData& other )
     : SharedData(other), m_operator(other.m_operator),
     m_args(other.m_args), m_attrName(other.m_attrName),
-    m_attrValue(other.m_attrValue)
+    m_attrNameLower(other.m_attrNameLower), m_attrValue(other.m_attrValue),
+    m_hasWildcard(other.m_hasWildcard)
   {
   }
 
   int m_operator;
   std::vector<LDAPExpr> m_args;
   std::string m_attrName;
+  // parsed once, property keys are matched case insensitive
+  std::string m_attrNameLower;
   std::string m_attrValue;
+  bool m_hasWildcard;
 };
 
 LDAPExpr::LDAPExpr() : d()
@@ -232,37 +239,14 @@ bool LDAPExpr::GetMatchedObjectClasses(ObjectClassSet& objClasses) const
       LDAPExpr::ObjectClassSet r;
       if (d->m_args[i].GetMatchedObjectClasses(r))
       {
-        result = true;
-        if (objClasses.empty())
+        // if AND op and classes in several operands, a matching service
+        // has a class of each of them. As services may have several
+        // classes, the smallest set is used instead of the intersection.
+        if (!result || r.size() < objClasses.size())
         {
           objClasses = r;
         }
-        else
-        {
-          // if AND op and classes in several operands,
-          // then only the intersection is possible.
-          LDAPExpr::ObjectClassSet::iterator it1 = objClasses.begin();
-          LDAPExpr::ObjectClassSet::iterator it2 = r.begin();
-          while ( (it1 != objClasses.end()) && (it2 != r.end()) )
-          {
-            if (*it1 < *it2)
-            {
-              objClasses.erase(it1++);
-            }
-            else if (*it2 < *it1)
-            {
-              ++it2;
-            }
-            else
-            { // *it1 == *it2
-              ++it1;
-              ++it2;
-            }
-          }
-          // Anything left in set_1 from here on did not appear in set_2,
-          // so we remove it.
-          objClasses.erase(it1, objClasses.end());
-        }
+        result = true;
       }
     }
     return result;
@@ -287,6 +271,26 @@ bool LDAPExpr::GetMatchedObjectClasses(ObjectClassSet& objClasses) const
   return false;
 }
 
+bool LDAPExpr::GetRequiredEqualityTerms(EqualityTerms& terms) const
+{
+  if (d->m_operator == EQ)
+  {
+    if (d->m_hasWildcard) return false;
+    terms.push_back(std::make_pair(d->m_attrNameLower, d->m_attrValue));
+    return true;
+  }
+  else if (d->m_operator == AND)
+  {
+    bool result = false;
+    for (std::size_t i = 0; i < d->m_args.size(); i++)
+    {
+      result = d->m_args[i].GetRequiredEqualityTerms(terms) || result;
+    }
+    return result;
+  }
+  return false;
+}
+
 std::string LDAPExpr::ToLower(const std::string& str)
 {
   std::string lowerStr(str);
@@ -338,9 +342,9 @@ bool LDAPExpr::Evaluate( const ServicePropertiesImpl& p, bool matchCase ) const
 {
   if ((d->m_operator & SIMPLE) != 0)
   {
-    // try case sensitive match first
-    int index = p.FindCaseSensitive(d->m_attrName);
-    if (index < 0 && !matchCase) index = p.Find(d->m_attrName);
+    // keys are unique ignoring case, so no case sensitive match first
+    int index = matchCase ? p.FindCaseSensitive(d->m_attrName)
+                          : p.FindLowerCase(d->m_attrNameLower);
     return index < 0 ? false : Compare(p.Value(index), d->m_operator, d->m_attrValue);
   }
   else
@@ -381,14 +385,14 @@ bool LDAPExpr::Compare( const Any& obj, int op, const std::string& s ) const
     const std::type_info& objType = obj.Type();
     if (objType == typeid(std::string))
     {
-      return CompareString(ref_any_cast<std::string>(obj), op, s);
+      return CompareValue(ref_any_cast<std::string>(obj), op, s);
     }
     else if (objType == typeid(std::vector<std::string>))
     {
       const std::vector<std::string>& list = ref_any_cast<std::vector<std::string> >(obj);
       for (std::size_t it = 0; it != list.size(); it++)
       {
-         if (CompareString(list[it], op, s))
+         if (CompareValue(list[it], op, s))
            return true;
       }
     }
@@ -398,7 +402,7 @@ bool LDAPExpr::Compare( const Any& obj, int op, const std::string& s ) const
       for (std::list<std::string>::const_iterator it = list.begin();
            it != list.end(); ++it)
       {
-         if (CompareString(*it, op, s))
+         if (CompareValue(*it, op, s))
            return true;
       }
     }
@@ -542,6 +546,16 @@ bool LDAPExpr::CompareIntegralType(const Any& obj, const int op, const std::stri
   }
 }
 
+bool LDAPExpr::CompareValue( const std::string& s1, int op, const std::string& s2 ) const
+{
+  // no pattern matching needed for the common (key=value) case
+  if (op == EQ && !d->m_hasWildcard)
+  {
+    return s1 == s2;
+  }
+  return CompareString(s1, op, s2);
+}
+
 bool LDAPExpr::CompareString( const std::string& s1, int op, const std::string& s2 )
 {
   switch(op)
@@ -57,6 +57,7 @@ public:
   typedef std::vector<std::string> StringList;
   typedef std::vector<StringList> LocalCache;
   typedef US_UNORDERED_SET_TYPE<std::string> ObjectClassSet;
+  typedef std::vector<std::pair<std::string, std::string> > EqualityTerms;
 
 
   /**
@@ -83,6 +84,16 @@ public:
    */
   bool GetMatchedObjectClasses(ObjectClassSet& objClasses) const;
 
+  /**
+   * Get the equality terms without wildcards which every matching service
+   * must satisfy, i.e. this expression or the operands of its top-level
+   * AND expressions.
+   *
+   * \param terms Pairs of lower case attribute names and values are added to terms.
+   * \return <code>true</code> if at least one term was found.
+   */
+  bool GetRequiredEqualityTerms(EqualityTerms& terms) const;
+
   /**
    * Checks if this LDAP expression is "simple". The definition of
    * a simple filter is:
@@ -152,6 +163,9 @@ private:
   //!
   bool Compare(const Any& obj, int op, const std::string& s) const;
 
+  //! Compares with this expression's pre-parsed value
+  bool CompareValue(const std::string& s1, int op, const std::string& s2) const;
+
   //!
   template<typename T>
   bool CompareIntegralType(const Any& obj, const int op, const std::string& s) const;
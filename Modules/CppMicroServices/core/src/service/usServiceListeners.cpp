@@ -231,6 +231,19 @@ void ServiceListeners::GetMatchingServiceListeners(const ServiceEvent& evt, Serv
        objClass != c.end(); ++objClass)
   {
     AddToSet(set, receivers, OBJECTCLASS_IX, *objClass);
+
+    // Complicated filters restricted to this class
+    CacheType::const_iterator classListeners = objectClassListeners.find(*objClass);
+    if (classListeners == objectClassListeners.end()) continue;
+    for (std::list<ServiceListenerEntry>::const_iterator sse = classListeners->second.begin();
+         sse != classListeners->second.end(); ++sse)
+    {
+      if (set.count(*sse) || receivers.count(*sse) == 0) continue;
+      if (sse->GetLDAPExpr().Evaluate(evt.GetServiceReference().d->GetProperties(), false))
+      {
+        set.insert(*sse);
+      }
+    }
   }
 
   long service_id = any_cast<long>(evt.GetServiceReference().d->GetProperty(ServiceConstants::SERVICE_ID(), lockProps));
@@ -274,7 +287,24 @@ void ServiceListeners::RemoveFromCache(const ServiceListenerEntry& sle)
   }
   else
   {
-    complicatedListeners.remove(sle);
+    LDAPExpr::ObjectClassSet objClasses;
+    if (!sle.GetLDAPExpr().IsNull() && sle.GetLDAPExpr().GetMatchedObjectClasses(objClasses))
+    {
+      for (LDAPExpr::ObjectClassSet::const_iterator objClass = objClasses.begin();
+           objClass != objClasses.end(); ++objClass)
+      {
+        std::list<ServiceListenerEntry>& sles = objectClassListeners[*objClass];
+        sles.remove(sle);
+        if (sles.empty())
+        {
+          objectClassListeners.erase(*objClass);
+        }
+      }
+    }
+    else
+    {
+      complicatedListeners.remove(sle);
+    }
   }
 }
 
@@ -301,8 +331,21 @@ void ServiceListeners::RemoveFromCache(const ServiceListenerEntry& sle)
      }
      else
      {
-       //US_DEBUG << "Too complicated filter: " << sle.GetFilter();
-       complicatedListeners.push_back(sle);
+       LDAPExpr::ObjectClassSet objClasses;
+       if (sle.GetLDAPExpr().GetMatchedObjectClasses(objClasses))
+       {
+         // only evaluated for events of services with one of these classes
+         for (LDAPExpr::ObjectClassSet::const_iterator objClass = objClasses.begin();
+              objClass != objClasses.end(); ++objClass)
+         {
+           objectClassListeners[*objClass].push_back(sle);
+         }
+       }
+       else
+       {
+         //US_DEBUG << "Too complicated filter: " << sle.GetFilter();
+         complicatedListeners.push_back(sle);
+       }
      }
    }
  }
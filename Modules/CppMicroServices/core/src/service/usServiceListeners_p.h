@@ -65,6 +65,10 @@ private:
   /* Service listeners with "simple" filters are cached. */
   CacheType cache[2];
 
+  /* Service listeners with complicated filters which only match
+     services of certain object classes, e.g. (&(objectclass=...)(...)) */
+  CacheType objectClassListeners;
+
   ServiceListenerEntries serviceSet;
 
   CoreModuleContext* coreCtx;
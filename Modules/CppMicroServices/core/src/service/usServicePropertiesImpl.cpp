@@ -21,15 +21,10 @@
 
 #include "usServicePropertiesImpl_p.h"
 
+#include <algorithm>
+#include <cctype>
 #include <limits>
 #include <stdexcept>
-#ifdef US_PLATFORM_WINDOWS
-#include <string.h>
-#define ci_compare strnicmp
-#else
-#include <strings.h>
-#define ci_compare strncasecmp
-#endif
 
 US_BEGIN_NAMESPACE
 
@@ -43,6 +38,7 @@ ServicePropertiesImpl::ServicePropertiesImpl(const ServiceProperties& p)
   }
 
   keys.reserve(p.size());
+  lowerKeys.reserve(p.size());
   values.reserve(p.size());
 
   for (ServiceProperties::const_iterator iter = p.begin();
@@ -55,6 +51,7 @@ ServicePropertiesImpl::ServicePropertiesImpl(const ServiceProperties& p)
       throw std::runtime_error(msg.c_str());
     }
     keys.push_back(iter->first);
+    lowerKeys.push_back(ToLower(iter->first));
     values.push_back(iter->second);
   }
 }
@@ -75,9 +72,14 @@ const Any& ServicePropertiesImpl::Value(int index) const
 
 int ServicePropertiesImpl::Find(const std::string& key) const
 {
-  for (std::size_t i = 0; i < keys.size(); ++i)
+  return FindLowerCase(ToLower(key));
+}
+
+int ServicePropertiesImpl::FindLowerCase(const std::string& lowerKey) const
+{
+  for (std::size_t i = 0; i < lowerKeys.size(); ++i)
   {
-    if (ci_compare(key.c_str(), keys[i].c_str(), key.size()) == 0)
+    if (lowerKey == lowerKeys[i])
     {
       return static_cast<int>(i);
     }
@@ -102,4 +104,11 @@ const std::vector<std::string>& ServicePropertiesImpl::Keys() const
   return keys;
 }
 
+std::string ServicePropertiesImpl::ToLower(const std::string& str)
+{
+  std::string lowerStr(str);
+  std::transform(str.begin(), str.end(), lowerStr.begin(), ::tolower);
+  return lowerStr;
+}
+
 US_END_NAMESPACE
@@ -39,11 +39,20 @@ public:
   int Find(const std::string& key) const;
   int FindCaseSensitive(const std::string& key) const;
 
+  /**
+   * Find the index of a key which is already in lower case. This avoids
+   * converting the key again, e.g. for pre-parsed LDAP filters.
+   */
+  int FindLowerCase(const std::string& lowerKey) const;
+
+  static std::string ToLower(const std::string& str);
+
   const std::vector<std::string>& Keys() const;
 
 private:
 
   std::vector<std::string> keys;
+  std::vector<std::string> lowerKeys;
   std::vector<Any> values;
 
   static Any emptyAny;
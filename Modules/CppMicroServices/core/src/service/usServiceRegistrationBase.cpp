@@ -110,8 +110,10 @@ void ServiceRegistrationBase::SetProperties(const ServiceProperties& props)
       int new_rank = 0;
 
       std::vector<std::string> classes;
+      ServicePropertiesImpl oldProperties = ServicePropertiesImpl(ServiceProperties());
       {
         MutexLock lock3(d->propsLock);
+        oldProperties = d->properties;
 
         {
           const Any& any = d->properties.Value(ServiceConstants::SERVICE_RANKING());
@@ -133,6 +135,7 @@ void ServiceRegistrationBase::SetProperties(const ServiceProperties& props)
       {
         d->module->coreCtx->services.UpdateServiceRegistrationOrder(*this, classes);
       }
+      d->module->coreCtx->services.UpdatePropertyIndex(*this, oldProperties);
     }
     else
     {
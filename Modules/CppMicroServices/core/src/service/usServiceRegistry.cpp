@@ -19,7 +19,9 @@
 
 =============================================================================*/
 
+#include <algorithm>
 #include <iterator>
+#include <list>
 #include <stdexcept>
 #include <cassert>
 
@@ -32,6 +34,54 @@
 #include "usCoreModuleContext_p.h"
 
 
+namespace {
+
+// parsed filters are kept until this many different filters were used
+const std::size_t MAX_FILTER_EXPRESSIONS = 1024;
+
+void InsertOrdered(std::vector<US_PREPEND_NAMESPACE(ServiceRegistrationBase)>& s,
+                   const US_PREPEND_NAMESPACE(ServiceRegistrationBase)& sr)
+{
+  s.insert(std::lower_bound(s.begin(), s.end(), sr), sr);
+}
+
+void Remove(std::vector<US_PREPEND_NAMESPACE(ServiceRegistrationBase)>& s,
+            const US_PREPEND_NAMESPACE(ServiceRegistrationBase)& sr)
+{
+  s.erase(std::remove(s.begin(), s.end(), sr), s.end());
+}
+
+// Gets the string values of a property, returns false for other types
+bool GetIndexValues(const US_PREPEND_NAMESPACE(Any)& any, std::vector<std::string>& values)
+{
+  const std::type_info& type = any.Type();
+  if (type == typeid(std::string))
+  {
+    values.push_back(US_PREPEND_NAMESPACE(ref_any_cast)<std::string>(any));
+  }
+  else if (type == typeid(std::vector<std::string>))
+  {
+    const std::vector<std::string>& list = US_PREPEND_NAMESPACE(ref_any_cast)<std::vector<std::string> >(any);
+    values.insert(values.end(), list.begin(), list.end());
+  }
+  else if (type == typeid(std::list<std::string>))
+  {
+    const std::list<std::string>& list = US_PREPEND_NAMESPACE(ref_any_cast)<std::list<std::string> >(any);
+    values.insert(values.end(), list.begin(), list.end());
+  }
+  else
+  {
+    return false;
+  }
+  // a list may contain a value twice
+  std::sort(values.begin(), values.end());
+  values.erase(std::unique(values.begin(), values.end()), values.end());
+  return true;
+}
+
+}
+
+
 US_BEGIN_NAMESPACE
 
 ServicePropertiesImpl ServiceRegistry::CreateServiceProperties(const ServiceProperties& in,
@@ -81,6 +131,8 @@ void ServiceRegistry::Clear()
   services.clear();
   serviceRegistrations.clear();
   classServices.clear();
+  propertyIndex.clear();
+  filterExpressions.clear();
   core = 0;
 }
 
@@ -123,6 +175,7 @@ ServiceRegistrationBase ServiceRegistry::RegisterService(ModulePrivate* module,
           std::lower_bound(s.begin(), s.end(), res);
       s.insert(ip, res);
     }
+    AddToPropertyIndex(res, res.d->properties);
   }
 
   ServiceReferenceBase r = res.GetReference(std::string());
@@ -147,6 +200,138 @@ void ServiceRegistry::UpdateServiceRegistrationOrder(const ServiceRegistrationBa
   }
 }
 
+void ServiceRegistry::UpdatePropertyIndex(const ServiceRegistrationBase& sr,
+                                          const ServicePropertiesImpl& oldProperties)
+{
+  MutexLock lock(mutex);
+  // the ranking may have changed too, so re-insert in any case
+  RemoveFromPropertyIndex(sr, oldProperties);
+  AddToPropertyIndex(sr, sr.d->properties);
+}
+
+void ServiceRegistry::AddToPropertyIndex(const ServiceRegistrationBase& sr,
+                                         const ServicePropertiesImpl& properties)
+{
+  const std::vector<std::string>& keys = properties.Keys();
+  for (std::size_t i = 0; i < keys.size(); ++i)
+  {
+    PropertyIndex& index = propertyIndex[ServicePropertiesImpl::ToLower(keys[i])];
+    std::vector<std::string> values;
+    if (GetIndexValues(properties.Value(static_cast<int>(i)), values))
+    {
+      for (std::vector<std::string>::const_iterator value = values.begin();
+           value != values.end(); ++value)
+      {
+        InsertOrdered(index.values[*value], sr);
+      }
+    }
+    else
+    {
+      InsertOrdered(index.others, sr);
+    }
+  }
+}
+
+void ServiceRegistry::RemoveFromPropertyIndex(const ServiceRegistrationBase& sr,
+                                              const ServicePropertiesImpl& properties)
+{
+  const std::vector<std::string>& keys = properties.Keys();
+  for (std::size_t i = 0; i < keys.size(); ++i)
+  {
+    MapPropertyIndex::iterator index = propertyIndex.find(ServicePropertiesImpl::ToLower(keys[i]));
+    if (index == propertyIndex.end()) continue;
+
+    std::vector<std::string> values;
+    if (GetIndexValues(properties.Value(static_cast<int>(i)), values))
+    {
+      for (std::vector<std::string>::const_iterator value = values.begin();
+           value != values.end(); ++value)
+      {
+        MapValueServices::iterator s = index->second.values.find(*value);
+        if (s == index->second.values.end()) continue;
+        Remove(s->second, sr);
+        if (s->second.empty())
+        {
+          index->second.values.erase(s);
+        }
+      }
+    }
+    else
+    {
+      Remove(index->second.others, sr);
+    }
+
+    if (index->second.values.empty() && index->second.others.empty())
+    {
+      propertyIndex.erase(index);
+    }
+  }
+}
+
+LDAPExpr ServiceRegistry::GetLDAPExpr_unlocked(const std::string& filter) const
+{
+  MapFilterExpressions::const_iterator iter = filterExpressions.find(filter);
+  if (iter != filterExpressions.end())
+  {
+    return iter->second;
+  }
+
+  // throws std::invalid_argument for invalid filters, which are not kept
+  LDAPExpr ldap(filter);
+  if (filterExpressions.size() >= MAX_FILTER_EXPRESSIONS)
+  {
+    filterExpressions.clear();
+  }
+  filterExpressions.insert(std::make_pair(filter, ldap));
+  return ldap;
+}
+
+bool ServiceRegistry::GetIndexedCandidates_unlocked(const LDAPExpr& ldap, std::size_t maxCandidates,
+                                                    std::vector<ServiceRegistrationBase>& candidates) const
+{
+  LDAPExpr::EqualityTerms terms;
+  if (!ldap.GetRequiredEqualityTerms(terms))
+  {
+    return false;
+  }
+
+  static const std::vector<ServiceRegistrationBase> emptyList;
+  const std::vector<ServiceRegistrationBase>* bestValues = NULL;
+  const std::vector<ServiceRegistrationBase>* bestOthers = NULL;
+  for (LDAPExpr::EqualityTerms::const_iterator term = terms.begin();
+       term != terms.end(); ++term)
+  {
+    MapPropertyIndex::const_iterator index = propertyIndex.find(term->first);
+    if (index == propertyIndex.end())
+    {
+      // no service has this property
+      candidates.clear();
+      return true;
+    }
+
+    MapValueServices::const_iterator values = index->second.values.find(term->second);
+    const std::vector<ServiceRegistrationBase>& valueList =
+        values == index->second.values.end() ? emptyList : values->second;
+    if (valueList.size() + index->second.others.size() < maxCandidates)
+    {
+      maxCandidates = valueList.size() + index->second.others.size();
+      bestValues = &valueList;
+      bestOthers = &index->second.others;
+    }
+  }
+
+  if (bestValues == NULL)
+  {
+    return false;
+  }
+
+  candidates.clear();
+  candidates.reserve(maxCandidates);
+  std::merge(bestValues->begin(), bestValues->end(), bestOthers->begin(), bestOthers->end(),
+             std::back_inserter(candidates));
+  return true;
+}
+
 void ServiceRegistry::Get(const std::string& clazz,
                           std::vector<ServiceRegistrationBase>& serviceRegs) const
 {
@@ -203,7 +388,7 @@ void ServiceRegistry::Get_unlocked(const std::string& clazz, const std::string&
   {
     if (!filter.empty())
     {
-      ldap = LDAPExpr(filter);
+      ldap = GetLDAPExpr_unlocked(filter);
       LDAPExpr::ObjectClassSet matched;
       if (ldap.GetMatchedObjectClasses(matched))
       {
@@ -253,17 +438,37 @@ void ServiceRegistry::Get_unlocked(const std::string& clazz, const std::string&
     }
     if (!filter.empty())
     {
-      ldap = LDAPExpr(filter);
+      ldap = GetLDAPExpr_unlocked(filter);
     }
   }
 
+  // Narrow down the services with the property index, e.g. to
+  // the readers of one mime-type instead of all readers
+  std::vector<ServiceRegistrationBase> candidates;
+  bool checkClass = false;
+  if (!filter.empty() &&
+      GetIndexedCandidates_unlocked(ldap, static_cast<std::size_t>(send - s), candidates))
+  {
+    s = candidates.begin();
+    send = candidates.end();
+    checkClass = !clazz.empty();
+  }
+
   for (; s != send; ++s)
   {
-    ServiceReferenceBase sri = s->GetReference(clazz);
+    if (checkClass)
+    {
+      MapServiceClasses::const_iterator classes = services.find(*s);
+      if (classes == services.end() ||
+          std::find(classes->second.begin(), classes->second.end(), clazz) == classes->second.end())
+      {
+        continue;
+      }
+    }
 
     if (filter.empty() || ldap.Evaluate(s->d->properties, false))
     {
-      res.push_back(sri);
+      res.push_back(s->GetReference(clazz));
     }
   }
 
@@ -287,6 +492,7 @@ void ServiceRegistry::RemoveServiceRegistration(const ServiceRegistrationBase& s
   assert(sr.d->properties.Value(ServiceConstants::OBJECTCLASS()).Type() == typeid(std::vector<std::string>));
   const std::vector<std::string>& classes = ref_any_cast<std::vector<std::string> >(
         sr.d->properties.Value(ServiceConstants::OBJECTCLASS()));
+  RemoveFromPropertyIndex(sr, sr.d->properties);
   services.erase(sr);
   serviceRegistrations.erase(std::remove(serviceRegistrations.begin(), serviceRegistrations.end(), sr),
                              serviceRegistrations.end());
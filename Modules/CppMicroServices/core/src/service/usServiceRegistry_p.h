@@ -27,6 +27,7 @@
 #include "usServiceRegistration.h"
 
 #include "usThreads_p.h"
+#include "usLDAPExpr_p.h"
 
 US_BEGIN_NAMESPACE
 
@@ -79,6 +80,27 @@ public:
    */
   MapClassServices classServices;
 
+  typedef US_UNORDERED_MAP_TYPE<std::string, std::vector<ServiceRegistrationBase> > MapValueServices;
+
+  /**
+   * Registered services by the values of one property, used to answer
+   * equality filters without evaluating the filter for every service.
+   */
+  struct PropertyIndex
+  {
+    /** String values, ordered like classServices */
+    MapValueServices values;
+    /** Services whose value is not a string (list), these are always candidates */
+    std::vector<ServiceRegistrationBase> others;
+  };
+
+  typedef US_UNORDERED_MAP_TYPE<std::string, PropertyIndex> MapPropertyIndex;
+
+  /**
+   * Mapping of lower case property keys to their index.
+   */
+  MapPropertyIndex propertyIndex;
+
   CoreModuleContext* core;
 
   ServiceRegistry(CoreModuleContext* coreCtx);
@@ -116,6 +138,15 @@ public:
   void UpdateServiceRegistrationOrder(const ServiceRegistrationBase& sr,
                                       const std::vector<std::string>& classes);
 
+  /**
+   * Service properties changed, update the property index.
+   *
+   * @param sr The ServiceRegistrationPrivate object with the new properties.
+   * @param oldProperties The properties before the change.
+   */
+  void UpdatePropertyIndex(const ServiceRegistrationBase& sr,
+                           const ServicePropertiesImpl& oldProperties);
+
   /**
    * Get all services implementing a certain class.
    * Only used internally by the framework.
@@ -178,6 +209,26 @@ private:
   void Get_unlocked(const std::string& clazz, const std::string& filter,
                     ModulePrivate* module, std::vector<ServiceReferenceBase>& serviceRefs) const;
 
+  /**
+   * Returns the parsed filter, parsing it only on first use.
+   */
+  LDAPExpr GetLDAPExpr_unlocked(const std::string& filter) const;
+
+  /**
+   * Collects the services which may match the required equality terms of
+   * the filter, if they are less than <code>maxCandidates</code>.
+   *
+   * @return <code>false</code> if the index cannot narrow down the candidates.
+   */
+  bool GetIndexedCandidates_unlocked(const LDAPExpr& ldap, std::size_t maxCandidates,
+                                     std::vector<ServiceRegistrationBase>& candidates) const;
+
+  void AddToPropertyIndex(const ServiceRegistrationBase& sr, const ServicePropertiesImpl& properties);
+  void RemoveFromPropertyIndex(const ServiceRegistrationBase& sr, const ServicePropertiesImpl& properties);
+
+  typedef US_UNORDERED_MAP_TYPE<std::string, LDAPExpr> MapFilterExpressions;
+  mutable MapFilterExpressions filterExpressions;
+
   // purposely not implemented
   ServiceRegistry(const ServiceRegistry&);
   ServiceRegistry& operator=(const ServiceRegistry&);
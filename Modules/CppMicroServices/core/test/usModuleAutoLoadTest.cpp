@@ -32,6 +32,7 @@
 #include "usTestUtilModuleListener.h"
 #include "usTestingMacros.h"
 
+#include <algorithm>
 #include <cassert>
 
 US_USE_NAMESPACE
@@ -156,6 +157,46 @@ void testCustomAutoLoadPath()
   mc->RemoveModuleListener(&listener, &TestModuleListener::ModuleChanged);
 }
 
+void testParallelActivation()
+{
+  ModuleSettings::SetParallelActivationEnabled(true);
+
+  SharedLibrary libAL3(LIB_PATH, "TestModuleAL3");
+
+  try
+  {
+    libAL3.Load();
+  }
+  catch (const std::exception& e)
+  {
+    US_TEST_FAILED_MSG(<< "Load module exception: " << e.what())
+  }
+
+  ModuleSettings::SetParallelActivationEnabled(false);
+
+  Module* moduleAL3 = ModuleRegistry::GetModule("TestModuleAL3");
+  US_TEST_CONDITION_REQUIRED(moduleAL3 != NULL, "Test for existing module TestModuleAL3")
+  US_TEST_CONDITION_REQUIRED(moduleAL3->IsLoaded(), "Test for loaded module TestModuleAL3")
+
+  Any activationTime = moduleAL3->GetProperty(Module::PROP_ACTIVATION_TIME());
+  US_TEST_CONDITION_REQUIRED(activationTime.Type() == typeid(double), "Test for PROP_ACTIVATION_TIME property type")
+  US_TEST_CONDITION(any_cast<double>(activationTime) >= 0, "Test for PROP_ACTIVATION_TIME property value")
+
+  std::vector<std::string> loadedModules = any_cast<std::vector<std::string> >(moduleAL3->GetProperty(Module::PROP_AUTOLOADED_MODULES()));
+  US_TEST_CONDITION_REQUIRED(loadedModules.size() == 2, "Test for PROP_AUTOLOADED_MODULES vector size")
+
+  const char* autoLoadedNames[] = { "TestModuleAL3_1", "TestModuleAL3_2" };
+  for (std::size_t i = 0; i < 2; ++i)
+  {
+    Module* module = ModuleRegistry::GetModule(autoLoadedNames[i]);
+    US_TEST_CONDITION_REQUIRED(module != NULL, "Test for existing auto-loaded module " << autoLoadedNames[i])
+    US_TEST_CONDITION(module->IsLoaded(), "Test for loaded auto-loaded module " << autoLoadedNames[i])
+    US_TEST_CONDITION(std::find(loadedModules.begin(), loadedModules.end(), module->GetLocation()) != loadedModules.end(),
+                      "Test for PROP_AUTOLOADED_MODULES vector content")
+    US_TEST_CONDITION(!module->GetProperty(Module::PROP_ACTIVATION_TIME()).Empty(), "Test for PROP_ACTIVATION_TIME property")
+  }
+}
+
 } // end unnamed namespace
 
 
@@ -171,5 +212,7 @@ int usModuleAutoLoadTest(int /*argc*/, char* /*argv*/[])
 
   testCustomAutoLoadPath();
 
+  testParallelActivation();
+
   US_TEST_END()
 }
@@ -23,6 +23,7 @@
 
 #include <usGetModuleContext.h>
 #include <usModuleContext.h>
+#include <usLDAPProp.h>
 
 US_USE_NAMESPACE
 
@@ -185,6 +186,8 @@ private:
 
   int nListeners;
   int nServices;
+  int nGroups;
+  int nLookups;
 
   std::size_t nRegistered;
   std::size_t nUnregistering;
@@ -203,6 +206,7 @@ public:
 
   void TestAddListeners();
   void TestRegisterServices();
+  void TestLookupServices();
 
   void TestModifyServices();
   void TestUnregisterServices();
@@ -216,6 +220,7 @@ private:
 
   void AddListeners(int n);
   void RegisterServices(int n);
+  void LookupServices(int n);
   void ModifyServices();
   void UnregisterServices();
 
@@ -259,6 +264,8 @@ ServiceRegistryPerformanceTest::ServiceRegistryPerformanceTest(ModuleContext* co
   : mc(context)
   , nListeners(100)
   , nServices(1000)
+  , nGroups(100)
+  , nLookups(10000)
   , nRegistered(0)
   , nUnregistering(0)
   , nModified(0)
@@ -349,6 +356,9 @@ void ServiceRegistryPerformanceTest::RegisterServices(int n)
     ss << pid << i;
     props["service.pid"] = ss.str();
     props["perf.service.value"] = i+1;
+    std::stringstream group;
+    group << "perf.group." << (i % nGroups);
+    props["perf.service.group"] = group.str();
 
     PerfTestService* service = new PerfTestService();
     services.push_back(service);
@@ -358,6 +368,40 @@ void ServiceRegistryPerformanceTest::RegisterServices(int n)
   }
 }
 
+void ServiceRegistryPerformanceTest::TestLookupServices()
+{
+  Log() << "Look up services by an equality filter, like the readers of a mime-type, and check that we get #of services ("
+        << nServices << ") / #of groups (" << nGroups << ") references\n";
+
+  HighPrecisionTimer t;
+  t.Start();
+  LookupServices(nLookups);
+  long long us = t.ElapsedMicro();
+  Log() << "lookup took " << us / 1000 << "ms\n";
+  Log() << "lookups per second: " << (us > 0 ? static_cast<long long>(nLookups) * 1000 * 1000 / us : 0) << "\n";
+}
+
+void ServiceRegistryPerformanceTest::LookupServices(int n)
+{
+  Log() << "looking up " << n << " times in " << regs.size() << " services\n";
+
+  std::vector<std::string> filters;
+  for(int i = 0; i < nGroups; i++)
+  {
+    std::stringstream group;
+    group << "perf.group." << i;
+    filters.push_back(LDAPProp("perf.service.group") == group.str());
+  }
+
+  std::size_t nFound = 0;
+  for(int i = 0; i < n; i++)
+  {
+    nFound += mc->GetServiceReferences<IPerfTestService>(filters[i % nGroups]).size();
+  }
+  US_TEST_CONDITION_REQUIRED(nFound == static_cast<std::size_t>(n) * (nServices / nGroups),
+                             "# found services must be # of lookups * # of services per group");
+}
+
 void ServiceRegistryPerformanceTest::TestModifyServices()
 {
   Log() << "Modify all services, and check that we get #of services ("
@@ -420,6 +464,7 @@ int usServiceRegistryPerformanceTest(int /*argc*/, char* /*argv*/[])
   perfTest.InitTestCase();
   perfTest.TestAddListeners();
   perfTest.TestRegisterServices();
+  perfTest.TestLookupServices();
   perfTest.TestModifyServices();
   perfTest.TestUnregisterServices();
   perfTest.CleanupTestCase();
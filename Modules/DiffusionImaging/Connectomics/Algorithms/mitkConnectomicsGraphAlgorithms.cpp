@@ -0,0 +1,193 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include "mitkConnectomicsGraphAlgorithms.h"
+
+#include <algorithm>
+
+#include <boost/graph/dijkstra_shortest_paths.hpp>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+int mitk::ConnectomicsGraphAlgorithms::GetNumberOfThreads( int numberOfThreads )
+{
+#ifdef _OPENMP
+  if( numberOfThreads > 0 )
+  {
+    return numberOfThreads;
+  }
+  return omp_get_max_threads();
+#else
+  (void) numberOfThreads;
+  return 1;
+#endif
+}
+
+void mitk::ConnectomicsGraphAlgorithms::CalculateBetweennessCentrality( const NetworkType& graph,
+  std::vector< double >& vertexCentrality, std::vector< double >* edgeCentrality, int numberOfThreads )
+{
+  int numberOfVertices = boost::num_vertices( graph );
+  int numberOfEdges = boost::num_edges( graph );
+
+  // adjacency lists of (neighbor index, edge index), loops are never part of a shortest path
+  typedef std::pair< int, int > NeighborType;
+  std::vector< std::vector< NeighborType > > neighbors( numberOfVertices );
+  boost::property_map< NetworkType, boost::vertex_index_t >::const_type vertexIndex = boost::get( boost::vertex_index, graph );
+  boost::graph_traits< NetworkType >::edge_iterator edgeIterator, edgeEnd;
+  int edgeIndex( 0 );
+  for( boost::tie( edgeIterator, edgeEnd ) = boost::edges( graph ); edgeIterator != edgeEnd; ++edgeIterator, edgeIndex++ )
+  {
+    int source = vertexIndex[ boost::source( *edgeIterator, graph ) ];
+    int target = vertexIndex[ boost::target( *edgeIterator, graph ) ];
+    if( source != target )
+    {
+      neighbors[ source ].push_back( NeighborType( target, edgeIndex ) );
+      neighbors[ target ].push_back( NeighborType( source, edgeIndex ) );
+    }
+  }
+
+  int threads = GetNumberOfThreads( numberOfThreads );
+  bool computeEdgeCentrality = edgeCentrality != nullptr;
+  std::vector< std::vector< double > > threadVertexCentrality( threads );
+  std::vector< std::vector< double > > threadEdgeCentrality( threads );
+
+#pragma omp parallel num_threads( threads )
+  {
+    int thread( 0 );
+#ifdef _OPENMP
+    thread = omp_get_thread_num();
+#endif
+    std::vector< double >& localVertexCentrality = threadVertexCentrality[ thread ];
+    std::vector< double >& localEdgeCentrality = threadEdgeCentrality[ thread ];
+    localVertexCentrality.assign( numberOfVertices, 0.0 );
+    localEdgeCentrality.assign( computeEdgeCentrality ? numberOfEdges : 0, 0.0 );
+
+    std::vector< int > distance( numberOfVertices );
+    std::vector< double > pathCount( numberOfVertices );
+    std::vector< double > dependency( numberOfVertices );
+    std::vector< int > discovered;
+    discovered.reserve( numberOfVertices );
+
+#pragma omp for schedule(static)
+    for( int source = 0; source < numberOfVertices; source++ )
+    {
+      std::fill( distance.begin(), distance.end(), -1 );
+      std::fill( pathCount.begin(), pathCount.end(), 0.0 );
+      std::fill( dependency.begin(), dependency.end(), 0.0 );
+      distance[ source ] = 0;
+      pathCount[ source ] = 1.0;
+      discovered.clear();
+      discovered.push_back( source );
+
+      // breadth first search counting the shortest paths, the discovered vertices serve as queue
+      for( unsigned int head( 0 ); head < discovered.size(); head++ )
+      {
+        int v = discovered[ head ];
+        for( unsigned int n( 0 ); n < neighbors[ v ].size(); n++ )
+        {
+          int w = neighbors[ v ][ n ].first;
+          if( distance[ w ] < 0 )
+          {
+            distance[ w ] = distance[ v ] + 1;
+            discovered.push_back( w );
+          }
+          if( distance[ w ] == distance[ v ] + 1 )
+          {
+            pathCount[ w ] += pathCount[ v ];
+          }
+        }
+      }
+
+      // accumulate the dependencies in order of non-increasing distance
+      for( int index = discovered.size() - 1; index >= 0; index-- )
+      {
+        int w = discovered[ index ];
+        for( unsigned int n( 0 ); n < neighbors[ w ].size(); n++ )
+        {
+          int v = neighbors[ w ][ n ].first;
+          if( distance[ v ] == distance[ w ] - 1 )
+          {
+            double factor = pathCount[ v ] / pathCount[ w ];
+            factor *= ( 1.0 + dependency[ w ] );
+            dependency[ v ] += factor;
+            if( computeEdgeCentrality )
+            {
+              localEdgeCentrality[ neighbors[ w ][ n ].second ] += factor;
+            }
+          }
+        }
+        if( w != source )
+        {
+          localVertexCentrality[ w ] += dependency[ w ];
+        }
+      }
+    }
+  }
+
+  // every path of the undirected graph has been counted from both ends
+  vertexCentrality.assign( numberOfVertices, 0.0 );
+  for( int thread( 0 ); thread < threads; thread++ )
+  {
+    for( int index( 0 ); index < numberOfVertices; index++ )
+    {
+      vertexCentrality[ index ] += threadVertexCentrality[ thread ][ index ];
+    }
+  }
+  for( int index( 0 ); index < numberOfVertices; index++ )
+  {
+    vertexCentrality[ index ] /= 2.0;
+  }
+
+  if( computeEdgeCentrality )
+  {
+    edgeCentrality->assign( numberOfEdges, 0.0 );
+    for( int thread( 0 ); thread < threads; thread++ )
+    {
+      for( int index( 0 ); index < numberOfEdges; index++ )
+      {
+        ( *edgeCentrality )[ index ] += threadEdgeCentrality[ thread ][ index ];
+      }
+    }
+    for( int index( 0 ); index < numberOfEdges; index++ )
+    {
+      ( *edgeCentrality )[ index ] /= 2.0;
+    }
+  }
+}
+
+void mitk::ConnectomicsGraphAlgorithms::CalculateShortestPathDistances( const NetworkType& graph,
+  std::vector< std::vector< int > >& distances, int numberOfThreads )
+{
+  int numberOfVertices = boost::num_vertices( graph );
+  distances.resize( numberOfVertices );
+  for( int index( 0 ); index < numberOfVertices; index++ )
+  {
+    distances[ index ].resize( numberOfVertices );
+  }
+
+  int threads = GetNumberOfThreads( numberOfThreads );
+
+#pragma omp parallel for schedule(dynamic) num_threads( threads )
+  for( int source = 0; source < numberOfVertices; source++ )
+  {
+    std::vector< mitk::ConnectomicsNetwork::VertexDescriptorType > predecessorMap( numberOfVertices );
+    boost::dijkstra_shortest_paths( graph, boost::vertex( source, graph ),
+      boost::predecessor_map( &predecessorMap[ 0 ] ).distance_map( &distances[ source ][ 0 ] ).weight_map(
+      boost::get( &mitk::ConnectomicsNetwork::NetworkEdge::edge_weight, graph ) ) );
+  }
+}
@@ -0,0 +1,63 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#ifndef mitkConnectomicsGraphAlgorithms_h
+#define mitkConnectomicsGraphAlgorithms_h
+
+#include <mitkConnectomicsNetwork.h>
+
+#include <MitkConnectomicsExports.h>
+
+#include <vector>
+
+namespace mitk
+{
+  /**
+  * \brief Multi-threaded all-sources graph algorithms for connectomics networks
+  *
+  * The sources are distributed statically over the threads. Each thread accumulates into its own buffers, which are
+  * summed up in thread order afterwards, so the results are reproducible for a fixed number of threads.
+  * A number of threads of 0 uses the OpenMP default.
+  */
+  class MITKCONNECTOMICS_EXPORT ConnectomicsGraphAlgorithms
+  {
+  public:
+
+    typedef mitk::ConnectomicsNetwork::NetworkType NetworkType;
+
+    /** \brief Brandes betweenness centrality of the unweighted graph
+    *
+    * Yields the same values as boost::brandes_betweenness_centrality (up to rounding). The vertex centralities are
+    * indexed by the vertex index, the edge centralities (optional) in the order of boost::edges().
+    */
+    static void CalculateBetweennessCentrality( const NetworkType& graph, std::vector< double >& vertexCentrality,
+      std::vector< double >* edgeCentrality = nullptr, int numberOfThreads = 0 );
+
+    /** \brief Dijkstra shortest path lengths from every vertex, using the edge_weight of the edges
+    *
+    * distances[ source ][ target ] as computed by boost::dijkstra_shortest_paths, unreachable vertices have a
+    * distance of std::numeric_limits< int >::max().
+    */
+    static void CalculateShortestPathDistances( const NetworkType& graph, std::vector< std::vector< int > >& distances,
+      int numberOfThreads = 0 );
+
+    /** Resolves the number of threads (0: OpenMP default, 1 without OpenMP) */
+    static int GetNumberOfThreads( int numberOfThreads );
+  };
+
+}// end namespace mitk
+
+#endif // mitkConnectomicsGraphAlgorithms_h
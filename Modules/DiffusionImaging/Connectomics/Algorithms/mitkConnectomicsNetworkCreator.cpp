@@ -16,6 +16,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 #include "mitkConnectomicsNetworkCreator.h"
 
+#include <algorithm>
 #include <sstream>
 #include <vector>
 
@@ -31,6 +32,68 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <vtkPolyLine.h>
 #include <vtkCellArray.h>
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace
+{
+  /** First occurrence of a label at a fiber end (key = 2 * fiber index + end) and its segmentation index */
+  struct LabelOccurrence
+  {
+    unsigned long key;
+    itk::Index<3> index;
+  };
+
+  /** Number of fibers connecting two labels, oriented as the first of these fibers */
+  struct EdgeOccurrence
+  {
+    unsigned long firstFiber;
+    int source;
+    int target;
+    int count;
+  };
+
+  typedef std::map< int, LabelOccurrence >                    LabelOccurrenceMapType;
+  typedef std::map< std::pair< int, int >, EdgeOccurrence >   EdgeOccurrenceMapType;
+
+  void AddLabelOccurrence( LabelOccurrenceMapType& labels, int label, unsigned long key, const itk::Index<3>& index )
+  {
+    LabelOccurrenceMapType::iterator it = labels.find( label );
+    if( it == labels.end() )
+    {
+      LabelOccurrence occurrence = { key, index };
+      labels.insert( std::make_pair( label, occurrence ) );
+    }
+    else if( key < it->second.key )
+    {
+      it->second.key = key;
+      it->second.index = index;
+    }
+  }
+
+  void AddEdgeOccurrence( EdgeOccurrenceMapType& edges, const EdgeOccurrence& edge )
+  {
+    // the network is undirected
+    std::pair< int, int > labelpair( std::min( edge.source, edge.target ), std::max( edge.source, edge.target ) );
+    EdgeOccurrenceMapType::iterator it = edges.find( labelpair );
+    if( it == edges.end() )
+    {
+      edges.insert( std::make_pair( labelpair, edge ) );
+    }
+    else
+    {
+      it->second.count += edge.count;
+      if( edge.firstFiber < it->second.firstFiber )
+      {
+        it->second.firstFiber = edge.firstFiber;
+        it->second.source = edge.source;
+        it->second.target = edge.target;
+      }
+    }
+  }
+}
+
 mitk::ConnectomicsNetworkCreator::ConnectomicsNetworkCreator()
 : m_FiberBundle()
 , m_Segmentation()
@@ -44,7 +107,7 @@ mitk::ConnectomicsNetworkCreator::ConnectomicsNetworkCreator()
 , m_MappingStrategy( EndElementPositionAvoidingWhiteMatter )
 , m_EndPointSearchRadius( 10.0 )
 , m_ZeroLabelInvalid( true )
-, m_AbortConnection( false )
+, m_NumberOfThreads( 0 )
 {
 }
 
@@ -60,7 +123,7 @@ mitk::ConnectomicsNetworkCreator::ConnectomicsNetworkCreator( mitk::Image::Point
 , m_MappingStrategy( EndElementPositionAvoidingWhiteMatter )
 , m_EndPointSearchRadius( 10.0 )
 , m_ZeroLabelInvalid( true )
-, m_AbortConnection( false )
+, m_NumberOfThreads( 0 )
 {
   mitk::CastToItkImage( segmentation, m_SegmentationItk );
 }
@@ -100,77 +163,136 @@ void mitk::ConnectomicsNetworkCreator::CreateNetworkFromFibersAndSegmentation()
 
   vtkSmartPointer<vtkPolyData> fiberPolyData = m_FiberBundle->GetFiberPolyData();
   vtkSmartPointer<vtkCellArray> vLines = fiberPolyData->GetLines();
-  vLines->InitTraversal();
+  vtkPoints* fiberPoints = fiberPolyData->GetPoints();
 
+  // point ids of all fibers, so that the fibers can be processed in any order
   int numFibers = m_FiberBundle->GetNumFibers();
+  std::vector< vtkIdType > numPointsInCell( numFibers, 0 );
+  std::vector< vtkIdType* > pointsInCell( numFibers, nullptr );
+  vLines->InitTraversal();
   for( int fiberID( 0 ); fiberID < numFibers; fiberID++ )
   {
-    vtkIdType   numPointsInCell(0);
-    vtkIdType*  pointsInCell(nullptr);
-    vLines->GetNextCell ( numPointsInCell, pointsInCell );
+    vLines->GetNextCell( numPointsInCell[ fiberID ], pointsInCell[ fiberID ] );
+  }
+
+  // the geometries compute their inverse transforms lazily, so this is done before the threads access them
+  mitk::Point3D dummyCoord, dummySegCoord;
+  dummyCoord.Fill( 0 );
+  FiberToSegmentationCoords( dummyCoord, dummySegCoord );
+  SegmentationToFiberCoords( dummySegCoord, dummyCoord );
+
+  int numThreads( 1 );
+#ifdef _OPENMP
+  numThreads = m_NumberOfThreads > 0 ? m_NumberOfThreads : omp_get_max_threads();
+#endif
 
-    TractType::Pointer singleTract = TractType::New();
-    for( int pointInCellID( 0 ); pointInCellID < numPointsInCell ; pointInCellID++)
+  // each thread collects the labels and connections of its fibers
+  std::vector< LabelOccurrenceMapType > threadLabels( numThreads );
+  std::vector< EdgeOccurrenceMapType > threadEdges( numThreads );
+  std::vector< FiberType > threadFibers( numThreads );
+
+#pragma omp parallel for schedule(dynamic, 256) num_threads(numThreads)
+  for( int fiberID = 0; fiberID < numFibers; fiberID++ )
+  {
+    int thread( 0 );
+#ifdef _OPENMP
+    thread = omp_get_thread_num();
+#endif
+    if( numPointsInCell[ fiberID ] <= 0 )
     {
-      // push back point
-      PointType point = GetItkPoint( fiberPolyData->GetPoint( pointsInCell[ pointInCellID ] ) );
-      singleTract->InsertElement( singleTract->Size(), point );
+      continue;
     }
 
-    if ( singleTract && ( singleTract->Size() > 0 ) )
+    FiberType& fiber = threadFibers[ thread ];
+    fiber.resize( numPointsInCell[ fiberID ] );
+    for( int pointInCellID( 0 ); pointInCellID < numPointsInCell[ fiberID ] ; pointInCellID++)
     {
-      AddConnectionToNetwork(
-        ReturnAssociatedVertexPairForLabelPair(
-        ReturnLabelForFiberTract( singleTract, m_MappingStrategy )
-        )
-        );
-      m_AbortConnection = false;
+      double point[ 3 ];
+      fiberPoints->GetPoint( pointsInCell[ fiberID ][ pointInCellID ], point );
+      fiber[ pointInCellID ] = GetItkPoint( point );
     }
-  }
 
-  // Prune unconnected nodes
-  //m_ConNetwork->PruneUnconnectedSingleNodes();
+    itk::Index<3> firstIndex, lastIndex;
+    firstIndex.Fill( 0 );
+    lastIndex.Fill( 0 );
+    ImageLabelPairType labelpair = ReturnLabelForFiberTract( fiber, m_MappingStrategy, firstIndex, lastIndex );
 
-  // provide network with geometry
-  m_ConNetwork->SetGeometry( dynamic_cast<mitk::BaseGeometry*>(m_Segmentation->GetGeometry()->Clone().GetPointer()) );
-  m_ConNetwork->UpdateBounds();
-  m_ConNetwork->SetIsModified( true );
+    AddLabelOccurrence( threadLabels[ thread ], labelpair.first, 2 * (unsigned long)fiberID, firstIndex );
+    AddLabelOccurrence( threadLabels[ thread ], labelpair.second, 2 * (unsigned long)fiberID + 1, lastIndex );
 
-  MBI_INFO << mitk::ConnectomicsConstantsManager::CONNECTOMICS_WARNING_INFO_NETWORK_CREATED;
-}
+    bool validConnection = !( m_ZeroLabelInvalid && ( labelpair.first == 0 || labelpair.second == 0 ) );
+    if( validConnection && ( allowLoops || labelpair.first != labelpair.second ) )
+    {
+      EdgeOccurrence edge = { (unsigned long)fiberID, labelpair.first, labelpair.second, 1 };
+      AddEdgeOccurrence( threadEdges[ thread ], edge );
+    }
+  }
 
-void mitk::ConnectomicsNetworkCreator::AddConnectionToNetwork(ConnectionType newConnection)
-{
-  if( m_AbortConnection )
+  // merge the results of the threads
+  LabelOccurrenceMapType labels;
+  EdgeOccurrenceMapType edges;
+  for( int thread( 0 ); thread < numThreads; thread++ )
   {
-    MITK_DEBUG << "Connection aborted";
-    return;
+    for( LabelOccurrenceMapType::const_iterator it = threadLabels[ thread ].begin(); it != threadLabels[ thread ].end(); ++it )
+    {
+      AddLabelOccurrence( labels, it->first, it->second.key, it->second.index );
+    }
+    for( EdgeOccurrenceMapType::const_iterator it = threadEdges[ thread ].begin(); it != threadEdges[ thread ].end(); ++it )
+    {
+      AddEdgeOccurrence( edges, it->second );
+    }
   }
 
-  VertexType vertexA = newConnection.first;
-  VertexType vertexB = newConnection.second;
+  // create nodes, vertices and edges in the order in which they are encountered along the fibers,
+  // which yields the same network as adding the fibers one after the other
+  std::vector< std::pair< unsigned long, ImageLabelType > > labelOrder;
+  for( LabelOccurrenceMapType::const_iterator it = labels.begin(); it != labels.end(); ++it )
+  {
+    labelOrder.push_back( std::make_pair( it->second.key, it->first ) );
+  }
+  std::sort( labelOrder.begin(), labelOrder.end() );
 
-  // check for loops (if they are not allowed)
-  if( allowLoops || !( vertexA == vertexB ) )
+  std::map< ImageLabelType, int > labelToId;
+  for( unsigned int index( 0 ); index < labelOrder.size(); index++ )
   {
-    // If the connection already exists, increment weight, else create connection
-    if ( m_ConNetwork->EdgeExists( vertexA, vertexB ) )
-    {
-      m_ConNetwork->IncreaseEdgeWeight( vertexA, vertexB );
-    }
-    else
+    ImageLabelType label = labelOrder[ index ].second;
+    CreateNewNode( label, labels[ label ].index, m_UseCoMCoordinates );
+    if( !( m_ZeroLabelInvalid && ( label == 0 ) ) )
     {
-      m_ConNetwork->AddEdge( vertexA, vertexB );
+      labelToId[ label ] = idCounter;
+      ReturnAssociatedVertexForLabel( label );
     }
   }
-}
 
+  std::vector< std::pair< unsigned long, ImageLabelPairType > > edgeOrder;
+  for( EdgeOccurrenceMapType::const_iterator it = edges.begin(); it != edges.end(); ++it )
+  {
+    edgeOrder.push_back( std::make_pair( it->second.firstFiber, it->first ) );
+  }
+  std::sort( edgeOrder.begin(), edgeOrder.end() );
+
+  for( unsigned int index( 0 ); index < edgeOrder.size(); index++ )
+  {
+    const EdgeOccurrence& edge = edges[ edgeOrder[ index ].second ];
+    m_ConNetwork->AddEdge( m_LabelToVertexMap[ edge.source ], m_LabelToVertexMap[ edge.target ],
+      labelToId[ edge.source ], labelToId[ edge.target ], edge.count );
+  }
+
+  // Prune unconnected nodes
+  //m_ConNetwork->PruneUnconnectedSingleNodes();
+
+  // provide network with geometry
+  m_ConNetwork->SetGeometry( dynamic_cast<mitk::BaseGeometry*>(m_Segmentation->GetGeometry()->Clone().GetPointer()) );
+  m_ConNetwork->UpdateBounds();
+  m_ConNetwork->SetIsModified( true );
+
+  MBI_INFO << mitk::ConnectomicsConstantsManager::CONNECTOMICS_WARNING_INFO_NETWORK_CREATED;
+}
 
 mitk::ConnectomicsNetworkCreator::VertexType mitk::ConnectomicsNetworkCreator::ReturnAssociatedVertexForLabel( ImageLabelType label )
 {
   if( m_ZeroLabelInvalid && ( label == 0 ) )
   {
-    m_AbortConnection = true;
     return ULONG_MAX;
   }
 
@@ -187,33 +309,26 @@ mitk::ConnectomicsNetworkCreator::VertexType mitk::ConnectomicsNetworkCreator::R
   return m_LabelToVertexMap.find( label )->second;
 }
 
-mitk::ConnectomicsNetworkCreator::ConnectionType mitk::ConnectomicsNetworkCreator::ReturnAssociatedVertexPairForLabelPair( ImageLabelPairType labelpair )
-{
-  //hand both labels through to the single label function
-  ConnectionType connection( ReturnAssociatedVertexForLabel(labelpair.first), ReturnAssociatedVertexForLabel(labelpair.second) );
-
-  return connection;
-}
-
-mitk::ConnectomicsNetworkCreator::ImageLabelPairType mitk::ConnectomicsNetworkCreator::ReturnLabelForFiberTract( TractType::Pointer singleTract, mitk::ConnectomicsNetworkCreator::MappingStrategy strategy)
+mitk::ConnectomicsNetworkCreator::ImageLabelPairType mitk::ConnectomicsNetworkCreator::ReturnLabelForFiberTract( const FiberType& fiber, mitk::ConnectomicsNetworkCreator::MappingStrategy strategy,
+  itk::Index<3>& firstIndex, itk::Index<3>& lastIndex ) const
 {
   switch( strategy )
   {
   case EndElementPosition:
     {
-      return EndElementPositionLabel( singleTract );
+      return EndElementPositionLabel( fiber, firstIndex, lastIndex );
     }
   case JustEndPointVerticesNoLabel:
     {
-      return JustEndPointVerticesNoLabelTest( singleTract );
+      return JustEndPointVerticesNoLabelTest( fiber, firstIndex, lastIndex );
     }
   case EndElementPositionAvoidingWhiteMatter:
     {
-      return EndElementPositionLabelAvoidingWhiteMatter( singleTract );
+      return EndElementPositionLabelAvoidingWhiteMatter( fiber, firstIndex, lastIndex );
     }
   case PrecomputeAndDistance:
     {
-      return PrecomputeVertexLocationsBySegmentation( singleTract );
+      return PrecomputeVertexLocationsBySegmentation( fiber, firstIndex, lastIndex );
     }
   }
 
@@ -223,23 +338,22 @@ mitk::ConnectomicsNetworkCreator::ImageLabelPairType mitk::ConnectomicsNetworkCr
   return nullPair;
 }
 
-mitk::ConnectomicsNetworkCreator::ImageLabelPairType mitk::ConnectomicsNetworkCreator::EndElementPositionLabel( TractType::Pointer singleTract )
+mitk::ConnectomicsNetworkCreator::ImageLabelPairType mitk::ConnectomicsNetworkCreator::EndElementPositionLabel( const FiberType& fiber, itk::Index<3>& firstElementSegIndex, itk::Index<3>& lastElementSegIndex ) const
 {
   ImageLabelPairType labelpair;
 
   {// Note: .fib image tracts are safed using index coordinates
     mitk::Point3D firstElementFiberCoord, lastElementFiberCoord;
     mitk::Point3D firstElementSegCoord, lastElementSegCoord;
-    itk::Index<3> firstElementSegIndex, lastElementSegIndex;
 
-    if( singleTract->front().Size() != 3 )
+    if( fiber.front().Size() != 3 )
     {
       MBI_ERROR << mitk::ConnectomicsConstantsManager::CONNECTOMICS_ERROR_INVALID_DIMENSION_NEED_3;
     }
-    for( unsigned int index = 0; index < singleTract->front().Size(); index++ )
+    for( unsigned int index = 0; index < fiber.front().Size(); index++ )
     {
-      firstElementFiberCoord.SetElement( index, singleTract->front().GetElement( index ) );
-      lastElementFiberCoord.SetElement( index, singleTract->back().GetElement( index ) );
+      firstElementFiberCoord.SetElement( index, fiber.front().GetElement( index ) );
+      lastElementFiberCoord.SetElement( index, fiber.back().GetElement( index ) );
     }
 
     // convert from fiber index coordinates to segmentation index coordinates
@@ -257,39 +371,34 @@ mitk::ConnectomicsNetworkCreator::ImageLabelPairType mitk::ConnectomicsNetworkCr
 
     labelpair.first = firstLabel;
     labelpair.second = lastLabel;
-
-    // Add property to property map
-    CreateNewNode( firstLabel, firstElementSegIndex, m_UseCoMCoordinates );
-    CreateNewNode( lastLabel, lastElementSegIndex, m_UseCoMCoordinates );
   }
 
   return labelpair;
 }
 
-mitk::ConnectomicsNetworkCreator::ImageLabelPairType mitk::ConnectomicsNetworkCreator::PrecomputeVertexLocationsBySegmentation( TractType::Pointer /*singleTract*/ )
+mitk::ConnectomicsNetworkCreator::ImageLabelPairType mitk::ConnectomicsNetworkCreator::PrecomputeVertexLocationsBySegmentation( const FiberType& /*fiber*/, itk::Index<3>& /*firstIndex*/, itk::Index<3>& /*lastIndex*/ ) const
 {
-  ImageLabelPairType labelpair;
+  ImageLabelPairType labelpair( 0, 0 );
 
   return labelpair;
 }
 
-mitk::ConnectomicsNetworkCreator::ImageLabelPairType mitk::ConnectomicsNetworkCreator::EndElementPositionLabelAvoidingWhiteMatter( TractType::Pointer singleTract )
+mitk::ConnectomicsNetworkCreator::ImageLabelPairType mitk::ConnectomicsNetworkCreator::EndElementPositionLabelAvoidingWhiteMatter( const FiberType& fiber, itk::Index<3>& firstElementSegIndex, itk::Index<3>& lastElementSegIndex ) const
 {
   ImageLabelPairType labelpair;
 
   {// Note: .fib image tracts are safed using index coordinates
     mitk::Point3D firstElementFiberCoord, lastElementFiberCoord;
     mitk::Point3D firstElementSegCoord, lastElementSegCoord;
-    itk::Index<3> firstElementSegIndex, lastElementSegIndex;
 
-    if( singleTract->front().Size() != 3 )
+    if( fiber.front().Size() != 3 )
     {
       MBI_ERROR << mitk::ConnectomicsConstantsManager::CONNECTOMICS_ERROR_INVALID_DIMENSION_NEED_3;
     }
-    for( unsigned int index = 0; index < singleTract->front().Size(); index++ )
+    for( unsigned int index = 0; index < fiber.front().Size(); index++ )
     {
-      firstElementFiberCoord.SetElement( index, singleTract->front().GetElement( index ) );
-      lastElementFiberCoord.SetElement( index, singleTract->back().GetElement( index ) );
+      firstElementFiberCoord.SetElement( index, fiber.front().GetElement( index ) );
+      lastElementFiberCoord.SetElement( index, fiber.back().GetElement( index ) );
     }
 
     // convert from fiber index coordinates to segmentation index coordinates
@@ -328,7 +437,7 @@ mitk::ConnectomicsNetworkCreator::ImageLabelPairType mitk::ConnectomicsNetworkCr
       int tempLabel( firstLabel );
       itk::Index<3> tempIndex = firstElementSegIndex;
 
-      LinearExtensionUntilGreyMatter( indexVectorOfPointsToUse, singleTract, tempLabel, tempIndex );
+      LinearExtensionUntilGreyMatter( indexVectorOfPointsToUse, fiber, tempLabel, tempIndex );
 
       firstLabel = tempLabel;
       firstElementSegIndex = tempIndex;
@@ -340,14 +449,14 @@ mitk::ConnectomicsNetworkCreator::ImageLabelPairType mitk::ConnectomicsNetworkCr
       std::vector< int > indexVectorOfPointsToUse;
 
       //Use last two points for direction
-      indexVectorOfPointsToUse.push_back( singleTract->Size() - 2 );
-      indexVectorOfPointsToUse.push_back( singleTract->Size() - 1 );
+      indexVectorOfPointsToUse.push_back( fiber.size() - 2 );
+      indexVectorOfPointsToUse.push_back( fiber.size() - 1 );
 
       // label and coordinate temp storage
       int tempLabel( lastLabel );
       itk::Index<3> tempIndex = lastElementSegIndex;
 
-      LinearExtensionUntilGreyMatter( indexVectorOfPointsToUse, singleTract, tempLabel, tempIndex );
+      LinearExtensionUntilGreyMatter( indexVectorOfPointsToUse, fiber, tempLabel, tempIndex );
 
       lastLabel = tempLabel;
       lastElementSegIndex = tempIndex;
@@ -358,7 +467,7 @@ mitk::ConnectomicsNetworkCreator::ImageLabelPairType mitk::ConnectomicsNetworkCr
       int tempLabel( firstLabel );
       itk::Index<3> tempIndex = firstElementSegIndex;
 
-      RetractionUntilBrainMatter( true, singleTract, tempLabel, tempIndex );
+      RetractionUntilBrainMatter( true, fiber, tempLabel, tempIndex );
 
       firstLabel = tempLabel;
       firstElementSegIndex = tempIndex;
@@ -371,7 +480,7 @@ mitk::ConnectomicsNetworkCreator::ImageLabelPairType mitk::ConnectomicsNetworkCr
       int tempLabel( lastLabel );
       itk::Index<3> tempIndex = lastElementSegIndex;
 
-      RetractionUntilBrainMatter( false, singleTract, tempLabel, tempIndex );
+      RetractionUntilBrainMatter( false, fiber, tempLabel, tempIndex );
 
       lastLabel = tempLabel;
       lastElementSegIndex = tempIndex;
@@ -383,32 +492,27 @@ mitk::ConnectomicsNetworkCreator::ImageLabelPairType mitk::ConnectomicsNetworkCr
 
     labelpair.first = firstLabel;
     labelpair.second = lastLabel;
-
-    // Add property to property map
-    CreateNewNode( firstLabel, firstElementSegIndex, m_UseCoMCoordinates );
-    CreateNewNode( lastLabel, lastElementSegIndex, m_UseCoMCoordinates );
   }
 
   return labelpair;
 }
 
-mitk::ConnectomicsNetworkCreator::ImageLabelPairType mitk::ConnectomicsNetworkCreator::JustEndPointVerticesNoLabelTest( TractType::Pointer singleTract )
+mitk::ConnectomicsNetworkCreator::ImageLabelPairType mitk::ConnectomicsNetworkCreator::JustEndPointVerticesNoLabelTest( const FiberType& fiber, itk::Index<3>& firstElementSegIndex, itk::Index<3>& lastElementSegIndex ) const
 {
   ImageLabelPairType labelpair;
 
    {// Note: .fib image tracts are safed using index coordinates
     mitk::Point3D firstElementFiberCoord, lastElementFiberCoord;
     mitk::Point3D firstElementSegCoord, lastElementSegCoord;
-    itk::Index<3> firstElementSegIndex, lastElementSegIndex;
 
-    if( singleTract->front().Size() != 3 )
+    if( fiber.front().Size() != 3 )
     {
       MBI_ERROR << mitk::ConnectomicsConstantsManager::CONNECTOMICS_ERROR_INVALID_DIMENSION_NEED_3;
     }
-    for( unsigned int index = 0; index < singleTract->front().Size(); index++ )
+    for( unsigned int index = 0; index < fiber.front().Size(); index++ )
     {
-      firstElementFiberCoord.SetElement( index, singleTract->front().GetElement( index ) );
-      lastElementFiberCoord.SetElement( index, singleTract->back().GetElement( index ) );
+      firstElementFiberCoord.SetElement( index, fiber.front().GetElement( index ) );
+      lastElementFiberCoord.SetElement( index, fiber.back().GetElement( index ) );
     }
 
     // convert from fiber index coordinates to segmentation index coordinates
@@ -426,10 +530,6 @@ mitk::ConnectomicsNetworkCreator::ImageLabelPairType mitk::ConnectomicsNetworkCr
 
     labelpair.first = firstLabel;
     labelpair.second = lastLabel;
-
-    // Add property to property map
-    CreateNewNode( firstLabel, firstElementSegIndex, m_UseCoMCoordinates );
-    CreateNewNode( lastLabel, lastElementSegIndex, m_UseCoMCoordinates );
   }
 
   return labelpair;
@@ -460,7 +560,7 @@ mitk::ConnectomicsNetwork::Pointer mitk::ConnectomicsNetworkCreator::GetNetwork(
   return m_ConNetwork;
 }
 
-void mitk::ConnectomicsNetworkCreator::FiberToSegmentationCoords( mitk::Point3D& fiberCoord, mitk::Point3D& segCoord )
+void mitk::ConnectomicsNetworkCreator::FiberToSegmentationCoords( mitk::Point3D& fiberCoord, mitk::Point3D& segCoord ) const
 {
   mitk::Point3D tempPoint;
 
@@ -469,7 +569,7 @@ void mitk::ConnectomicsNetworkCreator::FiberToSegmentationCoords( mitk::Point3D&
   m_Segmentation->GetGeometry()->WorldToIndex( tempPoint, segCoord );
 }
 
-void mitk::ConnectomicsNetworkCreator::SegmentationToFiberCoords( mitk::Point3D& segCoord, mitk::Point3D& fiberCoord )
+void mitk::ConnectomicsNetworkCreator::SegmentationToFiberCoords( mitk::Point3D& segCoord, mitk::Point3D& fiberCoord ) const
 {
   mitk::Point3D tempPoint;
 
@@ -478,7 +578,7 @@ void mitk::ConnectomicsNetworkCreator::SegmentationToFiberCoords( mitk::Point3D&
   m_FiberBundle->GetGeometry()->WorldToIndex( tempPoint, fiberCoord );
 }
 
-bool mitk::ConnectomicsNetworkCreator::IsNonWhiteMatterLabel( int labelInQuestion )
+bool mitk::ConnectomicsNetworkCreator::IsNonWhiteMatterLabel( int labelInQuestion ) const
 {
   bool isWhite( false );
 
@@ -495,7 +595,7 @@ bool mitk::ConnectomicsNetworkCreator::IsNonWhiteMatterLabel( int labelInQuestio
   return !isWhite;
 }
 
-bool mitk::ConnectomicsNetworkCreator::IsBackgroundLabel( int labelInQuestion )
+bool mitk::ConnectomicsNetworkCreator::IsBackgroundLabel( int labelInQuestion ) const
 {
   bool isBackground( false );
 
@@ -506,11 +606,11 @@ bool mitk::ConnectomicsNetworkCreator::IsBackgroundLabel( int labelInQuestion )
 
 void mitk::ConnectomicsNetworkCreator::LinearExtensionUntilGreyMatter(
   std::vector<int> & indexVectorOfPointsToUse,
-  TractType::Pointer singleTract,
+  const FiberType& fiber,
   int & label,
-  itk::Index<3> & mitkIndex )
+  itk::Index<3> & mitkIndex ) const
 {
-  if( indexVectorOfPointsToUse.size() > singleTract->Size() )
+  if( indexVectorOfPointsToUse.size() > fiber.size() )
   {
     MBI_WARN << mitk::ConnectomicsConstantsManager::CONNECTOMICS_WARNING_MORE_POINTS_THAN_PRESENT;
     return;
@@ -529,7 +629,7 @@ void mitk::ConnectomicsNetworkCreator::LinearExtensionUntilGreyMatter(
       MBI_WARN << mitk::ConnectomicsConstantsManager::CONNECTOMICS_WARNING_ESTIMATING_BEYOND_START;
       return;
     }
-    if( (unsigned int)indexVectorOfPointsToUse[ index ] > singleTract->Size() )
+    if( (unsigned int)indexVectorOfPointsToUse[ index ] > fiber.size() )
     {
       MBI_WARN << mitk::ConnectomicsConstantsManager::CONNECTOMICS_WARNING_ESTIMATING_BEYOND_END;
       return;
@@ -538,7 +638,7 @@ void mitk::ConnectomicsNetworkCreator::LinearExtensionUntilGreyMatter(
 
   mitk::Point3D startPoint, endPoint;
   std::vector< double > differenceVector;
-  differenceVector.resize( singleTract->front().Size() );
+  differenceVector.resize( fiber.front().Size() );
 
   {
     // which points to use, currently only last two //TODO correct using all points
@@ -547,10 +647,10 @@ void mitk::ConnectomicsNetworkCreator::LinearExtensionUntilGreyMatter(
 
     // convert to segmentation coords
     mitk::Point3D startFiber, endFiber;
-    for( unsigned int index = 0; index < singleTract->front().Size(); index++ )
+    for( unsigned int index = 0; index < fiber.front().Size(); index++ )
     {
-      endFiber.SetElement( index, singleTract->GetElement( indexVectorOfPointsToUse[ endPointIndex ] ).GetElement( index ) );
-      startFiber.SetElement( index, singleTract->GetElement( indexVectorOfPointsToUse[ startPointIndex ] ).GetElement( index ) );
+      endFiber.SetElement( index, fiber[ indexVectorOfPointsToUse[ endPointIndex ] ].GetElement( index ) );
+      startFiber.SetElement( index, fiber[ indexVectorOfPointsToUse[ startPointIndex ] ].GetElement( index ) );
     }
 
     FiberToSegmentationCoords( endFiber, endPoint );
@@ -558,7 +658,7 @@ void mitk::ConnectomicsNetworkCreator::LinearExtensionUntilGreyMatter(
 
     // calculate straight line
 
-    for( unsigned int index = 0; index < singleTract->front().Size(); index++ )
+    for( unsigned int index = 0; index < fiber.front().Size(); index++ )
     {
       differenceVector[ index ] = endPoint.GetElement( index ) - startPoint.GetElement( index );
     }
@@ -629,10 +729,10 @@ void mitk::ConnectomicsNetworkCreator::LinearExtensionUntilGreyMatter(
   }
 }
 
-void mitk::ConnectomicsNetworkCreator::RetractionUntilBrainMatter( bool retractFront, TractType::Pointer singleTract,
-                                                                  int & label, itk::Index<3> & mitkIndex )
+void mitk::ConnectomicsNetworkCreator::RetractionUntilBrainMatter( bool retractFront, const FiberType& fiber,
+                                                                  int & label, itk::Index<3> & mitkIndex ) const
 {
-  int retractionStartIndex( singleTract->Size() - 1 );
+  int retractionStartIndex( fiber.size() - 1 );
   int retractionStepIndexSize( -1 );
   int retractionTerminationIndex( 0 );
 
@@ -640,7 +740,7 @@ void mitk::ConnectomicsNetworkCreator::RetractionUntilBrainMatter( bool retractF
   {
     retractionStartIndex = 0;
     retractionStepIndexSize = 1;
-    retractionTerminationIndex = singleTract->Size() - 1;
+    retractionTerminationIndex = fiber.size() - 1;
   }
 
   int currentRetractionIndex = retractionStartIndex;
@@ -649,16 +749,16 @@ void mitk::ConnectomicsNetworkCreator::RetractionUntilBrainMatter( bool retractF
 
   mitk::Point3D currentPoint, nextPoint;
   std::vector< double > differenceVector;
-  differenceVector.resize( singleTract->front().Size() );
+  differenceVector.resize( fiber.front().Size() );
 
   while( keepRetracting && ( currentRetractionIndex != retractionTerminationIndex ) )
   {
     // convert to segmentation coords
     mitk::Point3D currentPointFiberCoord, nextPointFiberCoord;
-    for( unsigned int index = 0; index < singleTract->front().Size(); index++ )
+    for( unsigned int index = 0; index < fiber.front().Size(); index++ )
     {
-      currentPointFiberCoord.SetElement( index, singleTract->GetElement( currentRetractionIndex ).GetElement( index ) );
-      nextPointFiberCoord.SetElement( index, singleTract->GetElement( currentRetractionIndex + retractionStepIndexSize ).GetElement( index ) );
+      currentPointFiberCoord.SetElement( index, fiber[ currentRetractionIndex ].GetElement( index ) );
+      nextPointFiberCoord.SetElement( index, fiber[ currentRetractionIndex + retractionStepIndexSize ].GetElement( index ) );
     }
 
     FiberToSegmentationCoords( currentPointFiberCoord, currentPoint );
@@ -666,7 +766,7 @@ void mitk::ConnectomicsNetworkCreator::RetractionUntilBrainMatter( bool retractF
 
     // calculate straight line
 
-    for( unsigned int index = 0; index < singleTract->front().Size(); index++ )
+    for( unsigned int index = 0; index < fiber.front().Size(); index++ )
     {
       differenceVector[ index ] = nextPoint.GetElement( index ) - currentPoint.GetElement( index );
     }
@@ -703,10 +803,10 @@ void mitk::ConnectomicsNetworkCreator::RetractionUntilBrainMatter( bool retractF
         // check whether result is within the search space
         {
           mitk::Point3D endPoint, foundPointSegmentation, foundPointFiber;
-          for( unsigned int index = 0; index < singleTract->front().Size(); index++ )
+          for( unsigned int index = 0; index < fiber.front().Size(); index++ )
           {
             // this is in fiber (world) coordinates
-            endPoint.SetElement( index, singleTract->GetElement( retractionStartIndex ).GetElement( index ) );
+            endPoint.SetElement( index, fiber[ retractionStartIndex ].GetElement( index ) );
           }
 
           for( int index( 0 ); index < 3; index++ )
@@ -718,8 +818,8 @@ void mitk::ConnectomicsNetworkCreator::RetractionUntilBrainMatter( bool retractF
           SegmentationToFiberCoords( foundPointSegmentation, foundPointFiber );
 
           std::vector< double > finalDistance;
-          finalDistance.resize( singleTract->front().Size() );
-          for( unsigned int index = 0; index < singleTract->front().Size(); index++ )
+          finalDistance.resize( fiber.front().Size() );
+          for( unsigned int index = 0; index < fiber.front().Size(); index++ )
           {
             finalDistance[ index ] = foundPointFiber.GetElement( index ) - endPoint.GetElement( index );
           }
@@ -748,7 +848,7 @@ void mitk::ConnectomicsNetworkCreator::RetractionUntilBrainMatter( bool retractF
       }
       // hit next point without finding brain matter
       currentRetractionIndex = currentRetractionIndex + retractionStepIndexSize;
-      if( ( currentRetractionIndex < 1 ) || ( (unsigned int)currentRetractionIndex > ( singleTract->Size() - 2 ) ) )
+      if( ( currentRetractionIndex < 1 ) || ( (unsigned int)currentRetractionIndex > ( fiber.size() - 2 ) ) )
       {
         keepRetracting = false;
       }
@@ -68,6 +68,7 @@ namespace mitk
     typedef itk::Point<float,3>                                          PointType;
     typedef itk::VectorContainer<unsigned int, PointType>                TractType;
     typedef itk::VectorContainer< unsigned int, TractType::Pointer >     TractContainerType; //init via smartpointer
+    typedef std::vector< PointType >                                     FiberType;
 
 
     /** Types for Network **/
@@ -90,6 +91,7 @@ namespace mitk
     itkSetMacro(MappingStrategy, MappingStrategy);
     itkSetMacro(EndPointSearchRadius, double);
     itkSetMacro(ZeroLabelInvalid, bool);
+    itkSetMacro(NumberOfThreads, int);  ///< number of threads used for the fiber to label mapping (0: OpenMP default)
 
     /** \brief Calculate the locations of vertices
      *
@@ -106,17 +108,15 @@ namespace mitk
     ConnectomicsNetworkCreator( mitk::Image::Pointer segmentation, mitk::FiberBundle::Pointer fiberBundle );
     ~ConnectomicsNetworkCreator();
 
-    /** Add a connection to the network */
-    void AddConnectionToNetwork(ConnectionType newConnection);
-
     /** Determine if a label is already identified with a vertex, otherwise create a new one */
     VertexType ReturnAssociatedVertexForLabel( ImageLabelType label );
 
-    /** Return the vertexes associated with a pair of labels */
-    ConnectionType ReturnAssociatedVertexPairForLabelPair( ImageLabelPairType labelpair );
+    /** Return the pair of labels which identify the areas connected by a single fiber
 
-    /** Return the pair of labels which identify the areas connected by a single fiber */
-    ImageLabelPairType ReturnLabelForFiberTract( TractType::Pointer singleTract, MappingStrategy strategy );
+    The segmentation indices at which the labels were found are returned in firstIndex and lastIndex. This does not
+    modify the creator and is called concurrently for different fibers. */
+    ImageLabelPairType ReturnLabelForFiberTract( const FiberType& fiber, MappingStrategy strategy,
+      itk::Index<3>& firstIndex, itk::Index<3>& lastIndex ) const;
 
     /** Assign the additional information which should be part of the vertex */
     void SupplyVertexWithInformation( ImageLabelType& label, VertexType& vertex );
@@ -125,23 +125,23 @@ namespace mitk
     std::string LabelToString( ImageLabelType& label );
 
     /** Check whether the label in question belongs to white matter according to the freesurfer table */
-    bool IsNonWhiteMatterLabel( int labelInQuestion );
+    bool IsNonWhiteMatterLabel( int labelInQuestion ) const;
 
     /** Check whether the label in question belongs to background according to the freesurfer table */
-    bool IsBackgroundLabel( int labelInQuestion );
+    bool IsBackgroundLabel( int labelInQuestion ) const;
 
     /** Extend a straight line through the given points and look for the first non white matter label
 
     It will try extend in the direction of the points in the vector so a vector {B,C} will result in
     extending from C in the direction C-B */
-    void LinearExtensionUntilGreyMatter( std::vector<int> & indexVectorOfPointsToUse, TractType::Pointer singleTract,
-      int & label, itk::Index<3> & mitkIndex );
+    void LinearExtensionUntilGreyMatter( std::vector<int> & indexVectorOfPointsToUse, const FiberType& fiber,
+      int & label, itk::Index<3> & mitkIndex ) const;
 
     /** Retract fiber until the first brain matter label is hit
 
     The bool parameter controls whether the front or the end is retracted */
-    void RetractionUntilBrainMatter( bool retractFront, TractType::Pointer singleTract,
-      int & label, itk::Index<3> & mitkIndex );
+    void RetractionUntilBrainMatter( bool retractFront, const FiberType& fiber,
+      int & label, itk::Index<3> & mitkIndex ) const;
 
     /** \brief Get the location of the center of mass for a specific label
      * This can throw an exception if the label is not found.
@@ -164,31 +164,31 @@ namespace mitk
 
     Map a fiber to a vertex by taking the value of the parcellation image at the same world coordinates as the last
     and first element of the tract.*/
-    ImageLabelPairType EndElementPositionLabel( TractType::Pointer singleTract );
+    ImageLabelPairType EndElementPositionLabel( const FiberType& fiber, itk::Index<3>& firstIndex, itk::Index<3>& lastIndex ) const;
 
     /** Map by distance between elements and vertices depending on their volume
 
     First go through the parcellation and compute the coordinates of the future vertices. Assign a radius according on their volume.
     Then map an edge to a label by considering the nearest vertices and comparing the distance to them to their radii. */
-    ImageLabelPairType PrecomputeVertexLocationsBySegmentation( TractType::Pointer singleTract );
+    ImageLabelPairType PrecomputeVertexLocationsBySegmentation( const FiberType& fiber, itk::Index<3>& firstIndex, itk::Index<3>& lastIndex ) const;
 
         /** Use the position of the end and starting element only to map to labels
 
     Just take first and last position, no labelling, nothing */
-    ImageLabelPairType JustEndPointVerticesNoLabelTest( TractType::Pointer singleTract );
+    ImageLabelPairType JustEndPointVerticesNoLabelTest( const FiberType& fiber, itk::Index<3>& firstIndex, itk::Index<3>& lastIndex ) const;
 
     /** Use the position of the end and starting element unless it is in white matter, then search for nearby parcellation to map to labels
 
     Map a fiber to a vertex by taking the value of the parcellation image at the same world coordinates as the last
     and first element of the tract. If this happens to be white matter, then try to extend the fiber in a line and
     take the first non-white matter parcel, that is intersected. */
-    ImageLabelPairType EndElementPositionLabelAvoidingWhiteMatter( TractType::Pointer singleTract );
+    ImageLabelPairType EndElementPositionLabelAvoidingWhiteMatter( const FiberType& fiber, itk::Index<3>& firstIndex, itk::Index<3>& lastIndex ) const;
 
     ///////// Conversions //////////
     /** Convert fiber index to segmentation index coordinates */
-    void FiberToSegmentationCoords( mitk::Point3D& fiberCoord, mitk::Point3D& segCoord );
+    void FiberToSegmentationCoords( mitk::Point3D& fiberCoord, mitk::Point3D& segCoord ) const;
     /** Convert segmentation index to fiber index coordinates */
-    void SegmentationToFiberCoords( mitk::Point3D& segCoord, mitk::Point3D& fiberCoord );
+    void SegmentationToFiberCoords( mitk::Point3D& segCoord, mitk::Point3D& fiberCoord ) const;
 
     /////////////////////// Variables ////////////////////////
     mitk::FiberBundle::Pointer m_FiberBundle;
@@ -225,9 +225,8 @@ namespace mitk
     // toggles whether a node with the label 0 may be present
     bool m_ZeroLabelInvalid;
 
-    // used internally to communicate a connection should not be added if the a problem
-    // is encountered while adding it
-    bool m_AbortConnection;
+    // number of threads used for mapping the fibers to labels
+    int m_NumberOfThreads;
 
     //////////////////////// IDs ////////////////////////////
 
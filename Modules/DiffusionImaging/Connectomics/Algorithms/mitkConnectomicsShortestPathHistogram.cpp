@@ -20,6 +20,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <boost/graph/dijkstra_shortest_paths.hpp>
 
 #include "mitkConnectomicsConstantsManager.h"
+#include "mitkConnectomicsGraphAlgorithms.h"
 
 mitk::ConnectomicsShortestPathHistogram::ConnectomicsShortestPathHistogram()
 : m_Mode( UnweightedUndirectedMode )
@@ -66,22 +67,8 @@ void mitk::ConnectomicsShortestPathHistogram::ComputeFromConnectomicsNetwork( Co
 
 void mitk::ConnectomicsShortestPathHistogram::CalculateUnweightedUndirectedShortestPaths( NetworkType* boostGraph )
 {
-  std::vector< DescriptorType > predecessorMap( boost::num_vertices( *boostGraph ) );
-  int numberOfNodes( boost::num_vertices( *boostGraph ) );
-
-  m_DistanceMatrix.resize( numberOfNodes );
-  for(unsigned int index(0); index < m_DistanceMatrix.size(); index++ )
-  {
-    m_DistanceMatrix[ index ].resize( numberOfNodes );
-  }
-
-  IteratorType iterator, end;
-  boost::tie(iterator, end) = boost::vertices( *boostGraph );
-
-  for ( int index(0) ; iterator != end; ++iterator, index++)
-  {
-          boost::dijkstra_shortest_paths(*boostGraph, *iterator, boost::predecessor_map(&predecessorMap[ 0 ]).distance_map(&m_DistanceMatrix[ index ][ 0 ]).weight_map( boost::get( &mitk::ConnectomicsNetwork::NetworkEdge::edge_weight ,*boostGraph ) ) ) ;
-  }
+  // one Dijkstra run per source node, the sources are processed in parallel
+  mitk::ConnectomicsGraphAlgorithms::CalculateShortestPathDistances( *boostGraph, m_DistanceMatrix );
 }
 
 void mitk::ConnectomicsShortestPathHistogram::CalculateWeightedUndirectedShortestPaths( NetworkType* /*boostGraph*/ )
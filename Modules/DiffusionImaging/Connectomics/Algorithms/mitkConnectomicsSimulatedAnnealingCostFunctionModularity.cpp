@@ -31,21 +31,38 @@ double mitk::ConnectomicsSimulatedAnnealingCostFunctionModularity::Evaluate( mit
   return cost;
 }
 
+double mitk::ConnectomicsSimulatedAnnealingCostFunctionModularity::Evaluate( const ModuleStatistics& statistics ) const
+{
+  double cost( 0.0 );
+  cost = 100.0 * ( 1.0 - CalculateModularity( statistics ) );
+  return cost;
+}
+
 double mitk::ConnectomicsSimulatedAnnealingCostFunctionModularity::CalculateModularity( mitk::ConnectomicsNetwork::Pointer network, ToModuleMapType* vertexToModuleMap ) const
 {
-  double modularity( 0.0 );
+  ModuleStatistics statistics;
+  if( !CalculateModuleStatistics( network, vertexToModuleMap, &statistics ) )
+  {
+    return 0.0;
+  }
+
+  return CalculateModularity( statistics );
+}
+
+bool mitk::ConnectomicsSimulatedAnnealingCostFunctionModularity::CalculateModuleStatistics(
+  mitk::ConnectomicsNetwork::Pointer network, ToModuleMapType* vertexToModuleMap, ModuleStatistics* statistics ) const
+{
   int numberOfModules = getNumberOfModules( vertexToModuleMap );
 
   if( network->GetNumberOfVertices() != (int)vertexToModuleMap->size() )
   {
     MBI_ERROR << "Number of vertices and vertex to module map size do not match!";
-    return modularity;
+    return false;
   }
 
-  int numberOfLinksInNetwork( 0 );
-  std::vector< int > numberOfLinksInModule, sumOfDegreesInModule;
-  numberOfLinksInModule.resize( numberOfModules, 0 );
-  sumOfDegreesInModule.resize( numberOfModules, 0 );
+  statistics->numberOfLinksInNetwork = 0;
+  statistics->numberOfLinksInModule.assign( numberOfModules, 0 );
+  statistics->sumOfDegreesInModule.assign( numberOfModules, 0 );
   // get vector of all vertex descriptors in the network
 
   const std::vector< VertexDescriptorType > allNodesVector
@@ -56,20 +73,28 @@ double mitk::ConnectomicsSimulatedAnnealingCostFunctionModularity::CalculateModu
     int correspondingModule = vertexToModuleMap->find( allNodesVector[ nodeNumber ] )->second;
     const std::vector< VertexDescriptorType > adjacentNodexVector
       = network->GetVectorOfAdjacentNodes( allNodesVector[ nodeNumber ] );
-    numberOfLinksInNetwork += adjacentNodexVector.size();
-    sumOfDegreesInModule[ correspondingModule ] += adjacentNodexVector.size();
+    statistics->numberOfLinksInNetwork += adjacentNodexVector.size();
+    statistics->sumOfDegreesInModule[ correspondingModule ] += adjacentNodexVector.size();
 
     for( unsigned int adjacentNodeNumber( 0 ); adjacentNodeNumber < adjacentNodexVector.size() ; adjacentNodeNumber++)
     {
       if( correspondingModule == vertexToModuleMap->find( adjacentNodexVector[ adjacentNodeNumber ] )->second )
       {
-        numberOfLinksInModule[ correspondingModule ]++;
+        statistics->numberOfLinksInModule[ correspondingModule ]++;
       }
     }
   }
 
+  return true;
+}
+
+double mitk::ConnectomicsSimulatedAnnealingCostFunctionModularity::CalculateModularity( const ModuleStatistics& statistics ) const
+{
+  double modularity( 0.0 );
+  int numberOfModules = statistics.numberOfLinksInModule.size();
+
   // the numbers for links have to be halved, as each edge was counted twice
-  numberOfLinksInNetwork = numberOfLinksInNetwork / 2;
+  int numberOfLinksInNetwork = statistics.numberOfLinksInNetwork / 2;
 
   // if the network contains no links return 0
   if( numberOfLinksInNetwork < 1)
@@ -77,11 +102,6 @@ double mitk::ConnectomicsSimulatedAnnealingCostFunctionModularity::CalculateModu
     return 0;
   }
 
-  for( int index( 0 ); index < numberOfModules ; index++)
-  {
-    numberOfLinksInModule[ index ] = numberOfLinksInModule[ index ] / 2;
-  }
-
   //Calculate modularity M:
   //M = sum_{s=1}^{N_{M}} [ (l_{s} / L) - (d_{s} / ( 2L ))^2 ]
   //where N_{M} is the number of modules
@@ -95,10 +115,11 @@ double mitk::ConnectomicsSimulatedAnnealingCostFunctionModularity::CalculateModu
 
   for( int moduleID( 0 ); moduleID < numberOfModules; moduleID++ )
   {
-    modularity += (((double) numberOfLinksInModule[ moduleID ]) / ((double) numberOfLinksInNetwork)) -
+    int numberOfLinksInModule = statistics.numberOfLinksInModule[ moduleID ] / 2;
+    modularity += (((double) numberOfLinksInModule) / ((double) numberOfLinksInNetwork)) -
       (
-      (((double) sumOfDegreesInModule[ moduleID ]) / ((double) 2 * numberOfLinksInNetwork) ) *
-      (((double) sumOfDegreesInModule[ moduleID ]) / ((double) 2 * numberOfLinksInNetwork) )
+      (((double) statistics.sumOfDegreesInModule[ moduleID ]) / ((double) 2 * numberOfLinksInNetwork) ) *
+      (((double) statistics.sumOfDegreesInModule[ moduleID ]) / ((double) 2 * numberOfLinksInNetwork) )
       );
   }
 
@@ -40,12 +40,34 @@ namespace mitk
     itkFactorylessNewMacro(Self)
     itkCloneMacro(Self)
 
+    // Counts of a mapping the modularity is calculated from. They can be updated
+    // locally when a single node changes its module, so the modularity of the new
+    // mapping is obtained without traversing the whole network again.
+    struct ModuleStatistics
+    {
+      // number of adjacencies in the network, i.e. twice the number of links
+      int numberOfLinksInNetwork;
+      // number of adjacencies between nodes of the same module, i.e. twice the number of links inside of the module
+      std::vector< int > numberOfLinksInModule;
+      // sum of the degrees of the nodes of the module
+      std::vector< int > sumOfDegreesInModule;
+    };
+
     // Evaluate the network according to the set cost function
     double Evaluate( mitk::ConnectomicsNetwork::Pointer network, ToModuleMapType *vertexToModuleMap  ) const;
 
+    // Evaluate a mapping given by its module statistics
+    double Evaluate( const ModuleStatistics& statistics ) const;
+
     // Will calculate and return the modularity of the network
     double CalculateModularity( mitk::ConnectomicsNetwork::Pointer network, ToModuleMapType *vertexToModuleMap  ) const;
 
+    // Will calculate and return the modularity of a mapping given by its module statistics
+    double CalculateModularity( const ModuleStatistics& statistics ) const;
+
+    // Count links and degrees per module, returns false if the mapping does not fit the network
+    bool CalculateModuleStatistics( mitk::ConnectomicsNetwork::Pointer network, ToModuleMapType *vertexToModuleMap, ModuleStatistics* statistics ) const;
+
 
   protected:
 
@@ -20,8 +20,18 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "vnl/vnl_random.h"
 #include "vnl/vnl_math.h"
 
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+
 mitk::ConnectomicsSimulatedAnnealingManager::ConnectomicsSimulatedAnnealingManager()
 : m_Permutation( nullptr )
+, m_NumberOfChains( 1 )
+, m_ExchangeInterval( 1 )
+, m_TemperatureRatio( 1.5 )
+, m_RandomSeed( 0 )
+, m_UseRandomSeed( false )
 {
 }
 
@@ -59,6 +69,12 @@ void mitk::ConnectomicsSimulatedAnnealingManager::SetPermutation( mitk::Connecto
   m_Permutation = permutation;
 }
 
+void mitk::ConnectomicsSimulatedAnnealingManager::SetRandomSeed( unsigned int seed )
+{
+  m_RandomSeed = seed;
+  m_UseRandomSeed = true;
+}
+
 void mitk::ConnectomicsSimulatedAnnealingManager::RunSimulatedAnnealing(
   double temperature,
   double stepSize
@@ -76,6 +92,17 @@ void mitk::ConnectomicsSimulatedAnnealingManager::RunSimulatedAnnealing(
     return;
   }
 
+  if( m_NumberOfChains > 1 )
+  {
+    RunMultipleChains( temperature, stepSize );
+    return;
+  }
+
+  if( m_UseRandomSeed )
+  {
+    m_Permutation->SetRandomSeed( m_RandomSeed );
+  }
+
   // Initialize the associated permutation
   m_Permutation->Initialize();
 
@@ -93,3 +120,94 @@ void mitk::ConnectomicsSimulatedAnnealingManager::RunSimulatedAnnealing(
   m_Permutation->CleanUp();
 
 }
+
+void mitk::ConnectomicsSimulatedAnnealingManager::RunMultipleChains(
+  double temperature,
+  double stepSize
+  )
+{
+  // chain 0 is the assigned permutation and runs at the given temperatures
+  std::vector< mitk::ConnectomicsSimulatedAnnealingPermutationBase::Pointer > chains;
+  chains.push_back( m_Permutation );
+  for( int chain( 1 ); chain < m_NumberOfChains; chain++ )
+  {
+    mitk::ConnectomicsSimulatedAnnealingPermutationBase::Pointer replica = m_Permutation->CreateReplica();
+    if( replica.IsNull() )
+    {
+      MBI_WARN << "Permutation does not support multiple chains, running a single chain.";
+      chains.resize( 1 );
+      break;
+    }
+    chains.push_back( replica );
+  }
+  const int numberOfChains = chains.size();
+
+  vnl_random rng( m_UseRandomSeed ? m_RandomSeed : (unsigned int) rand() );
+
+  std::vector< double > temperatureFactors( numberOfChains, 1.0 );
+  for( int chain( 0 ); chain < numberOfChains; chain++ )
+  {
+    chains[ chain ]->SetRandomSeed( rng.lrand32() );
+    chains[ chain ]->Initialize();
+    if( chain > 0 )
+    {
+      temperatureFactors[ chain ] = temperatureFactors[ chain - 1 ] * m_TemperatureRatio;
+    }
+  }
+
+  int step( 0 );
+  for( double currentTemperature( temperature );
+    currentTemperature > 0.00001;
+    currentTemperature = currentTemperature / stepSize, step++ )
+  {
+    // Run Permutations at the current temperature, each chain at its own
+#pragma omp parallel for schedule(dynamic)
+    for( int chain = 0; chain < numberOfChains; chain++ )
+    {
+      chains[ chain ]->Permutate( currentTemperature * temperatureFactors[ chain ] );
+    }
+
+    if( ( step + 1 ) % std::max( m_ExchangeInterval, 1 ) != 0 )
+    {
+      continue;
+    }
+
+    // Exchange the states of neighbouring chains, alternating between even and odd pairs
+    std::vector< double > costs( numberOfChains, 0.0 );
+    for( int chain( 0 ); chain < numberOfChains; chain++ )
+    {
+      costs[ chain ] = chains[ chain ]->GetCost();
+    }
+    for( int chain( ( step / std::max( m_ExchangeInterval, 1 ) ) % 2 ); chain + 1 < numberOfChains; chain += 2 )
+    {
+      const double colder = currentTemperature * temperatureFactors[ chain ];
+      const double warmer = currentTemperature * temperatureFactors[ chain + 1 ];
+      const double exponent = ( costs[ chain ] - costs[ chain + 1 ] ) * ( 1.0 / colder - 1.0 / warmer );
+      if( exponent >= 0 || rng.drand64( 0.0, 1.0 ) < std::exp( exponent ) )
+      {
+        chains[ chain ]->SwapState( chains[ chain + 1 ] );
+        std::swap( costs[ chain ], costs[ chain + 1 ] );
+      }
+    }
+  }
+
+  // pass the best state to the assigned permutation
+  int bestChain( 0 );
+  double bestCost( chains[ 0 ]->GetCost() );
+  for( int chain( 1 ); chain < numberOfChains; chain++ )
+  {
+    double cost = chains[ chain ]->GetCost();
+    if( cost < bestCost )
+    {
+      bestCost = cost;
+      bestChain = chain;
+    }
+  }
+  if( bestChain != 0 )
+  {
+    m_Permutation->SwapState( chains[ bestChain ] );
+  }
+
+  // Clean up result
+  m_Permutation->CleanUp();
+}
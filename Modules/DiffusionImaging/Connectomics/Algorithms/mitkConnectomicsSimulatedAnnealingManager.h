@@ -30,7 +30,12 @@ See LICENSE.txt or http://www.mitk.org for details.
 namespace mitk
 {
   /**
-  * \brief A class allow generic simulated annealing by using classes derived from ConnectomicsSimulatedAnnealingPermutationBase */
+  * \brief A class allow generic simulated annealing by using classes derived from ConnectomicsSimulatedAnnealingPermutationBase
+  *
+  * With more than one chain, replicas of the permutation are annealed in parallel at temperatures
+  * increasing by a constant ratio from chain to chain. Every exchange interval temperature steps, neighbouring
+  * chains swap their states with the replica exchange (parallel tempering) acceptance probability. The state
+  * with the lowest cost is passed to the assigned permutation at the end. */
   class MITKCONNECTOMICS_EXPORT ConnectomicsSimulatedAnnealingManager : public itk::Object
   {
   public:
@@ -51,16 +56,40 @@ namespace mitk
     // Set the permutation to be used
     void SetPermutation( mitk::ConnectomicsSimulatedAnnealingPermutationBase::Pointer permutation );
 
+    // Number of chains annealed in parallel (default 1)
+    itkSetMacro( NumberOfChains, int )
+    itkGetConstMacro( NumberOfChains, int )
+
+    // Number of temperature steps between two replica exchanges (default 1)
+    itkSetMacro( ExchangeInterval, int )
+    itkGetConstMacro( ExchangeInterval, int )
+
+    // Ratio of the temperatures of two neighbouring chains (default 1.5)
+    itkSetMacro( TemperatureRatio, double )
+    itkGetConstMacro( TemperatureRatio, double )
+
+    // Seed of the chains and the replica exchange, if not set rand() is used
+    void SetRandomSeed( unsigned int seed );
+
   protected:
 
     //////////////////// Functions ///////////////////////
     ConnectomicsSimulatedAnnealingManager();
     ~ConnectomicsSimulatedAnnealingManager();
 
+    // Run replicas of the permutation in parallel with replica exchange
+    void RunMultipleChains( double temperature, double stepSize );
+
     /////////////////////// Variables ////////////////////////
     // The permutation assigned to the simulated annealing manager
     mitk::ConnectomicsSimulatedAnnealingPermutationBase::Pointer m_Permutation;
 
+    int m_NumberOfChains;
+    int m_ExchangeInterval;
+    double m_TemperatureRatio;
+    unsigned int m_RandomSeed;
+    bool m_UseRandomSeed;
+
   };
 
 }// end namespace mitk
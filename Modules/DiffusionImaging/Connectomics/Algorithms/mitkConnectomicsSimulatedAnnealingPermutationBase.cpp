@@ -16,8 +16,11 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 #include "mitkConnectomicsSimulatedAnnealingPermutationBase.h"
 
+#include <cstdlib>
+
 mitk::ConnectomicsSimulatedAnnealingPermutationBase::ConnectomicsSimulatedAnnealingPermutationBase()
 : m_CostFunction( nullptr )
+, m_UseRandomSeed( false )
 {
 }
 
@@ -42,3 +45,24 @@ bool mitk::ConnectomicsSimulatedAnnealingPermutationBase::HasCostFunction( )
 
   return hasCostFunction;
 }
+
+void mitk::ConnectomicsSimulatedAnnealingPermutationBase::SetRandomSeed( unsigned int seed )
+{
+  m_RandomGenerator.reseed( seed );
+  m_UseRandomSeed = true;
+}
+
+bool mitk::ConnectomicsSimulatedAnnealingPermutationBase::HasRandomSeed() const
+{
+  return m_UseRandomSeed;
+}
+
+unsigned int mitk::ConnectomicsSimulatedAnnealingPermutationBase::DrawRandomSeed() const
+{
+  if( m_UseRandomSeed )
+  {
+    return m_RandomGenerator.lrand32();
+  }
+
+  return (unsigned int) rand();
+}
@@ -27,6 +27,9 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 #include "mitkConnectomicsSimulatedAnnealingCostFunctionBase.h"
 
+//for random number generation
+#include "vnl/vnl_random.h"
+
 namespace mitk
 {
 
@@ -58,16 +61,40 @@ namespace mitk
     // Do clean up necessary after a permutation
     virtual void CleanUp(){};
 
+    // Create a permutation of the same problem for another annealing chain,
+    // returns nullptr if the permutation does not support multiple chains
+    virtual ConnectomicsSimulatedAnnealingPermutationBase::Pointer CreateReplica() const { return nullptr; };
+
+    // Cost of the current state
+    virtual double GetCost() const { return 0.0; };
+
+    // Exchange the current state with the one of a replica
+    virtual void SwapState( ConnectomicsSimulatedAnnealingPermutationBase* /*replica*/ ){};
+
+    // Draw the random numbers of this permutation from its own generator instead of rand(),
+    // which makes the permutation reproducible and allows to run several of them in parallel
+    void SetRandomSeed( unsigned int seed );
+
   protected:
 
     //////////////////// Functions ///////////////////////
     ConnectomicsSimulatedAnnealingPermutationBase();
     ~ConnectomicsSimulatedAnnealingPermutationBase();
 
+    // Seed for the random number generators of a single permutation step
+    unsigned int DrawRandomSeed() const;
+
+    // Whether a random seed was set
+    bool HasRandomSeed() const;
+
     /////////////////////// Variables ////////////////////////
     // The cost function assigned to the permutation
     mitk::ConnectomicsSimulatedAnnealingCostFunctionBase::Pointer m_CostFunction;
 
+    // The generator used after a random seed was set
+    mutable vnl_random m_RandomGenerator;
+    bool m_UseRandomSeed;
+
   };
 
 }// end namespace mitk
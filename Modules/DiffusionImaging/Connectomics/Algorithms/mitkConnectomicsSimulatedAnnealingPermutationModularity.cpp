@@ -66,13 +66,20 @@ void mitk::ConnectomicsSimulatedAnnealingPermutationModularity::Permutate( doubl
   double currentBestCost = Evaluate( &currentBestSolution );
 
   // do singleNodeMaxNumber node permutations and evaluate
-  for(int loop( 0 ); loop < singleNodeMaxNumber; loop++)
+  if( dynamic_cast<mitk::ConnectomicsSimulatedAnnealingCostFunctionModularity*>( m_CostFunction.GetPointer() ) )
   {
-    permutateMappingSingleNodeShift( &currentSolution, m_Network );
-    if( AcceptChange( currentBestCost, Evaluate( &currentSolution ), temperature ) )
+    permutateSingleNodesIncremental( &currentSolution, &currentBestSolution, &currentBestCost, temperature, singleNodeMaxNumber );
+  }
+  else
+  {
+    for(int loop( 0 ); loop < singleNodeMaxNumber; loop++)
     {
-      currentBestSolution = currentSolution;
-      currentBestCost = Evaluate( &currentBestSolution );
+      permutateMappingSingleNodeShift( &currentSolution, m_Network );
+      if( AcceptChange( currentBestCost, Evaluate( &currentSolution ), temperature ) )
+      {
+        currentBestSolution = currentSolution;
+        currentBestCost = Evaluate( &currentBestSolution );
+      }
     }
   }
 
@@ -111,7 +118,7 @@ void mitk::ConnectomicsSimulatedAnnealingPermutationModularity::permutateMapping
   const int moduleCount = getNumberOfModules( vertexToModuleMap );
 
   // the random number generators
-  vnl_random rng( (unsigned int) rand() );
+  vnl_random rng( DrawRandomSeed() );
   unsigned long randomNode = rng.lrand32( nodeCount - 1 );
   // move the node either to any existing module, or to its own
   //unsigned long randomModule = rng.lrand32( moduleCount );
@@ -145,11 +152,133 @@ void mitk::ConnectomicsSimulatedAnnealingPermutationModularity::permutateMapping
   }
 }
 
+void mitk::ConnectomicsSimulatedAnnealingPermutationModularity::permutateSingleNodesIncremental(
+  ToModuleMapType *currentSolution,
+  ToModuleMapType *currentBestSolution,
+  double *currentBestCost,
+  double temperature,
+  int numberOfPermutations )
+{
+  mitk::ConnectomicsSimulatedAnnealingCostFunctionModularity* costMapping =
+    dynamic_cast<mitk::ConnectomicsSimulatedAnnealingCostFunctionModularity*>( m_CostFunction.GetPointer() );
+
+  mitk::ConnectomicsSimulatedAnnealingCostFunctionModularity::ModuleStatistics statistics;
+  if( !costMapping->CalculateModuleStatistics( m_Network, currentSolution, &statistics ) )
+  {
+    return;
+  }
+
+  // the nodes are addressed by their position in the vector of all vertex descriptors,
+  // as in permutateMappingSingleNodeShift
+  const std::vector< VertexDescriptorType > allNodesVector = m_Network->GetVectorOfAllVertexDescriptors();
+  const int nodeCount = allNodesVector.size();
+
+  std::map< VertexDescriptorType, int > nodePositions;
+  for( int node( 0 ); node < nodeCount; node++ )
+  {
+    nodePositions.insert( std::pair< VertexDescriptorType, int >( allNodesVector[ node ], node ) );
+  }
+
+  std::vector< std::vector< int > > adjacentNodes( nodeCount );
+  std::vector< int > currentModules( nodeCount, 0 );
+  std::vector< int > verticesInModule( statistics.numberOfLinksInModule.size(), 0 );
+  for( int node( 0 ); node < nodeCount; node++ )
+  {
+    const std::vector< VertexDescriptorType > adjacentNodexVector = m_Network->GetVectorOfAdjacentNodes( allNodesVector[ node ] );
+    for( unsigned int adjacentNodeNumber( 0 ); adjacentNodeNumber < adjacentNodexVector.size() ; adjacentNodeNumber++)
+    {
+      adjacentNodes[ node ].push_back( nodePositions.find( adjacentNodexVector[ adjacentNodeNumber ] )->second );
+    }
+    currentModules[ node ] = currentSolution->find( allNodesVector[ node ] )->second;
+    verticesInModule[ currentModules[ node ] ]++;
+  }
+
+  std::vector< int > bestModules = currentModules;
+  double currentCost = costMapping->Evaluate( statistics );
+
+  for(int loop( 0 ); loop < numberOfPermutations; loop++)
+  {
+    // same random numbers as permutateMappingSingleNodeShift
+    const int moduleCount = verticesInModule.size();
+    vnl_random rng( DrawRandomSeed() );
+    unsigned long randomNode = rng.lrand32( nodeCount - 1 );
+    unsigned long randomModule = rng.lrand32( moduleCount - 1 );
+
+    // with less than two nodes there is nothing to move, as in permutateMappingSingleNodeShift
+    const int previousModuleNumber = ( nodeCount < 2 ) ? (int)randomModule : currentModules[ randomNode ];
+    if( previousModuleNumber != (long)randomModule )
+    {
+      // a link to another node is counted once from each end, a self loop only once
+      const std::vector< int >& adjacentNodeVector = adjacentNodes[ randomNode ];
+      for( unsigned int adjacentNodeNumber( 0 ); adjacentNodeNumber < adjacentNodeVector.size() ; adjacentNodeNumber++)
+      {
+        const int adjacentNode = adjacentNodeVector[ adjacentNodeNumber ];
+        const int count = ( adjacentNode == (int)randomNode ) ? 1 : 2;
+        if( adjacentNode == (int)randomNode || currentModules[ adjacentNode ] == previousModuleNumber )
+        {
+          statistics.numberOfLinksInModule[ previousModuleNumber ] -= count;
+        }
+        if( adjacentNode == (int)randomNode || currentModules[ adjacentNode ] == (int)randomModule )
+        {
+          statistics.numberOfLinksInModule[ randomModule ] += count;
+        }
+      }
+      statistics.sumOfDegreesInModule[ previousModuleNumber ] -= adjacentNodeVector.size();
+      statistics.sumOfDegreesInModule[ randomModule ] += adjacentNodeVector.size();
+      verticesInModule[ previousModuleNumber ]--;
+      verticesInModule[ randomModule ]++;
+      currentModules[ randomNode ] = randomModule;
+
+      if( verticesInModule[ previousModuleNumber ] < 1 )
+      {
+        // as removeModule, the last module takes the number of the empty one
+        const int lastModuleNumber = moduleCount - 1;
+        if( previousModuleNumber != lastModuleNumber )
+        {
+          for( int node( 0 ); node < nodeCount; node++ )
+          {
+            if( currentModules[ node ] == lastModuleNumber )
+            {
+              currentModules[ node ] = previousModuleNumber;
+            }
+          }
+          statistics.numberOfLinksInModule[ previousModuleNumber ] = statistics.numberOfLinksInModule[ lastModuleNumber ];
+          statistics.sumOfDegreesInModule[ previousModuleNumber ] = statistics.sumOfDegreesInModule[ lastModuleNumber ];
+          verticesInModule[ previousModuleNumber ] = verticesInModule[ lastModuleNumber ];
+          verticesInModule[ lastModuleNumber ] = 0;
+        }
+
+        // the number of modules is given by the highest module containing nodes
+        while( verticesInModule.size() > 1 && verticesInModule.back() < 1 )
+        {
+          statistics.numberOfLinksInModule.pop_back();
+          statistics.sumOfDegreesInModule.pop_back();
+          verticesInModule.pop_back();
+        }
+      }
+
+      currentCost = costMapping->Evaluate( statistics );
+    }
+
+    if( AcceptChange( *currentBestCost, currentCost, temperature ) )
+    {
+      bestModules = currentModules;
+      *currentBestCost = currentCost;
+    }
+  }
+
+  for( int node( 0 ); node < nodeCount; node++ )
+  {
+    currentSolution->find( allNodesVector[ node ] )->second = currentModules[ node ];
+    currentBestSolution->find( allNodesVector[ node ] )->second = bestModules[ node ];
+  }
+}
+
 void mitk::ConnectomicsSimulatedAnnealingPermutationModularity::permutateMappingModuleChange(
   ToModuleMapType *vertexToModuleMap, double currentTemperature, mitk::ConnectomicsNetwork::Pointer network )
 {
   //the random number generators
-  vnl_random rng( (unsigned int) rand() );
+  vnl_random rng( DrawRandomSeed() );
 
   //randomly generate threshold
   const double threshold = rng.drand64( 0.0 , 1.0);
@@ -249,6 +378,10 @@ void mitk::ConnectomicsSimulatedAnnealingPermutationModularity::splitModule(
     permutation->SetNetwork( subNetwork );
     permutation->SetDepth( m_Depth - 1 );
     permutation->SetStepSize( m_StepSize * 2 );
+    if( HasRandomSeed() )
+    {
+      permutation->SetRandomSeed( DrawRandomSeed() );
+    }
 
     manager->SetPermutation( permutation.GetPointer() );
 
@@ -434,7 +567,7 @@ void mitk::ConnectomicsSimulatedAnnealingPermutationModularity::randomlyAssignNo
   }
 
   //the random number generators
-  vnl_random rng( (unsigned int) rand() );
+  vnl_random rng( DrawRandomSeed() );
 
   std::vector< int > histogram;
   std::vector< int > nodeList;
@@ -512,7 +645,7 @@ bool mitk::ConnectomicsSimulatedAnnealingPermutationModularity::AcceptChange( do
   }
 
   //the random number generators
-  vnl_random rng( (unsigned int) rand() );
+  vnl_random rng( DrawRandomSeed() );
 
   //randomly generate threshold
   const double threshold = rng.drand64( 0.0 , 1.0);
@@ -529,6 +662,34 @@ bool mitk::ConnectomicsSimulatedAnnealingPermutationModularity::AcceptChange( do
 }
 
 
+mitk::ConnectomicsSimulatedAnnealingPermutationBase::Pointer
+mitk::ConnectomicsSimulatedAnnealingPermutationModularity::CreateReplica() const
+{
+  mitk::ConnectomicsSimulatedAnnealingPermutationModularity::Pointer replica = mitk::ConnectomicsSimulatedAnnealingPermutationModularity::New();
+  replica->SetCostFunction( m_CostFunction );
+  replica->SetNetwork( m_Network );
+  replica->SetDepth( m_Depth );
+  replica->SetStepSize( m_StepSize );
+
+  return replica.GetPointer();
+}
+
+double mitk::ConnectomicsSimulatedAnnealingPermutationModularity::GetCost() const
+{
+  ToModuleMapType mapping = m_BestSolution;
+  return Evaluate( &mapping );
+}
+
+void mitk::ConnectomicsSimulatedAnnealingPermutationModularity::SwapState( ConnectomicsSimulatedAnnealingPermutationBase* replica )
+{
+  mitk::ConnectomicsSimulatedAnnealingPermutationModularity* modularityReplica =
+    dynamic_cast<mitk::ConnectomicsSimulatedAnnealingPermutationModularity*>( replica );
+  if( modularityReplica )
+  {
+    m_BestSolution.swap( modularityReplica->m_BestSolution );
+  }
+}
+
 void mitk::ConnectomicsSimulatedAnnealingPermutationModularity::SetDepth( int depth )
 {
   m_Depth = depth;
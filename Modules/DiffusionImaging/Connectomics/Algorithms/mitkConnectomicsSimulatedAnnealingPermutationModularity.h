@@ -49,6 +49,15 @@ namespace mitk
     // Do clean up necessary after a permutation
     virtual void CleanUp() override;
 
+    // Create a permutation of the same network for another annealing chain
+    virtual ConnectomicsSimulatedAnnealingPermutationBase::Pointer CreateReplica() const override;
+
+    // Cost of the current best solution
+    virtual double GetCost() const override;
+
+    // Exchange the current best solution with the one of a replica
+    virtual void SwapState( ConnectomicsSimulatedAnnealingPermutationBase* replica ) override;
+
     // set the network permutation is to be run upon
     void SetNetwork( mitk::ConnectomicsNetwork::Pointer theNetwork );
 
@@ -81,6 +90,15 @@ namespace mitk
       ToModuleMapType *vertexToModuleMap,
       mitk::ConnectomicsNetwork::Pointer network );
 
+    // Does the single node shifts of a permutation step, updating the modularity
+    // locally for every moved node instead of evaluating the whole mapping
+    void permutateSingleNodesIncremental(
+      ToModuleMapType *currentSolution,
+      ToModuleMapType *currentBestSolution,
+      double *currentBestCost,
+      double temperature,
+      int numberOfPermutations );
+
         // This function splits and joins modules
     void permutateMappingModuleChange(
       ToModuleMapType *vertexToModuleMap,
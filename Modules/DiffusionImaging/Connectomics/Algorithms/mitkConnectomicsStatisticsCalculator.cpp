@@ -16,6 +16,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 #include "mitkConnectomicsStatisticsCalculator.h"
 #include "mitkConnectomicsNetworkConverter.h"
+#include "mitkConnectomicsGraphAlgorithms.h"
 
 #include <numeric>
 
@@ -26,6 +27,10 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 #include "vnl/algo/vnl_symmetric_eigensystem.h"
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 template<typename GraphType>
 class all_pairs_shortest_recorder : public boost::default_bfs_visitor
 {
@@ -199,31 +204,45 @@ void mitk::ConnectomicsStatisticsCalculator::CalculateRatioOfNodesInLargestCompo
 void mitk::ConnectomicsStatisticsCalculator::CalculateHopPlotValues()
 {
   std::vector<int> bins( m_NumberOfVertices );
-
-  VertexIteratorType vi, vi_end;
   unsigned int index( 0 );
 
-  for( boost::tie( vi, vi_end ) = boost::vertices( *(m_Network->GetBoostGraph()) ); vi != vi_end; ++vi)
+  // the BFS of the different sources are independent, each thread counts into its own bins
+  const NetworkType& graph = *(m_Network->GetBoostGraph());
+  int numberOfThreads = mitk::ConnectomicsGraphAlgorithms::GetNumberOfThreads( 0 );
+  std::vector< std::vector<int> > threadBins( numberOfThreads, std::vector<int>( m_NumberOfVertices, 0 ) );
+
+#pragma omp parallel for schedule(dynamic) num_threads( numberOfThreads )
+  for( int src = 0; src < (int)m_NumberOfVertices; src++ )
   {
+    int thread( 0 );
+#ifdef _OPENMP
+    thread = omp_get_thread_num();
+#endif
     std::vector<int> distances(m_NumberOfVertices, 0);
     int max_distance = 0;
-    VertexDescriptorType src = *vi;
-    distances[src] = 0;
     unsigned int size = 0;
 
-    boost::breadth_first_search(*(m_Network->GetBoostGraph()), src,
+    boost::breadth_first_search(graph, boost::vertex( src, graph ),
       visitor(all_pairs_shortest_recorder< NetworkType >
       (&distances[0], max_distance, size)));
 
-    for(index=0; index < distances.size(); index++)
+    for(unsigned int i=0; i < distances.size(); i++)
     {
-      if(distances[index] > 0)
+      if(distances[i] > 0)
       {
-        bins[distances[index]]++;
+        threadBins[thread][distances[i]]++;
       }
     }
   }
 
+  for( int thread = 0; thread < numberOfThreads; thread++ )
+  {
+    for(index=0; index < bins.size(); index++)
+    {
+      bins[index] += threadBins[thread][index];
+    }
+  }
+
   bins[0] = m_NumberOfVertices;
   for(index=1; index < bins.size(); index++)
   {
@@ -368,8 +387,9 @@ void mitk::ConnectomicsStatisticsCalculator::CalculateBetweennessCentrality()
   // Create the external property map
   m_PropertyMapOfVertexBetweennessCentralities = VertexIteratorPropertyMapType(m_VectorOfVertexBetweennessCentralities.begin(), vertexIndex);
 
-  boost::brandes_betweenness_centrality( *(m_Network->GetBoostGraph()),
-    m_PropertyMapOfVertexBetweennessCentralities, m_PropertyMapOfEdgeBetweennessCentralities );
+  // multi-threaded Brandes algorithm, same values as boost::brandes_betweenness_centrality
+  mitk::ConnectomicsGraphAlgorithms::CalculateBetweennessCentrality( *(m_Network->GetBoostGraph()),
+    m_VectorOfVertexBetweennessCentralities, &m_VectorOfEdgeBetweennessCentralities );
 
   m_AverageVertexBetweennessCentrality = std::accumulate(m_VectorOfVertexBetweennessCentralities.begin(),
     m_VectorOfVertexBetweennessCentralities.end(),
@@ -436,8 +456,15 @@ void mitk::ConnectomicsStatisticsCalculator::CalculateShortestPathMetrics()
   unsigned int giant_component_size = 0;
   VertexDescriptorType radius_src(0);
 
-  //Loop over the vertices
-  for( boost::tie(vi, vi_end) = boost::vertices( *(m_Network->GetBoostGraph()) ); vi!=vi_end; ++vi)
+  //Loop over the vertices. The BFS of the different sources are
+  //independent and run in parallel, the per source results are
+  //combined afterwards in vertex order.
+  const NetworkType& graph = *(m_Network->GetBoostGraph());
+  std::vector<unsigned int> componentSizes( m_NumberOfVertices, 0 );
+  int numberOfThreads = mitk::ConnectomicsGraphAlgorithms::GetNumberOfThreads( 0 );
+
+#pragma omp parallel for schedule(dynamic) num_threads( numberOfThreads )
+  for( int source = 0; source < (int)m_NumberOfVertices; source++ )
   {
     //We are going to start a BFS, initialize the neccessary
     //structures for that.  Store the distances of nodes from the
@@ -448,36 +475,16 @@ void mitk::ConnectomicsStatisticsCalculator::CalculateShortestPathMetrics()
     //this BFS.
     std::vector<int> distances( m_NumberOfVertices );
     int max_distance = 0;
-    VertexDescriptorType src = *vi;
+    VertexDescriptorType src = boost::vertex( source, graph );
     distances[src] = 0;
     unsigned int size = 0;
 
-    breadth_first_search(*(m_Network->GetBoostGraph()), src,
+    breadth_first_search(graph, src,
       visitor(all_pairs_shortest_recorder<NetworkType>
       (&distances[0], max_distance, size)));
     // vertex vi has eccentricity equal to max_distance
     m_VectorOfEccentrities[src] = max_distance;
-
-    //check whether there is any change in the diameter or the radius.
-    //note that the diameter we are calculating here is also the
-    //diameter of the giant connected component!
-    if(m_VectorOfEccentrities[src] > m_Diameter)
-    {
-      m_Diameter = m_VectorOfEccentrities[src];
-    }
-
-    //The radius should be calculated on the largest connected
-    //component, otherwise it is very likely that radius will be 1.
-    //We change the value of the radius only if this is the giant
-    //connected component so far. After all the eccentricities are
-    //found we should loop over this connected component and find the
-    //minimum eccentricity which is the radius. So we keep the src
-    //node, so that we can find the connected component later on.
-    if(size > giant_component_size)
-    {
-      giant_component_size = size;
-      radius_src = src;
-    }
+    componentSizes[src] = size;
 
     //Calculate in how many hops we can reach 90 percent of the
     //nodes. We store the number of hops we can reach in h hops in the
@@ -511,10 +518,34 @@ void mitk::ConnectomicsStatisticsCalculator::CalculateShortestPathMetrics()
     }
     // vertex vi has eccentricity90 equal to eccentricity90
     m_VectorOfEccentrities90[src] = eccentricity90;
+  }
+
+  for( unsigned int src = 0; src < m_NumberOfVertices; src++ )
+  {
+    //check whether there is any change in the diameter or the radius.
+    //note that the diameter we are calculating here is also the
+    //diameter of the giant connected component!
+    if(m_VectorOfEccentrities[src] > m_Diameter)
+    {
+      m_Diameter = m_VectorOfEccentrities[src];
+    }
     if(m_VectorOfEccentrities90[src] > m_Diameter90)
     {
       m_Diameter90 = m_VectorOfEccentrities90[src];
     }
+
+    //The radius should be calculated on the largest connected
+    //component, otherwise it is very likely that radius will be 1.
+    //We change the value of the radius only if this is the giant
+    //connected component so far. After all the eccentricities are
+    //found we should loop over this connected component and find the
+    //minimum eccentricity which is the radius. So we keep the src
+    //node, so that we can find the connected component later on.
+    if(componentSizes[src] > giant_component_size)
+    {
+      giant_component_size = componentSizes[src];
+      radius_src = src;
+    }
   }
 
   //We are going to calculate the radius now. We stored the src node
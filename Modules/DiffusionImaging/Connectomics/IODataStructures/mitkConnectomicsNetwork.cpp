@@ -17,8 +17,9 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 #include "mitkConnectomicsNetwork.h"
 #include <mitkConnectomicsStatisticsCalculator.h>
+#include <mitkConnectomicsGraphAlgorithms.h>
 #include <boost/graph/clustering_coefficient.hpp>
-#include <boost/graph/betweenness_centrality.hpp>
+#include <boost/graph/dijkstra_shortest_paths.hpp>
 
 /* Constructor and Destructor */
 mitk::ConnectomicsNetwork::ConnectomicsNetwork()
@@ -619,56 +620,28 @@ void mitk::ConnectomicsNetwork::UpdateIDs()
 
 std::vector< double > mitk::ConnectomicsNetwork::GetNodeBetweennessVector() const
 {
-  std::vector< double > betweennessVector;
+  std::vector< double > centrality;
+  mitk::ConnectomicsGraphAlgorithms::CalculateBetweennessCentrality( m_Network, centrality );
 
-  betweennessVector.clear();
+  // indexed by node id
+  std::vector< double > betweennessVector;
   betweennessVector.resize( this->GetNumberOfVertices() );
 
-  boost::brandes_betweenness_centrality(
-    m_Network,
-    boost::centrality_map(
-    boost::make_iterator_property_map( betweennessVector.begin(), boost::get( &NetworkNode::id, m_Network ), double() )
-    ).vertex_index_map( boost::get( &NetworkNode::id, m_Network ) )
-    );
+  boost::graph_traits<NetworkType>::vertex_iterator iterator, end;
+  boost::tie(iterator, end) = boost::vertices( m_Network );
+  for ( ; iterator != end; ++iterator)
+  {
+    betweennessVector[ m_Network[ *iterator ].id ] = centrality[ *iterator ];
+  }
 
   return betweennessVector;
 }
 
 std::vector< double > mitk::ConnectomicsNetwork::GetEdgeBetweennessVector() const
 {
-  // std::map used for convenient initialization
-  typedef std::map<EdgeDescriptorType, int> EdgeIndexStdMap;
-  EdgeIndexStdMap stdEdgeIndex;
-  // associative property map needed for iterator property map-wrapper
-  typedef boost::associative_property_map< EdgeIndexStdMap > EdgeIndexMap;
-  EdgeIndexMap edgeIndex(stdEdgeIndex);
-
-  boost::graph_traits<NetworkType>::edge_iterator iterator, end;
-
-  // sets iterator to start end end to end
-  boost::tie(iterator, end) = boost::edges( m_Network );
-
-  int i(0);
-  for ( ; iterator != end; ++iterator, ++i)
-  {
-    stdEdgeIndex.insert(std::pair< EdgeDescriptorType, int >( *iterator, i));
-  }
-
-  // Define EdgeCentralityMap
-  std::vector< double > edgeBetweennessVector(boost::num_edges( m_Network ), 0.0);
-  // Create the external property map
-  boost::iterator_property_map< std::vector< double >::iterator, EdgeIndexMap >
-    e_centrality_map(edgeBetweennessVector.begin(), edgeIndex);
-
-  // Define VertexCentralityMap
-  typedef boost::property_map< NetworkType, boost::vertex_index_t>::type VertexIndexMap;
-  VertexIndexMap vertexIndex = get(boost::vertex_index, m_Network );
-  std::vector< double > betweennessVector(boost::num_vertices( m_Network ), 0.0);
-  // Create the external property map
-  boost::iterator_property_map< std::vector< double >::iterator, VertexIndexMap >
-    v_centrality_map(betweennessVector.begin(), vertexIndex);
-
-  boost::brandes_betweenness_centrality( m_Network, v_centrality_map, e_centrality_map );
+  std::vector< double > betweennessVector;
+  std::vector< double > edgeBetweennessVector;
+  mitk::ConnectomicsGraphAlgorithms::CalculateBetweennessCentrality( m_Network, betweennessVector, &edgeBetweennessVector );
 
   return edgeBetweennessVector;
 }
@@ -36,6 +36,7 @@ class mitkConnectomicsNetworkCreationTestSuite : public mitk::TestFixture
   vtkDebugLeaks::SetExitError(0);
 
   MITK_TEST(CreateNetworkFromFibersAndParcellation);
+  MITK_TEST(CreateNetworkMultiThreaded_EqualsSingleThreaded);
   CPPUNIT_TEST_SUITE_END();
 
 private:
@@ -108,6 +109,34 @@ public:
     CPPUNIT_ASSERT_MESSAGE( "Comparing created and reference network.", mitk::Equal( network.GetPointer(), referenceNetwork, mitk::eps, true) );
 
   }
+
+  void CreateNetworkMultiThreaded_EqualsSingleThreaded()
+  {
+    std::vector<mitk::BaseData::Pointer> fiberInfile = mitk::IOUtil::Load( m_FiberPath );
+    CPPUNIT_ASSERT_MESSAGE( "Fiber Image at " + m_FiberPath + " could not be read.", !fiberInfile.empty() );
+    mitk::FiberBundle* fiberBundle = dynamic_cast<mitk::FiberBundle*>( fiberInfile.at(0).GetPointer() );
+
+    std::vector<mitk::BaseData::Pointer> parcellationInFile = mitk::IOUtil::Load( m_ParcellationPath );
+    CPPUNIT_ASSERT_MESSAGE( "Parcellation at " + m_ParcellationPath + " could not be read.", !parcellationInFile.empty() );
+    mitk::Image* parcellationImage = dynamic_cast<mitk::Image*>( parcellationInFile.at(0).GetPointer() );
+
+    // the network must not depend on the order in which the fibers are mapped
+    mitk::ConnectomicsNetwork::Pointer networks[ 2 ];
+    int threads[ 2 ] = { 1, 4 };
+    for( int i = 0; i < 2; i++ )
+    {
+      mitk::ConnectomicsNetworkCreator::Pointer connectomicsNetworkCreator = mitk::ConnectomicsNetworkCreator::New();
+      connectomicsNetworkCreator->SetSegmentation( parcellationImage );
+      connectomicsNetworkCreator->SetFiberBundle( fiberBundle );
+      connectomicsNetworkCreator->CalculateCenterOfMass();
+      connectomicsNetworkCreator->SetEndPointSearchRadius( 15 );
+      connectomicsNetworkCreator->SetNumberOfThreads( threads[ i ] );
+      connectomicsNetworkCreator->CreateNetworkFromFibersAndSegmentation();
+      networks[ i ] = connectomicsNetworkCreator->GetNetwork();
+    }
+
+    CPPUNIT_ASSERT_MESSAGE( "Comparing single and multi threaded network.", mitk::Equal( networks[ 0 ].GetPointer(), networks[ 1 ].GetPointer(), mitk::eps, true) );
+  }
 };
 
 MITK_TEST_SUITE_REGISTRATION(mitkConnectomicsNetworkCreation)
@@ -520,6 +520,30 @@ int mitkConnectomicsNetworkTest(int argc, char* argv[])
 
     bool noInternalThreeModuleModularity( std::abs(-0.3395 - costFunction->CalculateModularity( network, &noInternalLinksThreeModuleSolution )) < eps);
     MITK_TEST_CONDITION_REQUIRED( noInternalThreeModuleModularity, "Expected three module modularity containing no internal links")
+
+    // Test multiple chains with replica exchange, the result has to be reproducible for a given seed
+    std::vector< ToModuleMapType > multiChainSolutions;
+    for( int run( 0 ); run < 2; run++ )
+    {
+      mitk::ConnectomicsSimulatedAnnealingManager::Pointer multiChainManager = mitk::ConnectomicsSimulatedAnnealingManager::New();
+      mitk::ConnectomicsSimulatedAnnealingPermutationModularity::Pointer multiChainPermutation = mitk::ConnectomicsSimulatedAnnealingPermutationModularity::New();
+
+      multiChainPermutation->SetCostFunction( costFunction.GetPointer() );
+      multiChainPermutation->SetNetwork( network );
+      multiChainPermutation->SetDepth( 1 );
+      multiChainPermutation->SetStepSize( 4.0 );
+
+      multiChainManager->SetPermutation( multiChainPermutation.GetPointer() );
+      multiChainManager->SetNumberOfChains( 4 );
+      multiChainManager->SetRandomSeed( 42 );
+      multiChainManager->RunSimulatedAnnealing( 2.0, 4.0 );
+
+      multiChainSolutions.push_back( multiChainPermutation->GetMapping() );
+    }
+
+    MITK_TEST_CONDITION_REQUIRED( multiChainSolutions[ 0 ].size() == vertexInVector.size(), "Expected every vertex to be mapped by multiple chains")
+    MITK_TEST_CONDITION_REQUIRED( multiChainSolutions[ 0 ] == multiChainSolutions[ 1 ], "Expected reproducible multiple chain result")
+    MITK_TEST_CONDITION_REQUIRED( costFunction->CalculateModularity( network, &multiChainSolutions[ 0 ] ) > 0.097222, "Expected multiple chains to find a better solution than the bad two module one")
   }
   catch (...)
   {
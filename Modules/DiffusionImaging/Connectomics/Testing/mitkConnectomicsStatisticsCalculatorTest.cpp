@@ -21,10 +21,15 @@ See LICENSE.txt or http://www.mitk.org for details.
 // std includes
 #include <string>
 #include <sstream>
+#include <map>
 
 // MITK includes
 #include <mitkIOUtil.h>
 #include <mitkConnectomicsStatisticsCalculator.h>
+#include <mitkConnectomicsGraphAlgorithms.h>
+
+// boost includes
+#include <boost/graph/betweenness_centrality.hpp>
 
 // VTK includes
 #include <vtkDebugLeaks.h>
@@ -38,6 +43,7 @@ class mitkConnectomicsStatisticsCalculatorTestSuite : public mitk::TestFixture
   vtkDebugLeaks::SetExitError(0);
 
   MITK_TEST(StatisticsCalculatorUpdate);
+  MITK_TEST(BetweennessCentrality_EqualsBoost);
   CPPUNIT_TEST_SUITE_END();
 
 private:
@@ -136,6 +142,66 @@ public:
     CPPUNIT_ASSERT_MESSAGE( "GetSmallWorldness", mitk::Equal( statisticsCalculator->GetSmallWorldness( ), 1.72908 , eps, true ) );
 
   }
+
+  void BetweennessCentrality_EqualsBoost()
+  {
+    // ring lattice with chords, several shortest paths between most vertex pairs
+    typedef mitk::ConnectomicsNetwork::VertexDescriptorType VertexDescriptorType;
+    typedef mitk::ConnectomicsNetwork::NetworkType NetworkType;
+    mitk::ConnectomicsNetwork::Pointer network = mitk::ConnectomicsNetwork::New();
+    const int numberOfVertices = 40;
+    std::vector< VertexDescriptorType > vertices;
+    for( int i = 0; i < numberOfVertices; i++ )
+    {
+      vertices.push_back( network->AddVertex( i ) );
+    }
+    for( int i = 0; i < numberOfVertices; i++ )
+    {
+      int j = ( i + 1 ) % numberOfVertices;
+      int k = ( i * 7 + 3 ) % numberOfVertices;
+      network->AddEdge( vertices[ i ], vertices[ j ], i, j );
+      if( k != i && k != j && !network->EdgeExists( vertices[ i ], vertices[ k ] ) )
+      {
+        network->AddEdge( vertices[ i ], vertices[ k ], i, k );
+      }
+    }
+    const NetworkType& graph = *( network->GetBoostGraph() );
+
+    // reference values of boost, edges indexed in the order of boost::edges()
+    typedef std::map< mitk::ConnectomicsNetwork::EdgeDescriptorType, int > EdgeIndexStdMap;
+    EdgeIndexStdMap stdEdgeIndex;
+    boost::associative_property_map< EdgeIndexStdMap > edgeIndex( stdEdgeIndex );
+    boost::graph_traits< NetworkType >::edge_iterator iterator, end;
+    int index( 0 );
+    for( boost::tie( iterator, end ) = boost::edges( graph ); iterator != end; ++iterator, ++index )
+    {
+      stdEdgeIndex.insert( std::make_pair( *iterator, index ) );
+    }
+
+    std::vector< double > referenceVertex( boost::num_vertices( graph ), 0.0 );
+    std::vector< double > referenceEdge( boost::num_edges( graph ), 0.0 );
+    boost::brandes_betweenness_centrality( graph,
+      boost::make_iterator_property_map( referenceVertex.begin(), boost::get( boost::vertex_index, graph ) ),
+      boost::make_iterator_property_map( referenceEdge.begin(), edgeIndex ) );
+
+    for( int threads = 1; threads <= 4; threads += 3 )
+    {
+      std::vector< double > vertexCentrality;
+      std::vector< double > edgeCentrality;
+      mitk::ConnectomicsGraphAlgorithms::CalculateBetweennessCentrality( graph, vertexCentrality, &edgeCentrality, threads );
+
+      CPPUNIT_ASSERT_MESSAGE( "Number of vertex centralities", vertexCentrality.size() == referenceVertex.size() );
+      CPPUNIT_ASSERT_MESSAGE( "Number of edge centralities", edgeCentrality.size() == referenceEdge.size() );
+      for( unsigned int i = 0; i < referenceVertex.size(); i++ )
+      {
+        CPPUNIT_ASSERT_MESSAGE( "Vertex centrality", mitk::Equal( vertexCentrality[ i ], referenceVertex[ i ], 0.0001, true ) );
+      }
+      for( unsigned int i = 0; i < referenceEdge.size(); i++ )
+      {
+        CPPUNIT_ASSERT_MESSAGE( "Edge centrality", mitk::Equal( edgeCentrality[ i ], referenceEdge[ i ], 0.0001, true ) );
+      }
+    }
+  }
 };
 
 MITK_TEST_SUITE_REGISTRATION(mitkConnectomicsStatisticsCalculator)
@@ -31,6 +31,7 @@ set(CPP_FILES
   Algorithms/mitkConnectomicsSimulatedAnnealingCostFunctionBase.cpp
   Algorithms/mitkConnectomicsSimulatedAnnealingCostFunctionModularity.cpp
   Algorithms/mitkConnectomicsStatisticsCalculator.cpp
+  Algorithms/mitkConnectomicsGraphAlgorithms.cpp
   Algorithms/mitkConnectomicsNetworkConverter.cpp
   Algorithms/mitkConnectomicsNetworkThresholder.cpp
   Algorithms/mitkFreeSurferParcellationTranslator.cpp
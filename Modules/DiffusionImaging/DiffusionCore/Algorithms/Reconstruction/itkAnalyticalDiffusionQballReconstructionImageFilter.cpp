@@ -27,6 +27,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <stdio.h>
 #include <locale>
 #include <fstream>
+#include <algorithm>
 
 #define _USE_MATH_DEFINES
 #include <math.h>
@@ -53,7 +54,8 @@ AnalyticalDiffusionQballReconstructionImageFilter<T,TG,TO,L,NODF>
     m_DirectionsDuplicated(false),
     m_Delta1(0.001),
     m_Delta2(0.001),
-    m_UseMrtrixBasis(false)
+    m_UseMrtrixBasis(false),
+    m_VoxelBlockSize(512)
 {
     // At least 1 inputs is necessary for a vector image.
     // For images added one at a time we need at least six
@@ -351,74 +353,107 @@ void AnalyticalDiffusionQballReconstructionImageFilter<T,TG,TO,L,NODF>
             gradientind.push_back(gradientind[i]);
     }
 
-    while( !git.IsAtEnd() )
+    if(m_NormalizationMethod == QBAR_NONNEG_SOLID_ANGLE)
     {
-        GradientVectorType b = git.Get();
+        /** this would be the place to implement a non-negative
+      * solver for quadratic programming problem:
+      * min .5*|| Bc-s ||^2 subject to -CLPc <= 4*pi*ones
+      * (refer to MICCAI 2009 Goh et al. "Estimating ODFs with PDF constraints")
+      * .5*|| Bc-s ||^2 == .5*c'B'Bc - x'B's + .5*s's
+      */
+
+        itkExceptionMacro( << "Nonnegative Solid Angle not yet implemented");
+    }
 
-        typename NumericTraits<ReferencePixelType>::AccumulateType b0 = NumericTraits<ReferencePixelType>::Zero;
+    // The signals of up to blockSize voxels are gathered column-wise into one
+    // matrix so that the reconstruction is a single matrix-matrix product per
+    // block instead of one matrix-vector product per voxel.
+    const unsigned int blockSize = std::max(1u, m_VoxelBlockSize);
+    vnl_matrix<TO> signals(m_NumberOfGradientDirections, blockSize);
+    std::vector< typename NumericTraits<ReferencePixelType>::AccumulateType > b0Values(blockSize);
+    std::vector< int > columns(blockSize);
+    vnl_vector<TO> B(m_NumberOfGradientDirections);
 
-        // Average the baseline image pixels
-        for(unsigned int i = 0; i < baselineind.size(); ++i)
+    while( !git.IsAtEnd() )
+    {
+        // gather block
+        unsigned int numVoxels = 0;
+        unsigned int numValid = 0;
+        while( !git.IsAtEnd() && numVoxels<blockSize )
         {
-            b0 += b[baselineind[i]];
-        }
-        b0 /= this->m_NumberOfBaselineImages;
+            GradientVectorType b = git.Get();
 
-        OdfPixelType odf(0.0);
-        typename CoefficientImageType::PixelType coeffPixel(0.0);
-        vnl_vector<TO> B(m_NumberOfGradientDirections);
+            typename NumericTraits<ReferencePixelType>::AccumulateType b0 = NumericTraits<ReferencePixelType>::Zero;
 
-        if( (b0 != 0) && (b0 >= m_Threshold) )
-        {
-            for( unsigned int i = 0; i< m_NumberOfGradientDirections; i++ )
+            // Average the baseline image pixels
+            for(unsigned int i = 0; i < baselineind.size(); ++i)
             {
-                B[i] = static_cast<TO>(b[gradientind[i]]);
+                b0 += b[baselineind[i]];
             }
+            b0 /= this->m_NumberOfBaselineImages;
 
-            B = PreNormalize(B, b0);
-            if(m_NormalizationMethod == QBAR_SOLID_ANGLE)
-            {
-                vnl_vector<TO> coeffs(m_NumberCoefficients);
-                coeffs = ( (*m_CoeffReconstructionMatrix) * B );
-                coeffs[0] += 1.0/(2.0*sqrt(QBALL_ANAL_RECON_PI));
-                odf = ( (*m_SphericalHarmonicBasisMatrix) * coeffs ).data_block();
-                coeffPixel = coeffs.data_block();
-            }
-            else if(m_NormalizationMethod == QBAR_NONNEG_SOLID_ANGLE)
+            b0Values[numVoxels] = b0;
+            columns[numVoxels] = -1;
+
+            if( (b0 != 0) && (b0 >= m_Threshold) )
             {
-                /** this would be the place to implement a non-negative
-              * solver for quadratic programming problem:
-              * min .5*|| Bc-s ||^2 subject to -CLPc <= 4*pi*ones
-              * (refer to MICCAI 2009 Goh et al. "Estimating ODFs with PDF constraints")
-              * .5*|| Bc-s ||^2 == .5*c'B'Bc - x'B's + .5*s's
-              */
-
-                itkExceptionMacro( << "Nonnegative Solid Angle not yet implemented");
+                for( unsigned int i = 0; i< m_NumberOfGradientDirections; i++ )
+                {
+                    B[i] = static_cast<TO>(b[gradientind[i]]);
+                }
+
+                signals.set_column(numValid, PreNormalize(B, b0));
+                columns[numVoxels] = numValid;
+                numValid++;
             }
+
+            ++numVoxels;
+            ++git;  // Gradient  image iterator
+        }
+
+        // reconstruct block
+        vnl_matrix<TO> coeffs;
+        vnl_matrix<TO> odfs;
+        if( numValid>0 )
+        {
+            vnl_matrix<TO> validSignals = signals.extract(m_NumberOfGradientDirections, numValid);
+            coeffs = (*m_CoeffReconstructionMatrix) * validSignals;
+            for (unsigned int j=0; j<numValid; j++)
+                coeffs(0,j) += 1.0/(2.0*sqrt(QBALL_ANAL_RECON_PI));
+
+            if(m_NormalizationMethod == QBAR_SOLID_ANGLE)
+                odfs = (*m_SphericalHarmonicBasisMatrix) * coeffs;
             else
+                odfs = (*m_ReconstructionMatrix) * validSignals;
+        }
+
+        // scatter block
+        for (unsigned int v=0; v<numVoxels; v++)
+        {
+            OdfPixelType odf(0.0);
+            typename CoefficientImageType::PixelType coeffPixel(0.0);
+
+            if( columns[v]>=0 )
             {
-                vnl_vector<TO> coeffs(m_NumberCoefficients);
-                coeffs = ( (*m_CoeffReconstructionMatrix) * B );
-                coeffs[0] += 1.0/(2.0*sqrt(QBALL_ANAL_RECON_PI));
-                coeffPixel = coeffs.data_block();
-                odf = ( (*m_ReconstructionMatrix) * B ).data_block();
+                for (int i=0; i<NODF; i++)
+                    odf[i] = odfs(i, columns[v]);
+                for (int i=0; i<m_NumberCoefficients; i++)
+                    coeffPixel[i] = coeffs(i, columns[v]);
+                odf = Normalize(odf, b0Values[v]);
             }
-            odf = Normalize(odf, b0);
 
+            oit.Set( odf );
+            oit2.Set( b0Values[v] );
+            float sum = 0;
+            for (unsigned int k=0; k<odf.Size(); k++)
+                sum += (float) odf[k];
+            oit3.Set( sum-1 );
+            oit4.Set(coeffPixel);
+            ++oit;  // odf image iterator
+            ++oit3; // odf sum image iterator
+            ++oit2; // b0 image iterator
+            ++oit4; // coefficient image iterator
         }
-
-        oit.Set( odf );
-        oit2.Set( b0 );
-        float sum = 0;
-        for (unsigned int k=0; k<odf.Size(); k++)
-            sum += (float) odf[k];
-        oit3.Set( sum-1 );
-        oit4.Set(coeffPixel);
-        ++oit;  // odf image iterator
-        ++oit3; // odf sum image iterator
-        ++oit2; // b0 image iterator
-        ++oit4; // coefficient image iterator
-        ++git;  // Gradient  image iterator
     }
 
     std::cout << "One Thread finished reconstruction" << std::endl;
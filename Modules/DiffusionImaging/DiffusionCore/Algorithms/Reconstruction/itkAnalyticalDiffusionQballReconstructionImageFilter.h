@@ -217,6 +217,11 @@ public:
 
     itkSetMacro( UseMrtrixBasis, bool )
 
+    /** Number of voxels whose signals are gathered into one matrix and
+   * reconstructed with a single matrix-matrix product (default 512). */
+    itkSetMacro( VoxelBlockSize, unsigned int )
+    itkGetMacro( VoxelBlockSize, unsigned int )
+
 #ifdef ITK_USE_CONCEPT_CHECKING
     /** Begin concept checking */
     itkConceptMacro(ReferenceEqualityComparableCheck,
@@ -274,6 +279,7 @@ private:
     TOdfPixelType                                     m_Delta1;
     TOdfPixelType                                     m_Delta2;
     bool                                              m_UseMrtrixBasis;
+    unsigned int                                      m_VoxelBlockSize;
 };
 
 }
@@ -26,6 +26,9 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 #include "itkRegularizedIVIMReconstructionFilter.h"
 
+#include <algorithm>
+#include <vector>
+
 #include <mitkLogMacros.h>
 
 #define IVIM_FOO -100000
@@ -39,8 +42,11 @@ DiffusionIntravoxelIncoherentMotionReconstructionImageFilter<TIn, TOut>
     m_GradientDirectionContainer(nullptr),
     m_Method(IVIM_DSTAR_FIX),
     m_FitDStar(true),
-    m_Verbose(false)
+    m_Verbose(false),
+    m_UseBatchedFit(false)
 {
+    m_CrossPosition.Fill(0);
+
     this->SetNumberOfRequiredInputs( 1 );
 
     this->SetNumberOfRequiredOutputs( 3 );
@@ -203,6 +209,11 @@ void DiffusionIntravoxelIncoherentMotionReconstructionImageFilter<TIn, TOut>
 ::ThreadedGenerateData(const OutputImageRegionType& outputRegionForThread,
                        ThreadIdType )
 {
+    if(m_UseBatchedFit && (m_Method == IVIM_FIT_ALL || m_Method == IVIM_DSTAR_FIX || m_Method == IVIM_D_THEN_DSTAR))
+    {
+        BatchedThreadedGenerateData(outputRegionForThread);
+        return;
+    }
 
     typename OutputImageType::Pointer outputImage =
             static_cast< OutputImageType * >(this->ProcessObject::GetPrimaryOutput());
@@ -675,6 +686,247 @@ void DiffusionIntravoxelIncoherentMotionReconstructionImageFilter<TIn, TOut>
     }
 }
 
+template< class TIn, class TOut>
+void DiffusionIntravoxelIncoherentMotionReconstructionImageFilter<TIn, TOut>
+::BatchedThreadedGenerateData(const OutputImageRegionType& outputRegionForThread)
+{
+    typename InputImageType::Pointer inputImagePointer = static_cast< InputImageType * >(this->ProcessObject::GetInput(0));
+    typename OutputImageType::Pointer outputImage = static_cast< OutputImageType * >(this->ProcessObject::GetPrimaryOutput());
+    typename OutputImageType::Pointer dImage = static_cast< OutputImageType * >(this->ProcessObject::GetOutput(1));
+    typename OutputImageType::Pointer dstarImage = static_cast< OutputImageType * >(this->ProcessObject::GetOutput(2));
+
+    const InputPixelType* inBuffer = inputImagePointer->GetBufferPointer();
+    OutputPixelType* fBuffer = outputImage->GetBufferPointer();
+    OutputPixelType* dBuffer = dImage->GetBufferPointer();
+    OutputPixelType* dstarBuffer = dstarImage->GetBufferPointer();
+    const unsigned int vectorLength = inputImagePointer->GetNumberOfComponentsPerPixel();
+
+    // read only from here on, the snapshot is only written for the voxel at the cross position
+    const int N = m_Snap.N;
+    const std::vector<unsigned int>& baselineind = m_Snap.baselineind;
+    const std::vector<unsigned int>& gradientind = m_Snap.gradientind;
+    const vnl_vector<double>& bvalues = m_Snap.bvalues;
+    const std::vector<int>& high_indices = m_Snap.high_indices;
+
+    IVIMLevenbergMarquardt<IVIM_3param_model> fitAll((IVIM_3param_model()));
+    IVIMLevenbergMarquardt<IVIM_fixdstar_model> fitFixDStar((IVIM_fixdstar_model(m_DStar)));
+    IVIMLevenbergMarquardt<IVIM_d_and_f_model> fitDAndF((IVIM_d_and_f_model()));
+    const double initAll[3] = {0.1, 0.001, 0.01};
+    const double initFixDStar[2] = {0.1, 0.001};
+    const double initDAndF[2] = {0.001, 0.1};
+
+    // all buffers are allocated once per thread
+    const unsigned int lineLength = outputRegionForThread.GetSize(0);
+    std::vector<double> lineMeas(lineLength*N);
+    std::vector<double> fitBvals(N), fitMeas(N);
+    std::vector<double> fitBvals2(N), fitMeas2(N);
+
+    typename InputImageType::IndexType index = outputRegionForThread.GetIndex();
+    for(unsigned int z=0; z<outputRegionForThread.GetSize(2); z++)
+        for(unsigned int y=0; y<outputRegionForThread.GetSize(1); y++)
+        {
+            index[0] = outputRegionForThread.GetIndex(0);
+            index[1] = outputRegionForThread.GetIndex(1)+y;
+            index[2] = outputRegionForThread.GetIndex(2)+z;
+            const InputPixelType* inLine = inBuffer + inputImagePointer->ComputeOffset(index)*vectorLength;
+            OffsetValueType outOffset = outputImage->ComputeOffset(index);
+
+            // normalized measurements of the whole line, thresholded ones blanked out
+            for(unsigned int x=0; x<lineLength; x++)
+            {
+                const InputPixelType* measvec = inLine + x*vectorLength;
+                double* meas = &lineMeas[x*N];
+
+                typename NumericTraits<InputPixelType>::AccumulateType b0 = NumericTraits<InputPixelType>::Zero;
+                if(!m_Snap.iterated_sequence)
+                {
+                    for(unsigned int i = 0; i < baselineind.size(); ++i)
+                        b0 += measvec[baselineind[i]];
+                    if(baselineind.size())
+                        b0 /= baselineind.size();
+                }
+                index[0] = outputRegionForThread.GetIndex(0)+x;
+                bool cross = index == m_CrossPosition;
+                if(cross)
+                    m_Snap.allmeas.set_size(N);
+
+                for(int i = 0; i < N; ++i)
+                {
+                    if(m_Snap.iterated_sequence)
+                        b0 = measvec[baselineind[i]];
+                    if(cross)
+                        m_Snap.allmeas[i] = measvec[gradientind[i]] / (b0+.0001);
+                    if(measvec[gradientind[i]] > m_S0Thres)
+                        meas[i] = measvec[gradientind[i]] / (b0+.0001);
+                    else
+                        meas[i] = IVIM_FOO;
+                }
+            }
+
+            // fit voxel by voxel, each one warm started from its predecessor in the line
+            double neighbour[3];
+            bool hasNeighbour = false;
+            for(unsigned int x=0; x<lineLength; x++)
+            {
+                const double* meas = &lineMeas[x*N];
+                double f = 0;
+                double D = 0;
+                double DStar = 0;
+                int n1 = 0;
+                int n2 = 0;
+
+                switch(m_Method)
+                {
+                case IVIM_FIT_ALL:
+                {
+                    for(int i=0; i<N; i++)
+                        if(meas[i] != IVIM_FOO)
+                        {
+                            fitBvals[n1] = bvalues[i];
+                            fitMeas[n1] = meas[i];
+                            n1++;
+                        }
+
+                    double p[3];
+                    if(n1 >= 3 && fitAll.WarmStartedMinimize(&fitBvals[0], &fitMeas[0], n1, initAll, hasNeighbour ? neighbour : nullptr, p))
+                    {
+                        f = p[0];
+                        D = p[1];
+                        DStar = p[2];
+                        std::copy(p, p+3, neighbour);
+                        hasNeighbour = true;
+                    }
+                    else
+                        hasNeighbour = false;
+                    break;
+                }
+
+                case IVIM_DSTAR_FIX:
+                {
+                    for(int i=0; i<N; i++)
+                        if(meas[i] != IVIM_FOO)
+                        {
+                            fitBvals[n1] = bvalues[i];
+                            fitMeas[n1] = meas[i];
+                            n1++;
+                        }
+
+                    double p[2];
+                    if(n1 >= 2 && fitFixDStar.WarmStartedMinimize(&fitBvals[0], &fitMeas[0], n1, initFixDStar, hasNeighbour ? neighbour : nullptr, p))
+                    {
+                        f = p[0];
+                        D = p[1];
+                        DStar = m_DStar;
+                        std::copy(p, p+2, neighbour);
+                        hasNeighbour = true;
+                    }
+                    else
+                        hasNeighbour = false;
+                    break;
+                }
+
+                case IVIM_D_THEN_DSTAR:
+                {
+                    for(unsigned int i=0; i<high_indices.size(); i++)
+                        if(meas[high_indices[i]] != IVIM_FOO)
+                        {
+                            fitBvals[n1] = bvalues[high_indices[i]];
+                            fitMeas[n1] = meas[high_indices[i]];
+                            n1++;
+                        }
+
+                    if(n1 < 2)
+                    {
+                        if(n1 == 1)
+                            D = - log(fitMeas[0]) / fitBvals[0];
+                        hasNeighbour = false;
+                        break;
+                    }
+
+                    double p[2];
+                    if(fitDAndF.WarmStartedMinimize(&fitBvals[0], &fitMeas[0], n1, initDAndF, hasNeighbour ? neighbour : nullptr, p))
+                    {
+                        D = p[0];
+                        f = p[1];
+                        std::copy(p, p+2, neighbour);
+                        hasNeighbour = true;
+                    }
+                    else
+                    {
+                        // no D and f to fix, searching D* against f = D = 0 is meaningless
+                        hasNeighbour = false;
+                        break;
+                    }
+
+                    if(m_FitDStar)
+                    {
+                        for(int i=0; i<N; i++)
+                            if(meas[i] != IVIM_FOO)
+                            {
+                                fitBvals2[n2] = bvalues[i];
+                                fitMeas2[n2] = meas[i];
+                                n2++;
+                            }
+                        if(n2 < 2)
+                            break;
+
+                        // same grid search as the unbatched fit
+                        IVIM_3param_model model;
+                        double gradient[3];
+                        double opt = 1111111111111111.0;
+                        int opt_idx = -1;
+                        int num_its = 100;
+                        double min_val = .001;
+                        double max_val = .15;
+                        for(int i=0; i<num_its; i++)
+                        {
+                            double params[3] = {f, D, min_val + i * ((max_val-min_val) / num_its)};
+                            double err = 0;
+                            for(int s=0; s<n2; s++)
+                            {
+                                double r = fitMeas2[s] - model.Evaluate(params, fitBvals2[s], gradient);
+                                err += r*r;
+                            }
+                            if(err<opt)
+                            {
+                                opt = err;
+                                opt_idx = i;
+                            }
+                        }
+                        DStar = min_val + opt_idx * ((max_val-min_val) / num_its);
+                    }
+                    break;
+                }
+
+                default:
+                    break;
+                }
+
+                double fCeiled = f;
+                IVIM_CEIL( fCeiled, 0.0, 1.0 );
+                fBuffer[outOffset+x] = fCeiled;
+                dBuffer[outOffset+x] = D;
+                dstarBuffer[outOffset+x] = DStar;
+
+                index[0] = outputRegionForThread.GetIndex(0)+x;
+                if(index == m_CrossPosition)
+                {
+                    // only one thread contains this voxel
+                    m_Snap.currentF = fCeiled;
+                    m_Snap.currentFunceiled = f;
+                    m_Snap.currentD = D;
+                    m_Snap.currentDStar = DStar;
+                    m_Snap.meas.set_size(N);
+                    m_Snap.meas.copy_in(meas);
+                    m_Snap.meas1 = vnl_vector<double>(&fitMeas[0], n1);
+                    m_Snap.bvals1 = vnl_vector<double>(&fitBvals[0], n1);
+                    m_Snap.meas2 = vnl_vector<double>(&fitMeas2[0], n2);
+                    m_Snap.bvals2 = vnl_vector<double>(&fitBvals2[0], n2);
+                }
+            }
+        }
+}
+
 template< class TIn, class TOut>
 void DiffusionIntravoxelIncoherentMotionReconstructionImageFilter<TIn, TOut>
 ::AfterThreadedGenerateData()
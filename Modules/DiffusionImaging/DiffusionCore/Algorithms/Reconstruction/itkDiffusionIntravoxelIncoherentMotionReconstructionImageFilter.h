@@ -30,6 +30,8 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "vnl/algo/vnl_levenberg_marquardt.h"
 #include "vnl/vnl_math.h"
 
+#include "itkIVIMLevenbergMarquardt.h"
+
 #define IVIM_CEIL(val,u,o) (val) =       \
   ( (val) < (u) ) ? ( (u) ) : ( ( (val)>(o) ) ? ( (o) ) : ( (val) ) );
 
@@ -303,6 +305,12 @@ namespace itk{
     void SetCrossPosition(typename InputImageType::IndexType crosspos){this->m_CrossPosition = crosspos;}
     void SetMethod(IVIM_Method method){m_Method = method;}
 
+    /** Fit IVIM_FIT_ALL, IVIM_DSTAR_FIX and IVIM_D_THEN_DSTAR line by line with the allocation free IVIMLevenbergMarquardt,
+     * each voxel warm started with the solution of its neighbour if that fits the measurements better than the default
+     * initialization. This path is thread safe, so the filter can use all threads. The snapshot is only filled for the
+     * voxel at the cross position. */
+    void SetUseBatchedFit(bool batched){m_UseBatchedFit = batched;}
+
     IVIMSnapshot GetSnapshot(){return m_Snap;}
 
     /** Return the gradient direction. idx is 0 based */
@@ -325,6 +333,8 @@ namespace itk{
                                ThreadIdType);
     void AfterThreadedGenerateData();
 
+    void BatchedThreadedGenerateData( const OutputImageRegionType &outputRegionForThread );
+
     MeasAndBvals ApplyS0Threshold(vnl_vector<double> &meas, vnl_vector<double> &bvals);
 
   private:
@@ -369,6 +379,8 @@ namespace itk{
 
     typename InputImageType::IndexType m_CrossPosition;
 
+    bool m_UseBatchedFit;
+
   };
 
 }
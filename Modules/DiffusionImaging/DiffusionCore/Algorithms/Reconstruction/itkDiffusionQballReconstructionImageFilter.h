@@ -252,6 +252,11 @@ public:
 #endif
   itkGetConstReferenceMacro( BValue, TOdfPixelType);
 
+  /** Number of voxels reconstructed together with a single matrix-matrix
+   * product (only used if the gradients are given in a single image) */
+  itkSetMacro( VoxelBlockSize, unsigned int );
+  itkGetMacro( VoxelBlockSize, unsigned int );
+
 #ifdef ITK_USE_CONCEPT_CHECKING
   /** Begin concept checking */
   itkConceptMacro(ReferenceEqualityComparableCheck,
@@ -329,6 +334,9 @@ private:
 
   /** Normalization method to be applied */
   Normalization                                     m_NormalizationMethod;
+
+  /** Number of voxels gathered into one signal matrix */
+  unsigned int                                      m_VoxelBlockSize;
 };
 
 }
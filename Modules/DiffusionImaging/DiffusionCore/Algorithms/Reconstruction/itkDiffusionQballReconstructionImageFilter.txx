@@ -24,6 +24,8 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "vnl/vnl_vector.h"
 #include "itkPointShell.h"
 
+#include <algorithm>
+
 #define _USE_MATH_DEFINES
 #include <math.h>
 
@@ -47,7 +49,8 @@ namespace itk {
     m_Threshold(NumericTraits< ReferencePixelType >::NonpositiveMin()),
     m_BValue(1.0),
     m_GradientImageTypeEnumeration(Else),
-    m_DirectionsDuplicated(false)
+    m_DirectionsDuplicated(false),
+    m_VoxelBlockSize(512)
   {
     // At least 1 inputs is necessary for a vector image.
     // For images added one at a time we need at least six
@@ -364,53 +367,82 @@ namespace itk {
           gradientind.push_back(gradientind[i]);
       }
 
-      // Following loop does the actual reconstruction work in each voxel
-      // (Tuch, Q-Ball Reconstruction [1])
+      // The signals of up to blockSize voxels are gathered column-wise so
+      // that the reconstruction of a whole block is a single matrix-matrix
+      // product with the reconstruction matrix (Tuch, Q-Ball Reconstruction [1])
+      const unsigned int blockSize = std::max(1u, m_VoxelBlockSize);
+      vnl_matrix<TOdfPixelType> signals(m_NumberOfGradientDirections, blockSize);
+      std::vector< typename NumericTraits<ReferencePixelType>::AccumulateType > b0Values(blockSize);
+      std::vector< int > columns(blockSize);
+
       while( !git.IsAtEnd() )
       {
-        // current vector of diffusion measurements
-        GradientVectorType b = git.Get();
-
-        // average of current b-zero reference values
-        typename NumericTraits<ReferencePixelType>::AccumulateType b0 = NumericTraits<ReferencePixelType>::Zero;
-        for(unsigned int i = 0; i < baselineind.size(); ++i)
+        // gather block of diffusion measurements
+        unsigned int numVoxels = 0;
+        unsigned int numValid = 0;
+        while( !git.IsAtEnd() && numVoxels<blockSize )
         {
-          b0 += b[baselineind[i]];
-        }
-        b0 /= this->m_NumberOfBaselineImages;
-
-        // init resulting ODF
-        OdfPixelType odf(0.0);
+          // current vector of diffusion measurements
+          GradientVectorType b = git.Get();
 
-        // threshold on reference value to suppress noisy regions
-        if( (b0 != 0) && (b0 >= m_Threshold) )
-        {
-          for( unsigned int i = 0; i< m_NumberOfGradientDirections; i++ )
+          // average of current b-zero reference values
+          typename NumericTraits<ReferencePixelType>::AccumulateType b0 = NumericTraits<ReferencePixelType>::Zero;
+          for(unsigned int i = 0; i < baselineind.size(); ++i)
           {
-            B[i] = static_cast<TOdfPixelType>(b[gradientind[i]]);
+            b0 += b[baselineind[i]];
           }
+          b0 /= this->m_NumberOfBaselineImages;
 
-          // pre-normalization according to m_NormalizationMethod
-          B = PreNormalize(B);
+          b0Values[numVoxels] = b0;
+          columns[numVoxels] = -1;
 
-          // actual reconstruction
-          odf = ( (*m_ReconstructionMatrix) * B ).data_block();
+          // threshold on reference value to suppress noisy regions
+          if( (b0 != 0) && (b0 >= m_Threshold) )
+          {
+            for( unsigned int i = 0; i< m_NumberOfGradientDirections; i++ )
+            {
+              B[i] = static_cast<TOdfPixelType>(b[gradientind[i]]);
+            }
 
-          // post-normalization according to m_NormalizationMethod
-          odf = Normalize(odf, b0);
+            // pre-normalization according to m_NormalizationMethod
+            signals.set_column(numValid, PreNormalize(B));
+            columns[numVoxels] = numValid;
+            numValid++;
+          }
 
+          ++numVoxels;
+          ++git; // Gradient  image iterator
         }
 
-        for (unsigned int i=0; i<odf.Size(); i++)
-            if (odf.GetElement(i)!=odf.GetElement(i))
-                odf.Fill(0.0);
+        // actual reconstruction of all valid voxels in the block
+        vnl_matrix<TOdfPixelType> odfs;
+        if( numValid>0 )
+          odfs = (*m_ReconstructionMatrix) * signals.extract(m_NumberOfGradientDirections, numValid);
 
-        // set and increment output iterators
-        oit.Set( odf );
-        ++oit;
-        oit2.Set( b0 );
-        ++oit2;
-        ++git; // Gradient  image iterator
+        for (unsigned int v=0; v<numVoxels; v++)
+        {
+          // init resulting ODF
+          OdfPixelType odf(0.0);
+
+          if( columns[v]>=0 )
+          {
+            for (int i=0; i<NrOdfDirections; i++)
+              odf[i] = odfs(i, columns[v]);
+
+            // post-normalization according to m_NormalizationMethod
+            odf = Normalize(odf, b0Values[v]);
+          }
+
+          for (unsigned int i=0; i<odf.Size(); i++)
+              if (odf.GetElement(i)!=odf.GetElement(i))
+                  odf.Fill(0.0);
+
+          // set and increment output iterators
+          oit.Set( odf );
+          ++oit;
+          oit2.Set( b0Values[v] );
+          ++oit2;
+        }
       }
     }
 
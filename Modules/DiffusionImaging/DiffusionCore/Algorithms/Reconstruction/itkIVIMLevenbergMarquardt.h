@@ -0,0 +1,257 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+#ifndef __itkIVIMLevenbergMarquardt_h
+#define __itkIVIMLevenbergMarquardt_h
+
+#include <cmath>
+#include <algorithm>
+
+namespace itk{
+
+  /** IVIM signal (1-f)*exp(-b*D) + f*exp(-b*(D+D*)), x = (f, D, D*) */
+  struct IVIM_3param_model
+  {
+    static const unsigned int NumberOfParameters = 3;
+
+    double Evaluate(const double* x, double b, double* gradient) const
+    {
+      double e1 = exp(-b*x[1]);
+      double e2 = exp(-b*(x[1]+x[2]));
+      double approx = (1-x[0])*e1 + x[0]*e2;
+      gradient[0] = e2 - e1;
+      gradient[1] = -b*approx;
+      gradient[2] = -b*x[0]*e2;
+      return approx;
+    }
+  };
+
+  /** IVIM signal with fixed D*, x = (f, D) */
+  struct IVIM_fixdstar_model
+  {
+    static const unsigned int NumberOfParameters = 2;
+
+    IVIM_fixdstar_model(double DStar) : fixDStar(DStar) {}
+
+    double Evaluate(const double* x, double b, double* gradient) const
+    {
+      double e1 = exp(-b*x[1]);
+      double e2 = exp(-b*(x[1]+fixDStar));
+      double approx = (1-x[0])*e1 + x[0]*e2;
+      gradient[0] = e2 - e1;
+      gradient[1] = -b*approx;
+      return approx;
+    }
+
+    double fixDStar;
+  };
+
+  /** monoexponential signal (1-f)*exp(-b*D), x = (D, f) */
+  struct IVIM_d_and_f_model
+  {
+    static const unsigned int NumberOfParameters = 2;
+
+    double Evaluate(const double* x, double b, double* gradient) const
+    {
+      double e = exp(-b*x[0]);
+      double approx = (1-x[1])*e;
+      gradient[0] = -b*approx;
+      gradient[1] = -e;
+      return approx;
+    }
+  };
+
+  /**
+    * \brief Levenberg-Marquardt least squares fit of one of the IVIM models above.
+    *
+    * In contrast to vnl_levenberg_marquardt the number of parameters is a compile time constant, the Jacobian is
+    * computed analytically and the normal equations are solved by a Cholesky decomposition on the stack, so a fit
+    * does not allocate any memory. The iteration stops if the relative decrease of the squared residual is below
+    * the f-tolerance, if no step decreases it anymore or after the maximum number of iterations.
+    */
+  template< class TModel >
+  class IVIMLevenbergMarquardt
+  {
+  public:
+
+    static const unsigned int NumberOfParameters = TModel::NumberOfParameters;
+
+    IVIMLevenbergMarquardt(const TModel& model)
+      : m_Model(model)
+      , m_FTolerance(0.0001)
+      , m_MaxIterations(100)
+    {}
+
+    void SetFTolerance(double tol){ m_FTolerance = tol; }
+    void SetMaxIterations(unsigned int its){ m_MaxIterations = its; }
+
+    /** Sum of squared residuals of the N measurements at parameters x. */
+    double GetCost(const double* bvals, const double* meas, unsigned int N, const double* x) const
+    {
+      double gradient[NumberOfParameters];
+      double cost = 0;
+      for (unsigned int s=0; s<N; s++)
+      {
+        double r = meas[s] - m_Model.Evaluate(x, bvals[s], gradient);
+        cost += r*r;
+      }
+      return cost;
+    }
+
+    /** Minimizes the squared residual starting at x. Returns false if the result is not finite. */
+    bool Minimize(const double* bvals, const double* meas, unsigned int N, double* x) const
+    {
+      double cost = GetCost(bvals, meas, N, x);
+      if (!std::isfinite(cost))
+        return false;
+
+      double lambda = 0.001;
+      for (unsigned int it=0; it<m_MaxIterations && cost>0; it++)
+      {
+        double JtJ[NumberOfParameters][NumberOfParameters];
+        double Jtr[NumberOfParameters];
+        for (unsigned int i=0; i<NumberOfParameters; i++)
+        {
+          Jtr[i] = 0;
+          for (unsigned int j=0; j<NumberOfParameters; j++)
+            JtJ[i][j] = 0;
+        }
+
+        double gradient[NumberOfParameters];
+        for (unsigned int s=0; s<N; s++)
+        {
+          double r = meas[s] - m_Model.Evaluate(x, bvals[s], gradient);
+          for (unsigned int i=0; i<NumberOfParameters; i++)
+          {
+            Jtr[i] += gradient[i]*r;
+            for (unsigned int j=0; j<=i; j++)
+              JtJ[i][j] += gradient[i]*gradient[j];
+          }
+        }
+
+        // increase the damping until the step decreases the residual
+        bool improved = false;
+        double newCost = cost;
+        double step[NumberOfParameters];
+        double newX[NumberOfParameters];
+        while (lambda<1e10)
+        {
+          double A[NumberOfParameters][NumberOfParameters];
+          for (unsigned int i=0; i<NumberOfParameters; i++)
+            for (unsigned int j=0; j<=i; j++)
+              A[i][j] = JtJ[i][j];
+          for (unsigned int i=0; i<NumberOfParameters; i++)
+            A[i][i] += lambda*(JtJ[i][i]>0 ? JtJ[i][i] : 1.0);
+
+          if (Solve(A, Jtr, step))
+          {
+            for (unsigned int i=0; i<NumberOfParameters; i++)
+              newX[i] = x[i] + step[i];
+            newCost = GetCost(bvals, meas, N, newX);
+            if (newCost<cost)
+            {
+              improved = true;
+              break;
+            }
+          }
+          lambda *= 10;
+        }
+        if (!improved)
+          break;
+
+        for (unsigned int i=0; i<NumberOfParameters; i++)
+          x[i] = newX[i];
+        double decrease = (cost-newCost)/cost;
+        cost = newCost;
+        lambda = std::max(lambda*0.1, 1e-12);
+        if (decrease<m_FTolerance)
+          break;
+      }
+
+      for (unsigned int i=0; i<NumberOfParameters; i++)
+        if (!std::isfinite(x[i]))
+          return false;
+      return true;
+    }
+
+    /** Minimizes starting at init or, if it is not null and has the lower residual, at the neighbour's solution. A warm
+     * start that does not converge to a finite result is repeated from init. */
+    bool WarmStartedMinimize(const double* bvals, const double* meas, unsigned int N, const double* init, const double* neighbour, double* x) const
+    {
+      for (unsigned int i=0; i<NumberOfParameters; i++)
+        x[i] = init[i];
+      bool warm = neighbour!=nullptr && GetCost(bvals, meas, N, neighbour)<GetCost(bvals, meas, N, init);
+      if (warm)
+        for (unsigned int i=0; i<NumberOfParameters; i++)
+          x[i] = neighbour[i];
+
+      if (Minimize(bvals, meas, N, x))
+        return true;
+      if (!warm)
+        return false;
+
+      for (unsigned int i=0; i<NumberOfParameters; i++)
+        x[i] = init[i];
+      return Minimize(bvals, meas, N, x);
+    }
+
+  protected:
+
+    /** Solves A*x=b for symmetric positive definite A (only the lower triangle is used). */
+    static bool Solve(const double A[][NumberOfParameters], const double* b, double* x)
+    {
+      double L[NumberOfParameters][NumberOfParameters];
+      for (unsigned int i=0; i<NumberOfParameters; i++)
+        for (unsigned int j=0; j<=i; j++)
+        {
+          double sum = A[i][j];
+          for (unsigned int k=0; k<j; k++)
+            sum -= L[i][k]*L[j][k];
+          if (i==j)
+          {
+            if (!(sum>0))
+              return false;
+            L[i][i] = sqrt(sum);
+          }
+          else
+            L[i][j] = sum/L[j][j];
+        }
+
+      double y[NumberOfParameters];
+      for (unsigned int i=0; i<NumberOfParameters; i++)
+      {
+        double sum = b[i];
+        for (unsigned int k=0; k<i; k++)
+          sum -= L[i][k]*y[k];
+        y[i] = sum/L[i][i];
+      }
+      for (int i=NumberOfParameters-1; i>=0; i--)
+      {
+        double sum = y[i];
+        for (unsigned int k=i+1; k<NumberOfParameters; k++)
+          sum -= L[k][i]*x[k];
+        x[i] = sum/L[i][i];
+      }
+      return true;
+    }
+
+    TModel        m_Model;
+    double        m_FTolerance;
+    unsigned int  m_MaxIterations;
+  };
+
+}
+
+#endif //__itkIVIMLevenbergMarquardt_h
@@ -40,6 +40,7 @@ PURPOSE.  See the above copyright notices for more information.
 #include <time.h>
 #include <itkImageRegionIterator.h>
 #include <itkImageRegion.h>
+#include <vector>
 
 namespace itk
 {
@@ -195,36 +196,22 @@ ElectrostaticRepulsionDiffusionGradientReductionFilter<TInputScalarType, TOutput
     outImage->SetVectorLength( vecLength ); // Set the vector length
     outImage->Allocate();
 
-    itk::ImageRegionIterator< OutputImageType > newIt(outImage, outImage->GetLargestPossibleRegion());
-    newIt.GoToBegin();
-
-    typename InputImageType::Pointer inImage = const_cast<InputImageType*>(this->GetInput(0));
-    itk::ImageRegionIterator< InputImageType > oldIt(inImage, inImage->GetLargestPossibleRegion());
-    oldIt.GoToBegin();
-
-    // initial new value of voxel
-    OutputPixelType newVec;
-    newVec.SetSize( vecLength );
-    newVec.AllocateElements( vecLength );
-
-    // generate new pixel values
-    while(!newIt.IsAtEnd())
+    // input channel of each output channel
+    std::vector< unsigned int > channels;
+    for(BValueMap::iterator it=manipulatedMap.begin(); it!=manipulatedMap.end(); it++)
+        channels.insert(channels.end(), it->second.begin(), it->second.end());
+
+    // copy directly between the image buffers, voxel by voxel, without temporary pixel vectors
+    const InputScalarType* inBuffer = this->GetInput(0)->GetBufferPointer();
+    const unsigned int inLength = this->GetInput(0)->GetVectorLength();
+    OutputScalarType* outBuffer = outImage->GetBufferPointer();
+    const unsigned long numVoxels = outImage->GetLargestPossibleRegion().GetNumberOfPixels();
+    for (unsigned long v=0; v<numVoxels; v++)
     {
-        // init new vector with zeros
-        newVec.Fill(0.0);
-        InputPixelType oldVec = oldIt.Get();
-
-        int index = 0;
-        for(BValueMap::iterator it=manipulatedMap.begin(); it!=manipulatedMap.end(); it++)
-            for(unsigned int j=0; j<it->second.size(); j++)
-            {
-                newVec[index] = oldVec[it->second.at(j)];
-                index++;
-            }
-        newIt.Set(newVec);
-
-        ++newIt;
-        ++oldIt;
+        const InputScalarType* inVoxel = inBuffer + v*inLength;
+        OutputScalarType* outVoxel = outBuffer + v*vecLength;
+        for (int c=0; c<vecLength; c++)
+            outVoxel[c] = inVoxel[channels[c]];
     }
 
     // set new gradient directions
@@ -19,6 +19,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 #include "itkImageToImageFilter.h"
 #include "itkVectorImage.h"
+#include <vector>
 
 
 namespace itk{
@@ -27,6 +28,10 @@ namespace itk{
    *
    * This Filter needs as an input a diffusion weigthed image, which will be denoised unsing the non-local means principle.
    * An input mask is optional to denoise only inside the mask range. All other voxels will be set to 0.
+   *
+   * The image is processed in blocks. For each offset in the search neighborhood, the squared differences between the
+   * extended block and its shifted copy are computed once and summed over the comparison neighborhoods by separable
+   * running sums, instead of comparing the full neighborhoods of every voxel pair.
   */
 
   template< class TPixelType >
@@ -124,6 +129,17 @@ namespace itk{
      */
     void ThreadedGenerateData( const OutputImageRegionType &outputRegionForThread, ThreadIdType);
 
+    /**
+     * @brief Denoises one block of the output region.
+     */
+    void DenoiseBlock(const OutputImageRegionType& block);
+
+    /**
+     * @brief Sums up the values of all comparison neighborhoods along one axis
+     *
+     * The input contains numChannels values per voxel, the output is 2 * comparisonradius voxels shorter along the axis.
+     */
+    void SumNeighborhoods(const std::vector< double >& input, const int inputSize[3], int axis, int numChannels, std::vector< double >& output);
 
 
   private:
@@ -135,6 +151,7 @@ namespace itk{
     unsigned int m_CurrentVoxelCount;                 ///< Amount of processed voxels.
     double m_Variance;                                ///< Estimated noise variance.
     typename MaskImageType::Pointer m_Mask;           ///< Pointer to the mask image.
+    unsigned int m_BlockSize;                         ///< Edge length of the blocks that are denoised at once.
   };
 }
 
@@ -28,6 +28,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "itkNeighborhoodIterator.h"
 #include <itkImageRegionIteratorWithIndex.h>
 #include <vector>
+#include <algorithm>
 
 namespace itk {
 
@@ -40,7 +41,8 @@ NonLocalMeansDenoisingFilter< TPixelType >
     m_UseJointInformation(false),
     m_UseRicianAdaption(false),
     m_Variance(1),
-    m_Mask(NULL)
+    m_Mask(NULL),
+    m_BlockSize(16)
 {
   this->SetNumberOfRequiredInputs( 1 );
 }
@@ -127,249 +129,289 @@ void
 NonLocalMeansDenoisingFilter< TPixelType >
 ::ThreadedGenerateData(const OutputImageRegionType& outputRegionForThread, ThreadIdType )
 {
+  // the region of this thread is denoised block by block
+  typename OutputImageRegionType::IndexType threadIndex = outputRegionForThread.GetIndex();
+  typename OutputImageRegionType::SizeType threadSize = outputRegionForThread.GetSize();
+  for (unsigned int z = 0; z < threadSize[2]; z += m_BlockSize)
+  {
+    for (unsigned int y = 0; y < threadSize[1]; y += m_BlockSize)
+    {
+      for (unsigned int x = 0; x < threadSize[0]; x += m_BlockSize)
+      {
+        typename OutputImageRegionType::IndexType blockIndex;
+        typename OutputImageRegionType::SizeType blockSize;
+        blockIndex[0] = threadIndex[0] + x;
+        blockIndex[1] = threadIndex[1] + y;
+        blockIndex[2] = threadIndex[2] + z;
+        blockSize[0] = std::min<unsigned int>(m_BlockSize, threadSize[0] - x);
+        blockSize[1] = std::min<unsigned int>(m_BlockSize, threadSize[1] - y);
+        blockSize[2] = std::min<unsigned int>(m_BlockSize, threadSize[2] - z);
+        DenoiseBlock(OutputImageRegionType(blockIndex, blockSize));
+      }
+    }
+  }
 
+  MITK_INFO << "One Thread finished calculation";
+}
 
-  // initialize iterators
-  typename OutputImageType::Pointer outputImage =
-          static_cast< OutputImageType * >(this->ProcessObject::GetOutput(0));
-
-  ImageRegionIterator< OutputImageType > oit(outputImage, outputRegionForThread);
-  oit.GoToBegin();
-
-  ImageRegionIterator< MaskImageType > mit(m_Mask, outputRegionForThread);
-  mit.GoToBegin();
-
+template< class TPixelType >
+void
+NonLocalMeansDenoisingFilter< TPixelType >
+::DenoiseBlock(const OutputImageRegionType& block)
+{
+  typename OutputImageType::Pointer outputImage = static_cast< OutputImageType * >(this->ProcessObject::GetOutput(0));
+  typename InputImageType::Pointer inputImagePointer = static_cast< InputImageType * >( this->ProcessObject::GetInput(0) );
 
+  const int numValues = inputImagePointer->GetVectorLength();
+  const int numChannels = m_UseJointInformation ? 1 : numValues;   // channels of the patch distances
+  const int numVoxels = block.GetNumberOfPixels();
 
-  typedef ImageRegionIteratorWithIndex <InputImageType> InputIteratorType;
-  typename InputImageType::Pointer inputImagePointer = NULL;
-  inputImagePointer = static_cast< InputImageType * >( this->ProcessObject::GetInput(0) );
+  int blockSize[3], extSize[3], extIndex[3], imageStart[3], imageEnd[3];
+  for (int i = 0; i < 3; ++i)
+  {
+    blockSize[i] = block.GetSize()[i];
+    extSize[i] = blockSize[i] + 2 * m_ComparisonRadius;
+    extIndex[i] = block.GetIndex()[i] - m_ComparisonRadius;
+    imageStart[i] = inputImagePointer->GetLargestPossibleRegion().GetIndex()[i];
+    imageEnd[i] = imageStart[i] + inputImagePointer->GetLargestPossibleRegion().GetSize()[i];
+  }
+  const int numExtVoxels = extSize[0] * extSize[1] * extSize[2];
+  const double maxDistance = 746;   // exp(-maxDistance) is zero in double precision
+
+  // raw access to the input pixels
+  const TPixelType* buffer = inputImagePointer->GetBufferPointer();
+  const typename InputImageType::OffsetValueType* offsetTable = inputImagePointer->GetOffsetTable();
+  const typename InputImageType::IndexType bufferIndex = inputImagePointer->GetBufferedRegion().GetIndex();
+  auto pixel = [&](int x, int y, int z) -> const TPixelType*
+  {
+    return buffer + ((x - bufferIndex[0]) + (y - bufferIndex[1]) * offsetTable[1] + (z - bufferIndex[2]) * offsetTable[2]) * numValues;
+  };
+  auto inside = [&](int x, int y, int z) -> bool
+  {
+    return x >= imageStart[0] && x < imageEnd[0] && y >= imageStart[1] && y < imageEnd[1] && z >= imageStart[2] && z < imageEnd[2];
+  };
 
-  InputIteratorType git(inputImagePointer, outputRegionForThread );
-  git.GoToBegin();
+  std::vector< char > mask(numVoxels, 0);
+  int numMasked = 0;
+  ImageRegionConstIterator< MaskImageType > mit(m_Mask, block);
+  for (int v = 0; !mit.IsAtEnd(); ++mit, ++v)
+  {
+    if (mit.Get() != 0 && !this->GetAbortGenerateData())
+    {
+      mask[v] = 1;
+      ++numMasked;
+    }
+  }
 
-  // iterate over complete image region
-  while( !git.IsAtEnd() )
+  std::vector< double > summw(numVoxels * numChannels, 0.0);
+  std::vector< double > sumj(numVoxels * numValues, 0.0);
+  if (numMasked > 0)
   {
-    typename OutputImageType::PixelType outpix;
-    outpix.SetSize (inputImagePointer->GetVectorLength());
+    std::vector< double > distances(numExtVoxels * numChannels), counts(numExtVoxels);
+    std::vector< double > temp1, temp2, patchDistances, temp3, temp4, patchSizes;
 
-    if (mit.Get() != 0 && !this->GetAbortGenerateData())
+    // The weights are normalized by the sum of all weights of a voxel before they are accumulated. Since the weights of all
+    // search offsets can not be stored, the first pass sums up the weights and the second pass computes the weighted means.
+    for (int pass = 0; pass < 2; ++pass)
     {
-      if(!m_UseJointInformation)
+      for (int dx = -m_SearchRadius; dx <= m_SearchRadius; ++dx)
       {
-        for (int i = 0; i < (int)inputImagePointer->GetVectorLength(); ++i)
+        for (int dy = -m_SearchRadius; dy <= m_SearchRadius; ++dy)
         {
-          double summw = 0;
-          double sumj = 0;
-          double w = 0;
-          std::vector<double> wj;
-          std::vector<double> p;
-          typename InputIteratorType::IndexType index;
-          index = git.GetIndex();
-
-          for (int x = index.GetElement(0) - m_SearchRadius; x <= index.GetElement(0) + m_SearchRadius; ++x)
+          for (int dz = -m_SearchRadius; dz <= m_SearchRadius; ++dz)
           {
-            for (int y = index.GetElement(1) - m_SearchRadius; y <= index.GetElement(1) + m_SearchRadius; ++y)
+            // squared differences between each voxel of the extended block and the voxel shifted by the search offset
+            for (int z = 0, e = 0; z < extSize[2]; ++z)
             {
-              for (int z = index.GetElement(2) - m_SearchRadius; z <= index.GetElement(2) + m_SearchRadius; ++z)
+              for (int y = 0; y < extSize[1]; ++y)
               {
-                typename InputIteratorType::IndexType indexV;
-                indexV.SetElement(0, x);
-                indexV.SetElement(1, y);
-                indexV.SetElement(2, z);
-                if (inputImagePointer->GetLargestPossibleRegion().IsInside(indexV))
+                for (int x = 0; x < extSize[0]; ++x, ++e)
                 {
-                  TPixelType pixelJ = inputImagePointer->GetPixel(indexV)[i];
-                  double sumk = 0;
-                  double size = 0;
-                  for (int xi = index.GetElement(0) - m_ComparisonRadius, xj = x - m_ComparisonRadius; xi <= index.GetElement(0) + m_ComparisonRadius; ++xi, ++xj)
+                  int ix = extIndex[0] + x, iy = extIndex[1] + y, iz = extIndex[2] + z;
+                  double* d = &distances[e * numChannels];
+                  if (!inside(ix, iy, iz) || !inside(ix + dx, iy + dy, iz + dz))
                   {
-                    for (int yi = index.GetElement(1) - m_ComparisonRadius, yj = y - m_ComparisonRadius; yi <= index.GetElement(1) + m_ComparisonRadius; ++yi, ++yj)
-                    {
-                      for (int zi = index.GetElement(2) - m_ComparisonRadius, zj = z - m_ComparisonRadius; zi <= index.GetElement(2) + m_ComparisonRadius; ++zi, ++zj)
-                      {
-                        typename InputIteratorType::IndexType indexI, indexJ;
-                        indexI.SetElement(0, xi);
-                        indexI.SetElement(1, yi);
-                        indexI.SetElement(2, zi);
-                        indexJ.SetElement(0, xj);
-                        indexJ.SetElement(1, yj);
-                        indexJ.SetElement(2, zj);
-
-
-                        // Compare neighborhoods ni & nj
-                        if (inputImagePointer->GetLargestPossibleRegion().IsInside(indexI) && inputImagePointer->GetLargestPossibleRegion().IsInside(indexJ))
-                        {
-                          int diff = inputImagePointer->GetPixel(indexI)[i] - inputImagePointer->GetPixel(indexJ)[i];
-                          sumk += (double)(diff*diff);
-                          ++size;
-                        }
-                      }
-                    }
+                    std::fill(d, d + numChannels, 0.0);
+                    counts[e] = 0;
+                    continue;
                   }
-                  // weight all neighborhoods
-                  w = std::exp( - sumk / size / m_Variance);
-                  wj.push_back(w);
-                  if (m_UseRicianAdaption)
+                  const TPixelType* pi = pixel(ix, iy, iz);
+                  const TPixelType* pj = pixel(ix + dx, iy + dy, iz + dz);
+                  if (m_UseJointInformation)
                   {
-                    p.push_back((double)(pixelJ*pixelJ));
+                    double sum = 0;
+                    for (int i = 0; i < numValues; ++i)
+                    {
+                      TPixelType diff = pi[i] - pj[i];
+                      sum += diff * diff;
+                    }
+                    d[0] = sum;
                   }
                   else
                   {
-                    p.push_back((double)(pixelJ));
+                    for (int i = 0; i < numValues; ++i)
+                    {
+                      int diff = pi[i] - pj[i];
+                      d[i] = (double)(diff * diff);
+                    }
                   }
-                  summw += w;
+                  counts[e] = 1;
                 }
               }
             }
-          }
-          for (unsigned int n = 0; n < wj.size(); ++n)
-          {
-            sumj += (wj[n]/summw) * p[n];
-          }
-          if (m_UseRicianAdaption)
-          {
-            sumj -=2 * m_Variance;
-          }
 
-          if (sumj < 0)
-          {
-            sumj = 0;
-          }
-
-          TPixelType outval;
-          if (m_UseRicianAdaption)
-          {
-            outval = std::floor(std::sqrt(sumj) + 0.5);
-          }
-          else
-          {
-            outval = std::floor(sumj + 0.5);
-          }
-          outpix.SetElement(i, outval);
-        }
-      }
-
-      else
-      {
-        // same procedure for vektoranalysis
-
-        double Z = 0;
-        itk::VariableLengthVector<double> sumj;
-        sumj.SetSize(inputImagePointer->GetVectorLength());
-        sumj.Fill(0.0);
-        double w = 0;
-        std::vector<double> wj;
-        std::vector<itk::VariableLengthVector <double> > p;
-        typename InputIteratorType::IndexType index;
-        index = git.GetIndex();
-
-        for (int x = index.GetElement(0) - m_SearchRadius; x <= index.GetElement(0) + m_SearchRadius; ++x)
-        {
-          for (int y = index.GetElement(1) - m_SearchRadius; y <= index.GetElement(1) + m_SearchRadius; ++y)
-          {
-            for (int z = index.GetElement(2) - m_SearchRadius; z <= index.GetElement(2) + m_SearchRadius; ++z)
+            // patch distances and patch sizes of all block voxels by separable box sums over the comparison neighborhood
+            int size0[3] = { extSize[0], extSize[1], extSize[2] };
+            int size1[3] = { blockSize[0], extSize[1], extSize[2] };
+            int size2[3] = { blockSize[0], blockSize[1], extSize[2] };
+            SumNeighborhoods(distances, size0, 0, numChannels, temp1);
+            SumNeighborhoods(temp1, size1, 1, numChannels, temp2);
+            SumNeighborhoods(temp2, size2, 2, numChannels, patchDistances);
+            SumNeighborhoods(counts, size0, 0, 1, temp3);
+            SumNeighborhoods(temp3, size1, 1, 1, temp4);
+            SumNeighborhoods(temp4, size2, 2, 1, patchSizes);
+
+            for (int z = 0, v = 0; z < blockSize[2]; ++z)
             {
-              typename InputIteratorType::IndexType indexV;
-              indexV.SetElement(0, x);
-              indexV.SetElement(1, y);
-              indexV.SetElement(2, z);
-              if (inputImagePointer->GetLargestPossibleRegion().IsInside(indexV))
+              for (int y = 0; y < blockSize[1]; ++y)
               {
-                typename InputImageType::PixelType pixelJ = inputImagePointer->GetPixel(indexV);
-                double sumk = 0;
-                double size = 0;
-                for (int xi = index.GetElement(0) - m_ComparisonRadius, xj = x - m_ComparisonRadius; xi <= index.GetElement(0) + m_ComparisonRadius; ++xi, ++xj)
+                for (int x = 0; x < blockSize[0]; ++x, ++v)
                 {
-                  for (int yi = index.GetElement(1) - m_ComparisonRadius, yj = y - m_ComparisonRadius; yi <= index.GetElement(1) + m_ComparisonRadius; ++yi, ++yj)
+                  int jx = block.GetIndex()[0] + x + dx, jy = block.GetIndex()[1] + y + dy, jz = block.GetIndex()[2] + z + dz;
+                  if (!mask[v] || !inside(jx, jy, jz))
+                    continue;
+                  const TPixelType* pixelJ = pixel(jx, jy, jz);
+
+                  if (m_UseJointInformation)
                   {
-                    for (int zi = index.GetElement(2) - m_ComparisonRadius, zj = z - m_ComparisonRadius; zi <= index.GetElement(2) + m_ComparisonRadius; ++zi, ++zj)
+                    double size = patchSizes[v] * (numValues + 1);
+                    double distance = (patchDistances[v] / size) / m_Variance;
+                    if (distance > maxDistance)   // weight is zero
+                      continue;
+                    double w = std::exp( - distance);
+                    if (pass == 0)
+                    {
+                      summw[v] += w;
+                      continue;
+                    }
+
+                    double wn = w / summw[v];
+                    if (m_UseRicianAdaption)
+                    {
+                      for (int i = 0; i < numValues; ++i)
+                        sumj[v * numValues + i] += wn * (double)(pixelJ[i] * pixelJ[i]);
+                    }
+                    else
                     {
-                      typename InputIteratorType::IndexType indexI, indexJ;
-                      indexI.SetElement(0, xi);
-                      indexI.SetElement(1, yi);
-                      indexI.SetElement(2, zi);
-                      indexJ.SetElement(0, xj);
-                      indexJ.SetElement(1, yj);
-                      indexJ.SetElement(2, zj);
-                      // Compare neighborhoods ni & nj
-                      if (inputImagePointer->GetLargestPossibleRegion().IsInside(indexI) && inputImagePointer->GetLargestPossibleRegion().IsInside(indexJ))
-                      {
-                        typename InputImageType::PixelType diff = inputImagePointer->GetPixel(indexI) - inputImagePointer->GetPixel(indexJ);
-                        sumk += (double)(diff.GetSquaredNorm());
-                        ++size;
-                      }
+                      for (int i = 0; i < numValues; ++i)
+                        sumj[v * numValues + i] += wn * (double)pixelJ[i];
                     }
                   }
-                }
-                // weight all neighborhoods
-                size *= inputImagePointer->GetVectorLength() + 1;
-                w = std::exp( - (sumk / size) / m_Variance);
-                wj.push_back(w);
-                if (m_UseRicianAdaption)
-                {
-                  itk::VariableLengthVector <double> m;
-                  m.SetSize(inputImagePointer->GetVectorLength());
-                  for (unsigned int i = 0; i < inputImagePointer->GetVectorLength(); ++i)
+                  else
                   {
-                    double sp = (double)(pixelJ.GetElement(i) * pixelJ.GetElement(i));
-                    m.SetElement(i,sp);
+                    double size = patchSizes[v];
+                    for (int i = 0; i < numValues; ++i)
+                    {
+                      double distance = patchDistances[v * numChannels + i] / size / m_Variance;
+                      if (distance > maxDistance)   // weight is zero
+                        continue;
+                      double w = std::exp( - distance);
+                      if (pass == 0)
+                        summw[v * numChannels + i] += w;
+                      else if (m_UseRicianAdaption)
+                        sumj[v * numValues + i] += (w / summw[v * numChannels + i]) * (double)(pixelJ[i] * pixelJ[i]);
+                      else
+                        sumj[v * numValues + i] += (w / summw[v * numChannels + i]) * (double)pixelJ[i];
+                    }
                   }
-                  p.push_back(m);
-                }
-                else
-                  ++size;
-                {
-                  p.push_back(pixelJ);
                 }
-                Z += w;
               }
             }
           }
         }
-        for (unsigned int n = 0; n < wj.size(); ++n)
+      }
+    }
+  }
+
+  ImageRegionIterator< OutputImageType > oit(outputImage, block);
+  typename OutputImageType::PixelType outpix;
+  outpix.SetSize(numValues);
+  for (int v = 0; !oit.IsAtEnd(); ++oit, ++v)
+  {
+    outpix.Fill(0);
+    if (mask[v])
+    {
+      for (int i = 0; i < numValues; ++i)
+      {
+        double a = sumj[v * numValues + i];
+        if (m_UseRicianAdaption)
         {
-          sumj = sumj + ((wj[n]/Z) * p[n]);
+          a -= 2 * m_Variance;
         }
+        if (a < 0)
+        {
+          a = 0;
+        }
+        TPixelType outval;
         if (m_UseRicianAdaption)
         {
-          sumj = sumj - (2 * m_Variance);
+          outval = std::floor(std::sqrt(a) + 0.5);
         }
-
-        for (unsigned int i = 0; i < inputImagePointer->GetVectorLength(); ++i)
+        else
         {
-          double a = sumj.GetElement(i);
-          if (a < 0)
-          {
-            a = 0;
-          }
-          TPixelType outval;
-          if (m_UseRicianAdaption)
-          {
-            outval = std::floor(std::sqrt(a) + 0.5);
-          }
-          else
-          {
-            outval = std::floor(a + 0.5);
-          }
-          outpix.SetElement(i, outval);
+          outval = std::floor(a + 0.5);
         }
+        outpix.SetElement(i, outval);
       }
     }
-    else
-    {
-      outpix.Fill(0);
-    }
-
     oit.Set(outpix);
-    ++oit;
-    ++m_CurrentVoxelCount;
-    ++git;
-    ++mit;
   }
+  m_CurrentVoxelCount += numVoxels;
+}
 
-  MITK_INFO << "One Thread finished calculation";
+template< class TPixelType >
+void
+NonLocalMeansDenoisingFilter< TPixelType >
+::SumNeighborhoods(const std::vector< double >& input, const int inputSize[3], int axis, int numChannels, std::vector< double >& output)
+{
+  // running sum over 2 * m_ComparisonRadius + 1 values along the axis, the output is 2 * m_ComparisonRadius shorter along this axis
+  int window = 2 * m_ComparisonRadius + 1;
+  int outputSize[3] = { inputSize[0], inputSize[1], inputSize[2] };
+  outputSize[axis] -= window - 1;
+  output.resize(outputSize[0] * outputSize[1] * outputSize[2] * numChannels);
+
+  int inputStride[3] = { numChannels, inputSize[0] * numChannels, inputSize[0] * inputSize[1] * numChannels };
+  int outputStride[3] = { numChannels, outputSize[0] * numChannels, outputSize[0] * outputSize[1] * numChannels };
+  int a1 = (axis + 1) % 3, a2 = (axis + 2) % 3;
+
+  std::vector< double > sums(numChannels);
+  for (int i2 = 0; i2 < outputSize[a2]; ++i2)
+  {
+    for (int i1 = 0; i1 < outputSize[a1]; ++i1)
+    {
+      const double* in = &input[i1 * inputStride[a1] + i2 * inputStride[a2]];
+      double* out = &output[i1 * outputStride[a1] + i2 * outputStride[a2]];
+
+      std::fill(sums.begin(), sums.end(), 0.0);
+      for (int k = 0; k < window; ++k)
+        for (int c = 0; c < numChannels; ++c)
+          sums[c] += in[k * inputStride[axis] + c];
+      for (int c = 0; c < numChannels; ++c)
+        out[c] = sums[c];
+
+      for (int k = 1; k < outputSize[axis]; ++k)
+      {
+        const double* add = in + (k + window - 1) * inputStride[axis];
+        const double* sub = in + (k - 1) * inputStride[axis];
+        double* o = out + k * outputStride[axis];
+        for (int c = 0; c < numChannels; ++c)
+        {
+          sums[c] += add[c] - sub[c];
+          o[c] = sums[c];
+        }
+      }
+    }
+  }
 }
 
 template< class TPixelType >
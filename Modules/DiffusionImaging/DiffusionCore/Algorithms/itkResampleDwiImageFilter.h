@@ -75,6 +75,13 @@ public:
 
     itkSetMacro( Interpolation, Interpolation )
 
+    /** Number of slabs along z in which the output is computed. With more than one slab only the input slices needed
+     * for the current slab are copied into the temporary channel images, so the peak memory stays close to input plus
+     * output. Nearest neighbour and linear interpolation yield the same result as one slab, B-spline and windowed sinc
+     * interpolation differ slightly at slab borders. */
+    itkSetMacro( NumberOfStreamDivisions, unsigned int )
+    itkGetMacro( NumberOfStreamDivisions, unsigned int )
+
     void SetSamplingFactor(DoubleVectorType sampling)
     {
         m_NewSpacing = this->GetInput()->GetSpacing();
@@ -129,9 +136,13 @@ public:
 
     void GenerateData();
 
+    /** Input slices (full x-y extent) needed to interpolate the given output slab. */
+    ImageRegion<3> GetInputSlab(const DwiImageType* outImage, const ImageRegion<3>& outSlab);
+
     DoubleVectorType m_NewSpacing;
     ImageRegion<3>   m_NewImageRegion;
     Interpolation    m_Interpolation;
+    unsigned int     m_NumberOfStreamDivisions;
 };
 
 
@@ -43,6 +43,8 @@ PURPOSE.  See the above copyright notices for more information.
 #include <itkNearestNeighborInterpolateImageFunction.h>
 #include <itkLinearInterpolateImageFunction.h>
 #include <itkWindowedSincInterpolateImageFunction.h>
+#include <algorithm>
+#include <cmath>
 
 namespace itk
 {
@@ -51,6 +53,7 @@ template <class TScalarType>
 ResampleDwiImageFilter<TScalarType>
 ::ResampleDwiImageFilter()
     : m_Interpolation(Interpolate_Linear)
+    , m_NumberOfStreamDivisions(1)
 {
     this->SetNumberOfRequiredInputs( 1 );
 }
@@ -125,42 +128,100 @@ ResampleDwiImageFilter<TScalarType>
     }
     }
 
-    for (unsigned int i=0; i<this->GetInput()->GetVectorLength(); i++)
+    const DwiImageType* input = this->GetInput();
+    const unsigned int vectorLength = input->GetVectorLength();
+    const TScalarType* inBuffer = input->GetBufferPointer();
+    TScalarType* outBuffer = outImage->GetBufferPointer();
+
+    unsigned int numSlabs = std::max(1u, std::min(m_NumberOfStreamDivisions, (unsigned int)m_NewImageRegion.GetSize(2)));
+    for (unsigned int s=0; s<numSlabs; s++)
     {
+        // slabs cover whole slices, so they are contiguous in the image buffers
+        ImageRegion<3> outSlab = m_NewImageRegion;
+        unsigned int z0 = s*m_NewImageRegion.GetSize(2)/numSlabs;
+        unsigned int z1 = (s+1)*m_NewImageRegion.GetSize(2)/numSlabs;
+        outSlab.SetIndex(2, m_NewImageRegion.GetIndex(2) + z0);
+        outSlab.SetSize(2, z1-z0);
+
+        ImageRegion<3> inSlab = input->GetLargestPossibleRegion();
+        if (numSlabs>1)
+            inSlab = GetInputSlab(outImage, outSlab);
+
+        resampler->SetOutputStartIndex(outSlab.GetIndex());
+        resampler->SetSize(outSlab.GetSize());
+
         typename DwiChannelType::Pointer channel = DwiChannelType::New();
-        channel->SetSpacing( this->GetInput()->GetSpacing() );
-        channel->SetOrigin( this->GetInput()->GetOrigin() );
-        channel->SetDirection( this->GetInput()->GetDirection() );
-        channel->SetLargestPossibleRegion( this->GetInput()->GetLargestPossibleRegion() );
-        channel->SetBufferedRegion( this->GetInput()->GetLargestPossibleRegion() );
-        channel->SetRequestedRegion( this->GetInput()->GetLargestPossibleRegion() );
+        channel->SetSpacing( input->GetSpacing() );
+        channel->SetOrigin( input->GetOrigin() );
+        channel->SetDirection( input->GetDirection() );
+        channel->SetRegions( inSlab );
         channel->Allocate();
 
-        ImageRegionIterator<DwiChannelType> it(channel, channel->GetLargestPossibleRegion());
-        while(!it.IsAtEnd())
+        const TScalarType* inSlabBuffer = inBuffer + input->ComputeOffset(inSlab.GetIndex())*vectorLength;
+        TScalarType* outSlabBuffer = outBuffer + outImage->ComputeOffset(outSlab.GetIndex())*vectorLength;
+        TScalarType* channelBuffer = channel->GetBufferPointer();
+        unsigned long numInVoxels = inSlab.GetNumberOfPixels();
+        unsigned long numOutVoxels = outSlab.GetNumberOfPixels();
+
+        for (unsigned int i=0; i<vectorLength; i++)
         {
-            typename DwiImageType::PixelType pix = this->GetInput()->GetPixel(it.GetIndex());
-            it.Set(pix[i]);
-            ++it;
-        }
+            for (unsigned long v=0; v<numInVoxels; v++)
+                channelBuffer[v] = inSlabBuffer[v*vectorLength+i];
+            channel->Modified();
 
-        resampler->SetInput(channel);
-        resampler->Update();
-        channel = resampler->GetOutput();
+            resampler->SetInput(channel);
+            resampler->Update();
 
-        ImageRegionIterator<DwiImageType> it2(outImage, outImage->GetLargestPossibleRegion());
-        while(!it2.IsAtEnd())
-        {
-            typename DwiImageType::PixelType pix = it2.Get();
-            pix[i] = channel->GetPixel(it2.GetIndex());
-            it2.Set(pix);
-            ++it2;
+            const TScalarType* resampled = resampler->GetOutput()->GetBufferPointer();
+            for (unsigned long v=0; v<numOutVoxels; v++)
+                outSlabBuffer[v*vectorLength+i] = resampled[v];
         }
     }
 
     this->SetNthOutput(0, outImage);
 }
 
+template <class TScalarType>
+ImageRegion<3>
+ResampleDwiImageFilter<TScalarType>
+::GetInputSlab(const DwiImageType* outImage, const ImageRegion<3>& outSlab)
+{
+    // support of the interpolation kernel in voxels, B-spline coefficients depend on the whole image and decay quickly
+    int padding = 1;
+    if (m_Interpolation==Interpolate_BSpline)
+        padding = 8;
+    else if (m_Interpolation==Interpolate_WindowedSinc)
+        padding = 4;
+
+    const DwiImageType* input = this->GetInput();
+    double minZ = itk::NumericTraits<double>::max();
+    double maxZ = itk::NumericTraits<double>::NonpositiveMin();
+    for (int c=0; c<8; c++)
+    {
+        itk::ContinuousIndex<double, 3> corner;
+        for (int d=0; d<3; d++)
+            corner[d] = outSlab.GetIndex(d) - 0.5 + ((c>>d)&1)*outSlab.GetSize(d);
+
+        itk::Point<double, 3> point;
+        outImage->TransformContinuousIndexToPhysicalPoint(corner, point);
+        itk::ContinuousIndex<double, 3> inIndex;
+        input->TransformPhysicalPointToContinuousIndex(point, inIndex);
+        minZ = std::min(minZ, inIndex[2]);
+        maxZ = std::max(maxZ, inIndex[2]);
+    }
+
+    ImageRegion<3> inRegion = input->GetLargestPossibleRegion();
+    long first = inRegion.GetIndex(2);
+    long last = first + (long)inRegion.GetSize(2) - 1;
+    long z0 = std::max(first, std::min(last, (long)std::floor(minZ) - padding));
+    long z1 = std::max(first, std::min(last, (long)std::ceil(maxZ) + padding));
+
+    ImageRegion<3> inSlab = inRegion;
+    inSlab.SetIndex(2, z0);
+    inSlab.SetSize(2, z1-z0+1);
+    return inSlab;
+}
+
 template <class TScalarType>
 void
 ResampleDwiImageFilter<TScalarType>
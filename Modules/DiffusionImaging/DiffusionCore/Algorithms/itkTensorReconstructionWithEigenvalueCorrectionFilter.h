@@ -132,6 +132,10 @@ namespace itk
       return m_MaskImage;
     }
 
+    /** Number of voxels reconstructed together with a single matrix-matrix product (default 512) */
+    itkSetMacro( VoxelBlockSize, unsigned int )
+    itkGetMacro( VoxelBlockSize, unsigned int )
+
 
   protected:
 
@@ -139,7 +143,12 @@ namespace itk
     ~TensorReconstructionWithEigenvalueCorrectionFilter() {}
 
 
-    void GenerateData();
+    /** Estimates the design matrix and iteratively corrects the diffusion
+    * volumes for voxels with negative tensor eigenvalues. */
+    void BeforeThreadedGenerateData();
+
+    /** Final tensor reconstruction of the corrected diffusion volumes */
+    void ThreadedGenerateData( const OutputImageRegionType &outputRegionForThread, ThreadIdType);
 
 
     typedef enum
@@ -163,7 +172,10 @@ namespace itk
     void CorrectDiffusionImage(int nof,int numberb0,itk::Size<3> size,typename GradientImagesType::Pointer corrected_diffusion,itk::Image<short, 3>::Pointer mask,vnl_vector< double> pixel_max,vnl_vector< double> pixel_min);
 
     /** Calculte a tensor iamge from a diffusion data set*/
-    void GenerateTensorImage(int nof,int numberb0,itk::Size<3> size,itk::VectorImage<short, 3>::Pointer corrected_diffusion,itk::Image<short, 3>::Pointer mask,double what_mask, typename itk::Image< itk::DiffusionTensor3D<TTensorPixelType>, 3 >::Pointer tensorImg );
+    void GenerateTensorImage(int nof,int numberb0,itk::Size<3> size,typename GradientImagesType::Pointer corrected_diffusion,itk::Image<short, 3>::Pointer mask,double what_mask, typename itk::Image< itk::DiffusionTensor3D<TTensorPixelType>, 3 >::Pointer tensorImg );
+
+    /** Reconstructs the tensors of all voxels in the region with mask value > 0 blockwise, i.e. with one matrix-matrix product per block of voxels. Voxels with mask value 0 are set to zero. */
+    void ReconstructTensors(const OutputImageRegionType& region, GradientImagesType* corrected_diffusion, itk::Image<short, 3>* mask, TensorImageType* tensorImg, double scale);
 
     //void DeepCopyTensorImage(itk::Image< itk::DiffusionTensor3D<double>, 3 >::Pointer tensorImg, itk::Image< itk::DiffusionTensor3D<double>, 3 >::Pointer temp_tensorImg);
 
@@ -214,6 +226,9 @@ namespace itk
     /** volumes of the diffusion data set */
     typename GradientImagesType::Pointer m_GradientImagePointer;
 
+    /** number of voxels gathered into one attenuation matrix */
+    unsigned int m_VoxelBlockSize;
+
   };
 
 
@@ -21,6 +21,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "itkImageFileWriter.h"
 #include "itkImage.h"
 #include "itkImageRegionIterator.h"
+#include <algorithm>
 
 namespace itk
 {
@@ -30,12 +31,13 @@ TensorReconstructionWithEigenvalueCorrectionFilter<TDiffusionPixelType, TTensorP
 ::TensorReconstructionWithEigenvalueCorrectionFilter()
 {
   m_B0Threshold = 50.0;
+  m_VoxelBlockSize = 512;
 }
 
 template <class TDiffusionPixelType, class TTensorPixelType>
 void
 TensorReconstructionWithEigenvalueCorrectionFilter<TDiffusionPixelType, TTensorPixelType>
-::GenerateData ()
+::BeforeThreadedGenerateData()
 {
 
   m_GradientImagePointer = static_cast< GradientImagesType * >( this->ProcessObject::GetInput(0) );
@@ -349,33 +351,118 @@ TensorReconstructionWithEigenvalueCorrectionFilter<TDiffusionPixelType, TTensorP
   // eigenvalues are still negative
   TurnMask(size, mask,1,1);
 
-  // Generation of final pre-processed tensor image that might be used as an input for FWE method
+  m_MaskImage = mask;
+}
 
-  // Final Tensor Reconstruction
-  std::cout << "Final tensors " << std::endl;
-  GenerateTensorImage(nof,numberb0,size,m_GradientImagePointer,mask,what_mask,tensorImg);
+template <class TDiffusionPixelType, class TTensorPixelType>
+void
+TensorReconstructionWithEigenvalueCorrectionFilter<TDiffusionPixelType, TTensorPixelType>
+::ThreadedGenerateData(const OutputImageRegionType& outputRegionForThread, ThreadIdType)
+{
+  // Generation of final pre-processed tensor image that might be used as an input for FWE method.
+  // Diffusivities are changed to the standard convention (division by 1000).
+  typename OutputType::Pointer outputImage = static_cast< OutputType * >(this->ProcessObject::GetPrimaryOutput());
+  ReconstructTensors(outputRegionForThread, m_GradientImagePointer, m_MaskImage, outputImage, 1.0/1000.0);
+}
 
-  m_MaskImage = mask;
+template <class TDiffusionPixelType, class TTensorPixelType>
+void
+TensorReconstructionWithEigenvalueCorrectionFilter<TDiffusionPixelType, TTensorPixelType>
+::ReconstructTensors(const OutputImageRegionType& region, GradientImagesType* corrected_diffusion, itk::Image<short, 3>* mask, TensorImageType* tensorImg, double scale)
+{
+  int nof = m_B0Mask.size();
+  int numberb0 = 0;
+  for (int i=0;i<nof;i++)
+  {
+    if(m_B0Mask[i]>0)
+    {
+      numberb0++;
+    }
+  }
 
+  // the log attenuations of up to blockSize voxels are gathered column-wise so that
+  // the tensors of the whole block are obtained with a single product with the pseudoinverse
+  const unsigned int blockSize = std::max(1u, m_VoxelBlockSize);
+  vnl_matrix<double> atten(nof-numberb0, blockSize);
+  std::vector<int> columns(blockSize);
 
+  itk::ImageRegionConstIterator<GradientImagesType> git(corrected_diffusion, region);
+  itk::ImageRegionConstIterator< itk::Image<short, 3> > mit(mask, region);
+  itk::ImageRegionIterator<TensorImageType> oit(tensorImg, region);
 
-  // Change diffusivity representation to standard convention
-  itk::ImageRegionIterator<OutputType> outputIterator(tensorImg, tensorImg->GetLargestPossibleRegion());
-  outputIterator.GoToBegin();
-  while(!outputIterator.IsAtEnd())
+  while( !git.IsAtEnd() )
+  {
+    unsigned int numVoxels = 0;
+    unsigned int numValid = 0;
+    while( !git.IsAtEnd() && numVoxels<blockSize )
     {
-    TensorPixelType tens = outputIterator.Get();
+      columns[numVoxels] = -1;
 
-    tens/= 1000.0;
+      //Tensors are calculated only for voxels above theshold for B0 image.
+      if( mit.Get() > 0 )
+      {
+        // calculation of attenuation with use of gradient image and mean B0 image
+        GradientVectorType pt = git.Get();
 
-    outputIterator.Set(tens);
-    ++outputIterator;
-    }
+        double mean_b=0.0;
+        for (int i=0;i<nof;i++)
+        {
+          if(m_B0Mask[i]>0)
+          {
+            mean_b=mean_b+pt[i];
+          }
+        }
+        mean_b=mean_b/numberb0;
 
-  this->SetNthOutput(0, tensorImg);
-}
+        int cnt=0;
+        for (int i=0;i<nof;i++)
+        {
+          if(m_B0Mask[i]==0)
+          {
+            double val = pt[i];
+            if (val <= 0)
+            {
+              val = 0.1;
+            }
+            atten(cnt, numValid) = log(val/mean_b);
+            cnt++;
+          }
+        }
 
+        columns[numVoxels] = numValid;
+        numValid++;
+      }
 
+      ++numVoxels;
+      ++git;
+      ++mit;
+    }
+
+    // Calculation of tensors with use of previously calculated inverse of design matrix and attenuations
+    vnl_matrix<double> tensors;
+    if (numValid>0)
+      tensors = m_PseudoInverse * atten.extract(nof-numberb0, numValid);
+
+    for (unsigned int v=0; v<numVoxels; v++)
+    {
+      // for voxels with mask value 0 - tensor is simply 0 ( outside brain value)
+      TensorPixelType ten;
+      ten.Fill(0);
+      if (columns[v]>=0)
+      {
+        int c = columns[v];
+        ten(0,0) = tensors(0,c)*scale;
+        ten(0,1) = tensors(3,c)*scale;
+        ten(0,2) = tensors(5,c)*scale;
+        ten(1,1) = tensors(1,c)*scale;
+        ten(1,2) = tensors(4,c)*scale;
+        ten(2,2) = tensors(2,c)*scale;
+      }
+      oit.Set(ten);
+      ++oit;
+    }
+  }
+}
 
 template <class TDiffusionPixelType, class TTensorPixelType>
 void
@@ -824,128 +911,10 @@ TensorReconstructionWithEigenvalueCorrectionFilter<TDiffusionPixelType, TTensorP
 template <class TDiffusionPixelType, class TTensorPixelType>
 void
 TensorReconstructionWithEigenvalueCorrectionFilter<TDiffusionPixelType, TTensorPixelType>
-::GenerateTensorImage(int nof,int numberb0,itk::Size<3> size,itk::VectorImage<short, 3>::Pointer corrected_diffusion,itk::Image<short, 3>::Pointer mask,double what_mask, typename itk::Image< itk::DiffusionTensor3D<TTensorPixelType>, 3 >::Pointer tensorImg)
+::GenerateTensorImage(int ,int ,itk::Size<3> ,typename GradientImagesType::Pointer corrected_diffusion,itk::Image<short, 3>::Pointer mask,double , typename itk::Image< itk::DiffusionTensor3D<TTensorPixelType>, 3 >::Pointer tensorImg)
 {
   // in this method the whole tensor image is updated with a tensors for defined voxels ( defined by a value of mask);
-
-
-  itk::Index<3> ix;
-
-  itk::Index<3> idx;
-  idx.Fill(5);
-
-  vnl_vector<double> org_data(nof);
-  vnl_vector<double> atten(nof-numberb0);
-  vnl_vector<double> tensor(6);
-  itk::DiffusionTensor3D<double> ten;
-  double mask_val=0;
-
-
-  for (unsigned int x=0;x<size[0];x++)
-  {
-
-    for (unsigned int y=0;y<size[1];y++)
-    {
-
-      for (unsigned int z=0;z<size[2];z++)
-      {
-
-
-        ix[0] = x; ix[1] = y; ix[2] = z;
-
-        mask_val= mask->GetPixel(ix);
-
-        //Tensors are calculated only for voxels above theshold for B0 image.
-
-        if( mask_val > 0.0 )
-        {
-
-          // calculation of attenuation with use of gradient image and  and mean B0 image
-          GradientVectorType pt = corrected_diffusion->GetPixel(ix);
-
-          for (int i=0;i<nof;i++)
-          {
-            org_data[i]=pt[i];
-          }
-
-          double mean_b=0.0;
-
-          for (int i=0;i<nof;i++)
-          {
-            if(m_B0Mask[i]>0)
-            {
-              mean_b=mean_b+org_data[i];
-            }
-
-          }
-          mean_b=mean_b/numberb0;
-          int cnt=0;
-          for (int i=0;i<nof;i++)
-          {
-            if (org_data[i]<= 0)
-
-            {
-              org_data[i]=0.1;
-            }
-            if(m_B0Mask[i]==0)
-            {
-              atten[cnt]=org_data[i]/mean_b;
-              cnt++;
-            }
-          }
-
-
-
-
-          for (int i=0;i<nof-numberb0;i++)
-          {
-
-            atten[i]=log((double)atten[i]);
-          }
-
-          // Calculation of tensor with use of previously calculated inverse of design matrix and attenuation
-          tensor = m_PseudoInverse*atten;
-
-          ten(0,0) = tensor[0];
-          ten(0,1) = tensor[3];
-          ten(0,2) = tensor[5];
-          ten(1,1) = tensor[1];
-          ten(1,2) = tensor[4];
-          ten(2,2) = tensor[2];
-
-          tensorImg->SetPixel(ix, ten);
-
-
-
-        }
-        // for voxels with mask value 0 - tensor is simply 0 ( outside brain value)
-        else if (mask_val < 1.0)
-        {
-
-          ten(0,0) = 0;
-          ten(0,1) = 0;
-          ten(0,2) = 0;
-          ten(1,1) = 0;
-          ten(1,2) = 0;
-          ten(2,2) = 0;
-          tensorImg->SetPixel(ix, ten);
-        }
-
-        if (ix == idx)
-        {
-          for (int ll = 0; ll < 6 ; ll++)
-          std::cout << tensor[ll] << "," << std::endl;
-        }
-
-
-
-
-      }
-    }
-  }
-
-
-
+  ReconstructTensors(tensorImg->GetLargestPossibleRegion(), corrected_diffusion, mask, tensorImg, 1.0);
 }// end of Generate Tensor
 
 
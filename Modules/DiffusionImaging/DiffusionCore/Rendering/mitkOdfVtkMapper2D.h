@@ -32,11 +32,19 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "vtkOdfSource.h"
 #include "vtkThickPlane.h"
 
+#include <map>
+#include <vector>
+
 namespace mitk {
 
 //##Documentation
 //## @brief Mapper for spherical object densitiy function representations
 //##
+//## The glyphs are built from the tessellated sphere of the ODF type (shared template), only the radii and colors
+//## are computed per voxel and cached per renderer until the image or the glyph properties change. Only voxels
+//## inside of the displayed area are glyphed. If more than "ShowMaxNumber" voxels are visible, only every n-th voxel
+//## in both directions is shown, and with "LevelOfDetail" enabled these glyphs are enlarged to fill the gaps.
+//##
 template<class TPixelType, int NrOdfDirections>
 class OdfVtkMapper2D : public VtkMapper
 {
@@ -91,11 +99,48 @@ public:
     {
     public:
 
+        /** Radii and cell colors of the glyph of one voxel */
+        struct OdfGlyph
+        {
+            std::vector< float >  radii;    ///< radius of each template point
+            std::vector< float >  colors;   ///< scalar of each template cell
+        };
+
+        /** Everything the cached glyphs depend on */
+        struct GlyphSettings
+        {
+            vtkImageData*   image;
+            unsigned long   imageMTime;
+            int             normalization;
+            int             scaleBy;
+            float           scaling;
+            float           indexParam1;
+            float           indexParam2;
+            double          additionalScale;
+
+            bool Equals(const GlyphSettings& other) const
+            {
+                return other.image == image &&
+                        other.imageMTime == imageMTime &&
+                        other.normalization == normalization &&
+                        other.scaleBy == scaleBy &&
+                        other.scaling == scaling &&
+                        other.indexParam1 == indexParam1 &&
+                        other.indexParam2 == indexParam2 &&
+                        other.additionalScale == additionalScale;
+            }
+        };
+
         std::vector< vtkSmartPointer<vtkPropAssembly> >       m_PropAssemblies;
         std::vector< vtkSmartPointer<vtkAppendPolyData> >     m_OdfsPlanes;
         std::vector< vtkSmartPointer<vtkActor> >              m_OdfsActors;
         std::vector< vtkSmartPointer<vtkPolyDataMapper> >     m_OdfsMappers;
         vtkSmartPointer< vtkPolyData >                        m_TemplateOdf;
+        std::vector< vtkIdType >                              m_TemplateCells;    ///< point count followed by the point ids of each template cell
+
+        std::map< vtkIdType, OdfGlyph >     m_GlyphCache;       ///< glyphs by voxel index
+        GlyphSettings                       m_GlyphSettings;
+        unsigned int                        m_MaxCachedGlyphs;  ///< the cache is cleared when it grows beyond this size
 
         itk::TimeStamp                      m_LastUpdateTime;
 
@@ -112,28 +157,26 @@ protected:
     OdfVtkMapper2D();
     virtual ~OdfVtkMapper2D();
 
-    static void GlyphMethod(void *arg);
     bool IsPlaneRotated(mitk::BaseRenderer* renderer);
 
+    /** Returns the cached glyph of the voxel or computes it from the ODF (or tensor) of the voxel */
+    const typename LocalStorage::OdfGlyph& GetGlyph(LocalStorage* localStorage, vtkIdType voxel);
+
 private:
 
+    typedef itk::OrientationDistributionFunction<float,N> OdfType;
+
     mitk::Image* GetInput();
 
-    static vtkSmartPointer<vtkTransform> m_OdfTransform;
-    static vtkSmartPointer<vtkOdfSource> m_OdfSource;
-    static float    m_Scaling;
-    static int      m_Normalization;
-    static int      m_ScaleBy;
-    static float    m_IndexParam1;
-    static float    m_IndexParam2;
+    float           m_Scaling;
+    int             m_Normalization;
+    int             m_ScaleBy;
+    float           m_IndexParam1;
+    float           m_IndexParam2;
+    double          m_AdditionalScale;
     int             m_ShowMaxNumber;
+    bool            m_LevelOfDetail;
 
-    std::vector< vtkSmartPointer<vtkPlane> >          m_Planes;
-    std::vector< vtkSmartPointer<vtkCutter> >         m_Cutters;
-    std::vector< vtkSmartPointer<vtkThickPlane> >     m_ThickPlanes1;
-    std::vector< vtkSmartPointer<vtkClipPolyData> >  m_Clippers1;
-    std::vector< vtkSmartPointer<vtkThickPlane> >     m_ThickPlanes2;
-    std::vector< vtkSmartPointer<vtkClipPolyData> >  m_Clippers2;
     vtkImageData*                   m_VtkImage ;
     OdfDisplayGeometry              m_LastDisplayGeometry;
     mitk::LocalStorageHandler<LocalStorage> m_LSH;
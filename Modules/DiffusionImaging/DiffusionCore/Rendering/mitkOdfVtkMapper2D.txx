@@ -31,26 +31,21 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 #include "vtkSphereSource.h"
 #include "vtkPropCollection.h"
-#include "vtkMaskedGlyph3D.h"
-#include "vtkGlyph2D.h"
-#include "vtkGlyph3D.h"
-#include "vtkMaskedProgrammableGlyphFilter.h"
 #include "vtkImageData.h"
 #include "vtkLinearTransform.h"
 #include "vtkCamera.h"
 #include "vtkPointData.h"
-#include "vtkTransformPolyDataFilter.h"
 #include "vtkTransform.h"
 #include "vtkOdfSource.h"
 #include "vtkDoubleArray.h"
 #include "vtkLookupTable.h"
 #include "vtkProperty.h"
-#include "vtkPolyDataNormals.h"
 #include "vtkLight.h"
 #include "vtkLightCollection.h"
 #include "vtkMath.h"
 #include "vtkFloatArray.h"
-#include "vtkDelaunay2D.h"
+#include "vtkCellArray.h"
+#include "vtkPoints.h"
 #include "vtkMapper.h"
 
 #include "vtkRenderer.h"
@@ -64,27 +59,8 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 #define _USE_MATH_DEFINES
 #include <math.h>
-
-template<class T, int N>
-vtkSmartPointer<vtkTransform> mitk::OdfVtkMapper2D<T,N>::m_OdfTransform = vtkSmartPointer<vtkTransform>::New();
-
-template<class T, int N>
-vtkSmartPointer<vtkOdfSource> mitk::OdfVtkMapper2D<T,N>::m_OdfSource = vtkSmartPointer<vtkOdfSource>::New();
-
-template<class T, int N>
-float mitk::OdfVtkMapper2D<T,N>::m_Scaling;
-
-template<class T, int N>
-int mitk::OdfVtkMapper2D<T,N>::m_Normalization;
-
-template<class T, int N>
-int mitk::OdfVtkMapper2D<T,N>::m_ScaleBy;
-
-template<class T, int N>
-float mitk::OdfVtkMapper2D<T,N>::m_IndexParam1;
-
-template<class T, int N>
-float mitk::OdfVtkMapper2D<T,N>::m_IndexParam2;
+#include <algorithm>
+#include <limits>
 
 #define ODF_MAPPER_PI M_PI
 
@@ -125,57 +101,37 @@ mitk::OdfVtkMapper2D<T,N>::LocalStorage::LocalStorage()
     m_OdfsActors[0]->SetMapper(m_OdfsMappers[0]);
     m_OdfsActors[1]->SetMapper(m_OdfsMappers[1]);
     m_OdfsActors[2]->SetMapper(m_OdfsMappers[2]);
+
+    // all glyphs share the tessellated sphere of the ODF directions
+    m_TemplateOdf = itk::OrientationDistributionFunction<float,N>::GetBaseMesh();
+    vtkCellArray* polys = m_TemplateOdf->GetPolys();
+    vtkIdType npts; vtkIdType *pts;
+    polys->InitTraversal();
+    while(polys->GetNextCell(npts,pts))
+    {
+        m_TemplateCells.push_back(npts);
+        for(int i=0; i<npts; i++)
+            m_TemplateCells.push_back(pts[i]);
+    }
+
+    m_GlyphSettings.image = NULL;
+    m_GlyphSettings.imageMTime = 0;
+    m_MaxCachedGlyphs = 10000;
 }
 
 template<class T, int N>
 mitk::OdfVtkMapper2D<T,N>
 ::OdfVtkMapper2D()
+    : m_Scaling(1)
+    , m_Normalization(ODFN_MINMAX)
+    , m_ScaleBy(ODFSB_NONE)
+    , m_IndexParam1(2)
+    , m_IndexParam2(1)
+    , m_AdditionalScale(1)
+    , m_ShowMaxNumber(500)
+    , m_LevelOfDetail(true)
+    , m_VtkImage(NULL)
 {
-
-    m_Planes.push_back(vtkPlane::New());
-    m_Planes.push_back(vtkPlane::New());
-    m_Planes.push_back(vtkPlane::New());
-
-    m_Cutters.push_back(vtkCutter::New());
-    m_Cutters.push_back(vtkCutter::New());
-    m_Cutters.push_back(vtkCutter::New());
-
-    m_Cutters[0]->SetCutFunction( m_Planes[0] );
-    m_Cutters[0]->GenerateValues( 1, 0, 1 );
-
-    m_Cutters[1]->SetCutFunction( m_Planes[1] );
-    m_Cutters[1]->GenerateValues( 1, 0, 1 );
-
-    m_Cutters[2]->SetCutFunction( m_Planes[2] );
-    m_Cutters[2]->GenerateValues( 1, 0, 1 );
-
-    // Windowing the cutted planes in direction 1
-    m_ThickPlanes1.push_back(vtkThickPlane::New());
-    m_ThickPlanes1.push_back(vtkThickPlane::New());
-    m_ThickPlanes1.push_back(vtkThickPlane::New());
-
-    m_Clippers1.push_back(vtkClipPolyData::New());
-    m_Clippers1.push_back(vtkClipPolyData::New());
-    m_Clippers1.push_back(vtkClipPolyData::New());
-
-    m_Clippers1[0]->SetClipFunction( m_ThickPlanes1[0] );
-    m_Clippers1[1]->SetClipFunction( m_ThickPlanes1[1] );
-    m_Clippers1[2]->SetClipFunction( m_ThickPlanes1[2] );
-
-    // Windowing the cutted planes in direction 2
-    m_ThickPlanes2.push_back(vtkThickPlane::New());
-    m_ThickPlanes2.push_back(vtkThickPlane::New());
-    m_ThickPlanes2.push_back(vtkThickPlane::New());
-
-    m_Clippers2.push_back(vtkClipPolyData::New());
-    m_Clippers2.push_back(vtkClipPolyData::New());
-    m_Clippers2.push_back(vtkClipPolyData::New());
-
-    m_Clippers2[0]->SetClipFunction( m_ThickPlanes2[0] );
-    m_Clippers2[1]->SetClipFunction( m_ThickPlanes2[1] );
-    m_Clippers2[2]->SetClipFunction( m_ThickPlanes2[2] );
-
-    m_ShowMaxNumber = 500;
 }
 
 template<class T, int N>
@@ -217,46 +173,27 @@ int  mitk::OdfVtkMapper2D<T,N>
 }
 
 template<class T, int N>
-void  mitk::OdfVtkMapper2D<T,N>
-::GlyphMethod(void *arg)
+const typename mitk::OdfVtkMapper2D<T,N>::LocalStorage::OdfGlyph& mitk::OdfVtkMapper2D<T,N>
+::GetGlyph(LocalStorage* localStorage, vtkIdType voxel)
 {
-    vtkMaskedProgrammableGlyphFilter* pfilter=(vtkMaskedProgrammableGlyphFilter*)arg;
-
-    double point[3];
-    double debugpoint[3];
-    pfilter->GetPoint(point);
-    pfilter->GetPoint(debugpoint);
-
-    itk::Point<double,3> p(point);
-    Vector3D spacing = pfilter->GetGeometry()->GetSpacing();
-    p[0] /= spacing[0];
-    p[1] /= spacing[1];
-    p[2] /= spacing[2];
-
-    mitk::Point3D p2;
-    pfilter->GetGeometry()->IndexToWorld( p, p2 );
-    point[0] = p2[0];
-    point[1] = p2[1];
-    point[2] = p2[2];
-
-    vtkPointData* data = pfilter->GetPointData();
-    vtkDataArray* odfvals = data->GetArray("vector");
-    vtkIdType id = pfilter->GetPointId();
-    m_OdfTransform->Identity();
-    m_OdfTransform->Translate(point[0],point[1],point[2]);
-
-    typedef itk::OrientationDistributionFunction<float,N> OdfType;
-    OdfType odf;
+    typename std::map< vtkIdType, typename LocalStorage::OdfGlyph >::iterator it = localStorage->m_GlyphCache.find(voxel);
+    if (it!=localStorage->m_GlyphCache.end())
+        return it->second;
+
+    if (localStorage->m_GlyphCache.size()>=localStorage->m_MaxCachedGlyphs)
+        localStorage->m_GlyphCache.clear();
 
+    vtkDataArray* odfvals = m_VtkImage->GetPointData()->GetArray("vector");
+    OdfType odf;
     if(odfvals->GetNumberOfComponents()==6)
     {
         float tensorelems[6] = {
-            (float)odfvals->GetComponent(id,0),
-            (float)odfvals->GetComponent(id,1),
-            (float)odfvals->GetComponent(id,2),
-            (float)odfvals->GetComponent(id,3),
-            (float)odfvals->GetComponent(id,4),
-            (float)odfvals->GetComponent(id,5),
+            (float)odfvals->GetComponent(voxel,0),
+            (float)odfvals->GetComponent(voxel,1),
+            (float)odfvals->GetComponent(voxel,2),
+            (float)odfvals->GetComponent(voxel,3),
+            (float)odfvals->GetComponent(voxel,4),
+            (float)odfvals->GetComponent(voxel,5),
         };
         itk::DiffusionTensor3D<float> tensor(tensorelems);
         odf.InitFromTensor(tensor);
@@ -264,25 +201,55 @@ void  mitk::OdfVtkMapper2D<T,N>
     else
     {
         for(int i=0; i<N; i++)
-            odf[i] = (double)odfvals->GetComponent(id,i);
+            odf[i] = (double)odfvals->GetComponent(voxel,i);
     }
 
+    double scale = m_Scaling;
     switch(m_ScaleBy)
     {
-    case ODFSB_NONE:
-        m_OdfSource->SetScale(m_Scaling);
-        break;
     case ODFSB_GFA:
-        m_OdfSource->SetScale(m_Scaling*odf.GetGeneralizedGFA(m_IndexParam1, m_IndexParam2));
+        scale = m_Scaling*odf.GetGeneralizedGFA(m_IndexParam1, m_IndexParam2);
         break;
     case ODFSB_PC:
-        m_OdfSource->SetScale(m_Scaling*odf.GetPrincipleCurvature(m_IndexParam1, m_IndexParam2, 0));
+        scale = m_Scaling*odf.GetPrincipleCurvature(m_IndexParam1, m_IndexParam2, 0);
+        break;
+    }
+
+    // same normalization and coloring as vtkOdfSource
+    OdfType colorOdf;
+    switch(m_Normalization)
+    {
+    case ODFN_MINMAX:
+        odf = odf.MinMaxNormalize();
+        colorOdf = odf;
+        break;
+    case ODFN_MAX:
+        odf = odf.MaxNormalize();
+        colorOdf = odf;
+        break;
+    case ODFN_NONE:
+        colorOdf = odf.MaxNormalize();
         break;
+    default:
+        odf = odf.MinMaxNormalize();
+        colorOdf = odf;
     }
 
-    m_OdfSource->SetNormalization(m_Normalization);
-    m_OdfSource->SetOdf(odf);
-    m_OdfSource->Modified();
+    typename LocalStorage::OdfGlyph& glyph = localStorage->m_GlyphCache[voxel];
+    glyph.radii.resize(N);
+    for(int j=0; j<N; j++)
+        glyph.radii[j] = odf.GetElement(j)*scale*m_AdditionalScale*0.5;
+
+    const std::vector< vtkIdType >& cells = localStorage->m_TemplateCells;
+    for(unsigned int c=0; c<cells.size(); c+=cells[c]+1)
+    {
+        double val = 0;
+        for(int i=1; i<=cells[c]; i++)
+            val += colorOdf.GetElement(cells[c+i]);
+        val /= cells[c];
+        glyph.colors.push_back(1-val);
+    }
+    return glyph;
 }
 
 template<class T, int N>
@@ -408,218 +375,163 @@ void  mitk::OdfVtkMapper2D<T,N>
     // thus the normal also must be axis align, since
     // we do not allow arbitrary cutting through volume
     //
-    // vnormal should already be axis align, but in order
-    // to get rid of precision effects, we set the two smaller
-    // components to zero here
+    // the slice is given by the largest component of the normal
     int dims[3];
     m_VtkImage->GetDimensions(dims);
     double spac[3];
     m_VtkImage->GetSpacing(spac);
-    if(fabs(dispGeo.vnormal[0]) > fabs(dispGeo.vnormal[1])
-            && fabs(dispGeo.vnormal[0]) > fabs(dispGeo.vnormal[2]) )
-    {
-        if(fabs(dispGeo.vp[0]/spac[0]) < 0.4)
-            dispGeo.vp[0] = 0.4*spac[0];
-        if(fabs(dispGeo.vp[0]/spac[0]) > (dims[0]-1)-0.4)
-            dispGeo.vp[0] = ((dims[0]-1)-0.4)*spac[0];
-        dispGeo.vnormal[1] = 0;
-        dispGeo.vnormal[2] = 0;
-    }
+    int axis = 0;
+    if(fabs(dispGeo.vnormal[1]) > fabs(dispGeo.vnormal[axis]))
+        axis = 1;
+    if(fabs(dispGeo.vnormal[2]) > fabs(dispGeo.vnormal[axis]))
+        axis = 2;
 
-    if(fabs(dispGeo.vnormal[1]) > fabs(dispGeo.vnormal[0]) && fabs(dispGeo.vnormal[1]) > fabs(dispGeo.vnormal[2]) )
-    {
-        if(fabs(dispGeo.vp[1]/spac[1]) < 0.4)
-            dispGeo.vp[1] = 0.4*spac[1];
-        if(fabs(dispGeo.vp[1]/spac[1]) > (dims[1]-1)-0.4)
-            dispGeo.vp[1] = ((dims[1]-1)-0.4)*spac[1];
-        dispGeo.vnormal[0] = 0;
-        dispGeo.vnormal[2] = 0;
-    }
+    int minIndex[3], maxIndex[3];
+    minIndex[axis] = maxIndex[axis] = std::max(0, std::min(dims[axis]-1, (int)floor(dispGeo.vp[axis]/spac[axis]+0.5)));
 
-    if(fabs(dispGeo.vnormal[2]) > fabs(dispGeo.vnormal[1]) && fabs(dispGeo.vnormal[2]) > fabs(dispGeo.vnormal[0]) )
+    // view frustum culling: only the voxels inside of the displayed area are glyphed
+    //
+    //  |------O------|
+    //  |             |
+    //  L      M      |
+    //  |             |
+    //  |-------------|
+    //
+    double lower[3] = { std::numeric_limits<double>::max(), std::numeric_limits<double>::max(), std::numeric_limits<double>::max() };
+    double upper[3] = { -std::numeric_limits<double>::max(), -std::numeric_limits<double>::max(), -std::numeric_limits<double>::max() };
+    for (int c=0; c<4; c++)
     {
-        if(fabs(dispGeo.vp[2]/spac[2]) < 0.4)
-            dispGeo.vp[2] = 0.4*spac[2];
-        if(fabs(dispGeo.vp[2]/spac[2]) > (dims[2]-1)-0.4)
-            dispGeo.vp[2] = ((dims[2]-1)-0.4)*spac[2];
-        dispGeo.vnormal[0] = 0;
-        dispGeo.vnormal[1] = 0;
+        double sx = (c%2==0) ? 1 : -1;
+        double sy = (c<2) ? 1 : -1;
+        double corner[3];
+        for (int i=0; i<3; i++)
+            corner[i] = dispGeo.M3D[i] + sx*(dispGeo.M3D[i]-dispGeo.L3D[i]) + sy*(dispGeo.O3D[i]-dispGeo.M3D[i]);
+        inversetransform->TransformPoint( corner, corner );
+        for (int i=0; i<3; i++)
+        {
+            lower[i] = std::min(lower[i], corner[i]/spac[i]);
+            upper[i] = std::max(upper[i], corner[i]/spac[i]);
+        }
     }
 
-
-    m_Planes[index]->SetTransform( (vtkAbstractTransform*)NULL );
-    m_Planes[index]->SetOrigin( dispGeo.vp );
-    m_Planes[index]->SetNormal( dispGeo.vnormal );
-
-    vtkSmartPointer<vtkPoints> points;
-    vtkSmartPointer<vtkPoints> tmppoints;
-    vtkSmartPointer<vtkPolyData> polydata;
-    vtkSmartPointer<vtkFloatArray> pointdata;
-    vtkSmartPointer<vtkDelaunay2D> delaunay;
-    vtkSmartPointer<vtkPolyData> cuttedPlane;
-
-    // the cutter only works if we do not have a 2D-image
-    // or if we have a 2D-image and want to see the whole image.
-    //
-    // for side views of 2D-images, we need some special treatment
-    if(!( (dims[0] == 1 && dispGeo.vnormal[0] != 0) ||
-          (dims[1] == 1 && dispGeo.vnormal[1] != 0) ||
-          (dims[2] == 1 && dispGeo.vnormal[2] != 0) ))
+    bool empty = false;
+    int numberOfVisibleVoxels = 1;
+    for (int i=0; i<3; i++)
     {
-        m_Cutters[index]->SetCutFunction( m_Planes[index] );
-        m_Cutters[index]->SetInputData( m_VtkImage );
-        m_Cutters[index]->Update();
-        cuttedPlane = m_Cutters[index]->GetOutput();
+        if (i==axis)
+            continue;
+        minIndex[i] = std::max(0, (int)ceil(lower[i]-0.5));
+        maxIndex[i] = std::min(dims[i]-1, (int)floor(upper[i]+0.5));
+        if (minIndex[i]>maxIndex[i])
+            empty = true;
+        else
+            numberOfVisibleVoxels *= maxIndex[i]-minIndex[i]+1;
     }
-    else
+
+    // level of detail: if there are too many visible voxels, only every stride-th voxel in both directions is glyphed
+    // (aligned to the image grid so that the glyphs do not jump while panning)
+    int stride = 1;
+    int maxNumber = std::max(1, m_ShowMaxNumber);
+    while (!empty && numberOfVisibleVoxels>maxNumber)
     {
-        // cutting of a 2D-Volume does not work,
-        // so we have to build up our own polydata object
-        cuttedPlane = vtkPolyData::New();
-        points = vtkPoints::New();
-        points->SetNumberOfPoints(m_VtkImage->GetNumberOfPoints());
-        for(int i=0; i<m_VtkImage->GetNumberOfPoints(); i++)
-        {
-            points->SetPoint(i, m_VtkImage->GetPoint(i));
-        }
-        cuttedPlane->SetPoints(points);
-
-        pointdata = vtkFloatArray::New();
-        int comps  = m_VtkImage->GetPointData()->GetScalars()->GetNumberOfComponents();
-        pointdata->SetNumberOfComponents(comps);
-        int tuples = m_VtkImage->GetPointData()->GetScalars()->GetNumberOfTuples();
-        pointdata->SetNumberOfTuples(tuples);
-        for(int i=0; i<tuples; i++)
-            pointdata->SetTuple(i,m_VtkImage->GetPointData()->GetScalars()->GetTuple(i));
-        pointdata->SetName( "vector" );
-        cuttedPlane->GetPointData()->AddArray(pointdata);
-
-        int nZero1, nZero2;
-        if(dims[0]==1)
-        {
-            nZero1 = 1; nZero2 = 2;
-        }
-        else if(dims[1]==1)
-        {
-            nZero1 = 0; nZero2 = 2;
-        }
-        else
+        stride++;
+        numberOfVisibleVoxels = 1;
+        for (int i=0; i<3; i++)
         {
-            nZero1 = 0; nZero2 = 1;
+            if (i==axis)
+                continue;
+            int first = ((minIndex[i]+stride-1)/stride)*stride;
+            numberOfVisibleVoxels *= first<=maxIndex[i] ? (maxIndex[i]-first)/stride+1 : 0;
         }
-
-        tmppoints = vtkPoints::New();
-        for(int j=0; j<m_VtkImage->GetNumberOfPoints(); j++){
-            double pt[3];
-            m_VtkImage->GetPoint(j,pt);
-            tmppoints->InsertNextPoint(pt[nZero1],pt[nZero2],0);
-        }
-
-        polydata = vtkPolyData::New();
-        polydata->SetPoints( tmppoints );
-        delaunay = vtkDelaunay2D::New();
-        delaunay->SetInputData( polydata );
-        delaunay->Update();
-        vtkCellArray* polys = delaunay->GetOutput()->GetPolys();
-        cuttedPlane->SetPolys(polys);
     }
+    double glyphScale = m_LevelOfDetail ? stride : 1;
 
-    if(cuttedPlane->GetNumberOfPoints())
+    // assemble the glyphs of all visible voxels in one polydata
+    vtkSmartPointer<vtkPolyData> glyphs = vtkSmartPointer<vtkPolyData>::New();
+    vtkSmartPointer<vtkPoints> points = vtkSmartPointer<vtkPoints>::New();
+    vtkSmartPointer<vtkFloatArray> normals = vtkSmartPointer<vtkFloatArray>::New();
+    vtkSmartPointer<vtkCellArray> polys = vtkSmartPointer<vtkCellArray>::New();
+    vtkSmartPointer<vtkDoubleArray> colors = vtkSmartPointer<vtkDoubleArray>::New();
+    normals->SetNumberOfComponents(3);
+
+    if (!empty)
     {
-        //  WINDOWING HERE
-        inversetransform = vtkTransform::New();
-        inversetransform->Identity();
-        inversetransform->Concatenate(vtktransform->GetLinearInverse());
-        double myscale[3];
-        ((vtkTransform*)vtktransform)->GetScale(myscale);
-        inversetransform->PostMultiply();
-        inversetransform->Scale(1*myscale[0],1*myscale[1],1*myscale[2]);
-
-        dispGeo.vnormal[0] = dispGeo.M3D[0]-dispGeo.O3D[0];
-        dispGeo.vnormal[1] = dispGeo.M3D[1]-dispGeo.O3D[1];
-        dispGeo.vnormal[2] = dispGeo.M3D[2]-dispGeo.O3D[2];
-        vtkMath::Normalize(dispGeo.vnormal);
-        dispGeo.vp[0] = dispGeo.M3D[0];
-        dispGeo.vp[1] = dispGeo.M3D[1];
-        dispGeo.vp[2] = dispGeo.M3D[2];
-
-        inversetransform->TransformPoint( dispGeo.vp, dispGeo.vp );
-        inversetransform->TransformNormalAtPoint( dispGeo.vp, dispGeo.vnormal, dispGeo.vnormal );
-
-        m_ThickPlanes1[index]->count = 0;
-        m_ThickPlanes1[index]->SetTransform((vtkAbstractTransform*)NULL );
-        m_ThickPlanes1[index]->SetPose( dispGeo.vnormal, dispGeo.vp );
-        m_ThickPlanes1[index]->SetThickness(dispGeo.d2);
-        m_Clippers1[index]->SetClipFunction( m_ThickPlanes1[index] );
-        m_Clippers1[index]->SetInputData( cuttedPlane );
-        m_Clippers1[index]->SetInsideOut(1);
-        m_Clippers1[index]->Update();
-
-        dispGeo.vnormal[0] = dispGeo.M3D[0]-dispGeo.L3D[0];
-        dispGeo.vnormal[1] = dispGeo.M3D[1]-dispGeo.L3D[1];
-        dispGeo.vnormal[2] = dispGeo.M3D[2]-dispGeo.L3D[2];
-        vtkMath::Normalize(dispGeo.vnormal);
-        dispGeo.vp[0] = dispGeo.M3D[0];
-        dispGeo.vp[1] = dispGeo.M3D[1];
-        dispGeo.vp[2] = dispGeo.M3D[2];
-
-        inversetransform->TransformPoint( dispGeo.vp, dispGeo.vp );
-        inversetransform->TransformNormalAtPoint( dispGeo.vp, dispGeo.vnormal, dispGeo.vnormal );
-
-        m_ThickPlanes2[index]->count = 0;
-        m_ThickPlanes2[index]->SetTransform((vtkAbstractTransform*)NULL );
-        m_ThickPlanes2[index]->SetPose( dispGeo.vnormal, dispGeo.vp );
-        m_ThickPlanes2[index]->SetThickness(dispGeo.d1);
-        m_Clippers2[index]->SetClipFunction( m_ThickPlanes2[index] );
-        m_Clippers2[index]->SetInputData( m_Clippers1[index]->GetOutput() );
-        m_Clippers2[index]->SetInsideOut(1);
-        m_Clippers2[index]->Update();
-
-        cuttedPlane = m_Clippers2[index]->GetOutput ();
-
-        if(cuttedPlane->GetNumberOfPoints())
-        {
-            localStorage->m_OdfsPlanes[index]->RemoveAllInputs();
-
-            vtkSmartPointer<vtkPolyDataNormals> normals = vtkSmartPointer<vtkPolyDataNormals>::New();
-            normals->SetInputConnection( m_OdfSource->GetOutputPort() );
-            normals->SplittingOff();
-            normals->ConsistencyOff();
-            normals->AutoOrientNormalsOff();
-            normals->ComputePointNormalsOn();
-            normals->ComputeCellNormalsOff();
-            normals->FlipNormalsOff();
-            normals->NonManifoldTraversalOff();
-
-            vtkSmartPointer<vtkTransformPolyDataFilter> trans = vtkSmartPointer<vtkTransformPolyDataFilter>::New();
-            trans->SetInputConnection( normals->GetOutputPort() );
-            trans->SetTransform(m_OdfTransform);
-
-            vtkSmartPointer<vtkMaskedProgrammableGlyphFilter> glyphGenerator = vtkSmartPointer<vtkMaskedProgrammableGlyphFilter>::New();
-            glyphGenerator->SetMaximumNumberOfPoints(std::min(m_ShowMaxNumber,(int)cuttedPlane->GetNumberOfPoints()));
-            glyphGenerator->SetRandomMode(0);
-            glyphGenerator->SetUseMaskPoints(1);
-            glyphGenerator->SetSourceConnection(trans->GetOutputPort() );
-            glyphGenerator->SetInput(cuttedPlane);
-            glyphGenerator->SetColorModeToColorBySource();
-            glyphGenerator->SetInputArrayToProcess(0,0,0, vtkDataObject::FIELD_ASSOCIATION_POINTS , "vector");
-            glyphGenerator->SetGeometry(this->GetDataNode()->GetData()->GetGeometry());
-            glyphGenerator->SetGlyphMethod(&(GlyphMethod),(void *)glyphGenerator);
-
-            try
+        mitk::BaseGeometry* geometry = this->GetDataNode()->GetData()->GetGeometry();
+        vtkPoints* templatePoints = localStorage->m_TemplateOdf->GetPoints();
+        const std::vector< vtkIdType >& cells = localStorage->m_TemplateCells;
+        std::vector< double > glyphPoints(3*N);
+        std::vector< double > glyphNormals(3*N);
+
+        int ijk[3];
+        ijk[axis] = minIndex[axis];
+        int u = (axis+1)%3;
+        int v = (axis+2)%3;
+        for (ijk[v]=((minIndex[v]+stride-1)/stride)*stride; ijk[v]<=maxIndex[v]; ijk[v]+=stride)
+            for (ijk[u]=((minIndex[u]+stride-1)/stride)*stride; ijk[u]<=maxIndex[u]; ijk[u]+=stride)
             {
-                glyphGenerator->Update();
-            }
-            catch( itk::ExceptionObject& err )
-            {
-                std::cout << err << std::endl;
+                vtkIdType voxel = m_VtkImage->ComputePointId(ijk);
+                const typename LocalStorage::OdfGlyph& glyph = GetGlyph(localStorage, voxel);
+
+                mitk::Point3D center;
+                mitk::Point3D voxelIndex;
+                voxelIndex[0] = ijk[0]; voxelIndex[1] = ijk[1]; voxelIndex[2] = ijk[2];
+                geometry->IndexToWorld(voxelIndex, center);
+
+                for (int j=0; j<N; j++)
+                {
+                    double p[3];
+                    templatePoints->GetPoint(j,p);
+                    for (int i=0; i<3; i++)
+                    {
+                        glyphPoints[3*j+i] = p[i]*glyph.radii[j]*glyphScale;
+                        glyphNormals[3*j+i] = 0;
+                    }
+                }
+
+                // point normals as computed by vtkPolyDataNormals without splitting: mean of the adjacent polygon normals
+                vtkIdType offset = points->GetNumberOfPoints();
+                for (unsigned int c=0; c<cells.size(); c+=cells[c]+1)
+                {
+                    double n[3] = {0,0,0};
+                    for (int i=1; i<=cells[c]; i++)
+                    {
+                        const double* a = &glyphPoints[3*cells[c+i]];
+                        const double* b = &glyphPoints[3*cells[c+(i%cells[c])+1]];
+                        n[0] += (a[1]-b[1])*(a[2]+b[2]);
+                        n[1] += (a[2]-b[2])*(a[0]+b[0]);
+                        n[2] += (a[0]-b[0])*(a[1]+b[1]);
+                    }
+                    vtkMath::Normalize(n);
+
+                    polys->InsertNextCell(cells[c]);
+                    for (int i=1; i<=cells[c]; i++)
+                    {
+                        polys->InsertCellPoint(offset+cells[c+i]);
+                        for (int k=0; k<3; k++)
+                            glyphNormals[3*cells[c+i]+k] += n[k];
+                    }
+                }
+                for (unsigned int c=0; c<glyph.colors.size(); c++)
+                    colors->InsertNextValue(glyph.colors[c]);
+
+                for (int j=0; j<N; j++)
+                {
+                    vtkMath::Normalize(&glyphNormals[3*j]);
+                    points->InsertNextPoint(center[0]+glyphPoints[3*j], center[1]+glyphPoints[3*j+1], center[2]+glyphPoints[3*j+2]);
+                    normals->InsertNextTuple(&glyphNormals[3*j]);
+                }
             }
+    }
 
-            localStorage->m_OdfsPlanes[index]->AddInputConnection(glyphGenerator->GetOutputPort());
+    glyphs->SetPoints(points);
+    glyphs->SetPolys(polys);
+    glyphs->GetPointData()->SetNormals(normals);
+    glyphs->GetCellData()->SetScalars(colors);
+
+    localStorage->m_OdfsPlanes[index]->RemoveAllInputs();
+    localStorage->m_OdfsPlanes[index]->AddInputData(glyphs);
+    localStorage->m_OdfsPlanes[index]->Update();
 
-            localStorage->m_OdfsPlanes[index]->Update();
-        }
-    }
     localStorage->m_PropAssemblies[index]->VisibilityOn();
     if(localStorage->m_PropAssemblies[index]->GetParts()->IsItemPresent(localStorage->m_OdfsActors[index]))
         localStorage->m_PropAssemblies[index]->RemovePart(localStorage->m_OdfsActors[index]);
@@ -776,8 +688,25 @@ void  mitk::OdfVtkMapper2D<T,N>
         localStorage->m_OdfsActors[1]->VisibilityOn();
         localStorage->m_OdfsActors[2]->VisibilityOn();
 
-        m_OdfSource->SetAdditionalScale(GetMinImageSpacing(GetIndex(renderer)));
+        m_AdditionalScale = GetMinImageSpacing(GetIndex(renderer));
         ApplyPropertySettings();
+
+        // the cached glyphs are only valid for the current image and glyph settings
+        typename LocalStorage::GlyphSettings settings;
+        settings.image = m_VtkImage;
+        settings.imageMTime = this->GetInput()->GetMTime();
+        settings.normalization = m_Normalization;
+        settings.scaleBy = m_ScaleBy;
+        settings.scaling = m_Scaling;
+        settings.indexParam1 = m_IndexParam1;
+        settings.indexParam2 = m_IndexParam2;
+        settings.additionalScale = m_AdditionalScale;
+        if (!settings.Equals(localStorage->m_GlyphSettings))
+        {
+            localStorage->m_GlyphCache.clear();
+            localStorage->m_GlyphSettings = settings;
+        }
+
         Slice(renderer, dispGeo);
         m_LastDisplayGeometry = dispGeo;
     }
@@ -814,6 +743,7 @@ void  mitk::OdfVtkMapper2D<T,N>
 {
     this->GetDataNode()->GetFloatProperty( "Scaling", m_Scaling );
     this->GetDataNode()->GetIntProperty( "ShowMaxNumber", m_ShowMaxNumber );
+    this->GetDataNode()->GetBoolProperty( "LevelOfDetail", m_LevelOfDetail );
 
     OdfNormalizationMethodProperty* nmp = dynamic_cast<OdfNormalizationMethodProperty*>(this->GetDataNode()->GetProperty( "Normalization" ));
     if(nmp)
@@ -865,6 +795,7 @@ void  mitk::OdfVtkMapper2D<T,N>
 ::SetDefaultProperties(mitk::DataNode* node, mitk::BaseRenderer*  /*renderer*/, bool  /*overwrite*/)
 {
     node->SetProperty( "ShowMaxNumber", mitk::IntProperty::New( 150 ) );
+    node->SetProperty( "LevelOfDetail", mitk::BoolProperty::New( true ) );
     node->SetProperty( "Scaling", mitk::FloatProperty::New( 1.0 ) );
     node->SetProperty( "Normalization", mitk::OdfNormalizationMethodProperty::New());
     node->SetProperty( "ScaleBy", mitk::OdfScaleByProperty::New());
@@ -1,6 +1,8 @@
 set(MODULE_TESTS
   mitkNonLocalMeansDenoisingTest.cpp
   mitkDiffusionPropertySerializerTest.cpp
+  mitkIVIMBatchedFitTest.cpp
+  mitkResampleDwiStreamingTest.cpp
 )
 
 set(MODULE_CUSTOM_TESTS
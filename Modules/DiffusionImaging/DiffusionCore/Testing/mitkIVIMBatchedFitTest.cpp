@@ -0,0 +1,161 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include "mitkTestingMacros.h"
+#include "mitkTestFixture.h"
+#include "itkDiffusionIntravoxelIncoherentMotionReconstructionImageFilter.h"
+#include "mitkSyntheticDwiTestHelper.h"
+#include <itkImageRegionIterator.h>
+#include <cmath>
+
+class mitkIVIMBatchedFitTestSuite : public mitk::TestFixture
+{
+
+  CPPUNIT_TEST_SUITE(mitkIVIMBatchedFitTestSuite);
+  MITK_TEST(FixedSizeLM_NoiseFreeSignal_RecoversParameters);
+  MITK_TEST(BatchedFit_FitAll_RecoversParameters);
+  MITK_TEST(BatchedFit_DStarFix_EqualsUnbatchedFit);
+  CPPUNIT_TEST_SUITE_END();
+
+private:
+
+  typedef itk::DiffusionIntravoxelIncoherentMotionReconstructionImageFilter<short, float> IVIMFilterType;
+  typedef mitk::SyntheticDwiTestHelper::DwiImageType VectorImageType;
+
+  VectorImageType::Pointer m_Image;
+  IVIMFilterType::GradientDirectionContainerType::Pointer m_Gradients;
+  std::vector<double> m_F;
+  std::vector<double> m_D;
+
+  static const double m_DStar;
+
+public:
+
+  /** Synthetic noise free IVIM image, f and D vary along x, D* is constant. */
+  void setUp() override
+  {
+    const double bvals[] = {0, 10, 20, 40, 80, 120, 200, 400, 600, 800, 1000};
+    const unsigned int numB = 11;
+
+    m_Gradients = IVIMFilterType::GradientDirectionContainerType::New();
+    for (unsigned int i=0; i<numB; i++)
+    {
+      IVIMFilterType::GradientDirectionType g;
+      g.fill(0.0);
+      g[0] = sqrt(bvals[i]/1000.0);
+      m_Gradients->InsertElement(i, g);
+    }
+
+    VectorImageType::SizeType size;
+    size[0] = 16; size[1] = 3; size[2] = 2;
+
+    m_F.clear();
+    m_D.clear();
+    for (unsigned int x=0; x<size[0]; x++)
+    {
+      m_F.push_back(0.05 + 0.01*x);
+      m_D.push_back(0.0007 + 0.00005*x);
+    }
+
+    m_Image = mitk::SyntheticDwiTestHelper::CreateImage(size, numB, [&](const VectorImageType::IndexType& idx, unsigned int i)
+    {
+      unsigned int x = idx[0];
+      return 30000*((1-m_F[x])*exp(-bvals[i]*m_D[x]) + m_F[x]*exp(-bvals[i]*(m_D[x]+m_DStar))) + 0.5;
+    });
+  }
+
+  void tearDown() override
+  {
+    m_Image = NULL;
+    m_Gradients = NULL;
+  }
+
+  IVIMFilterType::Pointer CreateFilter(IVIMFilterType::IVIM_Method method, bool batched)
+  {
+    IVIMFilterType::Pointer filter = IVIMFilterType::New();
+    filter->SetInput(m_Image);
+    filter->SetGradientDirections(m_Gradients);
+    filter->SetBValue(1000);
+    filter->SetS0Thres(0);
+    filter->SetDStar(m_DStar);
+    filter->SetMethod(method);
+    filter->SetUseBatchedFit(batched);
+    if (!batched)
+      filter->SetNumberOfThreads(1);
+    filter->Update();
+    return filter;
+  }
+
+  void FixedSizeLM_NoiseFreeSignal_RecoversParameters()
+  {
+    double b[] = {10, 20, 40, 80, 120, 200, 400, 600, 800, 1000};
+    double meas[10];
+    double truth[3] = {0.15, 0.0012, m_DStar};
+    double gradient[3];
+    itk::IVIM_3param_model model;
+    for (unsigned int i=0; i<10; i++)
+      meas[i] = model.Evaluate(truth, b[i], gradient);
+
+    itk::IVIMLevenbergMarquardt<itk::IVIM_3param_model> lm(model);
+    lm.SetFTolerance(1e-12);
+    double x[3] = {0.1, 0.001, 0.01};
+    CPPUNIT_ASSERT_MESSAGE("Fit converged", lm.Minimize(b, meas, 10, x));
+    for (unsigned int i=0; i<3; i++)
+      CPPUNIT_ASSERT_DOUBLES_EQUAL_MESSAGE("Parameter recovered", truth[i], x[i], 1e-4*truth[i]);
+  }
+
+  void BatchedFit_FitAll_RecoversParameters()
+  {
+    IVIMFilterType::Pointer filter = CreateFilter(IVIMFilterType::IVIM_FIT_ALL, true);
+
+    itk::ImageRegionIterator<IVIMFilterType::OutputImageType> fit(filter->GetOutput(0), filter->GetOutput(0)->GetLargestPossibleRegion());
+    itk::ImageRegionIterator<IVIMFilterType::OutputImageType> dit(filter->GetOutput(1), filter->GetOutput(1)->GetLargestPossibleRegion());
+    itk::ImageRegionIterator<IVIMFilterType::OutputImageType> dstarit(filter->GetOutput(2), filter->GetOutput(2)->GetLargestPossibleRegion());
+    while (!fit.IsAtEnd())
+    {
+      unsigned int x = fit.GetIndex()[0];
+      CPPUNIT_ASSERT_DOUBLES_EQUAL_MESSAGE("f", m_F[x], fit.Get(), 0.005);
+      CPPUNIT_ASSERT_DOUBLES_EQUAL_MESSAGE("D", m_D[x], dit.Get(), 0.02*m_D[x]);
+      CPPUNIT_ASSERT_DOUBLES_EQUAL_MESSAGE("D*", m_DStar, dstarit.Get(), 0.1*m_DStar);
+      ++fit;
+      ++dit;
+      ++dstarit;
+    }
+  }
+
+  void BatchedFit_DStarFix_EqualsUnbatchedFit()
+  {
+    IVIMFilterType::Pointer batched = CreateFilter(IVIMFilterType::IVIM_DSTAR_FIX, true);
+    IVIMFilterType::Pointer reference = CreateFilter(IVIMFilterType::IVIM_DSTAR_FIX, false);
+
+    for (unsigned int o=0; o<2; o++)
+    {
+      itk::ImageRegionIterator<IVIMFilterType::OutputImageType> it(batched->GetOutput(o), batched->GetOutput(o)->GetLargestPossibleRegion());
+      itk::ImageRegionIterator<IVIMFilterType::OutputImageType> refit(reference->GetOutput(o), reference->GetOutput(o)->GetLargestPossibleRegion());
+      while (!it.IsAtEnd())
+      {
+        CPPUNIT_ASSERT_DOUBLES_EQUAL_MESSAGE("Batched fit equals vnl fit", refit.Get(), it.Get(), 0.01*fabs(refit.Get()));
+        ++it;
+        ++refit;
+      }
+    }
+  }
+
+};
+
+const double mitkIVIMBatchedFitTestSuite::m_DStar = 0.02;
+
+MITK_TEST_SUITE_REGISTRATION(mitkIVIMBatchedFit)
@@ -21,6 +21,8 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "mitkGradientDirectionsProperty.h"
 #include "mitkITKImageImport.h"
 #include <mitkImageCast.h>
+#include <itkImageRegionConstIterator.h>
+#include <cmath>
 
 class mitkNonLocalMeansDenoisingTestSuite : public mitk::TestFixture
 {
@@ -29,7 +31,7 @@ class mitkNonLocalMeansDenoisingTestSuite : public mitk::TestFixture
   MITK_TEST(Denoise_NLMg_shouldReturnTrue);
   MITK_TEST(Denoise_NLMr_shouldReturnTrue);
   MITK_TEST(Denoise_NLMv_shouldReturnTrue);
-  MITK_TEST(Denoise_NLMvr_shouldReturnTrue);
+  MITK_TEST(Denoise_NLMvr_EqualsReference);
   CPPUNIT_TEST_SUITE_END();
 
 private:
@@ -142,11 +144,69 @@ public:
     MITK_ASSERT_EQUAL( m_DenoisedImage, m_ReferenceImage, "NLMv should always return the same result.");
   }
 
-  void Denoise_NLMvr_shouldReturnTrue()
+  /** Joint rician NLM of one voxel, computed neighbor by neighbor. */
+  VectorImagetType::PixelType DenoiseJointRician(VectorImagetType* image, const VectorImagetType::IndexType& index, int searchRadius, int comparisonRadius, double variance)
   {
-    std::string referenceImagePath = GetTestDataFilePath("DiffusionImaging/Denoising/test_multi_NLMvr.dwi");
-    m_ReferenceImage = mitk::IOUtil::LoadImage(referenceImagePath);
+    const unsigned int numValues = image->GetVectorLength();
+    const VectorImagetType::RegionType region = image->GetLargestPossibleRegion();
+    std::vector<double> weights;
+    std::vector<VectorImagetType::IndexType> neighbors;
+    double sumWeights = 0;
+
+    VectorImagetType::IndexType indexJ;
+    for (indexJ[0] = index[0] - searchRadius; indexJ[0] <= index[0] + searchRadius; ++indexJ[0])
+      for (indexJ[1] = index[1] - searchRadius; indexJ[1] <= index[1] + searchRadius; ++indexJ[1])
+        for (indexJ[2] = index[2] - searchRadius; indexJ[2] <= index[2] + searchRadius; ++indexJ[2])
+        {
+          if (!region.IsInside(indexJ))
+            continue;
+
+          double distance = 0;
+          double size = 0;
+          VectorImagetType::OffsetType offset;
+          for (offset[0] = -comparisonRadius; offset[0] <= comparisonRadius; ++offset[0])
+            for (offset[1] = -comparisonRadius; offset[1] <= comparisonRadius; ++offset[1])
+              for (offset[2] = -comparisonRadius; offset[2] <= comparisonRadius; ++offset[2])
+              {
+                if (!region.IsInside(index + offset) || !region.IsInside(indexJ + offset))
+                  continue;
+                for (unsigned int i = 0; i < numValues; ++i)
+                {
+                  short diff = image->GetPixel(index + offset)[i] - image->GetPixel(indexJ + offset)[i];
+                  distance += diff * diff;
+                }
+                ++size;
+              }
+          size *= numValues + 1;
+          double w = std::exp( - (distance / size) / variance);
+          weights.push_back(w);
+          neighbors.push_back(indexJ);
+          sumWeights += w;
+        }
+
+    // one squared value per neighbor, weighted with the weight of this neighbor
+    std::vector<double> sums(numValues, 0.0);
+    for (unsigned int n = 0; n < neighbors.size(); ++n)
+      for (unsigned int i = 0; i < numValues; ++i)
+      {
+        short value = image->GetPixel(neighbors[n])[i];
+        sums[i] += (weights[n] / sumWeights) * (double)(value * value);
+      }
+
+    VectorImagetType::PixelType pixel;
+    pixel.SetSize(numValues);
+    for (unsigned int i = 0; i < numValues; ++i)
+    {
+      double a = sums[i] - 2 * variance;
+      if (a < 0)
+        a = 0;
+      pixel[i] = std::floor(std::sqrt(a) + 0.5);
+    }
+    return pixel;
+  }
 
+  void Denoise_NLMvr_EqualsReference()
+  {
     m_DenoisingFilter->SetUseRicianAdaption(true);
     m_DenoisingFilter->SetUseJointInformation(true);
     try
@@ -158,10 +218,15 @@ public:
       MITK_ERROR << e.what();
     }
 
-    mitk::GrabItkImageMemory(m_DenoisingFilter->GetOutput(),m_DenoisedImage);
-    m_DenoisedImage->SetPropertyList(m_Image->GetPropertyList()->Clone());
-
-    MITK_ASSERT_EQUAL( m_DenoisedImage, m_ReferenceImage, "NLMvr should always return the same result.");
+    VectorImagetType::Pointer vectorImage;
+    mitk::CastToItkImage(m_Image,vectorImage);
+    itk::ImageRegionConstIterator<VectorImagetType> it(m_DenoisingFilter->GetOutput(), m_DenoisingFilter->GetOutput()->GetLargestPossibleRegion());
+    for (; !it.IsAtEnd(); ++it)
+    {
+      VectorImagetType::PixelType reference = DenoiseJointRician(vectorImage, it.GetIndex(), 1, 1, 500);
+      for (unsigned int i = 0; i < reference.GetSize(); ++i)
+        CPPUNIT_ASSERT_EQUAL_MESSAGE("NLMvr equals the neighbor by neighbor reference", reference[i], it.Get()[i]);
+    }
   }
 
 };
@@ -0,0 +1,101 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include "mitkTestingMacros.h"
+#include "mitkTestFixture.h"
+#include "itkResampleDwiImageFilter.h"
+#include "mitkSyntheticDwiTestHelper.h"
+#include <itkImageRegionConstIterator.h>
+
+class mitkResampleDwiStreamingTestSuite : public mitk::TestFixture
+{
+
+  CPPUNIT_TEST_SUITE(mitkResampleDwiStreamingTestSuite);
+  MITK_TEST(Resample_LinearInSlabs_EqualsSingleSlab);
+  MITK_TEST(Resample_NearestNeighbourInSlabs_EqualsSingleSlab);
+  CPPUNIT_TEST_SUITE_END();
+
+private:
+
+  typedef itk::ResampleDwiImageFilter<short> ResampleFilterType;
+  typedef ResampleFilterType::DwiImageType DwiImageType;
+
+  DwiImageType::Pointer m_Image;
+
+public:
+
+  void setUp() override
+  {
+    DwiImageType::SizeType size;
+    size[0] = 7; size[1] = 5; size[2] = 9;
+
+    DwiImageType::SpacingType spacing;
+    spacing[0] = 2; spacing[1] = 2; spacing[2] = 2.5;
+
+    m_Image = mitk::SyntheticDwiTestHelper::CreateImage(size, spacing, 4, [](const DwiImageType::IndexType& idx, unsigned int c)
+    {
+      return (idx[0]*31 + idx[1]*17 + idx[2]*idx[2]*13 + c*101) % 1000;
+    });
+  }
+
+  void tearDown() override
+  {
+    m_Image = NULL;
+  }
+
+  DwiImageType::Pointer Resample(ResampleFilterType::Interpolation interpolation, unsigned int numSlabs)
+  {
+    ResampleFilterType::DoubleVectorType spacing;
+    spacing[0] = 1.25; spacing[1] = 1.25; spacing[2] = 1.25;
+
+    ResampleFilterType::Pointer resampler = ResampleFilterType::New();
+    resampler->SetInput(m_Image);
+    resampler->SetInterpolation(interpolation);
+    resampler->SetNewSpacing(spacing);
+    resampler->SetNumberOfStreamDivisions(numSlabs);
+    resampler->Update();
+    return resampler->GetOutput();
+  }
+
+  void CompareSlabs(ResampleFilterType::Interpolation interpolation)
+  {
+    DwiImageType::Pointer reference = Resample(interpolation, 1);
+    DwiImageType::Pointer streamed = Resample(interpolation, 5);
+
+    CPPUNIT_ASSERT_MESSAGE("Same size", reference->GetLargestPossibleRegion()==streamed->GetLargestPossibleRegion());
+    itk::ImageRegionConstIterator<DwiImageType> rit(reference, reference->GetLargestPossibleRegion());
+    itk::ImageRegionConstIterator<DwiImageType> sit(streamed, streamed->GetLargestPossibleRegion());
+    while (!rit.IsAtEnd())
+    {
+      CPPUNIT_ASSERT_MESSAGE("Streamed result equals single slab", rit.Get()==sit.Get());
+      ++rit;
+      ++sit;
+    }
+  }
+
+  void Resample_LinearInSlabs_EqualsSingleSlab()
+  {
+    CompareSlabs(ResampleFilterType::Interpolate_Linear);
+  }
+
+  void Resample_NearestNeighbourInSlabs_EqualsSingleSlab()
+  {
+    CompareSlabs(ResampleFilterType::Interpolate_NearestNeighbour);
+  }
+
+};
+
+MITK_TEST_SUITE_REGISTRATION(mitkResampleDwiStreaming)
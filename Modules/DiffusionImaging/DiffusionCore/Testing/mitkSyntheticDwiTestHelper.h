@@ -0,0 +1,73 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#ifndef mitkSyntheticDwiTestHelper_h
+#define mitkSyntheticDwiTestHelper_h
+
+#include <itkVectorImage.h>
+#include <itkImageRegionIterator.h>
+
+namespace mitk
+{
+
+/** Creates small synthetic diffusion weighted images for filter tests that need no input data. */
+class SyntheticDwiTestHelper
+{
+  public:
+
+  typedef itk::VectorImage<short,3> DwiImageType;
+
+  /** Allocates an image of the given size and spacing and sets every voxel to signal(index), which
+   *  returns one value per component. */
+  template<class SignalFunction>
+  static DwiImageType::Pointer CreateImage(const DwiImageType::SizeType& size, const DwiImageType::SpacingType& spacing,
+                                           unsigned int numComponents, SignalFunction signal)
+  {
+    DwiImageType::RegionType region;
+    region.SetSize(size);
+
+    DwiImageType::Pointer image = DwiImageType::New();
+    image->SetRegions(region);
+    image->SetSpacing(spacing);
+    image->SetVectorLength(numComponents);
+    image->Allocate();
+
+    DwiImageType::PixelType pix(numComponents);
+    itk::ImageRegionIterator<DwiImageType> it(image, region);
+    while (!it.IsAtEnd())
+    {
+      for (unsigned int c=0; c<numComponents; c++)
+        pix[c] = signal(it.GetIndex(), c);
+      it.Set(pix);
+      ++it;
+    }
+    return image;
+  }
+
+  /** Same with unit spacing. */
+  template<class SignalFunction>
+  static DwiImageType::Pointer CreateImage(const DwiImageType::SizeType& size, unsigned int numComponents, SignalFunction signal)
+  {
+    DwiImageType::SpacingType spacing;
+    spacing.Fill(1.0);
+    return CreateImage(size, spacing, numComponents, signal);
+  }
+
+}; // end helper class
+
+} // namespace
+
+#endif
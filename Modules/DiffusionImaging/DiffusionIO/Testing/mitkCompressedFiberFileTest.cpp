@@ -0,0 +1,126 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include "mitkTestingMacros.h"
+#include "mitkTestFixture.h"
+#include <mitkTestingConfig.h>
+#include <mitkCompressedFiberFile.h>
+#include <mitkFiberBundle.h>
+#include <vtkCellArray.h>
+#include <vtkPoints.h>
+#include <vtkPolyLine.h>
+#include <vtkSmartPointer.h>
+#include <cmath>
+
+class mitkCompressedFiberFileTestSuite : public mitk::TestFixture
+{
+
+  CPPUNIT_TEST_SUITE(mitkCompressedFiberFileTestSuite);
+  MITK_TEST(ReadFiberBundle_RangeAcrossBlocks_EqualsSourceFibers);
+  MITK_TEST(ReadFibers_RangeInsideBlock_EqualsSourceFibers);
+  CPPUNIT_TEST_SUITE_END();
+
+private:
+
+  mitk::FiberBundle::Pointer m_FiberBundle;
+  std::string m_Filename;
+  double m_Tolerance;
+
+  /** Compares fibers first..last-1 of the source bundle with the read fibers. */
+  void AssertEqualsSourceFibers(vtkPolyData* fibers, const std::vector< float >& weights, unsigned int first, unsigned int last)
+  {
+    CPPUNIT_ASSERT_EQUAL((vtkIdType)(last - first), fibers->GetNumberOfLines());
+    CPPUNIT_ASSERT_EQUAL((size_t)(last - first), weights.size());
+    for (unsigned int f = first; f < last; ++f)
+    {
+      vtkCell* source = m_FiberBundle->GetFiberPolyData()->GetCell(f);
+      vtkCell* read = fibers->GetCell(f - first);
+      CPPUNIT_ASSERT_EQUAL(source->GetNumberOfPoints(), read->GetNumberOfPoints());
+      for (vtkIdType p = 0; p < source->GetNumberOfPoints(); ++p)
+        for (int i = 0; i < 3; ++i)
+          CPPUNIT_ASSERT_DOUBLES_EQUAL(source->GetPoints()->GetPoint(p)[i], read->GetPoints()->GetPoint(p)[i], m_Tolerance);
+      CPPUNIT_ASSERT_DOUBLES_EQUAL(m_FiberBundle->GetFiberWeight(f), weights.at(f - first), 1e-6);
+    }
+  }
+
+public:
+
+  void setUp() override
+  {
+    // 50 fibers of different lengths inside a box of 100 mm
+    vtkSmartPointer<vtkPoints> points = vtkSmartPointer<vtkPoints>::New();
+    vtkSmartPointer<vtkCellArray> cells = vtkSmartPointer<vtkCellArray>::New();
+    for (int f = 0; f < 50; ++f)
+    {
+      vtkSmartPointer<vtkPolyLine> line = vtkSmartPointer<vtkPolyLine>::New();
+      for (int i = 0; i < 5 + f % 7; ++i)
+      {
+        double p[3] = { 2.0 * f, 50 + 40 * std::sin(0.3 * i + f), 3.7 * i };
+        line->GetPointIds()->InsertNextId(points->InsertNextPoint(p));
+      }
+      cells->InsertNextCell(line);
+    }
+    vtkSmartPointer<vtkPolyData> polyData = vtkSmartPointer<vtkPolyData>::New();
+    polyData->SetPoints(points);
+    polyData->SetLines(cells);
+    m_FiberBundle = mitk::FiberBundle::New(polyData);
+    for (int f = 0; f < 50; ++f)
+      m_FiberBundle->SetFiberWeight(f, 0.5f + 0.01f * f);
+
+    // half a quantization step of the largest bounding box extent
+    m_Tolerance = 100.0 / 65535;
+
+    m_Filename = std::string(MITK_TEST_OUTPUT_DIR) + "/compressedFiberFileTest.cfib";
+    mitk::CompressedFiberFile::Write(m_Filename, m_FiberBundle, 8);
+  }
+
+  void tearDown() override
+  {
+    m_FiberBundle = nullptr;
+  }
+
+  void ReadFiberBundle_RangeAcrossBlocks_EqualsSourceFibers()
+  {
+    mitk::CompressedFiberFile file;
+    CPPUNIT_ASSERT_MESSAGE("Should open file", file.Open(m_Filename));
+    CPPUNIT_ASSERT_EQUAL(50u, file.GetNumFibers());
+    CPPUNIT_ASSERT_EQUAL(7u, file.GetNumBlocks());
+
+    // fibers 5 to 28 are stored in the blocks 0 to 3
+    mitk::FiberBundle::Pointer fib = file.ReadFiberBundle(5, 29);
+    std::vector< float > weights;
+    for (int f = 0; f < fib->GetNumFibers(); ++f)
+      weights.push_back(fib->GetFiberWeight(f));
+    AssertEqualsSourceFibers(fib->GetFiberPolyData(), weights, 5, 29);
+  }
+
+  void ReadFibers_RangeInsideBlock_EqualsSourceFibers()
+  {
+    mitk::CompressedFiberFile file;
+    CPPUNIT_ASSERT_MESSAGE("Should open file", file.Open(m_Filename));
+
+    std::vector< float > weights;
+    vtkSmartPointer<vtkPolyData> fibers = file.ReadFibers(41, 46, &weights);
+    AssertEqualsSourceFibers(fibers, weights, 41, 46);
+
+    // the last, partially filled block
+    fibers = file.ReadFibers(47, 60, &weights);
+    AssertEqualsSourceFibers(fibers, weights, 47, 50);
+  }
+
+};
+
+MITK_TEST_SUITE_REGISTRATION(mitkCompressedFiberFile)
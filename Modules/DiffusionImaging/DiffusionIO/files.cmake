@@ -34,6 +34,9 @@ set(CPP_FILES
 
   mitkFiberBundleTrackVisReader.cpp
   mitkFiberBundleTrackVisWriter.cpp
+  mitkFiberBundleCompressedReader.cpp
+  mitkFiberBundleCompressedWriter.cpp
+  mitkCompressedFiberFile.cpp
   mitkFiberBundleVtkReader.cpp
   mitkFiberBundleVtkWriter.cpp
   mitkFiberBundleSerializer.cpp
@@ -0,0 +1,467 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include "mitkCompressedFiberFile.h"
+#include <mitkExceptionMacro.h>
+#include <mitkGeometry3D.h>
+#include <vtkCellArray.h>
+#include <vtkFloatArray.h>
+#include <vtkIdTypeArray.h>
+#include <vtkPoints.h>
+#include "itk_zlib.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace
+{
+  // All values are stored in little endian byte order, independent of the byte order of the machine.
+  const char MAGIC[8] = { 'M', 'I', 'T', 'K', 'F', 'I', 'B', 'Z' };
+  const unsigned int VERSION = 1;
+  const double QUANTIZATION_STEPS = 65535;
+
+  bool IsLittleEndian()
+  {
+    const unsigned int one = 1;
+    return *reinterpret_cast< const unsigned char* >(&one) == 1;
+  }
+
+  template< class T, class Byte >
+  void Put(std::vector< Byte >& buffer, T value)
+  {
+    unsigned char bytes[sizeof(T)];
+    memcpy(bytes, &value, sizeof(T));
+    if (!IsLittleEndian())
+      std::reverse(bytes, bytes + sizeof(T));
+    buffer.insert(buffer.end(), bytes, bytes + sizeof(T));
+  }
+
+  template< class T >
+  T Decode(const unsigned char* data)
+  {
+    unsigned char bytes[sizeof(T)];
+    memcpy(bytes, data, sizeof(T));
+    if (!IsLittleEndian())
+      std::reverse(bytes, bytes + sizeof(T));
+    T value;
+    memcpy(&value, bytes, sizeof(T));
+    return value;
+  }
+
+  template< class T >
+  T Get(std::istream& stream)
+  {
+    unsigned char bytes[sizeof(T)] = {};
+    stream.read(reinterpret_cast< char* >(bytes), sizeof(T));
+    return Decode< T >(bytes);
+  }
+
+  void PutVarint(std::vector< unsigned char >& buffer, unsigned int value)
+  {
+    while (value >= 0x80)
+    {
+      buffer.push_back((unsigned char)(value | 0x80));
+      value >>= 7;
+    }
+    buffer.push_back((unsigned char)value);
+  }
+
+  unsigned int GetVarint(const unsigned char*& data, const unsigned char* end)
+  {
+    unsigned int value = 0;
+    for (int shift = 0; data < end && shift < 35; shift += 7)
+    {
+      unsigned char byte = *data++;
+      value |= (unsigned int)(byte & 0x7F) << shift;
+      if ((byte & 0x80) == 0)
+        return value;
+    }
+    mitkThrow() << "Corrupt fiber block.";
+  }
+
+  // signed differences are mapped to unsigned values with small magnitude (0,-1,1,-2,... -> 0,1,2,3,...)
+  unsigned int ZigZag(int value)
+  {
+    return ((unsigned int)value << 1) ^ (unsigned int)(value >> 31);
+  }
+
+  int UnZigZag(unsigned int value)
+  {
+    return (int)(value >> 1) ^ -(int)(value & 1);
+  }
+}
+
+mitk::CompressedFiberFile::CompressedFiberFile()
+  : m_NumFibers(0)
+  , m_HasGeometry(false)
+{
+  for (int i = 0; i < 3; ++i)
+  {
+    m_BoundsMin[i] = 0;
+    m_Scale[i] = 1;
+    m_Origin[i] = 0;
+    m_Spacing[i] = 1;
+    m_Dimensions[i] = 0;
+  }
+}
+
+mitk::CompressedFiberFile::~CompressedFiberFile()
+{
+  Close();
+}
+
+void mitk::CompressedFiberFile::Write(const std::string& filename, const FiberBundle* fib, unsigned int fibersPerBlock)
+{
+  vtkSmartPointer<vtkPolyData> poly = fib->GetFiberPolyData();
+  vtkCellArray* lines = poly->GetLines();
+  fibersPerBlock = std::max(fibersPerBlock, 1u);
+
+  // point ids of each fiber
+  std::vector< vtkIdType > fiberPoints;
+  std::vector< vtkIdType* > fiberPointIds;
+  if (lines != nullptr)
+  {
+    vtkIdType numPoints;
+    vtkIdType* pointIds;
+    lines->InitTraversal();
+    while (lines->GetNextCell(numPoints, pointIds))
+    {
+      fiberPoints.push_back(numPoints);
+      fiberPointIds.push_back(pointIds);
+    }
+  }
+  unsigned int numFibers = fiberPoints.size();
+  unsigned int numBlocks = (numFibers + fibersPerBlock - 1) / fibersPerBlock;
+
+  vtkSmartPointer<vtkFloatArray> weights = fib->GetFiberWeights();
+  bool useWeights = weights != nullptr && weights->GetNumberOfTuples() == (vtkIdType)numFibers;
+
+  // quantization grid spanned by the bounding box
+  double bounds[6] = { 0, 0, 0, 0, 0, 0 };
+  if (poly->GetNumberOfPoints() > 0)
+    poly->GetBounds(bounds);
+  double boundsMin[3], scale[3];
+  for (int i = 0; i < 3; ++i)
+  {
+    boundsMin[i] = bounds[2 * i];
+    scale[i] = (bounds[2 * i + 1] - bounds[2 * i]) / QUANTIZATION_STEPS;
+    if (scale[i] <= 0)
+      scale[i] = 1;
+  }
+
+  // encode and compress the blocks in parallel
+  std::vector< std::vector< char > > compressed(numBlocks);
+  std::vector< unsigned long long > rawSizes(numBlocks);
+  std::vector< unsigned int > blockPoints(numBlocks, 0);
+  bool failed = false;
+#pragma omp parallel for schedule(dynamic)
+  for (int b = 0; b < (int)numBlocks; ++b)
+  {
+    std::vector< unsigned char > raw;
+    unsigned int firstFiber = b * fibersPerBlock;
+    unsigned int lastFiber = std::min(firstFiber + fibersPerBlock, numFibers);
+    for (unsigned int f = firstFiber; f < lastFiber; ++f)
+    {
+      PutVarint(raw, fiberPoints[f]);
+      Put<float>(raw, useWeights ? weights->GetValue(f) : 1.0f);
+
+      int last[3] = { 0, 0, 0 };
+      for (vtkIdType p = 0; p < fiberPoints[f]; ++p)
+      {
+        double point[3];
+        poly->GetPoint(fiberPointIds[f][p], point);
+        for (int i = 0; i < 3; ++i)
+        {
+          int q = (int)std::floor((point[i] - boundsMin[i]) / scale[i] + 0.5);
+          q = std::max(0, std::min(q, (int)QUANTIZATION_STEPS));
+          PutVarint(raw, ZigZag(q - last[i]));
+          last[i] = q;
+        }
+      }
+      blockPoints[b] += fiberPoints[f];
+    }
+
+    rawSizes[b] = raw.size();
+    uLongf compressedSize = compressBound(raw.size());
+    compressed[b].resize(compressedSize);
+    if (compress2((Bytef*)compressed[b].data(), &compressedSize, (const Bytef*)raw.data(), raw.size(), Z_DEFAULT_COMPRESSION) != Z_OK)
+    {
+#pragma omp critical
+      failed = true;
+    }
+    compressed[b].resize(compressedSize);
+  }
+  if (failed)
+    mitkThrow() << "Compression of fiber blocks failed.";
+
+  // header, offset table and blocks
+  bool hasGeometry = fib->GetReferenceGeometry().IsNotNull();
+  std::vector< char > header;
+  header.insert(header.end(), MAGIC, MAGIC + 8);
+  Put<unsigned int>(header, VERSION);
+  Put<unsigned int>(header, numFibers);
+  Put<unsigned int>(header, numBlocks);
+  Put<unsigned int>(header, hasGeometry ? 1 : 0);
+  for (int i = 0; i < 3; ++i)
+    Put<double>(header, boundsMin[i]);
+  for (int i = 0; i < 3; ++i)
+    Put<double>(header, scale[i]);
+  for (int i = 0; i < 3; ++i)
+    Put<double>(header, hasGeometry ? fib->GetReferenceGeometry()->GetOrigin()[i] : 0.0);
+  for (int i = 0; i < 3; ++i)
+    Put<double>(header, hasGeometry ? fib->GetReferenceGeometry()->GetSpacing()[i] : 1.0);
+  for (int i = 0; i < 3; ++i)
+    Put<unsigned int>(header, hasGeometry ? (unsigned int)fib->GetReferenceGeometry()->GetExtent(i) : 0);
+
+  const unsigned long long tableEntrySize = 3 * sizeof(unsigned long long) + 3 * sizeof(unsigned int);
+  unsigned long long offset = header.size() + numBlocks * tableEntrySize;
+  for (unsigned int b = 0; b < numBlocks; ++b)
+  {
+    Put<unsigned long long>(header, offset);
+    Put<unsigned long long>(header, compressed[b].size());
+    Put<unsigned long long>(header, rawSizes[b]);
+    Put<unsigned int>(header, b * fibersPerBlock);
+    Put<unsigned int>(header, std::min(fibersPerBlock, numFibers - b * fibersPerBlock));
+    Put<unsigned int>(header, blockPoints[b]);
+    offset += compressed[b].size();
+  }
+
+  std::ofstream stream(filename.c_str(), std::ios::out | std::ios::binary);
+  if (!stream.good())
+    mitkThrow() << "Could not open " << filename;
+  stream.write(header.data(), header.size());
+  for (unsigned int b = 0; b < numBlocks; ++b)
+    stream.write(compressed[b].data(), compressed[b].size());
+  if (!stream.good())
+    mitkThrow() << "Error while writing " << filename;
+}
+
+bool mitk::CompressedFiberFile::Open(const std::string& filename)
+{
+  Close();
+  m_Stream.open(filename.c_str(), std::ios::in | std::ios::binary);
+  if (!m_Stream.good())
+    return false;
+
+  char magic[8];
+  m_Stream.read(magic, 8);
+  if (!m_Stream.good() || memcmp(magic, MAGIC, 8) != 0 || Get<unsigned int>(m_Stream) != VERSION)
+  {
+    Close();
+    return false;
+  }
+
+  m_NumFibers = Get<unsigned int>(m_Stream);
+  unsigned int numBlocks = Get<unsigned int>(m_Stream);
+  m_HasGeometry = Get<unsigned int>(m_Stream) != 0;
+  for (int i = 0; i < 3; ++i)
+    m_BoundsMin[i] = Get<double>(m_Stream);
+  for (int i = 0; i < 3; ++i)
+    m_Scale[i] = Get<double>(m_Stream);
+  for (int i = 0; i < 3; ++i)
+    m_Origin[i] = Get<double>(m_Stream);
+  for (int i = 0; i < 3; ++i)
+    m_Spacing[i] = Get<double>(m_Stream);
+  for (int i = 0; i < 3; ++i)
+    m_Dimensions[i] = Get<unsigned int>(m_Stream);
+
+  m_Blocks.resize(numBlocks);
+  for (unsigned int b = 0; b < numBlocks; ++b)
+  {
+    m_Blocks[b].offset = Get<unsigned long long>(m_Stream);
+    m_Blocks[b].compressedSize = Get<unsigned long long>(m_Stream);
+    m_Blocks[b].rawSize = Get<unsigned long long>(m_Stream);
+    m_Blocks[b].firstFiber = Get<unsigned int>(m_Stream);
+    m_Blocks[b].numFibers = Get<unsigned int>(m_Stream);
+    m_Blocks[b].numPoints = Get<unsigned int>(m_Stream);
+  }
+
+  if (!m_Stream.good())
+  {
+    Close();
+    return false;
+  }
+  return true;
+}
+
+void mitk::CompressedFiberFile::Close()
+{
+  if (m_Stream.is_open())
+    m_Stream.close();
+  m_Stream.clear();
+  m_NumFibers = 0;
+  m_Blocks.clear();
+}
+
+void mitk::CompressedFiberFile::DecodeBlock(const std::vector< char >& compressed, const BlockInfo& info, Block& block) const
+{
+  std::vector< unsigned char > raw(info.rawSize);
+  uLongf rawSize = info.rawSize;
+  if (uncompress((Bytef*)raw.data(), &rawSize, (const Bytef*)compressed.data(), compressed.size()) != Z_OK || rawSize != info.rawSize)
+    mitkThrow() << "Decompression of fiber block failed.";
+
+  block.numPoints.resize(info.numFibers);
+  block.weights.resize(info.numFibers);
+  block.points.resize(3 * (size_t)info.numPoints);
+
+  const unsigned char* data = raw.data();
+  const unsigned char* end = data + raw.size();
+  float* point = block.points.data();
+  float* pointsEnd = point + block.points.size();
+  for (unsigned int f = 0; f < info.numFibers; ++f)
+  {
+    unsigned int numPoints = GetVarint(data, end);
+    if (end - data < 4 || pointsEnd - point < 3 * (ptrdiff_t)numPoints)
+      mitkThrow() << "Corrupt fiber block.";
+    block.weights[f] = Decode<float>(data);
+    data += 4;
+    block.numPoints[f] = numPoints;
+
+    int q[3] = { 0, 0, 0 };
+    for (unsigned int p = 0; p < numPoints; ++p)
+    {
+      for (int i = 0; i < 3; ++i)
+      {
+        q[i] += UnZigZag(GetVarint(data, end));
+        *point++ = m_BoundsMin[i] + q[i] * m_Scale[i];
+      }
+    }
+  }
+}
+
+vtkSmartPointer<vtkPolyData> mitk::CompressedFiberFile::ReadFibers(unsigned int first, unsigned int last, std::vector< float >* weights)
+{
+  last = std::min(last, m_NumFibers);
+  first = std::min(first, last);
+
+  // blocks containing the requested fibers
+  unsigned int firstBlock = 0, lastBlock = 0;
+  while (firstBlock < m_Blocks.size() && m_Blocks[firstBlock].firstFiber + m_Blocks[firstBlock].numFibers <= first)
+    ++firstBlock;
+  lastBlock = firstBlock;
+  while (lastBlock < m_Blocks.size() && m_Blocks[lastBlock].firstFiber < last)
+    ++lastBlock;
+  int numBlocks = lastBlock - firstBlock;
+
+  // the blocks are read sequentially and decoded in parallel
+  std::vector< std::vector< char > > compressed(numBlocks);
+  for (int b = 0; b < numBlocks; ++b)
+  {
+    const BlockInfo& info = m_Blocks[firstBlock + b];
+    compressed[b].resize(info.compressedSize);
+    m_Stream.seekg(info.offset);
+    m_Stream.read(compressed[b].data(), info.compressedSize);
+  }
+  if (!m_Stream.good())
+    mitkThrow() << "Error while reading fiber blocks.";
+
+  std::vector< Block > blocks(numBlocks);
+  bool failed = false;
+#pragma omp parallel for schedule(dynamic)
+  for (int b = 0; b < numBlocks; ++b)
+  {
+    try
+    {
+      DecodeBlock(compressed[b], m_Blocks[firstBlock + b], blocks[b]);
+    }
+    catch (...)
+    {
+#pragma omp critical
+      failed = true;
+    }
+    std::vector< char >().swap(compressed[b]);
+  }
+  if (failed)
+    mitkThrow() << "Error while decoding fiber blocks.";
+
+  // assemble the requested fibers
+  std::vector< float > coordinates;
+  std::vector< vtkIdType > cells;
+  if (weights != nullptr)
+    weights->clear();
+  vtkIdType pointId = 0;
+  for (int b = 0; b < numBlocks; ++b)
+  {
+    const BlockInfo& info = m_Blocks[firstBlock + b];
+    const float* point = blocks[b].points.data();
+    for (unsigned int f = 0; f < info.numFibers; ++f)
+    {
+      unsigned int fiber = info.firstFiber + f;
+      unsigned int numPoints = blocks[b].numPoints[f];
+      if (fiber >= first && fiber < last)
+      {
+        coordinates.insert(coordinates.end(), point, point + 3 * numPoints);
+        cells.push_back(numPoints);
+        for (unsigned int p = 0; p < numPoints; ++p)
+          cells.push_back(pointId++);
+        if (weights != nullptr)
+          weights->push_back(blocks[b].weights[f]);
+      }
+      point += 3 * numPoints;
+    }
+  }
+
+  vtkSmartPointer<vtkFloatArray> pointData = vtkSmartPointer<vtkFloatArray>::New();
+  pointData->SetNumberOfComponents(3);
+  pointData->SetNumberOfTuples(pointId);
+  if (pointId > 0)
+    memcpy(pointData->GetPointer(0), coordinates.data(), coordinates.size() * sizeof(float));
+  vtkSmartPointer<vtkPoints> points = vtkSmartPointer<vtkPoints>::New();
+  points->SetData(pointData);
+
+  vtkSmartPointer<vtkIdTypeArray> cellData = vtkSmartPointer<vtkIdTypeArray>::New();
+  cellData->SetNumberOfValues(cells.size());
+  if (!cells.empty())
+    memcpy(cellData->GetPointer(0), cells.data(), cells.size() * sizeof(vtkIdType));
+  vtkSmartPointer<vtkCellArray> lines = vtkSmartPointer<vtkCellArray>::New();
+  lines->SetCells(last - first, cellData);
+
+  vtkSmartPointer<vtkPolyData> poly = vtkSmartPointer<vtkPolyData>::New();
+  poly->SetPoints(points);
+  poly->SetLines(lines);
+  return poly;
+}
+
+mitk::FiberBundle::Pointer mitk::CompressedFiberFile::ReadFiberBundle(unsigned int first, unsigned int last)
+{
+  std::vector< float > weights;
+  FiberBundle::Pointer fib = FiberBundle::New(ReadFibers(first, last, &weights));
+
+  vtkSmartPointer<vtkFloatArray> weightArray = vtkSmartPointer<vtkFloatArray>::New();
+  weightArray->SetName("FIBER_WEIGHTS");
+  weightArray->SetNumberOfValues(weights.size());
+  for (unsigned int i = 0; i < weights.size(); ++i)
+    weightArray->SetValue(i, weights[i]);
+  fib->SetFiberWeights(weightArray);
+
+  if (m_HasGeometry)
+  {
+    mitk::Geometry3D::Pointer geometry = mitk::Geometry3D::New();
+    mitk::Point3D origin;
+    mitk::Vector3D spacing;
+    for (int i = 0; i < 3; ++i)
+    {
+      origin[i] = m_Origin[i];
+      spacing[i] = m_Spacing[i];
+    }
+    geometry->SetOrigin(origin);
+    geometry->SetSpacing(spacing);
+    for (int i = 0; i < 3; ++i)
+      geometry->SetExtentInMM(i, m_Spacing[i] * m_Dimensions[i]);
+    fib->SetReferenceGeometry(dynamic_cast<mitk::BaseGeometry*>(geometry.GetPointer()));
+  }
+  return fib;
+}
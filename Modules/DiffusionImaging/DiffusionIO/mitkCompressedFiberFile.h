@@ -0,0 +1,100 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#ifndef __mitkCompressedFiberFile_h
+#define __mitkCompressedFiberFile_h
+
+#include <MitkDiffusionIOExports.h>
+#include <mitkFiberBundle.h>
+#include <vtkSmartPointer.h>
+#include <vtkPolyData.h>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace mitk
+{
+
+/**
+ * \brief Compact binary tractogram format (.cfib) with random access to fiber subsets.
+ *
+ * The point coordinates are quantized to 16 bit relative to the bounding box of the tractogram and stored as
+ * variable length differences between consecutive points of a fiber. The fibers are grouped into blocks that are
+ * compressed independently with zlib. An offset table after the header allows to read arbitrary fiber ranges
+ * without decoding the whole file, and the blocks are encoded and decoded in parallel.
+ *
+ * The quantization error of each coordinate is at most half the bounding box size divided by 65535.
+ */
+class MITKDIFFUSIONIO_EXPORT CompressedFiberFile
+{
+public:
+
+  CompressedFiberFile();
+  ~CompressedFiberFile();
+
+  /** Writes the fibers, their weights and the reference geometry of the fiber bundle. Throws on failure. */
+  static void Write(const std::string& filename, const FiberBundle* fib, unsigned int fibersPerBlock = 1000);
+
+  /** Reads header and offset table. Returns false if the file could not be opened or is not a compressed fiber file. */
+  bool Open(const std::string& filename);
+  void Close();
+
+  unsigned int GetNumFibers() const { return m_NumFibers; }
+  unsigned int GetNumBlocks() const { return m_Blocks.size(); }
+
+  /** Decodes fibers first..last-1 (only the blocks containing them). Weights are returned if the pointer is not null. */
+  vtkSmartPointer<vtkPolyData> ReadFibers(unsigned int first, unsigned int last, std::vector< float >* weights = nullptr);
+
+  /** Fiber bundle with fibers first..last-1, their weights and the stored reference geometry. */
+  FiberBundle::Pointer ReadFiberBundle(unsigned int first, unsigned int last);
+  FiberBundle::Pointer ReadFiberBundle() { return ReadFiberBundle(0, m_NumFibers); }
+
+private:
+
+  struct BlockInfo
+  {
+    unsigned long long  offset;           ///< file offset of the compressed block
+    unsigned long long  compressedSize;
+    unsigned long long  rawSize;
+    unsigned int        firstFiber;
+    unsigned int        numFibers;
+    unsigned int        numPoints;
+  };
+
+  /** Decoded content of one block. */
+  struct Block
+  {
+    std::vector< unsigned int > numPoints;
+    std::vector< float >        weights;
+    std::vector< float >        points;
+  };
+
+  void DecodeBlock(const std::vector< char >& compressed, const BlockInfo& info, Block& block) const;
+
+  std::ifstream             m_Stream;
+  unsigned int              m_NumFibers;
+  double                    m_BoundsMin[3];
+  double                    m_Scale[3];         ///< size of one quantization step
+  bool                      m_HasGeometry;
+  double                    m_Origin[3];
+  double                    m_Spacing[3];
+  unsigned int              m_Dimensions[3];
+  std::vector< BlockInfo >  m_Blocks;
+};
+
+}
+
+#endif // __mitkCompressedFiberFile_h
@@ -38,6 +38,7 @@ std::vector<CustomMimeType*> DiffusionIOMimeTypes::Get()
 
   mimeTypes.push_back(FIBERBUNDLE_VTK_MIMETYPE().Clone());
   mimeTypes.push_back(FIBERBUNDLE_TRK_MIMETYPE().Clone());
+  mimeTypes.push_back(FIBERBUNDLE_CFIB_MIMETYPE().Clone());
 
   mimeTypes.push_back(CONNECTOMICS_MIMETYPE().Clone());
 
@@ -79,6 +80,16 @@ CustomMimeType DiffusionIOMimeTypes::FIBERBUNDLE_TRK_MIMETYPE()
   return mimeType;
 }
 
+CustomMimeType DiffusionIOMimeTypes::FIBERBUNDLE_CFIB_MIMETYPE()
+{
+  CustomMimeType mimeType(FIBERBUNDLE_CFIB_MIMETYPE_NAME());
+  std::string category = "Compressed Fibers";
+  mimeType.SetComment("Compressed Fibers");
+  mimeType.SetCategory(category);
+  mimeType.AddExtension("cfib");
+  return mimeType;
+}
+
 DiffusionIOMimeTypes::DiffusionImageNrrdMimeType::DiffusionImageNrrdMimeType()
   : CustomMimeType(DWI_NRRD_MIMETYPE_NAME())
 {
@@ -313,6 +324,12 @@ std::string DiffusionIOMimeTypes::FIBERBUNDLE_TRK_MIMETYPE_NAME()
   return name;
 }
 
+std::string DiffusionIOMimeTypes::FIBERBUNDLE_CFIB_MIMETYPE_NAME()
+{
+  static std::string name = IOMimeTypes::DEFAULT_BASE_NAME() + ".FiberBundle.cfib";
+  return name;
+}
+
 std::string DiffusionIOMimeTypes::CONNECTOMICS_MIMETYPE_NAME()
 {
   static std::string name = IOMimeTypes::DEFAULT_BASE_NAME() + ".cnf";
@@ -58,6 +58,11 @@ public:
   static CustomMimeType FIBERBUNDLE_TRK_MIMETYPE();
   static std::string FIBERBUNDLE_TRK_MIMETYPE_NAME();
 
+  // ------------------------------ Compressed fiber format ---------------------------
+
+  static CustomMimeType FIBERBUNDLE_CFIB_MIMETYPE();
+  static std::string FIBERBUNDLE_CFIB_MIMETYPE_NAME();
+
 
   // ------------------------- Image formats (ITK based) --------------------------
 
@@ -22,6 +22,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <mitkNrrdQBallImageReader.h>
 #include <mitkFiberBundleVtkReader.h>
 #include <mitkFiberBundleTrackVisReader.h>
+#include <mitkFiberBundleCompressedReader.h>
 #include <mitkConnectomicsNetworkReader.h>
 #include <mitkPlanarFigureCompositeReader.h>
 
@@ -31,6 +32,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <mitkNrrdQBallImageWriter.h>
 #include <mitkFiberBundleVtkWriter.h>
 #include <mitkFiberBundleTrackVisWriter.h>
+#include <mitkFiberBundleCompressedWriter.h>
 #include <mitkConnectomicsNetworkWriter.h>
 #include <mitkConnectomicsNetworkCSVWriter.h>
 #include <mitkConnectomicsNetworkMatrixWriter.h>
@@ -65,6 +67,7 @@ namespace mitk
       m_NrrdQBallImageReader = new NrrdQBallImageReader();
       m_FiberBundleVtkReader = new FiberBundleVtkReader();
       m_FiberBundleTrackVisReader = new FiberBundleTrackVisReader();
+      m_FiberBundleCompressedReader = new FiberBundleCompressedReader();
       m_ConnectomicsNetworkReader = new ConnectomicsNetworkReader();
       m_PlanarFigureCompositeReader = new PlanarFigureCompositeReader();
 
@@ -74,6 +77,7 @@ namespace mitk
       m_NrrdQBallImageWriter = new NrrdQBallImageWriter();
       m_FiberBundleVtkWriter = new FiberBundleVtkWriter();
       m_FiberBundleTrackVisWriter = new FiberBundleTrackVisWriter();
+      m_FiberBundleCompressedWriter = new FiberBundleCompressedWriter();
       m_ConnectomicsNetworkWriter = new ConnectomicsNetworkWriter();
       m_ConnectomicsNetworkCSVWriter = new ConnectomicsNetworkCSVWriter();
       m_ConnectomicsNetworkMatrixWriter = new ConnectomicsNetworkMatrixWriter();
@@ -93,6 +97,7 @@ namespace mitk
       delete m_NrrdQBallImageReader;
       delete m_FiberBundleVtkReader;
       delete m_FiberBundleTrackVisReader;
+      delete m_FiberBundleCompressedReader;
       delete m_ConnectomicsNetworkReader;
       delete m_PlanarFigureCompositeReader;
 
@@ -102,6 +107,7 @@ namespace mitk
       delete m_NrrdQBallImageWriter;
       delete m_FiberBundleVtkWriter;
       delete m_FiberBundleTrackVisWriter;
+      delete m_FiberBundleCompressedWriter;
       delete m_ConnectomicsNetworkWriter;
       delete m_ConnectomicsNetworkCSVWriter;
       delete m_ConnectomicsNetworkMatrixWriter;
@@ -116,6 +122,7 @@ namespace mitk
     NrrdQBallImageReader * m_NrrdQBallImageReader;
     FiberBundleVtkReader * m_FiberBundleVtkReader;
     FiberBundleTrackVisReader * m_FiberBundleTrackVisReader;
+    FiberBundleCompressedReader * m_FiberBundleCompressedReader;
     ConnectomicsNetworkReader * m_ConnectomicsNetworkReader;
     PlanarFigureCompositeReader* m_PlanarFigureCompositeReader;
 
@@ -125,6 +132,7 @@ namespace mitk
     NrrdQBallImageWriter * m_NrrdQBallImageWriter;
     FiberBundleVtkWriter * m_FiberBundleVtkWriter;
     FiberBundleTrackVisWriter * m_FiberBundleTrackVisWriter;
+    FiberBundleCompressedWriter * m_FiberBundleCompressedWriter;
     ConnectomicsNetworkWriter * m_ConnectomicsNetworkWriter;
     ConnectomicsNetworkCSVWriter * m_ConnectomicsNetworkCSVWriter;
     ConnectomicsNetworkMatrixWriter * m_ConnectomicsNetworkMatrixWriter;
@@ -0,0 +1,51 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include "mitkFiberBundleCompressedReader.h"
+#include <mitkCompressedFiberFile.h>
+#include <mitkCustomMimeType.h>
+#include "mitkDiffusionIOMimeTypes.h"
+
+
+mitk::FiberBundleCompressedReader::FiberBundleCompressedReader()
+    : mitk::AbstractFileReader( mitk::DiffusionIOMimeTypes::FIBERBUNDLE_CFIB_MIMETYPE_NAME(), "Compressed Fiber Bundle Reader" )
+{
+    m_ServiceReg = this->RegisterService();
+}
+
+mitk::FiberBundleCompressedReader::FiberBundleCompressedReader(const FiberBundleCompressedReader &other)
+    :mitk::AbstractFileReader(other)
+{
+}
+
+mitk::FiberBundleCompressedReader * mitk::FiberBundleCompressedReader::Clone() const
+{
+    return new FiberBundleCompressedReader(*this);
+}
+
+std::vector<itk::SmartPointer<mitk::BaseData> > mitk::FiberBundleCompressedReader::Read()
+{
+    std::vector<itk::SmartPointer<mitk::BaseData> > result;
+
+    CompressedFiberFile file;
+    if (!file.Open(this->GetInputLocation()))
+        mitkThrow() << "Unable to open " << this->GetInputLocation();
+    FiberBundle::Pointer fib = file.ReadFiberBundle();
+    result.push_back(fib.GetPointer());
+
+    MITK_INFO << "Fiber bundle read";
+    return result;
+}
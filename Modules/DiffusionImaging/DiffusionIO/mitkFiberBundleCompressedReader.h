@@ -0,0 +1,50 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#ifndef __mitkFiberBundleCompressedReader_h
+#define __mitkFiberBundleCompressedReader_h
+
+#include <mitkCommon.h>
+#include <mitkFiberBundle.h>
+
+#include <mitkAbstractFileReader.h>
+
+namespace mitk
+{
+
+  /** \brief Reads fiber bundles stored in the compressed fiber format (see CompressedFiberFile).
+  */
+
+  class FiberBundleCompressedReader : public AbstractFileReader
+  {
+  public:
+
+    FiberBundleCompressedReader();
+    virtual ~FiberBundleCompressedReader(){}
+    FiberBundleCompressedReader(const FiberBundleCompressedReader& other);
+    virtual FiberBundleCompressedReader * Clone() const override;
+
+    using mitk::AbstractFileReader::Read;
+    virtual std::vector<itk::SmartPointer<BaseData> > Read() override;
+
+  private:
+
+    us::ServiceRegistration<mitk::IFileReader> m_ServiceReg;
+  };
+
+} //namespace MITK
+
+#endif // __mitkFiberBundleCompressedReader_h
@@ -0,0 +1,54 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include "mitkFiberBundleCompressedWriter.h"
+#include <itksys/SystemTools.hxx>
+#include <mitkCompressedFiberFile.h>
+#include <mitkCustomMimeType.h>
+#include "mitkDiffusionIOMimeTypes.h"
+
+mitk::FiberBundleCompressedWriter::FiberBundleCompressedWriter()
+    : mitk::AbstractFileWriter(mitk::FiberBundle::GetStaticNameOfClass(), mitk::DiffusionIOMimeTypes::FIBERBUNDLE_CFIB_MIMETYPE_NAME(), "Compressed Fiber Bundle Writer")
+{
+    RegisterService();
+}
+
+mitk::FiberBundleCompressedWriter::FiberBundleCompressedWriter(const mitk::FiberBundleCompressedWriter & other)
+    :mitk::AbstractFileWriter(other)
+{}
+
+mitk::FiberBundleCompressedWriter::~FiberBundleCompressedWriter()
+{}
+
+mitk::FiberBundleCompressedWriter * mitk::FiberBundleCompressedWriter::Clone() const
+{
+    return new mitk::FiberBundleCompressedWriter(*this);
+}
+
+void mitk::FiberBundleCompressedWriter::Write()
+{
+    if (this->GetOutputStream())
+        mitkThrow() << "Writing compressed fiber bundles to streams is not supported.";
+
+    mitk::FiberBundle::ConstPointer input = dynamic_cast<const mitk::FiberBundle*>(this->GetInput());
+    std::string ext = itksys::SystemTools::GetFilenameLastExtension(this->GetOutputLocation().c_str());
+    if(ext == "")
+        this->SetOutputLocation(this->GetOutputLocation() + ".cfib");
+
+    MITK_INFO << "Writing fiber bundle as CFIB";
+    CompressedFiberFile::Write(this->GetOutputLocation(), input.GetPointer());
+    MITK_INFO << "Fiber bundle written";
+}
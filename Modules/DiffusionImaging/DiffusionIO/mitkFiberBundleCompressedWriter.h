@@ -0,0 +1,48 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#ifndef __mitkFiberBundleCompressedWriter_h
+#define __mitkFiberBundleCompressedWriter_h
+
+#include <mitkAbstractFileWriter.h>
+
+#include "mitkFiberBundle.h"
+
+namespace mitk
+{
+
+/**
+ * Writes fiber bundles in the compressed fiber format (see CompressedFiberFile).
+ * @ingroup Process
+ */
+class FiberBundleCompressedWriter : public mitk::AbstractFileWriter
+{
+public:
+
+    FiberBundleCompressedWriter();
+    FiberBundleCompressedWriter(const FiberBundleCompressedWriter & other);
+    virtual FiberBundleCompressedWriter * Clone() const override;
+    virtual ~FiberBundleCompressedWriter();
+
+    using mitk::AbstractFileWriter::Write;
+    virtual void Write() override;
+
+};
+
+
+} // end of namespace mitk
+
+#endif //__mitkFiberBundleCompressedWriter_h
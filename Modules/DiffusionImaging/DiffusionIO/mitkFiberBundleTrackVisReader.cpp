@@ -68,10 +68,12 @@ std::vector<itk::SmartPointer<mitk::BaseData> > mitk::FiberBundleTrackVisReader:
         if (ext==".trk")
         {
             FiberBundle::Pointer image = FiberBundle::New();
-            TrackVisFiberReader reader;
-            reader.open(this->GetInputLocation().c_str());
-            reader.read(image.GetPointer());
+            TrackVisStreamReader reader;
+            if (!reader.Open(this->GetInputLocation()))
+                mitkThrow() << "Unable to open " << this->GetInputLocation();
+            reader.Read(image.GetPointer());
             result.push_back(image.GetPointer());
+            setlocale(LC_ALL, currLocale.c_str());
             return result;
         }
 
@@ -89,10 +89,12 @@ void mitk::FiberBundleTrackVisWriter::Write()
         }
 
         MITK_INFO << "Writing fiber bundle as TRK";
-        TrackVisFiberReader trk;
-        trk.create(filename, input.GetPointer());
-        trk.writeHdr();
-        trk.append(input.GetPointer());
+        TrackVisStreamWriter trk;
+        if (!trk.Create(filename, input.GetPointer()))
+            mitkThrow() << "Unable to create " << filename;
+        trk.AddFibers(input->GetFiberPolyData());
+        if (!trk.Close())
+            mitkThrow() << "Error while writing " << filename;
 
         setlocale(LC_ALL, currLocale.c_str());
         MITK_INFO << "Fiber bundle written";
@@ -59,6 +59,7 @@ protected:
     vnl_matrix_fixed<float, 3, 3>   m_RotationMatrix;
     SphereInterpolator*             m_SphereInterpolator;
     ParticleGrid*                   m_ParticleGrid;
+    ParticleGrid::NeighborTracker   m_NeighborTracker;  // own neighbour iteration state so that several energy computers can share one grid
     ItkRandGenType*                 m_RandGen;
     ItkFloatImageType*              m_Mask;
     vnl_vector_fixed<int, 3>        m_Size;
@@ -44,6 +44,11 @@ MetropolisHastingsSampler::MetropolisHastingsSampler(ParticleGrid* grid, EnergyC
     m_StopProb = exp(-1/m_TractProb);
 }
 
+MetropolisHastingsSampler::~MetropolisHastingsSampler()
+{
+
+}
+
 void MetropolisHastingsSampler::SetProbabilities(float birth, float death, float shift, float optShift, float connect)
 {
     m_BirthProb = birth;
@@ -116,26 +121,28 @@ void MetropolisHastingsSampler::MakeProposal()
     {
         m_BirthTime.Start();
         vnl_vector_fixed<float, 3> R;
-        m_EnergyComputer->DrawRandomPosition(R);
-        vnl_vector_fixed<float, 3> N = GetRandomDirection();
-        Particle prop;
-        prop.GetPos() = R;
-        prop.GetDir() = N;
+        if (DrawBirthPosition(R))
+        {
+            vnl_vector_fixed<float, 3> N = GetRandomDirection();
+            Particle prop;
+            prop.GetPos() = R;
+            prop.GetDir() = N;
 
-        float prob =  m_Density * m_DeathProb /((m_BirthProb)*(m_ParticleGrid->m_NumParticles+1));
+            float prob =  m_Density * m_DeathProb * GetBirthVolumeFraction() /((m_BirthProb)*(GetNumParticles()+1));
 
-        float ex_energy = m_EnergyComputer->ComputeExternalEnergy(R,N,nullptr);
-        float in_energy = m_EnergyComputer->ComputeInternalEnergy(&prop);
-        prob *= exp((in_energy/m_InTemp+ex_energy/m_ExTemp)) ;
+            float ex_energy = m_EnergyComputer->ComputeExternalEnergy(R,N,nullptr);
+            float in_energy = m_EnergyComputer->ComputeInternalEnergy(&prop);
+            prob *= exp((in_energy/m_InTemp+ex_energy/m_ExTemp)) ;
 
-        if (prob > 1 || m_RandGen->GetVariate() < prob)
-        {
-            Particle *p = m_ParticleGrid->NewParticle(R);
-            if (p!=nullptr)
+            if (prob > 1 || m_RandGen->GetVariate() < prob)
             {
-                p->GetPos() = R;
-                p->GetDir() = N;
-                m_AcceptedProposals++;
+                Particle *p = AddParticle(R);
+                if (p!=nullptr)
+                {
+                    p->GetPos() = R;
+                    p->GetDir() = N;
+                    m_AcceptedProposals++;
+                }
             }
         }
         m_BirthTime.Stop();
@@ -144,20 +151,20 @@ void MetropolisHastingsSampler::MakeProposal()
     else if (randnum < m_BirthProb+m_DeathProb)
     {
         m_DeathTime.Start();
-        if (m_ParticleGrid->m_NumParticles > 0)
+        if (GetNumParticles() > 0)
         {
-            int pnum = m_RandGen->GetIntegerVariate()%m_ParticleGrid->m_NumParticles;
+            int pnum = DrawParticle();
             Particle *dp = m_ParticleGrid->GetParticle(pnum);
             if (dp->pID == -1 && dp->mID == -1)
             {
                 float ex_energy = m_EnergyComputer->ComputeExternalEnergy(dp->GetPos(),dp->GetDir(),dp);
                 float in_energy = m_EnergyComputer->ComputeInternalEnergy(dp);
 
-                float prob = m_ParticleGrid->m_NumParticles * (m_BirthProb) /(m_Density*m_DeathProb); //*SpatProb(dp->R);
+                float prob = GetNumParticles() * (m_BirthProb) /(m_Density*m_DeathProb*GetBirthVolumeFraction()); //*SpatProb(dp->R);
                 prob *= exp(-(in_energy/m_InTemp+ex_energy/m_ExTemp)) ;
                 if (prob > 1 || m_RandGen->GetVariate() < prob)
                 {
-                    m_ParticleGrid->RemoveParticle(pnum);
+                    DeleteParticle(pnum);
                     m_AcceptedProposals++;
                 }
             }
@@ -167,10 +174,10 @@ void MetropolisHastingsSampler::MakeProposal()
     // Shift Proposal
     else  if (randnum < m_BirthProb+m_DeathProb+m_ShiftProb)
     {
-        if (m_ParticleGrid->m_NumParticles > 0)
+        if (GetNumParticles() > 0)
         {
             m_ShiftTime.Start();
-            int pnum = m_RandGen->GetIntegerVariate()%m_ParticleGrid->m_NumParticles;
+            int pnum = DrawParticle();
             Particle *p =  m_ParticleGrid->GetParticle(pnum);
             Particle prop_p = *p;
 
@@ -178,6 +185,11 @@ void MetropolisHastingsSampler::MakeProposal()
             DistortVector(m_Sigma/(2*m_ParticleLength), prop_p.GetDir());
             prop_p.GetDir().normalize();
 
+            if (!IsInsideDomain(prop_p.GetPos()) || !ConnectionsInsideDomain(p))
+            {
+                m_ShiftTime.Stop();
+                return;
+            }
 
             float ex_energy = m_EnergyComputer->ComputeExternalEnergy(prop_p.GetPos(),prop_p.GetDir(),p)
                     - m_EnergyComputer->ComputeExternalEnergy(p->GetPos(),p->GetDir(),p);
@@ -203,10 +215,10 @@ void MetropolisHastingsSampler::MakeProposal()
     // Optimal Shift Proposal
     else  if (randnum < m_BirthProb+m_DeathProb+m_ShiftProb+m_OptShiftProb)
     {
-        if (m_ParticleGrid->m_NumParticles > 0)
+        if (GetNumParticles() > 0)
         {
             m_OptShiftTime.Start();
-            int pnum = m_RandGen->GetIntegerVariate()%m_ParticleGrid->m_NumParticles;
+            int pnum = DrawParticle();
             Particle *p =  m_ParticleGrid->GetParticle(pnum);
 
             bool no_proposal = false;
@@ -239,6 +251,9 @@ void MetropolisHastingsSampler::MakeProposal()
             else
                 no_proposal = true;
 
+            if (!no_proposal && (!IsInsideDomain(prop_p.GetPos()) || !ConnectionsInsideDomain(p)))
+                no_proposal = true;
+
             if (!no_proposal)
             {
                 float cos = dot_product(prop_p.GetDir(), p->GetDir());
@@ -270,10 +285,10 @@ void MetropolisHastingsSampler::MakeProposal()
     // Connection Proposal
     else
     {
-        if (m_ParticleGrid->m_NumParticles > 0)
+        if (GetNumParticles() > 0)
         {
             m_ConnectionTime.Start();
-            int pnum = m_RandGen->GetIntegerVariate()%m_ParticleGrid->m_NumParticles;
+            int pnum = DrawParticle();
             Particle *p = m_ParticleGrid->GetParticle(pnum);
 
             EndPoint P;
@@ -331,6 +346,11 @@ void MetropolisHastingsSampler::RemoveAndSaveTrack(EndPoint P)
             if (Current.p->pID != -1)
             {
                 Next.p = m_ParticleGrid->GetParticle(Current.p->pID);
+                if (!IsInsideDomain(Next.p))  // track leaves the domain -> no proposal possible
+                {
+                    AccumProb = 0;
+                    break;
+                }
                 Current.p->pID = -1;
                 m_ParticleGrid->m_NumConnections--;
             }
@@ -340,6 +360,11 @@ void MetropolisHastingsSampler::RemoveAndSaveTrack(EndPoint P)
             if (Current.p->mID != -1)
             {
                 Next.p = m_ParticleGrid->GetParticle(Current.p->mID);
+                if (!IsInsideDomain(Next.p))
+                {
+                    AccumProb = 0;
+                    break;
+                }
                 Current.p->mID = -1;
                 m_ParticleGrid->m_NumConnections--;
             }
@@ -449,16 +474,16 @@ void MetropolisHastingsSampler::ComputeEndPointProposalDistribution(EndPoint P)
 
     float dist,dot;
     vnl_vector_fixed<float, 3> R = p->GetPos() + (p->GetDir() * (ep*m_ParticleLength) );
-    m_ParticleGrid->ComputeNeighbors(R);
+    m_ParticleGrid->ComputeNeighbors(R, m_NeighborTracker);
     m_SimpSamp.clear();
 
     m_SimpSamp.add(m_StopProb,EndPoint(nullptr,0));
 
     for (;;)
     {
-        Particle *p2 =  m_ParticleGrid->GetNextNeighbor();
+        Particle *p2 =  m_ParticleGrid->GetNextNeighbor(m_NeighborTracker);
         if (p2 == nullptr) break;
-        if (p!=p2 && p2->label == 0)
+        if (p!=p2 && p2->label == 0 && IsInsideDomain(p2))
         {
             if (p2->mID == -1)
             {
@@ -497,3 +522,53 @@ int MetropolisHastingsSampler::GetNumAcceptedProposals()
 }
 
 
+
+int MetropolisHastingsSampler::GetNumParticles()
+{
+    return m_ParticleGrid->m_NumParticles;
+}
+
+int MetropolisHastingsSampler::DrawParticle()
+{
+    return m_RandGen->GetIntegerVariate()%GetNumParticles();
+}
+
+bool MetropolisHastingsSampler::DrawBirthPosition(vnl_vector_fixed<float, 3>& R)
+{
+    m_EnergyComputer->DrawRandomPosition(R);
+    return true;
+}
+
+float MetropolisHastingsSampler::GetBirthVolumeFraction()
+{
+    return 1;
+}
+
+Particle* MetropolisHastingsSampler::AddParticle(vnl_vector_fixed<float, 3>& R)
+{
+    return m_ParticleGrid->NewParticle(R);
+}
+
+void MetropolisHastingsSampler::DeleteParticle(int pnum)
+{
+    m_ParticleGrid->RemoveParticle(pnum);
+}
+
+bool MetropolisHastingsSampler::IsInsideDomain(const vnl_vector_fixed<float, 3>& )
+{
+    return true;
+}
+
+bool MetropolisHastingsSampler::IsInsideDomain(Particle* )
+{
+    return true;
+}
+
+bool MetropolisHastingsSampler::ConnectionsInsideDomain(Particle* p)
+{
+    if (p->pID != -1 && !IsInsideDomain(m_ParticleGrid->GetParticle(p->pID)))
+        return false;
+    if (p->mID != -1 && !IsInsideDomain(m_ParticleGrid->GetParticle(p->mID)))
+        return false;
+    return true;
+}
@@ -45,6 +45,7 @@ public:
     typedef itk::Statistics::MersenneTwisterRandomVariateGenerator ItkRandGenType;
 
     MetropolisHastingsSampler(ParticleGrid* grid, EnergyComputer* enComp, ItkRandGenType* randGen, float curvThres);
+    virtual ~MetropolisHastingsSampler();
     void SetTemperature(float val);
 
     void MakeProposal();    ///< make proposal for birth/death/shift/connection of particles
@@ -64,6 +65,18 @@ protected:
     void DistortVector(float sigma, vnl_vector_fixed<float, 3>& vec);
     vnl_vector_fixed<float, 3> GetRandomDirection();
 
+    /** Particle access and domain restriction. The defaults operate on the whole grid.
+     * Subclasses restrict the sampler to a subdomain of the grid (see ParallelMetropolisHastingsSampler). */
+    virtual int GetNumParticles();                                      ///< number of particles the sampler operates on
+    virtual int DrawParticle();                                         ///< ID of a random particle
+    virtual bool DrawBirthPosition(vnl_vector_fixed<float, 3>& R);      ///< random position for birth proposals, false if no valid position was found
+    virtual float GetBirthVolumeFraction();                             ///< fraction of the total spatial probability covered by DrawBirthPosition
+    virtual Particle* AddParticle(vnl_vector_fixed<float, 3>& R);
+    virtual void DeleteParticle(int pnum);
+    virtual bool IsInsideDomain(const vnl_vector_fixed<float, 3>& R);
+    virtual bool IsInsideDomain(Particle* p);
+    bool ConnectionsInsideDomain(Particle* p);                          ///< true if all particles connected to p are inside the domain
+
     ItkRandGenType* m_RandGen;      ///< random generator
     Track       m_ProposalTrack;    ///< stores proposal track
     Track       m_BackupTrack;      ///< stores track removed for new proposal traCK
@@ -92,6 +105,7 @@ protected:
     float m_ChempotParticle;
 
     ParticleGrid*   m_ParticleGrid;         ///< storest all particles
+    ParticleGrid::NeighborTracker m_NeighborTracker;    ///< neighbour iteration state of the local tracking
     EnergyComputer* m_EnergyComputer;       ///< computes internal and external energy of particles
     unsigned int    m_AcceptedProposals;    ///< counts accepted proposals
 
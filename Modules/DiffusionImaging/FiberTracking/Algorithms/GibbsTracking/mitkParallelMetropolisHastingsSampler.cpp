@@ -0,0 +1,336 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include "mitkParallelMetropolisHastingsSampler.h"
+#include <algorithm>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+using namespace mitk;
+
+DomainMetropolisHastingsSampler::DomainMetropolisHastingsSampler(ParallelMetropolisHastingsSampler* parent, ParticleGrid* grid, EnergyComputer* enComp, ItkRandGenType* randGen, float curvThres)
+    : MetropolisHastingsSampler(grid, enComp, randGen, curvThres)
+    , m_Parent(parent)
+    , m_DomainMass(0)
+    , m_LastDrawnIndex(-1)
+{
+    m_MinCell.fill(0);
+    m_MaxCell.fill(0);
+}
+
+DomainMetropolisHastingsSampler::~DomainMetropolisHastingsSampler()
+{
+
+}
+
+void DomainMetropolisHastingsSampler::SetDomain(const vnl_vector_fixed<int, 3>& minCell, const vnl_vector_fixed<int, 3>& maxCell)
+{
+    m_MinCell = minCell;
+    m_MaxCell = maxCell;
+    m_DomainParticles.clear();
+    m_DomainCells.clear();
+    m_CumulatedCellMass.clear();
+    m_DomainMass = 0;
+    m_LastDrawnIndex = -1;
+
+    vnl_vector_fixed<int, 3> gridSize = m_ParticleGrid->GetGridSize();
+    vnl_vector_fixed<int, 3> cell;
+    for (cell[2] = m_MinCell[2]; cell[2] < m_MaxCell[2]; cell[2]++)
+        for (cell[1] = m_MinCell[1]; cell[1] < m_MaxCell[1]; cell[1]++)
+            for (cell[0] = m_MinCell[0]; cell[0] < m_MaxCell[0]; cell[0]++)
+            {
+                int idx = cell[0] + gridSize[0]*(cell[1] + gridSize[1]*cell[2]);
+                m_DomainMass += m_Parent->m_CellMass[idx];
+                m_DomainCells.push_back(idx);
+                m_CumulatedCellMass.push_back(m_DomainMass);
+
+                int count = m_ParticleGrid->GetOccupationCount(cell);
+                for (int i=0; i<count; i++)
+                    m_DomainParticles.push_back(m_ParticleGrid->GetCellParticle(cell, i)->ID);
+            }
+}
+
+float DomainMetropolisHastingsSampler::GetDomainMass()
+{
+    return m_DomainMass;
+}
+
+std::vector< int >& DomainMetropolisHastingsSampler::GetDetachedParticles()
+{
+    return m_DetachedParticles;
+}
+
+int DomainMetropolisHastingsSampler::GetNumParticles()
+{
+    return m_DomainParticles.size();
+}
+
+int DomainMetropolisHastingsSampler::DrawParticle()
+{
+    m_LastDrawnIndex = m_RandGen->GetIntegerVariate()%m_DomainParticles.size();
+    return m_DomainParticles.at(m_LastDrawnIndex);
+}
+
+bool DomainMetropolisHastingsSampler::DrawBirthPosition(vnl_vector_fixed<float, 3>& R)
+{
+    if (m_DomainMass <= 0)
+        return false;
+
+    // draw cell from the domain cells and voxel from the cell voxels
+    float r = m_RandGen->GetVariate()*m_DomainMass;
+    unsigned int c = std::upper_bound(m_CumulatedCellMass.begin(), m_CumulatedCellMass.end(), r) - m_CumulatedCellMass.begin();
+    if (c >= m_CumulatedCellMass.size())
+        c = m_CumulatedCellMass.size()-1;
+
+    const std::vector< float >& cumulatedMass = m_Parent->m_CellCumulatedMass.at(m_DomainCells.at(c));
+    if (cumulatedMass.empty())
+        return false;
+    r = m_RandGen->GetVariate()*cumulatedMass.back();
+    unsigned int v = std::upper_bound(cumulatedMass.begin(), cumulatedMass.end(), r) - cumulatedMass.begin();
+    if (v >= cumulatedMass.size())
+        v = cumulatedMass.size()-1;
+
+    int idx = m_Parent->m_CellVoxels.at(m_DomainCells.at(c)).at(v);
+    const vnl_vector_fixed<int, 3>& size = m_Parent->m_Size;
+    const vnl_vector_fixed<float, 3>& spacing = m_Parent->m_Spacing;
+    R[0] = spacing[0]*((float)(idx % size[0])  + m_RandGen->GetVariate());
+    R[1] = spacing[1]*((float)((idx/size[0]) % size[1])  + m_RandGen->GetVariate());
+    R[2] = spacing[2]*((float)(idx/(size[0]*size[1]))    + m_RandGen->GetVariate());
+
+    return IsInsideDomain(R);   // voxels are assigned to the cell containing their center and may reach into the neighboring cells
+}
+
+float DomainMetropolisHastingsSampler::GetBirthVolumeFraction()
+{
+    return m_DomainMass/m_Parent->m_TotalMass;
+}
+
+Particle* DomainMetropolisHastingsSampler::AddParticle(vnl_vector_fixed<float, 3>& R)
+{
+    // the container was enlarged before the sweep and must not be reallocated while other domains are sampled
+    Particle* p = nullptr;
+    m_Parent->m_BirthMutex.Lock();
+    if (m_ParticleGrid->m_NumParticles < m_ParticleGrid->GetContainerCapacity())
+        p = m_ParticleGrid->NewParticle(R);
+    m_Parent->m_BirthMutex.Unlock();
+
+    if (p!=nullptr)
+        m_DomainParticles.push_back(p->ID);
+    return p;
+}
+
+void DomainMetropolisHastingsSampler::DeleteParticle(int pnum)
+{
+    int i = m_LastDrawnIndex;
+    if (i<0 || i>=(int)m_DomainParticles.size() || m_DomainParticles.at(i)!=pnum)
+        i = std::find(m_DomainParticles.begin(), m_DomainParticles.end(), pnum) - m_DomainParticles.begin();
+
+    // removing the particle from the container would move the last particle, which may be part of another domain
+    m_ParticleGrid->DetachParticle(pnum);
+    m_DetachedParticles.push_back(pnum);
+
+    m_DomainParticles.at(i) = m_DomainParticles.back();
+    m_DomainParticles.pop_back();
+    m_LastDrawnIndex = -1;
+}
+
+bool DomainMetropolisHastingsSampler::IsInsideDomain(const vnl_vector_fixed<int, 3>& cell)
+{
+    return cell[0]>=m_MinCell[0] && cell[0]<m_MaxCell[0]
+        && cell[1]>=m_MinCell[1] && cell[1]<m_MaxCell[1]
+        && cell[2]>=m_MinCell[2] && cell[2]<m_MaxCell[2];
+}
+
+bool DomainMetropolisHastingsSampler::IsInsideDomain(const vnl_vector_fixed<float, 3>& R)
+{
+    vnl_vector_fixed<int, 3> cell;
+    if (!m_ParticleGrid->GetCellCoordinates(R, cell))
+        return false;
+    return IsInsideDomain(cell);
+}
+
+bool DomainMetropolisHastingsSampler::IsInsideDomain(Particle* p)
+{
+    return IsInsideDomain(m_ParticleGrid->GetCellCoordinates(p));
+}
+
+
+ParallelMetropolisHastingsSampler::ParallelMetropolisHastingsSampler(ParticleGrid* grid, std::vector< EnergyComputer* > energyComputers, ItkFloatImageType* mask, ItkRandGenType* randGen, float curvThres)
+    : m_ParticleGrid(grid)
+    , m_RandGen(randGen)
+    , m_TotalMass(0)
+    , m_DomainSize(GetMinDomainSize())
+{
+    for (unsigned int i=0; i<energyComputers.size(); i++)
+    {
+        m_RandGens.push_back(ItkRandGenType::New());
+        m_Samplers.push_back(new DomainMetropolisHastingsSampler(this, grid, energyComputers.at(i), m_RandGens.back(), curvThres));
+    }
+
+    for (int i=0; i<3; i++)
+    {
+        m_Size[i] = mask->GetLargestPossibleRegion().GetSize()[i];
+        m_Spacing[i] = mask->GetSpacing()[i];
+    }
+
+    // assign the active voxels to the grid cells containing their centers
+    vnl_vector_fixed<int, 3> gridSize = m_ParticleGrid->GetGridSize();
+    float cellSize = m_ParticleGrid->GetCellSize();
+    int numCells = gridSize[0]*gridSize[1]*gridSize[2];
+    m_CellVoxels.resize(numCells);
+    m_CellCumulatedMass.resize(numCells);
+    m_CellMass.resize(numCells, 0);
+
+    for (int z = 0; z < m_Size[2]; z++)
+        for (int y = 0; y < m_Size[1]; y++)
+            for (int x = 0; x < m_Size[0]; x++)
+            {
+                ItkFloatImageType::IndexType index;
+                index[0] = x; index[1] = y; index[2] = z;
+                float val = mask->GetPixel(index);
+                if (val <= 0.5)
+                    continue;
+
+                vnl_vector_fixed<float, 3> center;
+                center[0] = m_Spacing[0]*(x+0.5); center[1] = m_Spacing[1]*(y+0.5); center[2] = m_Spacing[2]*(z+0.5);
+                vnl_vector_fixed<int, 3> cell;
+                for (int i=0; i<3; i++)
+                    cell[i] = std::min(int(center[i]/cellSize), gridSize[i]-1);
+                int cellIdx = cell[0] + gridSize[0]*(cell[1] + gridSize[1]*cell[2]);
+
+                m_CellMass[cellIdx] += val;
+                m_CellVoxels[cellIdx].push_back(x + m_Size[0]*(y + m_Size[1]*z));
+                m_CellCumulatedMass[cellIdx].push_back(m_CellMass[cellIdx]);
+                m_TotalMass += val;
+            }
+}
+
+ParallelMetropolisHastingsSampler::~ParallelMetropolisHastingsSampler()
+{
+    for (unsigned int i=0; i<m_Samplers.size(); i++)
+        delete m_Samplers.at(i);
+}
+
+// the proposals of a domain read particles up to two cells outside of the domain (neighbors of the connection end points)
+int ParallelMetropolisHastingsSampler::GetMinDomainSize()
+{
+    return 3;
+}
+
+void ParallelMetropolisHastingsSampler::SetDomainSize(int cells)
+{
+    m_DomainSize = std::max(cells, GetMinDomainSize());
+}
+
+int ParallelMetropolisHastingsSampler::GetDomainSize()
+{
+    return m_DomainSize;
+}
+
+unsigned int ParallelMetropolisHastingsSampler::GetNumberOfThreads()
+{
+    return m_Samplers.size();
+}
+
+void ParallelMetropolisHastingsSampler::SetTemperature(float val)
+{
+    for (unsigned int i=0; i<m_Samplers.size(); i++)
+        m_Samplers.at(i)->SetTemperature(val);
+}
+
+int ParallelMetropolisHastingsSampler::GetNumAcceptedProposals()
+{
+    int accepted = 0;
+    for (unsigned int i=0; i<m_Samplers.size(); i++)
+        accepted += m_Samplers.at(i)->GetNumAcceptedProposals();
+    return accepted;
+}
+
+void ParallelMetropolisHastingsSampler::MakeProposals(unsigned long numProposals)
+{
+    if (m_TotalMass <= 0 || m_Samplers.empty())
+        return;
+
+    // randomly shifted partition of the grid into domains
+    vnl_vector_fixed<int, 3> gridSize = m_ParticleGrid->GetGridSize();
+    vnl_vector_fixed<int, 3> offset;
+    vnl_vector_fixed<int, 3> numDomains;
+    for (int i=0; i<3; i++)
+    {
+        offset[i] = m_RandGen->GetIntegerVariate()%m_DomainSize;
+        numDomains[i] = (gridSize[i] + offset[i] + m_DomainSize - 1)/m_DomainSize;
+    }
+    ItkRandGenType::IntegerType sweepSeed = m_RandGen->GetIntegerVariate();
+
+    // births must not reallocate the particle container during the sweep
+    m_ParticleGrid->ReserveParticles(m_ParticleGrid->m_NumParticles + numProposals + numDomains[0]*numDomains[1]*numDomains[2]);
+
+    int numThreads = m_Samplers.size();
+    for (int color=0; color<8; color++)
+    {
+        std::vector< int > domains;
+        for (int z=color/4; z<numDomains[2]; z+=2)
+            for (int y=(color/2)%2; y<numDomains[1]; y+=2)
+                for (int x=color%2; x<numDomains[0]; x+=2)
+                    domains.push_back(x + numDomains[0]*(y + numDomains[1]*z));
+
+#pragma omp parallel for schedule(dynamic) num_threads(numThreads)
+        for (int d=0; d<(int)domains.size(); d++)
+        {
+            int thread = 0;
+#ifdef _OPENMP
+            thread = omp_get_thread_num();
+#endif
+            int domainIdx = domains[d];
+            vnl_vector_fixed<int, 3> domain;
+            domain[0] = domainIdx % numDomains[0];
+            domain[1] = (domainIdx / numDomains[0]) % numDomains[1];
+            domain[2] = domainIdx / (numDomains[0]*numDomains[1]);
+
+            vnl_vector_fixed<int, 3> minCell, maxCell;
+            for (int i=0; i<3; i++)
+            {
+                minCell[i] = std::max(domain[i]*m_DomainSize - offset[i], 0);
+                maxCell[i] = std::min(domain[i]*m_DomainSize - offset[i] + m_DomainSize, gridSize[i]);
+            }
+
+            // seed per domain and not per thread to obtain results independent of the scheduling
+            m_RandGens.at(thread)->SetSeed(sweepSeed + 2654435761u*(domainIdx+1));
+
+            DomainMetropolisHastingsSampler* sampler = m_Samplers.at(thread);
+            sampler->SetDomain(minCell, maxCell);
+
+            double expected = (double)numProposals*sampler->GetDomainMass()/m_TotalMass;
+            unsigned long n = (unsigned long)expected;
+            if (m_RandGens.at(thread)->GetVariate() < expected-n)
+                n++;
+            for (unsigned long i=0; i<n; i++)
+                sampler->MakeProposal();
+        }
+
+        // compact the particle container
+        std::vector< int > detached;
+        for (unsigned int i=0; i<m_Samplers.size(); i++)
+        {
+            std::vector< int >& samplerDetached = m_Samplers.at(i)->GetDetachedParticles();
+            detached.insert(detached.end(), samplerDetached.begin(), samplerDetached.end());
+            samplerDetached.clear();
+        }
+        m_ParticleGrid->RemoveDetachedParticles(detached);
+    }
+}
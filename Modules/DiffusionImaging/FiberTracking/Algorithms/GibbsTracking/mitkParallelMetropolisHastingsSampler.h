@@ -0,0 +1,126 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#ifndef _PARALLELSAMPLER
+#define _PARALLELSAMPLER
+
+// MITK
+#include <MitkFiberTrackingExports.h>
+#include <mitkMetropolisHastingsSampler.h>
+
+// ITK
+#include <itkSimpleFastMutexLock.h>
+
+namespace mitk
+{
+
+class ParallelMetropolisHastingsSampler;
+
+/**
+* \brief Metropolis Hastings sampler restricted to a box of particle grid cells.
+*
+* All particles modified by the proposals of this sampler are located inside of the domain. Particles outside of the domain
+* are only read and deaths are deferred (see ParticleGrid::DetachParticle()), so that domains that are at least
+* ParallelMetropolisHastingsSampler::GetMinDomainSize() cells apart can be sampled concurrently.   */
+
+class MITKFIBERTRACKING_EXPORT DomainMetropolisHastingsSampler : public MetropolisHastingsSampler
+{
+public:
+
+    DomainMetropolisHastingsSampler(ParallelMetropolisHastingsSampler* parent, ParticleGrid* grid, EnergyComputer* enComp, ItkRandGenType* randGen, float curvThres);
+    virtual ~DomainMetropolisHastingsSampler();
+
+    void SetDomain(const vnl_vector_fixed<int, 3>& minCell, const vnl_vector_fixed<int, 3>& maxCell);  ///< first cell and end cell (exclusive) of the domain
+    float GetDomainMass();                          ///< spatial probability mass of the domain
+    std::vector< int >& GetDetachedParticles();     ///< particles removed from the grid that still have to be removed from the particle container
+
+protected:
+
+    int GetNumParticles() override;
+    int DrawParticle() override;
+    bool DrawBirthPosition(vnl_vector_fixed<float, 3>& R) override;
+    float GetBirthVolumeFraction() override;
+    Particle* AddParticle(vnl_vector_fixed<float, 3>& R) override;
+    void DeleteParticle(int pnum) override;
+    bool IsInsideDomain(const vnl_vector_fixed<float, 3>& R) override;
+    bool IsInsideDomain(Particle* p) override;
+
+    bool IsInsideDomain(const vnl_vector_fixed<int, 3>& cell);
+
+    ParallelMetropolisHastingsSampler*  m_Parent;
+    vnl_vector_fixed<int, 3>            m_MinCell;
+    vnl_vector_fixed<int, 3>            m_MaxCell;
+    std::vector< int >                  m_DomainParticles;          ///< IDs of the particles inside of the domain
+    std::vector< int >                  m_DomainCells;              ///< linear indices of the grid cells inside of the domain
+    std::vector< float >                m_CumulatedCellMass;        ///< cumulated spatial probability of the domain cells
+    std::vector< int >                  m_DetachedParticles;
+    float                               m_DomainMass;
+    int                                 m_LastDrawnIndex;           ///< index of the last particle returned by DrawParticle() in m_DomainParticles
+};
+
+/**
+* \brief Generates proposals of particle configurations in parallel.
+*
+* The particle grid is partitioned into cubic domains of GetDomainSize() cells that are colored like a 3D checkerboard.
+* Domains of the same color do not interact and are sampled concurrently, one color after the other. The partition
+* is shifted randomly in each sweep so that particles close to domain borders are not frozen. Every domain is sampled
+* with its own random generator seeded from the sweep and domain index, so the sampled particle configuration for a
+* fixed seed does not depend on the number of threads or the thread scheduling.   */
+
+class MITKFIBERTRACKING_EXPORT ParallelMetropolisHastingsSampler
+{
+public:
+
+    typedef itk::Image< float, 3 >  ItkFloatImageType;
+    typedef itk::Statistics::MersenneTwisterRandomVariateGenerator ItkRandGenType;
+
+    /** One energy computer per thread. The random generator is used to draw the partition offsets and domain seeds. */
+    ParallelMetropolisHastingsSampler(ParticleGrid* grid, std::vector< EnergyComputer* > energyComputers, ItkFloatImageType* mask, ItkRandGenType* randGen, float curvThres);
+    ~ParallelMetropolisHastingsSampler();
+
+    void SetTemperature(float val);
+    void MakeProposals(unsigned long numProposals);     ///< one sweep over all domains with approximately numProposals proposals in total
+    int GetNumAcceptedProposals();
+    unsigned int GetNumberOfThreads();
+
+    void SetDomainSize(int cells);  ///< edge length of the domains in grid cells (at least GetMinDomainSize())
+    int GetDomainSize();
+    static int GetMinDomainSize();
+
+protected:
+
+    friend class DomainMetropolisHastingsSampler;
+
+    ParticleGrid*                                   m_ParticleGrid;
+    ItkRandGenType*                                 m_RandGen;
+    std::vector< DomainMetropolisHastingsSampler* > m_Samplers;         ///< one sampler per thread
+    std::vector< ItkRandGenType::Pointer >          m_RandGens;         ///< random generator of each sampler
+    itk::SimpleFastMutexLock                        m_BirthMutex;       ///< guards the particle container during births
+
+    vnl_vector_fixed<int, 3>                        m_Size;             ///< mask size
+    vnl_vector_fixed<float, 3>                      m_Spacing;          ///< mask spacing
+    std::vector< std::vector< int > >               m_CellVoxels;       ///< active voxels of each grid cell (voxel center inside of the cell)
+    std::vector< std::vector< float > >             m_CellCumulatedMass;///< cumulated spatial probability of the cell voxels
+    std::vector< float >                            m_CellMass;
+    float                                           m_TotalMass;
+    int                                             m_DomainSize;
+};
+
+}
+
+#endif
+
+
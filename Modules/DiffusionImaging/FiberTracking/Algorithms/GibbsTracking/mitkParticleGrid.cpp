@@ -18,6 +18,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "mitkParticleGrid.h"
 #include <stdlib.h>
 #include <stdio.h>
+#include <algorithm>
 
 using namespace mitk;
 
@@ -48,8 +49,6 @@ ParticleGrid::ParticleGrid(ItkFloatImageType* image, float particleLength, int c
     m_Particles.resize(m_ContainerCapacity);        // allocate and initialize particles
     m_Grid.resize(gridSize, nullptr);   // allocate and initialize particle grid
     m_OccupationCount.resize(numCells, 0);          // allocate and initialize occupation counter array
-    m_NeighbourTracker.cellidx.resize(8, 0);        // allocate and initialize neighbour tracker
-    m_NeighbourTracker.cellidx_c.resize(8, 0);
 
     for (int i = 0;i < m_ContainerCapacity;i++)     // initialize particle IDs
         m_Particles[i].ID = i;
@@ -72,16 +71,12 @@ void ParticleGrid::ResetGrid()
     m_Particles.clear();
     m_Grid.clear();
     m_OccupationCount.clear();
-    m_NeighbourTracker.cellidx.clear();
-    m_NeighbourTracker.cellidx_c.clear();
 
     int numCells = m_GridSize[0]*m_GridSize[1]*m_GridSize[2];   // number of grid cells
 
     m_Particles.resize(m_ContainerCapacity);        // allocate and initialize particles
     m_Grid.resize(numCells*m_CellCapacity, nullptr);   // allocate and initialize particle grid
     m_OccupationCount.resize(numCells, 0);          // allocate and initialize occupation counter array
-    m_NeighbourTracker.cellidx.resize(8, 0);        // allocate and initialize neighbour tracker
-    m_NeighbourTracker.cellidx_c.resize(8, 0);
 
     for (int i = 0;i < m_ContainerCapacity;i++)     // initialize particle IDs
         m_Particles[i].ID = i;
@@ -89,12 +84,18 @@ void ParticleGrid::ResetGrid()
 
 bool ParticleGrid::ReallocateGrid()
 {
-    int new_capacity = m_ContainerCapacity + 100000;    // increase container capacity by 100k particles
+    return ReserveParticles(m_ContainerCapacity + 100000);  // increase container capacity by 100k particles
+}
+
+bool ParticleGrid::ReserveParticles(int new_capacity)
+{
+    if (new_capacity <= m_ContainerCapacity)
+        return true;
     try
     {
         m_Particles.resize(new_capacity);                   // reallocate particles
 
-        for (int i = 0; i<m_ContainerCapacity; i++)         // update particle addresses (changed during reallocation)
+        for (int i = 0; i<m_NumParticles; i++)              // update particle addresses (changed during reallocation)
             m_Grid[m_Particles[i].gridindex] = &m_Particles[i];
 
         for (int i = m_ContainerCapacity; i < new_capacity; i++)    // initialize IDs of ne particles
@@ -212,6 +213,12 @@ bool ParticleGrid::TryUpdateGrid(int k)
 }
 
 void ParticleGrid::RemoveParticle(int k)
+{
+    DetachParticle(k);
+    RemoveFromContainer(k);
+}
+
+void ParticleGrid::DetachParticle(int k)
 {
     Particle* p = &(m_Particles[k]);
     int gridIndex = p->gridindex;
@@ -231,9 +238,21 @@ void ParticleGrid::RemoveParticle(int k)
         m_Grid[cellIdx*m_CellCapacity+m_OccupationCount[cellIdx]-1] = nullptr;
         m_Grid[gridIndex]->gridindex = gridIndex;
     }
+    else
+        m_Grid[gridIndex] = nullptr;
     m_OccupationCount[cellIdx]--;
+}
+
+void ParticleGrid::RemoveDetachedParticles(std::vector< int > ids)
+{
+    // remove in descending order so that only particles still contained in the grid are moved into the freed slots
+    std::sort(ids.begin(), ids.end());
+    for (int i=ids.size()-1; i>=0; i--)
+        RemoveFromContainer(ids.at(i));
+}
 
-    // remove from container
+void ParticleGrid::RemoveFromContainer(int k)
+{
     if (k < m_NumParticles-1)
     {
         Particle* last = &m_Particles[m_NumParticles-1];  // last particle
@@ -263,6 +282,16 @@ void ParticleGrid::RemoveParticle(int k)
 }
 
 void ParticleGrid::ComputeNeighbors(vnl_vector_fixed<float, 3> &R)
+{
+    ComputeNeighbors(R, m_NeighbourTracker);
+}
+
+Particle* ParticleGrid::GetNextNeighbor()
+{
+    return GetNextNeighbor(m_NeighbourTracker);
+}
+
+void ParticleGrid::ComputeNeighbors(vnl_vector_fixed<float, 3> &R, NeighborTracker& tracker)
 {
     float xfrac = R[0]*m_GridScale[0];
     float yfrac = R[1]*m_GridScale[1];
@@ -290,48 +319,96 @@ void ParticleGrid::ComputeNeighbors(vnl_vector_fixed<float, 3> &R)
     if (m_GridSize[2] <= 1) { dz = 0; } // Necessary with 2d images (bug 15416)
 
 
-    m_NeighbourTracker.cellidx[0] = xint + m_GridSize[0]*(yint+zint*m_GridSize[1]);
-    m_NeighbourTracker.cellidx[1] = m_NeighbourTracker.cellidx[0] + dx;
-    m_NeighbourTracker.cellidx[2] = m_NeighbourTracker.cellidx[1] + dy*m_GridSize[0];
-    m_NeighbourTracker.cellidx[3] = m_NeighbourTracker.cellidx[2] - dx;
-    m_NeighbourTracker.cellidx[4] = m_NeighbourTracker.cellidx[0] + dz*m_GridSize[0]*m_GridSize[1];
-    m_NeighbourTracker.cellidx[5] = m_NeighbourTracker.cellidx[4] + dx;
-    m_NeighbourTracker.cellidx[6] = m_NeighbourTracker.cellidx[5] + dy*m_GridSize[0];
-    m_NeighbourTracker.cellidx[7] = m_NeighbourTracker.cellidx[6] - dx;
+    tracker.cellidx[0] = xint + m_GridSize[0]*(yint+zint*m_GridSize[1]);
+    tracker.cellidx[1] = tracker.cellidx[0] + dx;
+    tracker.cellidx[2] = tracker.cellidx[1] + dy*m_GridSize[0];
+    tracker.cellidx[3] = tracker.cellidx[2] - dx;
+    tracker.cellidx[4] = tracker.cellidx[0] + dz*m_GridSize[0]*m_GridSize[1];
+    tracker.cellidx[5] = tracker.cellidx[4] + dx;
+    tracker.cellidx[6] = tracker.cellidx[5] + dy*m_GridSize[0];
+    tracker.cellidx[7] = tracker.cellidx[6] - dx;
 
 
-    m_NeighbourTracker.cellidx_c[0] = m_CellCapacity*m_NeighbourTracker.cellidx[0];
-    m_NeighbourTracker.cellidx_c[1] = m_CellCapacity*m_NeighbourTracker.cellidx[1];
-    m_NeighbourTracker.cellidx_c[2] = m_CellCapacity*m_NeighbourTracker.cellidx[2];
-    m_NeighbourTracker.cellidx_c[3] = m_CellCapacity*m_NeighbourTracker.cellidx[3];
-    m_NeighbourTracker.cellidx_c[4] = m_CellCapacity*m_NeighbourTracker.cellidx[4];
-    m_NeighbourTracker.cellidx_c[5] = m_CellCapacity*m_NeighbourTracker.cellidx[5];
-    m_NeighbourTracker.cellidx_c[6] = m_CellCapacity*m_NeighbourTracker.cellidx[6];
-    m_NeighbourTracker.cellidx_c[7] = m_CellCapacity*m_NeighbourTracker.cellidx[7];
+    tracker.cellidx_c[0] = m_CellCapacity*tracker.cellidx[0];
+    tracker.cellidx_c[1] = m_CellCapacity*tracker.cellidx[1];
+    tracker.cellidx_c[2] = m_CellCapacity*tracker.cellidx[2];
+    tracker.cellidx_c[3] = m_CellCapacity*tracker.cellidx[3];
+    tracker.cellidx_c[4] = m_CellCapacity*tracker.cellidx[4];
+    tracker.cellidx_c[5] = m_CellCapacity*tracker.cellidx[5];
+    tracker.cellidx_c[6] = m_CellCapacity*tracker.cellidx[6];
+    tracker.cellidx_c[7] = m_CellCapacity*tracker.cellidx[7];
 
-    m_NeighbourTracker.cellcnt = 0;
-    m_NeighbourTracker.pcnt = 0;
+    tracker.cellcnt = 0;
+    tracker.pcnt = 0;
 }
 
-Particle* ParticleGrid::GetNextNeighbor()
+Particle* ParticleGrid::GetNextNeighbor(NeighborTracker& tracker)
 {
-    if (m_NeighbourTracker.pcnt < m_OccupationCount[m_NeighbourTracker.cellidx[m_NeighbourTracker.cellcnt]])
+    if (tracker.pcnt < m_OccupationCount[tracker.cellidx[tracker.cellcnt]])
     {
-        return m_Grid[m_NeighbourTracker.cellidx_c[m_NeighbourTracker.cellcnt] + (m_NeighbourTracker.pcnt++)];
+        return m_Grid[tracker.cellidx_c[tracker.cellcnt] + (tracker.pcnt++)];
     }
     else
     {
         for(;;)
         {
-            m_NeighbourTracker.cellcnt++;
-            if (m_NeighbourTracker.cellcnt >= 8)
+            tracker.cellcnt++;
+            if (tracker.cellcnt >= 8)
                 return nullptr;
-            if (m_OccupationCount[m_NeighbourTracker.cellidx[m_NeighbourTracker.cellcnt]] > 0)
+            if (m_OccupationCount[tracker.cellidx[tracker.cellcnt]] > 0)
                 break;
         }
-        m_NeighbourTracker.pcnt = 1;
-        return m_Grid[m_NeighbourTracker.cellidx_c[m_NeighbourTracker.cellcnt]];
+        tracker.pcnt = 1;
+        return m_Grid[tracker.cellidx_c[tracker.cellcnt]];
+    }
+}
+
+bool ParticleGrid::GetCellCoordinates(const vnl_vector_fixed<float, 3>& R, vnl_vector_fixed<int, 3>& cell)
+{
+    for (int i=0; i<3; i++)
+    {
+        if (R[i] < 0)
+            return false;
+        cell[i] = int(R[i]*m_GridScale[i]);
+        if (cell[i] >= m_GridSize[i])
+            return false;
     }
+    return true;
+}
+
+vnl_vector_fixed<int, 3> ParticleGrid::GetCellCoordinates(Particle* p)
+{
+    int cellIdx = p->gridindex/m_CellCapacity;
+    vnl_vector_fixed<int, 3> cell;
+    cell[0] = cellIdx % m_GridSize[0];
+    cell[1] = (cellIdx / m_GridSize[0]) % m_GridSize[1];
+    cell[2] = cellIdx / (m_GridSize[0]*m_GridSize[1]);
+    return cell;
+}
+
+vnl_vector_fixed<int, 3> ParticleGrid::GetGridSize()
+{
+    return m_GridSize;
+}
+
+float ParticleGrid::GetCellSize()
+{
+    return 1/m_GridScale[0];
+}
+
+int ParticleGrid::GetOccupationCount(const vnl_vector_fixed<int, 3>& cell)
+{
+    return m_OccupationCount[cell[0] + m_GridSize[0]*(cell[1] + m_GridSize[1]*cell[2])];
+}
+
+Particle* ParticleGrid::GetCellParticle(const vnl_vector_fixed<int, 3>& cell, int i)
+{
+    return m_Grid[m_CellCapacity*(cell[0] + m_GridSize[0]*(cell[1] + m_GridSize[1]*cell[2])) + i];
+}
+
+int ParticleGrid::GetContainerCapacity()
+{
+    return m_ContainerCapacity;
 }
 
 void ParticleGrid::CreateConnection(Particle *P1,int ep1, Particle *P2, int ep2)
@@ -24,6 +24,9 @@ See LICENSE.txt or http://www.mitk.org for details.
 // ITK
 #include <itkImage.h>
 
+// MISC
+#include <atomic>
+
 namespace mitk
 {
 
@@ -37,9 +40,19 @@ public:
 
     typedef itk::Image< float, 3 >  ItkFloatImageType;
 
-    int m_NumParticles;         // number of particles
-    int m_NumConnections;       // number of connections
-    int m_NumCellOverflows;     // number of cell overflows
+    struct NeighborTracker  // to run over the neighbors
+    {
+        std::vector< int > cellidx;
+        std::vector< int > cellidx_c;
+        int cellcnt;
+        int pcnt;
+
+        NeighborTracker() : cellidx(8, 0), cellidx_c(8, 0), cellcnt(0), pcnt(0) {}
+    };
+
+    int m_NumParticles;                     // number of particles
+    std::atomic<int> m_NumConnections;      // number of connections (atomic since concurrently modified by the ParallelMetropolisHastingsSampler)
+    std::atomic<int> m_NumCellOverflows;    // number of cell overflows
     float m_ParticleLength;
 
     ParticleGrid(ItkFloatImageType* image, float particleLength, int cellCapacity);
@@ -54,6 +67,28 @@ public:
     void ComputeNeighbors(vnl_vector_fixed<float, 3> &R);
     Particle* GetNextNeighbor();
 
+    /** Thread safe neighbor iteration using an external tracker instead of the internal one. */
+    void ComputeNeighbors(vnl_vector_fixed<float, 3> &R, NeighborTracker& tracker);
+    Particle* GetNextNeighbor(NeighborTracker& tracker);
+
+    /** Grid cell containing the position. Returns false if the position is outside of the grid. */
+    bool GetCellCoordinates(const vnl_vector_fixed<float, 3>& R, vnl_vector_fixed<int, 3>& cell);
+    /** Grid cell containing the particle. */
+    vnl_vector_fixed<int, 3> GetCellCoordinates(Particle* p);
+    vnl_vector_fixed<int, 3> GetGridSize();
+    float GetCellSize();
+    int GetOccupationCount(const vnl_vector_fixed<int, 3>& cell);
+    Particle* GetCellParticle(const vnl_vector_fixed<int, 3>& cell, int i);
+
+    /** Grow the particle container so that it can hold at least the given number of particles without reallocation. */
+    bool ReserveParticles(int numParticles);
+    int GetContainerCapacity();
+
+    /** Remove particle from the grid and destroy its connections but keep its slot in the particle container.
+     * The container is compacted with RemoveDetachedParticles(). Allows removal while other particles are accessed concurrently. */
+    void DetachParticle(int k);
+    void RemoveDetachedParticles(std::vector< int > ids);
+
     void CreateConnection(Particle *P1,int ep1, Particle *P2, int ep2);
     void DestroyConnection(Particle *P1,int ep1, Particle *P2, int ep2);
     void DestroyConnection(Particle *P1,int ep1);
@@ -64,6 +99,7 @@ public:
 protected:
 
     bool ReallocateGrid();
+    void RemoveFromContainer(int k);
 
     std::vector< Particle* >    m_Grid;             // the grid
     std::vector< Particle >     m_Particles;        // particle container
@@ -76,13 +112,7 @@ protected:
 
     int m_CellCapacity;      // particle capacity of single cell in grid
 
-    struct NeighborTracker  // to run over the neighbors
-    {
-        std::vector< int > cellidx;
-        std::vector< int > cellidx_c;
-        int cellcnt;
-        int pcnt;
-    } m_NeighbourTracker;
+    NeighborTracker m_NeighbourTracker;
 
 };
 
@@ -26,6 +26,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <itkImageRegionConstIteratorWithIndex.h>
 #include <itkImageRegionIterator.h>
 #include <itkImageFileWriter.h>
+#include <algorithm>
 //#include <boost/thread/thread.hpp>
 
 #define _USE_MATH_DEFINES
@@ -47,6 +48,7 @@ MLBSTrackingFilter< NumImageFeatures >
     , m_SeedsPerVoxel(1)
     , m_UseDirection(true)
     , m_NumberOfSamples(50)
+    , m_StreamlineBatchSize(16)
     , m_SamplingDistance(-1)
     , m_SeedImage(NULL)
     , m_MaskImage(NULL)
@@ -110,6 +112,10 @@ void MLBSTrackingFilter< NumImageFeatures >::BeforeThreadedGenerateData()
         PolyDataType poly = PolyDataType::New();
         m_PolyDataContainer.push_back(poly);
     }
+    m_ThreadTractograms.clear();
+    m_ThreadTractograms.resize(this->GetNumberOfThreads());
+
+    m_FlatForest.Initialize(*m_DecisionForest);
 
     m_NotWmImage = ItkDoubleImgType::New();
     m_NotWmImage->SetSpacing( m_FeatureImage->GetSpacing() );
@@ -325,49 +331,52 @@ typename MLBSTrackingFilter< NumImageFeatures >::FeatureImageType::PixelType MLB
         tmpIdx = idx; tmpIdx[0]++; tmpIdx[1]++; tmpIdx[2]++;
         pix +=  m_FeatureImage->GetPixel(tmpIdx) * interpWeights[7];
     }
+
+    return pix;
 }
 
 template< int NumImageFeatures >
 vnl_vector_fixed<double,3> MLBSTrackingFilter< NumImageFeatures >::Classify(itk::Point<double, 3>& pos, int& candidates, vnl_vector_fixed<double,3>& olddir, double angularThreshold, double& prob, bool avoidStop)
 {
-    vnl_vector_fixed<double,3> direction; direction.fill(0);
+    vigra::MultiArray<2, double> featureData(vigra::Shape2(1, GetNumberOfFeatures()));
+    SetFeatures(pos, olddir, featureData, 0);
 
-    vigra::MultiArray<2, double> featureData;
-    if(m_UseDirection)
-        featureData = vigra::MultiArray<2, double>( vigra::Shape2(1,NumImageFeatures+3) );
-    else
-        featureData = vigra::MultiArray<2, double>( vigra::Shape2(1,NumImageFeatures) );
+    vigra::MultiArray<2, double> probs(vigra::Shape2(1, m_FlatForest.GetClassCount()));
+    m_FlatForest.PredictProbabilities(featureData, probs);
 
+    return EvaluateProbabilities(probs, 0, pos, candidates, olddir, angularThreshold, prob, avoidStop);
+}
+
+template< int NumImageFeatures >
+void MLBSTrackingFilter< NumImageFeatures >::SetFeatures(const itk::Point<double, 3>& pos, const vnl_vector_fixed<double,3>& olddir, vigra::MultiArray<2, double>& featureData, int row)
+{
     typename FeatureImageType::PixelType featurePixel = GetImageValues(pos);
 
     // pixel values
     for (unsigned int f=0; f<NumImageFeatures; f++)
-        featureData(0,f) = featurePixel[f];
+        featureData(row,f) = featurePixel[f];
 
     // direction features
-    int c = 0;
     if (m_UseDirection)
     {
         vnl_vector_fixed<double,3> ref; ref.fill(0); ref[0]=1;
-        for (unsigned int f=NumImageFeatures; f<NumImageFeatures+3; f++)
-        {
-            if (dot_product(ref, olddir)<0)
-                featureData(0,f) = -olddir[c];
-            else
-                featureData(0,f) = olddir[c];
-            c++;
-        }
+        double sign = dot_product(ref, olddir)<0 ? -1 : 1;
+        for (unsigned int c=0; c<3; c++)
+            featureData(row,NumImageFeatures+c) = sign*olddir[c];
     }
+}
 
-    vigra::MultiArray<2, double> probs(vigra::Shape2(1, m_DecisionForest->class_count()));
-    m_DecisionForest->predictProbabilities(featureData, probs);
+template< int NumImageFeatures >
+vnl_vector_fixed<double,3> MLBSTrackingFilter< NumImageFeatures >::EvaluateProbabilities(const vigra::MultiArray<2, double>& probs, int row, itk::Point<double, 3>& pos, int& candidates, vnl_vector_fixed<double,3>& olddir, double angularThreshold, double& prob, bool avoidStop)
+{
+    vnl_vector_fixed<double,3> direction; direction.fill(0);
 
     double outProb = 0;
     prob = 0;
     candidates = 0; // directions with probability > 0
     for (int i=0; i<m_DecisionForest->class_count(); i++)
     {
-        if (probs(0,i)>0)
+        if (probs(row,i)>0)
         {
             int classLabel = 0;
             m_DecisionForest->ext_param_.to_classlabel(i, classLabel);
@@ -386,18 +395,18 @@ vnl_vector_fixed<double,3> MLBSTrackingFilter< NumImageFeatures >::Classify(itk:
                         if (dot<0)
                             d *= -1;
                         dot = fabs(dot);
-                        direction += probs(0,i)*dot*d;
-                        prob += probs(0,i)*dot;
+                        direction += probs(row,i)*dot*d;
+                        prob += probs(row,i)*dot;
                     }
                 }
                 else
                 {
-                    direction += probs(0,i)*d;
-                    prob += probs(0,i);
+                    direction += probs(row,i)*d;
+                    prob += probs(row,i);
                 }
             }
             else
-                outProb += probs(0,i);
+                outProb += probs(row,i);
         }
     }
 
@@ -430,144 +439,307 @@ double MLBSTrackingFilter< NumImageFeatures >::GetRandDouble(double min, double
 template< int NumImageFeatures >
 vnl_vector_fixed<double,3> MLBSTrackingFilter< NumImageFeatures >::GetNewDirection(itk::Point<double, 3> &pos, vnl_vector_fixed<double, 3>& olddir)
 {
-    vnl_vector_fixed<double,3> direction; direction.fill(0);
+    std::vector< itk::Point<double, 3> > positions(1, pos);
+    std::vector< vnl_vector_fixed<double,3> > olddirs(1, olddir);
+    std::vector< vnl_vector_fixed<double,3> > directions;
+    GetNewDirections(positions, olddirs, directions);
+    olddir = olddirs.at(0);
+    return directions.at(0);
+}
+
+template< int NumImageFeatures >
+void MLBSTrackingFilter< NumImageFeatures >::GetNewDirections(const std::vector< itk::Point<double, 3> >& positions, std::vector< vnl_vector_fixed<double,3> >& olddirs, std::vector< vnl_vector_fixed<double,3> >& directions)
+{
+    vnl_vector_fixed<double,3> zero; zero.fill(0);
+    directions.assign(positions.size(), zero);
 
-    ItkUcharImgType::IndexType idx;
-    m_StoppingRegions->TransformPhysicalPointToIndex(pos, idx);
-    if (m_StoppingRegions->GetPixel(idx)>0)
-        return direction;
+    // the current position and the probe positions of each streamline are consecutive rows of one feature matrix
+    itk::OrientationDistributionFunction< double, 50 >  probeVecs;
+    std::vector< int > firstRows(positions.size(), -1);
+    int numRows = 0;
+    for (unsigned int s=0; s<positions.size(); s++)
+    {
+        ItkUcharImgType::IndexType idx;
+        m_StoppingRegions->TransformPhysicalPointToIndex(positions.at(s), idx);
+        if (m_StoppingRegions->GetPixel(idx)>0)
+            continue;
 
-    if (olddir.magnitude()>0)
-        olddir.normalize();
+        if (olddirs.at(s).magnitude()>0)
+            olddirs.at(s).normalize();
+        firstRows.at(s) = numRows;
+        numRows += 1+m_NumberOfSamples;
+    }
+    if (numRows==0)
+        return;
 
-    int candidates = 0; // number of directions with probability > 0
-    double prob = 0;
-    direction = Classify(pos, candidates, olddir, m_AngularThreshold, prob); // sample neighborhood
-    direction *= prob;
+    vigra::MultiArray<2, double> featureData(vigra::Shape2(numRows, GetNumberOfFeatures()));
+    std::vector< itk::Point<double, 3> > rowPositions(numRows);
+    for (unsigned int s=0; s<positions.size(); s++)
+    {
+        int row = firstRows.at(s);
+        if (row<0)
+            continue;
 
+        const itk::Point<double, 3>& pos = positions.at(s);
+        rowPositions.at(row) = pos;
+        for (int i=0; i<m_NumberOfSamples; i++)
+        {
+            vnl_vector_fixed<double,3> d = probeVecs.GetDirection(i)*m_SamplingDistance;
+            itk::Point<double, 3>& sample_pos = rowPositions.at(row+1+i);
+            sample_pos[0] = pos[0] + d[0];
+            sample_pos[1] = pos[1] + d[1];
+            sample_pos[2] = pos[2] + d[2];
+        }
+        for (int r=row; r<=row+m_NumberOfSamples; r++)
+            SetFeatures(rowPositions.at(r), olddirs.at(s), featureData, r);
+    }
 
-    itk::OrientationDistributionFunction< double, 50 >  probeVecs;
+    vigra::MultiArray<2, double> probs(vigra::Shape2(numRows, m_FlatForest.GetClassCount()));
+    m_FlatForest.PredictProbabilities(featureData, probs);
 
-    for (int i=0; i<m_NumberOfSamples; i++)
+    std::vector< itk::Point<double, 3> > avoidStopPositions;
+    std::vector< vnl_vector_fixed<double,3> > avoidStopProbes;
+    std::vector< int > avoidStopStreamlines;
+    for (unsigned int s=0; s<positions.size(); s++)
     {
-        vnl_vector_fixed<double,3> d;
-//        probe[0] = GetRandDouble()*m_SamplingDistance;
-//        probe[1] = GetRandDouble()*m_SamplingDistance;
-//        probe[2] = GetRandDouble()*m_SamplingDistance;
+        int row = firstRows.at(s);
+        if (row<0)
+            continue;
 
-        d = probeVecs.GetDirection(i)*m_SamplingDistance;
+        vnl_vector_fixed<double,3>& olddir = olddirs.at(s);
+        vnl_vector_fixed<double,3>& direction = directions.at(s);
 
-        itk::Point<double, 3> sample_pos;
-        sample_pos[0] = pos[0] + d[0];
-        sample_pos[1] = pos[1] + d[1];
-        sample_pos[2] = pos[2] + d[2];
+        int candidates = 0; // number of directions with probability > 0
+        double prob = 0;
+        direction = EvaluateProbabilities(probs, row, rowPositions.at(row), candidates, olddir, m_AngularThreshold, prob, false); // sample neighborhood
+        direction *= prob;
 
-        candidates = 0;
-        vnl_vector_fixed<double,3> tempDir = Classify(sample_pos, candidates, olddir, m_AngularThreshold, prob); // sample neighborhood
-        if (candidates>0 && tempDir.magnitude()>0.001)
+        for (int i=0; i<m_NumberOfSamples; i++)
         {
-            direction += tempDir*prob;
+            candidates = 0;
+            vnl_vector_fixed<double,3> tempDir = EvaluateProbabilities(probs, row+1+i, rowPositions.at(row+1+i), candidates, olddir, m_AngularThreshold, prob, false); // sample neighborhood
+            if (candidates>0 && tempDir.magnitude()>0.001)
+            {
+                direction += tempDir*prob;
+            }
+            else if (m_AvoidStop && candidates==0 && olddir.magnitude()>0) // out of white matter
+            {
+                vnl_vector_fixed<double,3> d = probeVecs.GetDirection(i)*m_SamplingDistance;
+                double dot = dot_product(d, olddir);
+                if (dot >= 0.0) // in front of plane defined by pos and olddir
+                    d = -d + 2*dot*olddir; // reflect
+                else
+                    d = -d; // invert
+
+                // look a bit further into the other direction
+                itk::Point<double, 3> sample_pos;
+                sample_pos[0] = positions.at(s)[0] + d[0]*2;
+                sample_pos[1] = positions.at(s)[1] + d[1]*2;
+                sample_pos[2] = positions.at(s)[2] + d[2]*2;
+                avoidStopPositions.push_back(sample_pos);
+                avoidStopProbes.push_back(d);
+                avoidStopStreamlines.push_back(s);
+            }
         }
-        else if (m_AvoidStop && candidates==0 && olddir.magnitude()>0) // out of white matter
-        {
-            double dot = dot_product(d, olddir);
-            if (dot >= 0.0) // in front of plane defined by pos and olddir
-                d = -d + 2*dot*olddir; // reflect
-            else
-                d = -d; // invert
+    }
 
-            // look a bit further into the other direction
-            sample_pos[0] = pos[0] + d[0]*2;
-            sample_pos[1] = pos[1] + d[1]*2;
-            sample_pos[2] = pos[2] + d[2]*2;
-            candidates = 0;
-            vnl_vector_fixed<double,3> tempDir = Classify(sample_pos, candidates, olddir, m_AngularThreshold, prob, true); // sample neighborhood
+    // second batch for the probes of all streamlines that left the white matter
+    if (!avoidStopPositions.empty())
+    {
+        featureData.reshape(vigra::Shape2(avoidStopPositions.size(), GetNumberOfFeatures()));
+        for (unsigned int i=0; i<avoidStopPositions.size(); i++)
+            SetFeatures(avoidStopPositions.at(i), olddirs.at(avoidStopStreamlines.at(i)), featureData, i);
+        probs.reshape(vigra::Shape2(avoidStopPositions.size(), m_FlatForest.GetClassCount()));
+        m_FlatForest.PredictProbabilities(featureData, probs);
+
+        for (unsigned int i=0; i<avoidStopPositions.size(); i++)
+        {
+            int s = avoidStopStreamlines.at(i);
+            int candidates = 0;
+            double prob = 0;
+            vnl_vector_fixed<double,3> tempDir = EvaluateProbabilities(probs, i, avoidStopPositions.at(i), candidates, olddirs.at(s), m_AngularThreshold, prob, true); // sample neighborhood
 
             if (candidates>0 && tempDir.magnitude()>0.001)  // are we back in the white matter?
             {
-                direction += d;         // go into the direction of the white matter
-                direction += tempDir*prob;  // go into the direction of the white matter direction at this location
+                directions.at(s) += avoidStopProbes.at(i);  // go into the direction of the white matter
+                directions.at(s) += tempDir*prob;           // go into the direction of the white matter direction at this location
             }
         }
     }
 
-    if (direction.magnitude()>0.001)
+    for (unsigned int s=0; s<positions.size(); s++)
+    {
+        vnl_vector_fixed<double,3>& direction = directions.at(s);
+        if (direction.magnitude()>0.001)
+        {
+            direction.normalize();
+            olddirs.at(s) = direction;
+        }
+        else
+            direction.fill(0);
+    }
+}
+
+template< int NumImageFeatures >
+bool MLBSTrackingFilter< NumImageFeatures >::StepStreamline(Streamline& streamline)
+{
+    while (m_PauseTracking){}
+    if (m_DemoMode)
     {
-        direction.normalize();
-        olddir[0] = direction[0];
-        olddir[1] = direction[1];
-        olddir[2] = direction[2];
+        m_Mutex.Lock();
+        m_BuildFibersReady++;
+        m_Tractogram.push_back(streamline.fib);
+        BuildFibers(true);
+        m_Stop = true;
+        m_Mutex.Unlock();
+        while (m_Stop){}
     }
+
+    // get new position
+    CalculateNewPosition(streamline.pos, streamline.dir);
+
+    // is new position inside of image and mask
+    if (!IsValidPosition(streamline.pos) || m_AbortTracking)   // if not end streamline
+        return false;
+
+    // if yes, add new point to streamline
+    streamline.tractLength +=  m_StepSize;
+    if (streamline.front)
+        streamline.fib.push_front(streamline.pos);
     else
-        direction.fill(0);
+        streamline.fib.push_back(streamline.pos);
 
-    return direction;
+    if (m_AposterioriCurvCheck)
+    {
+        int curv = CheckCurvature(&streamline.fib, streamline.front);  // TODO: Move into classification ???
+        if (curv>0)
+        {
+            streamline.tractLength -= m_StepSize*curv;
+            while (curv>0)
+            {
+                if (streamline.front)
+                    streamline.fib.pop_front();
+                else
+                    streamline.fib.pop_back();
+                curv--;
+            }
+            return false;
+        }
+    }
+
+    return streamline.tractLength<=m_MaxTractLength;
 }
 
 template< int NumImageFeatures >
-double MLBSTrackingFilter< NumImageFeatures >::FollowStreamline(ThreadIdType threadId, itk::Point<double, 3> pos, vnl_vector_fixed<double,3> dir, FiberType* fib, double tractLength, bool front)
+void MLBSTrackingFilter< NumImageFeatures >::EndDirection(Streamline& streamline)
 {
-    vnl_vector_fixed<double,3> dirOld = dir;
-    dirOld = dir;
-
-    for (int step=0; step< m_MaxLength/2; step++)
+    vnl_vector_fixed<double,3> dirOld; dirOld.fill(0.0);
+    if (!streamline.front)
     {
-        while (m_PauseTracking){}
-        if (m_DemoMode)
+        streamline.fib.push_front(streamline.seed);
+
+        if (m_RemoveWmEndFibers)
         {
-            m_Mutex.Lock();
-            m_BuildFibersReady++;
-            m_Tractogram.push_back(*fib);
-            BuildFibers(true);
-            m_Stop = true;
-            m_Mutex.Unlock();
-            while (m_Stop){}
+            itk::Point<double> check = streamline.fib.back();
+            vnl_vector_fixed<double,3> check2 = GetNewDirection(check, dirOld);
+            if (check2.magnitude()>0.001)
+            {
+                MITK_INFO << "Detected WM ending. Discarding fiber.";
+                streamline.active = false;
+                return;
+            }
         }
 
-        // get new position
-        CalculateNewPosition(pos, dir);
+        // backward tracking
+        streamline.front = true;
+        streamline.pos = streamline.seed;
+        streamline.dir = -streamline.startDir;
+        streamline.dirOld = streamline.dir;
+        streamline.step = 0;
+        return;
+    }
 
-        // is new position inside of image and mask
-        if (!IsValidPosition(pos) || m_AbortTracking)   // if not end streamline
+    streamline.active = false;
+    if (m_RemoveWmEndFibers)
+    {
+        itk::Point<double> check = streamline.fib.front();
+        vnl_vector_fixed<double,3> check2 = GetNewDirection(check, dirOld);
+        if (check2.magnitude()>0.001)
         {
-            return tractLength;
+            MITK_INFO << "Detected WM ending. Discarding fiber.";
+            return;
         }
-        else    // if yes, add new point to streamline
+    }
+
+    streamline.accepted = streamline.tractLength>=m_MinTractLength && streamline.fib.size()>=2;
+}
+
+template< int NumImageFeatures >
+void MLBSTrackingFilter< NumImageFeatures >::TrackStreamlines(ThreadIdType threadId, std::vector< Streamline >& streamlines)
+{
+    std::vector< int > stepped;
+    std::vector< itk::Point<double, 3> > positions;
+    std::vector< vnl_vector_fixed<double,3> > olddirs;
+    std::vector< vnl_vector_fixed<double,3> > directions;
+    while (true)
+    {
+        // one integration step of all active streamlines
+        stepped.clear();
+        positions.clear();
+        olddirs.clear();
+        for (unsigned int s=0; s<streamlines.size(); s++)
         {
-            tractLength +=  m_StepSize;
-            if (front)
-                fib->push_front(pos);
-            else
-                fib->push_back(pos);
+            Streamline& streamline = streamlines.at(s);
+            if (!streamline.active)
+                continue;
 
-            if (m_AposterioriCurvCheck)
+            if (StepStreamline(streamline))
             {
-                int curv = CheckCurvature(fib, front);  // TODO: Move into classification ???
-                if (curv>0)
-                {
-                    tractLength -= m_StepSize*curv;
-                    while (curv>0)
-                    {
-                        if (front)
-                            fib->pop_front();
-                        else
-                            fib->pop_back();
-                        curv--;
-                    }
-                    return tractLength;
-                }
+                stepped.push_back(s);
+                positions.push_back(streamline.pos);
+                olddirs.push_back(streamline.dirOld);
             }
+            else
+                EndDirection(streamline);
+        }
+        if (stepped.empty())
+        {
+            bool active = false;
+            for (unsigned int s=0; s<streamlines.size(); s++)
+                active = active || streamlines.at(s).active;
+            if (!active)
+                break;
+            continue;
+        }
 
-            if (tractLength>m_MaxTractLength)
-                return tractLength;
+        // new directions of all of them with one forest evaluation
+        GetNewDirections(positions, olddirs, directions);
+        for (unsigned int i=0; i<stepped.size(); i++)
+        {
+            Streamline& streamline = streamlines.at(stepped.at(i));
+            streamline.dir = directions.at(i);
+            streamline.dirOld = olddirs.at(i);
+            streamline.step++;
+            if (streamline.dir.magnitude()<0.0001 || streamline.step>=m_MaxLength/2)
+                EndDirection(streamline);
         }
+    }
 
-        dir = GetNewDirection(pos, dirOld);
+    // add the fibers in the order of their seeds
+    for (unsigned int s=0; s<streamlines.size(); s++)
+    {
+        if (!streamlines.at(s).accepted)
+            continue;
 
-        if (dir.magnitude()<0.0001)
-            return tractLength;
+        if (m_DemoMode) // the demo mode displays m_Tractogram while tracking
+        {
+            m_Mutex.Lock();
+            m_Tractogram.push_back(streamlines.at(s).fib);
+            m_Mutex.Unlock();
+        }
+        else
+            m_ThreadTractograms.at(threadId).push_back(streamlines.at(s).fib);
     }
-    return tractLength;
 }
 
 template< int NumImageFeatures >
@@ -652,10 +824,14 @@ void MLBSTrackingFilter< NumImageFeatures >::ThreadedGenerateData(const InputIma
     MaskIteratorType    sit(m_SeedImage, regionForThread );
     MaskIteratorType    mit(m_MaskImage, regionForThread );
 
+    // the demo mode displays every step of a single streamline
+    unsigned int batchSize = m_DemoMode ? 1 : std::max(m_StreamlineBatchSize, 1);
+    std::vector< Streamline > streamlines;
+
     sit.GoToBegin();
     mit.GoToBegin();
     itk::Point<double> worldPos;
-    while( !sit.IsAtEnd() )
+    while( !sit.IsAtEnd() && !m_AbortTracking )
     {
         if (sit.Value()==0 || mit.Value()==0)
         {
@@ -666,11 +842,8 @@ void MLBSTrackingFilter< NumImageFeatures >::ThreadedGenerateData(const InputIma
 
         for (int s=0; s<m_SeedsPerVoxel; s++)
         {
-            FiberType fib;
-            double tractLength = 0;
             typename FeatureImageType::IndexType index = sit.GetIndex();
             itk::ContinuousIndex<double, 3> start;
-            unsigned int counter = 0;
 
             if (m_SeedsPerVoxel>1)
             {
@@ -696,53 +869,32 @@ void MLBSTrackingFilter< NumImageFeatures >::ThreadedGenerateData(const InputIma
             if (dir.magnitude()<0.0001)
                 continue;
 
-            // forward tracking
-            tractLength = FollowStreamline(threadId, worldPos, dir, &fib, 0, false);
-            fib.push_front(worldPos);
-
-            if (m_RemoveWmEndFibers)
-            {
-                itk::Point<double> check = fib.back();
-                dirOld.fill(0.0);
-                vnl_vector_fixed<double,3> check2 = GetNewDirection(check, dirOld);
-                if (check2.magnitude()>0.001)
-                {
-                    MITK_INFO << "Detected WM ending. Discarding fiber.";
-                    continue;
-                }
-            }
-
-            // backward tracking
-            tractLength = FollowStreamline(threadId, worldPos, -dir, &fib, tractLength, true);
-            counter = fib.size();
-
-            if (m_RemoveWmEndFibers)
+            // forward tracking first
+            Streamline streamline;
+            streamline.seed = worldPos;
+            streamline.pos = worldPos;
+            streamline.startDir = dir;
+            streamline.dir = dir;
+            streamline.dirOld = dir;
+            streamline.tractLength = 0;
+            streamline.step = 0;
+            streamline.front = false;
+            streamline.active = true;
+            streamline.accepted = false;
+            streamlines.push_back(streamline);
+
+            if (streamlines.size()>=batchSize)
             {
-                itk::Point<double> check = fib.front();
-                dirOld.fill(0.0);
-                vnl_vector_fixed<double,3> check2 = GetNewDirection(check, dirOld);
-                if (check2.magnitude()>0.001)
-                {
-                    MITK_INFO << "Detected WM ending. Discarding fiber.";
-                    continue;
-                }
+                TrackStreamlines(threadId, streamlines);
+                streamlines.clear();
             }
-
-            if (tractLength<m_MinTractLength || counter<2)
-                continue;
-
-            m_Mutex.Lock();
-            m_Tractogram.push_back(fib);
-            m_Mutex.Unlock();
-
-            if (m_AbortTracking)
-                break;
         }
-        if (m_AbortTracking)
-            break;
         ++sit;
         ++mit;
     }
+    if (!streamlines.empty())
+        TrackStreamlines(threadId, streamlines);
+
     m_Threads--;
     std::cout << "Thread " << threadId << " finished tracking" << std::endl;
 }
@@ -781,6 +933,13 @@ void MLBSTrackingFilter< NumImageFeatures >::BuildFibers(bool check)
 template< int NumImageFeatures >
 void MLBSTrackingFilter< NumImageFeatures >::AfterThreadedGenerateData()
 {
+    // merge the fibers of the single threads
+    for (unsigned int i=0; i<m_ThreadTractograms.size(); i++)
+    {
+        m_Tractogram.insert(m_Tractogram.end(), m_ThreadTractograms.at(i).begin(), m_ThreadTractograms.at(i).end());
+        m_ThreadTractograms.at(i).clear();
+    }
+
     MITK_INFO << "Generating polydata ";
     BuildFibers(false);
     MITK_INFO << "done";
@@ -36,6 +36,7 @@ This file is based heavily on a corresponding ITK filter.
 #include <itkAnalyticalDiffusionQballReconstructionImageFilter.h>
 #include <itkSimpleFastMutexLock.h>
 #include <mitkDiffusionPropertyHelper.h>
+#include <mitkFlatDecisionForest.h>
 
 // classification includes
 #include <vigra/random_forest.hxx>
@@ -103,6 +104,7 @@ public:
     itkSetMacro( RemoveWmEndFibers, bool )
     itkSetMacro( AposterioriCurvCheck, bool )
     itkSetMacro( AvoidStop, bool )
+    itkSetMacro( StreamlineBatchSize, int )             ///< Number of streamlines of a thread that are advanced in lockstep and classified together.
 
     void SetDecisionForest( DecisionForestType* forest )
     {
@@ -117,12 +119,37 @@ public:
         MLBSTrackingFilter();
     ~MLBSTrackingFilter() {}
 
+    /** Tracking state of one seed. The streamlines of a thread are advanced step by step in lockstep. */
+    struct Streamline
+    {
+        itk::Point<double, 3>       seed;
+        itk::Point<double, 3>       pos;
+        vnl_vector_fixed<double,3>  startDir;   ///< direction at the seed, the backward part starts with -startDir
+        vnl_vector_fixed<double,3>  dir;
+        vnl_vector_fixed<double,3>  dirOld;
+        FiberType                   fib;
+        double                      tractLength;
+        int                         step;
+        bool                        front;      ///< true while tracking backward, i.e. adding points to the front of the fiber
+        bool                        active;
+        bool                        accepted;   ///< fiber is added to the tractogram
+    };
+
     void CalculateNewPosition(itk::Point<double, 3>& pos, vnl_vector_fixed<double,3>& dir);    ///< Calculate next integration step.
-    double FollowStreamline(ThreadIdType threadId, itk::Point<double, 3> pos, vnl_vector_fixed<double,3> dir, FiberType* fib, double tractLength, bool front);       ///< Start streamline in one direction.
+    void TrackStreamlines(ThreadIdType threadId, std::vector< Streamline >& streamlines);      ///< Track forward and backward from all seeds, one step of all streamlines per forest evaluation.
+    bool StepStreamline(Streamline& streamline);        ///< Moves to the next position, false if the current direction of the streamline ends.
+    void EndDirection(Streamline& streamline);          ///< Starts backward tracking after forward tracking or finishes the fiber.
     bool IsValidPosition(itk::Point<double, 3>& pos);   ///< Are we outside of the mask image?
     vnl_vector_fixed<double,3> GetNewDirection(itk::Point<double, 3>& pos, vnl_vector_fixed<double,3>& olddir);
+    /** New directions of all positions with one forest evaluation for the positions and their neighborhood probes. */
+    void GetNewDirections(const std::vector< itk::Point<double, 3> >& positions, std::vector< vnl_vector_fixed<double,3> >& olddirs, std::vector< vnl_vector_fixed<double,3> >& directions);
     vnl_vector_fixed<double,3> Classify(itk::Point<double, 3>& pos, int& candidates, vnl_vector_fixed<double,3>& olddir, double angularThreshold, double& prob, bool avoidStop=false);
 
+    /** Writes the features of pos into the given row of the feature matrix. */
+    void SetFeatures(const itk::Point<double, 3>& pos, const vnl_vector_fixed<double,3>& olddir, vigra::MultiArray<2, double>& featureData, int row);
+    int GetNumberOfFeatures() const { return m_UseDirection ? NumImageFeatures+3 : NumImageFeatures; }
+    vnl_vector_fixed<double,3> EvaluateProbabilities(const vigra::MultiArray<2, double>& probs, int row, itk::Point<double, 3>& pos, int& candidates, vnl_vector_fixed<double,3>& olddir, double angularThreshold, double& prob, bool avoidStop);
+
     typename FeatureImageType::PixelType GetImageValues(itk::Point<float, 3> itkP);
     double GetRandDouble(double min=-1, double max=1);
     double RoundToNearest(double num);
@@ -136,6 +163,7 @@ public:
     vtkSmartPointer<vtkPoints>          m_Points;
     vtkSmartPointer<vtkCellArray>       m_Cells;
     BundleType                          m_Tractogram;
+    std::vector< BundleType >           m_ThreadTractograms;    ///< fibers of each thread, merged into m_Tractogram after tracking
 
     double                              m_AngularThreshold;
     double                              m_StepSize;
@@ -146,6 +174,7 @@ public:
     bool                                m_UseDirection;
     double                              m_SamplingDistance;
     int                                 m_NumberOfSamples;
+    int                                 m_StreamlineBatchSize;
     std::vector< int >                  m_ImageSize;
     std::vector< double >               m_ImageSpacing;
 
@@ -172,6 +201,7 @@ public:
 
     // decision forest
     DecisionForestType*                                                 m_DecisionForest;
+    mitk::FlatDecisionForest                                            m_FlatForest;       ///< cache friendly copy of m_DecisionForest used for prediction
     itk::OrientationDistributionFunction< double, NumImageFeatures*2 >  m_ODF;
     std::vector< int >                                                  m_DirectionIndices;
 
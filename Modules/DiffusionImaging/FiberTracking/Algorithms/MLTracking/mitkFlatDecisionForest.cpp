@@ -0,0 +1,158 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include "mitkFlatDecisionForest.h"
+#include <mitkLogMacros.h>
+
+namespace mitk
+{
+
+FlatDecisionForest::FlatDecisionForest()
+    : m_Flattened(false)
+    , m_ClassCount(0)
+{
+
+}
+
+FlatDecisionForest::~FlatDecisionForest()
+{
+
+}
+
+void FlatDecisionForest::Initialize(const DecisionForestType& forest)
+{
+    m_Fallback.reset();
+    m_Nodes.clear();
+    m_Roots.clear();
+    m_LeafWeights.clear();
+
+    m_ClassCount = forest.class_count();
+    double weighted = forest.options_.predict_weighted_;
+    m_Flattened = true;
+    for (unsigned int t=0; t<forest.trees_.size(); t++)
+    {
+        m_Roots.push_back(m_Nodes.size());
+        if (!FlattenTree(forest.trees_[t], weighted))
+        {
+            MITK_INFO << "FlatDecisionForest: unsupported node type, using vigra prediction.";
+            m_Flattened = false;
+            m_Nodes.clear();
+            m_Roots.clear();
+            m_LeafWeights.clear();
+            m_Fallback = std::make_shared< const DecisionForestType >(forest);
+            return;
+        }
+    }
+}
+
+bool FlatDecisionForest::FlattenTree(const DecisionForestType::DecisionTree_t& tree, double weighted)
+{
+    // depth first, the root of vigra trees is located at topology index 2
+    std::vector< std::pair< int, int > > stack;     // topology index and flat index of the parent's child entry
+    stack.push_back(std::make_pair(2, -1));
+    while (!stack.empty())
+    {
+        int topologyIndex = stack.back().first;
+        int parentEntry = stack.back().second;
+        stack.pop_back();
+
+        int flatIndex = m_Nodes.size();
+        if (parentEntry>=0)
+            m_Nodes[parentEntry/2].child[parentEntry%2] = flatIndex;
+
+        Node node;
+        vigra::NodeBase base(tree.topology_, tree.parameters_, topologyIndex);
+        if (base.typeID()==vigra::i_ThresholdNode)
+        {
+            vigra::Node<vigra::i_ThresholdNode> split(tree.topology_, tree.parameters_, topologyIndex);
+            node.threshold = split.threshold();
+            node.column = split.column();
+            node.child[0] = -1;
+            node.child[1] = -1;
+            m_Nodes.push_back(node);
+
+            stack.push_back(std::make_pair((int)split.child(1), 2*flatIndex+1));
+            stack.push_back(std::make_pair((int)split.child(0), 2*flatIndex));
+        }
+        else if (base.typeID()==vigra::e_ConstProbNode)
+        {
+            vigra::Node<vigra::e_ConstProbNode> leaf(tree.topology_, tree.parameters_, topologyIndex);
+            double factor = weighted*leaf.weights() + (1-weighted);    // same weighting as vigra
+            node.threshold = 0;
+            node.column = -1;
+            node.child[0] = m_LeafWeights.size();
+            node.child[1] = -1;
+            m_Nodes.push_back(node);
+
+            for (int l=0; l<m_ClassCount; l++)
+                m_LeafWeights.push_back(leaf.prob_begin()[l]*factor);
+        }
+        else
+            return false;
+    }
+    return true;
+}
+
+void FlatDecisionForest::PredictProbabilities(const vigra::MultiArrayView<2, double>& features, vigra::MultiArrayView<2, double>& probabilities) const
+{
+    if (!m_Flattened)
+    {
+        if (m_Fallback!=nullptr)
+            m_Fallback->predictProbabilities(features, probabilities);
+        return;
+    }
+
+    int numRows = features.shape(0);
+    probabilities.init(0.0);
+    std::vector< double > totalWeights(numRows, 0.0);
+
+    // rows containing NaNs are not classified (as in vigra)
+    std::vector< bool > valid(numRows, true);
+    for (int r=0; r<numRows; r++)
+        for (int f=0; f<features.shape(1); f++)
+            if (features(r,f)!=features(r,f))
+            {
+                valid[r] = false;
+                break;
+            }
+
+    for (unsigned int t=0; t<m_Roots.size(); t++)
+    {
+        for (int r=0; r<numRows; r++)
+        {
+            if (!valid[r])
+                continue;
+
+            const Node* node = &m_Nodes[m_Roots[t]];
+            while (node->column>=0)
+                node = &m_Nodes[ features(r, node->column) < node->threshold ? node->child[0] : node->child[1] ];
+
+            const double* weights = &m_LeafWeights[node->child[0]];
+            for (int l=0; l<m_ClassCount; l++)
+            {
+                probabilities(r,l) += weights[l];
+                totalWeights[r] += weights[l];
+            }
+        }
+    }
+
+    for (int r=0; r<numRows; r++)
+        if (valid[r] && totalWeights[r]>0)
+            for (int l=0; l<m_ClassCount; l++)
+                probabilities(r,l) /= totalWeights[r];
+}
+
+}
@@ -0,0 +1,82 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#ifndef _FlatDecisionForest
+#define _FlatDecisionForest
+
+#include <MitkFiberTrackingExports.h>
+#include <memory>
+#include <vector>
+
+// classification includes
+#undef DIFFERENCE
+#define VIGRA_STATIC_LIB
+#include <vigra/random_forest.hxx>
+#include <vigra/multi_array.hxx>
+
+namespace mitk
+{
+
+/**
+* \brief Read-only copy of a vigra::RandomForest with all trees stored in one contiguous node array.
+*
+* Prediction yields the same probabilities as vigra::RandomForest::predictProbabilities(). The samples are classified
+* tree by tree so that each tree stays in the cache while a whole batch of feature vectors is pushed through it.
+* Forests containing other than threshold split nodes and constant probability leaves are not flattened and are
+* evaluated by a copy of the vigra forest instead. The flat forest does not reference the forest it was initialized
+* with, so it can be copied along with its owner.   */
+
+class MITKFIBERTRACKING_EXPORT FlatDecisionForest
+{
+
+public:
+
+    typedef vigra::RandomForest<int>    DecisionForestType;
+
+    FlatDecisionForest();
+    ~FlatDecisionForest();
+
+    void Initialize(const DecisionForestType& forest);
+    bool IsInitialized() const { return m_Flattened || m_Fallback!=nullptr; }
+    bool IsFlattened() const { return m_Flattened; }    ///< false if the forest is evaluated by vigra
+    int GetClassCount() const { return m_ClassCount; }
+    int GetTreeCount() const { return m_Roots.size(); }
+
+    /** Class probabilities of each row of the feature matrix. probabilities has to be of size rows x GetClassCount(). */
+    void PredictProbabilities(const vigra::MultiArrayView<2, double>& features, vigra::MultiArrayView<2, double>& probabilities) const;
+
+protected:
+
+    struct Node
+    {
+        double  threshold;
+        int     column;     ///< feature index, -1 for leaves
+        int     child[2];   ///< flat indices of the children (child[0] of a leaf is the offset of its weighted class probabilities)
+    };
+
+    bool FlattenTree(const DecisionForestType::DecisionTree_t& tree, double weighted);
+
+    std::shared_ptr< const DecisionForestType > m_Fallback;   ///< copy of the forest if it could not be flattened
+    bool                        m_Flattened;
+    int                         m_ClassCount;
+    std::vector< Node >         m_Nodes;
+    std::vector< int >          m_Roots;        ///< flat index of the root node of each tree
+    std::vector< double >       m_LeafWeights;  ///< class probabilities of the leaves multiplied with the leaf weights
+};
+
+}
+
+#endif
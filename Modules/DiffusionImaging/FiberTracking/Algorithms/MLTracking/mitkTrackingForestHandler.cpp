@@ -490,6 +490,7 @@ void TrackingForestHandler< NumberOfSignalFeatures >::TrainForest()
     }
 
     m_Forest.options_.tree_count_ = m_NumTrees;
+    m_FlatForest.Initialize(m_Forest);
     MITK_INFO << "Training finsihed";
     MITK_INFO << "The out-of-bag error is: " << oob_v.oob_breiman << std::endl;
 }
@@ -506,6 +507,7 @@ void TrackingForestHandler< NumberOfSignalFeatures >::LoadForest(std::string for
 {
     MITK_INFO << "Loading forest from " << forestFile;
     vigra::rf_import_HDF5(m_Forest, forestFile);
+    m_FlatForest.Initialize(m_Forest);
 }
 
 //// superclass implementations
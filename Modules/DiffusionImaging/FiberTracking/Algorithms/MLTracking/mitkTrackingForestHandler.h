@@ -20,6 +20,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "mitkBaseData.h"
 
 #include <mitkFiberBundle.h>
+#include <mitkFlatDecisionForest.h>
 #include <itkAnalyticalDiffusionQballReconstructionImageFilter.h>
 #include <itkOrientationDistributionFunction.h>
 #include <itkMersenneTwisterRandomVariateGenerator.h>
@@ -77,6 +78,9 @@ public:
     void SetSampleFraction(double fraction){ m_SampleFraction = fraction; }
     vigra::RandomForest<int> GetForest(){ return m_Forest; }
 
+    /** Class probabilities of each row of the feature matrix using the flattened copy of the forest. */
+    void PredictProbabilities(const vigra::MultiArrayView<2, double>& features, vigra::MultiArrayView<2, double>& probabilities) const { m_FlatForest.PredictProbabilities(features, probabilities); }
+
 protected:
 
     void InputDataValidForTracking();
@@ -101,6 +105,7 @@ protected:
 
     int m_NumberOfSamples;
     vigra::RandomForest<int> m_Forest;
+    FlatDecisionForest m_FlatForest;
     vigra::MultiArray<2, double> m_FeatureData;
     vigra::MultiArray<2, double> m_LabelData;
     std::vector< typename InterpolatedRawImageType::Pointer > m_InterpolatedRawImages;
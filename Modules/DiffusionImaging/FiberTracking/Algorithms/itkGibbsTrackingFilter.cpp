@@ -21,6 +21,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <mitkStandardFileLocations.h>
 #include <mitkFiberBuilder.h>
 #include <mitkMetropolisHastingsSampler.h>
+#include <mitkParallelMetropolisHastingsSampler.h>
 //#include <mitkEnergyComputer.h>
 #include <itkTensorImageToQBallImageFilter.h>
 #include <mitkGibbsEnergyComputer.h>
@@ -35,6 +36,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 // #include <QFile>
 #include <tinyxml.h>
 #include <math.h>
+#include <algorithm>
 #include <boost/progress.hpp>
 #include <boost/lexical_cast.hpp>
 #include <boost/algorithm/string.hpp>
@@ -66,7 +68,9 @@ GibbsTrackingFilter< ItkQBallImageType >::GibbsTrackingFilter():
     m_RandomSeed(-1),
     m_LoadParameterFile(""),
     m_LutPath(""),
-    m_IsInValidState(true)
+    m_IsInValidState(true),
+    m_SamplerThreads(1),
+    m_SamplerDomainSize(3)
 {
 
 }
@@ -256,11 +260,29 @@ void GibbsTrackingFilter< ItkQBallImageType >::GenerateData()
     ParticleGrid* particleGrid;
     GibbsEnergyComputer* encomp;
     MetropolisHastingsSampler* sampler;
+    // the parallel sampler needs one energy computer (and sphere interpolator) per thread
+    std::vector< SphereInterpolator* > threadInterpolators;
+    std::vector< GibbsEnergyComputer* > threadEnergyComputers;
+    ParallelMetropolisHastingsSampler* parallelSampler = nullptr;
     try{
         particleGrid = new ParticleGrid(m_MaskImage, m_ParticleLength, m_ParticleGridCellCapacity);
         encomp = new GibbsEnergyComputer(m_QBallImage, m_MaskImage, particleGrid, interpolator, randGen);
         encomp->SetParameters(m_ParticleWeight,m_ParticleWidth,m_ConnectionPotential*m_ParticleLength*m_ParticleLength,m_CurvatureThreshold,m_InexBalance,m_ParticlePotential);
         sampler = new MetropolisHastingsSampler(particleGrid, encomp, randGen, m_CurvatureThreshold);
+
+        if (m_SamplerThreads>1)
+        {
+            for (unsigned int t=0; t<m_SamplerThreads; t++)
+            {
+                threadInterpolators.push_back(new SphereInterpolator(*interpolator));
+                GibbsEnergyComputer* threadEncomp = new GibbsEnergyComputer(m_QBallImage, m_MaskImage, particleGrid, threadInterpolators.back(), randGen);
+                threadEncomp->SetParameters(m_ParticleWeight,m_ParticleWidth,m_ConnectionPotential*m_ParticleLength*m_ParticleLength,m_CurvatureThreshold,m_InexBalance,m_ParticlePotential);
+                threadEnergyComputers.push_back(threadEncomp);
+            }
+            std::vector< EnergyComputer* > energyComputers(threadEnergyComputers.begin(), threadEnergyComputers.end());
+            parallelSampler = new ParallelMetropolisHastingsSampler(particleGrid, energyComputers, m_MaskImage, randGen, m_CurvatureThreshold);
+            parallelSampler->SetDomainSize(m_SamplerDomainSize);
+        }
     }
     catch(...)
     {
@@ -283,6 +305,11 @@ void GibbsTrackingFilter< ItkQBallImageType >::GenerateData()
     MITK_INFO << "Min. fiber length: " << m_MinFiberLength;
     MITK_INFO << "Curvature threshold: " << m_CurvatureThreshold;
     MITK_INFO << "Random seed: " << m_RandomSeed;
+    if (parallelSampler!=nullptr)
+    {
+        MITK_INFO << "Sampler threads: " << parallelSampler->GetNumberOfThreads();
+        MITK_INFO << "Sampler domain size: " << parallelSampler->GetDomainSize();
+    }
     MITK_INFO << "----------------------------------------";
 
     // main loop
@@ -299,6 +326,45 @@ void GibbsTrackingFilter< ItkQBallImageType >::GenerateData()
         float temperature = m_StartTemperature * exp(alpha*(((1.0)*m_CurrentStep)/((1.0)*m_Steps)));
         sampler->SetTemperature(temperature);
 
+        if (parallelSampler!=nullptr)
+        {
+            parallelSampler->SetTemperature(temperature);
+
+            // sample in sweeps over all domains, check for fiber build and abort requests between the sweeps
+            unsigned long i = 0;
+            while (i<singleIts)
+            {
+                if (m_AbortTracking)
+                    break;
+
+                unsigned long sweepIts = std::min(singleIts-i, (unsigned long)m_ParallelSweepIterations);
+                parallelSampler->MakeProposals(sweepIts);
+                disp += sweepIts;
+                i += sweepIts;
+                counter += sweepIts;
+
+                if (m_BuildFibers || (i==singleIts && m_CurrentStep==m_Steps))
+                {
+                    m_ProposalAcceptance = (float)parallelSampler->GetNumAcceptedProposals()/counter;
+                    m_NumParticles = particleGrid->m_NumParticles;
+                    m_NumConnections = particleGrid->m_NumConnections;
+
+                    FiberBuilder fiberBuilder(particleGrid, m_MaskImage);
+                    m_FiberPolyData = fiberBuilder.iterate(m_MinFiberLength);
+                    m_NumAcceptedFibers = m_FiberPolyData->GetNumberOfLines();
+                    m_BuildFibers = false;
+                }
+            }
+
+            m_ProposalAcceptance = (float)parallelSampler->GetNumAcceptedProposals()/counter;
+            m_NumParticles = particleGrid->m_NumParticles;
+            m_NumConnections = particleGrid->m_NumConnections;
+
+            if (m_AbortTracking)
+                break;
+            continue;
+        }
+
         for (unsigned long i=0; i<singleIts; i++)
         {
             ++disp;
@@ -336,6 +402,12 @@ void GibbsTrackingFilter< ItkQBallImageType >::GenerateData()
     }
     clock.Stop();
 
+    delete parallelSampler;
+    for (unsigned int t=0; t<threadEnergyComputers.size(); t++)
+    {
+        delete threadEnergyComputers.at(t);
+        delete threadInterpolators.at(t);
+    }
     delete sampler;
     delete encomp;
     delete interpolator;
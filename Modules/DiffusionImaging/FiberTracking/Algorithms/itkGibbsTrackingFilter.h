@@ -73,6 +73,8 @@ public:
     itkSetMacro( LoadParameterFile, std::string )   ///< Parameter file.
     itkSetMacro( SaveParameterFile, std::string )
     itkSetMacro( LutPath, std::string )             ///< Path to lookuptables. Default is binary directory.
+    itkSetMacro( SamplerThreads, unsigned int )     ///< Number of threads of the parallel sampler. 1 uses the serial sampler (default).
+    itkSetMacro( SamplerDomainSize, int )           ///< Edge length (in particle grid cells) of the domains sampled in parallel.
 
     /** Getter. */
     itkGetMacro( ParticleWeight, float )
@@ -85,6 +87,8 @@ public:
     itkGetMacro( ProposalAcceptance, float )
     itkGetMacro( Steps, unsigned int)
     itkGetMacro( IsInValidState, bool)
+    itkGetMacro( SamplerThreads, unsigned int )
+    itkGetMacro( SamplerDomainSize, int )
     FiberPolyDataType GetFiberBundle();             ///< Output fibers
 
     /** Input images. */
@@ -138,11 +142,14 @@ protected:
     std::string     m_SaveParameterFile;    ///< filename of parameter file (writer)
     std::string     m_LutPath;              ///< path to lookuptables used by the sphere interpolator
     bool            m_IsInValidState;       ///< Whether the filter is in a valid state, false if error occured
+    unsigned int    m_SamplerThreads;       ///< number of threads used by the ParallelMetropolisHastingsSampler (1 -> serial MetropolisHastingsSampler)
+    int             m_SamplerDomainSize;    ///< edge length of the parallel sampling domains in grid cells
 
     FiberPolyDataType m_FiberPolyData;      ///< container for reconstructed fibers
 
     //Constant values
     static const int m_ParticleGridCellCapacity = 1024;
+    static const int m_ParallelSweepIterations = 100000;   ///< proposals per sweep of the parallel sampler over all domains
 };
 }
 
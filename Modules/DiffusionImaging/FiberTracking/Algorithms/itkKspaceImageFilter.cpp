@@ -38,6 +38,7 @@ KspaceImageFilter< TPixelType >
     : m_FrequencyMapSlice(NULL)
     , m_Z(0)
     , m_UseConstantRandSeed(false)
+    , m_RandSeed(-1)
     , m_SpikesPerSlice(0)
     , m_IsBaseline(true)
 {
@@ -51,7 +52,9 @@ template< class TPixelType >
 void KspaceImageFilter< TPixelType >
 ::BeforeThreadedGenerateData()
 {
-    if (m_UseConstantRandSeed)  // always generate the same random numbers?
+    if (m_RandSeed>=0)
+        m_RandGen->SetSeed(m_RandSeed);
+    else if (m_UseConstantRandSeed)  // always generate the same random numbers?
         m_RandGen->SetSeed(0);
     else
         m_RandGen->SetSeed();
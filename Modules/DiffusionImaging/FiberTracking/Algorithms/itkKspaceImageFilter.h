@@ -77,6 +77,7 @@ namespace itk{
     itkSetMacro( Z, double )                        ///< Slice position, necessary for eddy current simulation.
     itkSetMacro( OutSize, itk::Size<2> )            ///< Output slice size. Can be different from input size, e.g. if Gibbs ringing is enabled.
     itkSetMacro( UseConstantRandSeed, bool )        ///< Use constant seed for random generator for reproducible results.
+    itkSetMacro( RandSeed, int )                    ///< Seed for the random generator. Negative values: use UseConstantRandSeed.
 
     void SetParameters( FiberfoxParameters<double> param ){ m_Parameters = param; }
     FiberfoxParameters<double> GetParameters(){ return m_Parameters; }
@@ -100,6 +101,7 @@ namespace itk{
     itk::Vector<double,3>                   m_DiffusionGradientDirection;
     double                                  m_Z;
     bool                                    m_UseConstantRandSeed;
+    int                                     m_RandSeed;
     unsigned int                            m_SpikesPerSlice;
     itk::Size<2>                            m_OutSize;
 
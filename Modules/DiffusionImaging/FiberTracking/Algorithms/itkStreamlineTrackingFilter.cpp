@@ -20,6 +20,8 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <time.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <stdint.h>
+#include <algorithm>
 
 #include "itkStreamlineTrackingFilter.h"
 #include <itkImageRegionConstIterator.h>
@@ -53,6 +55,11 @@ TPDPixelType>
     , m_ResampleFibers(false)
     , m_SeedImage(NULL)
     , m_MaskImage(NULL)
+    , m_DeterministicSeeding(false)
+    , m_RandomSeed(0)
+    , m_CurrentRandomSeed(0)
+    , m_SeedChunkSize(32)
+    , m_NextSeedChunk(0)
 {
     // At least 1 inputs is necessary for a vector image.
     // For images added one at a time we need at least six
@@ -68,6 +75,20 @@ TPDPixelType>
     return (num > 0.0) ? floor(num + 0.5) : ceil(num - 0.5);
 }
 
+template< class TTensorPixelType,
+          class TPDPixelType>
+double StreamlineTrackingFilter< TTensorPixelType,
+TPDPixelType>
+::GetSeedOffset(unsigned long seedIdx, int component)
+{
+    // splitmix64 hash of the random seed and the seed coordinate index
+    uint64_t z = (uint64_t)m_CurrentRandomSeed + ((uint64_t)seedIdx*3 + component + 1)*0x9E3779B97F4A7C15ULL;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    z = z ^ (z >> 31);
+    return 0.98*(double)(z >> 11)/9007199254740992.0 - 0.49;
+}
+
 template< class TTensorPixelType,
           class TPDPixelType>
 void StreamlineTrackingFilter< TTensorPixelType,
@@ -111,6 +132,8 @@ TPDPixelType>
         FiberPolyDataType poly = FiberPolyDataType::New();
         m_PolyDataContainer->InsertElement(i, poly);
     }
+    m_ThreadFiberSeeds.clear();
+    m_ThreadFiberSeeds.resize(this->GetNumberOfThreads());
 
     if (m_SeedImage.IsNull())
     {
@@ -221,6 +244,25 @@ TPDPixelType>
     if (m_MinCurvatureRadius<0.0)
         m_MinCurvatureRadius = 0.5*minSpacing;
 
+    // collect seed voxels in image order, the threads fetch chunks of them during tracking
+    m_SeedVoxels.clear();
+    ImageRegionConstIteratorWithIndex< ItkUcharImgType > sit(m_SeedImage, m_SeedImage->GetLargestPossibleRegion());
+    while( !sit.IsAtEnd() )
+    {
+        typename InputImageType::IndexType index = sit.GetIndex();
+        if (sit.Get()>0 && m_MaskImage->GetPixel(index)>0 && m_FaImage->GetPixel(index)>=m_FaThreshold)
+            m_SeedVoxels.push_back(index);
+        ++sit;
+    }
+    m_NextSeedChunk = 0;
+    if (m_SeedChunkSize<1)
+        m_SeedChunkSize = 1;
+
+    if (m_DeterministicSeeding)
+        m_CurrentRandomSeed = m_RandomSeed;
+    else
+        m_CurrentRandomSeed = time(NULL);
+
     std::cout << "StreamlineTrackingFilter: Min. curvature radius: " << m_MinCurvatureRadius << std::endl;
     std::cout << "StreamlineTrackingFilter: FA threshold: " << m_FaThreshold << std::endl;
     std::cout << "StreamlineTrackingFilter: stepsize: " << m_StepSize << " mm" << std::endl;
@@ -733,52 +775,43 @@ template< class TTensorPixelType,
           class TPDPixelType>
 void StreamlineTrackingFilter< TTensorPixelType,
 TPDPixelType>
-::ThreadedGenerateData(const OutputImageRegionType& outputRegionForThread,
+::ThreadedGenerateData(const OutputImageRegionType&,
                        ThreadIdType threadId)
 {
     FiberPolyDataType poly = m_PolyDataContainer->GetElement(threadId);
+    std::vector< unsigned long >& fiberSeeds = m_ThreadFiberSeeds.at(threadId);
     vtkSmartPointer<vtkPoints> points = vtkSmartPointer<vtkPoints>::New();
     vtkSmartPointer<vtkCellArray> Cells = vtkSmartPointer<vtkCellArray>::New();
 
-    typedef itk::DiffusionTensor3D<TTensorPixelType>        TensorType;
-    typedef ImageRegionConstIterator< InputImageType >      InputIteratorType;
-    typedef ImageRegionConstIterator< ItkUcharImgType >     MaskIteratorType;
-    typedef ImageRegionConstIterator< ItkFloatImgType >     doubleIteratorType;
-    typedef typename InputImageType::PixelType              InputTensorType;
-
-    MaskIteratorType    sit(m_SeedImage, outputRegionForThread );
-    doubleIteratorType   fit(m_FaImage, outputRegionForThread );
-    MaskIteratorType    mit(m_MaskImage, outputRegionForThread );
-
-    for (int img=0; img<m_NumberOfInputs; img++)
+    // the image region of this thread is ignored, seed voxels are fetched in chunks until all of them are processed
+    unsigned long numVoxels = m_SeedVoxels.size();
+    unsigned long numWorkItems = numVoxels*m_NumberOfInputs;
+    itk::Point<double> worldPos;
+    while (true)
     {
-        sit.GoToBegin();
-        mit.GoToBegin();
-        fit.GoToBegin();
-        itk::Point<double> worldPos;
-        while( !sit.IsAtEnd() )
+        unsigned long chunkStart = m_NextSeedChunk.fetch_add(1)*m_SeedChunkSize;
+        if (chunkStart>=numWorkItems)
+            break;
+        unsigned long chunkEnd = std::min(chunkStart+m_SeedChunkSize, numWorkItems);
+
+        for (unsigned long w=chunkStart; w<chunkEnd; w++)
         {
-            if (sit.Value()==0 || fit.Value()<m_FaThreshold || mit.Value()==0)
-            {
-                ++sit;
-                ++mit;
-                ++fit;
-                continue;
-            }
+            int img = w/numVoxels;
+            const typename InputImageType::IndexType& index = m_SeedVoxels.at(w%numVoxels);
 
             for (int s=0; s<m_SeedsPerVoxel; s++)
             {
+                unsigned long seedIdx = w*m_SeedsPerVoxel + s;
                 vtkSmartPointer<vtkPolyLine> line = vtkSmartPointer<vtkPolyLine>::New();
                 std::vector< vtkIdType > pointIDs;
-                typename InputImageType::IndexType index = sit.GetIndex();
                 itk::ContinuousIndex<double, 3> start;
                 unsigned int counter = 0;
 
                 if (m_SeedsPerVoxel>1)
                 {
-                    start[0] = index[0]+(double)(rand()%99-49)/100;
-                    start[1] = index[1]+(double)(rand()%99-49)/100;
-                    start[2] = index[2]+(double)(rand()%99-49)/100;
+                    start[0] = index[0]+GetSeedOffset(seedIdx, 0);
+                    start[1] = index[1]+GetSeedOffset(seedIdx, 1);
+                    start[2] = index[2]+GetSeedOffset(seedIdx, 2);
                 }
                 else
                 {
@@ -807,8 +840,6 @@ TPDPixelType>
 
                 counter += pointIDs.size();
 
-                //MITK_INFO << "Tract length " << tractLength;
-
                 if (tractLength<m_MinTractLength || counter<2)
                     continue;
 
@@ -817,10 +848,8 @@ TPDPixelType>
                     line->GetPointIds()->InsertNextId(pointIDs.at(i));
 
                 Cells->InsertNextCell(line);
+                fiberSeeds.push_back(seedIdx);
             }
-            ++sit;
-            ++mit;
-            ++fit;
         }
     }
     poly->SetPoints(points);
@@ -831,38 +860,57 @@ TPDPixelType>
 
 template< class TTensorPixelType,
           class TPDPixelType>
-vtkSmartPointer< vtkPolyData > StreamlineTrackingFilter< TTensorPixelType,
+void StreamlineTrackingFilter< TTensorPixelType,
 TPDPixelType>
-::AddPolyData(FiberPolyDataType poly1, FiberPolyDataType poly2)
+::MergeThreadFibers()
 {
-    vtkSmartPointer<vtkPolyData> vNewPolyData = vtkSmartPointer<vtkPolyData>::New();
-    vtkSmartPointer<vtkCellArray> vNewLines = poly1->GetLines();
-    vtkSmartPointer<vtkPoints> vNewPoints = poly1->GetPoints();
+    // (seed index, thread, cell) of all fibers
+    std::vector< std::pair< unsigned long, std::pair< unsigned int, vtkIdType > > > fibers;
+    for (unsigned int t=0; t<m_ThreadFiberSeeds.size(); t++)
+        for (unsigned int i=0; i<m_ThreadFiberSeeds.at(t).size(); i++)
+            fibers.push_back(std::make_pair(m_ThreadFiberSeeds.at(t).at(i), std::make_pair(t, (vtkIdType)i)));
+    std::sort(fibers.begin(), fibers.end());
+
+    // random access to the cells of each thread
+    std::vector< std::vector< vtkIdType > > cellOffsets(m_ThreadFiberSeeds.size());
+    for (unsigned int t=0; t<m_ThreadFiberSeeds.size(); t++)
+    {
+        vtkCellArray* cells = m_PolyDataContainer->GetElement(t)->GetLines();
+        if (cells==NULL)
+            continue;
+        vtkIdType numPoints; vtkIdType* pointIds;
+        cells->InitTraversal();
+        vtkIdType offset = cells->GetTraversalLocation();
+        while (cells->GetNextCell(numPoints, pointIds))
+        {
+            cellOffsets.at(t).push_back(offset);
+            offset = cells->GetTraversalLocation();
+        }
+    }
 
-    for( int i=0; i<poly2->GetNumberOfLines(); i++ )
+    vtkSmartPointer<vtkPoints> vNewPoints = vtkSmartPointer<vtkPoints>::New();
+    vtkSmartPointer<vtkCellArray> vNewLines = vtkSmartPointer<vtkCellArray>::New();
+    for (unsigned int f=0; f<fibers.size(); f++)
     {
-        vtkCell* cell = poly2->GetCell(i);
-        int numPoints = cell->GetNumberOfPoints();
-        vtkPoints* points = cell->GetPoints();
+        unsigned int t = fibers.at(f).second.first;
+        FiberPolyDataType poly = m_PolyDataContainer->GetElement(t);
+        vtkIdType numPoints; vtkIdType* pointIds;
+        poly->GetLines()->GetCell(cellOffsets.at(t).at(fibers.at(f).second.second), numPoints, pointIds);
 
         vtkSmartPointer<vtkPolyLine> container = vtkSmartPointer<vtkPolyLine>::New();
         for (int j=0; j<numPoints; j++)
         {
-            double p[3];
-            points->GetPoint(j, p);
-
-            vtkIdType id = vNewPoints->InsertNextPoint(p);
+            vtkIdType id = vNewPoints->InsertNextPoint(poly->GetPoint(pointIds[j]));
             container->GetPointIds()->InsertNextId(id);
         }
         vNewLines->InsertNextCell(container);
     }
 
-    // initialize polydata
-    vNewPolyData->SetPoints(vNewPoints);
-    vNewPolyData->SetLines(vNewLines);
-
-    return vNewPolyData;
+    m_FiberPolyData = FiberPolyDataType::New();
+    m_FiberPolyData->SetPoints(vNewPoints);
+    m_FiberPolyData->SetLines(vNewLines);
 }
+
 template< class TTensorPixelType,
           class TPDPixelType>
 void StreamlineTrackingFilter< TTensorPixelType,
@@ -870,11 +918,9 @@ TPDPixelType>
 ::AfterThreadedGenerateData()
 {
     MITK_INFO << "Generating polydata ";
-    m_FiberPolyData = m_PolyDataContainer->GetElement(0);
-    for (unsigned int i=1; i<this->GetNumberOfThreads(); i++)
-    {
-        m_FiberPolyData = AddPolyData(m_FiberPolyData, m_PolyDataContainer->GetElement(i));
-    }
+    MergeThreadFibers();
+    m_SeedVoxels.clear();
+    m_ThreadFiberSeeds.clear();
     MITK_INFO << "done";
 }
 
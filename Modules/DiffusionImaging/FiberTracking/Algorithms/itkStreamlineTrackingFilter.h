@@ -32,11 +32,16 @@ This file is based heavily on a corresponding ITK filter.
 #include <vtkCellArray.h>
 #include <vtkPoints.h>
 #include <vtkPolyLine.h>
+#include <atomic>
 
 namespace itk{
 
 /**
-* \brief Performes deterministic streamline tracking on the input tensor image.   */
+* \brief Performes deterministic streamline tracking on the input tensor image.
+*
+* The seed voxels are collected before tracking and processed in chunks that the threads pull from a shared counter, so
+* threads that finish early continue with the remaining seeds. Each thread stores its fibers in its own buffer. The buffers
+* are merged in seed order, so the output does not depend on the number of threads.   */
 
   template< class TTensorPixelType, class TPDPixelType=double>
   class StreamlineTrackingFilter :
@@ -84,6 +89,12 @@ namespace itk{
     itkSetMacro( MinCurvatureRadius, double )            ///< Tracking is stopped if curvature radius (in mm) is too small.
     itkGetMacro( MinCurvatureRadius, double )
     itkSetMacro( ResampleFibers, bool )                 ///< If enabled, the resulting fibers are resampled to feature point distances of 0.5*MinSpacing. This is recommendable for very short integration steps and many seeds. If disabled, the resulting fiber bundle might become very large.
+    itkSetMacro( DeterministicSeeding, bool )           ///< If enabled, the random seed positions (SeedsPerVoxel>1) are generated from RandomSeed and the tracking result is reproducible.
+    itkGetMacro( DeterministicSeeding, bool )
+    itkSetMacro( RandomSeed, unsigned int )             ///< Seed of the random seed positions if DeterministicSeeding is enabled.
+    itkGetMacro( RandomSeed, unsigned int )
+    itkSetMacro( SeedChunkSize, unsigned int )          ///< Number of seed voxels a thread processes before fetching new work.
+    itkGetMacro( SeedChunkSize, unsigned int )
 
   protected:
     StreamlineTrackingFilter();
@@ -95,11 +106,12 @@ namespace itk{
     bool IsValidPosition(itk::ContinuousIndex<double, 3>& pos, typename InputImageType::IndexType& index, vnl_vector_fixed< double, 8 >& interpWeights, int imageIdx);   ///< Are we outside of the mask image? Is the FA too low?
 
     double RoundToNearest(double num);
+    double GetSeedOffset(unsigned long seedIdx, int component);    ///< Random offset in [-0.49, 0.49] of one seed coordinate. Only depends on the seed index and the random seed.
     void BeforeThreadedGenerateData();
     void ThreadedGenerateData( const OutputImageRegionType &outputRegionForThread, ThreadIdType threadId);
     void AfterThreadedGenerateData();
 
-    FiberPolyDataType AddPolyData(FiberPolyDataType poly1, FiberPolyDataType poly2);    ///< Combine tracking results generated by the individual threads.
+    void MergeThreadFibers();   ///< Combine tracking results generated by the individual threads in seed order.
 
     FiberPolyDataType               m_FiberPolyData;
     vtkSmartPointer<vtkPoints>      m_Points;
@@ -126,8 +138,16 @@ namespace itk{
     std::vector< double >        m_ImageSpacing;
     ItkUcharImgType::Pointer    m_SeedImage;
     ItkUcharImgType::Pointer    m_MaskImage;
+    bool                        m_DeterministicSeeding;
+    unsigned int                m_RandomSeed;
+    unsigned int                m_CurrentRandomSeed;    ///< RandomSeed or time based seed of the current run
+    unsigned int                m_SeedChunkSize;
 
-    itk::VectorContainer< int, FiberPolyDataType >::Pointer m_PolyDataContainer;
+    std::vector< typename InputImageType::IndexType >   m_SeedVoxels;       ///< Voxels that are seeded (seed mask, tracking mask and FA threshold).
+    std::atomic< unsigned long >                        m_NextSeedChunk;    ///< Next chunk of m_SeedVoxels that is not yet processed.
+
+    itk::VectorContainer< int, FiberPolyDataType >::Pointer m_PolyDataContainer;  ///< Fibers of each thread
+    std::vector< std::vector< unsigned long > >             m_ThreadFiberSeeds;   ///< Seed index of each fiber in m_PolyDataContainer
 
   private:
 
@@ -79,21 +79,6 @@ TractsToDWIImageFilter< PixelType >::DoubleDwiType::Pointer TractsToDWIImageFilt
     sliceSpacing[0] = m_UpsampledSpacing[0];
     sliceSpacing[1] = m_UpsampledSpacing[1];
 
-    // frequency map slice
-    SliceType::Pointer fMapSlice = NULL;
-    if (m_Parameters.m_SignalGen.m_FrequencyMap.IsNotNull())
-    {
-        fMapSlice = SliceType::New();
-        ImageRegion<2> region;
-        region.SetSize(0, m_UpsampledImageRegion.GetSize()[0]);
-        region.SetSize(1, m_UpsampledImageRegion.GetSize()[1]);
-        fMapSlice->SetLargestPossibleRegion( region );
-        fMapSlice->SetBufferedRegion( region );
-        fMapSlice->SetRequestedRegion( region );
-        fMapSlice->Allocate();
-        fMapSlice->FillBuffer(0.0);
-    }
-
     DoubleDwiType::Pointer newImage = DoubleDwiType::New();
     newImage->SetSpacing( m_Parameters.m_SignalGen.m_ImageSpacing );
     newImage->SetOrigin( m_Parameters.m_SignalGen.m_ImageOrigin );
@@ -104,127 +89,230 @@ TractsToDWIImageFilter< PixelType >::DoubleDwiType::Pointer TractsToDWIImageFilt
     newImage->SetVectorLength( images.at(0)->GetVectorLength() );
     newImage->Allocate();
 
+    int numChannels = images.at(0)->GetVectorLength();
+    int numSlices = images.at(0)->GetLargestPossibleRegion().GetSize(2);
+
     std::vector< unsigned int > spikeVolume;
     for (unsigned int i=0; i<m_Parameters.m_SignalGen.m_Spikes; i++)
-        spikeVolume.push_back(m_RandGen->GetIntegerVariate()%images.at(0)->GetVectorLength());
+        spikeVolume.push_back(m_RandGen->GetIntegerVariate()%numChannels);
     std::sort (spikeVolume.begin(), spikeVolume.end());
     std::reverse (spikeVolume.begin(), spikeVolume.end());
 
+    // distribute spikes and draw one seed per (channel, slice) job in a fixed order, so that the result does not depend on the thread scheduling
+    std::vector< int > numSpikes(numChannels*numSlices, 0);
+    for (int g=0; g<numChannels; g++)
+        while (!spikeVolume.empty() && spikeVolume.back()==(unsigned int)g)
+        {
+            numSpikes[g*numSlices + m_RandGen->GetIntegerVariate()%numSlices]++;
+            spikeVolume.pop_back();
+        }
+    std::vector< int > seeds(numChannels*numSlices, -1);   // -1: constant seed of the k-space filter
+    if (!m_UseConstantRandSeed)
+        for (unsigned int i=0; i<seeds.size(); i++)
+            seeds[i] = m_RandGen->GetIntegerVariate()%itk::NumericTraits<int>::max();
+
+    // frequency map slices are the same for all channels
+    std::vector< SliceType::Pointer > fMapSlices(numSlices);
+    if (m_Parameters.m_SignalGen.m_FrequencyMap.IsNotNull())
+        for (int z=0; z<numSlices; z++)
+        {
+            SliceType::Pointer fMapSlice = SliceType::New();
+            fMapSlice->SetLargestPossibleRegion( sliceRegion );
+            fMapSlice->SetBufferedRegion( sliceRegion );
+            fMapSlice->SetRequestedRegion( sliceRegion );
+            fMapSlice->Allocate();
+            fMapSlice->FillBuffer(0.0);
+
+            for (unsigned int y=0; y<images.at(0)->GetLargestPossibleRegion().GetSize(1); y++)
+                for (unsigned int x=0; x<images.at(0)->GetLargestPossibleRegion().GetSize(0); x++)
+                {
+                    SliceType::IndexType index2D; index2D[0]=x; index2D[1]=y;
+                    DoubleDwiType::IndexType index3D; index3D[0]=x; index3D[1]=y; index3D[2]=z;
+                    fMapSlice->SetPixel(index2D, m_Parameters.m_SignalGen.m_FrequencyMap->GetPixel(index3D));
+                }
+            fMapSlices[z] = fMapSlice;
+        }
+
+    std::vector< double > t2Vector;
+    for (unsigned int i=0; i<images.size(); i++)
+    {
+        if (i<numFiberCompartments)
+            t2Vector.push_back(m_Parameters.m_FiberModelList.at(i)->GetT2());
+        else
+            t2Vector.push_back(m_Parameters.m_NonFiberModelList.at(i-numFiberCompartments)->GetT2());
+    }
+
     m_StatusText += "0%   10   20   30   40   50   60   70   80   90   100%\n";
     m_StatusText += "|----|----|----|----|----|----|----|----|----|----|\n*";
     unsigned long lastTick = 0;
 
-    boost::progress_display disp(2*images.at(0)->GetVectorLength()*images.at(0)->GetLargestPossibleRegion().GetSize(2));
-    for (unsigned int g=0; g<images.at(0)->GetVectorLength(); g++)
+    int numThreads = this->GetNumberOfThreads();
+    bool aborted = false;
+    boost::progress_display disp(numChannels*numSlices);
+#pragma omp parallel for schedule(dynamic) num_threads(numThreads)
+    for (int job=0; job<numChannels*numSlices; job++)
     {
-        std::vector< unsigned int > spikeSlice;
-        while (!spikeVolume.empty() && spikeVolume.back()==g)
+        if (aborted)
+            continue;
+        if (this->GetAbortGenerateData())
         {
-            spikeSlice.push_back(m_RandGen->GetIntegerVariate()%images.at(0)->GetLargestPossibleRegion().GetSize(2));
-            spikeVolume.pop_back();
+            aborted = true;
+            continue;
         }
-        std::sort (spikeSlice.begin(), spikeSlice.end());
-        std::reverse (spikeSlice.begin(), spikeSlice.end());
 
-        for (unsigned int z=0; z<images.at(0)->GetLargestPossibleRegion().GetSize(2); z++)
-        {
-            std::vector< SliceType::Pointer > compartmentSlices;
-            std::vector< double > t2Vector;
+        int g = job/numSlices;
+        int z = job%numSlices;
 
-            for (unsigned int i=0; i<images.size(); i++)
-            {
-                DiffusionSignalModel<double>* signalModel;
-                if (i<numFiberCompartments)
-                    signalModel = m_Parameters.m_FiberModelList.at(i);
-                else
-                    signalModel = m_Parameters.m_NonFiberModelList.at(i-numFiberCompartments);
-
-                SliceType::Pointer slice = SliceType::New();
-                slice->SetLargestPossibleRegion( sliceRegion );
-                slice->SetBufferedRegion( sliceRegion );
-                slice->SetRequestedRegion( sliceRegion );
-                slice->SetSpacing(sliceSpacing);
-                slice->Allocate();
-                slice->FillBuffer(0.0);
-
-                // extract slice from channel g
-                for (unsigned int y=0; y<images.at(0)->GetLargestPossibleRegion().GetSize(1); y++)
-                    for (unsigned int x=0; x<images.at(0)->GetLargestPossibleRegion().GetSize(0); x++)
-                    {
-                        SliceType::IndexType index2D; index2D[0]=x; index2D[1]=y;
-                        DoubleDwiType::IndexType index3D; index3D[0]=x; index3D[1]=y; index3D[2]=z;
-
-                        slice->SetPixel(index2D, images.at(i)->GetPixel(index3D)[g]);
-
-                        if (fMapSlice.IsNotNull() && i==0)
-                            fMapSlice->SetPixel(index2D, m_Parameters.m_SignalGen.m_FrequencyMap->GetPixel(index3D));
-                    }
+        // extract slice from channel g
+        std::vector< SliceType::Pointer > compartmentSlices;
+        for (unsigned int i=0; i<images.size(); i++)
+        {
+            SliceType::Pointer slice = SliceType::New();
+            slice->SetLargestPossibleRegion( sliceRegion );
+            slice->SetBufferedRegion( sliceRegion );
+            slice->SetRequestedRegion( sliceRegion );
+            slice->SetSpacing(sliceSpacing);
+            slice->Allocate();
+            slice->FillBuffer(0.0);
+
+            const double* buffer = images.at(i)->GetBufferPointer();
+            for (unsigned int y=0; y<images.at(0)->GetLargestPossibleRegion().GetSize(1); y++)
+                for (unsigned int x=0; x<images.at(0)->GetLargestPossibleRegion().GetSize(0); x++)
+                {
+                    SliceType::IndexType index2D; index2D[0]=x; index2D[1]=y;
+                    DoubleDwiType::IndexType index3D; index3D[0]=x; index3D[1]=y; index3D[2]=z;
+                    slice->SetPixel(index2D, buffer[images.at(i)->ComputeOffset(index3D)*numChannels + g]);
+                }
 
-                compartmentSlices.push_back(slice);
-                t2Vector.push_back(signalModel->GetT2());
-            }
+            compartmentSlices.push_back(slice);
+        }
 
-            if (this->GetAbortGenerateData())
-                return NULL;
-
-            // create k-sapce (inverse fourier transform slices)
-            itk::Size<2> outSize; outSize.SetElement(0, m_Parameters.m_SignalGen.m_ImageRegion.GetSize(0)); outSize.SetElement(1, m_Parameters.m_SignalGen.m_ImageRegion.GetSize(1));
-            itk::KspaceImageFilter< SliceType::PixelType >::Pointer idft = itk::KspaceImageFilter< SliceType::PixelType >::New();
-            idft->SetCompartmentImages(compartmentSlices);
-            idft->SetT2(t2Vector);
-            idft->SetUseConstantRandSeed(m_UseConstantRandSeed);
-            idft->SetParameters(m_Parameters);
-            idft->SetZ((double)z-(double)images.at(0)->GetLargestPossibleRegion().GetSize(2)/2.0);
-            idft->SetDiffusionGradientDirection(m_Parameters.m_SignalGen.GetGradientDirection(g));
-            idft->SetFrequencyMapSlice(fMapSlice);
-            idft->SetOutSize(outSize);
-            int numSpikes = 0;
-            while (!spikeSlice.empty() && spikeSlice.back()==z)
+        // create k-sapce (inverse fourier transform slices)
+        itk::Size<2> outSize; outSize.SetElement(0, m_Parameters.m_SignalGen.m_ImageRegion.GetSize(0)); outSize.SetElement(1, m_Parameters.m_SignalGen.m_ImageRegion.GetSize(1));
+        itk::KspaceImageFilter< SliceType::PixelType >::Pointer idft = itk::KspaceImageFilter< SliceType::PixelType >::New();
+        idft->SetCompartmentImages(compartmentSlices);
+        idft->SetT2(t2Vector);
+        idft->SetUseConstantRandSeed(m_UseConstantRandSeed);
+        idft->SetRandSeed(seeds[job]);
+        idft->SetParameters(m_Parameters);
+        idft->SetZ((double)z-(double)numSlices/2.0);
+        idft->SetDiffusionGradientDirection(m_Parameters.m_SignalGen.GetGradientDirection(g));
+        idft->SetFrequencyMapSlice(fMapSlices[z]);
+        idft->SetOutSize(outSize);
+        idft->SetSpikesPerSlice(numSpikes[job]);
+        if (numThreads>1)
+            idft->SetNumberOfThreads(1);    // the jobs are already running in parallel
+        idft->Update();
+
+        ComplexSliceType::Pointer fSlice;
+        fSlice = idft->GetOutput();
+
+        // fourier transform slice
+        SliceType::Pointer newSlice;
+        itk::DftImageFilter< SliceType::PixelType >::Pointer dft = itk::DftImageFilter< SliceType::PixelType >::New();
+        dft->SetInput(fSlice);
+        if (numThreads>1)
+            dft->SetNumberOfThreads(1);
+        dft->Update();
+        newSlice = dft->GetOutput();
+
+        // put slice back into channel g (each job writes a different channel/slice, so only this component of the pixel is touched)
+        double* outBuffer = newImage->GetBufferPointer();
+        for (unsigned int y=0; y<fSlice->GetLargestPossibleRegion().GetSize(1); y++)
+            for (unsigned int x=0; x<fSlice->GetLargestPossibleRegion().GetSize(0); x++)
             {
-                numSpikes++;
-                spikeSlice.pop_back();
+                DoubleDwiType::IndexType index3D; index3D[0]=x; index3D[1]=y; index3D[2]=z;
+                SliceType::IndexType index2D; index2D[0]=x; index2D[1]=y;
+                outBuffer[newImage->ComputeOffset(index3D)*numChannels + g] = newSlice->GetPixel(index2D);
             }
-            idft->SetSpikesPerSlice(numSpikes);
-            idft->Update();
-
-            ComplexSliceType::Pointer fSlice;
-            fSlice = idft->GetOutput();
 
+#pragma omp critical
+        {
             ++disp;
             unsigned long newTick = 50*disp.count()/disp.expected_count();
-            for (unsigned  long tick = 0; tick<(newTick-lastTick); tick++)
-                m_StatusText += "*";
-            lastTick = newTick;
-
-            // fourier transform slice
-            SliceType::Pointer newSlice;
-            itk::DftImageFilter< SliceType::PixelType >::Pointer dft = itk::DftImageFilter< SliceType::PixelType >::New();
-            dft->SetInput(fSlice);
-            dft->Update();
-            newSlice = dft->GetOutput();
-
-            // put slice back into channel g
-            for (unsigned int y=0; y<fSlice->GetLargestPossibleRegion().GetSize(1); y++)
-                for (unsigned int x=0; x<fSlice->GetLargestPossibleRegion().GetSize(0); x++)
-                {
-                    DoubleDwiType::IndexType index3D; index3D[0]=x; index3D[1]=y; index3D[2]=z;
-                    SliceType::IndexType index2D; index2D[0]=x; index2D[1]=y;
-
-                    DoubleDwiType::PixelType pix3D = newImage->GetPixel(index3D);
-                    pix3D[g] = newSlice->GetPixel(index2D);
-                    newImage->SetPixel(index3D, pix3D);
-                }
-            ++disp;
-            newTick = 50*disp.count()/disp.expected_count();
             for (unsigned long tick = 0; tick<(newTick-lastTick); tick++)
                 m_StatusText += "*";
             lastTick = newTick;
         }
     }
+    if (aborted)
+        return NULL;
+
     m_StatusText += "\n\n";
     return newImage;
 }
 
+template< class PixelType >
+void TractsToDWIImageFilter< PixelType >::ComputeFiberSegments(double segmentVolume)
+{
+    vtkPolyData* fiberPolyData = m_FiberBundleTransformed->GetFiberPolyData();
+    vtkPoints* fiberPoints = fiberPolyData->GetPoints();
+    vtkSmartPointer<vtkCellArray> vLines = fiberPolyData->GetLines();
+    int numFibers = m_FiberBundleTransformed->GetNumFibers();
+
+    // point ids of all fibers, so that the fibers can be processed in any order
+    std::vector< vtkIdType > numPointsInCell(numFibers, 0);
+    std::vector< vtkIdType* > pointsInCell(numFibers, NULL);
+    vLines->InitTraversal();
+    for (int i=0; i<numFibers; i++)
+        vLines->GetNextCell(numPointsInCell[i], pointsInCell[i]);
+
+    std::vector< std::vector< FiberSegment > > fiberSegments(numFibers);
+#pragma omp parallel for schedule(dynamic, 64) num_threads(this->GetNumberOfThreads())
+    for (int i=0; i<numFibers; i++)
+    {
+        int numPoints = numPointsInCell[i];
+        if (numPoints<2)
+            continue;
+
+        double fiberVolume = segmentVolume*m_FiberBundleTransformed->GetFiberWeight(i);
+        for (int j=0; j<numPoints; j++)
+        {
+            double temp[3];
+            fiberPoints->GetPoint(pointsInCell[i][j], temp);
+            itk::Point<float, 3> vertex = GetItkPoint(temp);
+            itk::Vector<double> v = GetItkVector(temp);
+
+            double neighbor[3];
+            itk::Vector<double, 3> dir(3);
+            if (j<numPoints-1)
+            {
+                fiberPoints->GetPoint(pointsInCell[i][j+1], neighbor);
+                dir = GetItkVector(neighbor)-v;
+            }
+            else
+            {
+                fiberPoints->GetPoint(pointsInCell[i][j-1], neighbor);
+                dir = v-GetItkVector(neighbor);
+            }
+
+            if (dir.GetSquaredNorm()<0.0001 || dir[0]!=dir[0] || dir[1]!=dir[1] || dir[2]!=dir[2])
+                continue;
+
+            itk::Index<3> idx;
+            m_MaskImage->TransformPhysicalPointToIndex(vertex, idx);
+            if (!m_MaskImage->GetLargestPossibleRegion().IsInside(idx) || m_MaskImage->GetPixel(idx)<=0)
+                continue;
+
+            FiberSegment segment;
+            segment.index = idx;
+            segment.direction = dir;
+            segment.volume = fiberVolume;
+            fiberSegments[i].push_back(segment);
+        }
+    }
+
+    m_FiberSegments.clear();
+    m_FiberSegmentOffsets.clear();
+    m_FiberSegmentOffsets.reserve(numFibers+1);
+    for (int i=0; i<numFibers; i++)
+    {
+        m_FiberSegmentOffsets.push_back(m_FiberSegments.size());
+        m_FiberSegments.insert(m_FiberSegments.end(), fiberSegments[i].begin(), fiberSegments[i].end());
+    }
+    m_FiberSegmentOffsets.push_back(m_FiberSegments.size());
+}
+
 template< class PixelType >
 void TractsToDWIImageFilter< PixelType >::GenerateData()
 {
@@ -610,6 +698,18 @@ void TractsToDWIImageFilter< PixelType >::GenerateData()
         m_StatusText += "0%   10   20   30   40   50   60   70   80   90   100%\n";
         m_StatusText += "|----|----|----|----|----|----|----|----|----|----|\n*";
 
+        ItkDoubleImgType::Pointer intraAxonalVolumeImage = ItkDoubleImgType::New();
+        intraAxonalVolumeImage->SetSpacing( m_UpsampledSpacing );
+        intraAxonalVolumeImage->SetOrigin( m_UpsampledOrigin );
+        intraAxonalVolumeImage->SetDirection( m_Parameters.m_SignalGen.m_ImageDirection );
+        intraAxonalVolumeImage->SetLargestPossibleRegion( m_UpsampledImageRegion );
+        intraAxonalVolumeImage->SetBufferedRegion( m_UpsampledImageRegion );
+        intraAxonalVolumeImage->SetRequestedRegion( m_UpsampledImageRegion );
+        intraAxonalVolumeImage->Allocate();
+
+        std::vector< double > segmentDirections;    // contiguous fiber directions of all segments
+        std::vector< double > segmentSignals;       // signal of each segment, compartment by compartment
+
         for (unsigned int g=0; g<m_Parameters.m_SignalGen.GetNumVolumes(); g++)
         {
             // Set signal model random generator seeds to get same configuration in each voxel
@@ -618,74 +718,54 @@ void TractsToDWIImageFilter< PixelType >::GenerateData()
             for (int i=0; i<m_Parameters.m_NonFiberModelList.size(); i++)
                 m_Parameters.m_NonFiberModelList.at(i)->SetSeed(signalModelSeed);
 
-            ItkDoubleImgType::Pointer intraAxonalVolumeImage = ItkDoubleImgType::New();
-            intraAxonalVolumeImage->SetSpacing( m_UpsampledSpacing );
-            intraAxonalVolumeImage->SetOrigin( m_UpsampledOrigin );
-            intraAxonalVolumeImage->SetDirection( m_Parameters.m_SignalGen.m_ImageDirection );
-            intraAxonalVolumeImage->SetLargestPossibleRegion( m_UpsampledImageRegion );
-            intraAxonalVolumeImage->SetBufferedRegion( m_UpsampledImageRegion );
-            intraAxonalVolumeImage->SetRequestedRegion( m_UpsampledImageRegion );
-            intraAxonalVolumeImage->Allocate();
-            intraAxonalVolumeImage->FillBuffer(0);
-
-            vtkPolyData* fiberPolyData = m_FiberBundleTransformed->GetFiberPolyData();
+            // the fiber segments and their volume only change if the fibers are moved
+            if (g==0 || m_Parameters.m_SignalGen.m_DoAddMotion)
+            {
+                ComputeFiberSegments(segmentVolume);
+                segmentDirections.resize(3*m_FiberSegments.size());
+                segmentSignals.resize(numFiberCompartments*m_FiberSegments.size());
 
-            // generate fiber signal (if there are any fiber models present)
-            if (!m_Parameters.m_FiberModelList.empty())
-                for( int i=0; i<numFibers; i++ )
+                intraAxonalVolumeImage->FillBuffer(0);
+                for (unsigned int s=0; s<m_FiberSegments.size(); s++)
                 {
-                    float fiberWeight = m_FiberBundleTransformed->GetFiberWeight(i);
-                    vtkCell* cell = fiberPolyData->GetCell(i);
-                    int numPoints = cell->GetNumberOfPoints();
-                    vtkPoints* points = cell->GetPoints();
+                    const FiberSegment& segment = m_FiberSegments[s];
+                    segmentDirections[3*s] = segment.direction[0];
+                    segmentDirections[3*s+1] = segment.direction[1];
+                    segmentDirections[3*s+2] = segment.direction[2];
+                    double vol = intraAxonalVolumeImage->GetPixel(segment.index) + segment.volume;
+                    intraAxonalVolumeImage->SetPixel(segment.index, vol);
+                    if (g==0 && vol>maxVolume)
+                        maxVolume = vol;
+                }
+            }
 
-                    if (numPoints<2)
-                        continue;
+            // generate fiber signal (if there are any fiber models present)
+            if (!m_Parameters.m_FiberModelList.empty() && !m_FiberSegments.empty())
+            {
+                // one batched model evaluation per compartment for all segments
+                unsigned int numSegments = m_FiberSegments.size();
+                unsigned int numVolumes = m_Parameters.m_SignalGen.GetNumVolumes();
+                for (int k=0; k<numFiberCompartments; k++)
+                    m_Parameters.m_FiberModelList[k]->SimulateMeasurement(&segmentDirections[0], numSegments, g, g+1, &segmentSignals[k*numSegments]);
 
-                    for( int j=0; j<numPoints; j++)
+                for( unsigned int i=0; i+1<m_FiberSegmentOffsets.size(); i++ )
+                {
+                    if (this->GetAbortGenerateData())
                     {
-                        if (this->GetAbortGenerateData())
-                        {
-                            m_StatusText += "\n"+this->GetTime()+" > Simulation aborted\n";
-                            return;
-                        }
-
-                        double* temp = points->GetPoint(j);
-                        itk::Point<float, 3> vertex = GetItkPoint(temp);
-                        itk::Vector<double> v = GetItkVector(temp);
-
-                        itk::Vector<double, 3> dir(3);
-                        if (j<numPoints-1)
-                            dir = GetItkVector(points->GetPoint(j+1))-v;
-                        else
-                            dir = v-GetItkVector(points->GetPoint(j-1));
-
-                        if (dir.GetSquaredNorm()<0.0001 || dir[0]!=dir[0] || dir[1]!=dir[1] || dir[2]!=dir[2])
-                            continue;
-
-                        itk::Index<3> idx;
-                        itk::ContinuousIndex<float, 3> contIndex;
-                        m_MaskImage->TransformPhysicalPointToIndex(vertex, idx);
-                        m_MaskImage->TransformPhysicalPointToContinuousIndex(vertex, contIndex);
+                        m_StatusText += "\n"+this->GetTime()+" > Simulation aborted\n";
+                        return;
+                    }
 
-                        if (!m_MaskImage->GetLargestPossibleRegion().IsInside(idx) || m_MaskImage->GetPixel(idx)<=0)
-                            continue;
+                    for (unsigned int s=m_FiberSegmentOffsets[i]; s<m_FiberSegmentOffsets[i+1]; s++)
+                    {
+                        const FiberSegment& segment = m_FiberSegments[s];
 
-                        // generate signal for each fiber compartment
+                        // add signal of each fiber compartment (only channel g of the pixel is touched)
                         for (int k=0; k<numFiberCompartments; k++)
                         {
-                            m_Parameters.m_FiberModelList[k]->SetFiberDirection(dir);
-                            DoubleDwiType::PixelType pix = m_CompartmentImages.at(k)->GetPixel(idx);
-                            pix[g] += fiberWeight*segmentVolume*m_Parameters.m_FiberModelList[k]->SimulateMeasurement(g);
-
-                            m_CompartmentImages.at(k)->SetPixel(idx, pix);
+                            DoubleDwiType* compartmentImage = m_CompartmentImages.at(k);
+                            compartmentImage->GetBufferPointer()[compartmentImage->ComputeOffset(segment.index)*numVolumes + g] += segment.volume*segmentSignals[k*numSegments+s];
                         }
-
-                        // update fiber volume image
-                        double vol = intraAxonalVolumeImage->GetPixel(idx) + segmentVolume*fiberWeight;
-                        intraAxonalVolumeImage->SetPixel(idx, vol);
-                        if (g==0 && vol>maxVolume)
-                            maxVolume = vol;
                     }
 
                     // progress report
@@ -695,6 +775,7 @@ void TractsToDWIImageFilter< PixelType >::GenerateData()
                         m_StatusText += "*";
                     lastTick = newTick;
                 }
+            }
 
             // generate non-fiber signal
             ImageRegionIterator<ItkUcharImgType> it3(m_MaskImage, m_MaskImage->GetLargestPossibleRegion());
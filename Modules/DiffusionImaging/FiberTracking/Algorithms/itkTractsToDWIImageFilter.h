@@ -84,9 +84,21 @@ protected:
     double RoundToNearest(double num);
     std::string GetTime();
 
-    /** Transform generated image compartment by compartment, channel by channel and slice by slice using DFT and add k-space artifacts. */
+    /** Voxel, direction and volume of one fiber segment located inside of the tissue mask. */
+    struct FiberSegment
+    {
+        itk::Index<3>           index;
+        itk::Vector<double, 3>  direction;
+        double                  volume;
+    };
+
+    /** Transform generated image compartment by compartment, channel by channel and slice by slice using DFT and add k-space artifacts.
+      * The (channel, slice) pairs are processed in parallel, each with its own random seed drawn in a fixed order. */
     DoubleDwiType::Pointer DoKspaceStuff(std::vector< DoubleDwiType::Pointer >& images);
 
+    /** Map the points of the transformed fiber bundle to the voxels of the current mask (in parallel). Segments are stored in fiber order. */
+    void ComputeFiberSegments(double segmentVolume);
+
     /** Generate signal of non-fiber compartments. */
     void SimulateNonFiberSignal(ItkUcharImgType::IndexType index, double intraAxonalVolume, int g=-1);
 
@@ -118,6 +130,8 @@ protected:
     std::vector< DoubleDwiType::Pointer >       m_CompartmentImages;
     ItkUcharImgType::Pointer                    m_MaskImage;                ///< copy of mask image (changes for each motion step)
     ItkUcharImgType::Pointer                    m_UpsampledMaskImage;       ///< helper image for motion simulation
+    std::vector< FiberSegment >                 m_FiberSegments;
+    std::vector< unsigned int >                 m_FiberSegmentOffsets;      ///< index of the first segment of each fiber (plus end index)
     DoubleVectorType                            m_Rotation;
     DoubleVectorType                            m_Translation;
     itk::Statistics::MersenneTwisterRandomVariateGenerator::Pointer m_RandGen;
@@ -1,185 +1,262 @@
 #include <mitkTrackvis.h>
-#include <vtkTransformPolyDataFilter.h>
-
-TrackVisFiberReader::TrackVisFiberReader()  { m_Filename = ""; m_FilePointer = nullptr; }
-
-TrackVisFiberReader::~TrackVisFiberReader() { if (m_FilePointer) fclose( m_FilePointer ); }
+#include <vtkIdTypeArray.h>
+#include <vtkFloatArray.h>
+#include <vtkMatrix4x4.h>
+#include <cstring>
+#include <algorithm>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+// Memory mapped TrackVis reader
+// -----------------------------
+TrackVisStreamReader::TrackVisStreamReader()
+    : m_Data(nullptr)
+    , m_Size(0)
+    , m_PointSize(3)
+#ifdef _WIN32
+    , m_FileHandle(nullptr)
+    , m_MappingHandle(nullptr)
+#else
+    , m_FileDescriptor(-1)
+#endif
+{
+    memset(&m_Header, 0, sizeof(m_Header));
+    m_Flip[0] = m_Flip[1] = m_Flip[2] = 1;
+}
 
+TrackVisStreamReader::~TrackVisStreamReader()
+{
+    Close();
+}
 
-// Create a TrackVis file and store standard metadata. The file is ready to append fibers.
-// ---------------------------------------------------------------------------------------
-short TrackVisFiberReader::create(string filename , const mitk::FiberBundle *fib)
+bool TrackVisStreamReader::Open(string filename)
 {
-    // prepare the header
-    for(int i=0; i<3 ;i++)
+    Close();
+
+#ifdef _WIN32
+    HANDLE file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    if (file == INVALID_HANDLE_VALUE)
     {
-        if (fib->GetReferenceGeometry().IsNotNull())
-        {
-            m_Header.dim[i]            = fib->GetReferenceGeometry()->GetExtent(i);
-            m_Header.voxel_size[i]     = fib->GetReferenceGeometry()->GetSpacing()[i];
-            m_Header.origin[i]         = fib->GetReferenceGeometry()->GetOrigin()[i];
-        }
-        else
-        {
-            m_Header.dim[i]            = fib->GetGeometry()->GetExtent(i);
-            m_Header.voxel_size[i]     = fib->GetGeometry()->GetSpacing()[i];
-            m_Header.origin[i]         = fib->GetGeometry()->GetOrigin()[i];
-        }
+        MITK_ERROR << "TrackVisStreamReader: unable to open file " << filename;
+        return false;
     }
-    m_Header.n_scalars = 0;
-    m_Header.n_properties = 0;
-    sprintf(m_Header.voxel_order,"LPS");
-    m_Header.image_orientation_patient[0] = 1.0;
-    m_Header.image_orientation_patient[1] = 0.0;
-    m_Header.image_orientation_patient[2] = 0.0;
-    m_Header.image_orientation_patient[3] = 0.0;
-    m_Header.image_orientation_patient[4] = 1.0;
-    m_Header.image_orientation_patient[5] = 0.0;
-    m_Header.pad1[0] = 0;
-    m_Header.pad1[1] = 0;
-    m_Header.pad2[0] = 0;
-    m_Header.pad2[1] = 0;
-    m_Header.invert_x = 0;
-    m_Header.invert_y = 0;
-    m_Header.invert_z = 0;
-    m_Header.swap_xy = 0;
-    m_Header.swap_yz = 0;
-    m_Header.swap_zx = 0;
-    m_Header.n_count = 0;
-    m_Header.version = 1;
-    m_Header.hdr_size = 1000;
-
-    // write the header to the file
-    m_FilePointer = fopen(filename.c_str(),"w+b");
-    if (m_FilePointer == nullptr)
+    LARGE_INTEGER size;
+    GetFileSizeEx(file, &size);
+    m_Size = size.QuadPart;
+    m_FileHandle = file;
+    if (m_Size > 0)
     {
-        printf("[ERROR] Unable to create file '%s'\n",filename.c_str());
-        return 0;
+        m_MappingHandle = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+        if (m_MappingHandle != nullptr)
+            m_Data = (const char*)MapViewOfFile(m_MappingHandle, FILE_MAP_READ, 0, 0, 0);
     }
-    sprintf(m_Header.id_string,"TRACK");
-    if (fwrite((char*)&m_Header, 1, 1000, m_FilePointer) != 1000)
-        MITK_ERROR << "TrackVis::create : Error occurding during writing fiber.";
-
-    this->m_Filename = filename;
-
-    return 1;
-}
-
-
-// Open an existing TrackVis file and read metadata information.
-// The file pointer is positiond at the beginning of fibers data
-// -------------------------------------------------------------
-short TrackVisFiberReader::open( string filename )
-{
-    m_FilePointer = fopen(filename.c_str(),"r+b");
-    if (m_FilePointer == nullptr)
+#else
+    m_FileDescriptor = ::open(filename.c_str(), O_RDONLY);
+    if (m_FileDescriptor < 0)
     {
-        printf("[ERROR] Unable to open file '%s'\n",filename.c_str());
-        return 0;
+        MITK_ERROR << "TrackVisStreamReader: unable to open file " << filename;
+        return false;
     }
-    this->m_Filename = filename;
-
-    return fread((char*)(&m_Header), 1, 1000, m_FilePointer);
-}
-
-
-
-// Append a fiber to the file
-// --------------------------
-short TrackVisFiberReader::append(const mitk::FiberBundle *fib)
-{
-    vtkPolyData* poly = fib->GetFiberPolyData();
-    for (int i=0; i<fib->GetNumFibers(); i++)
+    struct stat fileStat;
+    fstat(m_FileDescriptor, &fileStat);
+    m_Size = fileStat.st_size;
+    if (m_Size > 0)
     {
-        vtkCell* cell = poly->GetCell(i);
-        int numPoints = cell->GetNumberOfPoints();
-        vtkPoints* points = cell->GetPoints();
-
-        unsigned int     numSaved, pos = 0;
-        //float* tmp = new float[3*maxSteps];
-        std::vector< float > tmp;
-        tmp.reserve(3*numPoints);
-
-        numSaved = numPoints;
-        for(unsigned int i=0; i<numSaved ;i++)
+        void* data = mmap(nullptr, m_Size, PROT_READ, MAP_PRIVATE, m_FileDescriptor, 0);
+        if (data != MAP_FAILED)
         {
-            double* p = points->GetPoint(i);
-
-            tmp[pos++] = p[0];
-            tmp[pos++] = p[1];
-            tmp[pos++] = p[2];
+            m_Data = (const char*)data;
+            madvise(data, m_Size, MADV_SEQUENTIAL);
         }
+    }
+#endif
 
-        // write the coordinates to the file
-        if ( fwrite((char*)&numSaved, 1, 4, m_FilePointer) != 4 )
+    if (m_Data == nullptr)
+    {
+        MITK_ERROR << "TrackVisStreamReader: unable to map file " << filename;
+        Close();
+        return false;
+    }
+    if (m_Size < 1000)
+    {
+        MITK_ERROR << "TrackVisStreamReader: file too small " << filename;
+        Close();
+        return false;
+    }
+    memcpy(&m_Header, m_Data, 1000);
+
+    m_PointSize = 3 + std::max((int)m_Header.n_scalars, 0);
+    int numProperties = std::max((int)m_Header.n_properties, 0);
+    m_Flip[0] = m_Header.voxel_order[0]=='R' ? -1 : 1;
+    m_Flip[1] = m_Header.voxel_order[1]=='A' ? -1 : 1;
+    m_Flip[2] = m_Header.voxel_order[2]=='I' ? -1 : 1;
+
+    // index the fibers
+    m_FiberOffsets.clear();
+    if (m_Header.n_count > 0)
+        m_FiberOffsets.reserve(m_Header.n_count);
+    size_t offset = 1000;
+    while (offset + 4 <= m_Size)
+    {
+        int numPoints;
+        memcpy(&numPoints, m_Data + offset, 4);
+        if (numPoints <= 0)
         {
-            printf( "[ERROR] Problems saving the fiber!\n" );
-            return 1;
+            MITK_ERROR << "TrackVisStreamReader: trying to read a fiber with " << numPoints << " points!";
+            break;
         }
-        if ( fwrite((char*)&(tmp.front()), 1, 4*pos, m_FilePointer) != 4*pos )
+        size_t fiberSize = 4 + 4*((size_t)numPoints*m_PointSize + numProperties);
+        if (offset + fiberSize > m_Size)
         {
-            printf( "[ERROR] Problems saving the fiber!\n" );
-            return 1;
+            MITK_ERROR << "TrackVisStreamReader: file is truncated after " << m_FiberOffsets.size() << " fibers.";
+            break;
         }
+        m_FiberOffsets.push_back(offset);
+        offset += fiberSize;
     }
 
-    return 0;
+    MITK_INFO << "Coordinate convention: " << m_Header.voxel_order;
+    return true;
+}
+
+void TrackVisStreamReader::Close()
+{
+#ifdef _WIN32
+    if (m_Data != nullptr)
+        UnmapViewOfFile(m_Data);
+    if (m_MappingHandle != nullptr)
+        CloseHandle(m_MappingHandle);
+    if (m_FileHandle != nullptr)
+        CloseHandle(m_FileHandle);
+    m_MappingHandle = nullptr;
+    m_FileHandle = nullptr;
+#else
+    if (m_Data != nullptr)
+        munmap((void*)m_Data, m_Size);
+    if (m_FileDescriptor >= 0)
+        ::close(m_FileDescriptor);
+    m_FileDescriptor = -1;
+#endif
+    m_Data = nullptr;
+    m_Size = 0;
+    m_FiberOffsets.clear();
 }
 
-//// Read one fiber from the file
-//// ----------------------------
-short TrackVisFiberReader::read( mitk::FiberBundle* fib )
+int TrackVisStreamReader::GetNumPoints(int fiber) const
 {
     int numPoints;
-    vtkSmartPointer<vtkPoints> vtkNewPoints = vtkSmartPointer<vtkPoints>::New();
-    vtkSmartPointer<vtkCellArray> vtkNewCells = vtkSmartPointer<vtkCellArray>::New();
+    memcpy(&numPoints, m_Data + m_FiberOffsets.at(fiber), 4);
+    return numPoints;
+}
 
-    while (fread((char*)&numPoints, 1, 4, m_FilePointer)==4)
+void TrackVisStreamReader::DecodePoints(int first, int last, float* out) const
+{
+    for (int f=first; f<last; f++)
     {
-        if ( numPoints <= 0 )
+        int numPoints = GetNumPoints(f);
+        const char* in = m_Data + m_FiberOffsets.at(f) + 4;
+        if (m_PointSize == 3)
         {
-            printf( "[ERROR] Trying to read a fiber with %d points!\n", numPoints );
-            return -1;
+            memcpy(out, in, 12*(size_t)numPoints);
+            for (int i=0; i<numPoints; i++)
+            {
+                out[3*i] *= m_Flip[0];
+                out[3*i+1] *= m_Flip[1];
+                out[3*i+2] *= m_Flip[2];
+            }
         }
-        vtkSmartPointer<vtkPolyLine> container = vtkSmartPointer<vtkPolyLine>::New();
-
-        float tmp[3];
-        for(int i=0; i<numPoints; i++)
+        else
         {
-            if (fread((char*)tmp, 1, 12, m_FilePointer) == 0)
-                MITK_ERROR << "TrackVis::read: Error during read.";
-
-            vtkIdType id = vtkNewPoints->InsertNextPoint(tmp);
-            container->GetPointIds()->InsertNextId(id);
+            // skip the scalars of each point
+            for (int i=0; i<numPoints; i++)
+            {
+                memcpy(out + 3*i, in + 4*(size_t)i*m_PointSize, 12);
+                out[3*i] *= m_Flip[0];
+                out[3*i+1] *= m_Flip[1];
+                out[3*i+2] *= m_Flip[2];
+            }
         }
-        vtkNewCells->InsertNextCell(container);
+        out += 3*numPoints;
+    }
+}
+
+void TrackVisStreamReader::ReadChunk(int first, int last, Chunk& chunk) const
+{
+    first = std::max(first, 0);
+    last = std::min(last, GetNumFibers());
+    chunk.firstFiber = first;
+    chunk.numPoints.clear();
+    chunk.points.clear();
+
+    size_t totalPoints = 0;
+    for (int f=first; f<last; f++)
+    {
+        chunk.numPoints.push_back(GetNumPoints(f));
+        totalPoints += chunk.numPoints.back();
+    }
+    chunk.points.resize(3*totalPoints);
+    if (totalPoints > 0)
+        DecodePoints(first, last, chunk.points.data());
+}
+
+vtkSmartPointer<vtkPolyData> TrackVisStreamReader::GetFiberPolyData(int first, int last) const
+{
+    first = std::max(first, 0);
+    last = std::min(last, GetNumFibers());
+    int numFibers = std::max(last - first, 0);
+    vtkIdType numPoints = 0;
+    for (int f=first; f<last; f++)
+        numPoints += GetNumPoints(f);
+
+    // the coordinates are decoded directly into the point array
+    vtkSmartPointer<vtkFloatArray> coordinates = vtkSmartPointer<vtkFloatArray>::New();
+    coordinates->SetNumberOfComponents(3);
+    coordinates->SetNumberOfTuples(numPoints);
+    if (numPoints > 0)
+        DecodePoints(first, last, coordinates->GetPointer(0));
+    vtkSmartPointer<vtkPoints> points = vtkSmartPointer<vtkPoints>::New();
+    points->SetData(coordinates);
+
+    // cell array layout: number of points followed by the point ids of each fiber
+    vtkSmartPointer<vtkIdTypeArray> ids = vtkSmartPointer<vtkIdTypeArray>::New();
+    ids->SetNumberOfValues(numFibers + numPoints);
+    vtkIdType* id = ids->GetPointer(0);
+    vtkIdType pointId = 0;
+    for (int f=first; f<last; f++)
+    {
+        int fiberPoints = GetNumPoints(f);
+        *id++ = fiberPoints;
+        for (int i=0; i<fiberPoints; i++)
+            *id++ = pointId++;
     }
+    vtkSmartPointer<vtkCellArray> cells = vtkSmartPointer<vtkCellArray>::New();
+    cells->SetCells(numFibers, ids);
 
     vtkSmartPointer<vtkPolyData> fiberPolyData = vtkSmartPointer<vtkPolyData>::New();
-    fiberPolyData->SetPoints(vtkNewPoints);
-    fiberPolyData->SetLines(vtkNewCells);
+    fiberPolyData->SetPoints(points);
+    fiberPolyData->SetLines(cells);
+    return fiberPolyData;
+}
 
-    MITK_INFO << "Coordinate convention: " << m_Header.voxel_order;
+void TrackVisStreamReader::Read(mitk::FiberBundle* fib) const
+{
+    fib->SetFiberPolyData(GetFiberPolyData(0, GetNumFibers()));
 
+    // the points are already flipped to LPS, the geometry keeps the orientation of the voxel order
     mitk::Geometry3D::Pointer geometry = mitk::Geometry3D::New();
     vtkSmartPointer< vtkMatrix4x4 > matrix = vtkSmartPointer< vtkMatrix4x4 >::New();
     matrix->Identity();
-
-    if (m_Header.voxel_order[0]=='R')
-        matrix->SetElement(0,0,-matrix->GetElement(0,0));
-    if (m_Header.voxel_order[1]=='A')
-        matrix->SetElement(1,1,-matrix->GetElement(1,1));
-    if (m_Header.voxel_order[2]=='I')
-        matrix->SetElement(2,2,-matrix->GetElement(2,2));
-
+    for (int i=0; i<3; i++)
+        matrix->SetElement(i,i,m_Flip[i]);
     geometry->SetIndexToWorldTransformByVtkMatrix(matrix);
 
-    vtkSmartPointer<vtkTransformPolyDataFilter> transformFilter = vtkSmartPointer<vtkTransformPolyDataFilter>::New();
-    transformFilter->SetInputData(fiberPolyData);
-    transformFilter->SetTransform(geometry->GetVtkTransform());
-    transformFilter->Update();
-    fib->SetFiberPolyData(transformFilter->GetOutput());
-
     mitk::Point3D origin;
     origin[0]=m_Header.origin[0];
     origin[1]=m_Header.origin[1];
@@ -197,41 +274,185 @@ short TrackVisFiberReader::read( mitk::FiberBundle* fib )
     geometry->SetExtentInMM(2, m_Header.voxel_size[2]*m_Header.dim[2]);
 
     fib->SetReferenceGeometry(dynamic_cast<mitk::BaseGeometry*>(geometry.GetPointer()));
+}
 
-    return numPoints;
+TrackVisStreamReader::ChunkIterator::ChunkIterator(const TrackVisStreamReader* reader, int chunkSize)
+    : m_Reader(reader)
+    , m_ChunkSize(std::max(chunkSize, 1))
+{
+    GoToBegin();
 }
 
+void TrackVisStreamReader::ChunkIterator::GoToBegin()
+{
+    m_Reader->ReadChunk(0, m_ChunkSize, m_Chunk);
+}
 
+bool TrackVisStreamReader::ChunkIterator::IsAtEnd() const
+{
+    return m_Chunk.firstFiber >= m_Reader->GetNumFibers();
+}
 
-// Update the field in the header to the new FIBER TOTAL.
-// ------------------------------------------------------
-void TrackVisFiberReader::updateTotal( int totFibers )
+TrackVisStreamReader::ChunkIterator& TrackVisStreamReader::ChunkIterator::operator++()
 {
-    fseek(m_FilePointer, 1000-12, SEEK_SET);
-    if (fwrite((char*)&totFibers, 1, 4, m_FilePointer) != 4)
-        MITK_ERROR << "[ERROR] Problems saving the fiber!";
+    int first = m_Chunk.firstFiber + m_ChunkSize;
+    m_Reader->ReadChunk(first, first + m_ChunkSize, m_Chunk);
+    m_Chunk.firstFiber = first;
+    return *this;
 }
 
 
-void TrackVisFiberReader::writeHdr()
+// Buffered TrackVis writer
+// ------------------------
+TrackVisStreamWriter::TrackVisStreamWriter(size_t bufferSize)
+    : m_FilePointer(nullptr)
+    , m_BufferSize(std::max(bufferSize, (size_t)1024))
+    , m_NumFibers(0)
+    , m_Failed(false)
 {
-    fseek(m_FilePointer, 0, SEEK_SET);
-    if (fwrite((char*)&m_Header, 1, 1000, m_FilePointer) != 1000)
-        MITK_ERROR << "[ERROR] Problems saving the fiber!";
+
 }
 
+TrackVisStreamWriter::~TrackVisStreamWriter()
+{
+    if (m_FilePointer != nullptr)
+        Close();
+}
 
-// Close the TrackVis file, but keep the metadata in the header.
-// -------------------------------------------------------------
-void TrackVisFiberReader::close()
+void TrackVisStreamWriter::InitHeader(TrackVis_header& header, const mitk::FiberBundle* fib)
 {
-    fclose(m_FilePointer);
-    m_FilePointer = nullptr;
+    memset(&header, 0, sizeof(header));
+    for(int i=0; i<3 ;i++)
+    {
+        if (fib->GetReferenceGeometry().IsNotNull())
+        {
+            header.dim[i]            = fib->GetReferenceGeometry()->GetExtent(i);
+            header.voxel_size[i]     = fib->GetReferenceGeometry()->GetSpacing()[i];
+            header.origin[i]         = fib->GetReferenceGeometry()->GetOrigin()[i];
+        }
+        else
+        {
+            header.dim[i]            = fib->GetGeometry()->GetExtent(i);
+            header.voxel_size[i]     = fib->GetGeometry()->GetSpacing()[i];
+            header.origin[i]         = fib->GetGeometry()->GetOrigin()[i];
+        }
+    }
+    header.n_scalars = 0;
+    header.n_properties = 0;
+    sprintf(header.voxel_order,"LPS");
+    header.image_orientation_patient[0] = 1.0;
+    header.image_orientation_patient[1] = 0.0;
+    header.image_orientation_patient[2] = 0.0;
+    header.image_orientation_patient[3] = 0.0;
+    header.image_orientation_patient[4] = 1.0;
+    header.image_orientation_patient[5] = 0.0;
+    header.pad1[0] = 0;
+    header.pad1[1] = 0;
+    header.pad2[0] = 0;
+    header.pad2[1] = 0;
+    header.invert_x = 0;
+    header.invert_y = 0;
+    header.invert_z = 0;
+    header.swap_xy = 0;
+    header.swap_yz = 0;
+    header.swap_zx = 0;
+    header.n_count = 0;
+    header.version = 1;
+    header.hdr_size = 1000;
+    sprintf(header.id_string,"TRACK");
+}
+
+bool TrackVisStreamWriter::Create(string filename, const mitk::FiberBundle* fib)
+{
+    TrackVis_header header;
+    InitHeader(header, fib);
+    return Create(filename, header);
 }
 
-bool TrackVisFiberReader::IsTransformValid()
+bool TrackVisStreamWriter::Create(string filename, const TrackVis_header& header)
 {
-    if (fabs(m_Header.image_orientation_patient[0])<=0.001 || fabs(m_Header.image_orientation_patient[3])<=0.001 || fabs(m_Header.image_orientation_patient[5])<=0.001)
+    if (m_FilePointer != nullptr)
+        Close();
+
+    m_FilePointer = fopen(filename.c_str(),"wb");
+    if (m_FilePointer == nullptr)
+    {
+        MITK_ERROR << "TrackVisStreamWriter: unable to create file " << filename;
         return false;
+    }
+
+    m_NumFibers = 0;
+    m_Failed = false;
+    m_Buffer.clear();
+    m_Buffer.reserve(m_BufferSize);
+    m_Buffer.insert(m_Buffer.end(), (const char*)&header, (const char*)&header + 1000);
     return true;
 }
+
+void TrackVisStreamWriter::AddFiber(const float* points, int numPoints)
+{
+    if (m_FilePointer == nullptr || numPoints <= 0)
+        return;
+
+    size_t numBytes = 4 + 12*(size_t)numPoints;
+    if (m_Buffer.size() + numBytes > m_BufferSize)
+        Flush();
+
+    m_Buffer.insert(m_Buffer.end(), (const char*)&numPoints, (const char*)&numPoints + 4);
+    m_Buffer.insert(m_Buffer.end(), (const char*)points, (const char*)points + 12*(size_t)numPoints);
+    m_NumFibers++;
+}
+
+void TrackVisStreamWriter::AddFibers(vtkPolyData* poly)
+{
+    vtkCellArray* cells = poly->GetLines();
+    if (cells == nullptr)
+        return;
+
+    std::vector< float > coordinates;
+    vtkIdType numPoints; vtkIdType* pointIds;
+    cells->InitTraversal();
+    while (cells->GetNextCell(numPoints, pointIds))
+    {
+        coordinates.resize(3*numPoints);
+        for (vtkIdType i=0; i<numPoints; i++)
+        {
+            double* p = poly->GetPoint(pointIds[i]);
+            coordinates[3*i] = p[0];
+            coordinates[3*i+1] = p[1];
+            coordinates[3*i+2] = p[2];
+        }
+        AddFiber(coordinates.data(), numPoints);
+    }
+}
+
+bool TrackVisStreamWriter::Flush()
+{
+    if (!m_Buffer.empty() && fwrite(m_Buffer.data(), 1, m_Buffer.size(), m_FilePointer) != m_Buffer.size())
+    {
+        MITK_ERROR << "TrackVisStreamWriter: problems saving the fibers!";
+        m_Failed = true;
+    }
+    m_Buffer.clear();
+    return !m_Failed;
+}
+
+bool TrackVisStreamWriter::Close()
+{
+    if (m_FilePointer == nullptr)
+        return false;
+
+    Flush();
+
+    // update the total number of fibers in the header
+    fseek(m_FilePointer, 1000-12, SEEK_SET);
+    if (fwrite((char*)&m_NumFibers, 1, 4, m_FilePointer) != 4)
+    {
+        MITK_ERROR << "TrackVisStreamWriter: problems saving the fiber count!";
+        m_Failed = true;
+    }
+
+    fclose(m_FilePointer);
+    m_FilePointer = nullptr;
+    return !m_Failed;
+}
@@ -24,6 +24,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <vtkPoints.h>
 #include <vtkPolyLine.h>
 #include <itkSize.h>
+#include <vector>
 
 using namespace std;
 
@@ -55,28 +56,106 @@ struct TrackVis_header
     int                 hdr_size;
 };
 
-// Class to handle TrackVis files.
-// -------------------------------
-class MITKFIBERTRACKING_EXPORT TrackVisFiberReader
+// Memory mapped read access to the fibers of a TrackVis file.
+// Open() indexes the fiber offsets in one pass over the mapped file. Fibers are then
+// read in chunks of consecutive fibers without materializing the whole tractogram.
+// ------------------------------------------------------------------------------------
+class MITKFIBERTRACKING_EXPORT TrackVisStreamReader
 {
+public:
+
+    // Consecutive fibers with the point coordinates of all fibers stored consecutively.
+    struct Chunk
+    {
+        int                 firstFiber;
+        std::vector< int >  numPoints;  // number of points of each fiber
+        std::vector< float > points;    // x,y,z of all points in world coordinates
+    };
+
+    // Forward iterator over all fibers of the file in chunks of a fixed number of fibers.
+    class ChunkIterator
+    {
+    public:
+        ChunkIterator(const TrackVisStreamReader* reader, int chunkSize);
+        void            GoToBegin();
+        bool            IsAtEnd() const;
+        ChunkIterator&  operator++();
+        const Chunk&    Get() const { return m_Chunk; }
+
+    private:
+        const TrackVisStreamReader* m_Reader;
+        int                         m_ChunkSize;
+        Chunk                       m_Chunk;
+    };
+
+    TrackVisStreamReader();
+    ~TrackVisStreamReader();
+
+    bool    Open(string filename);
+    void    Close();
+    bool    IsOpen() const { return m_Data!=nullptr; }
+
+    const TrackVis_header& GetHeader() const { return m_Header; }
+    int     GetNumFibers() const { return m_FiberOffsets.size(); }
+    int     GetNumPoints(int fiber) const;
+
+    void    ReadChunk(int first, int last, Chunk& chunk) const;                       // fibers first..last-1
+    vtkSmartPointer<vtkPolyData>  GetFiberPolyData(int first, int last) const;     // fibers first..last-1
+    ChunkIterator   GetChunkIterator(int chunkSize) const { return ChunkIterator(this, chunkSize); }
+
+    // Reads all fibers and the reference geometry stored in the header into the fiber bundle.
+    void    Read(mitk::FiberBundle* fib) const;
+
 private:
-    string              m_Filename;
-    FILE*               m_FilePointer;
 
+    TrackVisStreamReader(const TrackVisStreamReader&);
+    TrackVisStreamReader& operator=(const TrackVisStreamReader&);
+
+    void    DecodePoints(int first, int last, float* out) const;  // x,y,z of fibers first..last-1 in world coordinates
+
+    TrackVis_header         m_Header;
+    const char*             m_Data;         // mapped file
+    size_t                  m_Size;
+    std::vector< size_t >   m_FiberOffsets; // file offset of each fiber
+    int                     m_PointSize;    // number of floats per point (coordinates and scalars)
+    float                   m_Flip[3];      // axis flips applied to convert the voxel order to LPS
+#ifdef _WIN32
+    void*                   m_FileHandle;
+    void*                   m_MappingHandle;
+#else
+    int                     m_FileDescriptor;
+#endif
+};
+
+// Buffered sequential writing of TrackVis files. Fibers are appended one by one,
+// e.g. directly by a tracking filter, and written to disk whenever the buffer is full.
+// -------------------------------------------------------------------------------------
+class MITKFIBERTRACKING_EXPORT TrackVisStreamWriter
+{
 public:
-    TrackVis_header     m_Header;
-
-    short   create(string m_Filename, const mitk::FiberBundle* fib);
-    short   open( string m_Filename );
-    short   read( mitk::FiberBundle* fib );
-    short   append(const mitk::FiberBundle* fib );
-    void    writeHdr();
-    void    updateTotal( int totFibers );
-    void    close();
-    bool    IsTransformValid();
-
-    TrackVisFiberReader();
-    ~TrackVisFiberReader();
+
+    TrackVisStreamWriter(size_t bufferSize = 4*1024*1024);
+    ~TrackVisStreamWriter();
+
+    // Creates the file. The header is initialized with the (reference) geometry of the fiber bundle.
+    bool    Create(string filename, const mitk::FiberBundle* fib);
+    bool    Create(string filename, const TrackVis_header& header);
+    void    AddFiber(const float* points, int numPoints);   // x,y,z of each point
+    void    AddFibers(vtkPolyData* poly);
+    bool    Close();                                        // writes the remaining buffer and the number of fibers
+
+    int     GetNumFibers() const { return m_NumFibers; }
+    static void InitHeader(TrackVis_header& header, const mitk::FiberBundle* fib);
+
+private:
+
+    bool    Flush();
+
+    FILE*               m_FilePointer;
+    std::vector< char > m_Buffer;
+    size_t              m_BufferSize;
+    int                 m_NumFibers;
+    bool                m_Failed;
 };
 
 #endif
@@ -125,3 +125,54 @@ typename AstroStickModel< ScalarType >::PixelType AstroStickModel< ScalarType >:
 
     return signal;
 }
+
+template< class ScalarType >
+void AstroStickModel< ScalarType >::SimulateMeasurement(const double* fiberDirections, unsigned int numFibers, unsigned int firstDir, unsigned int lastDir, ScalarType* signal)
+{
+    // random stick configurations consume random numbers in the order of the single measurements
+    if (m_RandomizeSticks)
+    {
+        DiffusionSignalModel< ScalarType >::SimulateMeasurement(fiberDirections, numFibers, firstDir, lastDir, signal);
+        return;
+    }
+
+    unsigned int numDirs = lastDir-firstDir;
+    if (numDirs==0 || m_NumSticks==0)
+        return;
+
+    // the signal does not depend on the fiber direction
+    ScalarType b = -m_BValue*m_Diffusivity;
+    std::vector< double > bVal(numDirs, 0);
+    std::vector< double > arguments(numDirs*m_NumSticks, 0);
+    std::vector< double > values(numDirs*m_NumSticks);
+    for (unsigned int d=firstDir; d<lastDir && d<this->m_GradientList.size(); d++)
+    {
+        GradientType g = this->m_GradientList[d];
+        ScalarType gNorm = g.GetNorm(); gNorm *= gNorm;
+        bVal[d-firstDir] = gNorm;
+        for (unsigned int j=0; j<m_NumSticks; j++)
+        {
+            ScalarType dot = m_Sticks[j]*g;
+            arguments[(d-firstDir)*m_NumSticks+j] = b*gNorm*dot*dot;
+        }
+    }
+    FastExp(&arguments[0], &values[0], arguments.size());
+
+    std::vector< ScalarType > dirSignal(numDirs, 0);
+    for (unsigned int d=0; d<numDirs; d++)
+    {
+        if (d+firstDir>=this->m_GradientList.size())
+            continue;
+        if (bVal[d]>0.0001)
+        {
+            for (unsigned int j=0; j<m_NumSticks; j++)
+                dirSignal[d] += values[d*m_NumSticks+j];
+            dirSignal[d] /= m_NumSticks;
+        }
+        else
+            dirSignal[d] = 1;
+    }
+    for (unsigned int f=0; f<numFibers; f++)
+        for (unsigned int d=0; d<numDirs; d++)
+            signal[f*numDirs+d] = dirSignal[d];
+}
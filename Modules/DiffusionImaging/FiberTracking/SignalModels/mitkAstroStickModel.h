@@ -18,6 +18,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 #define _MITK_AstroStickModel_H
 
 #include <mitkDiffusionSignalModel.h>
+#include <mitkFastExp.h>
 #include <itkPointShell.h>
 
 namespace mitk {
@@ -57,6 +58,7 @@ public:
     /** Actual signal generation **/
     PixelType SimulateMeasurement();
     ScalarType SimulateMeasurement(unsigned int dir);
+    void SimulateMeasurement(const double* fiberDirections, unsigned int numFibers, unsigned int firstDir, unsigned int lastDir, ScalarType* signal);   ///< batched version, see DiffusionSignalModel
 
 
     void SetFiberDirection(GradientType fiberDirection){ this->m_FiberDirection = fiberDirection; }
@@ -71,3 +71,35 @@ typename BallModel< ScalarType >::PixelType BallModel< ScalarType >::SimulateMea
 
     return signal;
 }
+
+template< class ScalarType >
+void BallModel< ScalarType >::SimulateMeasurement(const double* /*fiberDirections*/, unsigned int numFibers, unsigned int firstDir, unsigned int lastDir, ScalarType* signal)
+{
+    unsigned int numDirs = lastDir-firstDir;
+    if (numDirs==0)
+        return;
+
+    // the signal does not depend on the fiber direction
+    std::vector< double > arguments(numDirs, 0);
+    std::vector< double > bVal(numDirs, 0);
+    std::vector< double > values(numDirs);
+    for (unsigned int d=firstDir; d<lastDir && d<this->m_GradientList.size(); d++)
+    {
+        GradientType g = this->m_GradientList[d];
+        ScalarType b = g.GetNorm(); b *= b;
+        bVal[d-firstDir] = b;
+        arguments[d-firstDir] = -m_BValue * b * m_Diffusivity;
+    }
+    FastExp(&arguments[0], &values[0], numDirs);
+
+    for (unsigned int d=0; d<numDirs; d++)
+    {
+        if (d+firstDir>=this->m_GradientList.size())
+            values[d] = 0;
+        else if (bVal[d]<=0.0001)
+            values[d] = 1;
+    }
+    for (unsigned int f=0; f<numFibers; f++)
+        for (unsigned int d=0; d<numDirs; d++)
+            signal[f*numDirs+d] = values[d];
+}
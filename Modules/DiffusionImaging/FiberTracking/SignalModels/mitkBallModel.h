@@ -18,6 +18,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 #define _MITK_BallModel_H
 
 #include <mitkDiffusionSignalModel.h>
+#include <mitkFastExp.h>
 
 namespace mitk {
 
@@ -54,6 +55,7 @@ public:
     /** Actual signal generation **/
     PixelType SimulateMeasurement();
     ScalarType SimulateMeasurement(unsigned int dir);
+    void SimulateMeasurement(const double* fiberDirections, unsigned int numFibers, unsigned int firstDir, unsigned int lastDir, ScalarType* signal);   ///< batched version, see DiffusionSignalModel
 
     void SetDiffusivity(double D) { m_Diffusivity = D; }
     double GetDiffusivity() { return m_Diffusivity; }
@@ -51,6 +51,27 @@ public:
     virtual PixelType SimulateMeasurement() = 0;
     virtual ScalarType SimulateMeasurement(unsigned int dir) = 0;
 
+    /**
+      * \brief Batched signal generation for many fiber directions and the gradient directions [firstDir, lastDir).
+      *
+      * fiberDirections contains numFibers contiguous (x,y,z) triples. signal has to hold numFibers*(lastDir-firstDir)
+      * values and is filled fiber by fiber. The default implementation sets each fiber direction and calls
+      * SimulateMeasurement(dir), so models drawing random numbers keep their order. Deterministic models override it
+      * with loops over contiguous arrays.
+      **/
+    virtual void SimulateMeasurement(const double* fiberDirections, unsigned int numFibers, unsigned int firstDir, unsigned int lastDir, ScalarType* signal)
+    {
+        unsigned int numDirs = lastDir-firstDir;
+        for (unsigned int f=0; f<numFibers; f++)
+        {
+            GradientType fiberDirection;
+            fiberDirection[0] = fiberDirections[3*f]; fiberDirection[1] = fiberDirections[3*f+1]; fiberDirection[2] = fiberDirections[3*f+2];
+            SetFiberDirection(fiberDirection);
+            for (unsigned int d=firstDir; d<lastDir; d++)
+                signal[f*numDirs + d-firstDir] = SimulateMeasurement(d);
+        }
+    }
+
     virtual void SetFiberDirection(GradientType fiberDirection) = 0;
     GradientType GetFiberDirection(){ return m_FiberDirection; }
 
@@ -45,3 +45,10 @@ typename DotModel< ScalarType >::PixelType DotModel< ScalarType >::SimulateMeasu
     signal.Fill(1);
     return signal;
 }
+
+template< class ScalarType >
+void DotModel< ScalarType >::SimulateMeasurement(const double* /*fiberDirections*/, unsigned int numFibers, unsigned int firstDir, unsigned int lastDir, ScalarType* signal)
+{
+    for (unsigned int i=0; i<numFibers*(lastDir-firstDir); i++)
+        signal[i] = 1;
+}
@@ -50,6 +50,7 @@ public:
     /** Actual signal generation **/
     PixelType SimulateMeasurement();
     ScalarType SimulateMeasurement(unsigned int dir);
+    void SimulateMeasurement(const double* fiberDirections, unsigned int numFibers, unsigned int firstDir, unsigned int lastDir, ScalarType* signal);   ///< batched version, see DiffusionSignalModel
 
     void SetFiberDirection(GradientType fiberDirection){ this->m_FiberDirection = fiberDirection; }
     void SetGradientList(GradientListType gradientList) { this->m_GradientList = gradientList; }
@@ -0,0 +1,78 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#ifndef _MITK_FastExp_H
+#define _MITK_FastExp_H
+
+#include <cmath>
+#include <cstring>
+#include <stdint.h>
+
+namespace mitk {
+
+/**
+  * \brief Computes y[i] = e^x[i] for a whole array.
+  *
+  * The main loop contains no branches and no library calls, so that the compiler can vectorize it. The argument is
+  * reduced to r = x - k*ln(2) with |r| <= ln(2)/2, e^r is evaluated by a polynomial of degree 12 and the result is
+  * scaled by 2^k by constructing the exponent bits directly. The relative error is below 1e-15. Arguments outside of
+  * [-708, 709] (and NaN) are recomputed with std::exp in a second pass. x and y must not overlap.
+  */
+inline void FastExp(const double* x, double* y, unsigned int n)
+{
+    const double log2e = 1.4426950408889634;
+    const double ln2Hi = 6.93147180369123816490e-01;
+    const double ln2Lo = 1.90821492927058770002e-10;
+    const double shifter = 6755399441055744.0;     // 1.5*2^52: adding it rounds to the nearest integer, which ends up in the low mantissa bits
+    uint64_t shifterBits; std::memcpy(&shifterBits, &shifter, sizeof(double));
+
+    for (unsigned int i=0; i<n; i++)
+    {
+        double v = x[i];
+        double kd = v*log2e + shifter;
+        uint64_t kBits; std::memcpy(&kBits, &kd, sizeof(double));
+        kd -= shifter;
+        double r = (v - kd*ln2Hi) - kd*ln2Lo;
+
+        double p = 1.0/479001600.0;
+        p = p*r + 1.0/39916800.0;
+        p = p*r + 1.0/3628800.0;
+        p = p*r + 1.0/362880.0;
+        p = p*r + 1.0/40320.0;
+        p = p*r + 1.0/5040.0;
+        p = p*r + 1.0/720.0;
+        p = p*r + 1.0/120.0;
+        p = p*r + 1.0/24.0;
+        p = p*r + 1.0/6.0;
+        p = p*r + 0.5;
+        p = p*r + 1.0;
+        p = p*r + 1.0;
+
+        // 2^k, k = kBits - shifterBits (k in [-1022, 1023])
+        uint64_t scaleBits = (kBits - shifterBits + 1023) << 52;
+        double scale; std::memcpy(&scale, &scaleBits, sizeof(double));
+
+        y[i] = p*scale;
+    }
+
+    for (unsigned int i=0; i<n; i++)
+        if (!(x[i]>=-708.0 && x[i]<=709.0))
+            y[i] = std::exp(x[i]);
+}
+
+}
+
+#endif
@@ -80,3 +80,48 @@ typename StickModel< ScalarType >::PixelType StickModel< ScalarType >::SimulateM
 
     return signal;
 }
+
+template< class ScalarType >
+void StickModel< ScalarType >::SimulateMeasurement(const double* fiberDirections, unsigned int numFibers, unsigned int firstDir, unsigned int lastDir, ScalarType* signal)
+{
+    unsigned int numDirs = lastDir-firstDir;
+    if (numFibers==0 || numDirs==0)
+        return;
+
+    std::vector< double > g(3*numDirs, 0);
+    std::vector< double > bVal(numDirs, 0);
+    for (unsigned int d=firstDir; d<lastDir && d<this->m_GradientList.size(); d++)
+    {
+        GradientType grad = this->m_GradientList[d];
+        ScalarType b = grad.GetNorm(); b *= b;
+        g[3*(d-firstDir)] = grad[0]; g[3*(d-firstDir)+1] = grad[1]; g[3*(d-firstDir)+2] = grad[2];
+        bVal[d-firstDir] = b;
+    }
+
+    std::vector< double > arguments(numFibers*numDirs);
+    std::vector< double > values(numFibers*numDirs);
+    for (unsigned int f=0; f<numFibers; f++)
+    {
+        GradientType fiberDirection;
+        fiberDirection[0] = fiberDirections[3*f]; fiberDirection[1] = fiberDirections[3*f+1]; fiberDirection[2] = fiberDirections[3*f+2];
+        fiberDirection.Normalize();
+        double* args = &arguments[f*numDirs];
+        for (unsigned int d=0; d<numDirs; d++)
+        {
+            ScalarType dot = fiberDirection[0]*g[3*d] + fiberDirection[1]*g[3*d+1] + fiberDirection[2]*g[3*d+2];
+            args[d] = -m_BValue * bVal[d] * m_Diffusivity*dot*dot;
+        }
+    }
+    FastExp(&arguments[0], &values[0], arguments.size());
+
+    for (unsigned int f=0; f<numFibers; f++)
+        for (unsigned int d=0; d<numDirs; d++)
+        {
+            if (d+firstDir>=this->m_GradientList.size())
+                signal[f*numDirs+d] = 0;
+            else if (bVal[d]>0.0001)
+                signal[f*numDirs+d] = values[f*numDirs+d];
+            else
+                signal[f*numDirs+d] = 1;
+        }
+}
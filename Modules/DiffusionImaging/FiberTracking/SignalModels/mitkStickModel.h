@@ -18,6 +18,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 #define _MITK_StickModel_H
 
 #include <mitkDiffusionSignalModel.h>
+#include <mitkFastExp.h>
 
 namespace mitk {
 
@@ -53,6 +54,7 @@ public:
     /** Actual signal generation **/
     PixelType SimulateMeasurement();
     ScalarType SimulateMeasurement(unsigned int dir);
+    void SimulateMeasurement(const double* fiberDirections, unsigned int numFibers, unsigned int firstDir, unsigned int lastDir, ScalarType* signal);   ///< batched version, see DiffusionSignalModel
 
     void SetBvalue(double bValue) { m_BValue = bValue; }                     ///< b-value used to generate the artificial signal
     double GetBvalue() { return m_BValue; }
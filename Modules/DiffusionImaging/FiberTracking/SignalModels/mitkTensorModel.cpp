@@ -36,6 +36,20 @@ TensorModel< ScalarType >::~TensorModel()
 
 }
 
+template< class ScalarType >
+typename TensorModel< ScalarType >::ItkTensorType TensorModel< ScalarType >::GetRotatedTensor(const GradientType& fiberDirection)
+{
+    ItkTensorType tensor; tensor.Fill(0.0);
+    vnl_vector_fixed<double, 3> axis = itk::CrossProduct(m_KernelDirection, fiberDirection).GetVnlVector(); axis.normalize();
+    vnl_quaternion<double> rotation(axis, acos(m_KernelDirection*fiberDirection));
+    rotation.normalize();
+    vnl_matrix_fixed<double, 3, 3> matrix = rotation.rotation_matrix_transpose();
+    vnl_matrix_fixed<double, 3, 3> tensorMatrix = matrix.transpose()*m_KernelTensorMatrix*matrix;
+    tensor[0] = tensorMatrix[0][0]; tensor[1] = tensorMatrix[0][1]; tensor[2] = tensorMatrix[0][2];
+    tensor[3] = tensorMatrix[1][1]; tensor[4] = tensorMatrix[1][2]; tensor[5] = tensorMatrix[2][2];
+    return tensor;
+}
+
 template< class ScalarType >
 ScalarType TensorModel< ScalarType >::SimulateMeasurement(unsigned int dir)
 {
@@ -44,16 +58,8 @@ ScalarType TensorModel< ScalarType >::SimulateMeasurement(unsigned int dir)
     if (dir>=this->m_GradientList.size())
         return signal;
 
-    ItkTensorType tensor; tensor.Fill(0.0);
     this->m_FiberDirection.Normalize();
-    vnl_vector_fixed<double, 3> axis = itk::CrossProduct(m_KernelDirection, this->m_FiberDirection).GetVnlVector(); axis.normalize();
-    vnl_quaternion<double> rotation(axis, acos(m_KernelDirection*this->m_FiberDirection));
-    rotation.normalize();
-    vnl_matrix_fixed<double, 3, 3> matrix = rotation.rotation_matrix_transpose();
-
-    vnl_matrix_fixed<double, 3, 3> tensorMatrix = matrix.transpose()*m_KernelTensorMatrix*matrix;
-    tensor[0] = tensorMatrix[0][0]; tensor[1] = tensorMatrix[0][1]; tensor[2] = tensorMatrix[0][2];
-    tensor[3] = tensorMatrix[1][1]; tensor[4] = tensorMatrix[1][2]; tensor[5] = tensorMatrix[2][2];
+    ItkTensorType tensor = GetRotatedTensor(this->m_FiberDirection);
 
     GradientType g = this->m_GradientList[dir];
     ScalarType bVal = g.GetNorm(); bVal *= bVal;
@@ -87,16 +93,8 @@ typename TensorModel< ScalarType >::PixelType TensorModel< ScalarType >::Simulat
 {
     PixelType signal; signal.SetSize(this->m_GradientList.size()); signal.Fill(0.0);
 
-    ItkTensorType tensor; tensor.Fill(0.0);
     this->m_FiberDirection.Normalize();
-    vnl_vector_fixed<double, 3> axis = itk::CrossProduct(m_KernelDirection, this->m_FiberDirection).GetVnlVector(); axis.normalize();
-    vnl_quaternion<double> rotation(axis, acos(m_KernelDirection*this->m_FiberDirection));
-    rotation.normalize();
-    vnl_matrix_fixed<double, 3, 3> matrix = rotation.rotation_matrix_transpose();
-
-    vnl_matrix_fixed<double, 3, 3> tensorMatrix = matrix.transpose()*m_KernelTensorMatrix*matrix;
-    tensor[0] = tensorMatrix[0][0]; tensor[1] = tensorMatrix[0][1]; tensor[2] = tensorMatrix[0][2];
-    tensor[3] = tensorMatrix[1][1]; tensor[4] = tensorMatrix[1][2]; tensor[5] = tensorMatrix[2][2];
+    ItkTensorType tensor = GetRotatedTensor(this->m_FiberDirection);
 
     for( unsigned int i=0; i<this->m_GradientList.size(); i++)
     {
@@ -127,3 +125,60 @@ typename TensorModel< ScalarType >::PixelType TensorModel< ScalarType >::Simulat
 
     return signal;
 }
+
+template< class ScalarType >
+void TensorModel< ScalarType >::SimulateMeasurement(const double* fiberDirections, unsigned int numFibers, unsigned int firstDir, unsigned int lastDir, ScalarType* signal)
+{
+    unsigned int numDirs = lastDir-firstDir;
+    if (numFibers==0 || numDirs==0)
+        return;
+
+    // gradient outer products, S = (gx*gx, gy*gx, gz*gx, gy*gy, gz*gy, gz*gz)
+    std::vector< double > S(6*numDirs, 0);
+    std::vector< double > bVal(numDirs, 0);
+    for (unsigned int d=firstDir; d<lastDir && d<this->m_GradientList.size(); d++)
+    {
+        GradientType g = this->m_GradientList[d];
+        ScalarType b = g.GetNorm(); b *= b;
+        bVal[d-firstDir] = b;
+        double* s = &S[6*(d-firstDir)];
+        s[0] = g[0]*g[0]; s[1] = g[1]*g[0]; s[2] = g[2]*g[0];
+        s[3] = g[1]*g[1]; s[4] = g[2]*g[1]; s[5] = g[2]*g[2];
+    }
+
+    std::vector< double > D(numFibers*numDirs);
+    std::vector< double > arguments(numFibers*numDirs);
+    std::vector< double > values(numFibers*numDirs);
+    for (unsigned int f=0; f<numFibers; f++)
+    {
+        // the rotated tensor is computed once per fiber instead of once per gradient direction
+        GradientType fiberDirection;
+        fiberDirection[0] = fiberDirections[3*f]; fiberDirection[1] = fiberDirections[3*f+1]; fiberDirection[2] = fiberDirections[3*f+2];
+        fiberDirection.Normalize();
+        ItkTensorType tensor = GetRotatedTensor(fiberDirection);
+
+        for (unsigned int d=0; d<numDirs; d++)
+        {
+            const double* s = &S[6*d];
+            ScalarType value = tensor[0]*s[0] + tensor[1]*s[1] + tensor[2]*s[2] +
+                               tensor[1]*s[1] + tensor[3]*s[3] + tensor[4]*s[4] +
+                               tensor[2]*s[2] + tensor[4]*s[4] + tensor[5]*s[5];
+            D[f*numDirs+d] = value;
+            arguments[f*numDirs+d] = -m_BValue * bVal[d] * value;
+        }
+    }
+    FastExp(&arguments[0], &values[0], arguments.size());
+
+    for (unsigned int f=0; f<numFibers; f++)
+        for (unsigned int d=0; d<numDirs; d++)
+        {
+            if (d+firstDir>=this->m_GradientList.size())
+                signal[f*numDirs+d] = 0;
+            else if (bVal[d]<=0.0001)
+                signal[f*numDirs+d] = 1;
+            else if (D[f*numDirs+d]>=0)   // check for corrupted tensor
+                signal[f*numDirs+d] = values[f*numDirs+d];
+            else
+                signal[f*numDirs+d] = 0;
+        }
+}
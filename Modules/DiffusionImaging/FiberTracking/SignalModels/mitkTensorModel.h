@@ -18,6 +18,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 #define _MITK_TensorModel_H
 
 #include <mitkDiffusionSignalModel.h>
+#include <mitkFastExp.h>
 #include <itkDiffusionTensor3D.h>
 
 namespace mitk {
@@ -56,6 +57,7 @@ public:
     /** Actual signal generation **/
     PixelType SimulateMeasurement();
     ScalarType SimulateMeasurement(unsigned int dir);
+    void SimulateMeasurement(const double* fiberDirections, unsigned int numFibers, unsigned int firstDir, unsigned int lastDir, ScalarType* signal);   ///< batched version, see DiffusionSignalModel
 
     void SetBvalue(double bValue) { m_BValue = bValue; }                     ///< b-value used to generate the artificial signal
     double GetBvalue() { return m_BValue; }
@@ -75,6 +77,9 @@ protected:
 
     /** Calculates tensor matrix from FA and ADC **/
     void UpdateKernelTensor();
+
+    /** Kernel tensor rotated so that its principal eigenvector points along the (normalized) fiber direction **/
+    ItkTensorType GetRotatedTensor(const GradientType& fiberDirection);
     GradientType                        m_KernelDirection;      ///< Direction of the kernel tensors principal eigenvector
     vnl_matrix_fixed<double, 3, 3>      m_KernelTensorMatrix;   ///< 3x3 matrix containing the kernel tensor values
     double                              m_BValue;               ///< b-value used to generate the artificial signal
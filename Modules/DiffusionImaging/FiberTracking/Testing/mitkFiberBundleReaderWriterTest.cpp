@@ -20,6 +20,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <itksys/SystemTools.hxx>
 #include <mitkTestingConfig.h>
 #include <mitkIOUtil.h>
+#include <mitkTrackvis.h>
 
 #include "mitkTestFixture.h"
 
@@ -28,6 +29,10 @@ class mitkFiberBundleReaderWriterTestSuite : public mitk::TestFixture
 
   CPPUNIT_TEST_SUITE(mitkFiberBundleReaderWriterTestSuite);
   MITK_TEST(Equal_SaveLoad_ReturnsTrue);
+  MITK_TEST(Equal_SaveLoadTrk_ReturnsTrue);
+  MITK_TEST(Equal_TrkChunks_ReturnsTrue);
+  MITK_TEST(Equal_SaveLoadTrkRas_ReturnsTrue);
+  MITK_TEST(Equal_SaveLoadCfib_ReturnsTrue);
   CPPUNIT_TEST_SUITE_END();
 
 private:
@@ -66,6 +71,105 @@ public:
     //MITK_ASSERT_EQUAL(fib1, fib2, "A saved and re-loaded file should be equal");
   }
 
+  void Equal_SaveLoadTrk_ReturnsTrue()
+  {
+    mitk::IOUtil::Save(fib1.GetPointer(), std::string(MITK_TEST_OUTPUT_DIR)+"/writerTest.trk");
+    std::vector<mitk::BaseData::Pointer> baseData = mitk::IOUtil::Load(std::string(MITK_TEST_OUTPUT_DIR)+"/writerTest.trk");
+    fib2 = dynamic_cast<mitk::FiberBundle*>(baseData[0].GetPointer());
+    CPPUNIT_ASSERT_MESSAGE("Should be equal", fib1->Equals(fib2));
+  }
+
+  void Equal_TrkChunks_ReturnsTrue()
+  {
+    std::string filename = std::string(MITK_TEST_OUTPUT_DIR)+"/chunkTest.trk";
+    TrackVisStreamWriter writer(1024);
+    CPPUNIT_ASSERT_MESSAGE("Should create file", writer.Create(filename, fib1.GetPointer()));
+    writer.AddFibers(fib1->GetFiberPolyData());
+    CPPUNIT_ASSERT_MESSAGE("Should close file", writer.Close());
+
+    TrackVisStreamReader reader;
+    CPPUNIT_ASSERT_MESSAGE("Should open file", reader.Open(filename));
+    CPPUNIT_ASSERT_EQUAL(fib1->GetNumFibers(), reader.GetNumFibers());
+    CPPUNIT_ASSERT_EQUAL(fib1->GetNumFibers(), reader.GetHeader().n_count);
+
+    // iterate the fibers in chunks and compare them with the original fibers
+    int fiber = 0;
+    bool equal = true;
+    for (TrackVisStreamReader::ChunkIterator it = reader.GetChunkIterator(7); !it.IsAtEnd(); ++it)
+    {
+      const TrackVisStreamReader::Chunk& chunk = it.Get();
+      CPPUNIT_ASSERT_EQUAL(fiber, chunk.firstFiber);
+      int point = 0;
+      for (unsigned int f=0; f<chunk.numPoints.size(); f++, fiber++)
+      {
+        vtkCell* cell = fib1->GetFiberPolyData()->GetCell(fiber);
+        equal &= cell->GetNumberOfPoints()==chunk.numPoints.at(f);
+        for (int i=0; i<chunk.numPoints.at(f) && equal; i++, point++)
+        {
+          double* p = cell->GetPoints()->GetPoint(i);
+          for (int d=0; d<3; d++)
+            equal &= fabs(p[d]-chunk.points.at(3*point+d))<0.001;
+        }
+      }
+    }
+    CPPUNIT_ASSERT_EQUAL(fib1->GetNumFibers(), fiber);
+    CPPUNIT_ASSERT_MESSAGE("Chunks should be equal to the original fibers", equal);
+  }
+
+  void Equal_SaveLoadTrkRas_ReturnsTrue()
+  {
+    // store the coordinates of fib1 in a file with RAS voxel order
+    std::string filename = std::string(MITK_TEST_OUTPUT_DIR)+"/rasTest.trk";
+    TrackVis_header header;
+    TrackVisStreamWriter::InitHeader(header, fib1.GetPointer());
+    sprintf(header.voxel_order,"RAS");
+    TrackVisStreamWriter writer;
+    CPPUNIT_ASSERT_MESSAGE("Should create file", writer.Create(filename, header));
+    writer.AddFibers(fib1->GetFiberPolyData());
+    CPPUNIT_ASSERT_MESSAGE("Should close file", writer.Close());
+
+    std::vector<mitk::BaseData::Pointer> baseData = mitk::IOUtil::Load(filename);
+    fib2 = dynamic_cast<mitk::FiberBundle*>(baseData[0].GetPointer());
+    CPPUNIT_ASSERT_EQUAL(fib1->GetNumFibers(), fib2->GetNumFibers());
+
+    // x and y are flipped to LPS
+    bool equal = true;
+    for (int f=0; f<fib1->GetNumFibers() && equal; f++)
+    {
+      vtkCell* cell1 = fib1->GetFiberPolyData()->GetCell(f);
+      vtkCell* cell2 = fib2->GetFiberPolyData()->GetCell(f);
+      equal &= cell1->GetNumberOfPoints()==cell2->GetNumberOfPoints();
+      for (int i=0; i<cell1->GetNumberOfPoints() && equal; i++)
+      {
+        double* p1 = cell1->GetPoints()->GetPoint(i);
+        double* p2 = cell2->GetPoints()->GetPoint(i);
+        equal &= fabs(p1[0]+p2[0])<0.001 && fabs(p1[1]+p2[1])<0.001 && fabs(p1[2]-p2[2])<0.001;
+      }
+    }
+    CPPUNIT_ASSERT_MESSAGE("Points should be flipped to LPS", equal);
+
+    mitk::AffineTransform3D::MatrixType matrix = fib2->GetReferenceGeometry()->GetIndexToWorldTransform()->GetMatrix();
+    CPPUNIT_ASSERT_MESSAGE("Reference geometry should be flipped in x", matrix[0][0]<0);
+    CPPUNIT_ASSERT_MESSAGE("Reference geometry should be flipped in y", matrix[1][1]<0);
+    CPPUNIT_ASSERT_MESSAGE("Reference geometry should not be flipped in z", matrix[2][2]>0);
+
+    // the writer stores LPS coordinates
+    mitk::IOUtil::Save(fib2.GetPointer(), std::string(MITK_TEST_OUTPUT_DIR)+"/rasTest2.trk");
+    baseData = mitk::IOUtil::Load(std::string(MITK_TEST_OUTPUT_DIR)+"/rasTest2.trk");
+    mitk::FiberBundle::Pointer fib3 = dynamic_cast<mitk::FiberBundle*>(baseData[0].GetPointer());
+    CPPUNIT_ASSERT_MESSAGE("Should be equal", fib2->Equals(fib3));
+  }
+
+  void Equal_SaveLoadCfib_ReturnsTrue()
+  {
+    mitk::IOUtil::Save(fib1.GetPointer(), std::string(MITK_TEST_OUTPUT_DIR)+"/writerTest.cfib");
+    std::vector<mitk::BaseData::Pointer> baseData = mitk::IOUtil::Load(std::string(MITK_TEST_OUTPUT_DIR)+"/writerTest.cfib");
+    fib2 = dynamic_cast<mitk::FiberBundle*>(baseData[0].GetPointer());
+    // the coordinates are quantized to 16 bit within the bounding box
+    CPPUNIT_ASSERT_MESSAGE("Should be equal", fib1->Equals(fib2, 0.01));
+    CPPUNIT_ASSERT_MESSAGE("Weights should be equal", fabs(fib1->GetFiberWeight(0)-fib2->GetFiberWeight(0))<0.0001);
+  }
+
 };
 
 MITK_TEST_SUITE_REGISTRATION(mitkFiberBundleReaderWriter)
@@ -0,0 +1,180 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include <mitkTestingMacros.h>
+#include <mitkFiberBundle.h>
+#include <itkTractsToDWIImageFilter.h>
+#include <mitkFiberfoxParameters.h>
+#include <mitkStickModel.h>
+#include <mitkTensorModel.h>
+#include <mitkBallModel.h>
+#include <itkImageRegionConstIterator.h>
+#include <vtkPolyData.h>
+#include <vtkPoints.h>
+#include <vtkCellArray.h>
+#include <vtkPolyLine.h>
+#include <vtkSmartPointer.h>
+#include <cmath>
+
+typedef itk::VectorImage< short, 3 > ItkDwiType;
+
+/**
+ * Signal model that evaluates the batched SimulateMeasurement() fiber by fiber with the default
+ * implementation of DiffusionSignalModel, i.e. like the filter did before batching.
+ */
+template< class ModelType >
+class PerVoxelModel : public ModelType
+{
+public:
+    using ModelType::SimulateMeasurement;
+
+    void SimulateMeasurement(const double* fiberDirections, unsigned int numFibers, unsigned int firstDir, unsigned int lastDir, double* signal)
+    {
+        mitk::DiffusionSignalModel< double >::SimulateMeasurement(fiberDirections, numFibers, firstDir, lastDir, signal);
+    }
+};
+
+/** Curved, partly crossing fibers in the default 12x12x3 image of the Fiberfox parameters. */
+mitk::FiberBundle::Pointer CreatePhantom()
+{
+    vtkSmartPointer<vtkPoints> points = vtkSmartPointer<vtkPoints>::New();
+    vtkSmartPointer<vtkCellArray> cells = vtkSmartPointer<vtkCellArray>::New();
+    for (int f=0; f<10; f++)
+    {
+        vtkSmartPointer<vtkPolyLine> line = vtkSmartPointer<vtkPolyLine>::New();
+        for (int i=0; i<40; i++)
+        {
+            double t = 0.5 + i*23.0/39;
+            double p[3];
+            if (f%2==0)
+            {
+                p[0] = t; p[1] = 3 + f*2 + 2*sin(t/4); p[2] = 1 + 0.4*f;
+            }
+            else
+            {
+                p[0] = 3 + f*2 + 2*cos(t/4); p[1] = t; p[2] = 5 - 0.4*f;
+            }
+            line->GetPointIds()->InsertNextId(points->InsertNextPoint(p));
+        }
+        cells->InsertNextCell(line);
+    }
+    vtkSmartPointer<vtkPolyData> polyData = vtkSmartPointer<vtkPolyData>::New();
+    polyData->SetPoints(points);
+    polyData->SetLines(cells);
+    return mitk::FiberBundle::New(polyData);
+}
+
+ItkDwiType::Pointer Simulate(mitk::FiberfoxParameters<double> parameters, mitk::FiberBundle::Pointer fiberBundle)
+{
+    itk::TractsToDWIImageFilter< short >::Pointer tractsToDwiFilter = itk::TractsToDWIImageFilter< short >::New();
+    tractsToDwiFilter->SetUseConstantRandSeed(true);
+    tractsToDwiFilter->SetParameters(parameters);
+    tractsToDwiFilter->SetFiberBundle(fiberBundle);
+    tractsToDwiFilter->Update();
+    return tractsToDwiFilter->GetOutput();
+}
+
+/** The batched models use a polynomial exp, so the rounded signal may differ by one. */
+bool CompareDwi(ItkDwiType* dwi1, ItkDwiType* dwi2)
+{
+    if (dwi1->GetLargestPossibleRegion()!=dwi2->GetLargestPossibleRegion() || dwi1->GetVectorLength()!=dwi2->GetVectorLength())
+        return false;
+
+    bool nonZero = false;
+    itk::ImageRegionConstIterator< ItkDwiType > it1(dwi1, dwi1->GetLargestPossibleRegion());
+    itk::ImageRegionConstIterator< ItkDwiType > it2(dwi2, dwi2->GetLargestPossibleRegion());
+    for (; !it1.IsAtEnd(); ++it1, ++it2)
+        for (unsigned int g=0; g<dwi1->GetVectorLength(); g++)
+        {
+            if (std::abs(it1.Get()[g]-it2.Get()[g])>1)
+            {
+                MITK_INFO << "Signal differs at " << it1.GetIndex() << ", volume " << g << ": " << it1.Get()[g] << " vs. " << it2.Get()[g];
+                return false;
+            }
+            nonZero = nonZero || it1.Get()[g]!=0;
+        }
+    return nonZero;
+}
+
+/**Documentation
+ * Test that the batched signal generation of Fiberfox gives the same image as the per voxel evaluation of the signal models
+ */
+int mitkFiberfoxBatchedSignalTest(int, char* [])
+{
+    MITK_TEST_BEGIN("mitkFiberfoxBatchedSignalTest");
+
+    mitk::FiberBundle::Pointer fiberBundle = CreatePhantom();
+
+    mitk::FiberfoxParameters<double> parameters;
+    parameters.m_SignalGen.m_SignalScale = 1000;
+    parameters.m_SignalGen.SetNumWeightedVolumes(30);
+
+    mitk::StickModel<double> stickModel;
+    PerVoxelModel< mitk::StickModel<double> > perVoxelStickModel;
+    mitk::TensorModel<double> tensorModel;
+    PerVoxelModel< mitk::TensorModel<double> > perVoxelTensorModel;
+    mitk::StickModel<double>* stickModels[2] = { &stickModel, &perVoxelStickModel };
+    mitk::TensorModel<double>* tensorModels[2] = { &tensorModel, &perVoxelTensorModel };
+    for (int i=0; i<2; i++)
+    {
+        stickModels[i]->SetBvalue(parameters.m_SignalGen.m_Bvalue);
+        stickModels[i]->SetT2(110);
+        stickModels[i]->SetDiffusivity(0.001);
+        stickModels[i]->SetGradientList(parameters.m_SignalGen.GetGradientDirections());
+
+        tensorModels[i]->SetBvalue(parameters.m_SignalGen.m_Bvalue);
+        tensorModels[i]->SetT2(110);
+        tensorModels[i]->SetDiffusivity1(0.001);
+        tensorModels[i]->SetDiffusivity2(0.00025);
+        tensorModels[i]->SetDiffusivity3(0.00025);
+        tensorModels[i]->SetGradientList(parameters.m_SignalGen.GetGradientDirections());
+    }
+
+    mitk::BallModel<double> ballModel;
+    ballModel.SetT2(80);
+    ballModel.SetBvalue(parameters.m_SignalGen.m_Bvalue);
+    ballModel.SetDiffusivity(0.001);
+    ballModel.SetGradientList(parameters.m_SignalGen.GetGradientDirections());
+    parameters.m_NonFiberModelList.push_back(&ballModel);
+
+    try{
+        // Stick-Ball
+        parameters.m_FiberModelList.clear();
+        parameters.m_FiberModelList.push_back(&stickModel);
+        ItkDwiType::Pointer batched = Simulate(parameters, fiberBundle);
+        parameters.m_FiberModelList.clear();
+        parameters.m_FiberModelList.push_back(&perVoxelStickModel);
+        ItkDwiType::Pointer perVoxel = Simulate(parameters, fiberBundle);
+        MITK_TEST_CONDITION_REQUIRED(CompareDwi(batched, perVoxel), "check batched stick-ball signal");
+
+        // Stick-Tensor-Ball
+        parameters.m_FiberModelList.clear();
+        parameters.m_FiberModelList.push_back(&stickModel);
+        parameters.m_FiberModelList.push_back(&tensorModel);
+        batched = Simulate(parameters, fiberBundle);
+        parameters.m_FiberModelList.clear();
+        parameters.m_FiberModelList.push_back(&perVoxelStickModel);
+        parameters.m_FiberModelList.push_back(&perVoxelTensorModel);
+        perVoxel = Simulate(parameters, fiberBundle);
+        MITK_TEST_CONDITION_REQUIRED(CompareDwi(batched, perVoxel), "check batched stick-tensor-ball signal");
+    }
+    catch (std::exception &e)
+    {
+        MITK_TEST_CONDITION_REQUIRED(false, e.what());
+    }
+
+    MITK_TEST_END();
+}
@@ -20,9 +20,71 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <itkGibbsTrackingFilter.h>
 #include <mitkFiberBundle.h>
 #include <mitkIOUtil.h>
+#include <itkTimeProbe.h>
+#include <vtkCell.h>
+#include <vtkPolyData.h>
+#include <algorithm>
+#include <cmath>
 
 using namespace mitk;
 
+typedef std::vector< std::vector< double > > FiberPoints;
+
+/**
+ * Fibers of the bundle as point lists, each oriented from its lexicographically
+ * smaller end point and sorted. The parallel sampler gives particles born
+ * concurrently their IDs in the order of the births, so the order and the
+ * direction in which the fibers are built may depend on the thread scheduling.
+ */
+static std::vector< FiberPoints > GetSortedFibers(mitk::FiberBundle* fib)
+{
+    std::vector< FiberPoints > fibers;
+    vtkSmartPointer<vtkPolyData> polyData = fib->GetFiberPolyData();
+    for (int i=0; i<fib->GetNumFibers(); i++)
+    {
+        vtkCell* cell = polyData->GetCell(i);
+        FiberPoints fiber;
+        for (int j=0; j<cell->GetNumberOfPoints(); j++)
+        {
+            double* p = cell->GetPoints()->GetPoint(j);
+            fiber.push_back(std::vector< double >(p, p+3));
+        }
+        if (!fiber.empty() && fiber.back() < fiber.front())
+            std::reverse(fiber.begin(), fiber.end());
+        fibers.push_back(fiber);
+    }
+    std::sort(fibers.begin(), fibers.end());
+    return fibers;
+}
+
+/** Compares the fiber geometry of two bundles regardless of the fiber order and direction. */
+static bool EqualFiberGeometry(mitk::FiberBundle* fib1, mitk::FiberBundle* fib2, double eps=0.0001)
+{
+    std::vector< FiberPoints > fibers1 = GetSortedFibers(fib1);
+    std::vector< FiberPoints > fibers2 = GetSortedFibers(fib2);
+    if (fibers1.size()!=fibers2.size())
+    {
+        MITK_INFO << "Unequal number of fibers: " << fibers1.size() << " vs. " << fibers2.size();
+        return false;
+    }
+    for (unsigned int i=0; i<fibers1.size(); i++)
+    {
+        if (fibers1[i].size()!=fibers2[i].size())
+        {
+            MITK_INFO << "Unequal number of points in fiber " << i << ": " << fibers1[i].size() << " vs. " << fibers2[i].size();
+            return false;
+        }
+        for (unsigned int j=0; j<fibers1[i].size(); j++)
+            for (int k=0; k<3; k++)
+                if (fabs(fibers1[i][j][k]-fibers2[i][j][k])>eps)
+                {
+                    MITK_INFO << "Unequal points in fiber " << i << " at position " << j;
+                    return false;
+                }
+    }
+    return true;
+}
+
 /**Documentation
  *  Test for gibbs tracking filter
  */
@@ -72,11 +134,32 @@ int mitkGibbsTrackingTest(int argc, char* argv[])
     gibbsTracker->SetDuplicateImage(false);
     gibbsTracker->SetRandomSeed(1);
     gibbsTracker->SetLoadParameterFile(argv[3]);
+    itk::TimeProbe serialClock;
+    serialClock.Start();
     gibbsTracker->Update();
+    serialClock.Stop();
 
     mitk::FiberBundle::Pointer fib2 = mitk::FiberBundle::New(gibbsTracker->GetFiberBundle());
     MITK_TEST_CONDITION_REQUIRED(fib1->Equals(fib2), "check if gibbs tracking has changed");
 
+    // parallel sampler: the sampled configuration must not depend on the number of threads
+    gibbsTracker->SetSamplerThreads(4);
+    itk::TimeProbe parallelClock;
+    parallelClock.Start();
+    gibbsTracker->Update();
+    parallelClock.Stop();
+    mitk::FiberBundle::Pointer fib3 = mitk::FiberBundle::New(gibbsTracker->GetFiberBundle());
+    MITK_TEST_CONDITION_REQUIRED(fib3->GetNumFibers()>0, "check if parallel gibbs tracking produces fibers");
+
+    gibbsTracker->SetSamplerThreads(2);
+    gibbsTracker->Update();
+    mitk::FiberBundle::Pointer fib4 = mitk::FiberBundle::New(gibbsTracker->GetFiberBundle());
+    MITK_TEST_CONDITION_REQUIRED(EqualFiberGeometry(fib3, fib4), "check if parallel gibbs tracking is independent of the number of threads");
+
+    MITK_INFO << "Serial sampler: " << serialClock.GetTotal() << "s, parallel sampler (4 threads): " << parallelClock.GetTotal() << "s, speedup: " << serialClock.GetTotal()/parallelClock.GetTotal();
+
+    gibbsTracker->SetSamplerThreads(1);
+
     gibbsTracker->SetRandomSeed(0);
     gibbsTracker->Update();
     fib2 = mitk::FiberBundle::New(gibbsTracker->GetFiberBundle());
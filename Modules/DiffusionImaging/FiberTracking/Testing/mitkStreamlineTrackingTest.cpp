@@ -106,6 +106,34 @@ int mitkStreamlineTrackingTest(int argc, char* argv[])
             MITK_INFO << "OUTPUT: " << mitk::IOUtil::GetTempPath();
         }
         MITK_TEST_CONDITION_REQUIRED(ok, "Check if tractograms are equal.");
+
+        // random seed positions have to be independent of the number of threads if deterministic seeding is enabled
+        std::vector< mitk::FiberBundle::Pointer > threadResults;
+        for (int numThreads=1; numThreads<=4; numThreads+=3)
+        {
+            FilterType::Pointer threadFilter = FilterType::New();
+            threadFilter->SetInput(itk_dti);
+            threadFilter->SetSeedsPerVoxel(3);
+            threadFilter->SetFaThreshold(minFA);
+            threadFilter->SetMinCurvatureRadius(minCurv);
+            threadFilter->SetStepSize(stepSize);
+            threadFilter->SetF(tendf);
+            threadFilter->SetG(tendg);
+            threadFilter->SetInterpolate(interpolate);
+            threadFilter->SetMinTractLength(minLength);
+            threadFilter->SetDeterministicSeeding(true);
+            threadFilter->SetRandomSeed(42);
+            threadFilter->SetSeedChunkSize(7);
+            threadFilter->SetNumberOfThreads(numThreads);
+            ItkUCharImageType::Pointer mask = ItkUCharImageType::New();
+            mitk::CastToItkImage(mitkMaskImage, mask);
+            threadFilter->SetSeedImage(mask);
+            threadFilter->SetMaskImage(mask);
+            threadFilter->Update();
+            threadResults.push_back(mitk::FiberBundle::New(threadFilter->GetFiberPolyData()));
+        }
+        MITK_TEST_CONDITION_REQUIRED(threadResults.at(0)->GetNumFibers()>0, "Check if deterministic seeding produces fibers.");
+        MITK_TEST_CONDITION_REQUIRED(threadResults.at(0)->Equals(threadResults.at(1)), "Check if tractograms of 1 and 4 threads are equal.");
     }
     catch (itk::ExceptionObject e)
     {
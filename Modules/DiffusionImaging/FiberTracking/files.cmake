@@ -13,10 +13,12 @@ set(CPP_FILES
   # Tractography
   Algorithms/GibbsTracking/mitkParticleGrid.cpp
   Algorithms/GibbsTracking/mitkMetropolisHastingsSampler.cpp
+  Algorithms/GibbsTracking/mitkParallelMetropolisHastingsSampler.cpp
   Algorithms/GibbsTracking/mitkEnergyComputer.cpp
   Algorithms/GibbsTracking/mitkGibbsEnergyComputer.cpp
   Algorithms/GibbsTracking/mitkFiberBuilder.cpp
   Algorithms/GibbsTracking/mitkSphereInterpolator.cpp
+  Algorithms/MLTracking/mitkFlatDecisionForest.cpp
 )
 
 set(H_FILES
@@ -49,16 +51,19 @@ set(H_FILES
   Algorithms/GibbsTracking/mitkParticle.h
   Algorithms/GibbsTracking/mitkParticleGrid.h
   Algorithms/GibbsTracking/mitkMetropolisHastingsSampler.h
+  Algorithms/GibbsTracking/mitkParallelMetropolisHastingsSampler.h
   Algorithms/GibbsTracking/mitkSimpSamp.h
   Algorithms/GibbsTracking/mitkEnergyComputer.h
   Algorithms/GibbsTracking/mitkGibbsEnergyComputer.h
   Algorithms/GibbsTracking/mitkSphereInterpolator.h
   Algorithms/GibbsTracking/mitkFiberBuilder.h
+  Algorithms/MLTracking/mitkFlatDecisionForest.h
   Algorithms/MLTracking/mitkTrackingForestHandler.h
   Algorithms/MLTracking/itkMLBSTrackingFilter.h
 
   # Signal Models
   SignalModels/mitkDiffusionSignalModel.h
+  SignalModels/mitkFastExp.h
   SignalModels/mitkTensorModel.h
   SignalModels/mitkBallModel.h
   SignalModels/mitkDotModel.h
@@ -27,6 +27,8 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <boost/algorithm/string.hpp>
 #include <itkFlipImageFilter.h>
 #include <mitkCoreObjectFactory.h>
+#include <itkTimeProbe.h>
+#include <algorithm>
 
 template<int shOrder>
 typename itk::ShCoefficientImageImporter< float, shOrder >::QballImageType::Pointer TemplatedConvertShCoeffs(mitk::Image* mitkImg, int toolkit, bool noFlip = false)
@@ -97,6 +99,8 @@ int main(int argc, char* argv[])
     parser.addArgument("shConvention", "s", mitkCommandLineParser::String, "SH coefficient:", "sh coefficient convention (FSL, MRtrix)", string("FSL"), true);
     parser.addArgument("outFile", "o", mitkCommandLineParser::OutputFile, "Output:", "output fiber bundle (.fib)", us::Any(), false);
     parser.addArgument("noFlip", "f", mitkCommandLineParser::Bool, "No flip:", "do not flip input image to match MITK coordinate convention");
+    parser.addArgument("threads", "t", mitkCommandLineParser::Int, "Threads:", "number of threads of the parallel sampler (default: 1, serial sampler)", us::Any());
+    parser.addArgument("domainSize", "d", mitkCommandLineParser::Int, "Domain size:", "edge length of the parallel sampling domains in particle grid cells (default: 3)", us::Any());
 
     map<string, us::Any> parsedArgs = parser.parseArguments(argc, argv);
     if (parsedArgs.size()==0)
@@ -110,6 +114,14 @@ int main(int argc, char* argv[])
     if (parsedArgs.count("noFlip"))
         noFlip = us::any_cast<bool>(parsedArgs["noFlip"]);
 
+    int threads = 1;
+    if (parsedArgs.count("threads"))
+        threads = us::any_cast<int>(parsedArgs["threads"]);
+
+    int domainSize = 3;
+    if (parsedArgs.count("domainSize"))
+        domainSize = us::any_cast<int>(parsedArgs["domainSize"]);
+
     try
     {
         // instantiate gibbs tracker
@@ -210,8 +222,14 @@ int main(int argc, char* argv[])
 
         gibbsTracker->SetDuplicateImage(false);
         gibbsTracker->SetLoadParameterFile( paramFileName );
+        gibbsTracker->SetSamplerThreads( std::max(threads, 1) );
+        gibbsTracker->SetSamplerDomainSize( domainSize );
 //        gibbsTracker->SetLutPath( "" );
+        itk::TimeProbe clock;
+        clock.Start();
         gibbsTracker->Update();
+        clock.Stop();
+        std::cout << "Tracking with " << threads << " sampler thread(s) took " << clock.GetTotal() << "s" << std::endl;
 
         mitk::FiberBundle::Pointer mitkFiberBundle = mitk::FiberBundle::New(gibbsTracker->GetFiberBundle());
         mitkFiberBundle->SetReferenceGeometry(mitkImage->GetGeometry());
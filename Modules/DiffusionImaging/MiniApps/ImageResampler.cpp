@@ -175,7 +175,7 @@ static void SaveImage(std::string fileName, mitk::Image* image, std::string file
   mitk::IOUtil::Save(image, fileName);
 }
 
-mitk::Image::Pointer ResampleDWIbySpacing(mitk::Image::Pointer input, float* spacing, bool useLinInt = true)
+mitk::Image::Pointer ResampleDWIbySpacing(mitk::Image::Pointer input, float* spacing, bool useLinInt = true, unsigned int numSlabs = 1)
 {
 
   itk::Vector<double, 3> spacingVector;
@@ -190,8 +190,12 @@ mitk::Image::Pointer ResampleDWIbySpacing(mitk::Image::Pointer input, float* spa
 
   ResampleFilterType::Pointer resampler = ResampleFilterType::New();
   resampler->SetInput( itkVectorImagePointer );
-  resampler->SetInterpolation(ResampleFilterType::Interpolate_Linear);
+  if (useLinInt)
+    resampler->SetInterpolation(ResampleFilterType::Interpolate_Linear);
+  else
+    resampler->SetInterpolation(ResampleFilterType::Interpolate_WindowedSinc);
   resampler->SetNewSpacing(spacingVector);
+  resampler->SetNumberOfStreamDivisions(numSlabs);
   resampler->Update();
 
   mitk::Image::Pointer output = mitk::GrabItkImageMemory( resampler->GetOutput() );
@@ -220,6 +224,7 @@ int main( int argc, char* argv[] )
   parser.addArgument("spacing", "s", mitkCommandLineParser::String, "Spacing:", "Resample provide x,y,z spacing in mm (e.g. -r 1,1,3), is not applied to tensor data",us::Any());
   parser.addArgument("reference", "r", mitkCommandLineParser::InputImage, "Reference:", "Resample using supplied reference image. Also cuts image to same dimensions",us::Any());
   parser.addArgument("win-sinc", "w", mitkCommandLineParser::Bool, "Windowed-sinc interpolation:", "Use windowed-sinc interpolation (3) instead of linear interpolation ",us::Any());
+  parser.addArgument("slabs", "l", mitkCommandLineParser::Int, "Slabs:", "Resample DWIs in this many slabs along z. Bounds the memory needed in addition to input and output to one slab of one channel.", 1);
 
 
   map<string, us::Any> parsedArgs = parser.parseArguments(argc, argv);
@@ -233,7 +238,7 @@ int main( int argc, char* argv[] )
       return EXIT_FAILURE;
     }
 
-    if (parsedArgs.count("sinc-int"))
+    if (parsedArgs.count("win-sinc"))
       useLinearInterpol = false;
 
     // Show a help message
@@ -256,13 +261,17 @@ int main( int argc, char* argv[] )
     if (arg != "")
     {
       spacings = split(arg ,',');
-      spacing[0] = atoi(spacings.at(0).c_str());
-      spacing[1] = atoi(spacings.at(1).c_str());
-      spacing[2] = atoi(spacings.at(2).c_str());
+      spacing[0] = atof(spacings.at(0).c_str());
+      spacing[1] = atof(spacings.at(1).c_str());
+      spacing[2] = atof(spacings.at(2).c_str());
       useSpacing = true;
     }
   }
 
+  unsigned int numSlabs = 1;
+  if (parsedArgs.count("slabs"))
+    numSlabs = us::any_cast<int>(parsedArgs["slabs"]);
+
   std::string refImageFile = "";
   if (parsedArgs.count("reference"))
   {
@@ -286,7 +295,10 @@ int main( int argc, char* argv[] )
     mitk::Image::Pointer outputImage;
 
     if (useSpacing)
-      outputImage = ResampleDWIbySpacing(inputDWI, spacing);
+    {
+      outputImage = ResampleDWIbySpacing(inputDWI, spacing, useLinearInterpol, numSlabs);
+      inputDWI = nullptr;   // not needed for writing
+    }
     else
     {
       MITK_WARN << "Not supported yet, to resample a DWI please set a new spacing.";
@@ -297,15 +309,13 @@ int main( int argc, char* argv[] )
 
     return EXIT_SUCCESS;
   }
-  mitk::Image::Pointer inputImage = mitk::IOUtil::LoadImage(inputFile);
-
 
   mitk::Image::Pointer resultImage;
 
   if (useSpacing)
-    resultImage = ResampleBySpacing(inputImage,spacing);
+    resultImage = ResampleBySpacing(inputDWI,spacing,useLinearInterpol);
   else
-    resultImage = TransformToReference(refImage,inputImage);
+    resultImage = TransformToReference(refImage,inputDWI);
 
 
   mitk::IOUtil::SaveImage(resultImage, outputFile);
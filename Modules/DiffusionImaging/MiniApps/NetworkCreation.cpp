@@ -24,6 +24,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "mitkConnectomicsNetworkCreator.h"
 #include <mitkCoreObjectFactory.h>
 #include <mitkIOUtil.h>
+#include <itkTimeProbe.h>
 
 int main(int argc, char* argv[])
 {
@@ -41,6 +42,7 @@ int main(int argc, char* argv[])
 
   parser.addArgument("radius", "r", mitkCommandLineParser::Int, "Radius", "Search radius in mm", 15, true);
   parser.addArgument("noCenterOfMass", "com", mitkCommandLineParser::Bool, "No center of mass", "Do not use center of mass for node positions");
+  parser.addArgument("threads", "t", mitkCommandLineParser::Int, "Threads", "number of threads used for mapping the fibers (0: all available)", 0, true);
 
   parser.setCategory("Connectomics");
   parser.setTitle("Network Creation");
@@ -54,6 +56,7 @@ int main(int argc, char* argv[])
   //default values
   int searchRadius( 15 );
   bool noCenterOfMass( false );
+  int threads( 0 );
 
   // parse command line arguments
   std::string fiberFilename = us::any_cast<std::string>(parsedArgs["fiberImage"]);
@@ -67,6 +70,9 @@ int main(int argc, char* argv[])
   if (parsedArgs.count("noCenterOfMass"))
     noCenterOfMass = us::any_cast<bool>(parsedArgs["noCenterOfMass"]);
 
+  if (parsedArgs.count("threads"))
+    threads = us::any_cast<int>(parsedArgs["threads"]);
+
   try
   {
 
@@ -102,12 +108,22 @@ int main(int argc, char* argv[])
     mitk::ConnectomicsNetworkCreator::Pointer connectomicsNetworkCreator = mitk::ConnectomicsNetworkCreator::New();
     connectomicsNetworkCreator->SetSegmentation( parcellationImage );
     connectomicsNetworkCreator->SetFiberBundle( fiberBundle );
+    itk::TimeProbe clock;
     if( !noCenterOfMass )
     {
+      clock.Start();
       connectomicsNetworkCreator->CalculateCenterOfMass();
+      clock.Stop();
+      std::cout << "Center of mass calculation took " << clock.GetTotal() << "s" << std::endl;
     }
     connectomicsNetworkCreator->SetEndPointSearchRadius( searchRadius );
+    connectomicsNetworkCreator->SetNumberOfThreads( threads );
+
+    clock.Reset();
+    clock.Start();
     connectomicsNetworkCreator->CreateNetworkFromFibersAndSegmentation();
+    clock.Stop();
+    std::cout << "Network creation from " << fiberBundle->GetNumFibers() << " fibers took " << clock.GetTotal() << "s" << std::endl;
 
 
     mitk::ConnectomicsNetwork::Pointer network = connectomicsNetworkCreator->GetNetwork();
@@ -0,0 +1,154 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include <mitkStickModel.h>
+#include <mitkTensorModel.h>
+#include <mitkBallModel.h>
+#include <mitkDotModel.h>
+#include <mitkAstroStickModel.h>
+#include <itkTimeProbe.h>
+#include <itkMersenneTwisterRandomVariateGenerator.h>
+#include "mitkCommandLineParser.h"
+#include <algorithm>
+#include <cmath>
+
+using namespace mitk;
+
+typedef DiffusionSignalModel<double> ModelType;
+
+/** Evaluates the model for all fiber directions and all gradient directions, once direction by direction and once batched, and prints the throughput of both. */
+void Benchmark(std::string name, ModelType* model, const std::vector< double >& fiberDirections, int repetitions)
+{
+    unsigned int numFibers = fiberDirections.size()/3;
+    unsigned int numGradients = model->GetGradientList().size();
+    std::vector< double > single(numFibers*numGradients);
+    std::vector< double > batched(numFibers*numGradients);
+    std::vector< double > batch(numFibers);
+
+    itk::TimeProbe singleClock;
+    for (int r=0; r<repetitions; r++)
+    {
+        singleClock.Start();
+        for (unsigned int g=0; g<numGradients; g++)
+            for (unsigned int f=0; f<numFibers; f++)
+            {
+                ModelType::GradientType dir;
+                dir[0] = fiberDirections[3*f]; dir[1] = fiberDirections[3*f+1]; dir[2] = fiberDirections[3*f+2];
+                model->SetFiberDirection(dir);
+                single[f*numGradients+g] = model->SimulateMeasurement(g);
+            }
+        singleClock.Stop();
+    }
+
+    // same access pattern as TractsToDWIImageFilter: all fibers for one gradient direction per call
+    itk::TimeProbe batchClock;
+    for (int r=0; r<repetitions; r++)
+    {
+        batchClock.Start();
+        for (unsigned int g=0; g<numGradients; g++)
+        {
+            model->SimulateMeasurement(&fiberDirections[0], numFibers, g, g+1, &batch[0]);
+            for (unsigned int f=0; f<numFibers; f++)
+                batched[f*numGradients+g] = batch[f];
+        }
+        batchClock.Stop();
+    }
+
+    double maxError = 0;
+    for (unsigned int i=0; i<single.size(); i++)
+        maxError = std::max(maxError, fabs(single[i]-batched[i]));
+
+    double numSignals = (double)numFibers*numGradients;
+    std::cout << name << ": "
+              << numSignals/singleClock.GetMean() << " signals/s single, "
+              << numSignals/batchClock.GetMean() << " signals/s batched, "
+              << "speedup " << singleClock.GetMean()/batchClock.GetMean()
+              << ", max. difference " << maxError << std::endl;
+}
+
+int main(int argc, char* argv[])
+{
+    mitkCommandLineParser parser;
+    parser.setTitle("Signal Model Benchmark");
+    parser.setCategory("Fiber Tracking and Processing Methods");
+    parser.setContributor("MBI");
+    parser.setDescription("Measures the throughput of the Fiberfox signal models with and without batched evaluation.");
+    parser.setArgumentPrefix("--", "-");
+    parser.addArgument("fibers", "f", mitkCommandLineParser::Int, "Fiber directions:", "number of random fiber directions", 100000);
+    parser.addArgument("gradients", "g", mitkCommandLineParser::Int, "Gradient directions:", "number of diffusion weighted gradient directions (one baseline is added)", 64);
+    parser.addArgument("repetitions", "r", mitkCommandLineParser::Int, "Repetitions:", "number of timed runs per model", 3);
+
+    map<string, us::Any> parsedArgs = parser.parseArguments(argc, argv);
+    if (parsedArgs.size()==0)
+        return EXIT_FAILURE;
+
+    int numFibers = 100000;
+    if (parsedArgs.count("fibers"))
+        numFibers = us::any_cast<int>(parsedArgs["fibers"]);
+    int numGradients = 64;
+    if (parsedArgs.count("gradients"))
+        numGradients = us::any_cast<int>(parsedArgs["gradients"]);
+    int repetitions = 3;
+    if (parsedArgs.count("repetitions"))
+        repetitions = us::any_cast<int>(parsedArgs["repetitions"]);
+
+    itk::Statistics::MersenneTwisterRandomVariateGenerator::Pointer randGen = itk::Statistics::MersenneTwisterRandomVariateGenerator::New();
+    randGen->SetSeed(0);
+
+    ModelType::GradientListType gradients;
+    ModelType::GradientType baseline; baseline.Fill(0.0);
+    gradients.push_back(baseline);
+    for (int i=0; i<numGradients; i++)
+    {
+        ModelType::GradientType g;
+        g[0] = randGen->GetNormalVariate(); g[1] = randGen->GetNormalVariate(); g[2] = randGen->GetNormalVariate();
+        g.Normalize();
+        gradients.push_back(g);
+    }
+
+    std::vector< double > fiberDirections(3*numFibers);
+    for (int i=0; i<3*numFibers; i++)
+        fiberDirections[i] = randGen->GetNormalVariate();
+
+    StickModel<double> stick;
+    stick.SetGradientList(gradients);
+    stick.SetBvalue(1000);
+    stick.SetDiffusivity(0.001);
+    Benchmark("Stick", &stick, fiberDirections, repetitions);
+
+    TensorModel<double> tensor;
+    tensor.SetGradientList(gradients);
+    tensor.SetBvalue(1000);
+    Benchmark("Tensor", &tensor, fiberDirections, repetitions);
+
+    BallModel<double> ball;
+    ball.SetGradientList(gradients);
+    ball.SetBvalue(1000);
+    ball.SetDiffusivity(0.001);
+    Benchmark("Ball", &ball, fiberDirections, repetitions);
+
+    AstroStickModel<double> astrosticks;
+    astrosticks.SetGradientList(gradients);
+    astrosticks.SetBvalue(1000);
+    astrosticks.SetDiffusivity(0.001);
+    Benchmark("Astrosticks", &astrosticks, fiberDirections, repetitions);
+
+    DotModel<double> dot;
+    dot.SetGradientList(gradients);
+    Benchmark("Dot", &dot, fiberDirections, repetitions);
+
+    return EXIT_SUCCESS;
+}
@@ -20,6 +20,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "mitkBasePropertySerializer.h"
 #include "mitkIOMimeTypes.h"
 #include "mitkLabelSetImageIO.h"
+#include "mitkLocaleSwitch.h"
 
 // itk
 #include "itkMetaDataDictionary.h"
@@ -56,20 +57,8 @@ void LabelSetImageIO::Write()
 
   const LabelSetImage* input = static_cast<const LabelSetImage*>(this->GetInput());
 
-  const std::string& locale = "C";
-  const std::string& currLocale = setlocale( LC_ALL, NULL );
-
-  if ( locale.compare(currLocale)!=0 )
-  {
-    try
-    {
-      setlocale(LC_ALL, locale.c_str());
-    }
-    catch(...)
-    {
-      mitkThrow() << "Could not set locale " << currLocale;
-    }
-  }
+  // Switch the current locale to "C"
+  LocaleSwitch localeSwitch("C");
 
   typedef itk::ImageFileWriter<VectorImageType> WriterType;
 
@@ -138,15 +127,6 @@ void LabelSetImageIO::Write()
     MITK_ERROR << "Could not write segmentation session. See error log for details.";
     mitkThrow() << e.GetDescription();
   }
-
-  try
-  {
-    setlocale(LC_ALL, currLocale.c_str());
-  }
-  catch(...)
-  {
-    mitkThrow() << "Could not reset locale " << currLocale;
-  }
 }
 
 IFileIO::ConfidenceLevel LabelSetImageIO::GetReaderConfidenceLevel() const
@@ -170,20 +150,8 @@ IFileIO::ConfidenceLevel LabelSetImageIO::GetReaderConfidenceLevel() const
 
 std::vector<BaseData::Pointer> LabelSetImageIO::Read()
 {
-  const std::string& locale = "C";
-  const std::string& currLocale = setlocale( LC_ALL, NULL );
-
-  if ( locale.compare(currLocale)!=0 )
-  {
-    try
-    {
-      setlocale(LC_ALL, locale.c_str());
-    }
-    catch(...)
-    {
-      mitkThrow() << "Could not set locale.";
-    }
-  }
+  // Switch the current locale to "C"
+  LocaleSwitch localeSwitch("C");
 
   LabelSetImage::VectorImageType::Pointer vectorImage;
 
@@ -260,15 +228,6 @@ std::vector<BaseData::Pointer> LabelSetImageIO::Read()
   // set vector image
   output->SetVectorImage(vectorImage);
 
-  try
-  {
-    setlocale(LC_ALL, currLocale.c_str());
-  }
-  catch(...)
-  {
-    mitkThrow() << "Could not reset locale!";
-  }
-
   std::vector<BaseData::Pointer> result;
   result.push_back(output.GetPointer());
   return result;
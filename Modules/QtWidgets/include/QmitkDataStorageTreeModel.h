@@ -133,6 +133,11 @@ public:
   /// Sets a node to modfified. Called by the DataStorage
   ///
   virtual void SetNodeModified(const mitk::DataNode* node);
+  ///
+  /// Removes, adds and updates the nodes of a DataStorage batch at once. The layer
+  /// properties are adjusted only once for the whole batch.
+  ///
+  virtual void ProcessBatchedNodeEvents(const mitk::DataStorage::BatchedNodeEvents& events);
 
   ///
   /// \return an index for the given datatreenode in the tree. If the node is not found
@@ -257,6 +262,10 @@ private:
   void AddNodeInternal(const mitk::DataNode*);
   void RemoveNodeInternal(const mitk::DataNode*);
   ///
+  /// True while ProcessBatchedNodeEvents() adds and removes nodes
+  ///
+  bool m_ProcessingBatch;
+  ///
   /// Checks if dicom properties patient name, study names and series name exists
   ///
   bool DicomPropertiesExists(const mitk::DataNode&) const;
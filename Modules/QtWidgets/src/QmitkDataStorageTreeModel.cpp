@@ -44,6 +44,7 @@ QmitkDataStorageTreeModel::QmitkDataStorageTreeModel( mitk::DataStorage* _DataSt
 , m_DataStorage(0)
 , m_PlaceNewNodesOnTop(_PlaceNewNodesOnTop)
 , m_Root(0)
+, m_ProcessingBatch(false)
 {
   this->SetDataStorage(_DataStorage);
 }
@@ -409,6 +410,9 @@ void QmitkDataStorageTreeModel::SetDataStorage( mitk::DataStorage* _DataStorage
       m_DataStorage->RemoveNodeEvent.RemoveListener( mitk::MessageDelegate1<QmitkDataStorageTreeModel
         , const mitk::DataNode*>( this, &QmitkDataStorageTreeModel::RemoveNode ) );
 
+      m_DataStorage->BatchNodeEvent.RemoveListener( mitk::MessageDelegate1<QmitkDataStorageTreeModel
+        , const mitk::DataStorage::BatchedNodeEvents&>( this, &QmitkDataStorageTreeModel::ProcessBatchedNodeEvents ) );
+
     }
 
     // take over the new data storage
@@ -439,6 +443,9 @@ void QmitkDataStorageTreeModel::SetDataStorage( mitk::DataStorage* _DataStorage
       m_DataStorage->RemoveNodeEvent.AddListener( mitk::MessageDelegate1<QmitkDataStorageTreeModel
         , const mitk::DataNode*>( this, &QmitkDataStorageTreeModel::RemoveNode ) );
 
+      m_DataStorage->BatchNodeEvent.AddListener( mitk::MessageDelegate1<QmitkDataStorageTreeModel
+        , const mitk::DataStorage::BatchedNodeEvents&>( this, &QmitkDataStorageTreeModel::ProcessBatchedNodeEvents ) );
+
       mitk::DataStorage::SetOfObjects::ConstPointer _NodeSet = m_DataStorage->GetSubset(m_Predicate);
 
       // finally add all nodes to the model
@@ -498,13 +505,15 @@ void QmitkDataStorageTreeModel::AddNodeInternal(const mitk::DataNode *node)
     // emit endInsertRows event
     endInsertRows();
 
-    this->AdjustLayerProperty();
+    if (!m_ProcessingBatch)
+      this->AdjustLayerProperty();
 }
 
 void QmitkDataStorageTreeModel::AddNode( const mitk::DataNode* node )
 {
     if(node == 0
       || m_DataStorage.IsNull()
+      || m_DataStorage->IsDeliveringBatch() // already handled by ProcessBatchedNodeEvents()
       || !m_DataStorage->Exists(node)
       || m_Root->Find(node) != 0)
       return;
@@ -553,19 +562,40 @@ void QmitkDataStorageTreeModel::RemoveNodeInternal( const mitk::DataNode* node )
       endInsertRows();
     }
 
-    this->AdjustLayerProperty();
+    if (!m_ProcessingBatch)
+      this->AdjustLayerProperty();
 }
 
 void QmitkDataStorageTreeModel::RemoveNode( const mitk::DataNode* node )
 {
-    if (node == 0)
+    if (node == 0
+      || (m_DataStorage.IsNotNull() && m_DataStorage->IsDeliveringBatch()))
         return;
 
     this->RemoveNodeInternal(node);
 }
 
+void QmitkDataStorageTreeModel::ProcessBatchedNodeEvents( const mitk::DataStorage::BatchedNodeEvents& events )
+{
+  m_ProcessingBatch = true;
+  for (std::vector<mitk::DataNode::ConstPointer>::const_iterator it = events.RemovedNodes.begin(); it != events.RemovedNodes.end(); ++it)
+    this->RemoveNodeInternal(*it);
+  for (std::vector<mitk::DataNode::ConstPointer>::const_iterator it = events.AddedNodes.begin(); it != events.AddedNodes.end(); ++it)
+    this->AddNode(*it);
+  m_ProcessingBatch = false;
+
+  if (!events.RemovedNodes.empty() || !events.AddedNodes.empty())
+    this->AdjustLayerProperty();
+
+  for (std::vector<mitk::DataNode::ConstPointer>::const_iterator it = events.ChangedNodes.begin(); it != events.ChangedNodes.end(); ++it)
+    this->SetNodeModified(*it);
+}
+
 void QmitkDataStorageTreeModel::SetNodeModified( const mitk::DataNode* node )
 {
+  if (m_DataStorage.IsNotNull() && m_DataStorage->IsDeliveringBatch())
+    return;
+
   TreeItem* treeItem = m_Root->Find(node);
   if(treeItem) {
     TreeItem* parentTreeItem = treeItem->GetParent();
@@ -633,6 +663,9 @@ void QmitkDataStorageTreeModel::AdjustLayerProperty()
   std::vector<TreeItem*> vec;
   this->TreeToVector(m_Root, vec);
 
+  // the layer changes are reported as one batch, see ProcessBatchedNodeEvents()
+  mitk::DataStorage::BatchScope batch(m_DataStorage.GetPointer());
+
   int i = vec.size()-1;
   for(std::vector<TreeItem*>::const_iterator it = vec.begin(); it != vec.end(); ++it)
   {
@@ -5,9 +5,12 @@ set(CPP_FILES
   mitkPointSetSerializer.cpp
   mitkPropertyListDeserializer.cpp
   mitkPropertyListDeserializerV1.cpp
+  mitkSceneArchive.cpp
+  mitkSceneDataLoader.cpp
   mitkSceneIO.cpp
   mitkSceneReader.cpp
   mitkSceneReaderV1.cpp
+  mitkSceneSerializationActivator.cpp
   mitkSurfaceSerializer.cpp
 )
 
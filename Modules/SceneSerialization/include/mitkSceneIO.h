@@ -22,7 +22,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "mitkDataStorage.h"
 #include "mitkNodePredicateBase.h"
 
-#include <Poco/Zip/ZipLocalFileHeader.h>
+#include <map>
 
 class TiXmlElement;
 
@@ -30,6 +30,7 @@ namespace mitk
 {
 
 class BaseData;
+class BaseDataSerializer;
 class PropertyList;
 
 class MITKSCENESERIALIZATION_EXPORT SceneIO : public itk::Object
@@ -42,6 +43,31 @@ class MITKSCENESERIALIZATION_EXPORT SceneIO : public itk::Object
 
     typedef DataStorage::SetOfObjects                                FailedBaseDataListType;
 
+    /**
+     * \brief Number of threads that serialize and deserialize the BaseData objects of a scene.
+     *
+     * Defaults to 1, which processes all nodes in the calling thread. More threads only pay off
+     * if all readers and writers of the scene's data types are safe to run concurrently, in
+     * particular they must not change the process locale, see mitk::LocaleSwitch.
+     */
+    itkSetMacro(NumberOfThreads, unsigned int);
+    itkGetConstMacro(NumberOfThreads, unsigned int);
+
+    /**
+     * \brief Open scenes without reading the BaseData of their nodes.
+     *
+     * LoadScene() creates all nodes with their properties, but each node reads its
+     * BaseData from the scene file on the first call of DataNode::GetData(). If
+     * NumberOfThreads is larger than 1, i.e. the readers of the scene may run concurrently,
+     * the data of visible nodes is read in a background thread right away. The scene file
+     * must not be removed or changed while it has nodes whose data was not read.
+     *
+     * Off by default.
+     */
+    itkSetMacro(LazyLoading, bool);
+    itkGetConstMacro(LazyLoading, bool);
+    itkBooleanMacro(LazyLoading);
+
     /**
      * \brief Load a scene of objects from file
      * \return DataStorage with all scene objects and their relations. If loading failed, query GetFailedNodes() and GetFailedProperties() for more detail.
@@ -100,17 +126,29 @@ class MITKSCENESERIALIZATION_EXPORT SceneIO : public itk::Object
 
     std::string CreateEmptyTempDirectory();
 
-    TiXmlElement* SaveBaseData( BaseData* data, const std::string& filenamehint, bool& error);
-    TiXmlElement* SavePropertyList( PropertyList* propertyList, const std::string& filenamehint );
+    /**
+     * \brief Creates the <data> element for a BaseData object and the serializer that will write its file.
+     *
+     * The serializer is not run here, SaveScene() runs the serializers of all nodes in parallel and sets the "file" attribute afterwards.
+     * Returns a NULL serializer if there is none for the type of data.
+     */
+    TiXmlElement* PrepareBaseData( BaseData* data, const std::string& filenamehint, itk::SmartPointer<BaseDataSerializer>& serializer );
 
-    void OnUnzipError(const void* pSender, std::pair<const Poco::Zip::ZipLocalFileHeader, const std::string>& info);
-    void OnUnzipOk(const void* pSender, std::pair<const Poco::Zip::ZipLocalFileHeader, const Poco::Path>& info);
+    /**
+     * \brief Creates the <properties> element for a property list and keeps its XML in m_PropertyListEntries.
+     */
+    TiXmlElement* SavePropertyList( PropertyList* propertyList, const std::string& filenamehint );
 
     FailedBaseDataListType::Pointer m_FailedNodes;
     PropertyList::Pointer           m_FailedProperties;
 
+    /** XML of the property lists of the scene that is saved, by zip entry name */
+    std::map<std::string, std::string> m_PropertyListEntries;
+
     std::string  m_WorkingDirectory;
     unsigned int m_UnzipErrors;
+    unsigned int m_NumberOfThreads;
+    bool         m_LazyLoading;
 };
 
 }
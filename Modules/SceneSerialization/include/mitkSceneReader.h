@@ -34,6 +34,37 @@ class MITKSCENESERIALIZATION_EXPORT SceneReader : public itk::Object
     itkCloneMacro(Self)
 
     virtual bool LoadScene( TiXmlDocument& document, const std::string& workingDirectory, DataStorage* storage );
+
+    /**
+      \brief Number of threads that read the BaseData files of the scene, 1 reads them in the calling thread.
+
+      With lazy loading, more than 1 thread also reads the data of visible nodes in the background.
+    */
+    itkSetMacro(NumberOfThreads, unsigned int);
+    itkGetConstMacro(NumberOfThreads, unsigned int);
+
+    /**
+      \brief If set, nodes get a loader that reads their BaseData from SceneFilename on first access, see DataNode::SetDataLoader().
+
+      Needs a SceneFilename, without it the BaseData is read from the working directory right away.
+    */
+    itkSetMacro(LazyLoading, bool);
+    itkGetConstMacro(LazyLoading, bool);
+    itkBooleanMacro(LazyLoading);
+
+    /**
+      \brief The scene file of the document. If set, the BaseData and property files are read from it and the working directory is not used.
+    */
+    itkSetStringMacro(SceneFilename);
+    itkGetStringMacro(SceneFilename);
+
+  protected:
+
+    SceneReader();
+
+    unsigned int m_NumberOfThreads;
+    bool m_LazyLoading;
+    std::string m_SceneFilename;
 };
 
 }
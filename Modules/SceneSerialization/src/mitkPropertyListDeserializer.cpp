@@ -31,10 +31,9 @@ bool mitk::PropertyListDeserializer::Deserialize()
 {
   bool error(false);
 
-  TiXmlDocument document( m_Filename );
-  if (!document.LoadFile())
+  TiXmlDocument document;
+  if (!this->LoadDocument( document ))
   {
-    MITK_ERROR << "Could not open/read/parse " << m_Filename << "\nTinyXML reports: " << document.ErrorDesc() << std::endl;
     return false;
   }
 
@@ -69,6 +68,7 @@ bool mitk::PropertyListDeserializer::Deserialize()
     if (PropertyListDeserializer* reader = dynamic_cast<PropertyListDeserializer*>( iter->GetPointer() ) )
     {
       reader->SetFilename( m_Filename );
+      reader->SetContent( m_Content );
       bool success = reader->Deserialize();
       error |= !success;
       m_PropertyList = reader->GetOutput();
@@ -85,6 +85,28 @@ bool mitk::PropertyListDeserializer::Deserialize()
 }
 
 
+bool mitk::PropertyListDeserializer::LoadDocument( TiXmlDocument& document )
+{
+  if (m_Content.empty())
+  {
+    if (!document.LoadFile( m_Filename.c_str() ))
+    {
+      MITK_ERROR << "Could not open/read/parse " << m_Filename << "\nTinyXML reports: " << document.ErrorDesc() << std::endl;
+      return false;
+    }
+  }
+  else
+  {
+    document.Parse( m_Content.c_str() );
+    if (document.Error())
+    {
+      MITK_ERROR << "Could not parse " << m_Filename << "\nTinyXML reports: " << document.ErrorDesc() << std::endl;
+      return false;
+    }
+  }
+  return true;
+}
+
 mitk::PropertyList::Pointer mitk::PropertyListDeserializer::GetOutput()
 {
   return m_PropertyList;
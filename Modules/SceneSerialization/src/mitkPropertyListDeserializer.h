@@ -19,6 +19,8 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 #include "mitkPropertyList.h"
 
+class TiXmlDocument;
+
 namespace mitk
 {
 
@@ -36,6 +38,12 @@ class PropertyListDeserializer : public itk::Object
     itkSetStringMacro(Filename);
     itkGetStringMacro(Filename);
 
+    /**
+      \brief XML text of the property list, e.g. read from a scene file. If set, it is parsed instead of the file and Filename only names the list in messages.
+    */
+    itkSetStringMacro(Content);
+    itkGetStringMacro(Content);
+
     /**
       \brief Reads a propertylist from file
       \return success of deserialization
@@ -49,7 +57,13 @@ class PropertyListDeserializer : public itk::Object
     PropertyListDeserializer();
     virtual ~PropertyListDeserializer();
 
+    /**
+      \brief Parses Content, or the file if there is no Content, into document
+    */
+    bool LoadDocument( TiXmlDocument& document );
+
     std::string m_Filename;
+    std::string m_Content;
     PropertyList::Pointer m_PropertyList;
 };
 
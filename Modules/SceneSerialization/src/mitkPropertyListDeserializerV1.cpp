@@ -36,10 +36,9 @@ bool mitk::PropertyListDeserializerV1::Deserialize()
 
   m_PropertyList = PropertyList::New();
 
-  TiXmlDocument document( m_Filename );
-  if (!document.LoadFile())
+  TiXmlDocument document;
+  if (!this->LoadDocument( document ))
   {
-    MITK_ERROR << "Could not open/read/parse " << m_Filename << "\nTinyXML reports: " << document.ErrorDesc() << std::endl;
     return false;
   }
 
@@ -0,0 +1,88 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include "mitkSceneArchive.h"
+#include "mitkExceptionMacro.h"
+
+#include <Poco/StreamCopier.h>
+#include <Poco/Zip/ZipArchive.h>
+#include <Poco/Zip/ZipStream.h>
+
+#include <fstream>
+#include <sstream>
+
+namespace
+{
+  const Poco::Zip::ZipLocalFileHeader& FindEntry( const Poco::Zip::ZipArchive& archive, const std::string& filename, const std::string& entryName )
+  {
+    Poco::Zip::ZipArchive::FileHeaders::const_iterator entry = archive.findHeader( entryName );
+    if (entry == archive.headerEnd())
+    {
+      mitkThrow() << "Scene file " << filename << " does not contain " << entryName;
+    }
+    return entry->second;
+  }
+}
+
+mitk::SceneArchive::SceneArchive( const std::string& filename )
+  : m_Filename(filename)
+{
+  std::ifstream file( m_Filename.c_str(), std::ios::binary );
+  if (!file.good())
+  {
+    mitkThrow() << "Cannot open '" << m_Filename << "' for reading";
+  }
+  m_Archive.reset( new Poco::Zip::ZipArchive( file ) );
+}
+
+mitk::SceneArchive::~SceneArchive()
+{
+}
+
+const std::string& mitk::SceneArchive::GetFilename() const
+{
+  return m_Filename;
+}
+
+bool mitk::SceneArchive::HasEntry( const std::string& entryName ) const
+{
+  return m_Archive->findHeader( entryName ) != m_Archive->headerEnd();
+}
+
+std::string mitk::SceneArchive::ReadEntry( const std::string& entryName ) const
+{
+  const Poco::Zip::ZipLocalFileHeader& entry = FindEntry( *m_Archive, m_Filename, entryName );
+
+  std::ifstream file( m_Filename.c_str(), std::ios::binary );
+  Poco::Zip::ZipInputStream zipin( file, entry );
+  std::ostringstream content;
+  Poco::StreamCopier::copyStream( zipin, content );
+  return content.str();
+}
+
+void mitk::SceneArchive::ExtractEntry( const std::string& entryName, const std::string& filename ) const
+{
+  const Poco::Zip::ZipLocalFileHeader& entry = FindEntry( *m_Archive, m_Filename, entryName );
+
+  std::ifstream file( m_Filename.c_str(), std::ios::binary );
+  Poco::Zip::ZipInputStream zipin( file, entry );
+  std::ofstream out( filename.c_str(), std::ios::binary );
+  Poco::StreamCopier::copyStream( zipin, out );
+  if (!out.good())
+  {
+    mitkThrow() << "Could not write '" << entryName << "' to " << filename;
+  }
+}
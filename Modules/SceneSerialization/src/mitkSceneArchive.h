@@ -0,0 +1,75 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#ifndef mitkSceneArchive_h_included
+#define mitkSceneArchive_h_included
+
+#include <memory>
+#include <string>
+
+namespace Poco
+{
+  namespace Zip
+  {
+    class ZipArchive;
+  }
+}
+
+namespace mitk
+{
+
+/**
+  \brief Reads single entries of a scene file without extracting the whole file.
+
+  Each entry is read through a stream of its own, so several threads can read
+  entries of the same archive at once.
+*/
+class SceneArchive
+{
+  public:
+
+    /**
+      \brief Reads the directory of the scene file, throws if it can not be read.
+    */
+    explicit SceneArchive( const std::string& filename );
+    ~SceneArchive();
+
+    const std::string& GetFilename() const;
+
+    bool HasEntry( const std::string& entryName ) const;
+
+    /**
+      \brief Returns the content of an entry, e.g. of an XML file. Throws if there is no such entry.
+    */
+    std::string ReadEntry( const std::string& entryName ) const;
+
+    /**
+      \brief Writes the content of an entry to a file, for readers that need a file name. Throws if there is no such entry.
+    */
+    void ExtractEntry( const std::string& entryName, const std::string& filename ) const;
+
+  private:
+
+    SceneArchive( const SceneArchive& );
+    SceneArchive& operator=( const SceneArchive& );
+
+    std::string m_Filename;
+    std::unique_ptr<Poco::Zip::ZipArchive> m_Archive;
+};
+
+}
+
+#endif
@@ -0,0 +1,228 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include "mitkSceneDataLoader.h"
+#include "mitkIOUtil.h"
+
+#include <Poco/File.h>
+#include <Poco/Path.h>
+#include <Poco/TemporaryFile.h>
+
+#include <itkConditionVariable.h>
+#include <itkMultiThreader.h>
+#include <itkMutexLockHolder.h>
+#include <itkSimpleMutexLock.h>
+
+#include <deque>
+
+namespace
+{
+  /**
+    One background thread that reads the data of the loaders in the order they were added.
+
+    The queue is stopped by SceneDataLoader::StopPrefetch() when the module is unloaded,
+    i.e. while IOUtil and the readers are still available. It is not a function static,
+    because joining the thread during static destruction may wait for a reader whose
+    module was destroyed already.
+  */
+  class PrefetchQueue
+  {
+  public:
+
+    PrefetchQueue()
+      : m_MultiThreader(itk::MultiThreader::New()),
+        m_Condition(itk::ConditionVariable::New()),
+        m_ThreadId(-1),
+        m_Stop(false)
+    {
+    }
+
+    /** Discards the queued loaders and waits for the loader that is being read */
+    ~PrefetchQueue()
+    {
+      {
+        itk::MutexLockHolder<itk::SimpleMutexLock> lock(m_Mutex);
+        m_Stop = true;
+        m_Loaders.clear();
+      }
+      m_Condition->Broadcast();
+      if (m_ThreadId >= 0)
+      {
+        m_MultiThreader->TerminateThread(m_ThreadId);
+      }
+    }
+
+    void Add( const std::vector<mitk::SceneDataLoader::Pointer>& loaders )
+    {
+      itk::MutexLockHolder<itk::SimpleMutexLock> lock(m_Mutex);
+      m_Loaders.insert( m_Loaders.end(), loaders.begin(), loaders.end() );
+      if (m_ThreadId < 0)
+      {
+        m_ThreadId = m_MultiThreader->SpawnThread( &PrefetchQueue::Worker, this );
+      }
+      m_Condition->Broadcast();
+    }
+
+  private:
+
+    static ITK_THREAD_RETURN_TYPE Worker( void* arg )
+    {
+      PrefetchQueue* queue = static_cast<PrefetchQueue*>( static_cast<itk::MultiThreader::ThreadInfoStruct*>(arg)->UserData );
+      while (true)
+      {
+        mitk::SceneDataLoader::Pointer loader;
+        {
+          itk::MutexLockHolder<itk::SimpleMutexLock> lock(queue->m_Mutex);
+          while (!queue->m_Stop && queue->m_Loaders.empty())
+          {
+            queue->m_Condition->Wait(&queue->m_Mutex);
+          }
+          if (queue->m_Stop)
+            break;
+          loader = queue->m_Loaders.front();
+          queue->m_Loaders.pop_front();
+        }
+
+        // the node of the loader still waits for its data
+        if (loader->GetReferenceCount() > 1)
+        {
+          loader->Load();
+        }
+      }
+      return ITK_THREAD_RETURN_VALUE;
+    }
+
+    itk::MultiThreader::Pointer m_MultiThreader;
+    itk::ConditionVariable::Pointer m_Condition;
+    itk::SimpleMutexLock m_Mutex;
+    itk::ThreadIdType m_ThreadId;
+    bool m_Stop;
+    std::deque<mitk::SceneDataLoader::Pointer> m_Loaders;
+  };
+
+  itk::SimpleMutexLock g_PrefetchQueueMutex;
+  PrefetchQueue* g_PrefetchQueue = NULL;
+  bool g_PrefetchStopped = false;
+}
+
+mitk::SceneDataLoader::SceneDataLoader( std::shared_ptr<const SceneArchive> archive, const std::string& entryName, const std::string& dataType )
+  : m_Archive(archive),
+    m_EntryName(entryName),
+    m_DataType(dataType),
+    m_Loaded(false)
+{
+}
+
+mitk::SceneDataLoader::~SceneDataLoader()
+{
+}
+
+std::string mitk::SceneDataLoader::GetDataType() const
+{
+  return m_DataType;
+}
+
+void mitk::SceneDataLoader::SetDataProperties( PropertyList* properties )
+{
+  itk::MutexLockHolder<itk::SimpleFastMutexLock> lock(m_Mutex);
+  m_DataProperties = properties;
+}
+
+mitk::BaseData::Pointer mitk::SceneDataLoader::Load()
+{
+  // a second caller waits for the data the first one is reading
+  itk::MutexLockHolder<itk::SimpleFastMutexLock> lock(m_Mutex);
+  if (!m_Loaded)
+  {
+    m_Data = this->Read();
+    m_Loaded = true;
+
+    if (m_Data.IsNotNull() && m_DataProperties.IsNotNull())
+    {
+      m_Data->SetPropertyList( m_DataProperties );
+    }
+  }
+  return m_Data;
+}
+
+mitk::BaseData::Pointer mitk::SceneDataLoader::Read()
+{
+  std::string directory = Poco::TemporaryFile::tempName();
+  BaseData::Pointer data;
+
+  try
+  {
+    // readers need a file name with the original extension
+    Poco::File( directory ).createDirectories();
+    std::string filename = directory + Poco::Path::separator() + Poco::Path( m_EntryName, Poco::Path::PATH_UNIX ).getFileName();
+    m_Archive->ExtractEntry( m_EntryName, filename );
+
+    std::vector<BaseData::Pointer> baseData = IOUtil::Load( filename );
+    if (baseData.size() > 1)
+    {
+      MITK_WARN << "Discarding multiple base data results from " << m_EntryName << " except the first one.";
+    }
+    if (!baseData.empty())
+    {
+      data = baseData.front();
+    }
+  }
+  catch (std::exception& e)
+  {
+    MITK_ERROR << "Error during attempt to read '" << m_EntryName << "' from " << m_Archive->GetFilename() << ". Exception says: " << e.what();
+  }
+
+  try
+  {
+    Poco::File deleteDir( directory );
+    if (deleteDir.exists())
+      deleteDir.remove(true); // recursive
+  }
+  catch(...)
+  {
+    MITK_ERROR << "Could not delete temporary directory " << directory;
+  }
+
+  return data;
+}
+
+void mitk::SceneDataLoader::Prefetch( const std::vector<SceneDataLoader::Pointer>& loaders )
+{
+  if (loaders.empty())
+    return;
+
+  itk::MutexLockHolder<itk::SimpleMutexLock> lock(g_PrefetchQueueMutex);
+  if (g_PrefetchStopped)
+    return; // the data is read on first access
+
+  if (g_PrefetchQueue == NULL)
+  {
+    g_PrefetchQueue = new PrefetchQueue;
+  }
+  g_PrefetchQueue->Add( loaders );
+}
+
+void mitk::SceneDataLoader::StopPrefetch()
+{
+  PrefetchQueue* queue = NULL;
+  {
+    itk::MutexLockHolder<itk::SimpleMutexLock> lock(g_PrefetchQueueMutex);
+    g_PrefetchStopped = true;
+    queue = g_PrefetchQueue;
+    g_PrefetchQueue = NULL;
+  }
+  delete queue;
+}
@@ -0,0 +1,90 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#ifndef mitkSceneDataLoader_h_included
+#define mitkSceneDataLoader_h_included
+
+#include "mitkLazyDataLoader.h"
+#include "mitkPropertyList.h"
+#include "mitkSceneArchive.h"
+
+#include <itkSimpleFastMutexLock.h>
+
+namespace mitk
+{
+
+/**
+  \brief Reads the BaseData of one node from a scene file on first access.
+
+  Only the entry of the node is extracted from the scene file into a temporary
+  directory, read with IOUtil and removed again. The scene file must therefore
+  still exist when the data is accessed. SceneReaderV1 also uses the loaders
+  to read all data of a scene right away.
+*/
+class SceneDataLoader : public LazyDataLoader
+{
+  public:
+
+    mitkClassMacro( SceneDataLoader, LazyDataLoader );
+    mitkNewMacro3Param( Self, std::shared_ptr<const SceneArchive>, const std::string&, const std::string& );
+
+    virtual std::string GetDataType() const override;
+
+    virtual BaseData::Pointer Load() override;
+
+    /**
+      \brief Properties of the BaseData, read from the scene file along with the node properties.
+    */
+    void SetDataProperties( PropertyList* properties );
+
+    /**
+      \brief Reads the data of the given loaders in a background thread, in the given order.
+
+      Loaders that are only referenced by the prefetch queue any more, e.g. because
+      their scene was closed or their node was loaded already, are skipped. The readers
+      of the data must be safe to run concurrently to other threads, in particular they
+      must not change the process locale (see mitk::LocaleSwitch).
+    */
+    static void Prefetch( const std::vector<SceneDataLoader::Pointer>& loaders );
+
+    /**
+      \brief Stops the prefetch thread, waiting for the data it is reading.
+
+      Called when the module is unloaded. Later calls of Prefetch() do nothing.
+    */
+    static void StopPrefetch();
+
+  protected:
+
+    SceneDataLoader( std::shared_ptr<const SceneArchive> archive, const std::string& entryName, const std::string& dataType );
+    virtual ~SceneDataLoader();
+
+    BaseData::Pointer Read();
+
+    std::shared_ptr<const SceneArchive> m_Archive;
+    std::string m_EntryName;
+    std::string m_DataType;
+
+    PropertyList::Pointer m_DataProperties;
+
+    itk::SimpleFastMutexLock m_Mutex;
+    BaseData::Pointer m_Data;
+    bool m_Loaded;
+};
+
+}
+
+#endif
@@ -16,14 +16,17 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 #include <Poco/TemporaryFile.h>
 #include <Poco/Path.h>
-#include <Poco/Delegate.h>
+#include <Poco/DateTime.h>
+#include <Poco/DirectoryIterator.h>
+#include <Poco/String.h>
 #include <Poco/Zip/Compress.h>
-#include <Poco/Zip/Decompress.h>
 
 #include "mitkSceneIO.h"
 #include "mitkBaseDataSerializer.h"
 #include "mitkPropertyListSerializer.h"
+#include "mitkSceneArchive.h"
 #include "mitkSceneReader.h"
+#include "mitkSceneIOParallelFor.h"
 
 #include "mitkProgressBar.h"
 #include "mitkBaseRenderer.h"
@@ -35,15 +38,107 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 #include <tinyxml.h>
 
+#include <algorithm>
 #include <fstream>
 #include <sstream>
 #include <mitkIOUtil.h>
 
 #include "itksys/SystemTools.hxx"
 
+namespace
+{
+  /** BaseData of one node, its <data> element and the serializer that writes its file */
+  struct BaseDataSerialization
+  {
+    mitk::DataNode* Node;
+    TiXmlElement* Element;
+    mitk::BaseDataSerializer::Pointer Serializer;
+    std::string Filename;
+    bool Error;
+  };
+
+  /** Extensions of files that are compressed by their writers already and therefore only stored in the scene file */
+  bool IsCompressedFileType( const std::string& extension )
+  {
+    static const char* const compressedExtensions[] = { "nrrd", "vtp", "vti", "gz", "zip", "png", "jpg", "jpeg" };
+    std::string lowerExtension = Poco::toLower(extension);
+    for (unsigned int i = 0; i < sizeof(compressedExtensions) / sizeof(compressedExtensions[0]); ++i)
+    {
+      if (lowerExtension == compressedExtensions[i])
+        return true;
+    }
+    return false;
+  }
+
+  /** Adds all files below directory to the zip file, directories are added recursively as prefix of the entry names */
+  void AddDirectoryToZip( Poco::Zip::Compress& zipper, const Poco::Path& directory, const Poco::Path& entryDirectory )
+  {
+    for (Poco::DirectoryIterator iter( directory ), end; iter != end; ++iter)
+    {
+      Poco::Path entryName( entryDirectory, Poco::Path( iter.name() ) );
+      if (iter->isDirectory())
+      {
+        entryName.makeDirectory();
+        AddDirectoryToZip( zipper, Poco::Path( iter.path() ).makeDirectory(), entryName );
+      }
+      else if (IsCompressedFileType( iter.path().getExtension() ))
+      {
+        // deflating large images and surfaces that are compressed already costs much time and gains nothing
+        zipper.addFile( iter.path(), entryName, Poco::Zip::ZipCommon::CM_STORE, Poco::Zip::ZipCommon::CL_NORMAL );
+      }
+      else
+      {
+        zipper.addFile( iter.path(), entryName, Poco::Zip::ZipCommon::CM_DEFLATE, Poco::Zip::ZipCommon::CL_MAXIMUM );
+      }
+    }
+  }
+
+  /** Adds all files below directory to the zip file and removes them from the directory */
+  void MoveDirectoryToZip( Poco::Zip::Compress& zipper, const std::string& directory )
+  {
+    Poco::Path directoryPath = Poco::Path( directory ).makeDirectory();
+    AddDirectoryToZip( zipper, directoryPath, Poco::Path() );
+
+    std::vector<std::string> names;
+    Poco::File( directoryPath ).list( names );
+    for (std::vector<std::string>::const_iterator name = names.begin(); name != names.end(); ++name)
+    {
+      Poco::File( Poco::Path( directoryPath, *name ) ).remove( true );
+    }
+  }
+
+  /** Adds a zip entry with the given content, e.g. an XML file that was created in memory */
+  void AddContentToZip( Poco::Zip::Compress& zipper, const std::string& entryName, const std::string& content )
+  {
+    std::istringstream in( content );
+    zipper.addFile( in, Poco::DateTime(), Poco::Path( entryName, Poco::Path::PATH_UNIX ), Poco::Zip::ZipCommon::CM_DEFLATE, Poco::Zip::ZipCommon::CL_MAXIMUM );
+  }
+
+  void RemoveDirectory( const std::string& directory )
+  {
+    if (directory.empty())
+      return;
+
+    try
+    {
+      Poco::File deleteDir( directory );
+      if (deleteDir.exists())
+      {
+        deleteDir.remove(true); // recursive
+      }
+    }
+    catch(...)
+    {
+      MITK_ERROR << "Could not delete temporary directory " << directory;
+    }
+  }
+}
+
 mitk::SceneIO::SceneIO()
   :m_WorkingDirectory(""),
-  m_UnzipErrors(0)
+  m_UnzipErrors(0),
+  m_NumberOfThreads(1),
+  m_LazyLoading(false)
 {
 }
 
@@ -114,62 +209,34 @@ mitk::DataStorage::Pointer mitk::SceneIO::LoadScene( const std::string& filename
     return storage;
   }
 
-  // test if filename can be read
-  std::ifstream file( filename.c_str(), std::ios::binary );
-  if (!file.good())
+  // only index.xml is read here, the reader takes the data and property files from the scene file as well
+  TiXmlDocument document;
+  try
   {
-    MITK_ERROR << "Cannot open '" << filename << "' for reading";
-    return storage;
+    SceneArchive archive( filename );
+    std::string index = archive.ReadEntry( "index.xml" );
+    document.Parse( index.c_str() );
   }
-
-  // get new temporary directory
-  m_WorkingDirectory = CreateEmptyTempDirectory();
-  if (m_WorkingDirectory.empty())
+  catch (std::exception& e)
   {
-    MITK_ERROR << "Could not create temporary directory. Cannot open scene files.";
+    MITK_ERROR << "Could not read index.xml from '" << filename << "': " << e.what();
     return storage;
   }
-
-  // unzip all filenames contents to temp dir
-  m_UnzipErrors = 0;
-  Poco::Zip::Decompress unzipper( file, Poco::Path( m_WorkingDirectory ) );
-  unzipper.EError += Poco::Delegate<SceneIO, std::pair<const Poco::Zip::ZipLocalFileHeader, const std::string> >(this, &SceneIO::OnUnzipError);
-  unzipper.EOk    += Poco::Delegate<SceneIO, std::pair<const Poco::Zip::ZipLocalFileHeader, const Poco::Path> >(this, &SceneIO::OnUnzipOk);
-  unzipper.decompressAllFiles();
-  unzipper.EError -= Poco::Delegate<SceneIO, std::pair<const Poco::Zip::ZipLocalFileHeader, const std::string> >(this, &SceneIO::OnUnzipError);
-  unzipper.EOk    -= Poco::Delegate<SceneIO, std::pair<const Poco::Zip::ZipLocalFileHeader, const Poco::Path> >(this, &SceneIO::OnUnzipOk);
-
-  if ( m_UnzipErrors )
-  {
-    MITK_ERROR << "There were " << m_UnzipErrors << " errors unzipping '" << filename << "'. Will attempt to read whatever could be unzipped.";
-  }
-
-  // test if index.xml exists
-  // parse index.xml with TinyXML
-  TiXmlDocument document( m_WorkingDirectory + mitk::IOUtil::GetDirectorySeparator() + "index.xml" );
-  if (!document.LoadFile())
+  if (document.Error())
   {
-    MITK_ERROR << "Could not open/read/parse " << m_WorkingDirectory << mitk::IOUtil::GetDirectorySeparator() << "index.xml\nTinyXML reports: " << document.ErrorDesc() << std::endl;
+    MITK_ERROR << "Could not parse index.xml of " << filename << "\nTinyXML reports: " << document.ErrorDesc() << std::endl;
     return storage;
   }
 
   SceneReader::Pointer reader = SceneReader::New();
-  if ( !reader->LoadScene( document, m_WorkingDirectory, storage ) )
+  reader->SetNumberOfThreads( m_NumberOfThreads );
+  reader->SetLazyLoading( m_LazyLoading );
+  reader->SetSceneFilename( Poco::Path( filename ).absolute().toString() );
+  if ( !reader->LoadScene( document, "", storage ) )
   {
     MITK_ERROR << "There were errors while loading scene file " << filename << ". Your data may be corrupted";
   }
 
-  // delete temp directory
-  try
-  {
-    Poco::File deleteDir( m_WorkingDirectory );
-    deleteDir.remove(true); // recursive
-  }
-  catch(...)
-  {
-    MITK_ERROR << "Could not delete temporary directory " << m_WorkingDirectory;
-  }
-
   // return new data storage, even if empty or uncomplete (return as much as possible but notify calling method)
   return storage;
 }
@@ -198,6 +265,11 @@ bool mitk::SceneIO::SaveScene( DataStorage::SetOfObjects::ConstPointer sceneNode
   {
     m_FailedNodes = DataStorage::SetOfObjects::New();
     m_FailedProperties = PropertyList::New();
+    m_PropertyListEntries.clear();
+    m_WorkingDirectory = "";
+
+    // BaseData objects are serialized after all nodes have been visited, in parallel
+    std::vector<BaseDataSerialization> baseDataSerializations;
 
     // start XML DOM
     TiXmlDocument document;
@@ -225,6 +297,7 @@ bool mitk::SceneIO::SaveScene( DataStorage::SetOfObjects::ConstPointer sceneNode
 
       MITK_INFO << "Storing scene with " << sceneNodes->size() << " objects to " << filename;
 
+      // the serializers of the BaseData objects can only write files
       m_WorkingDirectory = CreateEmptyTempDirectory();
       if (m_WorkingDirectory.empty())
       {
@@ -314,13 +387,12 @@ bool mitk::SceneIO::SaveScene( DataStorage::SetOfObjects::ConstPointer sceneNode
           // store basedata
           if ( BaseData* data = node->GetData() )
           {
-            //std::string filenameHint( node->GetName() );
-            bool error(false);
-            TiXmlElement* dataElement( SaveBaseData( data, filenameHint, error ) ); // returns a reference to a file
-            if (error)
-            {
-              m_FailedNodes->push_back( node );
-            }
+            BaseDataSerialization serialization;
+            serialization.Node = node;
+            serialization.Element = PrepareBaseData( data, filenameHint, serialization.Serializer ); // will get a reference to a file
+            serialization.Error = true;
+            baseDataSerializations.push_back( serialization );
+            TiXmlElement* dataElement( serialization.Element );
 
             // store basedata properties
             PropertyList* propertyList = data->GetPropertyList();
@@ -370,69 +442,97 @@ bool mitk::SceneIO::SaveScene( DataStorage::SetOfObjects::ConstPointer sceneNode
           MITK_WARN << "Ignoring NULL node during scene serialization.";
         }
 
-        ProgressBar::GetInstance()->Progress();
       } // end for all nodes
     } // end if sceneNodes
 
-    if ( !document.SaveFile( m_WorkingDirectory + Poco::Path::separator() + "index.xml" ) )
+    Poco::File deleteFile( filename.c_str() );
+    if (deleteFile.exists())
     {
-      MITK_ERROR << "Could not write scene to " << m_WorkingDirectory << Poco::Path::separator() << "index.xml" << "\nTinyXML reports '" << document.ErrorDesc() << "'";
+      deleteFile.remove();
+    }
+
+    std::ofstream file( filename.c_str(), std::ios::binary | std::ios::out );
+    if (!file.good())
+    {
+      MITK_ERROR << "Could not open a zip file for writing: '" << filename << "'";
+      RemoveDirectory( m_WorkingDirectory );
       return false;
     }
-    else
+    Poco::Zip::Compress zipper( file, true );
+
+    // property lists and index.xml go into the zip file from memory
+    for (std::map<std::string, std::string>::const_iterator iter = m_PropertyListEntries.begin();
+      iter != m_PropertyListEntries.end();
+      ++iter)
+    {
+      AddContentToZip( zipper, iter->first, iter->second );
+    }
+
+    // the files of the BaseData objects are written by m_NumberOfThreads serializers at a time and moved into
+    // the zip file after each batch, so the working directory never holds more than one file per thread
+    const std::size_t batchSize = std::max( m_NumberOfThreads, 1u );
+    for (std::size_t first = 0; first < baseDataSerializations.size(); first += batchSize)
     {
-      try
+      const unsigned int count = static_cast<unsigned int>( std::min( batchSize, baseDataSerializations.size() - first ) );
+      SceneIOParallelFor( count, m_NumberOfThreads, [&baseDataSerializations, first](unsigned int i)
       {
-        Poco::File deleteFile( filename.c_str() );
-        if (deleteFile.exists())
-        {
-          deleteFile.remove();
-        }
+        BaseDataSerialization& serialization = baseDataSerializations[first + i];
+        if (serialization.Serializer.IsNull())
+          return;
 
-        // create zip at filename
-        std::ofstream file( filename.c_str(), std::ios::binary | std::ios::out);
-        if (!file.good())
-        {
-          MITK_ERROR << "Could not open a zip file for writing: '" << filename << "'";
-          return false;
-        }
-        else
-        {
-          Poco::Zip::Compress zipper( file, true );
-          Poco::Path tmpdir( m_WorkingDirectory );
-          zipper.addRecursive( tmpdir );
-          zipper.close();
-        }
         try
         {
-          Poco::File deleteDir( m_WorkingDirectory );
-          deleteDir.remove(true); // recursive
+          serialization.Filename = serialization.Serializer->Serialize();
+          serialization.Error = false;
         }
-        catch(...)
+        catch (std::exception& e)
         {
-          MITK_ERROR << "Could not delete temporary directory " << m_WorkingDirectory;
-          return false; // ok?
+          MITK_ERROR << "Serializer " << serialization.Serializer->GetNameOfClass() << " failed: " << e.what();
         }
+      });
+
+      MoveDirectoryToZip( zipper, m_WorkingDirectory );
+    }
+
+    if ( sceneNodes.IsNotNull() )
+    {
+      ProgressBar::GetInstance()->Progress( sceneNodes->size() );
+    }
+
+    for (std::vector<BaseDataSerialization>::iterator iter = baseDataSerializations.begin();
+      iter != baseDataSerializations.end();
+      ++iter)
+    {
+      if (iter->Error)
+      {
+        m_FailedNodes->push_back( iter->Node );
       }
-      catch(std::exception& e)
+      else
       {
-        MITK_ERROR << "Could not create ZIP file from " << m_WorkingDirectory << "\nReason: " << e.what();
-        return false;
+        iter->Element->SetAttribute("file", iter->Filename);
       }
-      return true;
     }
+
+    TiXmlPrinter printer;
+    document.Accept( &printer );
+    AddContentToZip( zipper, "index.xml", printer.CStr() );
+
+    zipper.close();
+    RemoveDirectory( m_WorkingDirectory );
+    return true;
   }
   catch(std::exception& e)
   {
-    MITK_ERROR << "Caught exception during saving temporary files to disk. Error description: '" << e.what() << "'";
+    MITK_ERROR << "Could not write scene to " << filename << ". Error description: '" << e.what() << "'";
+    RemoveDirectory( m_WorkingDirectory );
     return false;
   }
 }
 
-TiXmlElement* mitk::SceneIO::SaveBaseData( BaseData* data, const std::string& filenamehint, bool& error )
+TiXmlElement* mitk::SceneIO::PrepareBaseData( BaseData* data, const std::string& filenamehint, BaseDataSerializer::Pointer& serializer )
 {
   assert(data);
-  error = true;
+  serializer = NULL;
 
   // find correct serializer
   // the serializer must
@@ -455,21 +555,12 @@ TiXmlElement* mitk::SceneIO::SaveBaseData( BaseData* data, const std::string& fi
     iter != thingsThatCanSerializeThis.end();
     ++iter )
   {
-    if (BaseDataSerializer* serializer = dynamic_cast<BaseDataSerializer*>( iter->GetPointer() ) )
+    if (BaseDataSerializer* baseDataSerializer = dynamic_cast<BaseDataSerializer*>( iter->GetPointer() ) )
     {
-      serializer->SetData(data);
-      serializer->SetFilenameHint(filenamehint);
-      serializer->SetWorkingDirectory( m_WorkingDirectory );
-      try
-      {
-        std::string writtenfilename = serializer->Serialize();
-        element->SetAttribute("file", writtenfilename);
-        error = false;
-      }
-      catch (std::exception& e)
-      {
-        MITK_ERROR << "Serializer " << serializer->GetNameOfClass() << " failed: " << e.what();
-      }
+      baseDataSerializer->SetData(data);
+      baseDataSerializer->SetFilenameHint(filenamehint);
+      baseDataSerializer->SetWorkingDirectory( m_WorkingDirectory );
+      serializer = baseDataSerializer;
       break;
     }
   }
@@ -488,12 +579,13 @@ TiXmlElement* mitk::SceneIO::SavePropertyList( PropertyList* propertyList, const
   PropertyListSerializer::Pointer serializer = PropertyListSerializer::New();
 
   serializer->SetPropertyList(propertyList);
-  serializer->SetFilenameHint(filenamehint);
-  serializer->SetWorkingDirectory( m_WorkingDirectory );
   try
   {
-    std::string writtenfilename = serializer->Serialize();
-    element->SetAttribute("file", writtenfilename);
+    // the list is kept in memory until SaveScene() writes the zip file
+    std::ostringstream entryName;
+    entryName << filenamehint << "_" << m_PropertyListEntries.size() + 1 << ".xml";
+    m_PropertyListEntries[ entryName.str() ] = serializer->SerializeToString();
+    element->SetAttribute("file", entryName.str());
     PropertyList::Pointer failedProperties = serializer->GetFailedProperties();
     if (failedProperties.IsNotNull())
     {
@@ -518,14 +610,3 @@ const mitk::PropertyList* mitk::SceneIO::GetFailedProperties()
 {
   return m_FailedProperties;
 }
-
-void mitk::SceneIO::OnUnzipError(const void*  /*pSender*/, std::pair<const Poco::Zip::ZipLocalFileHeader, const std::string>& info)
-{
-  ++m_UnzipErrors;
-  MITK_ERROR << "Error while unzipping: " << info.second;
-}
-
-void mitk::SceneIO::OnUnzipOk(const void*  /*pSender*/, std::pair<const Poco::Zip::ZipLocalFileHeader, const Poco::Path>& /*info*/)
-{
-  // MITK_INFO << "Unzipped ok: " << info.second.toString();
-}
\ No newline at end of file
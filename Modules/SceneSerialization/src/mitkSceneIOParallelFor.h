@@ -0,0 +1,87 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#ifndef mitkSceneIOParallelFor_h_included
+#define mitkSceneIOParallelFor_h_included
+
+#include <itkMultiThreader.h>
+#include <itkSimpleFastMutexLock.h>
+#include <itkMutexLockHolder.h>
+
+#include <algorithm>
+#include <functional>
+
+namespace mitk
+{
+
+namespace SceneIOParallelForDetail
+{
+  struct Tasks
+  {
+    const std::function<void(unsigned int)>* Task;
+    unsigned int Count;
+    unsigned int Next;
+    itk::SimpleFastMutexLock Mutex;
+  };
+
+  inline ITK_THREAD_RETURN_TYPE ThreaderCallback( void* arg )
+  {
+    Tasks* tasks = static_cast<Tasks*>( static_cast<itk::MultiThreader::ThreadInfoStruct*>(arg)->UserData );
+    while (true)
+    {
+      unsigned int index;
+      {
+        itk::MutexLockHolder<itk::SimpleFastMutexLock> lock(tasks->Mutex);
+        if (tasks->Next >= tasks->Count)
+          break;
+        index = tasks->Next++;
+      }
+      (*tasks->Task)(index);
+    }
+    return ITK_THREAD_RETURN_VALUE;
+  }
+}
+
+/**
+  \brief Calls task(0) ... task(count-1) on up to numberOfThreads threads.
+
+  Each thread takes the next index as soon as its previous task is done, so
+  a few large objects do not keep the other threads waiting. Tasks are
+  started in index order and must not throw. Returns after all tasks are done.
+*/
+inline void SceneIOParallelFor( unsigned int count, unsigned int numberOfThreads, const std::function<void(unsigned int)>& task )
+{
+  if (numberOfThreads <= 1 || count <= 1)
+  {
+    for (unsigned int i = 0; i < count; ++i)
+      task(i);
+    return;
+  }
+
+  SceneIOParallelForDetail::Tasks tasks;
+  tasks.Task = &task;
+  tasks.Count = count;
+  tasks.Next = 0;
+
+  itk::MultiThreader::Pointer threader = itk::MultiThreader::New();
+  threader->SetNumberOfThreads( std::min(numberOfThreads, count) );
+  threader->SetSingleMethod( &SceneIOParallelForDetail::ThreaderCallback, &tasks );
+  threader->SingleMethodExecute();
+}
+
+}
+
+#endif
@@ -16,8 +16,17 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 #include "mitkSceneReader.h"
 
+mitk::SceneReader::SceneReader()
+  : m_NumberOfThreads(1),
+    m_LazyLoading(false)
+{
+}
+
 bool mitk::SceneReader::LoadScene( TiXmlDocument& document, const std::string& workingDirectory, DataStorage* storage )
 {
+  // scenes are read from their file or from a directory they were extracted to
+  const std::string sceneName = m_SceneFilename.empty() ? workingDirectory + "/index.xml" : m_SceneFilename;
+
   // find version node --> note version in some variable
   int fileVersion = 1;
   TiXmlElement* versionObject = document.FirstChildElement("Version");
@@ -25,7 +34,7 @@ bool mitk::SceneReader::LoadScene( TiXmlDocument& document, const std::string& w
   {
     if ( versionObject->QueryIntAttribute( "FileVersion", &fileVersion ) != TIXML_SUCCESS )
     {
-      MITK_ERROR << "Scene file " << workingDirectory + "/index.xml" << " does not contain version information! Trying version 1 format." << std::endl;
+      MITK_ERROR << "Scene file " << sceneName << " does not contain version information! Trying version 1 format." << std::endl;
     }
   }
 
@@ -48,9 +57,12 @@ bool mitk::SceneReader::LoadScene( TiXmlDocument& document, const std::string& w
   {
     if (SceneReader* reader = dynamic_cast<SceneReader*>( iter->GetPointer() ) )
     {
+      reader->SetNumberOfThreads( m_NumberOfThreads );
+      reader->SetLazyLoading( m_LazyLoading );
+      reader->SetSceneFilename( m_SceneFilename );
       if ( !reader->LoadScene( document, workingDirectory, storage ) )
       {
-        MITK_ERROR << "There were errors while loading scene file " << workingDirectory + "/index.xml. Your data may be corrupted";
+        MITK_ERROR << "There were errors while loading scene file " << sceneName << ". Your data may be corrupted";
         return false;
       }
       else
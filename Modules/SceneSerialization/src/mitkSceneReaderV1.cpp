@@ -15,6 +15,8 @@ See LICENSE.txt or http://www.mitk.org for details.
 ===================================================================*/
 
 #include "mitkSceneReaderV1.h"
+#include "mitkSceneIOParallelFor.h"
+#include "mitkSceneDataLoader.h"
 #include "mitkSerializerMacros.h"
 #include "mitkBaseRenderer.h"
 #include "mitkPropertyListDeserializer.h"
@@ -30,6 +32,21 @@ bool mitk::SceneReaderV1::LoadScene( TiXmlDocument& document, const std::string&
   assert(storage);
   bool error(false);
 
+  // with a scene file, the data and property files are read from it instead of from the working directory
+  m_Archive.reset();
+  if (!m_SceneFilename.empty())
+  {
+    try
+    {
+      m_Archive = std::make_shared<SceneArchive>( m_SceneFilename );
+    }
+    catch (std::exception& e)
+    {
+      MITK_ERROR << "Could not read scene file " << m_SceneFilename << ": " << e.what();
+      return false;
+    }
+  }
+
   // TODO prepare to detect errors (such as cycles) from wrongly written or edited xml files
 
   //Get number of elements to initialze progress bar
@@ -50,10 +67,67 @@ bool mitk::SceneReaderV1::LoadScene( TiXmlDocument& document, const std::string&
 
   ProgressBar::GetInstance()->AddStepsToDo(listSize * 2);
 
+  std::vector<TiXmlElement*> dataElements;
   for (TiXmlElement* element = document.FirstChildElement("node"); element != NULL; element = element->NextSiblingElement("node"))
   {
-      DataNodes.push_back(LoadBaseDataFromDataTag(element->FirstChildElement("data"), workingDirectory, error));
-      ProgressBar::GetInstance()->Progress();
+    dataElements.push_back(element->FirstChildElement("data"));
+  }
+
+  std::vector<BaseData::Pointer> baseData(dataElements.size());
+  std::vector<SceneDataLoader::Pointer> loaders(dataElements.size());
+  std::vector<char> loadErrors(dataElements.size(), 0);
+  if (m_Archive)
+  {
+    // each node reads its entry from the scene file, on first access when loading lazily
+    for (std::size_t i = 0; i < dataElements.size(); ++i)
+    {
+      const char* filename = dataElements[i] ? dataElements[i]->Attribute("file") : NULL;
+      if (filename)
+      {
+        const char* type = dataElements[i]->Attribute("type");
+        loaders[i] = SceneDataLoader::New( m_Archive, filename, type ? type : "" );
+      }
+    }
+
+    if (!m_LazyLoading)
+    {
+      // read the data of all nodes in parallel, the nodes are created afterwards in this thread
+      SceneIOParallelFor(static_cast<unsigned int>(dataElements.size()), m_NumberOfThreads, [&](unsigned int i)
+      {
+        if (loaders[i].IsNotNull())
+        {
+          baseData[i] = loaders[i]->Load();
+          loadErrors[i] = baseData[i].IsNull();
+        }
+      });
+    }
+  }
+  else
+  {
+    // read the files of all nodes from the working directory in parallel
+    SceneIOParallelFor(static_cast<unsigned int>(dataElements.size()), m_NumberOfThreads, [&](unsigned int i)
+    {
+      bool loadError(false);
+      baseData[i] = LoadBaseData(dataElements[i], workingDirectory, loadError);
+      loadErrors[i] = loadError;
+    });
+  }
+
+  for (std::size_t i = 0; i < dataElements.size(); ++i)
+  {
+    // in case there was no <data> element we create a new empty node (for appending a propertylist later)
+    DataNode::Pointer node = DataNode::New();
+    if (baseData[i].IsNotNull())
+    {
+      node->SetData(baseData[i]);
+    }
+    else if (m_LazyLoading && loaders[i].IsNotNull())
+    {
+      node->SetDataLoader(loaders[i]);
+    }
+    DataNodes.push_back(node);
+    error |= loadErrors[i] != 0;
+    ProgressBar::GetInstance()->Progress();
   }
 
   OrderedLayers orderedLayers;
@@ -72,7 +146,13 @@ bool mitk::SceneReaderV1::LoadScene( TiXmlDocument& document, const std::string&
     if( dataXmlElement && dataXmlElement->FirstChildElement("properties") )
     {
       TiXmlElement *baseDataElement = dataXmlElement->FirstChildElement("properties");
-      if ( node->GetData() )
+      if ( SceneDataLoader* loader = dynamic_cast<SceneDataLoader*>( node->GetDataLoader() ) )
+      {
+        // the loader attaches the properties to the data it reads
+        bool propertiesError(false);
+        loader->SetDataProperties( ReadBaseDataProperties( baseDataElement, workingDirectory, propertiesError ) );
+      }
+      else if ( node->GetData() )
       {
         DecorateBaseDataWithProperties( node->GetData(), baseDataElement, workingDirectory);
       }
@@ -154,6 +234,25 @@ bool mitk::SceneReaderV1::LoadScene( TiXmlDocument& document, const std::string&
     }
   }
 
+  // read the data of the visible nodes in the background, the hidden ones are read on first access;
+  // the background thread runs the readers concurrently to the application, which is only
+  // safe if they do not change the process locale, so it needs the same opt-in as parallel loading
+  if (m_LazyLoading && m_NumberOfThreads > 1)
+  {
+    std::vector<SceneDataLoader::Pointer> visibleLoaders;
+    for (std::size_t i = 0; i < DataNodes.size(); ++i)
+    {
+      if (loaders[i].IsNotNull() && DataNodes[i]->IsVisible(NULL))
+      {
+        visibleLoaders.push_back(loaders[i]);
+      }
+    }
+    SceneDataLoader::Prefetch(visibleLoaders);
+  }
+
+  // observers are notified once about all nodes of the scene
+  DataStorage::BatchScope batch(storage);
+
   // repeat
   //   for all created nodes
   unsigned int lastMapSize(0);
@@ -244,7 +343,21 @@ void mitk::SceneReaderV1::GetLayerOrder(TiXmlDocument& document, const std::stri
 
 mitk::DataNode::Pointer mitk::SceneReaderV1::LoadBaseDataFromDataTag( TiXmlElement* dataElement, const std::string& workingDirectory, bool& error )
 {
-  DataNode::Pointer node;
+  DataNode::Pointer node = DataNode::New();
+
+  // in case there was no <data> element we return an empty node (for appending a propertylist later)
+  BaseData::Pointer baseData = LoadBaseData( dataElement, workingDirectory, error );
+  if (baseData.IsNotNull())
+  {
+    node->SetData(baseData);
+  }
+
+  return node;
+}
+
+mitk::BaseData::Pointer mitk::SceneReaderV1::LoadBaseData( TiXmlElement* dataElement, const std::string& workingDirectory, bool& error )
+{
+  BaseData::Pointer data;
 
   if (dataElement)
   {
@@ -258,8 +371,10 @@ mitk::DataNode::Pointer mitk::SceneReaderV1::LoadBaseDataFromDataTag( TiXmlEleme
         {
           MITK_WARN << "Discarding multiple base data results from " << filename << " except the first one.";
         }
-        node = DataNode::New();
-        node->SetData(baseData.front());
+        if (!baseData.empty())
+        {
+          data = baseData.front();
+        }
       }
       catch (std::exception& e)
       {
@@ -267,7 +382,7 @@ mitk::DataNode::Pointer mitk::SceneReaderV1::LoadBaseDataFromDataTag( TiXmlEleme
         error = true;
       }
 
-      if (node.IsNull())
+      if (data.IsNull())
       {
         MITK_ERROR << "Error during attempt to read '" << filename << "'. Factory returned NULL object.";
         error = true;
@@ -275,13 +390,7 @@ mitk::DataNode::Pointer mitk::SceneReaderV1::LoadBaseDataFromDataTag( TiXmlEleme
     }
   }
 
-  // in case there was no <data> element we create a new empty node (for appending a propertylist later)
-  if (node.IsNull())
-  {
-    node = DataNode::New();
-  }
-
-  return node;
+  return data;
 }
 
 bool mitk::SceneReaderV1::DecorateNodeWithProperties(DataNode* node, TiXmlElement* nodeElement, const std::string& workingDirectory)
@@ -303,12 +412,9 @@ bool mitk::SceneReaderV1::DecorateNodeWithProperties(DataNode* node, TiXmlElemen
     propertyList->Clear();
 
     // use deserializer to construct new properties
-    PropertyListDeserializer::Pointer deserializer = PropertyListDeserializer::New();
-
-    deserializer->SetFilename(workingDirectory + Poco::Path::separator() + propertiesfile);
-    bool success = deserializer->Deserialize();
+    PropertyList::Pointer readProperties;
+    bool success = ReadPropertyList(propertiesfile, workingDirectory, readProperties);
     error |= !success;
-    PropertyList::Pointer readProperties = deserializer->GetOutput();
 
     if (readProperties.IsNotNull())
     {
@@ -330,29 +436,30 @@ bool mitk::SceneReaderV1::DecorateBaseDataWithProperties(BaseData::Pointer data,
   assert(baseDataNodeElem);
   bool error(false);
 
+  // store the read-in properties to the given node
+  PropertyList::Pointer inProperties = ReadBaseDataProperties( baseDataNodeElem, workingDir, error );
+  if( inProperties.IsNotNull() )
+  {
+    data->SetPropertyList( inProperties );
+  }
+
+  return !error;
+}
+
+mitk::PropertyList::Pointer mitk::SceneReaderV1::ReadBaseDataProperties(TiXmlElement *baseDataNodeElem, const std::string &workingDir, bool& error)
+{
+  PropertyList::Pointer inProperties;
+
   // get the file name stored in the <properties ...> tag
   const char* baseDataPropertyFile( baseDataNodeElem->Attribute("file") );
   // check if the filename was found
   if(baseDataPropertyFile)
   {
-    //PropertyList::Pointer dataPropList = data->GetPropertyList();
-
-    PropertyListDeserializer::Pointer propertyDeserializer = PropertyListDeserializer::New();
-
-    // initialize the property reader
-    propertyDeserializer->SetFilename(workingDir + Poco::Path::separator() + baseDataPropertyFile);
-    bool ioSuccess = propertyDeserializer->Deserialize();
+    bool ioSuccess = ReadPropertyList(baseDataPropertyFile, workingDir, inProperties);
     error = !ioSuccess;
 
-    // get the output
-    PropertyList::Pointer inProperties = propertyDeserializer->GetOutput();
-
-    // store the read-in properties to the given node or throw error otherwise
-    if( inProperties.IsNotNull() )
-    {
-      data->SetPropertyList( inProperties );
-    }
-    else
+    // check the output
+    if( inProperties.IsNull() )
     {
       MITK_ERROR << "The property deserializer did not return a (valid) property list.";
       error = true;
@@ -364,6 +471,33 @@ bool mitk::SceneReaderV1::DecorateBaseDataWithProperties(BaseData::Pointer data,
     error = true;
   }
 
-  return !error;
+  return inProperties;
 }
 
+bool mitk::SceneReaderV1::ReadPropertyList(const std::string& propertiesFile, const std::string& workingDirectory, PropertyList::Pointer& propertyList)
+{
+  PropertyListDeserializer::Pointer deserializer = PropertyListDeserializer::New();
+
+  if (m_Archive)
+  {
+    // the XML is parsed from memory, it is not extracted to a file
+    deserializer->SetFilename(propertiesFile);
+    try
+    {
+      deserializer->SetContent(m_Archive->ReadEntry(propertiesFile));
+    }
+    catch (std::exception& e)
+    {
+      MITK_ERROR << "Could not read property list " << propertiesFile << ": " << e.what();
+      return false;
+    }
+  }
+  else
+  {
+    deserializer->SetFilename(workingDirectory + Poco::Path::separator() + propertiesFile);
+  }
+
+  bool success = deserializer->Deserialize();
+  propertyList = deserializer->GetOutput();
+  return success;
+}
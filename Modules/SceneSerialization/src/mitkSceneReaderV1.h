@@ -15,6 +15,9 @@ See LICENSE.txt or http://www.mitk.org for details.
 ===================================================================*/
 
 #include "mitkSceneReader.h"
+#include "mitkSceneArchive.h"
+
+#include <memory>
 
 namespace mitk
 {
@@ -38,6 +41,15 @@ class SceneReaderV1 : public SceneReader
                                                    const std::string& workingDirectory,
                                                    bool& error );
 
+    /**
+      \brief reads the BaseData of a <data> element, returns NULL if there is no such element or the file can not be read
+
+      Does not change the reader and can be called from several threads at once.
+    */
+    BaseData::Pointer LoadBaseData( TiXmlElement* dataElement,
+                                    const std::string& workingDirectory,
+                                    bool& error );
+
     /**
       \brief reads all the properties from the XML document and recreates them in node
     */
@@ -50,6 +62,16 @@ class SceneReaderV1 : public SceneReader
     */
     bool DecorateBaseDataWithProperties(BaseData::Pointer data, TiXmlElement* baseDataNodeElem, const std::string& workingDir);
 
+    /**
+      \brief reads the property list of a base data element, the baseDataNodeElem is supposed to be the <properties file="..."> element.
+    */
+    PropertyList::Pointer ReadBaseDataProperties(TiXmlElement* baseDataNodeElem, const std::string& workingDir, bool& error);
+
+    /**
+      \brief reads a property list file, from the scene file if there is one, otherwise from the working directory
+    */
+    bool ReadPropertyList(const std::string& propertiesFile, const std::string& workingDirectory, PropertyList::Pointer& propertyList);
+
     typedef std::multimap<int, std::string> UnorderedLayers;
     typedef std::map<std::string, int> OrderedLayers;
     typedef std::pair<DataNode::Pointer, std::list<std::string> >   NodesAndParentsPair;
@@ -66,6 +88,8 @@ class SceneReaderV1 : public SceneReader
     NodeToIDMappingType     m_IDForNode;
 
     UIDGenerator m_UIDGen;
+
+    std::shared_ptr<const SceneArchive> m_Archive;
 };
 
 }
@@ -0,0 +1,40 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include "mitkSceneDataLoader.h"
+
+#include <usModuleActivator.h>
+#include <usModuleContext.h>
+
+namespace mitk
+{
+  class SceneSerializationActivator : public us::ModuleActivator
+  {
+  public:
+
+    void Load(us::ModuleContext*) override
+    {
+    }
+
+    void Unload(us::ModuleContext*) override
+    {
+      // the prefetch thread reads with IOUtil, so it has to end before the modules it uses are gone
+      SceneDataLoader::StopPrefetch();
+    }
+  };
+}
+
+US_EXPORT_MODULE_ACTIVATOR(mitk::SceneSerializationActivator)
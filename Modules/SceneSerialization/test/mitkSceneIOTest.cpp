@@ -27,6 +27,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "mitkSurface.h"
 #include "mitkPointSet.h"
 #include "mitkIOUtil.h"
+#include "mitkNodePredicateDataType.h"
 #include "Poco/File.h"
 #include "Poco/TemporaryFile.h"
 
@@ -207,6 +208,10 @@ int mitkSceneIOTest(int, char* argv[])
     // create a data storage and fill it with some test data
     mitk::SceneIO::Pointer sceneIO = mitk::SceneIO::New();
     MITK_TEST_CONDITION_REQUIRED(sceneIO.IsNotNull(),"SceneIO instantiation")
+    MITK_TEST_CONDITION_REQUIRED(sceneIO->GetNumberOfThreads() == 1, "Scenes are processed in the calling thread by default")
+
+    // the images, surfaces and point sets of the test scene are written and read without changing the process locale
+    sceneIO->SetNumberOfThreads(4);
 
     mitk::DataStorage::Pointer storage = mitk::StandaloneDataStorage::New().GetPointer();
     MITK_TEST_CONDITION_REQUIRED(storage.IsNotNull(),"StandaloneDataStorage instantiation");
@@ -263,6 +268,7 @@ int mitkSceneIOTest(int, char* argv[])
 
     //Now do the loading part
     sceneIO = mitk::SceneIO::New();
+    sceneIO->SetNumberOfThreads(4);
 
     //Load scene into the datastorage and clean the DS first
     MITK_TEST_OUTPUT(<< "Loading scene again");
@@ -309,6 +315,37 @@ int mitkSceneIOTest(int, char* argv[])
     // check if data storage content has been restored correctly
     SceneIOTestClass::VerifyStorage(storage);
 
+    // the scene was saved and loaded with several threads, the result must not differ from sequential loading
+    sceneIO = mitk::SceneIO::New();
+    sceneIO->SetNumberOfThreads(1);
+    MITK_TEST_OUTPUT(<< "Loading scene again in a single thread");
+    mitk::DataStorage::Pointer sequentialStorage = sceneIO->LoadScene(sceneFileName);
+    MITK_TEST_CONDITION_REQUIRED(sceneIO->GetFailedNodes() == NULL || sceneIO->GetFailedNodes()->empty(), "Checking if all nodes have been loaded in a single thread.")
+    MITK_TEST_CONDITION_REQUIRED(sequentialStorage->GetAll()->Size() == storage->GetAll()->Size(), "Same number of nodes loaded in a single thread.")
+    SceneIOTestClass::VerifyStorage(sequentialStorage);
+
+    // lazy loading creates the nodes without their data, which is read on first access
+    sceneIO = mitk::SceneIO::New();
+    sceneIO->LazyLoadingOn();
+    MITK_TEST_OUTPUT(<< "Loading scene lazily");
+    mitk::DataStorage::Pointer lazyStorage = sceneIO->LoadScene(sceneFileName);
+    MITK_TEST_CONDITION_REQUIRED(lazyStorage->GetAll()->Size() == storage->GetAll()->Size(), "Same number of nodes loaded lazily.")
+    mitk::DataNode::Pointer lazyImageNode = lazyStorage->GetNamedNode("Pic3D");
+    MITK_TEST_CONDITION_REQUIRED(lazyImageNode.IsNotNull(), "Lazily loaded node found by name.")
+    MITK_TEST_CONDITION(!lazyImageNode->IsDataLoaded(), "Data not read in the background by default.")
+    MITK_TEST_CONDITION(lazyStorage->GetSubset(mitk::NodePredicateDataType::New("Image"))->Size() == 2, "Lazily loaded nodes found by data type.")
+    SceneIOTestClass::VerifyStorage(lazyStorage);
+    MITK_TEST_CONDITION(lazyImageNode->IsDataLoaded(), "Data read on first access.")
+
+    // with parallel IO enabled, the data of visible nodes is read in the background
+    sceneIO = mitk::SceneIO::New();
+    sceneIO->LazyLoadingOn();
+    sceneIO->SetNumberOfThreads(4);
+    MITK_TEST_OUTPUT(<< "Loading scene lazily with background reading");
+    mitk::DataStorage::Pointer prefetchedStorage = sceneIO->LoadScene(sceneFileName);
+    MITK_TEST_CONDITION_REQUIRED(prefetchedStorage->GetAll()->Size() == storage->GetAll()->Size(), "Same number of nodes loaded with background reading.")
+    SceneIOTestClass::VerifyStorage(prefetchedStorage);
+
   }
   // if no sub-test failed remove the scene file, otherwise it is kept for debugging purposes
   if ( mitk::TestManager::GetInstance()->NumberOfFailedTests() == 0 )
@@ -23,6 +23,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 #include <itkObjectFactoryBase.h>
 
+class TiXmlDocument;
 class TiXmlElement;
 
 namespace mitk
@@ -53,6 +54,12 @@ class MITKSCENESERIALIZATIONBASE_EXPORT PropertyListSerializer : public itk::Obj
       */
     virtual std::string Serialize();
 
+    /**
+      \brief Serializes given PropertyList object without writing a file, e.g. into a scene file.
+      \return the XML text, empty if the list could not be serialized.
+      */
+    virtual std::string SerializeToString();
+
     PropertyList* GetFailedProperties();
 
   protected:
@@ -60,6 +67,7 @@ class MITKSCENESERIALIZATIONBASE_EXPORT PropertyListSerializer : public itk::Obj
     PropertyListSerializer();
     virtual ~PropertyListSerializer();
 
+    void CreateDocument( TiXmlDocument& document );
     TiXmlElement* SerializeOneProperty( const std::string& key, const BaseProperty* property );
 
     std::string m_FilenameHint;
@@ -17,6 +17,8 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "mitkBaseDataSerializer.h"
 #include "mitkStandardFileLocations.h"
 #include <itksys/SystemTools.hxx>
+#include <itkSimpleFastMutexLock.h>
+#include <itkMutexLockHolder.h>
 
 mitk::BaseDataSerializer::BaseDataSerializer()
 : m_FilenameHint("unnamed")
@@ -40,9 +42,14 @@ std::string mitk::BaseDataSerializer::Serialize()
 
 std::string mitk::BaseDataSerializer::GetUniqueFilenameInWorkingDirectory()
 {
-  // tmpname
+  // tmpname; serializers of several nodes may run in parallel
   static unsigned long count = 0;
-  unsigned long n = count++;
+  static itk::SimpleFastMutexLock countMutex;
+  unsigned long n;
+  {
+    itk::MutexLockHolder<itk::SimpleFastMutexLock> lock(countMutex);
+    n = count++;
+  }
   std::ostringstream name;
   for (int i = 0; i < 6; ++i)
   {
@@ -67,6 +67,38 @@ std::string mitk::PropertyListSerializer::Serialize()
     fullname = fullname.substr(1, length - 2);
 
   TiXmlDocument document;
+  this->CreateDocument( document );
+
+  // save XML file
+  if ( !document.SaveFile( fullname ) )
+  {
+    MITK_ERROR << "Could not write PropertyList to " << fullname << "\nTinyXML reports '" << document.ErrorDesc() << "'";
+    return "";
+  }
+
+  return filename;
+}
+
+std::string mitk::PropertyListSerializer::SerializeToString()
+{
+  m_FailedProperties = PropertyList::New();
+
+  if ( m_PropertyList.IsNull() || m_PropertyList->IsEmpty() )
+  {
+    MITK_ERROR << "Not serializing NULL or empty PropertyList";
+    return "";
+  }
+
+  TiXmlDocument document;
+  this->CreateDocument( document );
+
+  TiXmlPrinter printer;
+  document.Accept( &printer );
+  return printer.CStr();
+}
+
+void mitk::PropertyListSerializer::CreateDocument( TiXmlDocument& document )
+{
   auto  decl = new TiXmlDeclaration( "1.0", "", "" ); // TODO what to write here? encoding? etc....
   document.LinkEndChild( decl );
 
@@ -95,15 +127,6 @@ std::string mitk::PropertyListSerializer::Serialize()
       m_FailedProperties->ReplaceProperty( key, const_cast<BaseProperty*>(property) );
     }
   }
-
-  // save XML file
-  if ( !document.SaveFile( fullname ) )
-  {
-    MITK_ERROR << "Could not write PropertyList to " << fullname << "\nTinyXML reports '" << document.ErrorDesc() << "'";
-    return "";
-  }
-
-  return filename;
 }
 
 TiXmlElement* mitk::PropertyListSerializer::SerializeOneProperty( const std::string& key, const BaseProperty* property )
@@ -662,7 +662,11 @@ bool QmitkIVIMView::FittIVIM(itk::VectorImage<short,3>* vecimg, DirContainerType
         filter->SetFitDStar(true);
     }
 
-    filter->SetNumberOfThreads(1);
+    // the batched fit of the first three methods is thread safe
+    bool batched = multivoxel && m_Controls->m_MethodCombo->currentIndex() <= 2;
+    filter->SetUseBatchedFit(batched);
+    if(!batched)
+        filter->SetNumberOfThreads(1);
     filter->SetVerbose(false);
     filter->SetCrossPosition(crosspos);
 
@@ -251,6 +251,7 @@ set(mitk_cmake_boolean_args
   MITK_BUILD_ALL_PLUGINS
   MITK_BUILD_ALL_APPS
   MITK_BUILD_EXAMPLES
+  MITK_BUILD_BENCHMARKS
 
   MITK_USE_QT
   MITK_USE_SYSTEM_Boost